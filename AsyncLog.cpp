@@ -0,0 +1,278 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "AsyncLog.h"
+#include "Server.h"
+#include "MemoryRingPipe.h"
+#include <memory.h>
+#include <algorithm>
+
+struct SAsyncLogBuffer
+{
+	SAsyncLogBuffer(size_t buffer_size)
+		: pipe(buffer_size), buffer_size(buffer_size), orphaned(false), dropped(0)
+	{}
+
+	CMemoryRingPipe pipe;
+	size_t buffer_size;
+	//Set once the owning thread exited or replaced it by a larger buffer.
+	//Removed from the log after it was read empty
+	std::atomic<bool> orphaned;
+	std::atomic<size_t> dropped;
+};
+
+namespace
+{
+	const size_t c_log_header_size = sizeof(int64) + sizeof(int);
+	const size_t c_initial_buffer_size = 4096;
+
+	struct SAsyncLogThreadBuffer
+	{
+		SAsyncLogThreadBuffer()
+			: owner(NULL)
+		{}
+
+		~SAsyncLogThreadBuffer()
+		{
+			if (buffer)
+			{
+				buffer->orphaned = true;
+			}
+		}
+
+		CAsyncLog* owner;
+		std::shared_ptr<SAsyncLogBuffer> buffer;
+		std::string msg;
+	};
+
+	thread_local SAsyncLogThreadBuffer thread_log_buffer;
+
+	bool entry_seq_less(const SAsyncLogEntry& a, const SAsyncLogEntry& b)
+	{
+		return a.seq < b.seq;
+	}
+}
+
+CAsyncLog::CAsyncLog(CServer* server, size_t max_buffer_size, int flush_interval_ms)
+	: server(server), max_buffer_size(max_buffer_size), flush_interval_ms(flush_interval_ms),
+	running(true), next_seq(0), do_wakeup(false), do_stop(false), stopped(false)
+{
+	mutex = server->createMutex();
+	cond = server->createCondition();
+}
+
+bool CAsyncLog::log(const std::string& msg, int loglevel)
+{
+	if (!running)
+	{
+		return false;
+	}
+
+	SAsyncLogBuffer* buffer = getBuffer();
+
+	int64 seq = next_seq++;
+
+	std::string& data = thread_log_buffer.msg;
+	data.resize(c_log_header_size);
+	memcpy(&data[0], &seq, sizeof(seq));
+	memcpy(&data[sizeof(seq)], &loglevel, sizeof(loglevel));
+	data.append(msg);
+
+	bool written = buffer->pipe.Write(data, 0, false);
+	while (!written
+		&& buffer->buffer_size < max_buffer_size)
+	{
+		buffer = growBuffer();
+		written = buffer->pipe.Write(data, 0, false);
+	}
+
+	if (!written)
+	{
+		if (loglevel < LL_WARNING)
+		{
+			++buffer->dropped;
+			return true;
+		}
+
+		wakeup();
+		buffer->pipe.Write(data, -1, false);
+	}
+
+	if (loglevel == LL_ERROR)
+	{
+		wakeup();
+	}
+
+	return true;
+}
+
+void CAsyncLog::operator()()
+{
+	IScopedLock lock(mutex);
+	while (true)
+	{
+		if (!do_stop && !do_wakeup)
+		{
+			cond->wait(&lock, flush_interval_ms);
+		}
+		do_wakeup = false;
+		bool curr_stop = do_stop;
+
+		lock.relock(NULL);
+		flushBuffers();
+		lock.relock(mutex);
+
+		if (curr_stop)
+		{
+			//Buffers of threads that are still running are freed when
+			//these threads exit
+			buffers.clear();
+			stopped = true;
+			cond->notify_all();
+			return;
+		}
+	}
+}
+
+void CAsyncLog::stop()
+{
+	running = false;
+
+	IScopedLock lock(mutex);
+	do_stop = true;
+	cond->notify_all();
+	while (!stopped)
+	{
+		cond->wait(&lock);
+	}
+}
+
+SAsyncLogBuffer* CAsyncLog::getBuffer()
+{
+	if (thread_log_buffer.owner == this)
+	{
+		return thread_log_buffer.buffer.get();
+	}
+
+	addBuffer((std::min)(c_initial_buffer_size, max_buffer_size));
+	thread_log_buffer.owner = this;
+	return thread_log_buffer.buffer.get();
+}
+
+SAsyncLogBuffer* CAsyncLog::growBuffer()
+{
+	//Messages are ordered by their sequence number, so the
+	//old buffer can still be read after the new one
+	addBuffer((std::min)(thread_log_buffer.buffer->buffer_size * 2, max_buffer_size));
+	return thread_log_buffer.buffer.get();
+}
+
+void CAsyncLog::addBuffer(size_t buffer_size)
+{
+	if (thread_log_buffer.buffer)
+	{
+		thread_log_buffer.buffer->orphaned = true;
+	}
+
+	std::shared_ptr<SAsyncLogBuffer> buffer = std::make_shared<SAsyncLogBuffer>(buffer_size);
+
+	{
+		IScopedLock lock(mutex);
+		buffers.push_back(buffer);
+	}
+
+	thread_log_buffer.buffer = buffer;
+}
+
+void CAsyncLog::wakeup()
+{
+	IScopedLock lock(mutex);
+	do_wakeup = true;
+	cond->notify_all();
+}
+
+void CAsyncLog::flushBuffers()
+{
+	std::vector<std::shared_ptr<SAsyncLogBuffer> > curr_buffers;
+	{
+		IScopedLock lock(mutex);
+		curr_buffers = buffers;
+	}
+
+	size_t n_entries = 0;
+	size_t dropped = 0;
+	std::vector<SAsyncLogBuffer*> orphaned_buffers;
+
+	for (size_t i = 0; i < curr_buffers.size(); ++i)
+	{
+		SAsyncLogBuffer* buffer = curr_buffers[i].get();
+
+		//Check before reading, so all messages of an exited thread are read
+		bool orphaned = buffer->orphaned;
+
+		while (buffer->pipe.isReadable(0))
+		{
+			if (buffer->pipe.Read(&read_buf, 0) < c_log_header_size)
+			{
+				continue;
+			}
+
+			if (n_entries >= entries.size())
+			{
+				entries.resize(n_entries + 1);
+			}
+
+			SAsyncLogEntry& entry = entries[n_entries++];
+			memcpy(&entry.seq, read_buf.data(), sizeof(entry.seq));
+			memcpy(&entry.loglevel, read_buf.data() + sizeof(entry.seq), sizeof(entry.loglevel));
+			entry.msg.assign(read_buf, c_log_header_size, std::string::npos);
+		}
+
+		dropped += buffer->dropped.exchange(0);
+
+		if (orphaned)
+		{
+			orphaned_buffers.push_back(buffer);
+		}
+	}
+
+	if (!orphaned_buffers.empty())
+	{
+		IScopedLock lock(mutex);
+		for (size_t i = 0; i < orphaned_buffers.size(); ++i)
+		{
+			for (size_t j = 0; j < buffers.size(); ++j)
+			{
+				if (buffers[j].get() == orphaned_buffers[i])
+				{
+					buffers.erase(buffers.begin() + j);
+					break;
+				}
+			}
+		}
+	}
+
+	if (n_entries == 0 && dropped == 0)
+	{
+		return;
+	}
+
+	std::sort(entries.begin(), entries.begin() + n_entries, entry_seq_less);
+
+	server->writeLogBatch(entries, n_entries, dropped);
+}
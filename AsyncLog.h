@@ -0,0 +1,75 @@
+#ifndef ASYNCLOG_H_
+#define ASYNCLOG_H_
+
+#include "Interface/Thread.h"
+#include "Interface/Mutex.h"
+#include "Interface/Condition.h"
+#include "Interface/Types.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+
+class CServer;
+struct SAsyncLogBuffer;
+
+struct SAsyncLogEntry
+{
+	int64 seq;
+	int loglevel;
+	std::string msg;
+};
+
+/**
+* Asynchronous log backend of CServer. Each logging thread writes its
+* messages into its own single producer/consumer ring buffer without
+* taking a lock. A background thread collects the messages of all threads
+* every flush_interval_ms (or as soon as an error is logged), restores the
+* logging order and hands them to CServer as one batch, which timestamps,
+* writes and flushes them once.
+* Buffers start small and are replaced by one twice the size when they run
+* full, up to max_buffer_size. If the buffer of a thread is full at that
+* size, errors and warnings wait for the background thread, lower log
+* levels are dropped and counted. Buffers are freed once their thread
+* exited and they were read, or when the log is stopped.
+*/
+class CAsyncLog : public IThread
+{
+public:
+	CAsyncLog(CServer* server, size_t max_buffer_size, int flush_interval_ms);
+
+	//Returns false if the async log is not running (anymore)
+	bool log(const std::string& msg, int loglevel);
+
+	void operator()();
+
+	//Writes out all buffered messages and stops the background thread
+	void stop();
+
+private:
+	SAsyncLogBuffer* getBuffer();
+	SAsyncLogBuffer* growBuffer();
+	void addBuffer(size_t buffer_size);
+	void wakeup();
+	void flushBuffers();
+
+	CServer* server;
+	size_t max_buffer_size;
+	int flush_interval_ms;
+
+	std::atomic<bool> running;
+	std::atomic<int64> next_seq;
+
+	IMutex* mutex;
+	ICondition* cond;
+	bool do_wakeup;
+	bool do_stop;
+	bool stopped;
+	std::vector<std::shared_ptr<SAsyncLogBuffer> > buffers;
+
+	//Only used by the background thread
+	std::vector<SAsyncLogEntry> entries;
+	std::string read_buf;
+};
+
+#endif /*ASYNCLOG_H_*/
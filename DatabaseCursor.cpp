@@ -27,7 +27,7 @@
 
 DatabaseCursor::DatabaseCursor(CQuery *query, int *timeoutms)
 	: query(query), transaction_lock(false), tries(60), timeoutms(timeoutms),
-	lastErr(SQLITE_OK), _has_error(false), is_shutdown(false)
+	lastErr(SQLITE_OK), _has_error(false), is_shutdown(false), was_restarted(false)
 #ifdef LOG_READ_QUERIES
 	, db(db)
 #endif
@@ -52,7 +52,7 @@ bool DatabaseCursor::reset()
 	is_shutdown = false;
 	transaction_lock = false;
 
-	query->setupStepping(timeoutms, false);
+	query->setupStepping(timeoutms, true);
 
 #ifdef LOG_READ_QUERIES
 	active_query = new ScopedAddActiveQuery(query);
@@ -63,11 +63,26 @@ bool DatabaseCursor::reset()
 bool DatabaseCursor::next(db_single_result &res)
 {
 	res.clear();
+	return nextRow(&res);
+}
+
+bool DatabaseCursor::next()
+{
+	return nextRow(NULL);
+}
+
+bool DatabaseCursor::nextRow(db_single_result* res)
+{
+	was_restarted=false;
 	do
 	{
 		bool reset=false;
 		lastErr=query->step(res, timeoutms, tries, transaction_lock, reset);
-		//TODO handle reset (should not happen in WAL mode)
+		//TODO handle reset for next(res) (should not happen in WAL mode)
+		if(reset)
+		{
+			was_restarted=true;
+		}
 		if(lastErr==SQLITE_ROW)
 		{
 			return true;
@@ -84,6 +99,36 @@ bool DatabaseCursor::next(db_single_result &res)
 	return false;
 }
 
+bool DatabaseCursor::restarted()
+{
+	return was_restarted;
+}
+
+int DatabaseCursor::columnIndex(const char* name)
+{
+	return query->getColumnIndex(name);
+}
+
+int DatabaseCursor::getInt(int col)
+{
+	return query->getColumnInt(col);
+}
+
+int64 DatabaseCursor::getInt64(int col)
+{
+	return query->getColumnInt64(col);
+}
+
+std::string DatabaseCursor::getString(int col)
+{
+	return query->getColumnString(col);
+}
+
+const char* DatabaseCursor::getBlob(int col, size_t& size)
+{
+	return query->getColumnBlob(col, size);
+}
+
 bool DatabaseCursor::has_error(void)
 {
 	return _has_error;
@@ -15,6 +15,17 @@ public:
 
 	bool next(db_single_result &res);
 
+	bool next();
+
+	bool restarted();
+
+	int columnIndex(const char* name);
+
+	int getInt(int col);
+	int64 getInt64(int col);
+	std::string getString(int col);
+	const char* getBlob(int col, size_t& size);
+
 	bool reset();
 
 	bool has_error();
@@ -22,6 +33,8 @@ public:
 	virtual void shutdown();
 
 private:
+	bool nextRow(db_single_result* res);
+
 	CQuery *query;
 
 	bool transaction_lock;
@@ -30,6 +43,7 @@ private:
 	int lastErr;
 	bool _has_error;
 	bool is_shutdown;
+	bool was_restarted;
 
 #ifdef LOG_READ_QUERIES
 	ScopedAddActiveQuery *active_query;
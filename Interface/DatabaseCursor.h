@@ -8,6 +8,23 @@ class IDatabaseCursor
 public:
 	virtual bool next(db_single_result &res)=0;
 
+	//Steps to the next row without copying it into a db_single_result.
+	//Read the row with the typed column accessors below
+	virtual bool next()=0;
+
+	//True if the query had to be restarted from the first row
+	//during the last call to next()
+	virtual bool restarted()=0;
+
+	//Index of the result column with this name or -1
+	virtual int columnIndex(const char* name)=0;
+
+	virtual int getInt(int col)=0;
+	virtual int64 getInt64(int col)=0;
+	virtual std::string getString(int col)=0;
+	//Pointer is valid until the next call to next()
+	virtual const char* getBlob(int col, size_t& size)=0;
+
 	virtual bool has_error()=0;
 
 	virtual bool reset() = 0;
@@ -110,6 +110,16 @@ public:
 	virtual bool createThread(IThread *thread, const std::string& name=std::string(), CreateThreadFlags flags = CreateThreadFlags_None)=0;
 	virtual void setCurrentThreadName(const std::string& name) = 0;
 	virtual IPipe *createMemoryPipe(void)=0;
+
+	enum MemoryPipeType
+	{
+		MemoryPipeType_Queue=0,
+		//Bounded ring buffer. Only for one writing and one reading thread
+		MemoryPipeType_SpscRing=1
+	};
+
+	//ring_size is only used by MemoryPipeType_SpscRing. 0 for the default size
+	virtual IPipe *createMemoryPipe(MemoryPipeType type, size_t ring_size=0)=0;
 	virtual IThreadPool *getThreadPool(void)=0;
 	virtual ISettingsReader* createFileSettingsReader(const std::string& pFile)=0;
 	virtual ISettingsReader* createDBSettingsReader(THREAD_ID tid, DATABASE_ID pIdentifier, const std::string &pTable, const std::string &pSQL="")=0;
@@ -0,0 +1,413 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "MemoryRingPipe.h"
+#include "Server.h"
+#include <memory.h>
+#include <algorithm>
+
+namespace
+{
+	const size_t c_min_ring_size = 4096;
+	const _u32 c_frame_more = 0x80000000;
+}
+
+CMemoryRingPipe::CMemoryRingPipe(size_t ring_size)
+	: head(0), tail(0), num_elements(0), reader_waiting(false), writer_waiting(false),
+	has_error(false), frame_remaining(0), frame_more(false)
+{
+	size_t rsize = c_min_ring_size;
+	while (rsize < ring_size)
+	{
+		rsize *= 2;
+	}
+
+	ring.resize(rsize);
+	mask = rsize - 1;
+	max_frame_size = rsize / 4;
+
+	mutex = Server->createMutex();
+	read_cond = Server->createCondition();
+	write_cond = Server->createCondition();
+}
+
+CMemoryRingPipe::~CMemoryRingPipe(void)
+{
+	Server->destroy(mutex);
+	Server->destroy(read_cond);
+	Server->destroy(write_cond);
+}
+
+size_t CMemoryRingPipe::Read(char *buffer, size_t bsize, int timeoutms)
+{
+	if (frame_remaining == 0 && !frame_more)
+	{
+		if (!nextFrame(timeoutms))
+		{
+			return 0;
+		}
+	}
+
+	size_t read = 0;
+	while (read < bsize)
+	{
+		if (frame_remaining == 0)
+		{
+			if (!frame_more)
+			{
+				break;
+			}
+
+			if (!nextFrame(-1))
+			{
+				return read;
+			}
+			continue;
+		}
+
+		size_t toread = (std::min)(frame_remaining, bsize - read);
+		copyOut(head.load(std::memory_order_relaxed), buffer + read, toread);
+		consumed(toread);
+		frame_remaining -= toread;
+		read += toread;
+	}
+
+	if (frame_remaining == 0 && !frame_more)
+	{
+		--num_elements;
+	}
+
+	return read;
+}
+
+bool CMemoryRingPipe::Write(const char *buffer, size_t bsize, int timeoutms, bool flush)
+{
+	if (has_error)
+	{
+		return false;
+	}
+
+	size_t written = 0;
+	do
+	{
+		size_t towrite = (std::min)(bsize - written, max_frame_size);
+		bool more = written + towrite < bsize;
+
+		//Once the first frame is written the rest of the message has to follow
+		if (!waitWritable(sizeof(_u32) + towrite, written == 0 ? timeoutms : -1))
+		{
+			return false;
+		}
+
+		size_t pos = tail.load(std::memory_order_relaxed);
+		_u32 header = static_cast<_u32>(towrite) | (more ? c_frame_more : 0);
+		copyIn(pos, reinterpret_cast<char*>(&header), sizeof(header));
+		copyIn(pos + sizeof(header), buffer + written, towrite);
+
+		if (!more)
+		{
+			++num_elements;
+		}
+
+		tail.store(pos + sizeof(header) + towrite);
+		written += towrite;
+
+		//The reader may already wait for the next frame of this message
+		if (written > towrite)
+		{
+			wakeReader();
+		}
+	} while (written < bsize);
+
+	if (flush)
+	{
+		wakeReader();
+	}
+
+	return true;
+}
+
+size_t CMemoryRingPipe::Read(std::string *ret, int timeoutms)
+{
+	if (frame_remaining == 0 && !frame_more)
+	{
+		if (!nextFrame(timeoutms))
+		{
+			return 0;
+		}
+	}
+
+	ret->clear();
+
+	while (true)
+	{
+		if (frame_remaining > 0)
+		{
+			size_t off = ret->size();
+			ret->resize(off + frame_remaining);
+			copyOut(head.load(std::memory_order_relaxed), &(*ret)[off], frame_remaining);
+			consumed(frame_remaining);
+			frame_remaining = 0;
+		}
+
+		if (!frame_more)
+		{
+			break;
+		}
+
+		if (!nextFrame(-1))
+		{
+			return 0;
+		}
+	}
+
+	--num_elements;
+
+	return ret->size();
+}
+
+bool CMemoryRingPipe::Write(const std::string &str, int timeoutms, bool flush)
+{
+	return Write(str.data(), str.size(), timeoutms, flush);
+}
+
+bool CMemoryRingPipe::isWritable(int timeoutms)
+{
+	return waitWritable(sizeof(_u32) + 1, timeoutms);
+}
+
+bool CMemoryRingPipe::isReadable(int timeoutms)
+{
+	if (frame_remaining > 0 || frame_more)
+	{
+		return true;
+	}
+
+	return waitReadable(timeoutms);
+}
+
+bool CMemoryRingPipe::hasError(void)
+{
+	return has_error;
+}
+
+void CMemoryRingPipe::shutdown(void)
+{
+	IScopedLock lock(mutex);
+	has_error = true;
+	read_cond->notify_all();
+	write_cond->notify_all();
+}
+
+size_t CMemoryRingPipe::getNumElements(void)
+{
+	return num_elements;
+}
+
+size_t CMemoryRingPipe::getNumWaiters()
+{
+	return reader_waiting ? 1 : 0;
+}
+
+void CMemoryRingPipe::addThrottler(IPipeThrottler *throttler)
+{
+}
+
+void CMemoryRingPipe::addOutgoingThrottler(IPipeThrottler *throttler)
+{
+}
+
+void CMemoryRingPipe::addIncomingThrottler(IPipeThrottler *throttler)
+{
+}
+
+_i64 CMemoryRingPipe::getTransferedBytes(void)
+{
+	return 0;
+}
+
+void CMemoryRingPipe::resetTransferedBytes(void)
+{
+}
+
+bool CMemoryRingPipe::Flush(int timeoutms)
+{
+	wakeReader();
+	return true;
+}
+
+bool CMemoryRingPipe::waitReadable(int timeoutms)
+{
+	size_t pos = head.load(std::memory_order_relaxed);
+	if (tail.load() != pos)
+	{
+		return true;
+	}
+
+	if (timeoutms == 0)
+	{
+		return false;
+	}
+
+	IScopedLock lock(mutex);
+	int64 starttime = Server->getTimeMS();
+	while (true)
+	{
+		reader_waiting = true;
+
+		if (tail.load() != pos)
+		{
+			reader_waiting = false;
+			return true;
+		}
+
+		if (has_error)
+		{
+			reader_waiting = false;
+			return false;
+		}
+
+		if (timeoutms < 0)
+		{
+			read_cond->wait(&lock);
+		}
+		else
+		{
+			int64 passed = Server->getTimeMS() - starttime;
+			if (passed >= timeoutms)
+			{
+				reader_waiting = false;
+				return false;
+			}
+			read_cond->wait(&lock, timeoutms - static_cast<int>(passed));
+		}
+	}
+}
+
+bool CMemoryRingPipe::waitWritable(size_t needed, int timeoutms)
+{
+	size_t pos = tail.load(std::memory_order_relaxed);
+	if (ring.size() - (pos - head.load()) >= needed)
+	{
+		return true;
+	}
+
+	if (timeoutms == 0)
+	{
+		return false;
+	}
+
+	IScopedLock lock(mutex);
+	int64 starttime = Server->getTimeMS();
+	while (true)
+	{
+		writer_waiting = true;
+
+		if (ring.size() - (pos - head.load()) >= needed)
+		{
+			writer_waiting = false;
+			return true;
+		}
+
+		if (has_error)
+		{
+			writer_waiting = false;
+			return false;
+		}
+
+		//Unflushed writes may not have woken up the reader yet
+		if (reader_waiting)
+		{
+			read_cond->notify_one();
+		}
+
+		if (timeoutms < 0)
+		{
+			write_cond->wait(&lock);
+		}
+		else
+		{
+			int64 passed = Server->getTimeMS() - starttime;
+			if (passed >= timeoutms)
+			{
+				writer_waiting = false;
+				return false;
+			}
+			write_cond->wait(&lock, timeoutms - static_cast<int>(passed));
+		}
+	}
+}
+
+bool CMemoryRingPipe::nextFrame(int timeoutms)
+{
+	if (!waitReadable(timeoutms))
+	{
+		return false;
+	}
+
+	_u32 header;
+	copyOut(head.load(std::memory_order_relaxed), reinterpret_cast<char*>(&header), sizeof(header));
+	consumed(sizeof(header));
+
+	frame_remaining = header & ~c_frame_more;
+	frame_more = (header & c_frame_more) != 0;
+
+	return true;
+}
+
+void CMemoryRingPipe::consumed(size_t n)
+{
+	head.store(head.load(std::memory_order_relaxed) + n);
+
+	if (writer_waiting)
+	{
+		IScopedLock lock(mutex);
+		write_cond->notify_one();
+	}
+}
+
+void CMemoryRingPipe::wakeReader()
+{
+	if (reader_waiting)
+	{
+		IScopedLock lock(mutex);
+		read_cond->notify_one();
+	}
+}
+
+void CMemoryRingPipe::copyIn(size_t pos, const char* buf, size_t bsize)
+{
+	size_t idx = pos & mask;
+	size_t first = (std::min)(bsize, ring.size() - idx);
+	memcpy(&ring[idx], buf, first);
+	if (first < bsize)
+	{
+		memcpy(&ring[0], buf + first, bsize - first);
+	}
+}
+
+void CMemoryRingPipe::copyOut(size_t pos, char* buf, size_t bsize)
+{
+	size_t idx = pos & mask;
+	size_t first = (std::min)(bsize, ring.size() - idx);
+	memcpy(buf, &ring[idx], first);
+	if (first < bsize)
+	{
+		memcpy(buf + first, &ring[0], bsize - first);
+	}
+}
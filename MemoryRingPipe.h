@@ -0,0 +1,78 @@
+#ifndef MEMRINGPIPE_H_
+#define MEMRINGPIPE_H_
+
+#include "Interface/Pipe.h"
+#include "Interface/Mutex.h"
+#include "Interface/Condition.h"
+#include <atomic>
+#include <vector>
+
+/**
+* Bounded memory pipe for exactly one writing and one reading thread.
+* Messages are stored in place in a ring buffer (length prefixed, larger
+* messages are split into several frames), so no memory is allocated per
+* message. Reader and writer only synchronize via the mutex if one of them
+* has to wait. Writes with flush=false do not wake up a waiting reader
+* until the next flushed write, Flush() or the ring being full.
+*/
+class CMemoryRingPipe : public IPipe
+{
+public:
+	CMemoryRingPipe(size_t ring_size);
+	~CMemoryRingPipe(void);
+
+	virtual size_t Read(char *buffer, size_t bsize, int timeoutms);
+	virtual bool Write(const char *buffer, size_t bsize, int timeoutms, bool flush);
+	virtual size_t Read(std::string *ret, int timeoutms);
+	virtual bool Write(const std::string &str, int timeoutms, bool flush);
+
+	virtual bool isWritable(int timeoutms);
+	virtual bool isReadable(int timeoutms);
+
+	virtual bool hasError(void);
+
+	virtual void shutdown(void);
+
+	virtual size_t getNumElements(void);
+	virtual size_t getNumWaiters();
+
+	virtual void addThrottler(IPipeThrottler *throttler);
+	virtual void addOutgoingThrottler(IPipeThrottler *throttler);
+	virtual void addIncomingThrottler(IPipeThrottler *throttler);
+
+	virtual _i64 getTransferedBytes(void);
+	virtual void resetTransferedBytes(void);
+
+	virtual bool Flush(int timeoutms=-1);
+
+private:
+	bool waitReadable(int timeoutms);
+	bool waitWritable(size_t needed, int timeoutms);
+	bool nextFrame(int timeoutms);
+	void consumed(size_t n);
+	void wakeReader();
+
+	void copyIn(size_t pos, const char* buf, size_t bsize);
+	void copyOut(size_t pos, char* buf, size_t bsize);
+
+	std::vector<char> ring;
+	size_t mask;
+	size_t max_frame_size;
+
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+	std::atomic<size_t> num_elements;
+	std::atomic<bool> reader_waiting;
+	std::atomic<bool> writer_waiting;
+	std::atomic<bool> has_error;
+
+	//Only used by the reader
+	size_t frame_remaining;
+	bool frame_more;
+
+	IMutex *mutex;
+	ICondition *read_cond;
+	ICondition *write_cond;
+};
+
+#endif /*MEMRINGPIPE_H_*/
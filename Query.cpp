@@ -39,6 +39,7 @@
 #include "Database.h"
 #include "DatabaseCursor.h"
 #include <memory.h>
+#include <string.h>
 #include <algorithm>
 #include "stringtools.h"
 
@@ -345,7 +346,7 @@ db_results CQuery::Read(int *timeoutms)
 	do
 	{
 		bool reset=false;
-		err=step(res, timeoutms, tries, transaction_lock, reset);
+		err=step(&res, timeoutms, tries, transaction_lock, reset);
 		if(reset)
 		{
 			rows.clear();
@@ -385,7 +386,7 @@ namespace
 	}
 }
 
-int CQuery::step(db_single_result& res, int *timeoutms, int& tries, bool& transaction_lock, bool& reset)
+int CQuery::step(db_single_result* res, int *timeoutms, int& tries, bool& transaction_lock, bool& reset)
 {
 	int err=sqlite3_step(ps);
 	if( resultOkay(err) )
@@ -425,7 +426,7 @@ int CQuery::step(db_single_result& res, int *timeoutms, int& tries, bool& transa
 				}
 			}
 		}
-		else if( err==SQLITE_ROW )
+		else if( err==SQLITE_ROW && res!=NULL )
 		{
 			int column=0;
 			std::string column_name;
@@ -444,11 +445,11 @@ int CQuery::step(db_single_result& res, int *timeoutms, int& tries, bool& transa
 					data_size = sqlite3_column_bytes(ps, column);
 				}
 				std::string datastr(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data)+data_size);				
-				res.insert( std::pair<std::string, std::string>(column_name, datastr) );
+				res->insert( std::pair<std::string, std::string>(column_name, datastr) );
 				++column;
 			}
 		}
-		else
+		else if( err!=SQLITE_ROW )
 		{
 			Server->wait(1000);
 			if(timeoutms!=NULL && *timeoutms>=0)
@@ -465,6 +466,65 @@ int CQuery::step(db_single_result& res, int *timeoutms, int& tries, bool& transa
 	return err;
 }
 
+int CQuery::getColumnIndex(const char* name)
+{
+	int ncolumns=sqlite3_column_count(ps);
+	for(int column=0;column<ncolumns;++column)
+	{
+		const char* c_name=sqlite3_column_name(ps, column);
+		if(c_name!=NULL && strcmp(c_name, name)==0)
+		{
+			return column;
+		}
+	}
+	return -1;
+}
+
+int CQuery::getColumnInt(int col)
+{
+	if(col<0)
+		return 0;
+
+	return sqlite3_column_int(ps, col);
+}
+
+int64 CQuery::getColumnInt64(int col)
+{
+	if(col<0)
+		return 0;
+
+	return sqlite3_column_int64(ps, col);
+}
+
+std::string CQuery::getColumnString(int col)
+{
+	size_t size;
+	const char* data=getColumnBlob(col, size);
+	if(data==NULL)
+		return std::string();
+
+	return std::string(data, size);
+}
+
+const char* CQuery::getColumnBlob(int col, size_t& size)
+{
+	size=0;
+	if(col<0)
+		return NULL;
+
+	const void* data;
+	if(sqlite3_column_type(ps, col)==SQLITE_BLOB)
+	{
+		data=sqlite3_column_blob(ps, col);
+	}
+	else
+	{
+		data=sqlite3_column_text(ps, col);
+	}
+	size=static_cast<size_t>(sqlite3_column_bytes(ps, col));
+	return reinterpret_cast<const char*>(data);
+}
+
 IDatabaseCursor* CQuery::Cursor(int *timeoutms)
 {
 	if(cursor==NULL)
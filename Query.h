@@ -49,7 +49,13 @@ public:
 	void setupStepping(int *timeoutms, bool with_read_lock);
 	void shutdownStepping(int err, int *timeoutms, bool& transaction_lock);
 
-	int step(db_single_result& res, int *timeoutms, int& tries, bool& transaction_lock, bool& reset);
+	int step(db_single_result* res, int *timeoutms, int& tries, bool& transaction_lock, bool& reset);
+
+	int getColumnIndex(const char* name);
+	int getColumnInt(int col);
+	int64 getColumnInt64(int col);
+	std::string getColumnString(int col);
+	const char* getColumnBlob(int col, size_t& size);
 
 	bool resultOkay(int rc);
 
@@ -485,18 +485,20 @@ enum StatementType
 	StatementType_None
 };
 
-std::string return_blob(size_t tabs, std::string value_name, std::string sql_name, std::string res_idx, bool do_return)
+std::string column_getter(const std::string& type, const std::string& col)
 {
-	std::string ret;
-	static int nb = 0;
-	std::string tabss(tabs, '\t');
-	++nb;
-	ret+=tabss+value_name+"=res["+res_idx+"][\""+sql_name+"\"];\r\n";
-	if(do_return)
+	if(type=="int")
 	{
-		ret+=tabss+"return "+value_name+";\r\n";
+		return "cur->getInt("+col+")";
+	}
+	else if(type=="int64")
+	{
+		return "cur->getInt64("+col+")";
+	}
+	else
+	{
+		return "cur->getString("+col+")";
 	}
-	return ret;
 }
 
 AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedData& gen_data, bool check)
@@ -796,9 +798,15 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 
 	bool has_return=false;
 
+	std::string reset_code;
+	if(!params.empty())
+	{
+		reset_code="\t"+query_name+"->Reset();\r\n";
+	}
+
 	if(stmt_type==StatementType_Select)
 	{
-		code+="\tdb_results res="+query_name+"->Read();\r\n";
+		code+="\tIDatabaseCursor* cur="+query_name+"->Cursor();\r\n";
 	}
 	else if(stmt_type==StatementType_Delete
 		|| stmt_type==StatementType_Insert
@@ -817,9 +825,16 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 		}
 	}
 
-	if(!params.empty())
+	//Rows are read directly from the cursor. The query may only be
+	//reset after the cursor is done
+	std::string finish_code;
+	if(stmt_type==StatementType_Select)
 	{
-		code+="\t"+query_name+"->Reset();\r\n";
+		finish_code="\tcur->shutdown();\r\n"+reset_code;
+	}
+	else
+	{
+		code+=reset_code;
 	}
 
 	if(has_return)
@@ -858,55 +873,33 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 			}
 		}
 		code+="> ret;\r\n";
-		code+="\tret.resize(res.size());\r\n";
-		code+="\tfor(size_t i=0;i<res.size();++i)\r\n";
+		for(size_t i=0;i<return_types.size() && (use_struct || i==0);++i)
+		{
+			code+="\tint c_"+return_types[i].name+"=cur->columnIndex(\""+return_types[i].name+"\");\r\n";
+		}
+		code+="\twhile(cur->next())\r\n";
 		code+="\t{\r\n";
+		code+="\t\tif(cur->restarted())\r\n";
+		code+="\t\t{\r\n";
+		code+="\t\t\tret.clear();\r\n";
+		code+="\t\t}\r\n";
 		if(use_struct)
 		{
+			code+="\t\tret.push_back("+struct_name+"());\r\n";
 			if(gen_data.structures[struct_name].use_exist)
 			{
-				code+="\t\tret[i].exists=true;\r\n";
+				code+="\t\tret.back().exists=true;\r\n";
 			}
 			for(size_t i=0;i<return_types.size();++i)
 			{
-				if(return_types[i].type=="int")
-				{
-					code+="\t\tret[i]."+return_types[i].name+"=watoi(res[i][\""+return_types[i].name+"\"]);\r\n";
-				}
-				else if(return_types[i].type=="int64")
-				{
-					code+="\t\tret[i]."+return_types[i].name+"=watoi64(res[i][\""+return_types[i].name+"\"]);\r\n";
-				}
-				else if(return_types[i].type=="blob")
-				{
-					code+=return_blob(2, "ret[i]."+return_types[i].name, return_types[i].name, "i", false);
-				}
-				else
-				{
-					code+="\t\tret[i]."+return_types[i].name+"=res[i][\""+return_types[i].name+"\"];\r\n";
-				}			
+				code+="\t\tret.back()."+return_types[i].name+"="+column_getter(return_types[i].type, "c_"+return_types[i].name)+";\r\n";
 			}
 		}
 		else
 		{
 			if(!return_types.empty())
 			{
-				if(return_types[0].type=="int")
-				{
-					code+="\t\tret[i]=watoi(res[i][\""+return_types[0].name+"\"]);\r\n";
-				}
-				else if(return_types[0].type=="int64")
-				{
-					code+="\t\tret[i]=watoi64(res[i][\""+return_types[0].name+"\"]);\r\n";
-				}
-				else if(return_types[0].type=="blob")
-				{
-					code+=return_blob(2, "ret[i]", return_types[0].name, "i", false);
-				}
-				else
-				{
-					code+="\t\tret[i]=res[i][\""+return_types[0].name+"\"];\r\n";
-				}
+				code+="\t\tret.push_back("+column_getter(return_types[0].type, "c_"+return_types[0].name)+");\r\n";
 			}
 			else
 			{
@@ -914,6 +907,7 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 			}
 		}
 		code+="\t}\r\n";
+		code+=finish_code;
 		code+="\treturn ret;\r\n";
 	}
 	else if(!return_types.empty() && !use_raw)
@@ -959,7 +953,7 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 			}
 		}
 		code+=" };\r\n";
-		code+="\tif(!res.empty())\r\n";
+		code+="\tif(cur->next())\r\n";
 		code+="\t{\r\n";
 		if(use_exists)
 		{
@@ -969,65 +963,35 @@ AnnotatedCode generateSqlFunction(IDatabase* db, AnnotatedCode input, GeneratedD
 		{
 			for(size_t i=0;i<return_types.size();++i)
 			{
-				if(return_types[i].type=="int")
-				{
-					code+="\t\tret."+return_types[i].name+"=watoi(res[0][\""+return_types[i].name+"\"]);\r\n";
-				}
-				else if(return_types[i].type=="int64")
-				{
-					code+="\t\tret."+return_types[i].name+"=watoi64(res[0][\""+return_types[i].name+"\"]);\r\n";
-				}
-				else if(return_types[i].type=="blob")
-				{
-					code+=return_blob(2, "ret."+return_types[i].name, return_types[i].name, "0", false);
-				}
-				else
-				{
-					code+="\t\tret."+return_types[i].name+"=res[0][\""+return_types[i].name+"\"];\r\n";
-				}			
+				code+="\t\tret."+return_types[i].name+"="+column_getter(return_types[i].type, "cur->columnIndex(\""+return_types[i].name+"\")")+";\r\n";
 			}
 		}
 		else
 		{
-			if(return_types[0].type=="int")
-			{
-				code+="\t\tret.value=watoi(res[0][\""+return_types[0].name+"\"]);\r\n";
-			}
-			else if(return_types[0].type=="int64")
-			{
-				code+="\t\tret.value=watoi64(res[0][\""+return_types[0].name+"\"]);\r\n";
-			}
-			else if(return_types[0].type=="blob")
-			{
-				code+=return_blob(2, "ret.value", return_types[0].name, "0", false);
-			}
-			else
-			{
-				code+="\t\tret.value=res[0][\""+return_types[0].name+"\"];\r\n";
-			}
+			code+="\t\tret.value="+column_getter(return_types[0].type, "cur->columnIndex(\""+return_types[0].name+"\")")+";\r\n";
 		}
 		code+="\t}\r\n";
+		code+=finish_code;
 		code+="\treturn ret;\r\n";			
 	}
 	else if(return_types.size()==1)
 	{
-		code+="\tassert(!res.empty());\r\n";
-		if(return_types[0].type=="int")
-		{
-			code+="\treturn watoi(res[0][\""+return_types[0].name+"\"]);\r\n";
-		}
-		else if(return_types[0].type=="int64")
+		std::string type="std::string";
+		std::string default_value="std::string()";
+		if(return_types[0].type=="int" || return_types[0].type=="int64")
 		{
-			code+="\treturn watoi64(res[0][\""+return_types[0].name+"\"]);\r\n";
-		}
-		else if(return_types[0].type=="blob")
-		{
-			code+=return_blob(1, "tmp", return_types[0].name, "0", true);
-		}
-		else
-		{
-			code+="\treturn res[0][\""+return_types[0].name+"\"];\r\n";
+			type=return_types[0].type;
+			default_value="0";
 		}
+		code+="\tbool has_row=cur->next();\r\n";
+		code+="\tassert(has_row);\r\n";
+		code+="\t"+type+" ret=has_row ? "+column_getter(return_types[0].type, "cur->columnIndex(\""+return_types[0].name+"\")")+" : "+default_value+";\r\n";
+		code+=finish_code;
+		code+="\treturn ret;\r\n";
+	}
+	else
+	{
+		code+=finish_code;
 	}
 	code+="}";
 	return AnnotatedCode(input.annotations, code);
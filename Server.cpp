@@ -52,6 +52,8 @@
 #include "file_memory.h"
 #include "utf8/utf8.h"
 #include "MemoryPipe.h"
+#include "MemoryRingPipe.h"
+#include "AsyncLog.h"
 #include "MemorySettingsReader.h"
 #include "Database.h"
 #include "SQLiteFactory.h"
@@ -203,6 +205,8 @@ CServer::CServer()
 
 	log_console_time = true;
 
+	async_log = NULL;
+
 #ifdef _WIN32
 	initialize_GetTickCount64();
 	log_rotation_size = 20*1024*1024; //20MB
@@ -273,6 +277,13 @@ void CServer::destroyDatabases(THREAD_ID tid)
 
 CServer::~CServer()
 {
+	if(async_log!=NULL)
+	{
+		//Not deleted, other threads may still log. stop() frees the
+		//log buffers apart from the ones of still running threads
+		async_log->stop();
+	}
+
 	if(getServerParameter("leak_check")!="true") //minimal cleanup
 	{
 		return;
@@ -410,46 +421,22 @@ void CServer::setServerParameter(const std::string &key, const std::string &valu
 
 void CServer::Log( const std::string &pStr, int LogLevel)
 {
+	if( async_log!=NULL
+		&& (loglevel <=LogLevel || has_circular_log_buffer)
+		&& async_log->log(pStr, LogLevel) )
+	{
+		return;
+	}
+
 	if( loglevel <=LogLevel )
 	{
 		IScopedLock lock(log_mutex);
 
-		time_t rawtime;		
 		char buffer [100];
-		time ( &rawtime );
-#ifdef _WIN32
-		struct tm  timeinfo;
-		localtime_s(&timeinfo, &rawtime);
-		strftime (buffer,100,"%Y-%m-%d %X: ",&timeinfo);
-#else
-		struct tm *timeinfo;
-		timeinfo = localtime ( &rawtime );
-		strftime (buffer,100,"%Y-%m-%d %X: ",timeinfo);
-#endif	
+		formatLogTime(buffer, sizeof(buffer));
 
-		if(log_console_time)
-		{
-			std::cout << buffer;
-		}
-
-		if( LogLevel==LL_ERROR )
-		{
-			std::cout << "ERROR: " << pStr << std::endl;
-			if(logfile_a)
-				logfile << buffer << "ERROR: " << pStr << std::endl;
-		}
-		else if( LogLevel==LL_WARNING )
-		{
-			std::cout << "WARNING: " << pStr << std::endl;
-			if(logfile_a)
-				logfile<< buffer << "WARNING: " << pStr << std::endl;
-		}
-		else
-		{
-			std::cout << pStr << std::endl;		
-			if(logfile_a)
-				logfile << buffer << pStr << std::endl;
-		}
+		writeLogLine(buffer, pStr, LogLevel);
+		std::cout.flush();
 		
 		if(logfile_a)
 		{
@@ -461,14 +448,114 @@ void CServer::Log( const std::string &pStr, int LogLevel)
 
 		if(has_circular_log_buffer)
 		{
-			logToCircularBuffer(pStr, LogLevel);
+			logToCircularBuffer(pStr, LogLevel, getTimeSeconds());
 		}
 	}
 	else if(has_circular_log_buffer)
 	{
 		IScopedLock lock(log_mutex);
 
-		logToCircularBuffer(pStr, LogLevel);
+		logToCircularBuffer(pStr, LogLevel, getTimeSeconds());
+	}
+}
+
+void CServer::formatLogTime(char* buffer, size_t bsize)
+{
+	time_t rawtime;
+	time ( &rawtime );
+#ifdef _WIN32
+	struct tm  timeinfo;
+	localtime_s(&timeinfo, &rawtime);
+	strftime (buffer,bsize,"%Y-%m-%d %X: ",&timeinfo);
+#else
+	struct tm timeinfo;
+	localtime_r(&rawtime, &timeinfo);
+	strftime (buffer,bsize,"%Y-%m-%d %X: ",&timeinfo);
+#endif
+}
+
+void CServer::writeLogLine(const char* timestr, const std::string& msg, int level)
+{
+	if(log_console_time)
+	{
+		std::cout << timestr;
+	}
+
+	const char* prefix = "";
+	if( level==LL_ERROR )
+	{
+		prefix = "ERROR: ";
+	}
+	else if( level==LL_WARNING )
+	{
+		prefix = "WARNING: ";
+	}
+
+	std::cout << prefix << msg << '\n';
+	if(logfile_a)
+		logfile << timestr << prefix << msg << '\n';
+}
+
+void CServer::setLogAsync(size_t buffer_size, int flush_interval_ms)
+{
+	if(async_log!=NULL)
+	{
+		return;
+	}
+
+	async_log = new CAsyncLog(this, buffer_size, flush_interval_ms);
+	createThread(async_log, "log writer");
+}
+
+void CServer::writeLogBatch(const std::vector<SAsyncLogEntry>& entries, size_t n_entries, size_t dropped)
+{
+	IScopedLock lock(log_mutex);
+
+	//One timestamp per batch
+	char buffer [100];
+	formatLogTime(buffer, sizeof(buffer));
+	int64 times = getTimeSeconds();
+
+	bool written = false;
+	for(size_t i=0;i<n_entries;++i)
+	{
+		const SAsyncLogEntry& entry = entries[i];
+		if( loglevel <=entry.loglevel )
+		{
+			writeLogLine(buffer, entry.msg, entry.loglevel);
+			written = true;
+		}
+
+		if(has_circular_log_buffer)
+		{
+			logToCircularBuffer(entry.msg, entry.loglevel, times);
+		}
+	}
+
+	if(dropped>0)
+	{
+		std::string msg = "Log buffer full. Dropped "+convert(dropped)+" log messages";
+		writeLogLine(buffer, msg, LL_WARNING);
+		written = true;
+
+		if(has_circular_log_buffer)
+		{
+			logToCircularBuffer(msg, LL_WARNING, times);
+		}
+	}
+
+	if(!written)
+	{
+		return;
+	}
+
+	std::cout.flush();
+
+	if(logfile_a)
+	{
+		logfile.flush();
+
+		rotateLogfile();
 	}
 }
 
@@ -1421,6 +1508,16 @@ IPipe *CServer::createMemoryPipe(void)
 	return new CMemoryPipe;
 }
 
+IPipe *CServer::createMemoryPipe(MemoryPipeType type, size_t ring_size)
+{
+	if (type == MemoryPipeType_SpscRing)
+	{
+		return new CMemoryRingPipe(ring_size>0 ? ring_size : 1024*1024);
+	}
+
+	return new CMemoryPipe;
+}
+
 #ifdef _WIN32
 struct SThreadInfo
 {
@@ -2193,7 +2290,7 @@ std::vector<SCircularLogEntry> CServer::getCicularLogBuffer( size_t minid )
 	return std::vector<SCircularLogEntry>();
 }
 
-void CServer::logToCircularBuffer(const std::string& msg, int loglevel)
+void CServer::logToCircularBuffer(const std::string& msg, int loglevel, int64 times)
 {
 	if(circular_log_buffer.empty())
 		return;
@@ -2203,7 +2300,7 @@ void CServer::logToCircularBuffer(const std::string& msg, int loglevel)
 	entry.utf8_msg=msg;
 	entry.loglevel=loglevel;
 	entry.id=circular_log_buffer_id++;
-	entry.time=Server->getTimeSeconds();
+	entry.time=times;
 
 	circular_log_buffer_idx=(circular_log_buffer_idx+1)%circular_log_buffer.size();
 }
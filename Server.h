@@ -33,6 +33,8 @@ class CSessionMgr;
 class CServiceAcceptor;
 class CThreadPool;
 class IOutputStream;
+class CAsyncLog;
+struct SAsyncLogEntry;
 
 struct SDatabase
 {
@@ -107,6 +109,7 @@ public:
 	virtual ISharedMutex* createSharedMutex();
 	virtual ICondition* createCondition(void);
 	virtual IPipe *createMemoryPipe(void);
+	virtual IPipe *createMemoryPipe(MemoryPipeType type, size_t ring_size=0);
 	virtual bool createThread(IThread *thread, const std::string& name = std::string(), CreateThreadFlags flags = CreateThreadFlags_None);
 	virtual void setCurrentThreadName(const std::string& name);
 	virtual IThreadPool *getThreadPool(void);
@@ -211,6 +214,10 @@ public:
 
 	void setLogConsoleTime(bool b);
 
+	void setLogAsync(size_t buffer_size, int flush_interval_ms);
+
+	void writeLogBatch(const std::vector<SAsyncLogEntry>& entries, size_t n_entries, size_t dropped);
+
 #ifdef _WIN32
 	void setSocketWindowSizes(int p_send_window_size, int p_recv_window_size);
 
@@ -223,7 +230,10 @@ public:
 
 private:
 
-	void logToCircularBuffer(const std::string& msg, int loglevel);
+	void logToCircularBuffer(const std::string& msg, int loglevel, int64 times);
+
+	void formatLogTime(char* buffer, size_t bsize);
+	void writeLogLine(const char* timestr, const std::string& msg, int level);
 
 	bool UnloadDLLs(void);
 	void UnloadDLLs2(void);
@@ -322,6 +332,8 @@ private:
 
 	size_t log_rotation_files;
 
+	CAsyncLog* async_log;
+
 #ifdef _WIN32
 	int send_window_size;
 	int recv_window_size;
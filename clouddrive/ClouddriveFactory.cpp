@@ -20,6 +20,7 @@
 #include "CloudFile.h"
 #include "KvStoreFrontend.h"
 #include "KvStoreBackendS3.h"
+#include "KvStoreBackendDir.h"
 #include "../cryptoplugin/cryptopp_inc.h"
 
 using namespace CryptoPPCompat;
@@ -61,24 +62,31 @@ IFile* ClouddriveFactory::createCloudFile(IBackupFileSystem* cachefs, CloudSetti
 
 	IKvStoreBackend* backend = createBackend(cachefs, aes_key, settings);
 
+	std::string cache_db_path;
 	if (settings.endpoint == CloudEndpoint::S3)
 	{
-		try
-		{
-			online_kv_store = new KvStoreFrontend(settings.s3_settings.cache_db_path,
-				backend, !check_only, std::string(), std::string(), nullptr,
-				std::string(), false, false, cachefs);
-		}
-		catch (const std::exception&)
-		{
-			return nullptr;
-		}
+		cache_db_path = settings.s3_settings.cache_db_path;
+	}
+	else if (settings.endpoint == CloudEndpoint::Dir)
+	{
+		cache_db_path = settings.dir_settings.cache_db_path;
 	}
 	else
 	{
 		return nullptr;
 	}
 
+	try
+	{
+		online_kv_store = new KvStoreFrontend(cache_db_path,
+			backend, !check_only, std::string(), std::string(), nullptr,
+			std::string(), false, false, cachefs);
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+
 	return new CloudFile(std::string(), cachefs,
 		settings.size, settings.size, online_kv_store, aes_key,
 		get_compress_encrypt_factory(), settings.verify_cache, settings.cpu_multiplier,
@@ -111,6 +119,16 @@ IKvStoreBackend* ClouddriveFactory::createBackend(IBackupFileSystem* cachefs,
 
 		return s3_backend;
 	}
+	else if (settings.endpoint == CloudEndpoint::Dir)
+	{
+		return new KvStoreBackendDir(aes_key,
+			settings.dir_settings.path,
+			get_compress_encrypt_factory(),
+			static_cast<unsigned int>(settings.submit_compression),
+			static_cast<unsigned int>(settings.metadata_submit_compression),
+			settings.dir_settings.num_del_parallel,
+			settings.dir_settings.ordered_del);
+	}
 
 	return nullptr;
 }
@@ -11,7 +11,8 @@ class IClouddriveFactory : public IPlugin
 public:
 	enum class CloudEndpoint
 	{
-		S3
+		S3,
+		Dir
 	};
 
 	enum class CompressionMethod
@@ -37,6 +38,14 @@ public:
 		std::string cache_db_path;
 	};
 
+	struct CloudSettingsDir
+	{
+		std::string path;
+		std::string cache_db_path;
+		size_t num_del_parallel = 4;
+		bool ordered_del = false;
+	};
+
 	struct CloudSettings
 	{
 		int64 size = -1;
@@ -65,6 +74,7 @@ public:
 		
 		CloudEndpoint endpoint;
 		CloudSettingsS3 s3_settings;
+		CloudSettingsDir dir_settings;
 	};
 
 	virtual bool checkConnectivity(CloudSettings settings,
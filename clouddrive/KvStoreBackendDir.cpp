@@ -0,0 +1,529 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2021 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "KvStoreBackendDir.h"
+#include "../Interface/File.h"
+#include "../Interface/Server.h"
+#include "../Interface/Types.h"
+#include "../stringtools.h"
+#include "../urbackupcommon/os_functions.h"
+#include "../urbackupcommon/events.h"
+#include "../md5.h"
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+namespace
+{
+	const char* tmp_ext = ".new";
+
+	std::string escapeKey(const std::string& key)
+	{
+		std::string ret;
+		ret.reserve(key.size());
+		for (size_t i = 0; i < key.size(); ++i)
+		{
+			char ch = key[i];
+			if ((ch >= 'a' && ch <= 'z')
+				|| (ch >= 'A' && ch <= 'Z')
+				|| (ch >= '0' && ch <= '9')
+				|| ch == '_' || ch == '-')
+			{
+				ret += ch;
+			}
+			else
+			{
+				ret += "%" + bytesToHex(reinterpret_cast<const unsigned char*>(&ch), 1);
+			}
+		}
+		return ret;
+	}
+
+	std::string unescapeKey(const std::string& fn)
+	{
+		std::string ret;
+		ret.reserve(fn.size());
+		for (size_t i = 0; i < fn.size(); ++i)
+		{
+			if (fn[i] == '%'
+				&& i + 2 < fn.size())
+			{
+				ret += hexToBytes(fn.substr(i + 1, 2));
+				i += 2;
+			}
+			else
+			{
+				ret += fn[i];
+			}
+		}
+		return ret;
+	}
+}
+
+KvStoreBackendDir::KvStoreBackendDir(const std::string& encryption_key, const std::string& rootpath,
+	ICompressEncryptFactory* compress_encrypt_factory, unsigned int comp_method, unsigned int comp_method_metadata,
+	size_t n_del_parallel, bool p_ordered_del)
+	: encryption_key(encryption_key), rootpath(rootpath),
+	compress_encrypt_factory(compress_encrypt_factory), online_kv_store(nullptr),
+	comp_method(comp_method), comp_method_metadata(comp_method_metadata),
+	n_del_parallel((std::max)(static_cast<size_t>(1), n_del_parallel)), p_ordered_del(p_ordered_del),
+	n_unsynced(0), uploaded_bytes(0), downloaded_bytes(0)
+{
+	if (!os_directory_exists(rootpath)
+		&& !os_create_dir_recursive(rootpath))
+	{
+		Server->Log("Error creating object directory \"" + rootpath + "\". " + os_last_error_str(), LL_ERROR);
+	}
+}
+
+std::string KvStoreBackendDir::keyPath(const std::string& key)
+{
+	std::string md5sum = Server->GenerateHexMD5(key);
+	return rootpath + os_file_sep() + md5sum.substr(0, 2) + os_file_sep() + md5sum.substr(2, 2)
+		+ os_file_sep() + escapeKey(key);
+}
+
+bool KvStoreBackendDir::copyToFile(IFile* src, int64 offset, IFile* dst, bool allow_error_event)
+{
+	std::vector<char> buffer;
+	buffer.resize(512 * 1024);
+
+	int64 pos = offset;
+	while (true)
+	{
+		bool has_read_error = false;
+		_u32 read = src->Read(pos, buffer.data(), static_cast<_u32>(buffer.size()), &has_read_error);
+
+		if (has_read_error)
+		{
+			std::string syserr = os_last_error_str();
+			Server->Log("Error reading from file \"" + src->getFilename() + "\" at position " + convert(pos) + ". " + syserr, LL_ERROR);
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error reading from file",
+					"Error reading from file \"" + src->getFilename() + "\". " + syserr, LL_ERROR);
+			}
+			return false;
+		}
+
+		if (read == 0)
+		{
+			return true;
+		}
+
+		if (dst->Write(buffer.data(), read) != read)
+		{
+			std::string syserr = os_last_error_str();
+			Server->Log("Error writing to file \"" + dst->getFilename() + "\". " + syserr, LL_ERROR);
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error writing to file",
+					"Error writing to file \"" + dst->getFilename() + "\". " + syserr, LL_ERROR);
+			}
+			return false;
+		}
+
+		pos += read;
+	}
+}
+
+bool KvStoreBackendDir::get( const std::string& key, const std::string& md5sum,
+		unsigned int flags, bool allow_error_event, IFsFile* ret_file, std::string& ret_md5sum, unsigned int& get_status)
+{
+	assert(ret_file!=nullptr);
+	get_status=0;
+
+	std::string expected_md5sum = get_md5sum(md5sum);
+	std::string path = keyPath(key);
+
+	std::unique_ptr<IFile> obj_file(Server->openFile(path, MODE_READ_SEQUENTIAL));
+
+	if (obj_file.get() == nullptr)
+	{
+		std::string syserr = os_last_error_str();
+		if (!FileExists(path))
+		{
+			Server->Log("Key " + key + " not found", LL_INFO);
+			get_status |= IKvStoreBackend::GetStatusNotFound;
+
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Object not found",
+					"Object " + key + " not found at \"" + path + "\"", LL_ERROR);
+			}
+		}
+		else
+		{
+			Server->Log("Error opening object file \"" + path + "\". " + syserr, LL_ERROR);
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error opening object file",
+					"Error opening object file \"" + path + "\". " + syserr, LL_ERROR);
+			}
+		}
+		return false;
+	}
+
+	if (!(flags & IKvStoreBackend::GetDecrypted))
+	{
+		Server->Log("Retrieving object " + key + " and not decrypting", LL_DEBUG);
+	}
+	else
+	{
+		Server->Log("Retrieving object " + key, LL_DEBUG);
+	}
+
+	std::unique_ptr<IDecryptAndDecompress> decrypt_and_decompress;
+
+	if (flags & IKvStoreBackend::GetDecrypted)
+	{
+		decrypt_and_decompress.reset(compress_encrypt_factory->createDecryptAndDecompress(encryption_key, ret_file));
+	}
+
+	std::vector<char> buffer;
+	buffer.resize(512 * 1024);
+
+	MD5 md_check;
+	while (true)
+	{
+		bool has_read_error = false;
+		_u32 read = obj_file->Read(buffer.data(), static_cast<_u32>(buffer.size()), &has_read_error);
+
+		if (has_read_error)
+		{
+			std::string syserr = os_last_error_str();
+			Server->Log("Error reading object file \"" + path + "\". " + syserr, LL_ERROR);
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error reading object file",
+					"Error reading object file \"" + path + "\". " + syserr, LL_ERROR);
+			}
+			return false;
+		}
+
+		if (read == 0)
+		{
+			break;
+		}
+
+		downloaded_bytes += read;
+
+		if (decrypt_and_decompress.get() != nullptr
+			&& !decrypt_and_decompress->put(buffer.data(), read))
+		{
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error decrypting and compressing",
+					"Error decrypting and decompressing object " + key + ". Last errors:\n" + extractLastLogErrors(), LL_ERROR);
+			}
+			Server->Log("Error decrypting and decompressing", LL_ERROR);
+			return false;
+		}
+		else if (decrypt_and_decompress.get() == nullptr)
+		{
+			md_check.update(reinterpret_cast<unsigned char*>(buffer.data()), read);
+			if (ret_file->Write(buffer.data(), read) != read)
+			{
+				std::string syserr = os_last_error_str();
+				Server->Log("Error writing to result file. " + syserr, LL_ERROR);
+				if (allow_error_event)
+				{
+					addSystemEvent("dir_backend",
+						"Error writing to result file",
+						"Error writing to result file. " + syserr, LL_ERROR);
+				}
+				return false;
+			}
+		}
+	}
+
+	if (decrypt_and_decompress.get() != nullptr)
+	{
+		if (!decrypt_and_decompress->finalize())
+		{
+			Server->Log("Error finalizing decryption of object " + key, LL_ERROR);
+			if (allow_error_event)
+			{
+				addSystemEvent("dir_backend",
+					"Error decrypting object",
+					"Error finalizing decryption of object " + key, LL_ERROR);
+			}
+			return false;
+		}
+
+		ret_md5sum = hexToBytes(decrypt_and_decompress->md5sum());
+	}
+	else
+	{
+		md_check.finalize();
+		ret_md5sum.assign(reinterpret_cast<char*>(md_check.raw_digest_int()), 16);
+	}
+
+	if (!expected_md5sum.empty()
+		&& expected_md5sum != ret_md5sum)
+	{
+		Server->Log("Calculated md5sum of object differs from expected md5sum for object " + key
+			+ ". Calculated=" + bytesToHex(ret_md5sum) + " Expected=" + bytesToHex(expected_md5sum), LL_ERROR);
+		if (allow_error_event)
+		{
+			addSystemEvent("dir_backend",
+				"Calculated md5sum differs from expected",
+				"Calculated md5sum of object differs from expected md5sum for object " + key
+				+ ". Calculated=" + bytesToHex(ret_md5sum) + " Expected=" + bytesToHex(expected_md5sum), LL_ERROR);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool KvStoreBackendDir::list( IListCallback* callback )
+{
+	bool has_error = false;
+	std::vector<SFile> shards1 = getFiles(rootpath, &has_error);
+	if (has_error)
+	{
+		Server->Log("Error listing object directory \"" + rootpath + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	for (const SFile& shard1 : shards1)
+	{
+		if (!shard1.isdir)
+			continue;
+
+		std::string shard1_path = rootpath + os_file_sep() + shard1.name;
+		std::vector<SFile> shards2 = getFiles(shard1_path, &has_error);
+		if (has_error)
+		{
+			Server->Log("Error listing object directory \"" + shard1_path + "\". " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+
+		for (const SFile& shard2 : shards2)
+		{
+			if (!shard2.isdir)
+				continue;
+
+			std::string shard2_path = shard1_path + os_file_sep() + shard2.name;
+			std::vector<SFile> objects = getFiles(shard2_path, &has_error);
+			if (has_error)
+			{
+				Server->Log("Error listing object directory \"" + shard2_path + "\". " + os_last_error_str(), LL_ERROR);
+				return false;
+			}
+
+			for (const SFile& obj : objects)
+			{
+				if (obj.isdir
+					|| next(obj.name, obj.name.size() - (std::min)(obj.name.size(), strlen(tmp_ext)), tmp_ext))
+					continue;
+
+				if (!callback->onlineItem(unescapeKey(obj.name), std::string(), obj.size, obj.last_modified * 1000))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool KvStoreBackendDir::put( const std::string& key, IFsFile* src,
+		unsigned int flags, bool allow_error_event, std::string& md5sum, int64& compressed_size)
+{
+	src->Seek(0);
+
+	unsigned int curr_comp_method = (flags & IKvStoreBackend::GetMetadata) > 0 ? comp_method_metadata
+		: comp_method;
+
+	std::string path = keyPath(key);
+	std::string tmp_path = path + tmp_ext;
+
+	IFile* obj_file = Server->openFile(tmp_path, MODE_WRITE);
+	if (obj_file == nullptr)
+	{
+		os_create_dir_recursive(ExtractFilePath(path, os_file_sep()));
+		obj_file = Server->openFile(tmp_path, MODE_WRITE);
+	}
+
+	if (obj_file == nullptr)
+	{
+		std::string syserr = os_last_error_str();
+		Server->Log("Error opening object file \"" + tmp_path + "\". " + syserr, LL_ERROR);
+		if (allow_error_event)
+		{
+			addSystemEvent("dir_backend",
+				"Error opening object file",
+				"Error opening object file \"" + tmp_path + "\". " + syserr, LL_ERROR);
+		}
+		return false;
+	}
+
+	ScopedDeleteFile delete_tmp_file(obj_file);
+
+	std::string local_md5;
+	if (!(flags & IKvStoreBackend::PutAlreadyCompressedEncrypted))
+	{
+		std::unique_ptr<ICompressAndEncrypt> compress_encrypt(compress_encrypt_factory->createCompressAndEncrypt(encryption_key,
+			src, online_kv_store, curr_comp_method));
+
+		std::vector<char> buffer;
+		buffer.resize(512 * 1024);
+		while (true)
+		{
+			size_t read = compress_encrypt->read(buffer.data(), buffer.size());
+
+			if (read == std::string::npos)
+			{
+				Server->Log("Error compressing and encrypting (dir)", LL_ERROR);
+				return false;
+			}
+
+			if (read == 0)
+			{
+				break;
+			}
+
+			if (obj_file->Write(buffer.data(), static_cast<_u32>(read)) != read)
+			{
+				std::string syserr = os_last_error_str();
+				Server->Log("Error writing to object file \"" + tmp_path + "\". " + syserr, LL_ERROR);
+				if (allow_error_event)
+				{
+					addSystemEvent("dir_backend",
+						"Error writing to object file",
+						"Error writing to object file \"" + tmp_path + "\". " + syserr, LL_ERROR);
+				}
+				return false;
+			}
+		}
+
+		local_md5 = compress_encrypt->md5sum();
+	}
+	else
+	{
+		local_md5.resize(16);
+		if (src->Read(0, &local_md5[0], static_cast<_u32>(local_md5.size())) != local_md5.size())
+		{
+			local_md5.clear();
+		}
+
+		if (!copyToFile(src, 16, obj_file, allow_error_event))
+		{
+			return false;
+		}
+	}
+
+	compressed_size = obj_file->Size();
+
+	Server->Log("Stored object " + key + ". Size=" + convert(compressed_size), LL_DEBUG);
+
+	delete_tmp_file.release();
+	Server->destroy(obj_file);
+
+	if (!os_rename_file(tmp_path, path))
+	{
+		std::string syserr = os_last_error_str();
+		Server->Log("Error renaming object file \"" + tmp_path + "\" to \"" + path + "\". " + syserr, LL_ERROR);
+		if (allow_error_event)
+		{
+			addSystemEvent("dir_backend",
+				"Error renaming object file",
+				"Error renaming object file \"" + tmp_path + "\" to \"" + path + "\". " + syserr, LL_ERROR);
+		}
+		Server->deleteFile(tmp_path);
+		return false;
+	}
+
+	++n_unsynced;
+	uploaded_bytes += compressed_size;
+	md5sum = local_md5;
+
+	return true;
+}
+
+bool KvStoreBackendDir::del(key_next_fun_t key_next_fun,
+		locinfo_next_fun_t locinfo_next_fun,
+		bool background_queue)
+{
+	std::string key;
+	while (key_next_fun(IKvStoreBackend::key_next_action_t::next, &key))
+	{
+		if (locinfo_next_fun != nullptr)
+		{
+			std::string locinfo;
+			if (locinfo_next_fun(IKvStoreBackend::key_next_action_t::next, &locinfo))
+				break;
+		}
+
+		std::string path = keyPath(key);
+		if (!Server->deleteFile(path)
+			&& FileExists(path))
+		{
+			Server->Log("Deleting object " + key + " at \"" + path + "\" failed. " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+
+		++n_unsynced;
+	}
+
+	return true;
+}
+
+void KvStoreBackendDir::setFrontend( IOnlineKvStore* online_kv_store , bool do_init)
+{
+	this->online_kv_store = online_kv_store;
+}
+
+bool KvStoreBackendDir::sync(bool sync_test, bool background_queue)
+{
+	int64 curr_unsynced = n_unsynced.exchange(0);
+
+	if (curr_unsynced == 0)
+	{
+		return true;
+	}
+
+	//One file system sync for all objects written or deleted since the last sync
+	if (!os_sync(rootpath))
+	{
+		Server->Log("Syncing object directory \"" + rootpath + "\" failed. " + os_last_error_str(), LL_ERROR);
+		n_unsynced += curr_unsynced;
+		return false;
+	}
+
+	return true;
+}
+
+bool KvStoreBackendDir::check_deleted(const std::string& key, const std::string& locinfo)
+{
+	return !FileExists(keyPath(key));
+}
+
+std::string KvStoreBackendDir::meminfo()
+{
+	return "##KvStoreBackendDir:\n  unsynced: " + convert(n_unsynced.load()) + "\n";
+}
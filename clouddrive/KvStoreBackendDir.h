@@ -0,0 +1,105 @@
+#pragma once
+#include <memory>
+#include <atomic>
+#include "IKvStoreBackend.h"
+#include "ICompressEncrypt.h"
+#include "../common/relaxed_atomic.h"
+
+class IOnlineKvStore;
+
+/**
+* Stores the objects as files in a directory, e.g. on local storage or a
+* NFS mount. Objects are sharded into two directory levels by the md5 of
+* their key. A put writes to a temporary file and renames it into place
+* without flushing it, sync() then flushes all puts and deletes since the
+* last sync with one file system sync.
+*/
+class KvStoreBackendDir : public IKvStoreBackend
+{
+public:
+	KvStoreBackendDir(const std::string& encryption_key, const std::string& rootpath,
+		ICompressEncryptFactory* compress_encrypt_factory, unsigned int comp_method, unsigned int comp_method_metadata,
+		size_t n_del_parallel, bool p_ordered_del);
+
+	virtual bool get( const std::string& key, const std::string& md5sum,
+				unsigned int flags, bool allow_error_event, IFsFile* ret_file, std::string& ret_md5sum, unsigned int& get_status);
+
+	virtual bool list( IListCallback* callback );
+
+	virtual bool put( const std::string& key, IFsFile* src,
+				unsigned int flags, bool allow_error_event, std::string& md5sum,
+				int64& compressed_size) override;
+
+	virtual bool del(key_next_fun_t key_next_fun,
+		bool background_queue) {
+		return del(key_next_fun, nullptr, background_queue);
+	}
+
+	virtual bool del(key_next_fun_t key_next_fun,
+		locinfo_next_fun_t locinfo_next_fun,
+		bool background_queue);
+
+	virtual size_t max_del_size() { return 1000; }
+
+	virtual size_t num_del_parallel() { return n_del_parallel; }
+
+	virtual size_t num_scrub_parallel() { return n_del_parallel; };
+
+	virtual void setFrontend(IOnlineKvStore* online_kv_store, bool do_init);
+
+	virtual bool sync(bool sync_test, bool background_queue);
+
+	virtual bool is_put_sync() { return false; }
+
+	virtual bool has_transactions() { return false; }
+
+	virtual bool prefer_sequential_read() { return false; }
+
+	virtual bool del_with_location_info() { return false; }
+
+	virtual bool ordered_del() { return p_ordered_del; }
+
+	virtual bool can_read_unsynced() {
+		return true;
+	}
+
+	virtual std::string meminfo();
+
+	virtual bool check_deleted(const std::string& key, const std::string& locinfo);
+
+	virtual bool need_curr_del(){ return false; }
+
+	virtual int64 get_uploaded_bytes() {
+		return uploaded_bytes;
+	}
+
+	virtual int64 get_downloaded_bytes() {
+		return downloaded_bytes;
+	}
+
+	virtual bool want_put_metadata() { return false; }
+
+	virtual bool fast_write_retry() { return true; }
+
+private:
+	std::string keyPath(const std::string& key);
+
+	bool copyToFile(IFile* src, int64 offset, IFile* dst, bool allow_error_event);
+
+	std::string encryption_key;
+	std::string rootpath;
+
+	ICompressEncryptFactory* compress_encrypt_factory;
+	IOnlineKvStore* online_kv_store;
+	unsigned int comp_method;
+	unsigned int comp_method_metadata;
+
+	size_t n_del_parallel;
+	bool p_ordered_del;
+
+	std::atomic<int64> n_unsynced;
+
+	relaxed_atomic<int64> uploaded_bytes;
+
+	relaxed_atomic<int64> downloaded_bytes;
+};
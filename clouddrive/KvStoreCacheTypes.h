@@ -0,0 +1,53 @@
+#pragma once
+#include "../Interface/Types.h"
+#include <stddef.h>
+
+class IFsFile;
+
+//Values of the TransactionalKvStore lru caches
+
+struct SKvCacheVal
+{
+	SKvCacheVal()
+		: dirty(false), chances(0)
+	{}
+
+	bool dirty : 1;
+	unsigned char chances : 7;
+};
+
+struct SFdKey
+{
+	SFdKey(IFsFile* fd, int64 size, bool read_only)
+		: fd(fd), size(size), read_only(read_only), refcount(1)
+	{
+	}
+
+	SFdKey()
+		: fd(NULL), size(0), read_only(true), refcount(1)
+	{
+
+	}
+
+	IFsFile* fd;
+	int64 size;
+	bool read_only;
+	int refcount;
+
+	bool operator<(const SFdKey& other) const
+	{
+		if(other.fd==fd)
+		{
+			return read_only<other.read_only;
+		}
+		else
+		{
+			return fd < other.fd;
+		}
+	}
+
+	bool operator==(const SFdKey& other) const
+	{
+		return other.fd==fd && other.read_only==read_only;
+	}
+};
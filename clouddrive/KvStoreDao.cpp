@@ -18,6 +18,7 @@
 
 #include "KvStoreDao.h"
 #include "../stringtools.h"
+#include "../Interface/DatabaseCursor.h"
 #include <memory.h>
 #include <assert.h>
 
@@ -647,16 +648,17 @@ KvStoreDao::Task KvStoreDao::getActiveTask(void)
 	{
 		q_getActiveTask=db->Prepare("SELECT id, task_id, trans_id, cd_id FROM tasks WHERE active!=0 ORDER BY id ASC LIMIT 1", false);
 	}
-	db_results res=q_getActiveTask->Read();
+	IDatabaseCursor* cur=q_getActiveTask->Cursor();
 	Task ret = { false, 0, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.task_id=watoi(res[0]["task_id"]);
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.cd_id=watoi64(res[0]["cd_id"]);
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.task_id=cur->getInt(cur->columnIndex("task_id"));
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.cd_id=cur->getInt64(cur->columnIndex("cd_id"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -677,18 +679,27 @@ std::vector<KvStoreDao::Task> KvStoreDao::getTasks(int64 created_max, int task_i
 	q_getTasks->Bind(created_max);
 	q_getTasks->Bind(task_id);
 	q_getTasks->Bind(cd_id);
-	db_results res=q_getTasks->Read();
-	q_getTasks->Reset();
+	IDatabaseCursor* cur=q_getTasks->Cursor();
 	std::vector<KvStoreDao::Task> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].task_id=watoi(res[i]["task_id"]);
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].cd_id=watoi64(res[i]["cd_id"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_task_id=cur->columnIndex("task_id");
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_cd_id=cur->columnIndex("cd_id");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(Task());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().task_id=cur->getInt(c_task_id);
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().cd_id=cur->getInt64(c_cd_id);
+	}
+	cur->shutdown();
+	q_getTasks->Reset();
 	return ret;
 }
 
@@ -706,17 +717,18 @@ KvStoreDao::Task KvStoreDao::getTask(int64 created_max)
 		q_getTask=db->Prepare("SELECT id, task_id, trans_id, cd_id FROM tasks WHERE created<=? OR created IS NULL ORDER BY id ASC LIMIT 1", false);
 	}
 	q_getTask->Bind(created_max);
-	db_results res=q_getTask->Read();
-	q_getTask->Reset();
+	IDatabaseCursor* cur=q_getTask->Cursor();
 	Task ret = { false, 0, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.task_id=watoi(res[0]["task_id"]);
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.cd_id=watoi64(res[0]["cd_id"]);
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.task_id=cur->getInt(cur->columnIndex("task_id"));
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.cd_id=cur->getInt64(cur->columnIndex("cd_id"));
 	}
+	cur->shutdown();
+	q_getTask->Reset();
 	return ret;
 }
 
@@ -770,15 +782,23 @@ std::vector<KvStoreDao::SCdTrans> KvStoreDao::getTransactionIds(void)
 	{
 		q_getTransactionIds=db->Prepare("SELECT id, completed, active FROM clouddrive_transactions", false);
 	}
-	db_results res=q_getTransactionIds->Read();
+	IDatabaseCursor* cur=q_getTransactionIds->Cursor();
 	std::vector<KvStoreDao::SCdTrans> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	int c_completed=cur->columnIndex("completed");
+	int c_active=cur->columnIndex("active");
+	while(cur->next())
 	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].completed=watoi(res[i]["completed"]);
-		ret[i].active=watoi(res[i]["active"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SCdTrans());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().completed=cur->getInt(c_completed);
+		ret.back().active=cur->getInt(c_active);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -796,16 +816,24 @@ std::vector<KvStoreDao::SCdTrans> KvStoreDao::getTransactionIdsCd(int64 cd_id)
 		q_getTransactionIdsCd=db->Prepare("SELECT id, completed, active FROM clouddrive_transactions_cd WHERE cd_id=?", false);
 	}
 	q_getTransactionIdsCd->Bind(cd_id);
-	db_results res=q_getTransactionIdsCd->Read();
-	q_getTransactionIdsCd->Reset();
+	IDatabaseCursor* cur=q_getTransactionIdsCd->Cursor();
 	std::vector<KvStoreDao::SCdTrans> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].completed=watoi(res[i]["completed"]);
-		ret[i].active=watoi(res[i]["active"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_completed=cur->columnIndex("completed");
+	int c_active=cur->columnIndex("active");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SCdTrans());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().completed=cur->getInt(c_completed);
+		ret.back().active=cur->getInt(c_active);
+	}
+	cur->shutdown();
+	q_getTransactionIdsCd->Reset();
 	return ret;
 }
 
@@ -822,14 +850,15 @@ KvStoreDao::SSize KvStoreDao::getSize(void)
 	{
 		q_getSize=db->Prepare("SELECT SUM(size) AS size, COUNT(size) AS count FROM (clouddrive_objects INNER JOIN clouddrive_transactions ON trans_id=clouddrive_transactions.id) WHERE size!= -1 AND active!=0", false);
 	}
-	db_results res=q_getSize->Read();
+	IDatabaseCursor* cur=q_getSize->Cursor();
 	SSize ret = { false, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.size=watoi64(res[0]["size"]);
-		ret.count=watoi64(res[0]["count"]);
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.count=cur->getInt64(cur->columnIndex("count"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -849,10 +878,13 @@ int64 KvStoreDao::getSizePartial(const std::string& tkey, int64 tans_id)
 	q_getSizePartial->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getSizePartial->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getSizePartial->Bind(tans_id);
-	db_results res=q_getSizePartial->Read();
+	IDatabaseCursor* cur=q_getSizePartial->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int64 ret=has_row ? cur->getInt64(cur->columnIndex("size")) : 0;
+	cur->shutdown();
 	q_getSizePartial->Reset();
-	assert(!res.empty());
-	return watoi64(res[0]["size"]);
+	return ret;
 }
 
 
@@ -870,10 +902,13 @@ int64 KvStoreDao::getSizePartialLMInit(int64 last_modified_start)
 		q_getSizePartialLMInit=db->Prepare("SELECT SUM(size) AS size FROM (clouddrive_objects INNER JOIN clouddrive_transactions ON trans_id=clouddrive_transactions.id) WHERE size!= -1 AND last_modified>=? AND active!=0", false);
 	}
 	q_getSizePartialLMInit->Bind(last_modified_start);
-	db_results res=q_getSizePartialLMInit->Read();
+	IDatabaseCursor* cur=q_getSizePartialLMInit->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int64 ret=has_row ? cur->getInt64(cur->columnIndex("size")) : 0;
+	cur->shutdown();
 	q_getSizePartialLMInit->Reset();
-	assert(!res.empty());
-	return watoi64(res[0]["size"]);
+	return ret;
 }
 
 /**
@@ -891,10 +926,13 @@ int64 KvStoreDao::getSizePartialLM(int64 last_modified_start, int64 last_modifie
 	}
 	q_getSizePartialLM->Bind(last_modified_start);
 	q_getSizePartialLM->Bind(last_modified_stop);
-	db_results res=q_getSizePartialLM->Read();
+	IDatabaseCursor* cur=q_getSizePartialLM->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int64 ret=has_row ? cur->getInt64(cur->columnIndex("size")) : 0;
+	cur->shutdown();
 	q_getSizePartialLM->Reset();
-	assert(!res.empty());
-	return watoi64(res[0]["size"]);
+	return ret;
 }
 
 /**
@@ -948,13 +986,14 @@ KvStoreDao::CondInt64 KvStoreDao::getMaxCompleteTransaction(void)
 	{
 		q_getMaxCompleteTransaction=db->Prepare("SELECT MAX(id) AS max_id FROM clouddrive_transactions WHERE completed=2", false);
 	}
-	db_results res=q_getMaxCompleteTransaction->Read();
+	IDatabaseCursor* cur=q_getMaxCompleteTransaction->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["max_id"]);
+		ret.value=cur->getInt64(cur->columnIndex("max_id"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -973,14 +1012,15 @@ KvStoreDao::CondInt64 KvStoreDao::getMaxCompleteTransactionCd(int64 cd_id)
 		q_getMaxCompleteTransactionCd=db->Prepare("SELECT MAX(id) AS max_id FROM clouddrive_transactions_cd WHERE completed=2 AND cd_id=?", false);
 	}
 	q_getMaxCompleteTransactionCd->Bind(cd_id);
-	db_results res=q_getMaxCompleteTransactionCd->Read();
-	q_getMaxCompleteTransactionCd->Reset();
+	IDatabaseCursor* cur=q_getMaxCompleteTransactionCd->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["max_id"]);
+		ret.value=cur->getInt64(cur->columnIndex("max_id"));
 	}
+	cur->shutdown();
+	q_getMaxCompleteTransactionCd->Reset();
 	return ret;
 }
 
@@ -999,14 +1039,19 @@ std::vector<int64> KvStoreDao::getIncompleteTransactions(int64 max_active)
 		q_getIncompleteTransactions=db->Prepare("SELECT id FROM clouddrive_transactions WHERE  completed=0 OR ( completed=1 AND id>? )", false);
 	}
 	q_getIncompleteTransactions->Bind(max_active);
-	db_results res=q_getIncompleteTransactions->Read();
-	q_getIncompleteTransactions->Reset();
+	IDatabaseCursor* cur=q_getIncompleteTransactions->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getIncompleteTransactions->Reset();
 	return ret;
 }
 
@@ -1026,14 +1071,19 @@ std::vector<int64> KvStoreDao::getIncompleteTransactionsCd(int64 max_active, int
 	}
 	q_getIncompleteTransactionsCd->Bind(max_active);
 	q_getIncompleteTransactionsCd->Bind(cd_id);
-	db_results res=q_getIncompleteTransactionsCd->Read();
-	q_getIncompleteTransactionsCd->Reset();
+	IDatabaseCursor* cur=q_getIncompleteTransactionsCd->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getIncompleteTransactionsCd->Reset();
 	return ret;
 }
 
@@ -1090,15 +1140,22 @@ std::vector<KvStoreDao::SDelItemMd5> KvStoreDao::getTransactionObjectsMd5(int64
 		q_getTransactionObjectsMd5=db->Prepare("SELECT tkey, md5sum FROM clouddrive_objects WHERE trans_id=? AND size != -1 ORDER BY tkey ASC", false);
 	}
 	q_getTransactionObjectsMd5->Bind(trans_id);
-	db_results res=q_getTransactionObjectsMd5->Read();
-	q_getTransactionObjectsMd5->Reset();
+	IDatabaseCursor* cur=q_getTransactionObjectsMd5->Cursor();
 	std::vector<KvStoreDao::SDelItemMd5> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-	}
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SDelItemMd5());
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+	}
+	cur->shutdown();
+	q_getTransactionObjectsMd5->Reset();
 	return ret;
 }
 
@@ -1119,15 +1176,22 @@ std::vector<KvStoreDao::SDelItemMd5> KvStoreDao::getTransactionObjectsMd5Cd(int6
 	}
 	q_getTransactionObjectsMd5Cd->Bind(cd_id);
 	q_getTransactionObjectsMd5Cd->Bind(trans_id);
-	db_results res=q_getTransactionObjectsMd5Cd->Read();
-	q_getTransactionObjectsMd5Cd->Reset();
+	IDatabaseCursor* cur=q_getTransactionObjectsMd5Cd->Cursor();
 	std::vector<KvStoreDao::SDelItemMd5> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-	}
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SDelItemMd5());
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+	}
+	cur->shutdown();
+	q_getTransactionObjectsMd5Cd->Reset();
 	return ret;
 }
 
@@ -1147,14 +1211,19 @@ std::vector<std::string> KvStoreDao::getTransactionObjects(int64 trans_id)
 		q_getTransactionObjects=db->Prepare("SELECT tkey FROM clouddrive_objects WHERE  trans_id=? AND size != -1 ORDER BY tkey ASC", false);
 	}
 	q_getTransactionObjects->Bind(trans_id);
-	db_results res=q_getTransactionObjects->Read();
-	q_getTransactionObjects->Reset();
+	IDatabaseCursor* cur=q_getTransactionObjects->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_tkey=cur->columnIndex("tkey");
+	while(cur->next())
 	{
-		ret[i]=res[i]["tkey"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_tkey));
 	}
+	cur->shutdown();
+	q_getTransactionObjects->Reset();
 	return ret;
 }
 
@@ -1175,14 +1244,19 @@ std::vector<std::string> KvStoreDao::getTransactionObjectsCd(int64 cd_id, int64
 	}
 	q_getTransactionObjectsCd->Bind(cd_id);
 	q_getTransactionObjectsCd->Bind(trans_id);
-	db_results res=q_getTransactionObjectsCd->Read();
-	q_getTransactionObjectsCd->Reset();
+	IDatabaseCursor* cur=q_getTransactionObjectsCd->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_tkey=cur->columnIndex("tkey");
+	while(cur->next())
 	{
-		ret[i]=res[i]["tkey"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_tkey));
 	}
+	cur->shutdown();
+	q_getTransactionObjectsCd->Reset();
 	return ret;
 }
 
@@ -1346,14 +1420,19 @@ std::vector<int64> KvStoreDao::getDeletableTransactions(int64 curr_trans_id)
 		q_getDeletableTransactions=db->Prepare("SELECT id FROM clouddrive_transactions t WHERE id<? AND completed!=0 AND NOT EXISTS  (SELECT * FROM clouddrive_objects WHERE trans_id=t.id)", false);
 	}
 	q_getDeletableTransactions->Bind(curr_trans_id);
-	db_results res=q_getDeletableTransactions->Read();
-	q_getDeletableTransactions->Reset();
+	IDatabaseCursor* cur=q_getDeletableTransactions->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getDeletableTransactions->Reset();
 	return ret;
 }
 
@@ -1374,14 +1453,19 @@ std::vector<int64> KvStoreDao::getDeletableTransactionsCd(int64 cd_id, int64 cur
 	}
 	q_getDeletableTransactionsCd->Bind(cd_id);
 	q_getDeletableTransactionsCd->Bind(curr_trans_id);
-	db_results res=q_getDeletableTransactionsCd->Read();
-	q_getDeletableTransactionsCd->Reset();
+	IDatabaseCursor* cur=q_getDeletableTransactionsCd->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getDeletableTransactionsCd->Reset();
 	return ret;
 }
 
@@ -1401,14 +1485,19 @@ std::vector<int64> KvStoreDao::getLastFinalizedTransactions(int64 last_trans_id,
 	}
 	q_getLastFinalizedTransactions->Bind(last_trans_id);
 	q_getLastFinalizedTransactions->Bind(curr_complete_trans_id);
-	db_results res=q_getLastFinalizedTransactions->Read();
-	q_getLastFinalizedTransactions->Reset();
+	IDatabaseCursor* cur=q_getLastFinalizedTransactions->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getLastFinalizedTransactions->Reset();
 	return ret;
 }
 
@@ -1429,14 +1518,19 @@ std::vector<int64> KvStoreDao::getLastFinalizedTransactionsCd(int64 cd_id, int64
 	q_getLastFinalizedTransactionsCd->Bind(cd_id);
 	q_getLastFinalizedTransactionsCd->Bind(last_trans_id);
 	q_getLastFinalizedTransactionsCd->Bind(curr_complete_trans_id);
-	db_results res=q_getLastFinalizedTransactionsCd->Read();
-	q_getLastFinalizedTransactionsCd->Reset();
+	IDatabaseCursor* cur=q_getLastFinalizedTransactionsCd->Cursor();
 	std::vector<int64> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi64(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt64(c_id));
 	}
+	cur->shutdown();
+	q_getLastFinalizedTransactionsCd->Reset();
 	return ret;
 }
 
@@ -1459,16 +1553,24 @@ std::vector<KvStoreDao::CdDelObjectMd5> KvStoreDao::getDeletableObjectsMd5Ordere
 	}
 	q_getDeletableObjectsMd5Ordered->Bind(curr_trans_id);
 	q_getDeletableObjectsMd5Ordered->Bind(curr_trans_id);
-	db_results res=q_getDeletableObjectsMd5Ordered->Read();
-	q_getDeletableObjectsMd5Ordered->Reset();
+	IDatabaseCursor* cur=q_getDeletableObjectsMd5Ordered->Cursor();
 	std::vector<KvStoreDao::CdDelObjectMd5> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdDelObjectMd5());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+	}
+	cur->shutdown();
+	q_getDeletableObjectsMd5Ordered->Reset();
 	return ret;
 }
 
@@ -1492,16 +1594,24 @@ std::vector<KvStoreDao::CdDelObjectMd5> KvStoreDao::getDeletableObjectsMd5Cd(int
 	q_getDeletableObjectsMd5Cd->Bind(cd_id);
 	q_getDeletableObjectsMd5Cd->Bind(curr_trans_id);
 	q_getDeletableObjectsMd5Cd->Bind(curr_trans_id);
-	db_results res=q_getDeletableObjectsMd5Cd->Read();
-	q_getDeletableObjectsMd5Cd->Reset();
+	IDatabaseCursor* cur=q_getDeletableObjectsMd5Cd->Cursor();
 	std::vector<KvStoreDao::CdDelObjectMd5> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdDelObjectMd5());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+	}
+	cur->shutdown();
+	q_getDeletableObjectsMd5Cd->Reset();
 	return ret;
 }
 
@@ -1524,16 +1634,24 @@ std::vector<KvStoreDao::CdDelObjectMd5> KvStoreDao::getDeletableObjectsMd5(int64
 	}
 	q_getDeletableObjectsMd5->Bind(curr_trans_id);
 	q_getDeletableObjectsMd5->Bind(curr_trans_id);
-	db_results res=q_getDeletableObjectsMd5->Read();
-	q_getDeletableObjectsMd5->Reset();
+	IDatabaseCursor* cur=q_getDeletableObjectsMd5->Cursor();
 	std::vector<KvStoreDao::CdDelObjectMd5> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdDelObjectMd5());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+	}
+	cur->shutdown();
+	q_getDeletableObjectsMd5->Reset();
 	return ret;
 }
 
@@ -1556,15 +1674,22 @@ std::vector<KvStoreDao::CdDelObject> KvStoreDao::getDeletableObjectsOrdered(int6
 	}
 	q_getDeletableObjectsOrdered->Bind(curr_trans_id);
 	q_getDeletableObjectsOrdered->Bind(curr_trans_id);
-	db_results res=q_getDeletableObjectsOrdered->Read();
-	q_getDeletableObjectsOrdered->Reset();
+	IDatabaseCursor* cur=q_getDeletableObjectsOrdered->Cursor();
 	std::vector<KvStoreDao::CdDelObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdDelObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+	}
+	cur->shutdown();
+	q_getDeletableObjectsOrdered->Reset();
 	return ret;
 }
 
@@ -1587,15 +1712,22 @@ std::vector<KvStoreDao::CdDelObject> KvStoreDao::getDeletableObjects(int64 curr_
 	}
 	q_getDeletableObjects->Bind(curr_trans_id);
 	q_getDeletableObjects->Bind(curr_trans_id);
-	db_results res=q_getDeletableObjects->Read();
-	q_getDeletableObjects->Reset();
+	IDatabaseCursor* cur=q_getDeletableObjects->Cursor();
 	std::vector<KvStoreDao::CdDelObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdDelObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+	}
+	cur->shutdown();
+	q_getDeletableObjects->Reset();
 	return ret;
 }
 
@@ -1987,13 +2119,14 @@ KvStoreDao::CondInt64 KvStoreDao::getGeneration(void)
 	{
 		q_getGeneration=db->Prepare("SELECT generation FROM clouddrive_generation", false);
 	}
-	db_results res=q_getGeneration->Read();
+	IDatabaseCursor* cur=q_getGeneration->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["generation"]);
+		ret.value=cur->getInt64(cur->columnIndex("generation"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2011,14 +2144,15 @@ KvStoreDao::CondInt64 KvStoreDao::getGenerationCd(int64 cd_id)
 		q_getGenerationCd=db->Prepare("SELECT generation FROM clouddrive_generation_cd WHERE cd_id=?", false);
 	}
 	q_getGenerationCd->Bind(cd_id);
-	db_results res=q_getGenerationCd->Read();
-	q_getGenerationCd->Reset();
+	IDatabaseCursor* cur=q_getGenerationCd->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["generation"]);
+		ret.value=cur->getInt64(cur->columnIndex("generation"));
 	}
+	cur->shutdown();
+	q_getGenerationCd->Reset();
 	return ret;
 }
 
@@ -2057,16 +2191,17 @@ KvStoreDao::CdObject KvStoreDao::getObjectInTransid(int64 trans_id, const std::s
 	}
 	q_getObjectInTransid->Bind(trans_id);
 	q_getObjectInTransid->Bind(tkey.c_str(), (_u32)tkey.size());
-	db_results res=q_getObjectInTransid->Read();
-	q_getObjectInTransid->Reset();
+	IDatabaseCursor* cur=q_getObjectInTransid->Cursor();
 	CdObject ret = { false, 0, 0, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.size=watoi64(res[0]["size"]);
-		ret.md5sum=res[0]["md5sum"];
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.md5sum=cur->getString(cur->columnIndex("md5sum"));
 	}
+	cur->shutdown();
+	q_getObjectInTransid->Reset();
 	return ret;
 }
 
@@ -2089,16 +2224,17 @@ KvStoreDao::CdObject KvStoreDao::getObjectInTransidCd(int64 cd_id, int64 trans_i
 	q_getObjectInTransidCd->Bind(cd_id);
 	q_getObjectInTransidCd->Bind(trans_id);
 	q_getObjectInTransidCd->Bind(tkey.c_str(), (_u32)tkey.size());
-	db_results res=q_getObjectInTransidCd->Read();
-	q_getObjectInTransidCd->Reset();
+	IDatabaseCursor* cur=q_getObjectInTransidCd->Cursor();
 	CdObject ret = { false, 0, 0, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.size=watoi64(res[0]["size"]);
-		ret.md5sum=res[0]["md5sum"];
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.md5sum=cur->getString(cur->columnIndex("md5sum"));
 	}
+	cur->shutdown();
+	q_getObjectInTransidCd->Reset();
 	return ret;
 }
 
@@ -2117,16 +2253,17 @@ KvStoreDao::CdSingleObject KvStoreDao::getSingleObject(void)
 	{
 		q_getSingleObject=db->Prepare("SELECT tkey, trans_id, size, md5sum FROM clouddrive_objects WHERE size!=-1 LIMIT 1", false);
 	}
-	db_results res=q_getSingleObject->Read();
+	IDatabaseCursor* cur=q_getSingleObject->Cursor();
 	CdSingleObject ret = { false, "", 0, 0, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.tkey=res[0]["tkey"];
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.size=watoi64(res[0]["size"]);
-		ret.md5sum=res[0]["md5sum"];
+		ret.tkey=cur->getString(cur->columnIndex("tkey"));
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.md5sum=cur->getString(cur->columnIndex("md5sum"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2151,16 +2288,17 @@ KvStoreDao::CdObject KvStoreDao::getObject(int64 curr_trans_id, const std::strin
 	}
 	q_getObject->Bind(curr_trans_id);
 	q_getObject->Bind(tkey.c_str(), (_u32)tkey.size());
-	db_results res=q_getObject->Read();
-	q_getObject->Reset();
+	IDatabaseCursor* cur=q_getObject->Cursor();
 	CdObject ret = { false, 0, 0, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.size=watoi64(res[0]["size"]);
-		ret.md5sum=res[0]["md5sum"];
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.md5sum=cur->getString(cur->columnIndex("md5sum"));
 	}
+	cur->shutdown();
+	q_getObject->Reset();
 	return ret;
 }
 
@@ -2187,16 +2325,17 @@ KvStoreDao::CdObject KvStoreDao::getObjectCd(int64 cd_id, int64 curr_trans_id, c
 	q_getObjectCd->Bind(cd_id);
 	q_getObjectCd->Bind(curr_trans_id);
 	q_getObjectCd->Bind(tkey.c_str(), (_u32)tkey.size());
-	db_results res=q_getObjectCd->Read();
-	q_getObjectCd->Reset();
+	IDatabaseCursor* cur=q_getObjectCd->Cursor();
 	CdObject ret = { false, 0, 0, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.trans_id=watoi64(res[0]["trans_id"]);
-		ret.size=watoi64(res[0]["size"]);
-		ret.md5sum=res[0]["md5sum"];
+		ret.trans_id=cur->getInt64(cur->columnIndex("trans_id"));
+		ret.size=cur->getInt64(cur->columnIndex("size"));
+		ret.md5sum=cur->getString(cur->columnIndex("md5sum"));
 	}
+	cur->shutdown();
+	q_getObjectCd->Reset();
 	return ret;
 }
 
@@ -2215,14 +2354,15 @@ KvStoreDao::CondInt64 KvStoreDao::isTransactionActive(int64 trans_id)
 		q_isTransactionActive=db->Prepare("SELECT id FROM clouddrive_transactions WHERE active=1 AND id=?", false);
 	}
 	q_isTransactionActive->Bind(trans_id);
-	db_results res=q_isTransactionActive->Read();
-	q_isTransactionActive->Reset();
+	IDatabaseCursor* cur=q_isTransactionActive->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_isTransactionActive->Reset();
 	return ret;
 }
 
@@ -2242,14 +2382,15 @@ KvStoreDao::CondInt64 KvStoreDao::isTransactionActiveCd(int64 cd_id, int64 trans
 	}
 	q_isTransactionActiveCd->Bind(cd_id);
 	q_isTransactionActiveCd->Bind(trans_id);
-	db_results res=q_isTransactionActiveCd->Read();
-	q_isTransactionActiveCd->Reset();
+	IDatabaseCursor* cur=q_isTransactionActiveCd->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_isTransactionActiveCd->Reset();
 	return ret;
 }
 
@@ -2289,14 +2430,15 @@ KvStoreDao::CondString KvStoreDao::getMiscValue(const std::string& key)
 		q_getMiscValue=db->Prepare("SELECT value FROM misc WHERE key=?", false);
 	}
 	q_getMiscValue->Bind(key);
-	db_results res=q_getMiscValue->Read();
-	q_getMiscValue->Reset();
+	IDatabaseCursor* cur=q_getMiscValue->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["value"];
+		ret.value=cur->getString(cur->columnIndex("value"));
 	}
+	cur->shutdown();
+	q_getMiscValue->Reset();
 	return ret;
 }
 
@@ -2332,16 +2474,17 @@ KvStoreDao::STransactionProperties KvStoreDao::getTransactionProperties(int64 id
 		q_getTransactionProperties=db->Prepare("SELECT active, completed, 0 AS cd_id FROM clouddrive_transactions WHERE id=?", false);
 	}
 	q_getTransactionProperties->Bind(id);
-	db_results res=q_getTransactionProperties->Read();
-	q_getTransactionProperties->Reset();
+	IDatabaseCursor* cur=q_getTransactionProperties->Cursor();
 	STransactionProperties ret = { false, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.active=watoi(res[0]["active"]);
-		ret.completed=watoi(res[0]["completed"]);
-		ret.cd_id=watoi64(res[0]["cd_id"]);
+		ret.active=cur->getInt(cur->columnIndex("active"));
+		ret.completed=cur->getInt(cur->columnIndex("completed"));
+		ret.cd_id=cur->getInt64(cur->columnIndex("cd_id"));
 	}
+	cur->shutdown();
+	q_getTransactionProperties->Reset();
 	return ret;
 }
 
@@ -2360,16 +2503,17 @@ KvStoreDao::STransactionProperties KvStoreDao::getTransactionPropertiesCd(int64
 	}
 	q_getTransactionPropertiesCd->Bind(cd_id);
 	q_getTransactionPropertiesCd->Bind(id);
-	db_results res=q_getTransactionPropertiesCd->Read();
-	q_getTransactionPropertiesCd->Reset();
+	IDatabaseCursor* cur=q_getTransactionPropertiesCd->Cursor();
 	STransactionProperties ret = { false, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.active=watoi(res[0]["active"]);
-		ret.completed=watoi(res[0]["completed"]);
-		ret.cd_id=watoi64(res[0]["cd_id"]);
+		ret.active=cur->getInt(cur->columnIndex("active"));
+		ret.completed=cur->getInt(cur->columnIndex("completed"));
+		ret.cd_id=cur->getInt64(cur->columnIndex("cd_id"));
 	}
+	cur->shutdown();
+	q_getTransactionPropertiesCd->Reset();
 	return ret;
 }
 
@@ -2387,17 +2531,27 @@ std::vector<KvStoreDao::CdIterObject> KvStoreDao::getInitialObjectsLM(void)
 	{
 		q_getInitialObjectsLM=db->Prepare("SELECT trans_id, tkey, md5sum, size, last_modified  FROM clouddrive_objects WHERE size!=-1 ORDER BY last_modified ASC LIMIT 10000", false);
 	}
-	db_results res=q_getInitialObjectsLM->Read();
+	IDatabaseCursor* cur=q_getInitialObjectsLM->Cursor();
 	std::vector<KvStoreDao::CdIterObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	int c_last_modified=cur->columnIndex("last_modified");
+	while(cur->next())
 	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
-		ret[i].last_modified=watoi64(res[i]["last_modified"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
+		ret.back().last_modified=cur->getInt64(c_last_modified);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2414,16 +2568,25 @@ std::vector<KvStoreDao::CdIterObject> KvStoreDao::getInitialObjects(void)
 	{
 		q_getInitialObjects=db->Prepare("SELECT trans_id, tkey, md5sum, size FROM clouddrive_objects WHERE size!=-1 ORDER BY tkey ASC, trans_id ASC LIMIT 10000", false);
 	}
-	db_results res=q_getInitialObjects->Read();
+	IDatabaseCursor* cur=q_getInitialObjects->Cursor();
 	std::vector<KvStoreDao::CdIterObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	while(cur->next())
 	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2444,18 +2607,28 @@ std::vector<KvStoreDao::CdIterObject> KvStoreDao::getIterObjectsLMInit(int64 las
 		q_getIterObjectsLMInit=db->Prepare("SELECT trans_id, tkey, md5sum, size, last_modified FROM (clouddrive_objects INNER JOIN clouddrive_transactions ON trans_id=clouddrive_transactions.id) WHERE last_modified>=? AND size!=-1 AND active!=0 ORDER BY last_modified ASC LIMIT 10000", false);
 	}
 	q_getIterObjectsLMInit->Bind(last_modified_start);
-	db_results res=q_getIterObjectsLMInit->Read();
-	q_getIterObjectsLMInit->Reset();
+	IDatabaseCursor* cur=q_getIterObjectsLMInit->Cursor();
 	std::vector<KvStoreDao::CdIterObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
-		ret[i].last_modified=watoi64(res[i]["last_modified"]);
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	int c_last_modified=cur->columnIndex("last_modified");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
+		ret.back().last_modified=cur->getInt64(c_last_modified);
+	}
+	cur->shutdown();
+	q_getIterObjectsLMInit->Reset();
 	return ret;
 }
 
@@ -2477,18 +2650,28 @@ std::vector<KvStoreDao::CdIterObject> KvStoreDao::getIterObjectsLM(int64 last_mo
 	}
 	q_getIterObjectsLM->Bind(last_modified_start);
 	q_getIterObjectsLM->Bind(last_modified_stop);
-	db_results res=q_getIterObjectsLM->Read();
-	q_getIterObjectsLM->Reset();
+	IDatabaseCursor* cur=q_getIterObjectsLM->Cursor();
 	std::vector<KvStoreDao::CdIterObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
-		ret[i].last_modified=watoi64(res[i]["last_modified"]);
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	int c_last_modified=cur->columnIndex("last_modified");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
+		ret.back().last_modified=cur->getInt64(c_last_modified);
+	}
+	cur->shutdown();
+	q_getIterObjectsLM->Reset();
 	return ret;
 }
 
@@ -2511,17 +2694,26 @@ std::vector<KvStoreDao::CdIterObject> KvStoreDao::getIterObjects(const std::stri
 	q_getIterObjects->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getIterObjects->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getIterObjects->Bind(tans_id);
-	db_results res=q_getIterObjects->Read();
-	q_getIterObjects->Reset();
+	IDatabaseCursor* cur=q_getIterObjects->Cursor();
 	std::vector<KvStoreDao::CdIterObject> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
-	}
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject());
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
+	}
+	cur->shutdown();
+	q_getIterObjects->Reset();
 	return ret;
 }
 
@@ -2599,17 +2791,27 @@ std::vector<KvStoreDao::CdIterObject2> KvStoreDao::getUnmirroredObjects(void)
 	{
 		q_getUnmirroredObjects=db->Prepare("SELECT clouddrive_objects.rowid AS id, trans_id, tkey, md5sum, size FROM (clouddrive_objects INNER JOIN clouddrive_transactions ON trans_id=clouddrive_transactions.id) WHERE size!=-1 AND active!=0 AND clouddrive_objects.mirrored=0 AND clouddrive_transactions.completed!=0 AND clouddrive_transactions.active!=0 ORDER BY last_modified ASC LIMIT 1000", false);
 	}
-	db_results res=q_getUnmirroredObjects->Read();
+	IDatabaseCursor* cur=q_getUnmirroredObjects->Cursor();
 	std::vector<KvStoreDao::CdIterObject2> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	int c_trans_id=cur->columnIndex("trans_id");
+	int c_tkey=cur->columnIndex("tkey");
+	int c_md5sum=cur->columnIndex("md5sum");
+	int c_size=cur->columnIndex("size");
+	while(cur->next())
 	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].trans_id=watoi64(res[i]["trans_id"]);
-		ret[i].tkey=res[i]["tkey"];
-		ret[i].md5sum=res[i]["md5sum"];
-		ret[i].size=watoi64(res[i]["size"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(CdIterObject2());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().trans_id=cur->getInt64(c_trans_id);
+		ret.back().tkey=cur->getString(c_tkey);
+		ret.back().md5sum=cur->getString(c_md5sum);
+		ret.back().size=cur->getInt64(c_size);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2628,14 +2830,15 @@ KvStoreDao::SUnmirrored KvStoreDao::getUnmirroredObjectsSize(void)
 	{
 		q_getUnmirroredObjectsSize=db->Prepare("SELECT SUM(size) AS tsize, COUNT(size) AS tcount FROM (clouddrive_objects INNER JOIN clouddrive_transactions ON trans_id=clouddrive_transactions.id) WHERE size!=-1 AND active!=0 AND clouddrive_objects.mirrored=0 AND clouddrive_transactions.completed!=0 AND clouddrive_transactions.active!=0", false);
 	}
-	db_results res=q_getUnmirroredObjectsSize->Read();
+	IDatabaseCursor* cur=q_getUnmirroredObjectsSize->Cursor();
 	SUnmirrored ret = { false, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.tsize=watoi64(res[0]["tsize"]);
-		ret.tcount=watoi64(res[0]["tcount"]);
+		ret.tsize=cur->getInt64(cur->columnIndex("tsize"));
+		ret.tcount=cur->getInt64(cur->columnIndex("tcount"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2670,15 +2873,23 @@ std::vector<KvStoreDao::SCdTrans> KvStoreDao::getUnmirroredTransactions(void)
 	{
 		q_getUnmirroredTransactions=db->Prepare("SELECT id, completed, active FROM clouddrive_transactions WHERE completed!=0 AND active!=0 AND mirrored=0 AND NOT EXISTS (SELECT * FROM clouddrive_objects WHERE clouddrive_objects.trans_id=clouddrive_transactions.id AND clouddrive_objects.mirrored=0)", false);
 	}
-	db_results res=q_getUnmirroredTransactions->Read();
+	IDatabaseCursor* cur=q_getUnmirroredTransactions->Cursor();
 	std::vector<KvStoreDao::SCdTrans> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	int c_completed=cur->columnIndex("completed");
+	int c_active=cur->columnIndex("active");
+	while(cur->next())
 	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].completed=watoi(res[i]["completed"]);
-		ret[i].active=watoi(res[i]["active"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SCdTrans());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().completed=cur->getInt(c_completed);
+		ret.back().active=cur->getInt(c_active);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -2746,14 +2957,15 @@ KvStoreDao::CondInt64 KvStoreDao::getLowerTransidObject(const std::string& tkey,
 	}
 	q_getLowerTransidObject->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getLowerTransidObject->Bind(transid);
-	db_results res=q_getLowerTransidObject->Read();
-	q_getLowerTransidObject->Reset();
+	IDatabaseCursor* cur=q_getLowerTransidObject->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["trans_id"]);
+		ret.value=cur->getInt64(cur->columnIndex("trans_id"));
 	}
+	cur->shutdown();
+	q_getLowerTransidObject->Reset();
 	return ret;
 }
 
@@ -2774,14 +2986,15 @@ KvStoreDao::CondInt64 KvStoreDao::getLowerTransidObjectCd(int64 cd_id, const std
 	q_getLowerTransidObjectCd->Bind(cd_id);
 	q_getLowerTransidObjectCd->Bind(tkey.c_str(), (_u32)tkey.size());
 	q_getLowerTransidObjectCd->Bind(transid);
-	db_results res=q_getLowerTransidObjectCd->Read();
-	q_getLowerTransidObjectCd->Reset();
+	IDatabaseCursor* cur=q_getLowerTransidObjectCd->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["trans_id"]);
+		ret.value=cur->getInt64(cur->columnIndex("trans_id"));
 	}
+	cur->shutdown();
+	q_getLowerTransidObjectCd->Reset();
 	return ret;
 }
 
@@ -2,6 +2,7 @@
 #include <list>
 #include <atomic>
 #include "../common/lrucache.h"
+#include "../common/hash_lrucache.h"
 #include "../Interface/Thread.h"
 #include "../Interface/Types.h"
 #include "../Interface/Mutex.h"
@@ -15,6 +16,7 @@
 #include <thread>
 #include <condition_variable>
 #include "IOnlineKvStore.h"
+#include "KvStoreCacheTypes.h"
 #include "../urbackupcommon/os_functions.h"
 #ifdef HAS_ASYNC
 #include "fuse_io_context.h"
@@ -77,42 +79,6 @@ namespace
 		bool finish;
 	};
 
-	struct SFdKey
-	{
-		SFdKey(IFsFile* fd, int64 size, bool read_only)
-			: fd(fd), size(size), read_only(read_only), refcount(1)
-		{
-		}
-
-		SFdKey()
-			: fd(NULL), size(0), read_only(true), refcount(1)
-		{
-
-		}
-
-		IFsFile* fd;
-		int64 size;
-		bool read_only;
-		int refcount;
-
-		bool operator<(const SFdKey& other) const
-		{
-			if(other.fd==fd)
-			{
-				return read_only<other.read_only;
-			}
-			else
-			{
-				return fd < other.fd;
-			}
-		}
-
-		bool operator==(const SFdKey& other) const
-		{
-			return other.fd==fd && other.read_only==read_only;
-		}
-	};
-
 	struct SubmittedItem
 	{
 		std::string key;
@@ -183,15 +149,10 @@ class TransactionalKvStore : public IThread
 
 public:
 
-	struct SCacheVal
-	{
-		SCacheVal()
-			: dirty(false), chances(0)
-		{}
+	typedef SKvCacheVal SCacheVal;
 
-		bool dirty : 1;
-		unsigned char chances : 7;
-	};
+	typedef common::hash_lrucache<std::string, SCacheVal> cache_t;
+	typedef cache_t::iterator cache_iterator_t;
 
 	class INumSecondChancesCallback
 	{
@@ -366,18 +327,18 @@ private:
 	std::string hexpath(const std::string& key);
 
 	bool evict_one(std::unique_lock<cache_mutex_t>& cache_lock, bool break_on_skip, bool only_non_dirty,
-		std::list<std::pair<std::string const *, SCacheVal> >::iterator& evict_it,
-		common::lrucache<std::string, SCacheVal>& target_cache, bool use_chances,
+		cache_iterator_t& evict_it,
+		cache_t& target_cache, bool use_chances,
 		int64& freed_space,
-		bool& run_del_items, std::vector<std::list<std::pair<std::string const *, SCacheVal> >::iterator>& move_front,
+		bool& run_del_items, std::vector<cache_iterator_t>& move_front,
 		bool& used_chance);
 
-	void evict_move_front(common::lrucache<std::string, SCacheVal>& target_cache,
-		std::vector<std::list<std::pair<std::string const *, SCacheVal> >::iterator>& move_front);
+	void evict_move_front(cache_t& target_cache,
+		std::vector<cache_iterator_t>& move_front);
 
 	void evict_item(const std::string& key, bool dirty,
-		common::lrucache<std::string, SCacheVal>& target_cache,
-		std::list<std::pair<std::string const *, SCacheVal> >::iterator* evict_it,
+		cache_t& target_cache,
+		cache_iterator_t* evict_it,
 		std::unique_lock<cache_mutex_t>& cache_lock, const std::string& from, int64& freed_space);
 
 	bool evict_memfiles(std::unique_lock<cache_mutex_t>& cache_lock, bool evict_dirty);
@@ -385,7 +346,7 @@ private:
 	void check_deleted(int64 transid, const std::string& key, bool comp);
 
 	bool compress_one(std::unique_lock<cache_mutex_t>& cache_lock,
-		std::list<std::pair<std::string const *, SCacheVal> >::iterator& compress_it);
+		cache_iterator_t& compress_it);
 
 	std::list<SSubmissionItem>::iterator next_submission_item(bool no_compress, bool prefer_non_delete, bool prefer_mem, std::string& path, bool& p_do_stop, SMemFile*& memf);
 
@@ -663,7 +624,7 @@ private:
 	}
 #endif
 
-	common::lrucache<std::string, SCacheVal> lru_cache;
+	cache_t lru_cache;
 	std::map<std::string, SFdKey> open_files;
 	std::map<IFsFile*, ReadOnlyFileWrapper*> read_only_open_files;
 	std::map<std::string, int> preload_once_items;
@@ -677,7 +638,7 @@ private:
 	std::map<int64, std::map<std::string, int64> > dirty_items_size;
 #endif
 	std::map<int64, size_t> num_delete_items;
-	common::lrucache<std::string, SFdKey> fd_cache;
+	common::hash_lrucache<std::string, SFdKey> fd_cache;
 	cache_mutex_t cache_mutex;
 	std::recursive_mutex submission_mutex;
 	std::recursive_mutex dirty_item_mutex;
@@ -685,7 +646,7 @@ private:
 	std::set<std::string> queued_dels;
 	std::map<std::string, size_t> in_retrieval;
 	std::condition_variable_any retrieval_cond;
-	common::lrucache<std::string, SCacheVal> compressed_items;
+	cache_t compressed_items;
 	std::set<std::string> dirty_evicted_items;
 	std::map<int64, std::set<std::string> > nosubmit_dirty_items;
 	std::set<std::string> nosubmit_untouched_items;
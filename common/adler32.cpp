@@ -31,6 +31,9 @@ adler32.c -- compute the Adler-32 checksum of a data stream
 
 /* @(#) $Id$ */
 
+#include "adler32.h"
+#include "cpu_features.h"
+
 #define BASE 65521      /* largest prime smaller than 65536 */
 #define NMAX 5552
 /* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
@@ -47,7 +50,7 @@ adler32.c -- compute the Adler-32 checksum of a data stream
 #  define MOD63(a) a %= BASE
 
 /* ========================================================================= */
-unsigned int urb_adler32(unsigned int adler, const char* pbuf, unsigned int len)
+static unsigned int adler32_scalar(unsigned int adler, const char* pbuf, unsigned int len)
 {
 	const unsigned char* buf = reinterpret_cast<const unsigned char*>(pbuf);
     unsigned int sum2;
@@ -115,6 +118,237 @@ unsigned int urb_adler32(unsigned int adler, const char* pbuf, unsigned int len)
     return adler | (sum2 << 16);
 }
 
+#ifdef URB_X86_SIMD
+
+/*
+ * Vectorized variants. Each processes full blocks of the vector width
+ * (32 bytes for SSSE3/AVX2, 64 bytes for AVX-512) and hands the tail to
+ * the scalar code. Per lane:
+ *   s1 += sum(bytes)
+ *   s2 += width*s1_before_block + sum((width-i)*bytes[i])
+ * The NMAX constraint is kept by reducing modulo BASE every NMAX bytes.
+ */
+
+URB_TARGET("ssse3")
+static unsigned int adler32_ssse3(unsigned int adler, const char* pbuf, unsigned int len)
+{
+	const unsigned char* buf = reinterpret_cast<const unsigned char*>(pbuf);
+	unsigned int s1 = adler & 0xffff;
+	unsigned int s2 = (adler >> 16) & 0xffff;
+
+	const unsigned int block_size = 32;
+	unsigned int blocks = len / block_size;
+	len -= blocks*block_size;
+
+	const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+	const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+
+	while (blocks)
+	{
+		unsigned int n = NMAX / block_size;
+		if (n > blocks)
+			n = blocks;
+		blocks -= n;
+
+		__m128i v_ps = _mm_set_epi32(0, 0, 0, s1*n);
+		__m128i v_s2 = _mm_set_epi32(0, 0, 0, s2);
+		__m128i v_s1 = _mm_setzero_si128();
+
+		do
+		{
+			const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+			const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+
+			v_ps = _mm_add_epi32(v_ps, v_s1);
+
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+			const __m128i mad1 = _mm_maddubs_epi16(bytes1, tap1);
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad1, ones));
+
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+			const __m128i mad2 = _mm_maddubs_epi16(bytes2, tap2);
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad2, ones));
+
+			buf += block_size;
+		} while (--n);
+
+		v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+		s1 += static_cast<unsigned int>(_mm_cvtsi128_si32(v_s1));
+
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+		s2 = static_cast<unsigned int>(_mm_cvtsi128_si32(v_s2));
+
+		MOD(s1);
+		MOD(s2);
+	}
+
+	return adler32_scalar(s1 | (s2 << 16), reinterpret_cast<const char*>(buf), len);
+}
+
+URB_TARGET("avx2")
+static unsigned int adler32_avx2(unsigned int adler, const char* pbuf, unsigned int len)
+{
+	const unsigned char* buf = reinterpret_cast<const unsigned char*>(pbuf);
+	unsigned int s1 = adler & 0xffff;
+	unsigned int s2 = (adler >> 16) & 0xffff;
+
+	const unsigned int block_size = 32;
+	unsigned int blocks = len / block_size;
+	len -= blocks*block_size;
+
+	const __m256i tap = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi16(1);
+
+	while (blocks)
+	{
+		unsigned int n = NMAX / block_size;
+		if (n > blocks)
+			n = blocks;
+		blocks -= n;
+
+		__m256i v_ps = _mm256_setr_epi32(s1*n, 0, 0, 0, 0, 0, 0, 0);
+		__m256i v_s2 = _mm256_setr_epi32(s2, 0, 0, 0, 0, 0, 0, 0);
+		__m256i v_s1 = _mm256_setzero_si256();
+
+		do
+		{
+			const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf));
+
+			v_ps = _mm256_add_epi32(v_ps, v_s1);
+			v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+			const __m256i mad = _mm256_maddubs_epi16(bytes, tap);
+			v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(mad, ones));
+
+			buf += block_size;
+		} while (--n);
+
+		v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+
+		__m128i r_s1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1), _mm256_extracti128_si256(v_s1, 1));
+		r_s1 = _mm_add_epi32(r_s1, _mm_shuffle_epi32(r_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+		r_s1 = _mm_add_epi32(r_s1, _mm_shuffle_epi32(r_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+		s1 += static_cast<unsigned int>(_mm_cvtsi128_si32(r_s1));
+
+		__m128i r_s2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2), _mm256_extracti128_si256(v_s2, 1));
+		r_s2 = _mm_add_epi32(r_s2, _mm_shuffle_epi32(r_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+		r_s2 = _mm_add_epi32(r_s2, _mm_shuffle_epi32(r_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+		s2 = static_cast<unsigned int>(_mm_cvtsi128_si32(r_s2));
+
+		MOD(s1);
+		MOD(s2);
+	}
+
+	return adler32_scalar(s1 | (s2 << 16), reinterpret_cast<const char*>(buf), len);
+}
+
+URB_TARGET("avx512f,avx512bw")
+static unsigned int adler32_avx512(unsigned int adler, const char* pbuf, unsigned int len)
+{
+	const unsigned char* buf = reinterpret_cast<const unsigned char*>(pbuf);
+	unsigned int s1 = adler & 0xffff;
+	unsigned int s2 = (adler >> 16) & 0xffff;
+
+	const unsigned int block_size = 64;
+	unsigned int blocks = len / block_size;
+	len -= blocks*block_size;
+
+	const __m512i tap = _mm512_set_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+		17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+		33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
+		49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64);
+	const __m512i zero = _mm512_setzero_si512();
+	const __m512i ones = _mm512_set1_epi16(1);
+
+	while (blocks)
+	{
+		unsigned int n = NMAX / block_size;
+		if (n > blocks)
+			n = blocks;
+		blocks -= n;
+
+		__m512i v_ps = _mm512_maskz_set1_epi32(1, static_cast<int>(s1*n));
+		__m512i v_s2 = _mm512_maskz_set1_epi32(1, static_cast<int>(s2));
+		__m512i v_s1 = _mm512_setzero_si512();
+
+		do
+		{
+			const __m512i bytes = _mm512_loadu_si512(buf);
+
+			v_ps = _mm512_add_epi32(v_ps, v_s1);
+			v_s1 = _mm512_add_epi32(v_s1, _mm512_sad_epu8(bytes, zero));
+			const __m512i mad = _mm512_maddubs_epi16(bytes, tap);
+			v_s2 = _mm512_add_epi32(v_s2, _mm512_madd_epi16(mad, ones));
+
+			buf += block_size;
+		} while (--n);
+
+		v_s2 = _mm512_add_epi32(v_s2, _mm512_slli_epi32(v_ps, 6));
+
+		s1 += static_cast<unsigned int>(_mm512_reduce_add_epi32(v_s1));
+		s2 = static_cast<unsigned int>(_mm512_reduce_add_epi32(v_s2));
+
+		MOD(s1);
+		MOD(s2);
+	}
+
+	return adler32_scalar(s1 | (s2 << 16), reinterpret_cast<const char*>(buf), len);
+}
+
+#endif //URB_X86_SIMD
+
+namespace
+{
+	typedef unsigned int(*adler32_fun_t)(unsigned int adler, const char* pbuf, unsigned int len);
+
+	adler32_fun_t select_adler32()
+	{
+#ifdef URB_X86_SIMD
+		const cpu_features::SFeatures& features = cpu_features::get();
+		if (features.avx512bw)
+			return adler32_avx512;
+		if (features.avx2)
+			return adler32_avx2;
+		if (features.ssse3)
+			return adler32_ssse3;
+#endif
+		return adler32_scalar;
+	}
+
+	adler32_fun_t adler32_impl()
+	{
+		static const adler32_fun_t impl = select_adler32();
+		return impl;
+	}
+}
+
+unsigned int urb_adler32(unsigned int adler, const char* pbuf, unsigned int len)
+{
+	if (len < 64 || pbuf == nullptr)
+		return adler32_scalar(adler, pbuf, len);
+
+	return adler32_impl()(adler, pbuf, len);
+}
+
+void urb_adler32_blocks(const char* pbuf, unsigned int len, unsigned int block_size, unsigned int* out)
+{
+	const unsigned int init = adler32_scalar(0, nullptr, 0);
+	const adler32_fun_t impl = adler32_impl();
+	for (unsigned int off = 0; off < len; off += block_size)
+	{
+		unsigned int r = (len - off) < block_size ? (len - off) : block_size;
+		*out = impl(init, pbuf + off, r);
+		++out;
+	}
+}
+
 unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int len2)
 {
 	unsigned long sum1;
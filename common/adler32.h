@@ -2,4 +2,8 @@
 
 unsigned int urb_adler32(unsigned int adler, const char *pbuf, unsigned int len);
 
+//Computes the Adler-32 of each block_size sized block of pbuf into out
+//(last block may be shorter). Uses the fastest available SIMD variant.
+void urb_adler32_blocks(const char* pbuf, unsigned int len, unsigned int block_size, unsigned int* out);
+
 unsigned int urb_adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int len2);
\ No newline at end of file
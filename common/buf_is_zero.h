@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define URB_BUF_IS_ZERO_SSE2
+#endif
+
+//Returns true if all bsize bytes at buf are zero. Checks 64 bytes
+//per iteration with SSE2 (word-wide without it) and returns early
+//on the first non-zero block.
+inline bool buf_is_zero(const char* buf, size_t bsize)
+{
+	size_t i = 0;
+
+#ifdef URB_BUF_IS_ZERO_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 64 <= bsize; i += 64)
+	{
+		const __m128i* p = reinterpret_cast<const __m128i*>(buf + i);
+		__m128i v = _mm_or_si128(
+			_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+			_mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF)
+		{
+			return false;
+		}
+	}
+#endif
+
+	for (; i + sizeof(unsigned long long) <= bsize; i += sizeof(unsigned long long))
+	{
+		unsigned long long w;
+		memcpy(&w, buf + i, sizeof(w));
+		if (w != 0)
+		{
+			return false;
+		}
+	}
+
+	for (; i < bsize; ++i)
+	{
+		if (buf[i] != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline bool buf_is_zero(const unsigned char* buf, size_t bsize)
+{
+	return buf_is_zero(reinterpret_cast<const char*>(buf), bsize);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define URB_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define URB_TARGET(x)
+#else
+#include <cpuid.h>
+#define URB_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+namespace cpu_features
+{
+	struct SFeatures
+	{
+		SFeatures()
+			: sse2(false), ssse3(false), sse41(false), avx2(false),
+			avx512bw(false), sha(false)
+		{
+#ifdef URB_X86_SIMD
+			unsigned int regs1[4] = {};
+			unsigned int regs7[4] = {};
+			if (!cpuid(0, regs1))
+				return;
+			unsigned int max_leaf = regs1[0];
+			cpuid(1, regs1);
+			if (max_leaf >= 7)
+				cpuid(7, regs7);
+
+			sse2 = (regs1[3] & (1 << 26)) != 0;
+			ssse3 = (regs1[2] & (1 << 9)) != 0;
+			sse41 = (regs1[2] & (1 << 19)) != 0;
+			sha = (regs7[1] & (1 << 29)) != 0;
+
+			bool osxsave = (regs1[2] & (1 << 27)) != 0;
+			bool avx = (regs1[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx)
+				return;
+
+			unsigned long long xcr0 = xgetbv();
+			if ((xcr0 & 0x6) != 0x6)
+				return;
+
+			avx2 = (regs7[1] & (1 << 5)) != 0;
+
+			if ((xcr0 & 0xE6) == 0xE6)
+			{
+				avx512bw = (regs7[1] & (1 << 16)) != 0
+					&& (regs7[1] & (1 << 30)) != 0;
+			}
+#endif
+		}
+
+		bool sse2;
+		bool ssse3;
+		bool sse41;
+		bool avx2;
+		bool avx512bw;
+		bool sha;
+
+	private:
+#ifdef URB_X86_SIMD
+		static bool cpuid(unsigned int leaf, unsigned int regs[4])
+		{
+#ifdef _MSC_VER
+			int r[4];
+			__cpuidex(r, static_cast<int>(leaf), 0);
+			for (int i = 0; i < 4; ++i)
+				regs[i] = static_cast<unsigned int>(r[i]);
+			return true;
+#else
+			return __get_cpuid_count(leaf, 0, &regs[0], &regs[1], &regs[2], &regs[3]) != 0;
+#endif
+		}
+
+		static unsigned long long xgetbv()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			unsigned int eax, edx;
+			__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+		}
+#endif
+	};
+
+	inline const SFeatures& get()
+	{
+		static SFeatures features;
+		return features;
+	}
+}
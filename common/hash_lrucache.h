@@ -0,0 +1,490 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#pragma once
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdlib.h>
+
+namespace common
+{
+
+/**
+* LRU cache with the same interface as lrucache. Keys are looked up in an
+* open addressing hash table (linear probing, backward shift deletion)
+* instead of a std::map. The LRU order is an intrusive doubly linked list
+* through nodes that are allocated in blocks and reused via a free list, so
+* items have stable addresses and iterators stay valid until their item is
+* deleted, like std::list iterators.
+*/
+template<typename K, typename V, typename H = std::hash<K> >
+class hash_lrucache
+{
+	struct node
+	{
+		node()
+			: prev(nullptr), next(nullptr), hash(0)
+		{
+			item.first = &key;
+		}
+
+		std::pair<K const *, V> item;
+		K key;
+		node* prev;
+		node* next;
+		size_t hash;
+	};
+
+public:
+	class iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef std::pair<K const *, V> value_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type* pointer;
+		typedef value_type& reference;
+
+		iterator()
+			: n(nullptr) {}
+
+		explicit iterator(node* n)
+			: n(n) {}
+
+		reference operator*() const { return n->item; }
+		pointer operator->() const { return &n->item; }
+
+		iterator& operator++() { n = n->next; return *this; }
+		iterator operator++(int) { iterator ret = *this; n = n->next; return ret; }
+		iterator& operator--() { n = n->prev; return *this; }
+		iterator operator--(int) { iterator ret = *this; n = n->prev; return ret; }
+
+		bool operator==(const iterator& other) const { return n == other.n; }
+		bool operator!=(const iterator& other) const { return n != other.n; }
+
+	private:
+		node* n;
+		friend class hash_lrucache;
+	};
+
+	class list_t
+	{
+	public:
+		typedef typename hash_lrucache::iterator iterator;
+
+		list_t()
+		{
+			head.prev = &head;
+			head.next = &head;
+		}
+
+		iterator begin() { return iterator(head.next); }
+		iterator end() { return iterator(&head); }
+		bool empty() const { return head.next == &head; }
+
+	private:
+		list_t(const list_t&) = delete;
+		list_t& operator=(const list_t&) = delete;
+
+		node head;
+		friend class hash_lrucache;
+	};
+
+	hash_lrucache()
+		: n_items(0), free_nodes(nullptr)
+	{}
+
+	void put(const K& key, const V& v)
+	{
+		size_t hash = hasher(key);
+		node* n = find_node(key, hash);
+
+		if(n!=nullptr)
+		{
+			link_after(n, &lru_list.head);
+			n->item.second=v;
+		}
+		else
+		{
+			n = new_node(key, hash, v);
+			link_after(n, &lru_list.head);
+		}
+	}
+
+	void put_after(const K& key, const K& put_key, const V& v)
+	{
+		node* n_after = find_node(key, hasher(key));
+
+		if (n_after != nullptr)
+		{
+			size_t hash = hasher(put_key);
+			node* n = find_node(put_key, hash);
+			if (n != nullptr)
+			{
+				if (n != n_after)
+				{
+					link_after(n, n_after->prev);
+				}
+			}
+			else
+			{
+				n = new_node(put_key, hash, v);
+				link_after(n, n_after->prev);
+			}
+		}
+		else
+		{
+			put(put_key, v);
+		}
+	}
+
+	void put_back(const K& key, const V& v)
+	{
+		size_t hash = hasher(key);
+		node* n = find_node(key, hash);
+
+		if(n!=nullptr)
+		{
+			n->item.second=v;
+		}
+		else
+		{
+			n = new_node(key, hash, v);
+			link_after(n, lru_list.head.prev);
+		}
+	}
+
+	bool change_key(const K& old_key, const K& new_key)
+	{
+		node* n = find_node(old_key, hasher(old_key));
+
+		if (n != nullptr)
+		{
+			table_erase(n);
+			n->key = new_key;
+			n->hash = hasher(new_key);
+			table_insert(n);
+			return true;
+		}
+		return false;
+	}
+
+	bool check()
+	{
+		size_t n_list = 0;
+		for (node* n = lru_list.head.next; n != &lru_list.head; n = n->next)
+		{
+			if (n->next->prev != n
+				|| n->item.first != &n->key
+				|| find_node(n->key, hasher(n->key)) != n)
+				return false;
+
+			++n_list;
+		}
+
+		size_t n_table = 0;
+		for (size_t i = 0; i < table.size(); ++i)
+		{
+			if (table[i] != nullptr)
+				++n_table;
+		}
+
+		return n_list == n_items && n_table == n_items;
+	}
+
+	size_t size() const
+	{
+		return n_items;
+	}
+
+	bool empty() const
+	{
+		return n_items == 0;
+	}
+
+	V* get(const K& key, bool bring_front=true)
+	{
+		node* n = find_node(key, hasher(key));
+
+		if(n!=nullptr)
+		{
+			if (bring_front)
+			{
+				link_after(n, &lru_list.head);
+			}
+
+			if (n->key != key)
+				abort();
+
+			return &n->item.second;
+		}
+		else
+		{
+			return reinterpret_cast<V*>(0);
+		}
+	}
+
+	bool has_key(const K& key)
+	{
+		return find_node(key, hasher(key)) != nullptr;
+	}
+
+	std::pair<K, V> evict_one()
+	{
+		if(!lru_list.empty())
+		{
+			node* n = lru_list.head.prev;
+
+			std::pair<K, V> ret(n->key, n->item.second);
+
+			delete_node(n);
+
+			return ret;
+		}
+		else
+		{
+			return std::pair<K, V>();
+		}
+	}
+
+	iterator eviction_iterator_start()
+	{
+		return lru_list.end();
+	}
+
+	iterator eviction_iterator_finish()
+	{
+		return lru_list.begin();
+	}
+
+	std::pair<K, V> eviction_candidate(size_t skip=0)
+	{
+		if(!lru_list.empty())
+		{
+			node* n = lru_list.head.prev;
+
+			for(size_t i=0;i<skip;++i)
+			{
+				if(n==lru_list.head.next)
+				{
+					return std::pair<K, V>();
+				}
+
+				n = n->prev;
+			}
+
+			return std::make_pair(n->key, n->item.second);
+		}
+		else
+		{
+			return std::pair<K, V>();
+		}
+	}
+
+	void del(const K& key)
+	{
+		node* n = find_node(key, hasher(key));
+
+		if(n!=nullptr)
+		{
+			delete_node(n);
+		}
+	}
+
+	list_t& get_list()
+	{
+		return lru_list;
+	}
+
+	void clear()
+	{
+		lru_list.head.prev = &lru_list.head;
+		lru_list.head.next = &lru_list.head;
+		table.clear();
+		blocks.clear();
+		free_nodes = nullptr;
+		n_items = 0;
+	}
+
+	void bring_to_front(iterator it)
+	{
+		link_after(it.n, &lru_list.head);
+	}
+
+private:
+	hash_lrucache(const hash_lrucache&) = delete;
+	hash_lrucache& operator=(const hash_lrucache&) = delete;
+
+	static const size_t block_nodes = 1024;
+
+	node* find_node(const K& key, size_t hash) const
+	{
+		if (table.empty())
+			return nullptr;
+
+		size_t mask = table.size() - 1;
+		for (size_t i = hash & mask;; i = (i + 1) & mask)
+		{
+			node* n = table[i];
+			if (n == nullptr)
+				return nullptr;
+
+			if (n->hash == hash
+				&& n->key == key)
+				return n;
+		}
+	}
+
+	void table_insert(node* n)
+	{
+		if ((n_items + 1) * 10 > table.size() * 7)
+		{
+			grow_table();
+		}
+
+		size_t mask = table.size() - 1;
+		size_t i = n->hash & mask;
+		while (table[i] != nullptr)
+		{
+			i = (i + 1) & mask;
+		}
+		table[i] = n;
+	}
+
+	void table_erase(node* n)
+	{
+		size_t mask = table.size() - 1;
+		size_t i = n->hash & mask;
+		while (table[i] != n)
+		{
+			i = (i + 1) & mask;
+		}
+
+		//Shift following entries of the probe sequence back into the hole
+		size_t j = i;
+		while (true)
+		{
+			j = (j + 1) & mask;
+			node* m = table[j];
+			if (m == nullptr)
+				break;
+
+			size_t home = m->hash & mask;
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				table[i] = m;
+				i = j;
+			}
+		}
+		table[i] = nullptr;
+	}
+
+	void grow_table()
+	{
+		std::vector<node*> old_table;
+		old_table.swap(table);
+		table.resize(old_table.empty() ? 16 : old_table.size() * 2, nullptr);
+
+		size_t mask = table.size() - 1;
+		for (size_t k = 0; k < old_table.size(); ++k)
+		{
+			node* n = old_table[k];
+			if (n == nullptr)
+				continue;
+
+			size_t i = n->hash & mask;
+			while (table[i] != nullptr)
+			{
+				i = (i + 1) & mask;
+			}
+			table[i] = n;
+		}
+	}
+
+	node* new_node(const K& key, size_t hash, const V& v)
+	{
+		if (free_nodes == nullptr)
+		{
+			blocks.push_back(std::unique_ptr<node[]>(new node[block_nodes]));
+			node* block = blocks.back().get();
+			for (size_t i = 0; i < block_nodes; ++i)
+			{
+				block[i].next = free_nodes;
+				free_nodes = &block[i];
+			}
+		}
+
+		node* n = free_nodes;
+		free_nodes = n->next;
+
+		n->key = key;
+		n->hash = hash;
+		n->item.second = v;
+		n->prev = n;
+		n->next = n;
+
+		table_insert(n);
+		++n_items;
+
+		return n;
+	}
+
+	void delete_node(node* n)
+	{
+		table_erase(n);
+
+		n->prev->next = n->next;
+		n->next->prev = n->prev;
+
+		n->key = K();
+		n->item.second = V();
+		n->prev = nullptr;
+		n->next = free_nodes;
+		free_nodes = n;
+
+		--n_items;
+	}
+
+	//Moves n directly after pos. n may be unlinked (pointing to itself)
+	void link_after(node* n, node* pos)
+	{
+		if (n == pos || pos->next == n)
+			return;
+
+		n->prev->next = n->next;
+		n->next->prev = n->prev;
+
+		n->prev = pos;
+		n->next = pos->next;
+		pos->next->prev = n;
+		pos->next = n;
+	}
+
+	H hasher;
+	list_t lru_list;
+	std::vector<node*> table;
+	std::vector<std::unique_ptr<node[]> > blocks;
+	size_t n_items;
+	node* free_nodes;
+};
+
+}
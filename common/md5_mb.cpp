@@ -0,0 +1,299 @@
+/*
+Multi-buffer MD5 (RFC 1321, derived from the RSA Data Security, Inc.
+MD5 Message-Digest Algorithm). Hashes several independent buffers at once
+with one buffer per SIMD lane. Lanes run in lock step over the blocks all
+buffers have. The remaining blocks and the padding are hashed per buffer.
+*/
+
+#include "md5_mb.h"
+#include "cpu_features.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(URB_X86_SIMD) && (defined(__SSE2__) || defined(_MSC_VER))
+#define MD5_MB_SSE2
+#endif
+
+namespace
+{
+	const size_t c_block_size = 64;
+
+	struct ScalarOps
+	{
+		typedef unsigned int V;
+
+		static V set1(unsigned int k) { return k; }
+		static V add(V a, V b) { return a + b; }
+		static V f(V x, V y, V z) { return z ^ (x & (y ^ z)); }
+		static V g(V x, V y, V z) { return y ^ (z & (x ^ y)); }
+		static V h(V x, V y, V z) { return x ^ y ^ z; }
+		static V i(V x, V y, V z) { return y ^ (x | ~z); }
+
+		template<int s>
+		static V rotl(V x) { return (x << s) | (x >> (32 - s)); }
+	};
+
+#define MD5_STEP(fn, a, b, c, d, x, k, s) \
+	a = O::add(b, O::template rotl<s>(O::add(O::add(a, O::fn(b, c, d)), O::add(x, O::set1(k)))))
+
+	//One MD5 block for all lanes of V. w are the 16 message words
+	template<typename O>
+	inline void md5_rounds(typename O::V state[4], const typename O::V w[16])
+	{
+		typename O::V a = state[0];
+		typename O::V b = state[1];
+		typename O::V c = state[2];
+		typename O::V d = state[3];
+
+		MD5_STEP(f, a, b, c, d, w[0], 0xd76aa478, 7);
+		MD5_STEP(f, d, a, b, c, w[1], 0xe8c7b756, 12);
+		MD5_STEP(f, c, d, a, b, w[2], 0x242070db, 17);
+		MD5_STEP(f, b, c, d, a, w[3], 0xc1bdceee, 22);
+		MD5_STEP(f, a, b, c, d, w[4], 0xf57c0faf, 7);
+		MD5_STEP(f, d, a, b, c, w[5], 0x4787c62a, 12);
+		MD5_STEP(f, c, d, a, b, w[6], 0xa8304613, 17);
+		MD5_STEP(f, b, c, d, a, w[7], 0xfd469501, 22);
+		MD5_STEP(f, a, b, c, d, w[8], 0x698098d8, 7);
+		MD5_STEP(f, d, a, b, c, w[9], 0x8b44f7af, 12);
+		MD5_STEP(f, c, d, a, b, w[10], 0xffff5bb1, 17);
+		MD5_STEP(f, b, c, d, a, w[11], 0x895cd7be, 22);
+		MD5_STEP(f, a, b, c, d, w[12], 0x6b901122, 7);
+		MD5_STEP(f, d, a, b, c, w[13], 0xfd987193, 12);
+		MD5_STEP(f, c, d, a, b, w[14], 0xa679438e, 17);
+		MD5_STEP(f, b, c, d, a, w[15], 0x49b40821, 22);
+
+		MD5_STEP(g, a, b, c, d, w[1], 0xf61e2562, 5);
+		MD5_STEP(g, d, a, b, c, w[6], 0xc040b340, 9);
+		MD5_STEP(g, c, d, a, b, w[11], 0x265e5a51, 14);
+		MD5_STEP(g, b, c, d, a, w[0], 0xe9b6c7aa, 20);
+		MD5_STEP(g, a, b, c, d, w[5], 0xd62f105d, 5);
+		MD5_STEP(g, d, a, b, c, w[10], 0x02441453, 9);
+		MD5_STEP(g, c, d, a, b, w[15], 0xd8a1e681, 14);
+		MD5_STEP(g, b, c, d, a, w[4], 0xe7d3fbc8, 20);
+		MD5_STEP(g, a, b, c, d, w[9], 0x21e1cde6, 5);
+		MD5_STEP(g, d, a, b, c, w[14], 0xc33707d6, 9);
+		MD5_STEP(g, c, d, a, b, w[3], 0xf4d50d87, 14);
+		MD5_STEP(g, b, c, d, a, w[8], 0x455a14ed, 20);
+		MD5_STEP(g, a, b, c, d, w[13], 0xa9e3e905, 5);
+		MD5_STEP(g, d, a, b, c, w[2], 0xfcefa3f8, 9);
+		MD5_STEP(g, c, d, a, b, w[7], 0x676f02d9, 14);
+		MD5_STEP(g, b, c, d, a, w[12], 0x8d2a4c8a, 20);
+
+		MD5_STEP(h, a, b, c, d, w[5], 0xfffa3942, 4);
+		MD5_STEP(h, d, a, b, c, w[8], 0x8771f681, 11);
+		MD5_STEP(h, c, d, a, b, w[11], 0x6d9d6122, 16);
+		MD5_STEP(h, b, c, d, a, w[14], 0xfde5380c, 23);
+		MD5_STEP(h, a, b, c, d, w[1], 0xa4beea44, 4);
+		MD5_STEP(h, d, a, b, c, w[4], 0x4bdecfa9, 11);
+		MD5_STEP(h, c, d, a, b, w[7], 0xf6bb4b60, 16);
+		MD5_STEP(h, b, c, d, a, w[10], 0xbebfbc70, 23);
+		MD5_STEP(h, a, b, c, d, w[13], 0x289b7ec6, 4);
+		MD5_STEP(h, d, a, b, c, w[0], 0xeaa127fa, 11);
+		MD5_STEP(h, c, d, a, b, w[3], 0xd4ef3085, 16);
+		MD5_STEP(h, b, c, d, a, w[6], 0x04881d05, 23);
+		MD5_STEP(h, a, b, c, d, w[9], 0xd9d4d039, 4);
+		MD5_STEP(h, d, a, b, c, w[12], 0xe6db99e5, 11);
+		MD5_STEP(h, c, d, a, b, w[15], 0x1fa27cf8, 16);
+		MD5_STEP(h, b, c, d, a, w[2], 0xc4ac5665, 23);
+
+		MD5_STEP(i, a, b, c, d, w[0], 0xf4292244, 6);
+		MD5_STEP(i, d, a, b, c, w[7], 0x432aff97, 10);
+		MD5_STEP(i, c, d, a, b, w[14], 0xab9423a7, 15);
+		MD5_STEP(i, b, c, d, a, w[5], 0xfc93a039, 21);
+		MD5_STEP(i, a, b, c, d, w[12], 0x655b59c3, 6);
+		MD5_STEP(i, d, a, b, c, w[3], 0x8f0ccc92, 10);
+		MD5_STEP(i, c, d, a, b, w[10], 0xffeff47d, 15);
+		MD5_STEP(i, b, c, d, a, w[1], 0x85845dd1, 21);
+		MD5_STEP(i, a, b, c, d, w[8], 0x6fa87e4f, 6);
+		MD5_STEP(i, d, a, b, c, w[15], 0xfe2ce6e0, 10);
+		MD5_STEP(i, c, d, a, b, w[6], 0xa3014314, 15);
+		MD5_STEP(i, b, c, d, a, w[13], 0x4e0811a1, 21);
+		MD5_STEP(i, a, b, c, d, w[4], 0xf7537e82, 6);
+		MD5_STEP(i, d, a, b, c, w[11], 0xbd3af235, 10);
+		MD5_STEP(i, c, d, a, b, w[2], 0x2ad7d2bb, 15);
+		MD5_STEP(i, b, c, d, a, w[9], 0xeb86d391, 21);
+
+		state[0] = O::add(state[0], a);
+		state[1] = O::add(state[1], b);
+		state[2] = O::add(state[2], c);
+		state[3] = O::add(state[3], d);
+	}
+
+#undef MD5_STEP
+
+	void md5_init(unsigned int state[4])
+	{
+		state[0] = 0x67452301;
+		state[1] = 0xefcdab89;
+		state[2] = 0x98badcfe;
+		state[3] = 0x10325476;
+	}
+
+	void md5_blocks_scalar(unsigned int state[4], const unsigned char* data, size_t n_blocks)
+	{
+		for (size_t j = 0; j < n_blocks; ++j, data += c_block_size)
+		{
+			unsigned int w[16];
+			for (size_t k = 0; k < 16; ++k)
+			{
+				w[k] = static_cast<unsigned int>(data[k * 4])
+					| (static_cast<unsigned int>(data[k * 4 + 1]) << 8)
+					| (static_cast<unsigned int>(data[k * 4 + 2]) << 16)
+					| (static_cast<unsigned int>(data[k * 4 + 3]) << 24);
+			}
+			md5_rounds<ScalarOps>(state, w);
+		}
+	}
+
+	//Hashes the remaining data of a buffer after done bytes were hashed into state
+	void md5_finish(unsigned int state[4], const unsigned char* buf, size_t len, size_t done, unsigned char digest[16])
+	{
+		size_t n_full = (len - done) / c_block_size;
+		md5_blocks_scalar(state, buf + done, n_full);
+		done += n_full*c_block_size;
+
+		unsigned char last[2 * c_block_size] = {};
+		size_t rest = len - done;
+		memcpy(last, buf + done, rest);
+		last[rest] = 0x80;
+
+		size_t n_last = rest + 1 + 8 > c_block_size ? 2 : 1;
+		unsigned long long bits = static_cast<unsigned long long>(len) * 8;
+		for (size_t k = 0; k < 8; ++k)
+		{
+			last[n_last*c_block_size - 8 + k] = static_cast<unsigned char>(bits >> (k * 8));
+		}
+		md5_blocks_scalar(state, last, n_last);
+
+		for (size_t k = 0; k < 4; ++k)
+		{
+			for (size_t l = 0; l < 4; ++l)
+			{
+				digest[k * 4 + l] = static_cast<unsigned char>(state[k] >> (l * 8));
+			}
+		}
+	}
+
+#ifdef MD5_MB_SSE2
+	struct Sse2Ops
+	{
+		typedef __m128i V;
+
+		static V set1(unsigned int k) { return _mm_set1_epi32(static_cast<int>(k)); }
+		static V add(V a, V b) { return _mm_add_epi32(a, b); }
+		static V f(V x, V y, V z) { return _mm_xor_si128(z, _mm_and_si128(x, _mm_xor_si128(y, z))); }
+		static V g(V x, V y, V z) { return _mm_xor_si128(y, _mm_and_si128(z, _mm_xor_si128(x, y))); }
+		static V h(V x, V y, V z) { return _mm_xor_si128(_mm_xor_si128(x, y), z); }
+		static V i(V x, V y, V z) { return _mm_xor_si128(y, _mm_or_si128(x, _mm_xor_si128(z, _mm_set1_epi32(-1)))); }
+
+		template<int s>
+		static V rotl(V x) { return _mm_or_si128(_mm_slli_epi32(x, s), _mm_srli_epi32(x, 32 - s)); }
+	};
+
+	const size_t c_sse2_lanes = 4;
+
+	//Hashes n_blocks blocks of four buffers. State is in lanes
+	void md5_blocks_sse2(__m128i state[4], const unsigned char* const bufs[c_sse2_lanes], size_t n_blocks)
+	{
+		for (size_t j = 0; j < n_blocks; ++j)
+		{
+			size_t off = j*c_block_size;
+			__m128i w[16];
+			for (size_t k = 0; k < 4; ++k)
+			{
+				//Transpose 4x4 words, so that w[n] has word n of each buffer
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bufs[0] + off + k * 16));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bufs[1] + off + k * 16));
+				__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bufs[2] + off + k * 16));
+				__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bufs[3] + off + k * 16));
+				__m128i t0 = _mm_unpacklo_epi32(a, b);
+				__m128i t1 = _mm_unpacklo_epi32(c, d);
+				__m128i t2 = _mm_unpackhi_epi32(a, b);
+				__m128i t3 = _mm_unpackhi_epi32(c, d);
+				w[k * 4] = _mm_unpacklo_epi64(t0, t1);
+				w[k * 4 + 1] = _mm_unpackhi_epi64(t0, t1);
+				w[k * 4 + 2] = _mm_unpacklo_epi64(t2, t3);
+				w[k * 4 + 3] = _mm_unpackhi_epi64(t2, t3);
+			}
+			md5_rounds<Sse2Ops>(state, w);
+		}
+	}
+
+	//Up to four buffers. Unused lanes hash the first buffer again
+	void md5_mb_sse2(const char* const* bufs, const size_t* lens, size_t n, unsigned char* digests)
+	{
+		const unsigned char* lane_bufs[c_sse2_lanes];
+		size_t min_len = lens[0];
+		for (size_t l = 0; l < c_sse2_lanes; ++l)
+		{
+			size_t idx = l < n ? l : 0;
+			lane_bufs[l] = reinterpret_cast<const unsigned char*>(bufs[idx]);
+			min_len = (std::min)(min_len, lens[idx]);
+		}
+
+		unsigned int init[4];
+		md5_init(init);
+
+		__m128i state[4];
+		for (size_t k = 0; k < 4; ++k)
+		{
+			state[k] = _mm_set1_epi32(static_cast<int>(init[k]));
+		}
+
+		size_t n_blocks = min_len / c_block_size;
+		md5_blocks_sse2(state, lane_bufs, n_blocks);
+
+		unsigned int lane_state[4][c_sse2_lanes];
+		for (size_t k = 0; k < 4; ++k)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lane_state[k]), state[k]);
+		}
+
+		for (size_t l = 0; l < n; ++l)
+		{
+			unsigned int s[4] = { lane_state[0][l], lane_state[1][l], lane_state[2][l], lane_state[3][l] };
+			md5_finish(s, lane_bufs[l], lens[l], n_blocks*c_block_size, digests + l * 16);
+		}
+	}
+#endif //MD5_MB_SSE2
+
+	bool has_sse2()
+	{
+#ifdef MD5_MB_SSE2
+		static const bool ret = cpu_features::get().sse2;
+		return ret;
+#else
+		return false;
+#endif
+	}
+}
+
+size_t md5_mb_lanes()
+{
+#ifdef MD5_MB_SSE2
+	if (has_sse2())
+		return c_sse2_lanes;
+#endif
+	return 1;
+}
+
+void md5_mb(const char* const* bufs, const size_t* lens, size_t n, unsigned char* digests)
+{
+	size_t i = 0;
+#ifdef MD5_MB_SSE2
+	if (has_sse2())
+	{
+		for (; i + 1 < n; i += c_sse2_lanes)
+		{
+			md5_mb_sse2(bufs + i, lens + i, (std::min)(c_sse2_lanes, n - i), digests + i * 16);
+		}
+	}
+#endif
+
+	for (; i < n; ++i)
+	{
+		unsigned int state[4];
+		md5_init(state);
+		md5_finish(state, reinterpret_cast<const unsigned char*>(bufs[i]), lens[i], 0, digests + i * 16);
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stddef.h>
+
+//Number of buffers md5_mb hashes in parallel (1 without SIMD support)
+size_t md5_mb_lanes();
+
+//Computes the MD5 of each of the n buffers into digests (16 bytes per buffer).
+//Buffers may have different lengths. Hashes md5_mb_lanes() buffers at once.
+void md5_mb(const char* const* bufs, const size_t* lens, size_t n, unsigned char* digests);
@@ -0,0 +1,12 @@
+#define HAVE_PTHREAD_H 1
+#define HAVE_ARPA_INET_H 1
+#define HAVE_FCNTL_H 1
+#define HAVE_NETDB_H 1
+#define HAVE_NETINET_IN_H 1
+#define HAVE_STDLIB_H 1
+#define HAVE_SYS_SOCKET_H 1
+#define HAVE_SYS_TIME_H 1
+#define HAVE_UNISTD_H 1
+#define HAVE_LINUX_FIEMAP_H 1
+#define HAVE_SYS_RANDOM_H 1
+#define HAVE_FALLOCATE64 1
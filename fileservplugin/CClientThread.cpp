@@ -86,6 +86,7 @@
 #define CLIENT_TIMEOUT	120
 #define CHECK_BASE_PATH
 #define SEND_TIMEOUT 300000
+#define SENDFILE_BSIZE (4*1024*1024)
 
 
 CClientThread::CClientThread(SOCKET pSocket, CTCPFileServ* pParent)
@@ -128,6 +129,18 @@ CClientThread::CClientThread(SOCKET pSocket, CTCPFileServ* pParent)
 	}
 #endif
 
+#ifndef _WIN32
+	//sendfile() writes to the blocking socket directly. Bound it the same way
+	//as writes via the pipe
+	timeval send_timeout;
+	send_timeout.tv_sec = SEND_TIMEOUT / 1000;
+	send_timeout.tv_usec = 0;
+	if (setsockopt(pSocket, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout)) != 0)
+	{
+		Log("Error: Can't set SO_SNDTIMEO", LL_DEBUG);
+	}
+#endif
+
 	close_the_socket=true;
 	errcount=0;
 	clientpipe=Server->PipeFromSocket(pSocket);
@@ -1110,7 +1123,16 @@ bool CClientThread::ProcessPacket(CRData *data)
 					    next_checkpoint=curr_filesize;
 				}
 
-				if((clientpipe!=nullptr || with_hashes) && foffset>0)
+				//Data is sent from the page cache to the socket without copying
+				//through user space if there is nothing in between (encryption,
+				//compression, tunnel) and no hashes need to be calculated
+#ifdef __linux__
+				bool use_sendfile = has_socket && !with_hashes;
+#else
+				bool use_sendfile = false;
+#endif
+
+				if(!use_sendfile && foffset>0)
 				{
 					if(lseek64(hFile, foffset, SEEK_SET)!=foffset)
 					{
@@ -1151,7 +1173,7 @@ bool CClientThread::ProcessPacket(CRData *data)
 							if (next_checkpoint>curr_filesize)
 								next_checkpoint = curr_filesize;
 
-							if (clientpipe != nullptr || with_hashes)
+							if (!use_sendfile)
 							{
 								off64_t rc = lseek64(hFile, foffset, SEEK_SET);
 
@@ -1178,7 +1200,8 @@ bool CClientThread::ProcessPacket(CRData *data)
 						}
 					}
 				
-					size_t count=(std::min)((size_t)s_bsize, (size_t)(next_checkpoint-foffset));
+					size_t count=(std::min)(use_sendfile ? (size_t)SENDFILE_BSIZE : (size_t)s_bsize,
+						(size_t)(next_checkpoint-foffset));
 
 					if (has_file_extents)
 					{
@@ -1188,7 +1211,7 @@ bool CClientThread::ProcessPacket(CRData *data)
 						}
 					}
 
-					if( clientpipe==nullptr && !with_hashes && count>0 )
+					if( use_sendfile && count>0 )
 					{
 						#if defined(__APPLE__) || defined(__FreeBSD__)
 						ssize_t rc=sendfile64(int_socket, hFile, foffset, count, reinterpret_cast<off_t*>(&count));
@@ -1200,25 +1223,45 @@ bool CClientThread::ProcessPacket(CRData *data)
 						#else			
 						ssize_t rc=sendfile64(int_socket, hFile, &foffset, count);
 						#endif
-						if(rc<0)
+						if(rc<0 && errno==EINTR)
+						{
+							continue;
+						}
+						else if(rc<0 && (errno==EINVAL || errno==ENOSYS))
+						{
+							//File system does not support sendfile. Use buffered path
+							Log("sendfile not supported for file (errno: "+convert(errno)+"). Falling back to reading and sending.", LL_DEBUG);
+							use_sendfile = false;
+							if (lseek64(hFile, foffset, SEEK_SET) != foffset)
+							{
+								Log("Error: Seeking in file failed (5045)", LL_ERROR);
+								CloseHandle(hFile);
+								return false;
+							}
+							continue;
+						}
+						else if(rc<0)
 						{
 							Log("Error: Reading and sending from file failed. Errno: "+convert(errno), LL_DEBUG);
 							FileServ::callErrorCallback(o_filename, filename, foffset, "code: " + convert(errno));
 							CloseHandle(hFile);
 							return false;
 						}
-						else if(rc==0 && foffset<filesize && errno == 0) //other process made the file smaller
+						else if(rc==0) //other process made the file smaller
 						{
 							memset(buf.data(), 0, s_bsize);
-							while(foffset<filesize)
+							while(count>0)
 							{
-								rc=SendInt(buf.data(), (std::min)((size_t)s_bsize, (size_t)(next_checkpoint-foffset)));
+								size_t tosend = (std::min)((size_t)s_bsize, count);
+								rc=SendInt(buf.data(), tosend);
 								if(rc==SOCKET_ERROR)
 								{
 									Log("Error: Sending data failed");
 									CloseHandle(hFile);
 									return false;
 								}
+								foffset+=tosend;
+								count-=tosend;
 							}
 						}
 					}
@@ -1334,6 +1377,13 @@ bool CClientThread::ProcessPacket(CRData *data)
 					return false;
 				}
 			} break;
+		case ID_PRIORITIZE_PHASH:
+			{
+				if (!PrioritizePhash(data))
+				{
+					return false;
+				}
+			} break;
 		case ID_FREE_SERVER_FILE:
 			{
 				if (chunk_send_thread_ticket != ILLEGAL_THREADPOOL_TICKET)
@@ -2042,7 +2092,7 @@ bool CClientThread::Handle_ID_BLOCK_REQUEST(CRData *data)
 	return true;
 }
 
-bool CClientThread::getNextChunk(SChunk *chunk, bool has_error)
+bool CClientThread::getNextChunk(SChunk *chunk, bool has_error, bool* would_block)
 {
 	IScopedLock lock(mutex);
 
@@ -2051,6 +2101,13 @@ bool CClientThread::getNextChunk(SChunk *chunk, bool has_error)
 		clientpipe->shutdown();
 		return false;
 	}
+
+	if(would_block!=nullptr
+		&& next_chunks.empty() && state==CS_BLOCKHASH)
+	{
+		*would_block=true;
+		return false;
+	}
 	
 	while(next_chunks.empty() && state==CS_BLOCKHASH)
 	{
@@ -2469,6 +2526,59 @@ bool CClientThread::StopPhash(CRData * data)
 	return true;
 }
 
+bool CClientThread::PrioritizePhash(CRData * data)
+{
+#ifdef CHECK_IDENT
+	std::string ident;
+	data->getStr(&ident);
+	if (!FileServ::checkIdentity(ident, is_tunneled))
+	{
+		Log("Identity check failed -phash prio", LL_DEBUG);
+		return false;
+	}
+#endif
+
+	std::string token;
+	data->getStr(&token);
+
+	std::string fn;
+	data->getStr(&fn);
+
+	int64 n_ids;
+	if (!data->getVarInt(&n_ids))
+	{
+		return false;
+	}
+
+	std::vector<int64> file_ids;
+	for (int64 i = 0; i < n_ids; ++i)
+	{
+		int64 file_id;
+		if (!data->getVarInt(&file_id))
+		{
+			return false;
+		}
+		file_ids.push_back(file_id);
+	}
+
+	PipeSessions::phashPrioritize(token, fn, file_ids);
+
+	char ch = ID_PONG;
+	int rc = SendInt(&ch, 1);
+	if (rc == SOCKET_ERROR)
+	{
+		Log("Error: Sending data failed (PrioritizePhash)");
+		return false;
+	}
+
+	if (!clientpipe->Flush(CLIENT_TIMEOUT * 1000))
+	{
+		Server->Log("Error flushing output socket (2)", LL_INFO);
+	}
+
+	return true;
+}
+
 bool CClientThread::FinishScript( CRData * data )
 {
 #ifdef CHECK_IDENT
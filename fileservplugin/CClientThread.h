@@ -115,7 +115,7 @@ public:
 
     int SendInt(const char *buf, size_t bsize, bool flush=false);
 	bool FlushInt();
-	bool getNextChunk(SChunk *chunk, bool has_error);
+	bool getNextChunk(SChunk *chunk, bool has_error, bool* would_block=nullptr);
 
 	static std::string getDummyMetadata(std::string output_fn, int64 folder_items, int64 metadata_id, bool is_dir);
 private:
@@ -137,6 +137,7 @@ private:
 	void queueChunk(const SChunk& chunk);
 	bool InformMetadataStreamEnd( CRData * data );
 	bool StopPhash(CRData * data);
+	bool PrioritizePhash(CRData * data);
 	bool FinishScript( CRData * data );
 
 	struct SExtent
@@ -28,6 +28,8 @@
 #include "../Interface/File.h"
 #include "../Interface/Server.h"
 #include "../common/adler32.h"
+#include "../common/buf_is_zero.h"
+#include "../urbackupcommon/os_functions.h"
 
 #ifndef _WIN32
 #include <errno.h>
@@ -45,24 +47,157 @@ namespace
 #endif
 	}
 
-	bool buf_is_zero(const char* buf, size_t bsize)
+	//Number of checkpoints read ahead and hashed while earlier ones are being sent
+	const size_t c_max_in_flight = 8;
+	const size_t c_max_workers = 4;
+
+	static_assert(c_chunk_size == c_small_hash_dist, "Pipelined chunk hashing assumes one small hash per chunk");
+
+	class ChunkSendWorker : public IThread
 	{
-		for (size_t i = 0; i < bsize; ++i)
+	public:
+		ChunkSendWorker(ChunkSendThread* send_thread)
+			: send_thread(send_thread)
+		{}
+
+		virtual ~ChunkSendWorker()
+		{}
+
+		void operator()()
 		{
-			if (buf[i] != 0)
-			{
-				return false;
-			}
+			send_thread->workerThread();
+			delete this;
 		}
 
-		return true;
+	private:
+		ChunkSendThread* send_thread;
+	};
+}
+
+/**
+* One checkpoint of a file that is read and hashed by a worker
+* while earlier checkpoints are sent. The result is sent in order
+* by the chunk send thread.
+*/
+struct SChunkJob
+{
+	SChunkJob()
+		: buf(new char[c_checkpoint_dist + c_chunk_padding])
+	{}
+
+	void reset(const SChunk& p_chunk, IFile* p_file, _i64 p_file_size)
+	{
+		chunk = p_chunk;
+		file = p_file;
+		file_size = p_file_size;
+		done = false;
+		seek_error = false;
+		read_error = false;
+		errcode = 0;
+		cbt_unchanged = false;
+		index_chunkhash_pos = -1;
+		index_chunkhash_pos_offset = 0;
+		read_total = 0;
+		n_pieces = 0;
 	}
+
+	void readAndHash();
+
+	SChunk chunk;
+	IFile* file;
+	_i64 file_size;
+
+	bool done;
+	bool seek_error;
+	bool read_error;
+	unsigned int errcode;
+	_i64 read_error_pos;
+
+	bool cbt_unchanged;
+	int64 index_chunkhash_pos;
+	_u16 index_chunkhash_pos_offset;
+
+	unsigned int read_total;
+	size_t n_pieces;
+	_u32 piece_size[c_checkpoint_dist / c_chunk_size];
+	unsigned int piece_adler[c_checkpoint_dist / c_chunk_size];
+	char big_hash[big_hash_size];
+
+	//Data starts at c_chunk_padding so that message headers can be put in front of it
+	std::unique_ptr<char[]> buf;
+};
+
+/**
+* Reads the whole checkpoint with as few reads as possible, then splits
+* it into the same c_chunk_size pieces (including zero fill on a short
+* file and the point of a read error) as ChunkSendThread::sendChunk
+*/
+void SChunkJob::readAndHash()
+{
+	_u32 total = static_cast<_u32>((std::min)(c_checkpoint_dist, file_size - chunk.startpos));
+	char* data = buf.get() + c_chunk_padding;
+
+	_u32 got = 0;
+	while (got < total)
+	{
+		bool c_readerr = false;
+		_u32 r_add = file->Read(chunk.startpos + got, data + got, total - got, &c_readerr);
+
+		if (c_readerr)
+		{
+			read_error = true;
+			errcode = getSystemErrorCode();
+			read_error_pos = chunk.startpos + got + r_add;
+			break;
+		}
+
+		if (r_add == 0)
+		{
+			break;
+		}
+
+		got += r_add;
+	}
+
+	_u32 err_piece_start = read_error ? (got - got % c_chunk_size) : total + 1;
+
+	MD5 md5;
+	_u32 pos = 0;
+	_u32 real_r;
+	do
+	{
+		if (pos >= err_piece_start)
+		{
+			break;
+		}
+
+		_u32 to_read = (std::min)(c_chunk_size, total - pos);
+		real_r = got > pos ? (std::min)(to_read, got - pos) : 0;
+
+		if (real_r < to_read)
+		{
+			memset(data + pos + real_r, 0, to_read - real_r);
+		}
+
+		md5.update(reinterpret_cast<unsigned char*>(data + pos), to_read);
+		piece_adler[n_pieces] = urb_adler32(urb_adler32(0, nullptr, 0), data + pos, to_read);
+		piece_size[n_pieces] = to_read;
+		++n_pieces;
+		pos += to_read;
+
+	} while (real_r == c_chunk_size && pos < c_checkpoint_dist);
+
+	read_total = pos;
+
+	md5.finalize();
+	memcpy(big_hash, md5.raw_digest_int(), big_hash_size);
 }
 
 
 ChunkSendThread::ChunkSendThread(CClientThread *parent)
 	: parent(parent), file(nullptr), has_error(false), cbt_hash_file_info(),
-	vdl_vol_cache(nullptr)
+	vdl_vol_cache(nullptr), mutex(nullptr), job_cond(nullptr), done_cond(nullptr),
+	stop_workers(false)
 {
 	chunk_buf=new char[(c_checkpoint_dist/c_chunk_size)*(c_chunk_size)+c_chunk_padding];
 }
@@ -71,13 +206,57 @@ ChunkSendThread::~ChunkSendThread(void)
 {
 	delete []chunk_buf;
 	Server->destroy(vdl_vol_cache);
+
+	for (size_t i = 0; i < free_jobs.size(); ++i)
+	{
+		delete free_jobs[i];
+	}
+
+	if (mutex != nullptr)
+	{
+		Server->destroy(mutex);
+		Server->destroy(job_cond);
+		Server->destroy(done_cond);
+	}
 }
 
 void ChunkSendThread::operator()(void)
 {
 	SChunk chunk;
-	while(parent->getNextChunk(&chunk, has_error))
+	while(true)
 	{
+		bool would_block = false;
+		if (!in_flight.empty()
+			&& in_flight.size() >= c_max_in_flight)
+		{
+			finishFrontChunk();
+			continue;
+		}
+
+		if (!parent->getNextChunk(&chunk, has_error, in_flight.empty() ? nullptr : &would_block))
+		{
+			if (would_block)
+			{
+				finishFrontChunk();
+				continue;
+			}
+			break;
+		}
+
+		if (canPipeline(chunk))
+		{
+			startChunk(chunk);
+			continue;
+		}
+
+		//Everything else has to be handled after the previous chunks were sent
+		finishAllChunks();
+
+		if (has_error)
+		{
+			continue;
+		}
+
 		if(chunk.msg != ID_ILLEGAL && chunk.msg!= ID_FREE_SERVER_FILE && chunk.msg!= ID_FLUSH_SOCKET)
 		{
 			if(parent->SendInt(reinterpret_cast<char*>(&chunk.msg), 1, true)==SOCKET_ERROR)
@@ -218,6 +397,11 @@ void ChunkSendThread::operator()(void)
 		}
 	}
 
+	//Stopped or error. Results of chunks still in flight are not needed anymore
+	has_error = true;
+	finishAllChunks();
+	stopWorkers();
+
 	if(pipe_file_user.get() == nullptr && file!=nullptr)
 	{
 		Server->Log("Closing file (finish) " + file->getFilename(), LL_DEBUG);
@@ -394,10 +578,142 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 	bool script_eof=false;
 	bool cbt_unchanged = false;
 	int64 index_chunkhash_pos = -1;
-	_u16 index_chunkhash_pos_offset;
+	_u16 index_chunkhash_pos_offset = 0;
+
+	checkCbtHash(chunk, cbt_unchanged, index_chunkhash_pos, index_chunkhash_pos_offset);
+
+	std::vector<char> new_chunkhashes;
+	if (index_chunkhash_pos != -1)
+	{
+		new_chunkhashes.resize(sizeof(_u16) + chunkhash_single_size);
+	}
+
+	if (!cbt_unchanged)
+	{
+		do
+		{
+			cptr += r;
+
+			_u32 to_read = c_chunk_size;
+
+			if (curr_file_size <= curr_pos && curr_file_size > 0)
+			{
+				to_read = 0;
+			}
+			else if (curr_file_size - curr_pos < to_read && curr_file_size>0)
+			{
+				to_read = static_cast<_u32>(curr_file_size - curr_pos);
+			}
+
+			bool readerr = false;
+
+			r = file->Read(spos, cptr, to_read, &readerr);
+			spos += r;
+			real_r = r;
+
+			if (readerr)
+			{
+				unsigned int readderr_code = getSystemErrorCode();
+				Server->Log("Reading from file \"" + file->getFilename() + "\" at position " + convert(spos) + " failed (code: " + convert(readderr_code) + ")(2).", LL_ERROR);
+				FileServ::callErrorCallback(s_filename, file->getFilename(), spos, "code: " + convert(readderr_code));
+				return sendError(ERR_READING_FAILED, readderr_code);
+			}
+
+			while (r < to_read)
+			{
+				_u32 r_add = file->Read(spos, cptr + r, to_read - r, &readerr);
+				spos += r_add;
+
+				if (readerr)
+				{
+					unsigned int readderr_code = getSystemErrorCode();
+					Server->Log("Reading from file \"" + file->getFilename() + "\" at position " + convert(spos) + " failed (code: " + convert(readderr_code) + ")(3).", LL_ERROR);
+					FileServ::callErrorCallback(s_filename, file->getFilename(), spos, "code: " + convert(readderr_code));
+					return sendError(ERR_READING_FAILED, readderr_code);
+				}
+
+				if (r_add == 0 && file->Size() != -1)
+				{
+					if (curr_file_size == -1)
+					{
+						if (!script_eof)
+						{
+							Log("Script output eof -2", LL_DEBUG);
+							script_eof = true;
+						}
+
+						break;
+					}
+					else
+					{
+						memset(cptr + r, 0, to_read - r);
+						r = to_read;
+					}
+				}
+
+				r += r_add;
+				real_r += r_add;
+			}
+
+			md5_hash.update((unsigned char*)cptr, (unsigned int)r);
+			c_adler = urb_adler32(c_adler, cptr, r);
+
+			read_total += r;
+
+			if (read_total == next_smallhash || r != c_chunk_size)
+			{
+				_u32 adler_other = little_endian(*((_u32*)&chunk->small_hash[small_hash_size*small_hash_num]));
+				if (c_adler != adler_other
+					|| curr_pos + r > curr_hash_size)
+				{
+					sent_update = true;
+					if (!sendUpdateChunk(cptr, curr_pos, r))
+					{
+						return false;
+					}
+				}
+
+				if (!new_chunkhashes.empty())
+				{
+					_u32 little_c_addler = little_endian(c_adler);
+					memcpy(&new_chunkhashes[sizeof(_u16) + big_hash_size + small_hash_size*small_hash_num], &little_c_addler, sizeof(little_c_addler));
+				}
+
+				c_adler = urb_adler32(0, nullptr, 0);
+				++small_hash_num;
+				next_smallhash += c_small_hash_dist;
+			}
+			curr_pos += r;
+
+		} while (real_r == c_chunk_size && read_total < c_checkpoint_dist);
+	}
+
+	md5_hash.finalize();
+
+	updateCbtHash(index_chunkhash_pos, index_chunkhash_pos_offset, new_chunkhashes,
+		reinterpret_cast<const char*>(md5_hash.raw_digest_int()));
+
+	if (!sendChunkResult(chunk, chunk_buf, read_total, sent_update, cbt_unchanged,
+		reinterpret_cast<const char*>(md5_hash.raw_digest_int())))
+	{
+		return false;
+	}
+
+	if(script_eof)
+	{
+		parent->SendInt(nullptr, 0);
+		return false;
+	}
+
+	return true;
+}
+
+void ChunkSendThread::checkCbtHash(SChunk *chunk, bool& cbt_unchanged, int64& index_chunkhash_pos, _u16& index_chunkhash_pos_offset)
+{
+	int64 spos = chunk->startpos;
 
 	if (cbt_hash_file_info.cbt_hash_file!=nullptr
-		&&  curr_pos+c_checkpoint_dist<=curr_file_size
+		&&  spos+c_checkpoint_dist<=curr_file_size
 		&& (cbt_hash_file_info.metadata_offset!=-1
 			|| !file_extents.empty()
 			|| has_more_extents ) )
@@ -513,149 +829,57 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 			}
 		}
 	}
+}
 
-	std::vector<char> new_chunkhashes;
-	if (index_chunkhash_pos != -1)
-	{
-		new_chunkhashes.resize(sizeof(_u16) + chunkhash_single_size);
-	}
-
-	if (!cbt_unchanged)
-	{
-		do
-		{
-			cptr += r;
-
-			_u32 to_read = c_chunk_size;
-
-			if (curr_file_size <= curr_pos && curr_file_size > 0)
-			{
-				to_read = 0;
-			}
-			else if (curr_file_size - curr_pos < to_read && curr_file_size>0)
-			{
-				to_read = static_cast<_u32>(curr_file_size - curr_pos);
-			}
-
-			bool readerr = false;
-
-			r = file->Read(spos, cptr, to_read, &readerr);
-			spos += r;
-			real_r = r;
-
-			if (readerr)
-			{
-				unsigned int readderr_code = getSystemErrorCode();
-				Server->Log("Reading from file \"" + file->getFilename() + "\" at position " + convert(spos) + " failed (code: " + convert(readderr_code) + ")(2).", LL_ERROR);
-				FileServ::callErrorCallback(s_filename, file->getFilename(), spos, "code: " + convert(readderr_code));
-				return sendError(ERR_READING_FAILED, readderr_code);
-			}
-
-			while (r < to_read)
-			{
-				_u32 r_add = file->Read(spos, cptr + r, to_read - r, &readerr);
-				spos += r_add;
-
-				if (readerr)
-				{
-					unsigned int readderr_code = getSystemErrorCode();
-					Server->Log("Reading from file \"" + file->getFilename() + "\" at position " + convert(spos) + " failed (code: " + convert(readderr_code) + ")(3).", LL_ERROR);
-					FileServ::callErrorCallback(s_filename, file->getFilename(), spos, "code: " + convert(readderr_code));
-					return sendError(ERR_READING_FAILED, readderr_code);
-				}
-
-				if (r_add == 0 && file->Size() != -1)
-				{
-					if (curr_file_size == -1)
-					{
-						if (!script_eof)
-						{
-							Log("Script output eof -2", LL_DEBUG);
-							script_eof = true;
-						}
-
-						break;
-					}
-					else
-					{
-						memset(cptr + r, 0, to_read - r);
-						r = to_read;
-					}
-				}
-
-				r += r_add;
-				real_r += r_add;
-			}
-
-			md5_hash.update((unsigned char*)cptr, (unsigned int)r);
-			c_adler = urb_adler32(c_adler, cptr, r);
-
-			read_total += r;
-
-			if (read_total == next_smallhash || r != c_chunk_size)
-			{
-				_u32 adler_other = little_endian(*((_u32*)&chunk->small_hash[small_hash_size*small_hash_num]));
-				if (c_adler != adler_other
-					|| curr_pos + r > curr_hash_size)
-				{
-					sent_update = true;
-					char tmp_backup[c_chunk_padding];
-					memcpy(tmp_backup, cptr - c_chunk_padding, c_chunk_padding);
-
-					*(cptr - c_chunk_padding) = ID_UPDATE_CHUNK;
-					_i64 curr_pos_tmp = little_endian(curr_pos);
-					memcpy(cptr - sizeof(_i64) - sizeof(_u32), &curr_pos_tmp, sizeof(_i64));
-					_u32 r_tmp = little_endian(r);
-					memcpy(cptr - sizeof(_u32), &r_tmp, sizeof(_u32));
-
-					Log("Sending chunk start=" + convert(curr_pos) + " size=" + convert(r), LL_DEBUG);
-
-					if (parent->SendInt(cptr - c_chunk_padding, c_chunk_padding + r) == SOCKET_ERROR)
-					{
-						Log("Error sending chunk", LL_DEBUG);
-						return false;
-					}
+bool ChunkSendThread::sendUpdateChunk(char* cptr, _i64 curr_pos, _u32 r)
+{
+	char tmp_backup[c_chunk_padding];
+	memcpy(tmp_backup, cptr - c_chunk_padding, c_chunk_padding);
 
-					if (FileServ::isPause()) Sleep(500);
+	*(cptr - c_chunk_padding) = ID_UPDATE_CHUNK;
+	_i64 curr_pos_tmp = little_endian(curr_pos);
+	memcpy(cptr - sizeof(_i64) - sizeof(_u32), &curr_pos_tmp, sizeof(_i64));
+	_u32 r_tmp = little_endian(r);
+	memcpy(cptr - sizeof(_u32), &r_tmp, sizeof(_u32));
 
-					memcpy(cptr - c_chunk_padding, tmp_backup, c_chunk_padding);
-				}
+	Log("Sending chunk start=" + convert(curr_pos) + " size=" + convert(r), LL_DEBUG);
 
-				if (!new_chunkhashes.empty())
-				{
-					_u32 little_c_addler = little_endian(c_adler);
-					memcpy(&new_chunkhashes[sizeof(_u16) + big_hash_size + small_hash_size*small_hash_num], &little_c_addler, sizeof(little_c_addler));
-				}
+	if (parent->SendInt(cptr - c_chunk_padding, c_chunk_padding + r) == SOCKET_ERROR)
+	{
+		Log("Error sending chunk", LL_DEBUG);
+		return false;
+	}
 
-				c_adler = urb_adler32(0, nullptr, 0);
-				++small_hash_num;
-				next_smallhash += c_small_hash_dist;
-			}
-			curr_pos += r;
+	if (FileServ::isPause()) Sleep(500);
 
-		} while (real_r == c_chunk_size && read_total < c_checkpoint_dist);
-	}
+	memcpy(cptr - c_chunk_padding, tmp_backup, c_chunk_padding);
 
-	md5_hash.finalize();
+	return true;
+}
 
+void ChunkSendThread::updateCbtHash(int64 index_chunkhash_pos, _u16 index_chunkhash_pos_offset, std::vector<char>& new_chunkhashes, const char* big_hash)
+{
 	if (!new_chunkhashes.empty()
 		&& *cbt_hash_file_info.snapshot_sequence_id == cbt_hash_file_info.snapshot_sequence_id_reference)
 	{
 		memcpy(new_chunkhashes.data(), &index_chunkhash_pos_offset, sizeof(index_chunkhash_pos_offset));
-		memcpy(new_chunkhashes.data()+sizeof(_u16), md5_hash.raw_digest_int(), big_hash_size);
+		memcpy(new_chunkhashes.data()+sizeof(_u16), big_hash, big_hash_size);
 		cbt_hash_file_info.cbt_hash_file->Write(index_chunkhash_pos, new_chunkhashes.data(), static_cast<_u32>(new_chunkhashes.size()));
 	}
+}
 
-	if(!sent_update && !cbt_unchanged && memcmp(md5_hash.raw_digest_int(), chunk->big_hash, big_hash_size)!=0 )
+bool ChunkSendThread::sendChunkResult(SChunk *chunk, char* buf, unsigned int read_total, bool sent_update, bool cbt_unchanged, const char* big_hash)
+{
+	if(!sent_update && !cbt_unchanged && memcmp(big_hash, chunk->big_hash, big_hash_size)!=0 )
 	{
 		Log("Sending whole block(2) start="+convert(chunk->startpos)+" size="+convert(read_total), LL_DEBUG);
 
-		*chunk_buf=ID_WHOLE_BLOCK;
+		*buf=ID_WHOLE_BLOCK;
 		_i64 chunk_startpos = little_endian(chunk->startpos);
-		memcpy(chunk_buf+1, &chunk_startpos, sizeof(_i64));
+		memcpy(buf+1, &chunk_startpos, sizeof(_i64));
 		unsigned int read_total_tmp = little_endian(read_total);
-		memcpy(chunk_buf+1+sizeof(_i64), &read_total_tmp, sizeof(_u32));
-		if(parent->SendInt(chunk_buf, read_total+1+sizeof(_i64)+sizeof(_u32))==SOCKET_ERROR)
+		memcpy(buf+1+sizeof(_i64), &read_total_tmp, sizeof(_u32));
+		if(parent->SendInt(buf, read_total+1+sizeof(_i64)+sizeof(_u32))==SOCKET_ERROR)
 		{
 			Log("Error sending whole block", LL_DEBUG);
 			return false;
@@ -663,10 +887,10 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 
 		if( FileServ::isPause() ) Sleep(500);
 
-		*chunk_buf=ID_BLOCK_HASH;
-		memcpy(chunk_buf+1, &chunk_startpos, sizeof(_i64));
-		memcpy(chunk_buf+1+sizeof(_i64), md5_hash.raw_digest_int(), big_hash_size);
-		if(parent->SendInt(chunk_buf, 1+sizeof(_i64)+big_hash_size)==SOCKET_ERROR)
+		*buf=ID_BLOCK_HASH;
+		memcpy(buf+1, &chunk_startpos, sizeof(_i64));
+		memcpy(buf+1+sizeof(_i64), big_hash, big_hash_size);
+		if(parent->SendInt(buf, 1+sizeof(_i64)+big_hash_size)==SOCKET_ERROR)
 		{
 			Log("Error sending whole block hash", LL_DEBUG);
 			return false;
@@ -676,10 +900,10 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 	}
 	else if(!sent_update)
 	{
-		*chunk_buf=ID_NO_CHANGE;
+		*buf=ID_NO_CHANGE;
 		_i64 chunk_startpos = little_endian(chunk->startpos);
-		memcpy(chunk_buf+1, &chunk_startpos, sizeof(_i64));
-		if(parent->SendInt(chunk_buf, 1+sizeof(_i64))==SOCKET_ERROR)
+		memcpy(buf+1, &chunk_startpos, sizeof(_i64));
+		if(parent->SendInt(buf, 1+sizeof(_i64))==SOCKET_ERROR)
 		{
 			Log("Error sending no change", LL_DEBUG);
 			return false;
@@ -689,11 +913,11 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 	}
 	else
 	{
-		*chunk_buf=ID_BLOCK_HASH;
+		*buf=ID_BLOCK_HASH;
 		_i64 chunk_startpos = little_endian(chunk->startpos);
-		memcpy(chunk_buf+1, &chunk_startpos, sizeof(_i64));
-		memcpy(chunk_buf+1+sizeof(_i64), md5_hash.raw_digest_int(), big_hash_size);
-		if(parent->SendInt(chunk_buf, 1+sizeof(_i64)+big_hash_size)==SOCKET_ERROR)
+		memcpy(buf+1, &chunk_startpos, sizeof(_i64));
+		memcpy(buf+1+sizeof(_i64), big_hash, big_hash_size);
+		if(parent->SendInt(buf, 1+sizeof(_i64)+big_hash_size)==SOCKET_ERROR)
 		{
 			Log("Error sending block hash");
 			return false;
@@ -702,13 +926,215 @@ bool ChunkSendThread::sendChunk(SChunk *chunk)
 		if( FileServ::isPause() ) Sleep(500);
 	}
 
-	if(script_eof)
+	return true;
+}
+
+bool ChunkSendThread::canPipeline(const SChunk& chunk)
+{
+	return chunk.msg == ID_ILLEGAL
+		&& chunk.update_file == nullptr
+		&& !chunk.transfer_all
+		&& file != nullptr
+		&& pipe_file_user.get() == nullptr
+		&& curr_file_size > 0
+		&& chunk.startpos >= 0
+		&& chunk.startpos < curr_file_size
+		&& file->Size() != -1;
+}
+
+void ChunkSendThread::startChunk(const SChunk& chunk)
+{
+	if (mutex == nullptr)
 	{
-		parent->SendInt(nullptr, 0);
-		return false;
+		mutex = Server->createMutex();
+		job_cond = Server->createCondition();
+		done_cond = Server->createCondition();
+
+		size_t n_workers = (std::min)(static_cast<size_t>(os_get_num_cpus()), c_max_workers);
+		n_workers = (std::max)(n_workers, static_cast<size_t>(1));
+
+		for (size_t i = 0; i < n_workers; ++i)
+		{
+			worker_tickets.push_back(Server->getThreadPool()->execute(new ChunkSendWorker(this), "filesrv: chunk hash"));
+		}
 	}
 
-	return true;
+	if (FileServ::isPause())
+	{
+		Sleep(500);
+	}
+
+	SChunkJob* job;
+	if (!free_jobs.empty())
+	{
+		job = free_jobs.back();
+		free_jobs.pop_back();
+	}
+	else
+	{
+		job = new SChunkJob;
+	}
+
+	job->reset(chunk, file, curr_file_size);
+
+	in_flight.push_back(job);
+
+	if (!file->Seek(chunk.startpos))
+	{
+		job->seek_error = true;
+		job->errcode = getSystemErrorCode();
+		job->done = true;
+		return;
+	}
+
+	checkCbtHash(&job->chunk, job->cbt_unchanged, job->index_chunkhash_pos, job->index_chunkhash_pos_offset);
+
+	if (job->cbt_unchanged)
+	{
+		job->done = true;
+		return;
+	}
+
+	IScopedLock lock(mutex);
+	pending_jobs.push_back(job);
+	job_cond->notify_one();
+}
+
+void ChunkSendThread::workerThread()
+{
+	IScopedLock lock(mutex);
+	while (true)
+	{
+		while (pending_jobs.empty() && !stop_workers)
+		{
+			job_cond->wait(&lock);
+		}
+
+		if (stop_workers)
+		{
+			return;
+		}
+
+		SChunkJob* job = pending_jobs.front();
+		pending_jobs.pop_front();
+
+		lock.relock(nullptr);
+
+		job->readAndHash();
+
+		lock.relock(mutex);
+
+		job->done = true;
+		done_cond->notify_all();
+	}
+}
+
+bool ChunkSendThread::finishChunk(SChunkJob* job)
+{
+	if (job->seek_error)
+	{
+		return sendError(ERR_SEEKING_FAILED, job->errcode);
+	}
+
+	SChunk* chunk = &job->chunk;
+
+	std::vector<char> new_chunkhashes;
+	if (job->index_chunkhash_pos != -1)
+	{
+		new_chunkhashes.resize(sizeof(_u16) + chunkhash_single_size);
+	}
+
+	bool sent_update = false;
+	_u32 pos = 0;
+	for (size_t i = 0; i < job->n_pieces; ++i)
+	{
+		char* cptr = job->buf.get() + c_chunk_padding + pos;
+		_u32 r = job->piece_size[i];
+		_i64 curr_pos = chunk->startpos + pos;
+
+		_u32 adler_other = little_endian(*((_u32*)&chunk->small_hash[small_hash_size*i]));
+		if (job->piece_adler[i] != adler_other
+			|| curr_pos + r > curr_hash_size)
+		{
+			sent_update = true;
+			if (!sendUpdateChunk(cptr, curr_pos, r))
+			{
+				return false;
+			}
+		}
+
+		if (!new_chunkhashes.empty())
+		{
+			_u32 little_c_addler = little_endian(job->piece_adler[i]);
+			memcpy(&new_chunkhashes[sizeof(_u16) + big_hash_size + small_hash_size*i], &little_c_addler, sizeof(little_c_addler));
+		}
+
+		pos += r;
+	}
+
+	if (job->read_error)
+	{
+		Server->Log("Reading from file \"" + file->getFilename() + "\" at position " + convert(job->read_error_pos) + " failed (code: " + convert(job->errcode) + ")(4).", LL_ERROR);
+		FileServ::callErrorCallback(s_filename, file->getFilename(), job->read_error_pos, "code: " + convert(job->errcode));
+		return sendError(ERR_READING_FAILED, job->errcode);
+	}
+
+	const char* big_hash = job->cbt_unchanged ? chunk->big_hash : job->big_hash;
+
+	if (!job->cbt_unchanged)
+	{
+		updateCbtHash(job->index_chunkhash_pos, job->index_chunkhash_pos_offset, new_chunkhashes, big_hash);
+	}
+
+	return sendChunkResult(chunk, job->buf.get(), job->read_total, sent_update, job->cbt_unchanged, big_hash);
+}
+
+void ChunkSendThread::finishFrontChunk()
+{
+	SChunkJob* job = in_flight.front();
+	in_flight.pop_front();
+
+	if (mutex != nullptr)
+	{
+		IScopedLock lock(mutex);
+		while (!job->done)
+		{
+			done_cond->wait(&lock);
+		}
+	}
+
+	if (!has_error
+		&& !finishChunk(job))
+	{
+		has_error = true;
+	}
+
+	free_jobs.push_back(job);
+}
+
+void ChunkSendThread::finishAllChunks()
+{
+	while (!in_flight.empty())
+	{
+		finishFrontChunk();
+	}
+}
+
+void ChunkSendThread::stopWorkers()
+{
+	if (mutex == nullptr)
+	{
+		return;
+	}
+
+	{
+		IScopedLock lock(mutex);
+		stop_workers = true;
+		job_cond->notify_all();
+	}
+
+	Server->getThreadPool()->waitFor(worker_tickets);
+	worker_tickets.clear();
 }
 
 bool ChunkSendThread::sendError( _u32 errorcode1, _u32 errorcode2 )
@@ -4,12 +4,18 @@
 #include "../Interface/Thread.h"
 #include "../Interface/Types.h"
 #include "../Interface/File.h"
+#include "../Interface/Mutex.h"
+#include "../Interface/Condition.h"
+#include "../Interface/ThreadPool.h"
 #include "../md5.h"
 #include <memory>
+#include <deque>
+#include <vector>
 
 class ScopedPipeFileUser;
 class CClientThread;
 struct SChunk;
+struct SChunkJob;
 
 class ChunkSendThread : public IThread
 {
@@ -21,10 +27,32 @@ public:
 
 	bool sendChunk(SChunk *chunk);
 
+	void workerThread();
+
 private:
 
 	bool sendError(_u32 errorcode1, _u32 errorcode2);
 
+	void checkCbtHash(SChunk *chunk, bool& cbt_unchanged, int64& index_chunkhash_pos, _u16& index_chunkhash_pos_offset);
+
+	bool sendUpdateChunk(char* cptr, _i64 curr_pos, _u32 r);
+
+	void updateCbtHash(int64 index_chunkhash_pos, _u16 index_chunkhash_pos_offset, std::vector<char>& new_chunkhashes, const char* big_hash);
+
+	bool sendChunkResult(SChunk *chunk, char* buf, unsigned int read_total, bool sent_update, bool cbt_unchanged, const char* big_hash);
+
+	bool canPipeline(const SChunk& chunk);
+
+	void startChunk(const SChunk& chunk);
+
+	bool finishChunk(SChunkJob* job);
+
+	void finishFrontChunk();
+
+	void finishAllChunks();
+
+	void stopWorkers();
+
 	CClientThread *parent;
 	IFile *file;
 	std::string s_filename;
@@ -43,4 +71,13 @@ private:
 	bool has_error;
 
 	MD5 md5_hash;
+
+	IMutex* mutex;
+	ICondition* job_cond;
+	ICondition* done_cond;
+	bool stop_workers;
+	std::vector<THREADPOOL_TICKET> worker_tickets;
+	std::deque<SChunkJob*> pending_jobs;
+	std::deque<SChunkJob*> in_flight;
+	std::vector<SChunkJob*> free_jobs;
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <stddef.h>
 #include "../Interface/Object.h"
+#include "../Interface/Types.h"
+#include <vector>
 
 class IPipeFileExt : public IObject
 {
@@ -10,4 +12,5 @@ public:
 	virtual bool readStdoutIntoBuffer(char* buf, size_t buf_avail, size_t& read_bytes) = 0;
 	virtual void finishStdout() = 0;
 	virtual bool readStderrIntoBuffer(char* buf, size_t buf_avail, size_t& read_bytes) = 0;
+	virtual void prioritize(const std::vector<int64>& ids) = 0;
 };
\ No newline at end of file
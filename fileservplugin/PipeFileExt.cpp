@@ -38,3 +38,8 @@ void PipeFileExt::forceExit()
 {
 	file_ext->forceExit();
 }
+
+void PipeFileExt::prioritize(const std::vector<int64>& ids)
+{
+	file_ext->prioritize(ids);
+}
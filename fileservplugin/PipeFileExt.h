@@ -13,6 +13,8 @@ public:
 	virtual void forceExitWait();
 
 	void forceExit();
+
+	void prioritize(const std::vector<int64>& ids);
 protected:
 	virtual bool readStdoutIntoBuffer(char* buf, size_t buf_avail, size_t& read_bytes);
 	virtual void finishStdout();
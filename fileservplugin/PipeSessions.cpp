@@ -628,6 +628,26 @@ void PipeSessions::phashEnd(const std::string & server_token, const std::string
 	}
 }
 
+void PipeSessions::phashPrioritize(const std::string & server_token, const std::string & phash_fn, const std::vector<int64>& file_ids)
+{
+	IScopedLock lock(mutex);
+
+	bool allow_exec;
+	std::string fn = map_file("phash_{9c28ff72-5a74-487b-b5e1-8f1c96cd0cf4}/phash_" + phash_fn, std::string(), allow_exec, nullptr);
+
+	if (fn.empty())
+		return;
+
+	std::map<std::string, SPipeSession>::iterator it = pipe_files.find(fn + "|0|0|" + server_token);
+
+	if (it != pipe_files.end())
+	{
+		PipeFileExt* pext = dynamic_cast<PipeFileExt*>(it->second.file);
+		if (pext != nullptr)
+			pext->prioritize(file_ids);
+	}
+}
+
 void PipeSessions::registerMetadataCallback( const std::string &name, const std::string& identity, IFileServ::IMetadataCallback* callback )
 {
 	IScopedLock lock(mutex);
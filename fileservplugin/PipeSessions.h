@@ -85,6 +85,8 @@ public:
 
 	static void phashEnd(const std::string& server_token, const std::string& phash_fn);
 
+	static void phashPrioritize(const std::string& server_token, const std::string& phash_fn, const std::vector<int64>& file_ids);
+
 	static void registerMetadataCallback(const std::string &name, const std::string& identity, IFileServ::IMetadataCallback* callback);
 	static void removeMetadataCallback(const std::string &name, const std::string& identity);
 
@@ -18,6 +18,7 @@
 
 #include "CompressedFile.h"
 #include "../stringtools.h"
+#include "../Interface/ThreadPool.h"
 #include <assert.h>
 #include <memory>
 #include <algorithm>
@@ -32,6 +33,7 @@
 
 const size_t c_cacheBuffersize = 2*1024*1024;
 const size_t c_ncacheItems = 5;
+const size_t c_readaheadMinSequential = 2;
 const size_t c_blockbufHeadersize = 2 * sizeof(_u32);
 const char headerMagic[] = "URBACKUP COMPRESSED FILE#";
 const char headerVersionV1_0[] = "1.0";
@@ -45,7 +47,9 @@ const size_t c_header_size = sizeof(headerMagic) + sizeof(headerVersionV1_0) + s
 CompressedFile::CompressedFile( std::string pFilename, int pMode, size_t n_threads)
 	: error(false), currentPosition(0),
 	  finished(false), filesize(0), noMagic(false),
-	mutex(Server->createMutex()), n_threads(n_threads), numBlockOffsets(0)
+	mutex(Server->createMutex()), n_threads(n_threads), numBlockOffsets(0),
+	last_filled_block(std::string::npos), n_sequential_fills(0), readaheadThread(this),
+	readahead_cond(Server->createCondition()), readahead_workers(0)
 {
 	uncompressedFile = Server->openFile(pFilename, pMode);
 
@@ -71,7 +75,7 @@ CompressedFile::CompressedFile( std::string pFilename, int pMode, size_t n_threa
 		initCompressedBuffers(n_threads + 1);
 	}
 
-	if(hotCache.get())
+	if(hotCache.get() && !readOnly)
 	{
 		hotCache->setCacheEvictionCallback(this);
 	}
@@ -82,7 +86,9 @@ CompressedFile::CompressedFile( std::string pFilename, int pMode, size_t n_threa
 CompressedFile::CompressedFile(IFile* file, bool openExisting, bool readOnly, size_t n_threads)
 	: error(false), currentPosition(0),
 	finished(false), uncompressedFile(file), filesize(0), readOnly(readOnly),
-	noMagic(false), n_threads(n_threads), numBlockOffsets(0)
+	noMagic(false), mutex(Server->createMutex()), n_threads(n_threads), numBlockOffsets(0),
+	last_filled_block(std::string::npos), n_sequential_fills(0), readaheadThread(this),
+	readahead_cond(Server->createCondition()), readahead_workers(0)
 {
 	if(openExisting)
 	{
@@ -95,7 +101,7 @@ CompressedFile::CompressedFile(IFile* file, bool openExisting, bool readOnly, si
 		hotCache.reset(new LRUMemCache(blocksize, c_ncacheItems, n_threads));
 		initCompressedBuffers(n_threads + 1);
 	}
-	if(hotCache.get()!=nullptr)
+	if(hotCache.get()!=nullptr && !readOnly)
 	{
 		hotCache->setCacheEvictionCallback(this);
 	}
@@ -105,6 +111,8 @@ CompressedFile::CompressedFile(IFile* file, bool openExisting, bool readOnly, si
 
 CompressedFile::~CompressedFile()
 {
+	stopReadahead();
+
 	hotCache.reset();
 
 	if(!finished)
@@ -312,6 +320,40 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 		return false;
 	}
 
+	if(readOnly && n_threads>1)
+	{
+		if(last_filled_block!=std::string::npos
+			&& block==last_filled_block+1)
+		{
+			++n_sequential_fills;
+		}
+		else
+		{
+			n_sequential_fills=0;
+		}
+		last_filled_block = block;
+
+		if(n_sequential_fills>=c_readaheadMinSequential)
+		{
+			scheduleReadahead(block);
+		}
+
+		bool ok;
+		if(takeReadahead(block, buf, ok))
+		{
+			if(!ok && has_error)
+			{
+				*has_error=true;
+			}
+			return ok;
+		}
+	}
+
+	return decompressBlock(block, buf, compressedBuffer, has_error);
+}
+
+bool CompressedFile::decompressBlock(size_t block, char* buf, std::vector<char>& compBuffer, bool *has_error)
+{
 	if(blockOffsets[block]==-1)
 	{
 		memset(buf, 0, blocksize);
@@ -351,12 +393,12 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 	}
 	else
 	{
-		if(compressedBuffer.size()<compressedSize)
+		if(compBuffer.size()<compressedSize)
 		{
-			compressedBuffer.resize(compressedSize);
+			compBuffer.resize(compressedSize);
 		}	
 
-		if(readFromFile(blockDataOffset + c_blockbufHeadersize, &compressedBuffer[0], compressedSize, has_error)!=compressedSize)
+		if(readFromFile(blockDataOffset + c_blockbufHeadersize, &compBuffer[0], compressedSize, has_error)!=compressedSize)
 		{
 			Server->Log("Error while reading compressed data from "+convert(blockDataOffset)+" ("+convert(compressedSize)+" bytes)", LL_ERROR);
 			return false;
@@ -368,7 +410,7 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 	{
 		rdecomp = blocksize;
 		int rc = mz_uncompress(reinterpret_cast<unsigned char*>(buf), &rdecomp,
-			reinterpret_cast<const unsigned char*>(compressedBuffer.data()), static_cast<mz_ulong>(compressedSize));
+			reinterpret_cast<const unsigned char*>(compBuffer.data()), static_cast<mz_ulong>(compressedSize));
 
 		if(rc != MZ_OK)
 		{
@@ -381,7 +423,7 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 	{
 		rdecomp = blocksize;
 		const size_t rc = ZSTD_decompress(buf, blocksize,
-			compressedBuffer.data(), compressedSize);
+			compBuffer.data(), compressedSize);
 
 		if (ZSTD_isError(rc))
 		{
@@ -397,7 +439,7 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 	}
 	
 
-	if(rdecomp!=blocksize && offset+blocksize<filesize)
+	if(rdecomp!=blocksize && static_cast<__int64>(block+1)*blocksize<filesize)
 	{
 		Server->Log("Did not receive enough bytes from compressed stream. Expected "+convert(blocksize)+" received "+convert((size_t)rdecomp), LL_ERROR);
 		return false;
@@ -406,6 +448,174 @@ bool CompressedFile::fillCache( __int64 offset, bool errorMsg, bool *has_error)
 	return true;
 }
 
+void CompressedFile::scheduleReadahead(size_t block)
+{
+	const size_t readahead_blocks_max = n_threads;
+
+	IScopedLock lock(mutex.get());
+
+	//Drop blocks the reader skipped or seeked away from
+	for(std::deque<size_t>::iterator it=readahead_queue.begin();it!=readahead_queue.end();)
+	{
+		if(*it<block || *it>block+readahead_blocks_max)
+		{
+			readahead_blocks.erase(*it);
+			it = readahead_queue.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for(std::map<size_t, SReadaheadBlock>::iterator it=readahead_blocks.begin();it!=readahead_blocks.end();)
+	{
+		if(it->second.done
+			&& (it->first<block || it->first>block+readahead_blocks_max) )
+		{
+			readahead_buffers.push_back(it->second.buffer);
+			readahead_blocks.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for(size_t i=1;i<=readahead_blocks_max && block+i<blockOffsets.size();++i)
+	{
+		size_t next_block = block+i;
+		if(blockOffsets[next_block]==-1
+			|| readahead_blocks.find(next_block)!=readahead_blocks.end())
+		{
+			continue;
+		}
+
+		if(readahead_blocks.size()>=2*readahead_blocks_max)
+		{
+			break;
+		}
+
+		readahead_blocks[next_block] = SReadaheadBlock();
+		readahead_queue.push_back(next_block);
+	}
+
+	while(readahead_workers<n_threads-1
+		&& readahead_workers<readahead_queue.size())
+	{
+		++readahead_workers;
+		Server->getThreadPool()->execute(&readaheadThread, "comp img read");
+	}
+}
+
+bool CompressedFile::takeReadahead(size_t block, char* buf, bool& ok)
+{
+	IScopedLock lock(mutex.get());
+
+	std::map<size_t, SReadaheadBlock>::iterator it=readahead_blocks.find(block);
+	if(it==readahead_blocks.end())
+	{
+		return false;
+	}
+
+	std::deque<size_t>::iterator queue_it = std::find(readahead_queue.begin(), readahead_queue.end(), block);
+	if(queue_it!=readahead_queue.end())
+	{
+		//Not started yet. Decompress it on this thread instead
+		readahead_queue.erase(queue_it);
+		readahead_blocks.erase(it);
+		return false;
+	}
+
+	while(!it->second.done)
+	{
+		readahead_cond->wait(&lock);
+	}
+
+	ok = it->second.ok;
+	if(ok)
+	{
+		memcpy(buf, it->second.buffer, blocksize);
+	}
+
+	readahead_buffers.push_back(it->second.buffer);
+	readahead_blocks.erase(it);
+
+	return true;
+}
+
+void CompressedFile::ReadaheadThread::operator()()
+{
+	file->readaheadWork();
+}
+
+void CompressedFile::readaheadWork()
+{
+	std::vector<char> compBuffer;
+
+	IScopedLock lock(mutex.get());
+	while(!readahead_queue.empty())
+	{
+		size_t block = readahead_queue.front();
+		readahead_queue.pop_front();
+
+		char* buf;
+		if(!readahead_buffers.empty())
+		{
+			buf = readahead_buffers.back();
+			readahead_buffers.pop_back();
+		}
+		else
+		{
+			buf = new char[blocksize];
+		}
+
+		lock.relock(nullptr);
+
+		bool has_error=false;
+		bool ok = decompressBlock(block, buf, compBuffer, &has_error) && !has_error;
+
+		lock.relock(mutex.get());
+
+		SReadaheadBlock& readahead_block = readahead_blocks[block];
+		readahead_block.buffer = buf;
+		readahead_block.ok = ok;
+		readahead_block.done = true;
+		readahead_cond->notify_all();
+	}
+
+	--readahead_workers;
+	readahead_cond->notify_all();
+}
+
+void CompressedFile::stopReadahead()
+{
+	IScopedLock lock(mutex.get());
+
+	for(size_t i=0;i<readahead_queue.size();++i)
+	{
+		readahead_blocks.erase(readahead_queue[i]);
+	}
+	readahead_queue.clear();
+
+	while(readahead_workers>0)
+	{
+		readahead_cond->wait(&lock);
+	}
+
+	for(std::map<size_t, SReadaheadBlock>::iterator it=readahead_blocks.begin();it!=readahead_blocks.end();++it)
+	{
+		delete[] it->second.buffer;
+	}
+	readahead_blocks.clear();
+
+	for(size_t i=0;i<readahead_buffers.size();++i)
+	{
+		delete[] readahead_buffers[i];
+	}
+	readahead_buffers.clear();
+}
+
 _u32 CompressedFile::Write( const char* buffer, _u32 bsize, bool *has_error)
 {
 	assert(!finished);
@@ -636,6 +846,8 @@ bool CompressedFile::finish()
 {
 	assert(!finished);
 
+	stopReadahead();
+
 	if(hotCache.get())
 	{
 		hotCache->clear();
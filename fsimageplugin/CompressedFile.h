@@ -5,6 +5,11 @@
 
 #include "../Interface/File.h"
 #include "../Interface/Mutex.h"
+#include "../Interface/Condition.h"
+#include "../Interface/Thread.h"
+
+#include <map>
+#include <deque>
 
 class LRUMemCache;
 
@@ -58,9 +63,38 @@ public:
 	bool hasNoMagic();
 
 private:
+	class ReadaheadThread : public IThread
+	{
+	public:
+		ReadaheadThread(CompressedFile* file)
+			: file(file)
+		{}
+
+		void operator()();
+
+	private:
+		CompressedFile* file;
+	};
+
+	struct SReadaheadBlock
+	{
+		SReadaheadBlock()
+			: buffer(nullptr), done(false), ok(false)
+		{}
+
+		char* buffer;
+		bool done;
+		bool ok;
+	};
+
 	void readHeader(bool *has_error);
 	void readIndex(bool *has_error);
 	bool fillCache(__int64 offset, bool errorMsg, bool *has_error);
+	bool decompressBlock(size_t block, char* buf, std::vector<char>& compBuffer, bool *has_error);
+	void scheduleReadahead(size_t block);
+	bool takeReadahead(size_t block, char* buf, bool& ok);
+	void readaheadWork();
+	void stopReadahead();
 	virtual void evictFromLruCache(const SCacheItem& item);
 	void writeHeader();
 	void writeIndex();
@@ -104,4 +138,14 @@ private:
 	std::unique_ptr<IMutex> mutex;
 
 	size_t n_threads;
+
+	//Sequential read detection and blocks decompressed ahead of the reader
+	size_t last_filled_block;
+	size_t n_sequential_fills;
+	ReadaheadThread readaheadThread;
+	std::unique_ptr<ICondition> readahead_cond;
+	std::map<size_t, SReadaheadBlock> readahead_blocks;
+	std::deque<size_t> readahead_queue;
+	std::vector<char*> readahead_buffers;
+	size_t readahead_workers;
 };
@@ -27,6 +27,11 @@
 #define FSNTFS FSNTFSWIN
 #endif
 #include "fs/unknown.h"
+#ifndef _WIN32
+#include "fs/ext.h"
+#include "fs/xfs.h"
+#include "fs/btrfs.h"
+#endif
 #include "vhdfile.h"
 #include "vhdxfile.h"
 #include "../stringtools.h"
@@ -38,6 +43,7 @@
 #endif
 #include "partclone.h"
 #include "cowfile.h"
+#include "dedupfile.h"
 #include "ClientBitmap.h"
 #include <stdlib.h>
 #include "FileWrapper.h"
@@ -358,6 +364,13 @@ IFilesystem *FSImageFactory::createFilesystem(const std::string &pDevOrig, ERead
 		return nullptr;
 	}
 
+#ifndef _WIN32
+	//The XFS and btrfs bitmap readers have not been checked against images
+	//created by mkfs.xfs/mkfs.btrfs yet. Use partclone unless enabled
+	bool native_xfs_btrfs = Server->getServerParameter("native_xfs_btrfs_bitmap") == "true";
+	bool is_btrfs = native_xfs_btrfs && FSBtrfs::isBtrfs(dev);
+#endif
+
 	Server->destroy(dev);
 
 	if(isNTFS(buffer) )
@@ -498,15 +511,44 @@ IFilesystem *FSImageFactory::createFilesystem(const std::string &pDevOrig, ERead
 #else
 	else
 	{
-		IFilesystem* fs = new Partclone(pDev, read_ahead, background_priority, next_block_callback);
-		if (fs->hasError())
+		IFilesystem* fs = nullptr;
+		if (FSExt::isExt(buffer))
+		{
+			Server->Log("Filesystem type is ext ("+pDev+")", LL_DEBUG);
+			fs = new FSExt(pDev, read_ahead, background_priority, next_block_callback);
+		}
+		else if (native_xfs_btrfs
+			&& FSXfs::isXfs(buffer))
 		{
+			Server->Log("Filesystem type is xfs ("+pDev+")", LL_DEBUG);
+			fs = new FSXfs(pDev, read_ahead, background_priority, next_block_callback);
+		}
+		else if (is_btrfs)
+		{
+			Server->Log("Filesystem type is btrfs ("+pDev+")", LL_DEBUG);
+			fs = new FSBtrfs(pDev, read_ahead, background_priority, next_block_callback);
+		}
+
+		if (fs != nullptr
+			&& fs->hasError())
+		{
+			Server->Log("Error reading used block bitmap of file system. Falling back to partclone.", LL_WARNING);
 			delete fs;
-			fs = new FSUnknown(pDev, read_ahead, background_priority, next_block_callback);
+			fs = nullptr;
+		}
+
+		if (fs == nullptr)
+		{
+			fs = new Partclone(pDev, read_ahead, background_priority, next_block_callback);
 			if (fs->hasError())
 			{
 				delete fs;
-				return nullptr;
+				fs = new FSUnknown(pDev, read_ahead, background_priority, next_block_callback);
+				if (fs->hasError())
+				{
+					delete fs;
+					return nullptr;
+				}
 			}
 		}
 		PrintInfo(fs);
@@ -555,6 +597,8 @@ IVHDFile *FSImageFactory::createVHDFile(const std::string &fn, bool pRead_only,
 #else
 		return NULL;
 #endif
+	case ImageFormat_Dedup:
+		return new DedupFile(fn, pRead_only);
 	}
 	return nullptr;
 }
@@ -576,11 +620,30 @@ IVHDFile *FSImageFactory::createVHDFile(const std::string &fn, const std::string
 #else
 		return NULL;
 #endif
+	case ImageFormat_Dedup:
+		//Needs the block store path. Use createDedupVHDFile
+		return nullptr;
 	}
 
 	return nullptr;
 }
 
+IVHDFile * FSImageFactory::createDedupVHDFile(const std::string & fn, const std::string & parent_fn,
+	const std::string & block_store_path, uint64 pDstsize, unsigned int pBlocksize)
+{
+	return new DedupFile(fn, parent_fn, block_store_path, pDstsize, pBlocksize);
+}
+
+bool FSImageFactory::removeDedupVHDFile(const std::string & fn)
+{
+	return DedupFile::removeImage(fn);
+}
+
+bool FSImageFactory::collectDedupGarbage(const std::string & block_store_path)
+{
+	return DedupFile::collectGarbage(block_store_path);
+}
+
 void FSImageFactory::destroyVHDFile(IVHDFile *vhd)
 {
 	delete vhd;
@@ -16,6 +16,13 @@ public:
 		bool pRead_only, bool fast_mode=false, IFSImageFactory::ImageFormat format=IFSImageFactory::ImageFormat_VHD, uint64 pDstsize=0,
 		size_t n_compress_threads = 0);
 
+	virtual IVHDFile *createDedupVHDFile(const std::string &fn, const std::string &parent_fn,
+		const std::string &block_store_path, uint64 pDstsize, unsigned int pBlocksize);
+
+	virtual bool removeDedupVHDFile(const std::string &fn);
+
+	virtual bool collectDedupGarbage(const std::string &block_store_path);
+
 	virtual void destroyVHDFile(IVHDFile *vhd);
 
 	virtual IReadOnlyBitmap* createClientBitmap(const std::string& fn);
@@ -37,7 +37,8 @@ public:
 		ImageFormat_CompressedVHD=1,
 		ImageFormat_RawCowFile=2,
 		ImageFormat_VHDX = 3,
-		ImageFormat_CompressedVHDX = 4
+		ImageFormat_CompressedVHDX = 4,
+		ImageFormat_Dedup = 5
 	};
 
 	virtual IVHDFile *createVHDFile(const std::string &fn, bool pRead_only, uint64 pDstsize,
@@ -48,6 +49,17 @@ public:
 		bool pRead_only, bool fast_mode=false, ImageFormat compress=ImageFormat_VHD, uint64 pDstsize=0,
 		size_t n_compress_threads = 0)=0;
 
+	//Creates a new image referencing its blocks in the content addressed store at block_store_path.
+	//Existing dedup images are opened via createVHDFile with ImageFormat_Dedup
+	virtual IVHDFile *createDedupVHDFile(const std::string &fn, const std::string &parent_fn,
+		const std::string &block_store_path, uint64 pDstsize, unsigned int pBlocksize)=0;
+
+	//Deletes a dedup image and the blocks only it used
+	virtual bool removeDedupVHDFile(const std::string &fn)=0;
+
+	//Deletes all blocks no dedup image uses from the block store at block_store_path
+	virtual bool collectDedupGarbage(const std::string &block_store_path)=0;
+
 	virtual void destroyVHDFile(IVHDFile *vhd)=0;
 
 	virtual IReadOnlyBitmap* createClientBitmap(const std::string& fn)=0;
@@ -18,61 +18,71 @@
 
 #include "LRUMemCache.h"
 #include "../Interface/Server.h"
+#include "../Interface/ThreadPool.h"
 #include "../stringtools.h"
 #include <string.h>
 #include <assert.h>
 
 
 LRUMemCache::LRUMemCache(size_t buffersize, size_t nbuffers, size_t p_n_threads)
-	: buffersize(buffersize), nbuffers(nbuffers), callback(nullptr),
-	mutex(Server->createMutex()), cond(Server->createCondition()), n_threads(p_n_threads),
-	do_quit(false), n_threads_working(0), cond_wait(Server->createCondition()), wait_work(false)
+	: lruHead(nullptr), lruTail(nullptr),
+	mutex(Server->createMutex()), cond_wait(Server->createCondition()),
+	buffersize(buffersize), nbuffers(nbuffers), n_threads(p_n_threads),
+	n_threads_working(0), callback(nullptr)
 {
 	if (n_threads > 0)
 		--n_threads;
 
-	for (size_t i = 0; i < n_threads; ++i)
+	lruMap.reserve(nbuffers);
+}
+
+LRUMemCache::SCacheNode* LRUMemCache::find( __int64 offset )
+{
+	std::unordered_map<__int64, SCacheNode*>::iterator it =
+		lruMap.find(offset - offset % static_cast<__int64>(buffersize));
+
+	if (it == lruMap.end())
 	{
-		Server->createThread(this, "comp img"+convert(i));
+		return nullptr;
 	}
+
+	return it->second;
 }
 
 char* LRUMemCache::get( __int64 offset, size_t& bsize )
 {
-	for(size_t i=lruItems.size(); i-->0; )
+	SCacheNode* node = find(offset);
+
+	if(node==nullptr)
 	{
-		if(lruItems[i].offset<=offset &&
-			lruItems[i].offset+static_cast<__int64>(buffersize)>offset)
-		{
-			size_t innerOffset = static_cast<size_t>(offset-lruItems[i].offset);
-			bsize = buffersize - innerOffset;
-			return lruItems[i].buffer + innerOffset;
-		}
+		return nullptr;
 	}
 
-	return nullptr;
+	putBack(node);
+
+	size_t innerOffset = static_cast<size_t>(offset-node->item.offset);
+	bsize = buffersize - innerOffset;
+	return node->item.buffer + innerOffset;
 }
 
 bool LRUMemCache::put( __int64 offset, const char* buffer, size_t bsize )
 {
-	for(size_t i=lruItems.size(); i-->0; )
+	SCacheNode* node = find(offset);
+
+	if(node!=nullptr)
 	{
-		if(lruItems[i].offset<=offset &&
-			lruItems[i].offset+static_cast<__int64>(buffersize)>offset)
-		{
-			size_t innerOffset = static_cast<size_t>(offset-lruItems[i].offset);
+		size_t innerOffset = static_cast<size_t>(offset-node->item.offset);
 
-			if( buffersize - innerOffset < bsize)
-			{
-				return false;
-			}
+		if( buffersize - innerOffset < bsize)
+		{
+			return false;
+		}
 
-			memcpy(lruItems[i].buffer + innerOffset, buffer, bsize);
+		memcpy(node->item.buffer + innerOffset, buffer, bsize);
 
-			putBack(i);
+		putBack(node);
 
-			return true;
-		}
+		return true;
 	}
 
 	SCacheItem newItem = createInt(offset);
@@ -89,14 +99,40 @@ bool LRUMemCache::put( __int64 offset, const char* buffer, size_t bsize )
 	return true;
 }
 
-void LRUMemCache::putBack( size_t idx )
+void LRUMemCache::unlink( SCacheNode* node )
+{
+	if(node->prev!=nullptr)
+		node->prev->next = node->next;
+	else
+		lruHead = node->next;
+
+	if(node->next!=nullptr)
+		node->next->prev = node->prev;
+	else
+		lruTail = node->prev;
+
+	node->prev = nullptr;
+	node->next = nullptr;
+}
+
+void LRUMemCache::putBack( SCacheNode* node )
 {
-	if(idx == lruItems.size()-1)
+	if(node == lruTail)
 		return;
 
-	SCacheItem item = lruItems[idx];
-	lruItems.erase(lruItems.begin()+idx);
-	lruItems.push_back(item);
+	unlink(node);
+	pushBack(node);
+}
+
+void LRUMemCache::pushBack( SCacheNode* node )
+{
+	node->prev = lruTail;
+	node->next = nullptr;
+	if(lruTail!=nullptr)
+		lruTail->next = node;
+	else
+		lruHead = node;
+	lruTail = node;
 }
 
 void LRUMemCache::setCacheEvictionCallback( ICacheEvictionCallback* cacheEvictionCallback )
@@ -108,41 +144,32 @@ void LRUMemCache::clear()
 {
 	waitThreadWork();
 
-	for(size_t i=0;i<lruItems.size();++i)
+	//Evict in LRU order, so blocks are written back in the same order as before
+	while(lruHead!=nullptr)
 	{
-		evict(lruItems[i], true);
+		SCacheNode* node = lruHead;
+		unlink(node);
+		evict(node->item, true);
+		freeNodes.push_back(node);
 	}
-	lruItems.clear();
+	lruMap.clear();
 }
 
 void LRUMemCache::operator()()
 {
 	IScopedLock lock(mutex.get());
-	while (!do_quit)
+	while (!evictedItems.empty())
 	{
-		while (!do_quit
-			&& evictedItems.empty())
-		{
-			cond->wait(&lock);
-		}
-
-		if (evictedItems.empty())
-			break;
-
 		SCacheItem item = evictedItems.back();
 		evictedItems.pop_back();
-		++n_threads_working;
 		lock.relock(nullptr);
 
 		callback->evictFromLruCache(item);
 
 		lock.relock(mutex.get());
 		lruItemBuffers.push_back(item.buffer);
-		--n_threads_working;
-		if(wait_work)
-			cond_wait->notify_all();
-	}	
-	--n_threads;
+	}
+	--n_threads_working;
 	cond_wait->notify_all();
 }
 
@@ -154,10 +181,7 @@ char* LRUMemCache::evict( SCacheItem& item, bool deleteBuffer )
 		{
 			callback->evictFromLruCache(item);
 		}
-		if (deleteBuffer)
-		{
-			delete[] item.buffer;
-		}
+		delete[] item.buffer;
 
 		return nullptr;
 	}
@@ -165,20 +189,26 @@ char* LRUMemCache::evict( SCacheItem& item, bool deleteBuffer )
 	{
 		if (callback == nullptr)
 		{
-			return nullptr;
+			//Nothing to write back. Reuse the buffer
+			return item.buffer;
 		}
 
 		IScopedLock lock(mutex.get());
 		if (evictedItems.size() >= n_threads)
 		{
 			char* ret = item.buffer;
+			lock.relock(nullptr);
 			callback->evictFromLruCache(item);
 			return ret;
 		}
 		else
 		{
 			evictedItems.push_back(item);
-			cond->notify_one();
+			if (n_threads_working < n_threads)
+			{
+				++n_threads_working;
+				Server->getThreadPool()->execute(this, "comp img evict");
+			}
 			return getLruItemBuffer(lock);
 		}
 	}
@@ -200,61 +230,66 @@ LRUMemCache::~LRUMemCache()
 {
 	clear();
 
-	finishThreads();
-
 	for (size_t i = 0; i < lruItemBuffers.size(); ++i)
 	{
 		delete[] lruItemBuffers[i];
 	}
 
 	lruItemBuffers.clear();
-}
 
-void LRUMemCache::finishThreads()
-{
-	IScopedLock lock(mutex.get());
-	do_quit = true;
-	while (n_threads > 0)
+	for (size_t i = 0; i < freeNodes.size(); ++i)
 	{
-		cond->notify_all();
-		cond_wait->wait(&lock);
+		delete freeNodes[i];
 	}
 }
 
 void LRUMemCache::waitThreadWork()
 {
 	IScopedLock lock(mutex.get());
-	wait_work = true;
 	while (!evictedItems.empty()
 		|| n_threads_working > 0)
 	{
 		cond_wait->wait(&lock);
 	}
-	wait_work = false;
 }
 
 SCacheItem LRUMemCache::createInt( __int64 offset )
 {
 	char* buffer=nullptr;
-	if(lruItems.size()>=nbuffers)
+	SCacheNode* node;
+	if(lruMap.size()>=nbuffers
+		&& lruHead!=nullptr)
 	{
-		SCacheItem& toremove = lruItems[0];
-		buffer = evict(toremove, false);
-		lruItems.erase(lruItems.begin());
+		node = lruHead;
+		unlink(node);
+		lruMap.erase(node->item.offset);
+		buffer = evict(node->item, false);
 	}
 	else
 	{
 		buffer = new char[buffersize];
+
+		if (!freeNodes.empty())
+		{
+			node = freeNodes.back();
+			freeNodes.pop_back();
+		}
+		else
+		{
+			node = new SCacheNode;
+		}
+		node->prev = nullptr;
+		node->next = nullptr;
 	}
 
-	SCacheItem newItem;
 	assert(buffer != nullptr);
-	newItem.buffer=buffer;
-	newItem.offset=offset - offset % buffersize;
+	node->item.buffer=buffer;
+	node->item.offset=offset - offset % buffersize;
 
-	lruItems.push_back(newItem);
+	lruMap[node->item.offset] = node;
+	pushBack(node);
 
-	return newItem;
+	return node->item;
 }
 
 char* LRUMemCache::create( __int64 offset )
@@ -268,4 +303,4 @@ char* LRUMemCache::create( __int64 offset )
 	}
 
 	return createInt(offset).buffer;
-}
+}
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 class LRUMemCache : public IThread
 {
@@ -28,31 +29,45 @@ public:
 	void operator()();
 
 private:
-	void finishThreads();
+	struct SCacheNode
+	{
+		SCacheItem item;
+		SCacheNode* prev;
+		SCacheNode* next;
+	};
+
 	void waitThreadWork();
 
+	SCacheNode* find(__int64 offset);
+
 	SCacheItem createInt(__int64 offset);
 
-	void putBack(size_t idx);
+	void putBack(SCacheNode* node);
+
+	void pushBack(SCacheNode* node);
+
+	void unlink(SCacheNode* node);
 
 	char* evict(SCacheItem& item, bool deleteBuffer);
 
 	char* getLruItemBuffer(IScopedLock& lock);
 
-	std::vector<SCacheItem> lruItems;
+	//Items by block offset. The list is ordered from least to most recently used
+	std::unordered_map<__int64, SCacheNode*> lruMap;
+	SCacheNode* lruHead;
+	SCacheNode* lruTail;
+	std::vector<SCacheNode*> freeNodes;
+
 	std::vector<SCacheItem> evictedItems;
 	std::vector<char*> lruItemBuffers;
 
 	std::unique_ptr<IMutex> mutex;
-	std::unique_ptr<ICondition> cond;
 	std::unique_ptr<ICondition> cond_wait;
 
 	size_t buffersize;
 	size_t nbuffers;
 	size_t n_threads;
 	size_t n_threads_working;
-	bool wait_work;
-	bool do_quit;
 
 	ICacheEvictionCallback* callback;
 };
\ No newline at end of file
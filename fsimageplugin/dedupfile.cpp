@@ -0,0 +1,1200 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "dedupfile.h"
+#include "../stringtools.h"
+#include "../urbackupcommon/os_functions.h"
+#include "../urbackupcommon/sha2/sha2.h"
+#include <memory.h>
+#include <atomic>
+#include <algorithm>
+
+namespace
+{
+	const char dedup_magic[] = "UrBDDIMG";
+	const _u32 dedup_version = 1;
+	const int64 dedup_header_size = 4096;
+	const _u32 dedup_flag_clean = 1;
+	const size_t dedup_max_pending_blocks = 8;
+	const char* dedup_images_dir = "images";
+
+	const char dedup_zero_hash[dedup_hash_size] = {};
+
+	std::atomic<uint64> dedup_tmp_id(0);
+
+	bool is_zero_hash(const char* hash)
+	{
+		return memcmp(hash, dedup_zero_hash, dedup_hash_size) == 0;
+	}
+
+	struct SDedupHash
+	{
+		char data[dedup_hash_size];
+
+		bool operator<(const SDedupHash& other) const
+		{
+			return memcmp(data, other.data, dedup_hash_size) < 0;
+		}
+
+		bool operator==(const SDedupHash& other) const
+		{
+			return memcmp(data, other.data, dedup_hash_size) == 0;
+		}
+	};
+
+	//Only the first half of the hash. A collision only keeps an unused block
+	//around, and it halves the memory of the used block set
+	struct SDedupHashPrefix
+	{
+		uint64 a;
+		uint64 b;
+
+		explicit SDedupHashPrefix(const char* hash)
+		{
+			memcpy(&a, hash, sizeof(a));
+			memcpy(&b, hash + sizeof(a), sizeof(b));
+		}
+
+		bool operator<(const SDedupHashPrefix& other) const
+		{
+			return a < other.a || (a == other.a && b < other.b);
+		}
+
+		bool operator==(const SDedupHashPrefix& other) const
+		{
+			return a == other.a && b == other.b;
+		}
+	};
+}
+
+std::mutex DedupBlockStore::gc_mutex;
+std::condition_variable DedupBlockStore::gc_cond;
+bool DedupBlockStore::gc_running = false;
+size_t DedupBlockStore::n_unprotected_commits = 0;
+std::set<std::string> DedupBlockStore::gc_protected;
+
+DedupBlockStore::DedupBlockStore(const std::string& path)
+	: path(path), is_open(true)
+{
+	if (!os_directory_exists(path + os_file_sep() + dedup_images_dir)
+		&& !os_create_dir_recursive(path + os_file_sep() + dedup_images_dir))
+	{
+		Server->Log("Error creating image block store at \"" + path + "\". " + os_last_error_str(), LL_ERROR);
+		is_open = false;
+	}
+}
+
+bool DedupBlockStore::isOpen()
+{
+	return is_open;
+}
+
+std::string DedupBlockStore::getPath()
+{
+	return path;
+}
+
+std::string DedupBlockStore::blockFn(const char* hash)
+{
+	std::string hex = bytesToHex(reinterpret_cast<const unsigned char*>(hash), dedup_hash_size);
+	return path + os_file_sep() + hex.substr(0, 2) + os_file_sep() + hex.substr(2, 2) + os_file_sep() + hex;
+}
+
+std::string DedupBlockStore::imageRefFn(const std::string& image_fn)
+{
+	unsigned char fn_hash[SHA256_DIGEST_SIZE];
+	sha256(reinterpret_cast<const unsigned char*>(image_fn.data()), static_cast<unsigned int>(image_fn.size()), fn_hash);
+	return path + os_file_sep() + dedup_images_dir + os_file_sep() + bytesToHex(fn_hash, sizeof(fn_hash));
+}
+
+bool DedupBlockStore::addBlock(const char* hash, const char* data, size_t data_size)
+{
+	std::string fn = blockFn(hash);
+
+	if (os_get_file_type(fn) & EFileType_File)
+	{
+		return true;
+	}
+
+	std::string tmp_fn = fn + "." + convert(++dedup_tmp_id) + ".new";
+	std::unique_ptr<IFile> tmp_f(Server->openFile(tmp_fn, MODE_WRITE));
+	if (tmp_f.get() == NULL)
+	{
+		std::string block_dir = ExtractFilePath(fn);
+		if (!os_directory_exists(block_dir)
+			&& !os_create_dir_recursive(block_dir))
+		{
+			Server->Log("Error creating image block directory \"" + block_dir + "\". " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+
+		tmp_f.reset(Server->openFile(tmp_fn, MODE_WRITE));
+		if (tmp_f.get() == NULL)
+		{
+			Server->Log("Error creating image block \"" + tmp_fn + "\". " + os_last_error_str(), LL_ERROR);
+			return false;
+		}
+	}
+
+	if (tmp_f->Write(data, static_cast<_u32>(data_size)) != data_size)
+	{
+		Server->Log("Error writing image block \"" + tmp_fn + "\". " + os_last_error_str(), LL_ERROR);
+		tmp_f.reset();
+		Server->deleteFile(tmp_fn);
+		return false;
+	}
+
+	tmp_f.reset();
+
+	if (!os_rename_file(tmp_fn, fn))
+	{
+		Server->deleteFile(tmp_fn);
+
+		//Added by another image in the meantime
+		if (os_get_file_type(fn) & EFileType_File)
+		{
+			return true;
+		}
+
+		Server->Log("Error renaming image block \"" + tmp_fn + "\" to \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+bool DedupBlockStore::readBlock(const char* hash, char* data, size_t data_size)
+{
+	std::string fn = blockFn(hash);
+	std::unique_ptr<IFile> f(Server->openFile(fn, MODE_READ));
+	if (f.get() == NULL)
+	{
+		Server->Log("Error opening image block \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	bool has_error = false;
+	if (f->Read(0, data, static_cast<_u32>(data_size), &has_error) != data_size
+		|| has_error)
+	{
+		Server->Log("Error reading image block \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+bool DedupBlockStore::beginCommit(const char* hash)
+{
+	std::lock_guard<std::mutex> lock(gc_mutex);
+	if (gc_running)
+	{
+		gc_protected.insert(std::string(hash, dedup_hash_size));
+		return true;
+	}
+
+	++n_unprotected_commits;
+	return false;
+}
+
+void DedupBlockStore::endCommit(bool is_protected)
+{
+	if (is_protected)
+	{
+		//Stays protected until the collection ends
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(gc_mutex);
+	--n_unprotected_commits;
+	if (n_unprotected_commits == 0)
+	{
+		gc_cond.notify_all();
+	}
+}
+
+bool DedupBlockStore::addImageRef(const std::string& image_fn)
+{
+	std::string ref_fn = imageRefFn(image_fn);
+	std::string tmp_fn = ref_fn + ".new";
+
+	std::unique_ptr<IFile> f(Server->openFile(tmp_fn, MODE_WRITE));
+	if (f.get() == NULL
+		|| f->Write(image_fn) != image_fn.size()
+		|| !f->Sync())
+	{
+		Server->Log("Error writing image reference \"" + tmp_fn + "\". " + os_last_error_str(), LL_ERROR);
+		f.reset();
+		Server->deleteFile(tmp_fn);
+		return false;
+	}
+	f.reset();
+
+	if (!os_rename_file(tmp_fn, ref_fn))
+	{
+		Server->Log("Error renaming image reference \"" + tmp_fn + "\" to \"" + ref_fn + "\". " + os_last_error_str(), LL_ERROR);
+		Server->deleteFile(tmp_fn);
+		return false;
+	}
+
+	return true;
+}
+
+bool DedupBlockStore::removeImageRef(const std::string& image_fn)
+{
+	std::string ref_fn = imageRefFn(image_fn);
+	if (!Server->deleteFile(ref_fn)
+		&& (os_get_file_type(ref_fn) & EFileType_File))
+	{
+		Server->Log("Error deleting image reference \"" + ref_fn + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+	return true;
+}
+
+std::vector<std::string> DedupBlockStore::getImageRefs(bool& has_error)
+{
+	std::string refs_dir = path + os_file_sep() + dedup_images_dir;
+	has_error = false;
+	std::vector<SFile> files = getFiles(refs_dir, &has_error);
+	std::vector<std::string> ret;
+	if (has_error)
+	{
+		Server->Log("Error listing image references in \"" + refs_dir + "\". " + os_last_error_str(), LL_ERROR);
+		return ret;
+	}
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (files[i].isdir
+			|| findextension(files[i].name) == "new")
+		{
+			continue;
+		}
+
+		std::string image_fn = getFile(refs_dir + os_file_sep() + files[i].name);
+		if (image_fn.empty())
+		{
+			Server->Log("Error reading image reference \"" + files[i].name + "\" in \"" + refs_dir + "\"", LL_ERROR);
+			has_error = true;
+			return std::vector<std::string>();
+		}
+		ret.push_back(image_fn);
+	}
+
+	return ret;
+}
+
+void DedupBlockStore::beginCollect()
+{
+	std::unique_lock<std::mutex> lock(gc_mutex);
+	while (gc_running)
+	{
+		gc_cond.wait(lock);
+	}
+	gc_running = true;
+
+	//Commits started before have to reach the image block tables before
+	//those are read
+	while (n_unprotected_commits > 0)
+	{
+		gc_cond.wait(lock);
+	}
+}
+
+void DedupBlockStore::endCollect()
+{
+	std::lock_guard<std::mutex> lock(gc_mutex);
+	gc_running = false;
+	gc_protected.clear();
+	gc_cond.notify_all();
+}
+
+int DedupBlockStore::deleteUnusedBlock(const std::string& hash, const std::string& fn)
+{
+	//Under the lock, so a commit either protects the block first or sees it
+	//is gone and stores it again
+	std::lock_guard<std::mutex> lock(gc_mutex);
+	if (gc_protected.find(hash) != gc_protected.end())
+	{
+		return 0;
+	}
+
+	if (!Server->deleteFile(fn)
+		&& (os_get_file_type(fn) & EFileType_File))
+	{
+		Server->Log("Error deleting unused image block \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return -1;
+	}
+
+	return 1;
+}
+
+bool DedupBlockStore::sync()
+{
+	return os_sync(path);
+}
+
+DedupFile::DedupFile(const std::string& fn, const std::string& parent_fn, const std::string& block_store_path,
+	uint64 pDstsize, unsigned int pBlocksize)
+	: filename(fn), is_open(false), read_only(false), finished(false),
+	block_size(pBlocksize), dst_size(pDstsize), spos(0), cached_block(-1)
+{
+	store.reset(new DedupBlockStore(block_store_path));
+	if (!store->isOpen())
+	{
+		return;
+	}
+
+	if (!parent_fn.empty())
+	{
+		DedupFile parent(parent_fn, true);
+		if (!parent.isOpen())
+		{
+			Server->Log("Error opening dedup image parent at \"" + parent_fn + "\"", LL_ERROR);
+			return;
+		}
+
+		if (parent.store->getPath() != store->getPath())
+		{
+			Server->Log("Dedup image parent \"" + parent_fn + "\" uses a different block store. Using block store at \""
+				+ parent.store->getPath() + "\".", LL_WARNING);
+			store.swap(parent.store);
+		}
+
+		block_size = parent.block_size;
+		if (dst_size == 0)
+		{
+			dst_size = parent.dst_size;
+		}
+
+		bat = parent.bat;
+	}
+
+	if (block_size == 0)
+	{
+		Server->Log("Invalid dedup image block size", LL_ERROR);
+		return;
+	}
+
+	bat.resize(static_cast<size_t>((dst_size + block_size - 1) / block_size)*dedup_hash_size);
+
+	file.reset(Server->openFile(fn, MODE_RW_CREATE));
+	if (file.get() == NULL)
+	{
+		Server->Log("Error creating dedup image \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return;
+	}
+
+	if (!writeHeader(false))
+	{
+		return;
+	}
+
+	if (!bat.empty()
+		&& file->Write(dedup_header_size, bat.data(), static_cast<_u32>(bat.size())) != bat.size())
+	{
+		Server->Log("Error writing dedup image block table. " + os_last_error_str(), LL_ERROR);
+		return;
+	}
+
+	//The parent keeps its blocks until the table is on disk and the image
+	//is registered. New blocks are only committed afterwards
+	if (!file->Sync()
+		|| !store->addImageRef(filename))
+	{
+		Server->Log("Error registering dedup image \"" + fn + "\" in block store \"" + store->getPath() + "\"", LL_ERROR);
+		return;
+	}
+
+	is_open = true;
+}
+
+DedupFile::DedupFile(const std::string& fn, bool pRead_only)
+	: filename(fn), is_open(false), read_only(pRead_only), finished(false),
+	block_size(0), dst_size(0), spos(0), cached_block(-1)
+{
+	file.reset(Server->openFile(fn, read_only ? MODE_READ : MODE_RW));
+	if (file.get() == NULL)
+	{
+		Server->Log("Error opening dedup image \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return;
+	}
+
+	if (!readHeader())
+	{
+		return;
+	}
+
+	if (!read_only
+		&& !writeHeader(false))
+	{
+		return;
+	}
+
+	is_open = true;
+}
+
+DedupFile::~DedupFile()
+{
+	if (is_open && !read_only)
+	{
+		finish();
+	}
+}
+
+bool DedupFile::readHeader()
+{
+	DedupFileHeader header;
+	if (file->Read(0, reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+		|| memcmp(header.magic, dedup_magic, sizeof(header.magic)) != 0)
+	{
+		Server->Log("Dedup image header of \"" + filename + "\" is invalid", LL_ERROR);
+		return false;
+	}
+
+	if (little_endian(header.version) != dedup_version)
+	{
+		Server->Log("Unknown dedup image version " + convert(little_endian(header.version)), LL_ERROR);
+		return false;
+	}
+
+	block_size = little_endian(header.block_size);
+	dst_size = static_cast<int64>(little_endian(header.dst_size));
+	_u32 store_path_size = little_endian(header.store_path_size);
+
+	if (block_size == 0
+		|| dst_size < 0
+		|| store_path_size > dedup_header_size - sizeof(header))
+	{
+		Server->Log("Dedup image header of \"" + filename + "\" is invalid -2", LL_ERROR);
+		return false;
+	}
+
+	std::string store_path = file->Read(sizeof(header), store_path_size);
+	if (store_path.size() != store_path_size)
+	{
+		Server->Log("Error reading block store path of dedup image \"" + filename + "\"", LL_ERROR);
+		return false;
+	}
+
+	store.reset(new DedupBlockStore(store_path));
+
+	bat.resize(static_cast<size_t>((dst_size + block_size - 1) / block_size)*dedup_hash_size);
+
+	if (!bat.empty()
+		&& file->Read(dedup_header_size, bat.data(), static_cast<_u32>(bat.size())) != bat.size())
+	{
+		Server->Log("Error reading dedup image block table of \"" + filename + "\"", LL_ERROR);
+		return false;
+	}
+
+	return store->isOpen();
+}
+
+bool DedupFile::writeHeader(bool is_clean)
+{
+	std::string store_path = store->getPath();
+
+	std::vector<char> buf(dedup_header_size);
+	DedupFileHeader* header = reinterpret_cast<DedupFileHeader*>(buf.data());
+	memcpy(header->magic, dedup_magic, sizeof(header->magic));
+	header->version = little_endian(dedup_version);
+	header->block_size = little_endian(block_size);
+	header->dst_size = little_endian(static_cast<uint64>(dst_size));
+	header->flags = little_endian(is_clean ? dedup_flag_clean : 0);
+	header->store_path_size = little_endian(static_cast<_u32>(store_path.size()));
+
+	if (store_path.size() > buf.size() - sizeof(DedupFileHeader))
+	{
+		Server->Log("Block store path \"" + store_path + "\" is too long", LL_ERROR);
+		return false;
+	}
+
+	memcpy(buf.data() + sizeof(DedupFileHeader), store_path.data(), store_path.size());
+
+	if (file->Write(0, buf.data(), static_cast<_u32>(buf.size())) != buf.size())
+	{
+		Server->Log("Error writing dedup image header of \"" + filename + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	if (!file->Sync())
+	{
+		Server->Log("Error syncing dedup image \"" + filename + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+bool DedupFile::writeBatEntry(int64 block)
+{
+	if (file->Write(dedup_header_size + block*dedup_hash_size, &bat[block*dedup_hash_size],
+		static_cast<_u32>(dedup_hash_size)) != dedup_hash_size)
+	{
+		Server->Log("Error writing dedup image block table entry " + convert(block) + ". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+	return true;
+}
+
+bool DedupFile::hasBlock(int64 block)
+{
+	return pending_blocks.find(block) != pending_blocks.end()
+		|| !is_zero_hash(&bat[block*dedup_hash_size]);
+}
+
+std::vector<char>* DedupFile::getPendingBlock(int64 block)
+{
+	std::map<int64, std::vector<char> >::iterator it = pending_blocks.find(block);
+	if (it != pending_blocks.end())
+	{
+		return &it->second;
+	}
+
+	std::vector<char>& data = pending_blocks[block];
+	data.resize(block_size);
+
+	const char* hash = &bat[block*dedup_hash_size];
+	if (!is_zero_hash(hash)
+		&& !store->readBlock(hash, data.data(), data.size()))
+	{
+		pending_blocks.erase(block);
+		return NULL;
+	}
+
+	return &data;
+}
+
+bool DedupFile::commitBlock(int64 block)
+{
+	std::map<int64, std::vector<char> >::iterator it = pending_blocks.find(block);
+	if (it == pending_blocks.end())
+	{
+		return true;
+	}
+
+	char* hash = &bat[block*dedup_hash_size];
+
+	char new_hash[dedup_hash_size];
+	sha256_ctx shactx;
+	sha256_init(&shactx);
+	sha256_update(&shactx, reinterpret_cast<const unsigned char*>(it->second.data()), static_cast<unsigned int>(it->second.size()));
+	sha256_final(&shactx, reinterpret_cast<unsigned char*>(new_hash));
+
+	if (memcmp(new_hash, hash, dedup_hash_size) == 0)
+	{
+		pending_blocks.erase(it);
+		return true;
+	}
+
+	bool gc_protected = store->beginCommit(new_hash);
+
+	if (!store->addBlock(new_hash, it->second.data(), it->second.size()))
+	{
+		store->endCommit(gc_protected);
+		return false;
+	}
+
+	if (cached_block == block)
+	{
+		cached_block = -1;
+	}
+
+	//The old block is removed by the next collection if no other image uses it
+	memcpy(hash, new_hash, dedup_hash_size);
+	pending_blocks.erase(it);
+
+	bool ret = writeBatEntry(block);
+	store->endCommit(gc_protected);
+	return ret;
+}
+
+bool DedupFile::commitPending()
+{
+	while (!pending_blocks.empty())
+	{
+		if (!commitBlock(pending_blocks.begin()->first))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DedupFile::Seek(_i64 offset)
+{
+	spos = offset;
+	return true;
+}
+
+bool DedupFile::Read(char* buffer, size_t bsize, size_t& read)
+{
+	bool has_read_error = false;
+	read = Read(spos, buffer, static_cast<_u32>(bsize), &has_read_error);
+	spos += read;
+	return !has_read_error;
+}
+
+_u32 DedupFile::Write(const char* buffer, _u32 bsize, bool* has_error)
+{
+	_u32 rc = Write(spos, buffer, bsize, has_error);
+	spos += rc;
+	return rc;
+}
+
+bool DedupFile::isOpen(void)
+{
+	return is_open;
+}
+
+uint64 DedupFile::getSize(void)
+{
+	return dst_size;
+}
+
+uint64 DedupFile::usedSize(void)
+{
+	uint64 ret = 0;
+	for (int64 block = 0; block*dedup_hash_size < static_cast<int64>(bat.size()); ++block)
+	{
+		if (hasBlock(block))
+		{
+			ret += block_size;
+		}
+	}
+	return ret;
+}
+
+std::string DedupFile::getFilename(void)
+{
+	return filename;
+}
+
+bool DedupFile::has_sector(_i64 sector_size)
+{
+	return this_has_sector(sector_size);
+}
+
+bool DedupFile::this_has_sector(_i64 sector_size)
+{
+	if (spos >= dst_size)
+	{
+		return false;
+	}
+	return hasBlock(spos / block_size);
+}
+
+unsigned int DedupFile::getBlocksize()
+{
+	return block_size;
+}
+
+bool DedupFile::finish()
+{
+	if (finished || read_only)
+	{
+		return true;
+	}
+
+	if (!commitPending())
+	{
+		return false;
+	}
+
+	//Blocks have to be persistent before the image is marked clean
+	if (!store->sync())
+	{
+		Server->Log("Error syncing image block store at \"" + store->getPath() + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	if (!file->Sync()
+		|| !writeHeader(true))
+	{
+		return false;
+	}
+
+	finished = true;
+	return true;
+}
+
+bool DedupFile::trimUnused(_i64 fs_offset, _i64 trim_blocksize, ITrimCallback* trim_callback)
+{
+	return true;
+}
+
+bool DedupFile::syncBitmap(_i64 fs_offset)
+{
+	return true;
+}
+
+bool DedupFile::makeFull(_i64 fs_offset, IVHDWriteCallback* write_callback)
+{
+	//Incremental dedup images reference all blocks of their parent already
+	return true;
+}
+
+bool DedupFile::setUnused(_i64 unused_start, _i64 unused_end)
+{
+	if (read_only)
+	{
+		Server->Log("Dedup image is read only", LL_ERROR);
+		return false;
+	}
+
+	if (unused_end > dst_size)
+	{
+		unused_end = dst_size;
+	}
+
+	int64 block_start = (unused_start + block_size - 1) / block_size;
+	int64 block_end = unused_end / block_size;
+	if (unused_end == dst_size)
+	{
+		block_end = (unused_end + block_size - 1) / block_size;
+	}
+
+	for (int64 block = block_start; block < block_end; ++block)
+	{
+		pending_blocks.erase(block);
+
+		char* hash = &bat[block*dedup_hash_size];
+		if (is_zero_hash(hash))
+		{
+			continue;
+		}
+
+		memset(hash, 0, dedup_hash_size);
+
+		if (cached_block == block)
+		{
+			cached_block = -1;
+		}
+
+		if (!writeBatEntry(block))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool DedupFile::setBackingFileSize(_i64 fsize)
+{
+	return true;
+}
+
+std::string DedupFile::Read(_u32 tr, bool* has_error)
+{
+	std::string ret = Read(spos, tr, has_error);
+	spos += ret.size();
+	return ret;
+}
+
+std::string DedupFile::Read(int64 spos, _u32 tr, bool* has_error)
+{
+	std::string ret;
+	ret.resize(tr);
+
+	_u32 rc = Read(spos, &ret[0], tr, has_error);
+	if (rc < tr)
+		ret.resize(rc);
+
+	return ret;
+}
+
+_u32 DedupFile::Read(char* buffer, _u32 bsize, bool* has_error)
+{
+	_u32 rc = Read(spos, buffer, bsize, has_error);
+	spos += rc;
+	return rc;
+}
+
+_u32 DedupFile::Read(int64 spos, char* buffer, _u32 bsize, bool* has_error)
+{
+	if (spos > dst_size)
+	{
+		if (has_error != NULL)
+			*has_error = true;
+
+		return 0;
+	}
+	else if (spos + bsize > dst_size)
+	{
+		bsize = static_cast<_u32>(dst_size - spos);
+	}
+
+	_u32 read = 0;
+	while (read < bsize)
+	{
+		int64 block = (spos + read) / block_size;
+		_u32 block_off = static_cast<_u32>((spos + read) % block_size);
+		_u32 toread = (std::min)(block_size - block_off, bsize - read);
+
+		std::map<int64, std::vector<char> >::iterator it = pending_blocks.find(block);
+		const char* hash = &bat[block*dedup_hash_size];
+
+		if (it != pending_blocks.end())
+		{
+			memcpy(buffer + read, it->second.data() + block_off, toread);
+		}
+		else if (is_zero_hash(hash))
+		{
+			memset(buffer + read, 0, toread);
+		}
+		else
+		{
+			if (cached_block != block)
+			{
+				cached_block_data.resize(block_size);
+				if (!store->readBlock(hash, cached_block_data.data(), cached_block_data.size()))
+				{
+					cached_block = -1;
+					if (has_error != NULL)
+						*has_error = true;
+					return read;
+				}
+				cached_block = block;
+			}
+
+			memcpy(buffer + read, cached_block_data.data() + block_off, toread);
+		}
+
+		read += toread;
+	}
+
+	return read;
+}
+
+_u32 DedupFile::Write(const std::string& tw, bool* has_error)
+{
+	return Write(tw.data(), static_cast<_u32>(tw.size()), has_error);
+}
+
+_u32 DedupFile::Write(int64 spos, const std::string& tw, bool* has_error)
+{
+	return Write(spos, tw.data(), static_cast<_u32>(tw.size()), has_error);
+}
+
+_u32 DedupFile::Write(int64 spos, const char* buffer, _u32 bsiz, bool* has_error)
+{
+	if (read_only
+		|| spos + bsiz > dst_size)
+	{
+		Server->Log("Dedup image is read only or write beyond end of image (pos " + convert(spos) + ")", LL_ERROR);
+		if (has_error != NULL)
+			*has_error = true;
+		return 0;
+	}
+
+	_u32 written = 0;
+	while (written < bsiz)
+	{
+		int64 block = (spos + written) / block_size;
+		_u32 block_off = static_cast<_u32>((spos + written) % block_size);
+		_u32 towrite = (std::min)(block_size - block_off, bsiz - written);
+
+		std::vector<char>* data = getPendingBlock(block);
+		if (data == NULL)
+		{
+			if (has_error != NULL)
+				*has_error = true;
+			return written;
+		}
+
+		memcpy(data->data() + block_off, buffer + written, towrite);
+		written += towrite;
+
+		bool block_full = block_off + towrite == block_size
+			|| block*block_size + block_off + towrite == dst_size;
+
+		if (block_full
+			&& !commitBlock(block))
+		{
+			if (has_error != NULL)
+				*has_error = true;
+			return written;
+		}
+
+		//Blocks written out of order are kept around for a while
+		while (pending_blocks.size() > dedup_max_pending_blocks)
+		{
+			int64 commit_block = pending_blocks.begin()->first;
+			if (commit_block == block)
+			{
+				commit_block = (++pending_blocks.begin())->first;
+			}
+
+			if (!commitBlock(commit_block))
+			{
+				if (has_error != NULL)
+					*has_error = true;
+				return written;
+			}
+		}
+	}
+
+	return written;
+}
+
+_i64 DedupFile::Size(void)
+{
+	return dst_size;
+}
+
+_i64 DedupFile::RealSize()
+{
+	return usedSize();
+}
+
+bool DedupFile::PunchHole(_i64 spos, _i64 size)
+{
+	return setUnused(spos, spos + size);
+}
+
+bool DedupFile::Sync()
+{
+	if (read_only)
+	{
+		return true;
+	}
+
+	return commitPending()
+		&& file->Sync();
+}
+
+bool DedupFile::removeImage(const std::string& fn)
+{
+	std::vector<char> bat;
+	std::unique_ptr<DedupBlockStore> store;
+	{
+		DedupFile image(fn, true);
+		if (!image.isOpen())
+		{
+			return false;
+		}
+
+		bat.swap(image.bat);
+		store.swap(image.store);
+	}
+
+	if (!Server->deleteFile(fn))
+	{
+		Server->Log("Error deleting dedup image \"" + fn + "\". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	//Deletion of the image has to be persistent before the blocks may go away
+	os_sync(ExtractFilePath(fn));
+
+	//Left over references are removed by the next collection
+	store->removeImageRef(fn);
+
+	if (!collectGarbage(*store, &bat))
+	{
+		Server->Log("Error removing unused blocks of dedup image \"" + fn + "\" from block store \""
+			+ store->getPath() + "\"", LL_WARNING);
+	}
+
+	return true;
+}
+
+bool DedupFile::collectGarbage(const std::string& block_store_path)
+{
+	if (!os_directory_exists(block_store_path))
+	{
+		return true;
+	}
+
+	DedupBlockStore store(block_store_path);
+	if (!store.isOpen())
+	{
+		return false;
+	}
+
+	return collectGarbage(store, NULL);
+}
+
+bool DedupFile::collectGarbage(DedupBlockStore& store, const std::vector<char>* candidate_bat)
+{
+	std::vector<SDedupHash> candidates;
+	if (candidate_bat != NULL)
+	{
+		for (size_t i = 0; i < candidate_bat->size(); i += dedup_hash_size)
+		{
+			if (!is_zero_hash(&(*candidate_bat)[i]))
+			{
+				SDedupHash hash;
+				memcpy(hash.data, &(*candidate_bat)[i], dedup_hash_size);
+				candidates.push_back(hash);
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+		if (candidates.empty())
+		{
+			return true;
+		}
+	}
+
+	store.beginCollect();
+
+	bool has_error = false;
+	std::vector<std::string> images = store.getImageRefs(has_error);
+	if (has_error)
+	{
+		store.endCollect();
+		return false;
+	}
+
+	//Mark the blocks the registered images use
+	std::vector<char> candidate_used(candidates.size());
+	std::vector<SDedupHashPrefix> used;
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		if (os_get_file_type(images[i]) == 0)
+		{
+			Server->Log("Removing reference of deleted dedup image \"" + images[i] + "\" from block store \"" + store.getPath() + "\"", LL_INFO);
+			store.removeImageRef(images[i]);
+			continue;
+		}
+
+		DedupFile image(images[i], true);
+		if (!image.isOpen())
+		{
+			//Cannot know which blocks it uses
+			Server->Log("Error opening dedup image \"" + images[i] + "\". Not removing any blocks from block store \"" + store.getPath() + "\".", LL_ERROR);
+			store.endCollect();
+			return false;
+		}
+
+		size_t used_size = used.size();
+		for (size_t j = 0; j < image.bat.size(); j += dedup_hash_size)
+		{
+			const char* hash = &image.bat[j];
+			if (is_zero_hash(hash))
+			{
+				continue;
+			}
+
+			if (candidate_bat != NULL)
+			{
+				SDedupHash search;
+				memcpy(search.data, hash, dedup_hash_size);
+				std::vector<SDedupHash>::iterator it = std::lower_bound(candidates.begin(), candidates.end(), search);
+				if (it != candidates.end() && *it == search)
+				{
+					candidate_used[it - candidates.begin()] = 1;
+				}
+			}
+			else
+			{
+				used.push_back(SDedupHashPrefix(hash));
+			}
+		}
+
+		if (used.size() != used_size)
+		{
+			std::sort(used.begin(), used.end());
+			used.erase(std::unique(used.begin(), used.end()), used.end());
+		}
+	}
+
+	int64 n_deleted = 0;
+	int64 n_errors = 0;
+
+	if (candidate_bat != NULL)
+	{
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			if (candidate_used[i])
+			{
+				continue;
+			}
+
+			std::string hash(candidates[i].data, dedup_hash_size);
+			int rc = store.deleteUnusedBlock(hash, store.blockFn(hash.data()));
+			if (rc > 0) ++n_deleted;
+			else if (rc < 0) ++n_errors;
+		}
+	}
+	else
+	{
+		//Blocks are in <store>/xx/yy/<hash>, temporary files in <store>/xx/yy/<hash>.<id>.new
+		std::vector<SFile> dirs1 = getFiles(store.getPath(), &has_error);
+		for (size_t i = 0; !has_error && i < dirs1.size(); ++i)
+		{
+			if (!dirs1[i].isdir || dirs1[i].name.size() != 2)
+				continue;
+
+			std::string path1 = store.getPath() + os_file_sep() + dirs1[i].name;
+			std::vector<SFile> dirs2 = getFiles(path1, &has_error);
+			for (size_t j = 0; !has_error && j < dirs2.size(); ++j)
+			{
+				if (!dirs2[j].isdir)
+					continue;
+
+				std::string path2 = path1 + os_file_sep() + dirs2[j].name;
+				std::vector<SFile> blocks = getFiles(path2, &has_error);
+				for (size_t k = 0; !has_error && k < blocks.size(); ++k)
+				{
+					const std::string& name = blocks[k].name;
+					std::string hash = hexToBytes(name.substr(0, dedup_hash_size * 2));
+					if (blocks[k].isdir
+						|| hash.size() != dedup_hash_size)
+						continue;
+
+					bool is_block = name.size() == dedup_hash_size * 2;
+					if (is_block
+						&& std::binary_search(used.begin(), used.end(), SDedupHashPrefix(hash.data())))
+						continue;
+
+					int rc = store.deleteUnusedBlock(hash, path2 + os_file_sep() + name);
+					if (rc > 0 && is_block) ++n_deleted;
+					else if (rc < 0) ++n_errors;
+				}
+			}
+		}
+
+		if (has_error)
+		{
+			Server->Log("Error listing blocks in block store \"" + store.getPath() + "\". " + os_last_error_str(), LL_ERROR);
+			++n_errors;
+		}
+	}
+
+	store.endCollect();
+
+	if (n_deleted > 0)
+	{
+		Server->Log("Removed " + convert(n_deleted) + " unused blocks from image block store \"" + store.getPath() + "\"", LL_INFO);
+	}
+
+	if (n_errors > 0)
+	{
+		Server->Log("Error removing " + convert(n_errors) + " unused blocks from image block store \"" + store.getPath() + "\"", LL_WARNING);
+		return false;
+	}
+
+	return true;
+}
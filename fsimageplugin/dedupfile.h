@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../Interface/Server.h"
+#include "../Interface/File.h"
+#include "IVHDFile.h"
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <set>
+#include <vector>
+
+const size_t dedup_hash_size = 32;
+
+/**
+* Content addressed store of image blocks shared between dedup image files.
+* Each block is a file named after the SHA-256 of its content.
+* Blocks are not reference counted. Each image registers one reference file
+* in the store and its block table says which blocks it uses. Blocks no
+* registered image uses are removed by DedupFile::collectGarbage.
+*/
+class DedupBlockStore
+{
+public:
+	DedupBlockStore(const std::string& path);
+
+	bool isOpen();
+	std::string getPath();
+
+	//Stores the block with hash if it does not exist yet. Has to be
+	//called between beginCommit and endCommit
+	bool addBlock(const char* hash, const char* data, size_t data_size);
+
+	bool readBlock(const char* hash, char* data, size_t data_size);
+
+	//A block used by an image must not be collected before its hash is
+	//in the image's block table on disk. Returns the value to pass to endCommit
+	bool beginCommit(const char* hash);
+	void endCommit(bool is_protected);
+
+	bool addImageRef(const std::string& image_fn);
+	bool removeImageRef(const std::string& image_fn);
+	std::vector<std::string> getImageRefs(bool& has_error);
+
+	//Waits for running commits. Commits started afterwards are protected until endCollect
+	void beginCollect();
+	void endCollect();
+	//Deletes the block (or temporary block file fn) if no commit protects it.
+	//Returns 1 if it was deleted, 0 if it is protected and -1 on error
+	int deleteUnusedBlock(const std::string& hash, const std::string& fn);
+
+	std::string blockFn(const char* hash);
+
+	bool sync();
+
+private:
+	std::string imageRefFn(const std::string& image_fn);
+
+	std::string path;
+	bool is_open;
+
+	static std::mutex gc_mutex;
+	static std::condition_variable gc_cond;
+	static bool gc_running;
+	static size_t n_unprotected_commits;
+	static std::set<std::string> gc_protected;
+};
+
+#pragma pack(1)
+struct DedupFileHeader
+{
+	char magic[8];
+	_u32 version;
+	_u32 block_size;
+	uint64 dst_size;
+	_u32 flags;
+	_u32 store_path_size;
+};
+#pragma pack()
+
+/**
+* Image file which only contains a block allocation table of block hashes.
+* The block data is in a DedupBlockStore. Incremental images copy the
+* table of their parent, so every image is self-contained.
+*/
+class DedupFile : public IVHDFile
+{
+public:
+	DedupFile(const std::string& fn, const std::string& parent_fn, const std::string& block_store_path,
+		uint64 pDstsize, unsigned int pBlocksize);
+	DedupFile(const std::string& fn, bool pRead_only);
+	~DedupFile();
+
+	virtual bool Seek(_i64 offset) override;
+	virtual bool Read(char* buffer, size_t bsize, size_t& read) override;
+	virtual _u32 Write(const char* buffer, _u32 bsize, bool* has_error = NULL) override;
+	virtual bool isOpen(void) override;
+	virtual uint64 getSize(void) override;
+	virtual uint64 usedSize(void) override;
+	virtual std::string getFilename(void) override;
+	virtual bool has_sector(_i64 sector_size = -1) override;
+	virtual bool this_has_sector(_i64 sector_size = -1) override;
+	virtual unsigned int getBlocksize() override;
+	virtual bool finish() override;
+	virtual bool trimUnused(_i64 fs_offset, _i64 trim_blocksize, ITrimCallback* trim_callback) override;
+	virtual bool syncBitmap(_i64 fs_offset) override;
+	virtual bool makeFull(_i64 fs_offset, IVHDWriteCallback* write_callback) override;
+	virtual bool setUnused(_i64 unused_start, _i64 unused_end) override;
+	virtual bool setBackingFileSize(_i64 fsize) override;
+
+	virtual std::string Read(_u32 tr, bool* has_error = NULL) override;
+	virtual std::string Read(int64 spos, _u32 tr, bool* has_error = NULL) override;
+	virtual _u32 Read(char* buffer, _u32 bsize, bool* has_error = NULL) override;
+	virtual _u32 Read(int64 spos, char* buffer, _u32 bsize, bool* has_error = NULL) override;
+	virtual _u32 Write(const std::string& tw, bool* has_error = NULL) override;
+	virtual _u32 Write(int64 spos, const std::string& tw, bool* has_error = NULL) override;
+	virtual _u32 Write(int64 spos, const char* buffer, _u32 bsiz, bool* has_error = NULL) override;
+	virtual _i64 Size(void) override;
+	virtual _i64 RealSize() override;
+	virtual bool PunchHole(_i64 spos, _i64 size) override;
+	virtual bool Sync() override;
+
+	//Deletes the image file and the blocks only it used
+	static bool removeImage(const std::string& fn);
+
+	//Deletes all blocks in the store no image uses, e.g. blocks overwritten
+	//in an image or left behind by failed backups
+	static bool collectGarbage(const std::string& block_store_path);
+
+private:
+	//Without candidate_bat all blocks in the store are candidates
+	static bool collectGarbage(DedupBlockStore& store, const std::vector<char>* candidate_bat);
+
+	bool readHeader();
+	bool writeHeader(bool is_clean);
+	bool writeBatEntry(int64 block);
+	bool hasBlock(int64 block);
+	std::vector<char>* getPendingBlock(int64 block);
+	bool commitBlock(int64 block);
+	bool commitPending();
+
+	std::unique_ptr<IFile> file;
+	std::unique_ptr<DedupBlockStore> store;
+	std::string filename;
+
+	bool is_open;
+	bool read_only;
+	bool finished;
+
+	_u32 block_size;
+	int64 dst_size;
+	int64 spos;
+
+	std::vector<char> bat;
+	std::map<int64, std::vector<char> > pending_blocks;
+
+	int64 cached_block;
+	std::vector<char> cached_block_data;
+};
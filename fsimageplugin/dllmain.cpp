@@ -50,11 +50,13 @@ extern IServer* Server;
 #include "../stringtools.h"
 #include "../urbackupcommon/sha2/sha2.h"
 #include "../urbackupcommon/mbrdata.h"
+#include "../common/buf_is_zero.h"
 
 #include <stdlib.h>
 
 #include "vhdfile.h"
 #include "vhdxfile.h"
+#include "dedupfile.h"
 #ifndef _WIN32
 #include "cowfile.h"
 #endif
@@ -208,6 +210,13 @@ namespace
 			else
 				return new VHDXFile(device_verify, parent_fn, read_only);
 		}
+		else if (ext == "dedup")
+		{
+			if (parent_fn.empty())
+				return new DedupFile(device_verify, read_only);
+			Server->Log("Dedup images reference all blocks of their parent already", LL_ERROR);
+			return nullptr;
+		}
 #if !defined(_WIN32) && !defined(__APPLE__)
 		else if(ext=="raw")
 		{
@@ -914,17 +923,7 @@ DLLEXPORT void LoadActions(IServer* pServer)
 
 			if (skip_zeroes)
 			{
-				bool is_zero = true;
-				for (_u32 i = 0; i < towrite; ++i)
-				{
-					if (buf[i] != 0)
-					{
-						is_zero = false;
-						break;
-					}
-				}
-
-				if (is_zero)
+				if (buf_is_zero(buf.data(), towrite))
 				{
 					vhdfile->Seek(pos + towrite);
 					continue;
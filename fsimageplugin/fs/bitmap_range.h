@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../Interface/Types.h"
+#include <memory.h>
+
+namespace
+{
+	size_t fs_bitmap_bytes(int64 n_blocks)
+	{
+		return static_cast<size_t>((n_blocks + 7) / 8);
+	}
+
+	//Marks the blocks [start, start+count) used/free in a bitmap in the
+	//format Filesystem::hasBlock expects (block n is bit n%8 of byte n/8)
+	void fs_bitmap_set_range(unsigned char* bitmap, int64 n_blocks, int64 start, int64 count, bool used)
+	{
+		if (start < 0)
+		{
+			count += start;
+			start = 0;
+		}
+
+		if (start + count > n_blocks)
+		{
+			count = n_blocks - start;
+		}
+
+		int64 end = start + count;
+
+		while (start < end && start % 8 != 0)
+		{
+			if (used)
+				bitmap[start / 8] |= static_cast<unsigned char>(1 << (start % 8));
+			else
+				bitmap[start / 8] &= static_cast<unsigned char>(~(1 << (start % 8)));
+			++start;
+		}
+
+		if (end - start >= 8)
+		{
+			memset(bitmap + start / 8, used ? 0xFF : 0, static_cast<size_t>((end - start) / 8));
+			start += ((end - start) / 8) * 8;
+		}
+
+		while (start < end)
+		{
+			if (used)
+				bitmap[start / 8] |= static_cast<unsigned char>(1 << (start % 8));
+			else
+				bitmap[start / 8] &= static_cast<unsigned char>(~(1 << (start % 8)));
+			++start;
+		}
+	}
+}
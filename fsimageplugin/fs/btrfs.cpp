@@ -0,0 +1,538 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "btrfs.h"
+#include "bitmap_range.h"
+#include "../../Interface/Server.h"
+#include "../../stringtools.h"
+#include <memory.h>
+
+namespace
+{
+	const uint64 btrfs_super_offset = 64 * 1024;
+	const size_t btrfs_super_size = 4096;
+	const char btrfs_magic[] = "_BHRfS_M";
+	const size_t btrfs_sys_chunk_array_offset = 0x32B;
+	const size_t btrfs_sys_chunk_array_max = 2048;
+
+	//Superblock mirrors at 64KiB, 64MiB and 256GiB
+	const uint64 btrfs_super_mirrors[] = { 64ULL * 1024, 64ULL * 1024 * 1024, 256ULL * 1024 * 1024 * 1024 };
+	//The first MiB is never allocated (boot loaders)
+	const uint64 btrfs_reserved_start = 1024 * 1024;
+
+	const uint64 btrfs_incompat_extent_tree_v2 = 1ULL << 13;
+
+	const uint64 btrfs_block_group_raid0 = 1ULL << 3;
+	const uint64 btrfs_block_group_raid10 = 1ULL << 6;
+	const uint64 btrfs_block_group_raid5 = 1ULL << 7;
+	const uint64 btrfs_block_group_raid6 = 1ULL << 8;
+
+	const uint64 btrfs_extent_tree_objectid = 2;
+
+	const unsigned char btrfs_extent_data_key = 108;
+	const unsigned char btrfs_root_item_key = 132;
+	const unsigned char btrfs_extent_item_key = 168;
+	const unsigned char btrfs_metadata_item_key = 169;
+	const unsigned char btrfs_chunk_item_key = 228;
+
+	const unsigned char btrfs_file_extent_reg = 1;
+	const unsigned char btrfs_file_extent_prealloc = 2;
+
+	const size_t btrfs_header_size = 101;
+	const size_t btrfs_disk_key_size = 17;
+	const size_t btrfs_item_size = btrfs_disk_key_size + 8;
+	const size_t btrfs_key_ptr_size = btrfs_disk_key_size + 16;
+	const size_t btrfs_chunk_item_size = 48;
+	const size_t btrfs_stripe_size = 32;
+	const size_t btrfs_root_item_min_size = 239;
+	const size_t btrfs_file_extent_min_size = 37;
+
+	const int btrfs_max_level = 8;
+
+	uint64 btrfs_u64(const char* data, size_t off)
+	{
+		uint64 ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return little_endian(ret);
+	}
+
+	_u32 btrfs_u32(const char* data, size_t off)
+	{
+		_u32 ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return little_endian(ret);
+	}
+
+	unsigned short btrfs_u16(const char* data, size_t off)
+	{
+		unsigned short ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return little_endian(ret);
+	}
+}
+
+FSBtrfs::FSBtrfs(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, read_ahead, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSBtrfs::FSBtrfs(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSBtrfs::~FSBtrfs(void)
+{
+	delete[] bitmap;
+}
+
+bool FSBtrfs::isBtrfs(IFile* pDev)
+{
+	char magic[sizeof(btrfs_magic) - 1];
+	bool read_error = false;
+	if (pDev->Read(btrfs_super_offset + 0x40, magic, sizeof(magic), &read_error) != sizeof(magic)
+		|| read_error)
+	{
+		return false;
+	}
+
+	return memcmp(magic, btrfs_magic, sizeof(magic)) == 0;
+}
+
+void FSBtrfs::init()
+{
+	if (has_error)
+		return;
+
+	std::vector<char> sb(btrfs_super_size);
+	bool read_error = false;
+	if (dev->Read(btrfs_super_offset, sb.data(), static_cast<_u32>(sb.size()), &read_error) != sb.size()
+		|| read_error)
+	{
+		Server->Log("Error reading btrfs superblock", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	if (memcmp(sb.data() + 0x40, btrfs_magic, sizeof(btrfs_magic) - 1) != 0)
+	{
+		Server->Log("btrfs superblock magic wrong", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	uint64 root = btrfs_u64(sb.data(), 0x50);
+	uint64 chunk_root = btrfs_u64(sb.data(), 0x58);
+	uint64 log_root = btrfs_u64(sb.data(), 0x60);
+	uint64 num_devices = btrfs_u64(sb.data(), 0x88);
+	blocksize = btrfs_u32(sb.data(), 0x90);
+	nodesize = btrfs_u32(sb.data(), 0x94);
+	_u32 sys_chunk_array_size = btrfs_u32(sb.data(), 0xA0);
+	uint64 incompat_flags = btrfs_u64(sb.data(), 0xBC);
+	int root_level = static_cast<unsigned char>(sb[0xC6]);
+	int chunk_root_level = static_cast<unsigned char>(sb[0xC7]);
+	int log_root_level = static_cast<unsigned char>(sb[0xC8]);
+	devid = btrfs_u64(sb.data(), 0xC9);
+	uint64 dev_total_bytes = btrfs_u64(sb.data(), 0xD1);
+
+	if (num_devices != 1)
+	{
+		Server->Log("btrfs with " + convert(num_devices) + " devices is not supported", LL_WARNING);
+		has_error = true;
+		return;
+	}
+
+	if (incompat_flags & btrfs_incompat_extent_tree_v2)
+	{
+		Server->Log("btrfs extent tree v2 is not supported", LL_WARNING);
+		has_error = true;
+		return;
+	}
+
+	if (blocksize < 512 || blocksize > 65536
+		|| (blocksize & (blocksize - 1)) != 0
+		|| nodesize < static_cast<uint64>(blocksize) || nodesize > 65536
+		|| sys_chunk_array_size > btrfs_sys_chunk_array_max)
+	{
+		Server->Log("Invalid btrfs superblock geometry", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	drivesize = dev->Size();
+	n_blocks = (drivesize + blocksize - 1) / blocksize;
+
+	if (dev_total_bytes > static_cast<uint64>(drivesize))
+	{
+		Server->Log("btrfs device (" + PrettyPrintBytes(dev_total_bytes) + ") is larger than block device (" + PrettyPrintBytes(drivesize) + ")", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	//Chunks needed to read the chunk tree
+	const char* sys_chunks = sb.data() + btrfs_sys_chunk_array_offset;
+	for (size_t off = 0; off < sys_chunk_array_size; )
+	{
+		if (off + btrfs_disk_key_size > sys_chunk_array_size
+			|| static_cast<unsigned char>(sys_chunks[off + 8]) != btrfs_chunk_item_key)
+		{
+			Server->Log("Invalid btrfs system chunk array", LL_ERROR);
+			has_error = true;
+			return;
+		}
+
+		uint64 logical = btrfs_u64(sys_chunks, off + 9);
+		off += btrfs_disk_key_size;
+
+		size_t chunk_size;
+		if (!addChunk(logical, sys_chunks + off, sys_chunk_array_size - off, chunk_size))
+		{
+			has_error = true;
+			return;
+		}
+		off += chunk_size;
+	}
+
+	bitmap = new unsigned char[fs_bitmap_bytes(n_blocks)];
+	memset(bitmap, 0, fs_bitmap_bytes(n_blocks));
+	used_bytes = 0;
+
+	if (!walkTree(chunk_root, chunk_root_level, ETreeWalk_Chunk, 0))
+	{
+		has_error = true;
+		return;
+	}
+
+	find_root_objectid = btrfs_extent_tree_objectid;
+	found_root.bytenr = 0;
+	if (!walkTree(root, root_level, ETreeWalk_FindRoot, 0)
+		|| found_root.bytenr == 0)
+	{
+		Server->Log("Could not find btrfs extent tree", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	//Every allocated data extent and tree block (including the chunk,
+	//root and extent trees themselves) is in the extent tree
+	if (!walkTree(found_root.bytenr, found_root.level, ETreeWalk_Extent, 0))
+	{
+		has_error = true;
+		return;
+	}
+
+	//Blocks and data extents referenced by a not yet replayed log tree
+	//(fsync after the last commit) are not in the committed extent tree
+	if (log_root != 0
+		&& !walkTree(log_root, log_root_level, ETreeWalk_Log, 0))
+	{
+		has_error = true;
+		return;
+	}
+
+	markUsed(0, btrfs_reserved_start);
+
+	for (size_t i = 0; i < sizeof(btrfs_super_mirrors) / sizeof(btrfs_super_mirrors[0]); ++i)
+	{
+		markUsed(btrfs_super_mirrors[i], btrfs_super_size);
+	}
+
+	//Space after the end of the file system
+	markUsed(dev_total_bytes, drivesize - dev_total_bytes);
+
+	Server->Log("btrfs: " + convert(chunks.size()) + " chunks, " + PrettyPrintBytes(used_bytes) + " in extents", LL_DEBUG);
+}
+
+bool FSBtrfs::addChunk(uint64 logical, const char* data, size_t data_size, size_t& chunk_size)
+{
+	if (data_size < btrfs_chunk_item_size)
+	{
+		Server->Log("btrfs chunk item too small", LL_ERROR);
+		return false;
+	}
+
+	SChunk chunk;
+	chunk.length = btrfs_u64(data, 0);
+	chunk.type = btrfs_u64(data, 24);
+	unsigned short num_stripes = btrfs_u16(data, 44);
+
+	chunk_size = btrfs_chunk_item_size + num_stripes*btrfs_stripe_size;
+
+	if (num_stripes == 0
+		|| chunk_size > data_size)
+	{
+		Server->Log("Invalid btrfs chunk item at " + convert(logical), LL_ERROR);
+		return false;
+	}
+
+	if (chunk.type & (btrfs_block_group_raid0 | btrfs_block_group_raid10 | btrfs_block_group_raid5 | btrfs_block_group_raid6))
+	{
+		Server->Log("Striped btrfs chunk profiles are not supported", LL_WARNING);
+		return false;
+	}
+
+	for (unsigned short i = 0; i < num_stripes; ++i)
+	{
+		const char* stripe = data + btrfs_chunk_item_size + i*btrfs_stripe_size;
+		if (btrfs_u64(stripe, 0) != devid)
+		{
+			Server->Log("btrfs chunk at " + convert(logical) + " is on another device", LL_WARNING);
+			return false;
+		}
+
+		chunk.stripe_offsets.push_back(btrfs_u64(stripe, 8));
+	}
+
+	chunks[logical] = chunk;
+	return true;
+}
+
+bool FSBtrfs::walkTree(uint64 bytenr, int level, ETreeWalk mode, int depth)
+{
+	if (depth > btrfs_max_level)
+	{
+		Server->Log("btrfs tree too deep", LL_ERROR);
+		return false;
+	}
+
+	uint64 chunk_start;
+	const SChunk* chunk = findChunk(bytenr, nodesize, chunk_start);
+	if (chunk == NULL)
+	{
+		Server->Log("btrfs tree block " + convert(bytenr) + " is not in a chunk", LL_ERROR);
+		return false;
+	}
+
+	if (mode == ETreeWalk_Log)
+	{
+		markLogicalUsed(bytenr, nodesize);
+	}
+
+	std::vector<char> buf(static_cast<size_t>(nodesize));
+	bool read_error = false;
+	if (dev->Read(chunk->stripe_offsets[0] + (bytenr - chunk_start), buf.data(), static_cast<_u32>(buf.size()), &read_error) != buf.size()
+		|| read_error)
+	{
+		Server->Log("Error reading btrfs tree block " + convert(bytenr), LL_ERROR);
+		return false;
+	}
+
+	_u32 nritems = btrfs_u32(buf.data(), 0x60);
+	int node_level = static_cast<unsigned char>(buf[0x64]);
+
+	if (btrfs_u64(buf.data(), 0x30) != bytenr
+		|| node_level != level)
+	{
+		Server->Log("btrfs tree block " + convert(bytenr) + " is invalid", LL_ERROR);
+		return false;
+	}
+
+	if (level > 0)
+	{
+		if (btrfs_header_size + nritems*btrfs_key_ptr_size > nodesize)
+		{
+			Server->Log("btrfs tree node " + convert(bytenr) + " has too many items", LL_ERROR);
+			return false;
+		}
+
+		for (_u32 i = 0; i < nritems; ++i)
+		{
+			const char* key_ptr = buf.data() + btrfs_header_size + i*btrfs_key_ptr_size;
+			if (!walkTree(btrfs_u64(key_ptr, btrfs_disk_key_size), level - 1, mode, depth + 1))
+			{
+				return false;
+			}
+
+			if (mode == ETreeWalk_FindRoot
+				&& found_root.bytenr != 0)
+			{
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+	if (btrfs_header_size + nritems*btrfs_item_size > nodesize)
+	{
+		Server->Log("btrfs tree leaf " + convert(bytenr) + " has too many items", LL_ERROR);
+		return false;
+	}
+
+	const char* leaf_data = buf.data() + btrfs_header_size;
+	size_t leaf_data_size = static_cast<size_t>(nodesize) - btrfs_header_size;
+
+	for (_u32 i = 0; i < nritems; ++i)
+	{
+		const char* item = leaf_data + i*btrfs_item_size;
+		_u32 data_offset = btrfs_u32(item, btrfs_disk_key_size);
+		_u32 data_size = btrfs_u32(item, btrfs_disk_key_size + 4);
+
+		if (static_cast<size_t>(data_offset) + data_size > leaf_data_size)
+		{
+			Server->Log("btrfs tree leaf " + convert(bytenr) + " has invalid item", LL_ERROR);
+			return false;
+		}
+
+		if (!handleLeafItem(btrfs_u64(item, 0), static_cast<unsigned char>(item[8]), btrfs_u64(item, 9),
+			leaf_data + data_offset, data_size, mode))
+		{
+			return false;
+		}
+
+		if (mode == ETreeWalk_FindRoot
+			&& found_root.bytenr != 0)
+		{
+			return true;
+		}
+	}
+
+	return true;
+}
+
+bool FSBtrfs::handleLeafItem(uint64 objectid, unsigned char type, uint64 offset, const char* data, size_t data_size, ETreeWalk mode)
+{
+	switch (mode)
+	{
+	case ETreeWalk_Chunk:
+		if (type == btrfs_chunk_item_key)
+		{
+			size_t chunk_size;
+			return addChunk(offset, data, data_size, chunk_size);
+		}
+		return true;
+	case ETreeWalk_FindRoot:
+		if (objectid == find_root_objectid
+			&& type == btrfs_root_item_key
+			&& data_size >= btrfs_root_item_min_size)
+		{
+			found_root.bytenr = btrfs_u64(data, 176);
+			found_root.level = static_cast<unsigned char>(data[238]);
+		}
+		return true;
+	case ETreeWalk_Extent:
+		if (type == btrfs_extent_item_key)
+		{
+			return markLogicalUsed(objectid, offset);
+		}
+		else if (type == btrfs_metadata_item_key)
+		{
+			return markLogicalUsed(objectid, nodesize);
+		}
+		return true;
+	case ETreeWalk_Log:
+		if (type == btrfs_root_item_key
+			&& data_size >= btrfs_root_item_min_size)
+		{
+			return walkTree(btrfs_u64(data, 176), static_cast<unsigned char>(data[238]), ETreeWalk_Log, 0);
+		}
+		else if (type == btrfs_extent_data_key
+			&& data_size >= btrfs_file_extent_min_size
+			&& (static_cast<unsigned char>(data[20]) == btrfs_file_extent_reg
+				|| static_cast<unsigned char>(data[20]) == btrfs_file_extent_prealloc))
+		{
+			uint64 disk_bytenr = btrfs_u64(data, 21);
+			uint64 disk_num_bytes = btrfs_u64(data, 29);
+			if (disk_bytenr != 0)
+			{
+				return markLogicalUsed(disk_bytenr, disk_num_bytes);
+			}
+		}
+		return true;
+	}
+
+	return true;
+}
+
+const FSBtrfs::SChunk* FSBtrfs::findChunk(uint64 logical, uint64 len, uint64& chunk_start)
+{
+	std::map<uint64, SChunk>::const_iterator it = chunks.upper_bound(logical);
+	if (it == chunks.begin())
+	{
+		return NULL;
+	}
+	--it;
+
+	if (logical + len > it->first + it->second.length)
+	{
+		return NULL;
+	}
+
+	chunk_start = it->first;
+	return &it->second;
+}
+
+bool FSBtrfs::markLogicalUsed(uint64 logical, uint64 len)
+{
+	uint64 chunk_start;
+	const SChunk* chunk = findChunk(logical, len, chunk_start);
+	if (chunk == NULL)
+	{
+		Server->Log("btrfs extent " + convert(logical) + " length " + convert(len) + " is not in a chunk", LL_ERROR);
+		return false;
+	}
+
+	//All copies (DUP)
+	for (size_t i = 0; i < chunk->stripe_offsets.size(); ++i)
+	{
+		markUsed(chunk->stripe_offsets[i] + (logical - chunk_start), len);
+	}
+
+	used_bytes += len;
+
+	return true;
+}
+
+void FSBtrfs::markUsed(uint64 offset, uint64 len)
+{
+	if (len == 0)
+		return;
+
+	int64 start = static_cast<int64>(offset / blocksize);
+	int64 end = static_cast<int64>((offset + len + blocksize - 1) / blocksize);
+
+	fs_bitmap_set_range(bitmap, n_blocks, start, end - start, true);
+}
+
+int64 FSBtrfs::getBlocksize(void)
+{
+	return blocksize;
+}
+
+int64 FSBtrfs::getSize(void)
+{
+	return drivesize;
+}
+
+const unsigned char * FSBtrfs::getBitmap(void)
+{
+	return bitmap;
+}
+
+void FSBtrfs::logFileChanges(std::string volpath, int64 min_size, char * fc_bitmap)
+{
+}
+
+std::string FSBtrfs::getType()
+{
+	return "btrfs";
+}
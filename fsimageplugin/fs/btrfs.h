@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../filesystem.h"
+#include <map>
+#include <vector>
+
+class FSBtrfs : public Filesystem
+{
+public:
+	FSBtrfs(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	FSBtrfs(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	~FSBtrfs(void);
+
+	int64 getBlocksize(void);
+	virtual int64 getSize(void);
+	const unsigned char * getBitmap(void);
+
+	virtual void logFileChanges(std::string volpath, int64 min_size, char* fc_bitmap);
+
+	virtual std::string getType();
+
+	//Reads the superblock at 64KiB to check if pDev is a btrfs device
+	static bool isBtrfs(IFile* pDev);
+
+private:
+	struct SChunk
+	{
+		uint64 length;
+		uint64 type;
+		std::vector<uint64> stripe_offsets;
+	};
+
+	enum ETreeWalk
+	{
+		ETreeWalk_Chunk,
+		ETreeWalk_FindRoot,
+		ETreeWalk_Extent,
+		ETreeWalk_Log
+	};
+
+	struct SRootItem
+	{
+		uint64 bytenr;
+		int level;
+	};
+
+	void init();
+	bool addChunk(uint64 logical, const char* data, size_t data_size, size_t& chunk_size);
+	bool walkTree(uint64 bytenr, int level, ETreeWalk mode, int depth);
+	bool handleLeafItem(uint64 objectid, unsigned char type, uint64 offset, const char* data, size_t data_size, ETreeWalk mode);
+	const SChunk* findChunk(uint64 logical, uint64 len, uint64& chunk_start);
+	bool markLogicalUsed(uint64 logical, uint64 len);
+	void markUsed(uint64 offset, uint64 len);
+
+	unsigned char *bitmap;
+	int64 drivesize;
+	int64 blocksize;
+	int64 n_blocks;
+
+	uint64 nodesize;
+	uint64 devid;
+	std::map<uint64, SChunk> chunks;
+
+	uint64 find_root_objectid;
+	SRootItem found_root;
+
+	uint64 used_bytes;
+};
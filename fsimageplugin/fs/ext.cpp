@@ -0,0 +1,459 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "ext.h"
+#include "bitmap_range.h"
+#include "../../Interface/Server.h"
+#include "../../stringtools.h"
+#include <memory.h>
+#include <algorithm>
+
+namespace
+{
+	const int64 ext_superblock_offset = 1024;
+	const unsigned short ext_magic = 0xEF53;
+
+	const _u32 ext_feature_compat_has_journal = 0x4;
+	const _u32 ext_feature_compat_sparse_super2 = 0x200;
+	const _u32 ext_feature_incompat_journal_dev = 0x8;
+	const _u32 ext_feature_incompat_meta_bg = 0x10;
+	const _u32 ext_feature_incompat_extents = 0x40;
+	const _u32 ext_feature_incompat_64bit = 0x80;
+	const _u32 ext_feature_incompat_flex_bg = 0x200;
+	const _u32 ext_feature_ro_compat_sparse_super = 0x1;
+	const _u32 ext_feature_ro_compat_bigalloc = 0x200;
+
+	const unsigned short ext_bg_block_uninit = 0x2;
+
+	//Maximum number of consecutive block bitmaps to read at once
+	const int64 ext_max_bitmap_read = 1024 * 1024;
+
+	_u32 ext_u32(const char* data, size_t off)
+	{
+		_u32 ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return little_endian(ret);
+	}
+
+	unsigned short ext_u16(const char* data, size_t off)
+	{
+		unsigned short ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return little_endian(ret);
+	}
+
+	bool is_power_of(int64 n, int64 base)
+	{
+		while (n > 1 && n%base == 0)
+		{
+			n /= base;
+		}
+		return n == 1;
+	}
+}
+
+FSExt::FSExt(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, read_ahead, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSExt::FSExt(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSExt::~FSExt(void)
+{
+	delete[] bitmap;
+}
+
+bool FSExt::isExt(const char* buffer)
+{
+	return ext_u16(buffer, ext_superblock_offset + 0x38) == ext_magic;
+}
+
+void FSExt::init()
+{
+	if (has_error)
+		return;
+
+	char sb[1024];
+	bool read_error = false;
+	if (dev->Read(ext_superblock_offset, sb, sizeof(sb), &read_error) != sizeof(sb)
+		|| read_error)
+	{
+		Server->Log("Error reading ext superblock", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	if (ext_u16(sb, 0x38) != ext_magic)
+	{
+		Server->Log("ext superblock magic wrong", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	_u32 feature_compat = ext_u32(sb, 0x5C);
+	_u32 feature_incompat = ext_u32(sb, 0x60);
+	_u32 feature_ro_compat = ext_u32(sb, 0x64);
+
+	if (feature_incompat & ext_feature_incompat_journal_dev)
+	{
+		Server->Log("Device is an ext journal device", LL_WARNING);
+		has_error = true;
+		return;
+	}
+
+	if (feature_incompat & (ext_feature_incompat_extents | ext_feature_incompat_64bit | ext_feature_incompat_flex_bg))
+		fstype = "ext4";
+	else if (feature_compat & ext_feature_compat_has_journal)
+		fstype = "ext3";
+	else
+		fstype = "ext2";
+
+	_u32 log_block_size = ext_u32(sb, 0x18);
+	_u32 log_cluster_size = ext_u32(sb, 0x1C);
+	if (log_block_size > 6)
+	{
+		Server->Log("Invalid ext block size", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	blocksize = 1024LL << log_block_size;
+	fs_blocks = ext_u32(sb, 0x04);
+	first_data_block = ext_u32(sb, 0x14);
+	blocks_per_group = ext_u32(sb, 0x20);
+	clusters_per_group = blocks_per_group;
+	cluster_ratio = 1;
+	meta_bg = (feature_incompat & ext_feature_incompat_meta_bg) != 0;
+	sparse_super = (feature_ro_compat & ext_feature_ro_compat_sparse_super) != 0;
+	sparse_super2 = (feature_compat & ext_feature_compat_sparse_super2) != 0;
+	backup_bgs[0] = ext_u32(sb, 0x24C);
+	backup_bgs[1] = ext_u32(sb, 0x250);
+	reserved_gdt_blocks = ext_u16(sb, 0xCE);
+	first_meta_bg = ext_u32(sb, 0x104);
+
+	desc_size = 32;
+	if (feature_incompat & ext_feature_incompat_64bit)
+	{
+		fs_blocks |= static_cast<int64>(ext_u32(sb, 0x150)) << 32;
+		desc_size = ext_u16(sb, 0xFE);
+		if (desc_size < 64 || desc_size > blocksize
+			|| (desc_size & (desc_size - 1)) != 0)
+		{
+			Server->Log("Invalid ext group descriptor size " + convert(desc_size), LL_ERROR);
+			has_error = true;
+			return;
+		}
+	}
+
+	if (feature_ro_compat & ext_feature_ro_compat_bigalloc)
+	{
+		if (log_cluster_size < log_block_size
+			|| log_cluster_size - log_block_size > 16)
+		{
+			Server->Log("Invalid ext cluster size", LL_ERROR);
+			has_error = true;
+			return;
+		}
+
+		cluster_ratio = 1LL << (log_cluster_size - log_block_size);
+		clusters_per_group = ext_u32(sb, 0x24);
+		blocks_per_group = clusters_per_group * cluster_ratio;
+	}
+
+	int64 inodes_per_group = ext_u32(sb, 0x28);
+	int64 inode_size = ext_u32(sb, 0x4C) >= 1 ? ext_u16(sb, 0x58) : 128;
+
+	if (blocks_per_group == 0
+		|| clusters_per_group > blocksize * 8
+		|| fs_blocks <= first_data_block)
+	{
+		Server->Log("Invalid ext block group layout", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	descs_per_block = blocksize / desc_size;
+	n_groups = (fs_blocks - first_data_block + blocks_per_group - 1) / blocks_per_group;
+	inode_table_blocks = (inodes_per_group*inode_size + blocksize - 1) / blocksize;
+
+	drivesize = dev->Size();
+	n_blocks = (drivesize + blocksize - 1) / blocksize;
+
+	if (fs_blocks > n_blocks)
+	{
+		Server->Log("ext file system (" + PrettyPrintBytes(fs_blocks*blocksize) + ") is larger than device (" + PrettyPrintBytes(drivesize) + ")", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	std::vector<SGroupDesc> descs;
+	if (!readGroupDescs(descs))
+	{
+		has_error = true;
+		return;
+	}
+
+	size_t bitmap_bytes = fs_bitmap_bytes(n_blocks);
+	bitmap = new unsigned char[bitmap_bytes];
+	memset(bitmap, 0xFF, bitmap_bytes);
+
+	std::vector<char> bitmap_buf;
+	int64 bitmap_buf_start = -1;
+	int64 bitmap_buf_blocks = 0;
+
+	for (int64 group = 0; group < n_groups; ++group)
+	{
+		const SGroupDesc& desc = descs[static_cast<size_t>(group)];
+
+		if (desc.block_uninit)
+		{
+			//Bitmap is not initialized. Only the group metadata is in use
+			markFree(groupFirstBlock(group), blocks_per_group);
+
+			int64 meta_blocks = 0;
+			if (hasSuper(group))
+			{
+				int64 gdt_blocks = meta_bg ? first_meta_bg : (n_groups + descs_per_block - 1) / descs_per_block;
+				meta_blocks = 1 + gdt_blocks + reserved_gdt_blocks;
+			}
+
+			if (meta_bg)
+			{
+				int64 meta_group_idx = group % descs_per_block;
+				if (group / descs_per_block >= first_meta_bg
+					&& (meta_group_idx == 0 || meta_group_idx == 1 || meta_group_idx == descs_per_block - 1))
+				{
+					meta_blocks += 1;
+				}
+			}
+
+			markUsed(groupSuperBlock(group), meta_blocks);
+		}
+		else
+		{
+			if (desc.block_bitmap < bitmap_buf_start
+				|| desc.block_bitmap >= bitmap_buf_start + bitmap_buf_blocks)
+			{
+				//Read the bitmaps of the following groups as well if they are consecutive (flex_bg)
+				int64 n_consecutive = 1;
+				while (group + n_consecutive < n_groups
+					&& n_consecutive*blocksize < ext_max_bitmap_read
+					&& descs[static_cast<size_t>(group + n_consecutive)].block_bitmap == desc.block_bitmap + n_consecutive)
+				{
+					++n_consecutive;
+				}
+
+				bitmap_buf.resize(static_cast<size_t>(n_consecutive*blocksize));
+				bool read_error = false;
+				if (desc.block_bitmap + n_consecutive > fs_blocks
+					|| dev->Read(desc.block_bitmap*blocksize, bitmap_buf.data(), static_cast<_u32>(bitmap_buf.size()), &read_error) != bitmap_buf.size()
+					|| read_error)
+				{
+					Server->Log("Error reading block bitmap of ext block group " + convert(group), LL_ERROR);
+					has_error = true;
+					return;
+				}
+
+				bitmap_buf_start = desc.block_bitmap;
+				bitmap_buf_blocks = n_consecutive;
+			}
+
+			const unsigned char* group_bitmap = reinterpret_cast<const unsigned char*>(bitmap_buf.data())
+				+ (desc.block_bitmap - bitmap_buf_start)*blocksize;
+
+			int64 group_start = groupFirstBlock(group);
+			for (int64 i = 0; i < clusters_per_group; )
+			{
+				if (i % 8 == 0
+					&& group_bitmap[i / 8] == 0xFF
+					&& i + 8 <= clusters_per_group)
+				{
+					i += 8;
+					continue;
+				}
+
+				if ((group_bitmap[i / 8] & (1 << (i % 8))) == 0)
+				{
+					markFree(group_start + i*cluster_ratio, cluster_ratio);
+				}
+				++i;
+			}
+		}
+
+		markUsed(desc.block_bitmap, 1);
+		markUsed(desc.inode_bitmap, 1);
+		markUsed(desc.inode_table, inode_table_blocks);
+	}
+
+	markUsed(0, first_data_block);
+
+	//Space after the end of the file system
+	markUsed(fs_blocks, n_blocks - fs_blocks);
+}
+
+bool FSExt::readGroupDescs(std::vector<SGroupDesc>& descs)
+{
+	descs.resize(static_cast<size_t>(n_groups));
+
+	int64 desc_blocks = (n_groups + descs_per_block - 1) / descs_per_block;
+	int64 old_desc_blocks = meta_bg ? (std::min)(first_meta_bg, desc_blocks) : desc_blocks;
+
+	std::vector<char> buf;
+	for (int64 desc_block = 0; desc_block < desc_blocks; )
+	{
+		int64 block;
+		int64 n_read = 1;
+		if (desc_block < old_desc_blocks)
+		{
+			block = groupSuperBlock(0) + 1 + desc_block;
+			n_read = old_desc_blocks - desc_block;
+		}
+		else
+		{
+			int64 group = desc_block*descs_per_block;
+			block = groupSuperBlock(group) + (hasSuper(group) ? 1 : 0);
+		}
+
+		buf.resize(static_cast<size_t>(n_read*blocksize));
+		bool read_error = false;
+		if (dev->Read(block*blocksize, buf.data(), static_cast<_u32>(buf.size()), &read_error) != buf.size()
+			|| read_error)
+		{
+			Server->Log("Error reading ext group descriptors at block " + convert(block), LL_ERROR);
+			return false;
+		}
+
+		for (int64 i = 0; i < n_read*descs_per_block; ++i)
+		{
+			int64 group = desc_block*descs_per_block + i;
+			if (group >= n_groups)
+				break;
+
+			if (!readGroupDesc(buf.data() + i*desc_size, descs[static_cast<size_t>(group)]))
+			{
+				Server->Log("Invalid group descriptor of ext block group " + convert(group), LL_ERROR);
+				return false;
+			}
+		}
+
+		desc_block += n_read;
+	}
+
+	return true;
+}
+
+bool FSExt::readGroupDesc(const char* data, SGroupDesc& desc)
+{
+	desc.block_bitmap = ext_u32(data, 0x0);
+	desc.inode_bitmap = ext_u32(data, 0x4);
+	desc.inode_table = ext_u32(data, 0x8);
+	desc.block_uninit = (ext_u16(data, 0x12) & ext_bg_block_uninit) != 0;
+
+	if (desc_size >= 64)
+	{
+		desc.block_bitmap |= static_cast<int64>(ext_u32(data, 0x20)) << 32;
+		desc.inode_bitmap |= static_cast<int64>(ext_u32(data, 0x24)) << 32;
+		desc.inode_table |= static_cast<int64>(ext_u32(data, 0x28)) << 32;
+	}
+
+	return desc.block_bitmap < fs_blocks
+		&& desc.inode_bitmap < fs_blocks
+		&& desc.inode_table < fs_blocks;
+}
+
+bool FSExt::hasSuper(int64 group)
+{
+	if (group == 0)
+		return true;
+
+	if (sparse_super2)
+		return group == backup_bgs[0] || group == backup_bgs[1];
+
+	if (group == 1 || !sparse_super)
+		return true;
+
+	if (group % 2 == 0)
+		return false;
+
+	return is_power_of(group, 3) || is_power_of(group, 5) || is_power_of(group, 7);
+}
+
+int64 FSExt::groupFirstBlock(int64 group)
+{
+	return first_data_block + group*blocks_per_group;
+}
+
+int64 FSExt::groupSuperBlock(int64 group)
+{
+	//With 1024 byte blocks the superblock is always in block 1 (even with bigalloc)
+	if (group == 0 && first_data_block == 0 && blocksize == 1024)
+	{
+		return 1;
+	}
+	return groupFirstBlock(group);
+}
+
+void FSExt::markUsed(int64 block, int64 count)
+{
+	if (count <= 0)
+		return;
+
+	//Allocation unit is the cluster
+	int64 end = block + count;
+	block -= (block - first_data_block) % cluster_ratio;
+	end += (cluster_ratio - (end - first_data_block) % cluster_ratio) % cluster_ratio;
+
+	fs_bitmap_set_range(bitmap, n_blocks, block, end - block, true);
+}
+
+void FSExt::markFree(int64 block, int64 count)
+{
+	fs_bitmap_set_range(bitmap, n_blocks, block, count, false);
+}
+
+int64 FSExt::getBlocksize(void)
+{
+	return blocksize;
+}
+
+int64 FSExt::getSize(void)
+{
+	return drivesize;
+}
+
+const unsigned char * FSExt::getBitmap(void)
+{
+	return bitmap;
+}
+
+void FSExt::logFileChanges(std::string volpath, int64 min_size, char * fc_bitmap)
+{
+}
+
+std::string FSExt::getType()
+{
+	return fstype;
+}
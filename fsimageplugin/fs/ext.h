@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../filesystem.h"
+#include <vector>
+
+class FSExt : public Filesystem
+{
+public:
+	FSExt(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	FSExt(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	~FSExt(void);
+
+	int64 getBlocksize(void);
+	virtual int64 getSize(void);
+	const unsigned char * getBitmap(void);
+
+	virtual void logFileChanges(std::string volpath, int64 min_size, char* fc_bitmap);
+
+	virtual std::string getType();
+
+	//buffer has to contain the first 4096 bytes of the device
+	static bool isExt(const char* buffer);
+
+private:
+	struct SGroupDesc
+	{
+		int64 block_bitmap;
+		int64 inode_bitmap;
+		int64 inode_table;
+		bool block_uninit;
+	};
+
+	void init();
+	bool readGroupDescs(std::vector<SGroupDesc>& descs);
+	bool readGroupDesc(const char* data, SGroupDesc& desc);
+	bool hasSuper(int64 group);
+	int64 groupFirstBlock(int64 group);
+	int64 groupSuperBlock(int64 group);
+	void markUsed(int64 block, int64 count);
+	void markFree(int64 block, int64 count);
+
+	unsigned char *bitmap;
+	int64 drivesize;
+	int64 blocksize;
+	int64 n_blocks;
+	std::string fstype;
+
+	int64 fs_blocks;
+	int64 first_data_block;
+	int64 blocks_per_group;
+	int64 clusters_per_group;
+	int64 cluster_ratio;
+	int64 n_groups;
+	int64 desc_size;
+	int64 descs_per_block;
+	int64 reserved_gdt_blocks;
+	int64 first_meta_bg;
+	int64 inode_table_blocks;
+	bool meta_bg;
+	bool sparse_super;
+	bool sparse_super2;
+	_u32 backup_bgs[2];
+};
@@ -0,0 +1,291 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "xfs.h"
+#include "bitmap_range.h"
+#include "../../Interface/Server.h"
+#include "../../stringtools.h"
+#include <memory.h>
+#include <vector>
+
+namespace
+{
+	const _u32 xfs_sb_magic = 0x58465342; //XFSB
+	const _u32 xfs_agf_magic = 0x58414746; //XAGF
+	const _u32 xfs_abtb_magic = 0x41425442; //ABTB
+	const _u32 xfs_abtb_crc_magic = 0x41423342; //AB3B
+	const unsigned short xfs_sb_version_5 = 5;
+	const _u32 xfs_null_agblock = 0xFFFFFFFF;
+
+	const size_t xfs_btree_sblock_len = 16;
+	const size_t xfs_btree_sblock_crc_len = 56;
+	const size_t xfs_alloc_rec_len = 8;
+	const size_t xfs_alloc_ptr_len = 4;
+
+	//Maximum btree depth (XFS_BTREE_MAXLEVELS)
+	const unsigned short xfs_btree_max_levels = 9;
+
+	_u32 xfs_u32(const char* data, size_t off)
+	{
+		_u32 ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return big_endian(ret);
+	}
+
+	unsigned short xfs_u16(const char* data, size_t off)
+	{
+		unsigned short ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return big_endian(ret);
+	}
+
+	uint64 xfs_u64(const char* data, size_t off)
+	{
+		uint64 ret;
+		memcpy(&ret, data + off, sizeof(ret));
+		return big_endian(ret);
+	}
+}
+
+FSXfs::FSXfs(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, read_ahead, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSXfs::FSXfs(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback)
+	: Filesystem(pDev, next_block_callback), bitmap(NULL)
+{
+	init();
+	initReadahead(read_ahead, background_priority);
+}
+
+FSXfs::~FSXfs(void)
+{
+	delete[] bitmap;
+}
+
+bool FSXfs::isXfs(const char* buffer)
+{
+	return xfs_u32(buffer, 0) == xfs_sb_magic;
+}
+
+void FSXfs::init()
+{
+	if (has_error)
+		return;
+
+	char sb[512];
+	bool read_error = false;
+	if (dev->Read(0, sb, sizeof(sb), &read_error) != sizeof(sb)
+		|| read_error)
+	{
+		Server->Log("Error reading XFS superblock", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	if (xfs_u32(sb, 0) != xfs_sb_magic)
+	{
+		Server->Log("XFS superblock magic wrong", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	if (sb[126] != 0)
+	{
+		Server->Log("XFS file system creation is in progress", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	blocksize = xfs_u32(sb, 4);
+	fs_blocks = static_cast<int64>(xfs_u64(sb, 8));
+	agblocks = xfs_u32(sb, 84);
+	agcount = xfs_u32(sb, 88);
+	sectsize = xfs_u16(sb, 102);
+	crc = (xfs_u16(sb, 100) & 0xF) == xfs_sb_version_5;
+
+	if (blocksize < 512 || blocksize > 65536
+		|| (blocksize & (blocksize - 1)) != 0
+		|| sectsize < 512 || sectsize > blocksize
+		|| agblocks == 0 || agcount == 0
+		|| static_cast<int64>(agcount)*agblocks < fs_blocks)
+	{
+		Server->Log("Invalid XFS superblock geometry", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	drivesize = dev->Size();
+	n_blocks = (drivesize + blocksize - 1) / blocksize;
+
+	if (fs_blocks > n_blocks)
+	{
+		Server->Log("XFS file system (" + PrettyPrintBytes(fs_blocks*blocksize) + ") is larger than device (" + PrettyPrintBytes(drivesize) + ")", LL_ERROR);
+		has_error = true;
+		return;
+	}
+
+	size_t bitmap_bytes = fs_bitmap_bytes(n_blocks);
+	bitmap = new unsigned char[bitmap_bytes];
+	memset(bitmap, 0xFF, bitmap_bytes);
+
+	//Everything not in the by-block free space btrees (including the AG
+	//free lists, the internal log and space after the file system) is used
+	for (_u32 agno = 0; agno < agcount; ++agno)
+	{
+		if (!readFreeSpace(agno))
+		{
+			has_error = true;
+			return;
+		}
+	}
+}
+
+bool FSXfs::readFreeSpace(_u32 agno)
+{
+	int64 ag_start = static_cast<int64>(agno)*agblocks;
+
+	char agf[512];
+	bool read_error = false;
+	if (dev->Read(ag_start*blocksize + sectsize, agf, sizeof(agf), &read_error) != sizeof(agf)
+		|| read_error)
+	{
+		Server->Log("Error reading AGF of XFS allocation group " + convert(agno), LL_ERROR);
+		return false;
+	}
+
+	if (xfs_u32(agf, 0) != xfs_agf_magic
+		|| xfs_u32(agf, 8) != agno)
+	{
+		Server->Log("AGF of XFS allocation group " + convert(agno) + " is invalid", LL_ERROR);
+		return false;
+	}
+
+	int64 ag_length = xfs_u32(agf, 12);
+	_u32 bno_root = xfs_u32(agf, 16);
+
+	if (ag_length > agblocks
+		|| ag_start + ag_length > fs_blocks)
+	{
+		Server->Log("AGF of XFS allocation group " + convert(agno) + " has invalid length", LL_ERROR);
+		return false;
+	}
+
+	size_t hdr_len = crc ? xfs_btree_sblock_crc_len : xfs_btree_sblock_len;
+	_u32 expected_magic = crc ? xfs_abtb_crc_magic : xfs_abtb_magic;
+	size_t node_maxrecs = (static_cast<size_t>(blocksize) - hdr_len) / (xfs_alloc_rec_len + xfs_alloc_ptr_len);
+	size_t leaf_maxrecs = (static_cast<size_t>(blocksize) - hdr_len) / xfs_alloc_rec_len;
+
+	std::vector<char> buf(static_cast<size_t>(blocksize));
+
+	_u32 curr = bno_root;
+	int64 n_read = 0;
+	int64 n_free = 0;
+	bool in_leaves = false;
+	unsigned short expected_level = 0;
+
+	while (curr != xfs_null_agblock)
+	{
+		if (curr >= ag_length
+			|| ++n_read > ag_length)
+		{
+			Server->Log("Invalid free space btree block " + convert(curr) + " in XFS allocation group " + convert(agno), LL_ERROR);
+			return false;
+		}
+
+		if (dev->Read((ag_start + curr)*blocksize, buf.data(), static_cast<_u32>(buf.size()), &read_error) != buf.size()
+			|| read_error)
+		{
+			Server->Log("Error reading free space btree block " + convert(curr) + " of XFS allocation group " + convert(agno), LL_ERROR);
+			return false;
+		}
+
+		unsigned short level = xfs_u16(buf.data(), 4);
+		size_t numrecs = xfs_u16(buf.data(), 6);
+
+		if (xfs_u32(buf.data(), 0) != expected_magic
+			|| level >= xfs_btree_max_levels
+			|| (level > 0 && (in_leaves || numrecs == 0 || numrecs > node_maxrecs))
+			|| (level == 0 && numrecs > leaf_maxrecs)
+			|| (n_read > 1 && !in_leaves && level + 1 != expected_level))
+		{
+			Server->Log("Free space btree block " + convert(curr) + " of XFS allocation group " + convert(agno) + " is invalid", LL_ERROR);
+			return false;
+		}
+
+		if (level > 0)
+		{
+			//Descend to the leftmost leaf
+			expected_level = level;
+			curr = xfs_u32(buf.data(), hdr_len + node_maxrecs*xfs_alloc_rec_len);
+			continue;
+		}
+
+		in_leaves = true;
+
+		for (size_t i = 0; i < numrecs; ++i)
+		{
+			const char* rec = buf.data() + hdr_len + i*xfs_alloc_rec_len;
+			int64 startblock = xfs_u32(rec, 0);
+			int64 blockcount = xfs_u32(rec, 4);
+
+			if (startblock + blockcount > ag_length)
+			{
+				Server->Log("Invalid free extent in XFS allocation group " + convert(agno), LL_ERROR);
+				return false;
+			}
+
+			fs_bitmap_set_range(bitmap, n_blocks, ag_start + startblock, blockcount, false);
+			n_free += blockcount;
+		}
+
+		//Follow the leaves from left to right
+		curr = xfs_u32(buf.data(), 12);
+	}
+
+	Server->Log("XFS allocation group " + convert(agno) + ": " + PrettyPrintBytes(n_free*blocksize) + " free", LL_DEBUG);
+
+	return true;
+}
+
+int64 FSXfs::getBlocksize(void)
+{
+	return blocksize;
+}
+
+int64 FSXfs::getSize(void)
+{
+	return drivesize;
+}
+
+const unsigned char * FSXfs::getBitmap(void)
+{
+	return bitmap;
+}
+
+void FSXfs::logFileChanges(std::string volpath, int64 min_size, char * fc_bitmap)
+{
+}
+
+std::string FSXfs::getType()
+{
+	return "xfs";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../filesystem.h"
+
+class FSXfs : public Filesystem
+{
+public:
+	FSXfs(const std::string &pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	FSXfs(IFile *pDev, IFSImageFactory::EReadaheadMode read_ahead, bool background_priority, IFsNextBlockCallback* next_block_callback);
+	~FSXfs(void);
+
+	int64 getBlocksize(void);
+	virtual int64 getSize(void);
+	const unsigned char * getBitmap(void);
+
+	virtual void logFileChanges(std::string volpath, int64 min_size, char* fc_bitmap);
+
+	virtual std::string getType();
+
+	//buffer has to contain the first 4096 bytes of the device
+	static bool isXfs(const char* buffer);
+
+private:
+	void init();
+	bool readFreeSpace(_u32 agno);
+
+	unsigned char *bitmap;
+	int64 drivesize;
+	int64 blocksize;
+	int64 n_blocks;
+
+	int64 fs_blocks;
+	int64 agblocks;
+	_u32 agcount;
+	int64 sectsize;
+	bool crc;
+};
@@ -45,11 +45,9 @@ const unsigned int sector_size=512;
 
 namespace
 {
-	size_t getNumCompThreads(bool read_only)
+	//Used for compression when writing and for read-ahead decompression when reading
+	size_t getNumCompThreads()
 	{
-		if (read_only)
-			return 1;
-
 		const size_t maxCpus = 5;
 #ifdef _WIN32
 		SYSTEM_INFO system_info;
@@ -104,7 +102,7 @@ VHDFile::VHDFile(const std::string &fn, bool pRead_only, uint64 pDstsize, unsign
 
 	if(check_if_compressed() || compress)
 	{
-		compressed_file = new CompressedFile(backing_file, openedExisting, read_only, compress_n_threads==0 ? getNumCompThreads(pRead_only): compress_n_threads);
+		compressed_file = new CompressedFile(backing_file, openedExisting, read_only, compress_n_threads==0 ? getNumCompThreads(): compress_n_threads);
 		file = compressed_file;
 
 		if(compressed_file->hasError())
@@ -197,7 +195,7 @@ VHDFile::VHDFile(const std::string &fn, const std::string &parent_fn, bool pRead
 
 	if(check_if_compressed() || compress)
 	{
-		file = new CompressedFile(backing_file, openedExisting, read_only, compress_n_threads==0 ? getNumCompThreads(pRead_only) : compress_n_threads);
+		file = new CompressedFile(backing_file, openedExisting, read_only, compress_n_threads==0 ? getNumCompThreads() : compress_n_threads);
 	}
 	else
 	{
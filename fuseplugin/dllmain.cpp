@@ -165,7 +165,14 @@ DLLEXPORT void LoadActions(IServer* pServer)
 		exit(2);
 	}
 	
-	vhdfile = image_fak->createVHDFile(vhd_filename, true, 0);
+	if (strlower(findextension(vhd_filename)) == "dedup")
+	{
+		vhdfile = image_fak->createVHDFile(vhd_filename, true, 0, 2 * 1024 * 1024, false, IFSImageFactory::ImageFormat_Dedup);
+	}
+	else
+	{
+		vhdfile = image_fak->createVHDFile(vhd_filename, true, 0);
+	}
 	
 	if(vhdfile==NULL || !vhdfile->isOpen())
 	{
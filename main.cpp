@@ -223,6 +223,7 @@ int main_fkt(int argc, char *argv[])
 	std::string daemon_user;
 	std::string pidfile;
 	bool log_console_no_time=false;
+	bool log_async=false;
 
 	for(int i=1;i<argc;++i)
 	{
@@ -308,6 +309,10 @@ int main_fkt(int argc, char *argv[])
 		{
 			log_console_no_time = true;
 		}
+		else if( carg=="--log_async")
+		{
+			log_async = true;
+		}
 		else
 		{
 			if( carg.size()>1 && carg[0]=='-' )
@@ -468,6 +473,11 @@ int main_fkt(int argc, char *argv[])
 		Server->setLogConsoleTime(false);
 	}
 
+	if(log_async)
+	{
+		Server->setLogAsync(256*1024, 100);
+	}
+
 	if(is_big_endian())
 	{
 		Server->setLogLevel(LL_DEBUG);
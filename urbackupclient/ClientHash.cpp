@@ -8,6 +8,7 @@
 #include "../fileservplugin/chunk_settings.h"
 #include "../stringtools.h"
 #include "../common/adler32.h"
+#include "../common/buf_is_zero.h"
 #include "../md5.h"
 #include "../urbackupcommon/TreeHash.h"
 
@@ -15,19 +16,6 @@
 
 namespace
 {
-	bool buf_is_zero(const char* buf, size_t bsize)
-	{
-		for (size_t i = 0; i < bsize; ++i)
-		{
-			if (buf[i] != 0)
-			{
-				return false;
-			}
-		}
-
-		return true;
-	}
-
 	std::string build_sparse_extent_content()
 	{
 		char buf[c_small_hash_dist] = {};
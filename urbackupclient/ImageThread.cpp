@@ -24,6 +24,7 @@
 #include "../fsimageplugin/IFilesystem.h"
 
 #include "../common/data.h"
+#include "../common/buf_is_zero.h"
 #include "../urbackupcommon/sha2/sha2.h"
 #include "../urbackupcommon/os_functions.h"
 
@@ -46,18 +47,6 @@ namespace
 
 	const unsigned char ImageFlag_Persistent=1;
 	const unsigned char ImageFlag_Bitmap=2;
-
-	bool buf_is_zero(unsigned char* buf, size_t buf_size)
-	{
-		for (size_t i = 0; i < buf_size; ++i)
-		{
-			if (buf[i] != 0)
-			{
-				return false;
-			}
-		}
-		return true;
-	}
 }
 
 
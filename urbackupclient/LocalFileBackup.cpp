@@ -59,7 +59,7 @@ _i64 LocalFileBackup::getIncrementalSize(IFile* f, const std::vector<size_t>& di
 	{
 		for (size_t i = 0; i < read; ++i)
 		{
-			bool b = list_parser.nextEntry(buffer[i], cf, nullptr);
+			bool b = list_parser.nextEntry(buffer, read, i, cf, nullptr);
 			if (b)
 			{
 				if (cf.isdir == true)
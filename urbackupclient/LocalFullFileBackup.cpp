@@ -170,7 +170,7 @@ bool LocalFullFileBackup::run()
 		for (size_t i = 0; i < read; ++i)
 		{
 			std::map<std::string, std::string> extra_params;
-			bool b = list_parser.nextEntry(buffer[i], cf, &extra_params);
+			bool b = list_parser.nextEntry(buffer, read, i, cf, &extra_params);
 			if (b)
 			{
 				FileMetadata metadata;
@@ -241,7 +241,7 @@ bool LocalIncrFileBackup::run()
 		for (size_t i = 0; i < read; ++i)
 		{
 			std::map<std::string, std::string> extra_params;
-			bool b = list_parser.nextEntry(buffer[i], cf, &extra_params);
+			bool b = list_parser.nextEntry(buffer.data(), read, i, cf, &extra_params);
 			if (b)
 			{
 				std::string osspecific_name;
@@ -922,7 +922,7 @@ bool LocalIncrFileBackup::deleteFilesInSnapshot(IFile* curr_file_list, const std
 	{
 		for (size_t i = 0; i < read; ++i)
 		{
-			if (list_parser.nextEntry(buffer[i], curr_file, nullptr))
+			if (list_parser.nextEntry(buffer.data(), read, i, curr_file, nullptr))
 			{
 				if (curr_file.isdir && curr_file.name == "..")
 				{
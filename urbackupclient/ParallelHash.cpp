@@ -15,16 +15,24 @@ namespace
 	const size_t max_modify_file_buffer_size = 2 * 1024 * 1024;
 	const int64 file_buffer_commit_interval = 120 * 1000;
 	const int64 link_file_min_size = 2048;
+
+	bool getHashFileId(const std::string& msg, int64& file_id)
+	{
+		CRData data(msg.data(), msg.size());
+		char id;
+		return data.getChar(&id)
+			&& id == ID_HASH_FILE
+			&& data.getVarInt(&file_id);
+	}
 }
 
 ParallelHash::ParallelHash(SQueueRef* phash_queue, int sha_version, size_t extra_n_threads)
-	: do_quit(false), phash_queue(phash_queue), phash_queue_pos(0),
-	stdout_buf_size(0), stdout_buf_pos(0), mutex(Server->createMutex()),
-	last_file_buffer_commit_time(0), sha_version(sha_version), eof(false),
-	extra_n_threads(extra_n_threads), extra_thread(false),
-	extra_mutex(Server->createMutex()), extra_cond(Server->createCondition()),
-	modify_file_buffer_mutex(Server->createMutex()), do_quit_extra(false),
-	has_read(false)
+	: out_of_order(false), last_read_file_id(-1), stdout_buf_pos(0), stdout_buf_size(0),
+	do_quit_extra(false), do_quit(false), eof(false), has_read(false),
+	phash_queue_pos(0), phash_queue(phash_queue), mutex(Server->createMutex()),
+	hash_params_gen(0), sha_version(sha_version), modify_file_buffer_mutex(Server->createMutex()),
+	last_file_buffer_commit_time(0), extra_n_threads(extra_n_threads), extra_thread(false),
+	extra_mutex(Server->createMutex()), extra_cond(Server->createCondition())
 {
 	stdout_buf.resize(4090);
 	ticket = Server->getThreadPool()->execute(this, extra_n_threads>0 ? "phash master": "phash");
@@ -89,6 +97,44 @@ void ParallelHash::finishStdout()
 {
 }
 
+void ParallelHash::prioritize(const std::vector<int64>& file_ids)
+{
+	IScopedLock lock(extra_mutex.get());
+
+	if (extra_n_threads == 0)
+	{
+		//Files are hashed in queue order anyway
+		return;
+	}
+
+	out_of_order = true;
+
+	for (size_t i = 0; i < file_ids.size(); ++i)
+	{
+		bool found = false;
+		for (std::deque<std::pair<int64, std::string> >::iterator it = extra_queue.begin();
+			it != extra_queue.end(); ++it)
+		{
+			int64 file_id;
+			if (getHashFileId(it->second, file_id)
+				&& file_id == file_ids[i])
+			{
+				std::pair<int64, std::string> msg = *it;
+				extra_queue.erase(it);
+				extra_queue.push_front(msg);
+				found = true;
+				break;
+			}
+		}
+
+		if (!found
+			&& file_ids[i] > last_read_file_id)
+		{
+			prio_file_ids.insert(file_ids[i]);
+		}
+	}
+}
+
 bool ParallelHash::readStderrIntoBuffer(char * buf, size_t buf_avail, size_t & read_bytes)
 {
 	while (!do_quit
@@ -148,20 +194,67 @@ void ParallelHash::operator()()
 					int64 working_file_id = phash_queue_pos;
 					phash_queue_pos += sizeof(_u32) + msg_size;
 
+					int64 file_id;
+					bool is_hash_file = getHashFileId(msg, file_id);
+
 					IScopedLock lock(extra_mutex.get());
-					working_file_ids.insert(working_file_id);	
 
-					if (extra_n_threads > 0)
+					if (is_hash_file)
 					{
-						extra_queue.push_back(std::make_pair(working_file_id, msg));
+						last_read_file_id = file_id;
+					}
+
+					if (extra_n_threads > 0
+						&& !is_hash_file)
+					{
+						//Directory and hash setup has to be done before
+						//the worker threads hash files of the directory
+						//and the finish message after all files are hashed.
+						//Replacing client_hash (once per backup dir) also has
+						//to wait until the workers are done with the old one
+						if (!msg.empty()
+							&& (msg[0] == ID_PHASH_FINISH
+								|| msg[0] == ID_INIT_HASH
+								|| msg[0] == ID_CBT_DATA))
+						{
+							while (!extra_queue.empty()
+								|| !working_file_ids.empty())
+							{
+								lock.relock(nullptr);
+								Server->wait(100);
+								lock.relock(extra_mutex.get());
+							}
+						}
+
+						lock.relock(nullptr);
+
+						CRData data(msg.data(), msg.size());
+						hashFile(working_file_id, data, clientdao, client_hash.get());
+					}
+					else if (extra_n_threads > 0)
+					{
+						working_file_ids.insert(working_file_id);
+
+						std::set<int64>::iterator it_prio = prio_file_ids.find(file_id);
+						if (it_prio != prio_file_ids.end())
+						{
+							prio_file_ids.erase(it_prio);
+							extra_queue.push_front(std::make_pair(working_file_id, msg));
+						}
+						else
+						{
+							extra_queue.push_back(std::make_pair(working_file_id, msg));
+						}
 						extra_cond->notify_one();
 					}
 					else
 					{
+						working_file_ids.insert(working_file_id);
+
 						lock.relock(nullptr);
 
 						CRData data(msg.data(), msg.size());
-						hashFile(working_file_id, data, clientdao);
+						hashFile(working_file_id, data, clientdao, client_hash.get());
 
 						lock.relock(extra_mutex.get());
 						working_file_ids.erase(working_file_id);
@@ -214,16 +307,18 @@ void ParallelHash::operator()()
 
 void ParallelHash::addQueuedStdoutMsgs()
 {
-	std::map<int64, CWData>::iterator it_msg;
-	while (!working_file_ids.empty() &&
-		(it_msg = stdout_msg_buf.find(*working_file_ids.begin())) != stdout_msg_buf.end())
+	while (!stdout_msg_buf.empty()
+		&& (out_of_order
+			|| working_file_ids.empty()
+			|| stdout_msg_buf.begin()->first < *working_file_ids.begin()))
 	{
+		std::map<int64, CWData>::iterator it_msg = stdout_msg_buf.begin();
 		addToStdoutBuf(it_msg->second.getDataPtr(), it_msg->second.getDataSize());
 		stdout_msg_buf.erase(it_msg);
 	}
 }
 
-bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& clientdao)
+bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& clientdao, ClientHash* curr_client_hash)
 {
 	char id;
 	if (!data.getChar(&id))
@@ -279,6 +374,10 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 	else if (id == ID_INIT_HASH)
 	{
 		client_hash.reset(new ClientHash(nullptr, false, 0, nullptr, 0));
+
+		IScopedLock lock(extra_mutex.get());
+		hash_params = SHashParams();
+		++hash_params_gen;
 		return true;
 	}
 	else if (id == ID_CBT_DATA)
@@ -297,10 +396,19 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 
 		client_hash.reset(new ClientHash(index_hdat_file, true, index_hdat_fs_block_size,
 			snapshot_sequence_id, static_cast<size_t>(snapshot_sequence_id_reference)));
+
+		IScopedLock lock(extra_mutex.get());
+		hash_params.index_hdat_file = index_hdat_file;
+		hash_params.index_hdat_fs_block_size = index_hdat_fs_block_size;
+		hash_params.snapshot_sequence_id = snapshot_sequence_id;
+		hash_params.snapshot_sequence_id_reference = static_cast<size_t>(snapshot_sequence_id_reference);
+		++hash_params_gen;
 		return true;
 	}
 	else if (id == ID_PHASH_FINISH)
 	{
+		IScopedLock lock(extra_mutex.get());
+		prio_file_ids.clear();
 		eof = true;
 		return true;
 	}
@@ -354,7 +462,7 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 		f.reset();
 
 		HashSha256 hash_256;
-		if (!client_hash->getShaBinary(full_path, hash_256, false))
+		if (!curr_client_hash->getShaBinary(full_path, hash_256, false))
 		{
 			Server->Log("Error hashing file (0) " + full_path + ". " + os_last_error_str(), LL_DEBUG);
 		}
@@ -368,8 +476,8 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 	{
 		f.reset();
 
-		TreeHash treehash(client_hash->hasCbtFile() ? client_hash.get() : nullptr);
-		if (!client_hash->getShaBinary(full_path, treehash, client_hash->hasCbtFile()))
+		TreeHash treehash(curr_client_hash->hasCbtFile() ? curr_client_hash : nullptr);
+		if (!curr_client_hash->getShaBinary(full_path, treehash, curr_client_hash->hasCbtFile()))
 		{
 			Server->Log("Error hashing file (1) " + full_path+". "+os_last_error_str(), LL_DEBUG);
 		}
@@ -379,8 +487,8 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 		}
 
 #ifdef HASH_CBT_CHECK
-		TreeHash treehash2(client_hash->hasCbtFile() ? client_hash.get() : NULL);
-		client_hash->getShaBinary(full_path, treehash2, false);
+		TreeHash treehash2(curr_client_hash->hasCbtFile() ? curr_client_hash : NULL);
+		curr_client_hash->getShaBinary(full_path, treehash2, false);
 		
 		std::string other_hash = treehash2.finalize();
 		if (other_hash != fandhash.hash)
@@ -396,7 +504,7 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 		f.reset();
 
 		HashSha512 hash_512;
-		if (!client_hash->getShaBinary(full_path, hash_512, false))
+		if (!curr_client_hash->getShaBinary(full_path, hash_512, false))
 		{
 			Server->Log("Error hashing file (2) " + full_path + ". " + os_last_error_str(), LL_DEBUG);
 		}
@@ -435,8 +543,9 @@ bool ParallelHash::hashFile(int64 working_file_id, CRData & data, ClientDAO& cli
 	Server->Log("Parallel hash \"" + full_path + "\" id=" + convert(file_id) + " hash=" + base64_encode_dash(fandhash.hash)+ ph_action, LL_DEBUG);
 
 	{
-		IScopedLock lock(mutex.get());
-		if (!working_file_ids.empty()
+		IScopedLock lock(extra_mutex.get());
+		if (!out_of_order
+			&& !working_file_ids.empty()
 			&& *working_file_ids.begin() != working_file_id)
 		{
 			stdout_msg_buf[working_file_id] = wdata;
@@ -555,6 +664,11 @@ size_t ParallelHash::calcBufferSize(const std::string &path, const std::vector<S
 
 void ParallelHash::runExtraThread()
 {
+	ClientDAO clientdao(Server->getDatabase(Server->getThreadID(), URBACKUPDB_CLIENT));
+
+	std::unique_ptr<ClientHash> worker_hash;
+	size_t worker_hash_gen = 0;
+
 	IScopedLock lock(extra_mutex.get());
 	while (!do_quit_extra)
 	{
@@ -570,8 +684,24 @@ void ParallelHash::runExtraThread()
 		std::pair<int64, std::string> msg = extra_queue.front();
 		extra_queue.pop_front();
 
+		bool new_hash_params = worker_hash.get() == nullptr
+			|| worker_hash_gen != hash_params_gen;
+		SHashParams curr_hash_params = hash_params;
+		worker_hash_gen = hash_params_gen;
+
 		lock.relock(nullptr);
 
+		if (new_hash_params)
+		{
+			//The master only replaces the parameters once all queued files
+			//are hashed, so the hdat file is still open here
+			worker_hash.reset(new ClientHash(curr_hash_params.index_hdat_file, false,
+				curr_hash_params.index_hdat_fs_block_size, curr_hash_params.snapshot_sequence_id,
+				curr_hash_params.snapshot_sequence_id_reference));
+		}
+
+		CRData data(msg.second.data(), msg.second.size());
+		hashFile(msg.first, data, clientdao, worker_hash.get());
 
 		lock.relock(extra_mutex.get());
 		working_file_ids.erase(msg.first);
@@ -33,6 +33,7 @@ public:
 	virtual bool readStdoutIntoBuffer(char * buf, size_t buf_avail, size_t & read_bytes);
 	virtual void finishStdout();
 	virtual bool readStderrIntoBuffer(char * buf, size_t buf_avail, size_t & read_bytes);
+	virtual void prioritize(const std::vector<int64>& file_ids);
 
 	void operator()();
 
@@ -50,7 +51,7 @@ private:
 		bool finish;
 	};
 
-	bool hashFile(int64 working_file_id, CRData& data, ClientDAO& clientdao);
+	bool hashFile(int64 working_file_id, CRData& data, ClientDAO& clientdao, ClientHash* curr_client_hash);
 	bool finishDir(ParallelHash::SCurrDir* dir, ClientDAO& clientdao, const int64& target_generation, int64& id);
 	bool addToStdoutBuf(const char* ptr, size_t size);
 	void addModifyFileBuffer(ClientDAO& clientdao, const std::string& path, int tgroup, const std::vector<SFileAndHash>& files, int64 target_generation, bool insert);
@@ -60,6 +61,11 @@ private:
 
 	std::map<int64, CWData> stdout_msg_buf;
 	std::set<int64> working_file_ids;
+	//Set once the server asked for specific files. The server then
+	//indexes the hashes and they do not need to be sent in order
+	bool out_of_order;
+	std::set<int64> prio_file_ids;
+	int64 last_read_file_id;
 
 	std::vector<char> stdout_buf;
 	size_t stdout_buf_pos;
@@ -77,6 +83,24 @@ private:
 	std::deque<std::string> postponed_finish;
 	
 	std::unique_ptr<ClientHash> client_hash;
+
+	//Parameters of the last ID_INIT_HASH/ID_CBT_DATA message.
+	//ClientHash is not thread-safe, so each worker thread builds
+	//its own (not owning the hdat file) from those
+	struct SHashParams
+	{
+		SHashParams()
+			: index_hdat_file(nullptr), index_hdat_fs_block_size(0),
+			snapshot_sequence_id(nullptr), snapshot_sequence_id_reference(0)
+		{}
+
+		IFile* index_hdat_file;
+		int64 index_hdat_fs_block_size;
+		size_t* snapshot_sequence_id;
+		size_t snapshot_sequence_id_reference;
+	};
+	SHashParams hash_params;
+	size_t hash_params_gen;
 	int sha_version;
 	THREADPOOL_TICKET ticket;
 	std::vector<THREADPOOL_TICKET> extra_tickets;
@@ -552,9 +552,9 @@ int64 RestoreFiles::calculateDownloadSize()
 	{
 		read = filelist->Read(buffer.data(), static_cast<_u32>(buffer.size()));
 
-		for(_u32 i=0;i<read;++i)
+		for(size_t i=0;i<read;++i)
 		{
-			if(filelist_parser.nextEntry(buffer[i], data, &extra))
+			if(filelist_parser.nextEntry(buffer.data(), read, i, data, &extra))
 			{
 				if(data.size>0)
 				{
@@ -602,9 +602,9 @@ bool RestoreFiles::openFiles(std::map<std::string, IFsFile*>& open_files, bool&
 	{
 		read = filelist->Read(buffer.data(), static_cast<_u32>(buffer.size()));
 
-		for (_u32 i = 0; i<read && !has_error; ++i)
+		for (size_t i = 0; i<read && !has_error; ++i)
 		{
-			if (filelist_parser.nextEntry(buffer[i], data, &extra))
+			if (filelist_parser.nextEntry(buffer.data(), read, i, data, &extra))
 			{
 				if (skip_dir != std::string::npos
 					&& data.isdir)
@@ -1023,9 +1023,9 @@ bool RestoreFiles::downloadFiles(FileClient& fc, int64 total_size, ScopedRestore
 	{
 		read = filelist->Read(buffer.data(), static_cast<_u32>(buffer.size()));
 
-		for(_u32 i=0;i<read && !has_error;++i)
+		for(size_t i=0;i<read && !has_error;++i)
 		{
-			if(filelist_parser.nextEntry(buffer[i], data, &extra))
+			if(filelist_parser.nextEntry(buffer.data(), read, i, data, &extra))
 			{
 				if (skip_dir != std::string::npos
 					&& data.isdir)
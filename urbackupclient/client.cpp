@@ -45,6 +45,7 @@
 #include "../fileservplugin/chunk_settings.h"
 #include "ImageThread.h"
 #include "../common/adler32.h"
+#include "../common/buf_is_zero.h"
 #include <string.h>
 
 #ifdef __APPLE__
@@ -6101,7 +6102,12 @@ bool IndexThread::nextLastFilelistItem(SFile& data, str_map* extra, bool with_up
 		}
 		else
 		{
-			if (last_filelist->parser.nextEntry(last_filelist->buf[last_filelist->buf_pos++], data, extra))
+			size_t entry_end = last_filelist->buf_pos;
+			bool has_entry = last_filelist->parser.nextEntry(last_filelist->buf.data(),
+				last_filelist->buf.size(), entry_end, data, extra);
+			last_filelist->buf_pos = entry_end + 1;
+
+			if (has_entry)
 			{
 				handleLastFilelistDepth(data);
 				last_filelist->item_pos = last_filelist->read_pos + last_filelist->buf_pos;
@@ -6763,7 +6769,7 @@ bool  IndexThread::punchHoleOrZero(IFile* f, int64 pos, const char* zero_buf, ch
 	if (!f->PunchHole(pos, zero_size))
 	{
 		bool data_differs = (f->Read(pos, zero_read_buf, static_cast<_u32>(zero_size)) != zero_size
-			|| memcmp(zero_read_buf, zero_buf, static_cast<_u32>(zero_size)) != 0);
+			|| !buf_is_zero(zero_read_buf, zero_size));
 
 		if (data_differs &&
 			f->Write(pos, zero_buf, static_cast<_u32>(zero_size)) != zero_size)
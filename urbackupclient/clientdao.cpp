@@ -18,6 +18,7 @@
 
 #include "clientdao.h"
 #include "../stringtools.h"
+#include "../Interface/DatabaseCursor.h"
 #include "../Interface/Server.h"
 #include <memory.h>
 
@@ -708,16 +709,25 @@ std::vector<ClientDAO::SToken> ClientDAO::getFileAccessTokens(void)
 	{
 		q_getFileAccessTokens=db->Prepare("SELECT id, accountname, token, is_user FROM fileaccess_tokens", false);
 	}
-	db_results res=q_getFileAccessTokens->Read();
+	IDatabaseCursor* cur=q_getFileAccessTokens->Cursor();
 	std::vector<ClientDAO::SToken> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	int c_accountname=cur->columnIndex("accountname");
+	int c_token=cur->columnIndex("token");
+	int c_is_user=cur->columnIndex("is_user");
+	while(cur->next())
 	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].accountname=res[i]["accountname"];
-		ret[i].token=res[i]["token"];
-		ret[i].is_user=watoi(res[i]["is_user"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SToken());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().accountname=cur->getString(c_accountname);
+		ret.back().token=cur->getString(c_token);
+		ret.back().is_user=cur->getInt(c_is_user);
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -739,14 +749,15 @@ ClientDAO::CondInt64 ClientDAO::getFileAccessTokenId2Alts(const std::string& acc
 	q_getFileAccessTokenId2Alts->Bind(accountname);
 	q_getFileAccessTokenId2Alts->Bind(is_user_alt1);
 	q_getFileAccessTokenId2Alts->Bind(is_user_alt2);
-	db_results res=q_getFileAccessTokenId2Alts->Read();
-	q_getFileAccessTokenId2Alts->Reset();
+	IDatabaseCursor* cur=q_getFileAccessTokenId2Alts->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_getFileAccessTokenId2Alts->Reset();
 	return ret;
 }
 
@@ -767,14 +778,15 @@ ClientDAO::CondInt64 ClientDAO::getFileAccessTokenId(const std::string& accountn
 	}
 	q_getFileAccessTokenId->Bind(accountname);
 	q_getFileAccessTokenId->Bind(is_user);
-	db_results res=q_getFileAccessTokenId->Read();
-	q_getFileAccessTokenId->Reset();
+	IDatabaseCursor* cur=q_getFileAccessTokenId->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_getFileAccessTokenId->Reset();
 	return ret;
 }
 
@@ -832,14 +844,19 @@ std::vector<int> ClientDAO::getGroupMembership(int uid)
 		q_getGroupMembership=db->Prepare("SELECT gid FROM token_group_memberships WHERE uid = ?", false);
 	}
 	q_getGroupMembership->Bind(uid);
-	db_results res=q_getGroupMembership->Read();
+	IDatabaseCursor* cur=q_getGroupMembership->Cursor();
+	std::vector<int> ret;
+	int c_gid=cur->columnIndex("gid");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_gid));
+	}
+	cur->shutdown();
 	q_getGroupMembership->Reset();
-	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i]=watoi(res[i]["gid"]);
-	}
 	return ret;
 }
 
@@ -940,14 +957,15 @@ ClientDAO::CondInt64 ClientDAO::hasHardLink(const std::string& vol, int64 frn_hi
 	q_hasHardLink->Bind(vol);
 	q_hasHardLink->Bind(frn_high);
 	q_hasHardLink->Bind(frn_low);
-	db_results res=q_hasHardLink->Read();
-	q_hasHardLink->Reset();
+	IDatabaseCursor* cur=q_hasHardLink->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["frn_low"]);
+		ret.value=cur->getInt64(cur->columnIndex("frn_low"));
 	}
+	cur->shutdown();
+	q_hasHardLink->Reset();
 	return ret;
 }
 
@@ -1002,16 +1020,17 @@ ClientDAO::SClientFacet ClientDAO::getClientFacet(const std::string& server_iden
 		q_getClientFacet=db->Prepare("SELECT id, name, server_identity FROM client_facets WHERE server_identity=?", false);
 	}
 	q_getClientFacet->Bind(server_identity);
-	db_results res=q_getClientFacet->Read();
-	q_getClientFacet->Reset();
+	IDatabaseCursor* cur=q_getClientFacet->Cursor();
 	SClientFacet ret = { false, 0, "", "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.name=res[0]["name"];
-		ret.server_identity=res[0]["server_identity"];
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.name=cur->getString(cur->columnIndex("name"));
+		ret.server_identity=cur->getString(cur->columnIndex("server_identity"));
 	}
+	cur->shutdown();
+	q_getClientFacet->Reset();
 	return ret;
 }
 
@@ -1029,16 +1048,17 @@ ClientDAO::SClientFacet ClientDAO::getClientFacetByName(const std::string& name)
 		q_getClientFacetByName=db->Prepare("SELECT id, name, server_identity FROM client_facets WHERE name=?", false);
 	}
 	q_getClientFacetByName->Bind(name);
-	db_results res=q_getClientFacetByName->Read();
-	q_getClientFacetByName->Reset();
+	IDatabaseCursor* cur=q_getClientFacetByName->Cursor();
 	SClientFacet ret = { false, 0, "", "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.name=res[0]["name"];
-		ret.server_identity=res[0]["server_identity"];
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.name=cur->getString(cur->columnIndex("name"));
+		ret.server_identity=cur->getString(cur->columnIndex("server_identity"));
 	}
+	cur->shutdown();
+	q_getClientFacetByName->Reset();
 	return ret;
 }
 
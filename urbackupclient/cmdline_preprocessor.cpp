@@ -188,6 +188,16 @@ void read_config_file(std::string fn, std::vector<std::string>& real_args)
 				real_args.push_back(val);
 			}
 		}
+		if (settings->getValue("NATIVE_XFS_BTRFS_BITMAP", &val))
+		{
+			val = trim(unquote_value(val));
+
+			if (!val.empty())
+			{
+				real_args.push_back("--native_xfs_btrfs_bitmap");
+				real_args.push_back(strlower(val));
+			}
+		}
 	}	
 
 	if(destroy_server)
@@ -1,5 +1,6 @@
 #include "backup_url_parser.h"
 #include "../stringtools.h"
+#include <algorithm>
 
 bool parse_backup_url(const std::string& url, const std::string& url_params, 
 	const str_map& secret_params, IClouddriveFactory::CloudSettings& settings)
@@ -48,6 +49,33 @@ bool parse_backup_url(const std::string& url, const std::string& url_params,
 
 		return true;
 	}
+	else if (next(url, 0, "dir://"))
+	{
+		settings.endpoint = IClouddriveFactory::CloudEndpoint::Dir;
+
+		settings.dir_settings.path = url.substr(6);
+
+		str_map params;
+		ParseParamStrHttp(url_params, &params);
+
+		auto del_parallel_it = params.find("del_parallel");
+		if (del_parallel_it != params.end())
+			settings.dir_settings.num_del_parallel = static_cast<size_t>((std::max)(1, watoi(del_parallel_it->second)));
+
+		auto ordered_del_it = params.find("ordered_del");
+		if (ordered_del_it != params.end())
+			settings.dir_settings.ordered_del = ordered_del_it->second == "1" || ordered_del_it->second == "true";
+
+		auto encryption_key_it = secret_params.find("encryption_key");
+		if (encryption_key_it != secret_params.end())
+			settings.encryption_key = encryption_key_it->second;
+
+		std::string cacheid = Server->GenerateHexMD5(url);
+		settings.cache_img_path = "urbackup/" + cacheid + ".vhdx";
+		settings.dir_settings.cache_db_path = "urbackup/" + cacheid + ".db";
+
+		return true;
+	}
 
 	return false;
 }
@@ -22,6 +22,8 @@
 #include "../fileservplugin/chunk_settings.h"
 #include "../md5.h"
 #include "../common/adler32.h"
+#include "../common/md5_mb.h"
+#include "../common/buf_is_zero.h"
 #include "../urbackupcommon/fileclient/FileClientChunked.h"
 #include "TreeHash.h"
 #include <memory.h>
@@ -56,20 +58,94 @@ namespace
 		return ret;
 	}
 
-	bool buf_is_zero(const char* buf, size_t bsize)
+	std::string sparse_extent_content;
+
+	//Checkpoints read and hashed at once at most
+	const size_t c_max_batch_checkpoints = 4;
+
+	//Reads several checkpoints at once and computes their MD5s
+	//with md5_mb, one checkpoint per SIMD lane
+	class CheckpointBatch
 	{
-		for (size_t i = 0; i < bsize; ++i)
+	public:
+		CheckpointBatch(IFile* f, _i64 fsize, size_t n_checkpoints)
+			: f(f), fsize(fsize), n_checkpoints(n_checkpoints),
+			buf(n_checkpoints*c_checkpoint_dist), digests(n_checkpoints*big_hash_size),
+			batch_pos(-1), batch_n(0), batch_read(0)
+		{
+		}
+
+		//Data of the checkpoint at pos and the MD5 of its chunks before fsize
+		bool get(_i64 pos, char*& data, _u32& cread, const unsigned char*& big_hash)
 		{
-			if (buf[i] != 0)
+			if (batch_pos < 0
+				|| pos < batch_pos
+				|| pos >= batch_pos + static_cast<_i64>(batch_n)*c_checkpoint_dist)
 			{
+				if (!read(pos))
+				{
+					return false;
+				}
+			}
+
+			size_t idx = static_cast<size_t>((pos - batch_pos) / c_checkpoint_dist);
+			data = &buf[idx*c_checkpoint_dist];
+			cread = checkpoint_read(idx);
+			big_hash = &digests[idx*big_hash_size];
+			return true;
+		}
+
+	private:
+		bool read(_i64 pos)
+		{
+			batch_pos = pos;
+			batch_n = static_cast<size_t>((std::min)(static_cast<_i64>(n_checkpoints),
+				(fsize - pos + c_checkpoint_dist - 1) / c_checkpoint_dist));
+
+			bool has_read_error = false;
+			batch_read = f->Read(pos, buf.data(), static_cast<_u32>(batch_n*c_checkpoint_dist), &has_read_error);
+
+			if (has_read_error)
+			{
+				batch_pos = -1;
 				return false;
 			}
+
+			const char* bufs[c_max_batch_checkpoints];
+			size_t lens[c_max_batch_checkpoints];
+			for (size_t i = 0; i < batch_n; ++i)
+			{
+				//Same bytes as hashed per chunk: all chunks before fsize
+				_i64 cp_pos = pos + static_cast<_i64>(i)*c_checkpoint_dist;
+				_i64 chunks_size = (((std::min)(cp_pos + c_checkpoint_dist, fsize) - cp_pos + c_small_hash_dist - 1) / c_small_hash_dist)*c_small_hash_dist;
+				bufs[i] = &buf[i*c_checkpoint_dist];
+				lens[i] = static_cast<size_t>((std::min)(static_cast<_i64>(checkpoint_read(i)), chunks_size));
+			}
+
+			md5_mb(bufs, lens, batch_n, digests.data());
+
+			return true;
 		}
 
-		return true;
-	}
+		_u32 checkpoint_read(size_t idx)
+		{
+			_u32 off = static_cast<_u32>(idx*c_checkpoint_dist);
+			if (batch_read <= off)
+			{
+				return 0;
+			}
+			return (std::min)(static_cast<_u32>(c_checkpoint_dist), batch_read - off);
+		}
 
-	std::string sparse_extent_content;
+		IFile* f;
+		_i64 fsize;
+		size_t n_checkpoints;
+		std::vector<char> buf;
+		std::vector<unsigned char> digests;
+		_i64 batch_pos;
+		size_t batch_n;
+		_u32 batch_read;
+	};
 }
 
 std::string get_sparse_extent_content()
@@ -120,7 +196,6 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 	}
 
 	_i64 n_chunks=c_checkpoint_dist/c_small_hash_dist;
-	std::vector<char> buf(c_checkpoint_dist);
 	char copy_buf[c_small_hash_dist];
 	_i64 copy_write_pos=0;
 	bool copy_read_eof=false;
@@ -170,6 +245,11 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 			max_vdl = fsize;
 	}
 
+	//Reading ahead would read data that is skipped via sparse extents or the CBT hash file
+	size_t n_batch_checkpoints = (extent_iterator == NULL && extents.empty()) ?
+		(std::min)(md5_mb_lanes(), c_max_batch_checkpoints) : 1;
+	CheckpointBatch checkpoint_batch(f, fsize, n_batch_checkpoints);
+
 	for(_i64 pos=0;pos<fsize;)
 	{
 		if(chunk_hashes.get())
@@ -375,7 +455,6 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 		copy_sparse_extent_start = -1;
 
 		
-		MD5 big_hash;
 		MD5 big_hash_copy_control;
 		size_t chunkidx=0;
 		_i64 copy_write_pos_start = copy_write_pos;
@@ -385,15 +464,19 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 		_i64 start_pos = pos;
 		size_t buf_off = 0;
 
-		bool has_read_error = false;
-		_u32 cread = f->Read(buf.data(), c_checkpoint_dist, &has_read_error);
-
-		if (has_read_error)
+		char* buf;
+		_u32 cread;
+		const unsigned char* big_hash;
+		if (!checkpoint_batch.get(pos, buf, cread, big_hash))
 		{
 			Server->Log("Error while reading from file \"" + f->getFilename() + "\"", LL_DEBUG);
 			return false;
 		}
 
+		unsigned int small_hashes[c_checkpoint_dist / c_small_hash_dist];
+		size_t n_small_hashes = static_cast<size_t>((cread + c_small_hash_dist - 1) / c_small_hash_dist);
+		urb_adler32_blocks(buf, cread, static_cast<unsigned int>(c_small_hash_dist), small_hashes);
+
 		int64 copy_off = pos;
 		int64 copy_size = 0;
 
@@ -401,7 +484,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 		{
 			bool has_read_error = false;
 
-			_u32 r = (std::min)(static_cast<_u32>(c_small_hash_dist), static_cast<_u32>(cread - buf_off));
+			_u32 r = buf_off < cread ? (std::min)(static_cast<_u32>(c_small_hash_dist), static_cast<_u32>(cread - buf_off)) : 0;
 			char* cbuf = &buf[buf_off];
 			buf_off += c_small_hash_dist;			
 
@@ -410,8 +493,8 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 				all_zeros = false;
 			}
 
-			*reinterpret_cast<unsigned int*>(&new_chunk.small_hash[chunkidx*small_hash_size]) = urb_adler32(urb_adler32(0, NULL, 0), cbuf, r);
-			big_hash.update((unsigned char*)cbuf, r);
+			*reinterpret_cast<unsigned int*>(&new_chunk.small_hash[chunkidx*small_hash_size]) = chunkidx < n_small_hashes ?
+				small_hashes[chunkidx] : urb_adler32(urb_adler32(0, NULL, 0), cbuf, r);
 			buf_read += r;
 
 			if(hashf!=NULL && treehash==NULL)
@@ -496,7 +579,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 
 		if (copy != nullptr && !modify_inplace)
 		{
-			if (!writeRepeatFreeSpace(copy, buf.data(), cread, cb))
+			if (!writeRepeatFreeSpace(copy, buf, cread, cb))
 			{
 				Server->Log("Error writing to copy file (" + copy->getFilename() + ") -4", LL_DEBUG);
 				return false;
@@ -505,8 +588,7 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 			copy_write_pos += cread;
 		}
 
-		big_hash.finalize();
-		memcpy(new_chunk.big_hash, big_hash.raw_digest_int(), 16);
+		memcpy(new_chunk.big_hash, big_hash, big_hash_size);
 
 		if (hashf != NULL)
 		{
@@ -585,18 +667,10 @@ bool build_chunk_hashs(IFile *f, IFile *hashoutput, INotEnoughSpaceCallback *cb,
 			{
 				Server->Log("Small hash collision. Copying whole big block...", LL_DEBUG);
 				copy_write_pos = copy_write_pos_start;
-				pos = epos - c_checkpoint_dist;
-				f->Seek(pos);
-				bool has_read_error = false;
-				_u32 r = f->Read(buf.data(), c_checkpoint_dist, &has_read_error);
-				if (has_read_error)
-				{
-					Server->Log("Error while reading from file \"" + f->getFilename() + "\" (col)", LL_DEBUG);
-					return false;
-				}
+				_u32 r = cread;
 
 				copy->Seek(copy_write_pos);
-				if (!writeRepeatFreeSpace(copy, buf.data(), r, cb))
+				if (!writeRepeatFreeSpace(copy, buf, r, cb))
 				{
 					Server->Log("Error writing to copy file (" + copy->getFilename() + ") -5", LL_DEBUG);
 					return false;
@@ -100,7 +100,7 @@ FileClient::FileClient(bool enable_find_servers, std::string identity, int proto
 	identity(identity), received_data_bytes(0), queue_callback(NULL), dl_off(0),
 	last_transferred_bytes(0), last_progress_log(0), progress_log_callback(NULL), needs_flush(false),
 	real_transferred_bytes(0), is_downloading(false), sparse_extends_f(NULL), sparse_bytes(0),
-	reconnect_tries(50)
+	reconnect_tries(50), receive_callback(NULL)
 {
 	memset(buffer, 0, BUFFERSIZE_UDP);
 
@@ -1504,6 +1504,11 @@ bool FileClient::Reconnect(void)
 
 						_u32 cw=file->Write(&buf[written], tw);
 						hash_func.update((unsigned char*)&buf[written], cw);
+						if(receive_callback!=NULL
+							&& sparse_file.get()==NULL)
+						{
+							receive_callback->receive_data(received, &buf[written], cw);
+						}
 						written+=cw;
 						write_remaining-=cw;
 						received+=cw;
@@ -2025,6 +2030,11 @@ void FileClient::setNoFreeSpaceCallback(FileClient::NoFreeSpaceCallback * cb)
 	nofreespace_callback = cb;
 }
 
+void FileClient::setReceiveCallback(FileClient::ReceiveCallback * cb)
+{
+	receive_callback = cb;
+}
+
 /*_u32 FileClient::GetFileHashAndMetadata( std::string remotefn, std::string& hash, std::string& permissions, int64& filesize, int64& created, int64& modified )
 {
 	if (tcpsock == NULL)
@@ -2389,6 +2399,72 @@ _u32 FileClient::StopPhashLoad(const std::string & server_token, const std::stri
 	}
 }
 
+_u32 FileClient::PrioritizePhashLoad(const std::string & server_token, const std::string & phash_fn, const std::vector<int64>& file_ids, int tries)
+{
+	if (tcpsock == NULL)
+		return ERR_ERROR;
+
+	setReconnectTries(tries);
+
+	CWData data;
+	data.addUChar(ID_PRIORITIZE_PHASH);
+	data.addString(identity);
+	data.addString(server_token);
+	data.addString(phash_fn);
+	data.addVarInt(static_cast<int64>(file_ids.size()));
+	for (size_t i = 0; i < file_ids.size(); ++i)
+	{
+		data.addVarInt(file_ids[i]);
+	}
+
+	if (stack.Send(tcpsock, data.getDataPtr(), data.getDataSize()) != data.getDataSize())
+	{
+		Server->Log("Timeout during sending phash priority request (1)", LL_ERROR);
+		return ERR_TIMEOUT;
+	}
+
+	while (true)
+	{
+		size_t rc = tcpsock->Read(dl_buf, 1, 120000);
+
+		if (rc == 0)
+		{
+			Server->Log("Server timeout (2) in FileClient sending phash priority request", LL_DEBUG);
+			int tries = getReconnectTriesDecr();
+			bool b = false;
+			if (tries > 0)
+			{
+				b = Reconnect();
+			}
+			if (!b)
+			{
+				Server->Log("FileClient: ERR_TIMEOUT (phash priority)", LL_INFO);
+				return ERR_TIMEOUT;
+			}
+			else
+			{
+				rc = stack.Send(tcpsock, data.getDataPtr(), data.getDataSize());
+				if (rc == 0)
+				{
+					Server->Log("FileClient: Error sending phash priority request", LL_INFO);
+				}
+				starttime = Server->getTimeMS();
+			}
+		}
+		else
+		{
+			if (*dl_buf == ID_PONG)
+			{
+				return ERR_SUCCESS;
+			}
+			else
+			{
+				return ERR_ERROR;
+			}
+		}
+	}
+}
+
 _u32 FileClient::FinishScript(std::string remotefn)
 {
 	if (tcpsock == NULL)
@@ -72,6 +72,13 @@ public:
 			virtual void log_progress(const std::string& fn, int64 total, int64 downloaded, int64 speed_bps) = 0;
 		};
 
+		class ReceiveCallback
+		{
+		public:
+			//Called with data written to the backing file at position pos. Not called for files with sparse extents
+			virtual void receive_data(int64 pos, const char* buf, size_t bsize) = 0;
+		};
+
 
 		FileClient(bool enable_find_servers, std::string identity, int protocol_version=0, bool add_request_checksums=false,
 			FileClient::ReconnectionCallback *reconnection_callback=NULL,
@@ -144,6 +151,8 @@ public:
 
 		_u32 StopPhashLoad(const std::string& server_token, const std::string& phash_fn, int tries);
 
+		_u32 PrioritizePhashLoad(const std::string& server_token, const std::string& phash_fn, const std::vector<int64>& file_ids, int tries);
+
 		_u32 FinishScript(std::string remotefn);
 
 		void addThrottler(IPipeThrottler *throttler);
@@ -168,6 +177,8 @@ public:
 
 		void setNoFreeSpaceCallback(FileClient::NoFreeSpaceCallback* cb);
 
+		void setReceiveCallback(FileClient::ReceiveCallback* cb);
+
 		_u32 Flush();
 
 		bool Reconnect(void);
@@ -292,6 +303,8 @@ private:
 		_i64 sparse_bytes;
 
 		int reconnect_tries;
+
+		FileClient::ReceiveCallback* receive_callback;
 };
 
 const _u32 ERR_CONTINUE=0;
@@ -19,6 +19,8 @@
 #include "filelist_utils.h"
 #include "../Interface/Server.h"
 #include "../stringtools.h"
+#include <memory.h>
+#include <stdlib.h>
 
 void writeFileRepeat(IFile *f, const char *buf, size_t bsize)
 {
@@ -142,6 +144,157 @@ void writeFileItem(IFile* f, SFile cf, std::string extra)
 }
 
 
+namespace
+{
+	//Same as os_atoi64(std::string(str, str_end))
+	int64 parse_int64(const char* str, const char* str_end)
+	{
+		char buf[32];
+		size_t len = str_end - str;
+		if (len >= sizeof(buf))
+		{
+			return os_atoi64(std::string(str, str_end));
+		}
+		memcpy(buf, str, len);
+		buf[len] = 0;
+#ifdef _WIN32
+		return _atoi64(buf);
+#else
+		return strtoll(buf, NULL, 10);
+#endif
+	}
+}
+
+bool FileListParser::nextEntry(const char* buf, size_t bsize, size_t& bpos, SFile &data, std::map<std::string, std::string>* extra)
+{
+	while (bpos < bsize)
+	{
+		if (state == ParseState_Type)
+		{
+			const char* line = buf + bpos;
+			const char* line_end = static_cast<const char*>(memchr(line, '\n', bsize - bpos));
+
+			if (line_end != NULL
+				&& parseLine(line, line_end, data, extra))
+			{
+				bpos += line_end - line;
+				return true;
+			}
+		}
+
+		//Line not completely in buffer or it needs the special cases
+		//of the state machine
+		if (nextEntry(buf[bpos], data, extra))
+		{
+			return true;
+		}
+
+		++bpos;
+	}
+
+	bpos = bsize - 1;
+	return false;
+}
+
+bool FileListParser::parseLine(const char* line, const char* line_end, SFile &data, std::map<std::string, std::string>* extra)
+{
+	if (*line == 'u')
+	{
+		if (line + 1 != line_end)
+		{
+			return false;
+		}
+
+		data.isdir = true;
+		data.name = "..";
+		data.last_modified = 0;
+		data.size = 0;
+		if (extra != NULL)
+		{
+			extra->clear();
+		}
+
+		reset();
+		return true;
+	}
+
+	bool isdir;
+	if (*line == 'f')
+	{
+		isdir = false;
+	}
+	else if (*line == 'd')
+	{
+		isdir = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (line_end - line < 2)
+	{
+		return false;
+	}
+
+	//Skip type and quote
+	const char* name_start = line + 2;
+	const char* name_end = static_cast<const char*>(memchr(name_start, '"', line_end - name_start));
+
+	if (name_end == NULL
+		|| name_end + 1 >= line_end
+		|| name_end[1] == '"'
+		|| memchr(name_start, '\\', name_end - name_start) != NULL)
+	{
+		return false;
+	}
+
+	if (isdir
+		&& name_end - name_start == 2
+		&& name_start[0] == '.' && name_start[1] == '.')
+	{
+		return false;
+	}
+
+	//Directories without size and time ('d"name"\n') end at the name and
+	//are left to nextEntry(char) by the name_end check above
+	const char* size_start = name_end + 2;
+	const char* size_end = size_start <= line_end ? static_cast<const char*>(memchr(size_start, ' ', line_end - size_start)) : NULL;
+	if (size_end == NULL)
+	{
+		return false;
+	}
+
+	const char* mod_start = size_end + 1;
+	const char* mod_end = static_cast<const char*>(memchr(mod_start, '#', line_end - mod_start));
+
+	data.size = parse_int64(size_start, size_end);
+
+	if (mod_end == NULL)
+	{
+		data.last_modified = parse_int64(mod_start, line_end);
+		if (extra != NULL)
+		{
+			extra->clear();
+		}
+	}
+	else
+	{
+		data.last_modified = parse_int64(mod_start, mod_end);
+		if (extra != NULL)
+		{
+			extra->clear();
+			ParseParamStrHttp(std::string(mod_end + 1, line_end), extra, false);
+		}
+	}
+
+	data.isdir = isdir;
+	data.name.assign(name_start, name_end);
+
+	reset();
+	return true;
+}
+
 bool FileListParser::nextEntry( char ch, SFile &data, std::map<std::string, std::string>* extra )
 {
 	++pos;
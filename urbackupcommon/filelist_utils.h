@@ -21,8 +21,19 @@ public:
 
 	bool nextEntry(char ch, SFile &data, std::map<std::string, std::string>* extra);
 
+	/**
+	* Parses buf starting at buf[bpos]. Complete lines are parsed directly
+	* from the buffer. If an entry is finished it returns true and bpos is
+	* the position of the entry's final '\n' (the position nextEntry(char)
+	* would have returned true at). Otherwise the whole buffer was consumed,
+	* bpos is bsize-1 and parsing continues with the next buffer.
+	*/
+	bool nextEntry(const char* buf, size_t bsize, size_t& bpos, SFile &data, std::map<std::string, std::string>* extra);
+
 private:
 
+	bool parseLine(const char* line, const char* line_end, SFile &data, std::map<std::string, std::string>* extra);
+
 	enum ParseState
 	{
 		ParseState_Type,
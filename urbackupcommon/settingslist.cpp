@@ -241,6 +241,10 @@ std::vector<std::string> getGlobalSettingsList(void)
 	ret.push_back("download_client");
 	ret.push_back("autoupdate_clients");
 	ret.push_back("max_sim_backups");
+	ret.push_back("max_sim_full_image_backups");
+	ret.push_back("admission_max_hash_queue");
+	ret.push_back("admission_max_storage_speed");
+	ret.push_back("admission_max_network_speed");
 	ret.push_back("max_active_clients");
 	ret.push_back("cleanup_window");
 	ret.push_back("backup_database");
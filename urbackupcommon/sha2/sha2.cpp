@@ -37,6 +37,7 @@
 
 #ifdef DO_NOT_USE_CRYPTOPP_SHA
 
+#include "../../common/cpu_features.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -523,6 +524,128 @@ void SHA256_Transform(SHA256_CTX* context, const sha2_word32* data) {
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+#ifdef URB_X86_SIMD
+
+/*
+* SHA-256 block transform using the x86 SHA extensions (SHA-NI).
+* Processes nblocks consecutive 64 byte blocks at data.
+*/
+#define SHANI_ROUNDS(msg_curr, k_idx) \
+	MSG = _mm_add_epi32(msg_curr, _mm_loadu_si128((const __m128i*)&K256[k_idx])); \
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG); \
+	MSG = _mm_shuffle_epi32(MSG, 0x0E); \
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG)
+
+#define SHANI_ROUNDS_SCHED(msg_curr, msg_prev, msg_next, k_idx) \
+	MSG = _mm_add_epi32(msg_curr, _mm_loadu_si128((const __m128i*)&K256[k_idx])); \
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG); \
+	TMP = _mm_alignr_epi8(msg_curr, msg_prev, 4); \
+	msg_next = _mm_add_epi32(msg_next, TMP); \
+	msg_next = _mm_sha256msg2_epu32(msg_next, msg_curr); \
+	MSG = _mm_shuffle_epi32(MSG, 0x0E); \
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG)
+
+URB_TARGET("sha,sse4.1,ssse3")
+static void SHA256_Transform_shani(SHA256_CTX* context, const sha2_byte* data, size_t nblocks) {
+	__m128i STATE0, STATE1, MSG, TMP;
+	__m128i MSG0, MSG1, MSG2, MSG3;
+	__m128i ABEF_SAVE, CDGH_SAVE;
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	TMP = _mm_loadu_si128((const __m128i*)&context->state[0]);
+	STATE1 = _mm_loadu_si128((const __m128i*)&context->state[4]);
+
+	TMP = _mm_shuffle_epi32(TMP, 0xB1);          /* CDAB */
+	STATE1 = _mm_shuffle_epi32(STATE1, 0x1B);    /* EFGH */
+	STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);    /* ABEF */
+	STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0); /* CDGH */
+
+	while (nblocks > 0) {
+		ABEF_SAVE = STATE0;
+		CDGH_SAVE = STATE1;
+
+		MSG0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0)), MASK);
+		MSG1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), MASK);
+		MSG2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), MASK);
+		MSG3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), MASK);
+
+		/* Rounds 0 to 15 */
+		SHANI_ROUNDS(MSG0, 0);
+		SHANI_ROUNDS(MSG1, 4);
+		MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+		SHANI_ROUNDS(MSG2, 8);
+		MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+		SHANI_ROUNDS_SCHED(MSG3, MSG2, MSG0, 12);
+		MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+
+		/* Rounds 16 to 51 */
+		SHANI_ROUNDS_SCHED(MSG0, MSG3, MSG1, 16);
+		MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+		SHANI_ROUNDS_SCHED(MSG1, MSG0, MSG2, 20);
+		MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+		SHANI_ROUNDS_SCHED(MSG2, MSG1, MSG3, 24);
+		MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+		SHANI_ROUNDS_SCHED(MSG3, MSG2, MSG0, 28);
+		MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+		SHANI_ROUNDS_SCHED(MSG0, MSG3, MSG1, 32);
+		MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+		SHANI_ROUNDS_SCHED(MSG1, MSG0, MSG2, 36);
+		MSG0 = _mm_sha256msg1_epu32(MSG0, MSG1);
+		SHANI_ROUNDS_SCHED(MSG2, MSG1, MSG3, 40);
+		MSG1 = _mm_sha256msg1_epu32(MSG1, MSG2);
+		SHANI_ROUNDS_SCHED(MSG3, MSG2, MSG0, 44);
+		MSG2 = _mm_sha256msg1_epu32(MSG2, MSG3);
+		SHANI_ROUNDS_SCHED(MSG0, MSG3, MSG1, 48);
+		MSG3 = _mm_sha256msg1_epu32(MSG3, MSG0);
+
+		/* Rounds 52 to 63 */
+		SHANI_ROUNDS_SCHED(MSG1, MSG0, MSG2, 52);
+		SHANI_ROUNDS_SCHED(MSG2, MSG1, MSG3, 56);
+		SHANI_ROUNDS(MSG3, 60);
+
+		STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+		STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+
+		data += SHA256_BLOCK_LENGTH;
+		--nblocks;
+	}
+
+	TMP = _mm_shuffle_epi32(STATE0, 0x1B);       /* FEBA */
+	STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);    /* DCHG */
+	STATE0 = _mm_blend_epi16(TMP, STATE1, 0xF0); /* DCBA */
+	STATE1 = _mm_alignr_epi8(STATE1, TMP, 8);    /* ABEF */
+
+	_mm_storeu_si128((__m128i*)&context->state[0], STATE0);
+	_mm_storeu_si128((__m128i*)&context->state[4], STATE1);
+}
+
+#undef SHANI_ROUNDS
+#undef SHANI_ROUNDS_SCHED
+
+static int SHA256_Has_shani(void) {
+	static const int has_shani = cpu_features::get().sha
+		&& cpu_features::get().sse41
+		&& cpu_features::get().ssse3;
+	return has_shani;
+}
+
+#endif /* URB_X86_SIMD */
+
+/* Process nblocks full blocks with the fastest available transform */
+static void SHA256_Transform_blocks(SHA256_CTX* context, const sha2_byte* data, size_t nblocks) {
+#ifdef URB_X86_SIMD
+	if (SHA256_Has_shani()) {
+		SHA256_Transform_shani(context, data, nblocks);
+		return;
+	}
+#endif
+	while (nblocks > 0) {
+		SHA256_Transform(context, (const sha2_word32*)data);
+		data += SHA256_BLOCK_LENGTH;
+		--nblocks;
+	}
+}
+
 void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -545,7 +668,7 @@ void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 			context->bitcount += freespace << 3;
 			len -= freespace;
 			data += freespace;
-			SHA256_Transform(context, (sha2_word32*)context->buffer);
+			SHA256_Transform_blocks(context, context->buffer, 1);
 		}
 		else {
 			/* The buffer is not yet full */
@@ -556,12 +679,13 @@ void SHA256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 			return;
 		}
 	}
-	while (len >= SHA256_BLOCK_LENGTH) {
+	if (len >= SHA256_BLOCK_LENGTH) {
 		/* Process as many complete blocks as we can */
-		SHA256_Transform(context, (sha2_word32*)data);
-		context->bitcount += SHA256_BLOCK_LENGTH << 3;
-		len -= SHA256_BLOCK_LENGTH;
-		data += SHA256_BLOCK_LENGTH;
+		size_t nblocks = len / SHA256_BLOCK_LENGTH;
+		SHA256_Transform_blocks(context, data, nblocks);
+		context->bitcount += ((sha2_word64)nblocks*SHA256_BLOCK_LENGTH) << 3;
+		len -= nblocks*SHA256_BLOCK_LENGTH;
+		data += nblocks*SHA256_BLOCK_LENGTH;
 	}
 	if (len > 0) {
 		/* There's left-overs, so save 'em */
@@ -613,7 +737,7 @@ void SHA256_Final(sha2_byte digest[], SHA256_CTX* context) {
 			*context->buffer = 0x80;
 		}
 		/* Set the bit count: */
-		*(sha2_word64*)&context->buffer[SHA256_SHORT_BLOCK_LENGTH] = context->bitcount;
+		MEMCPY_BCOPY(&context->buffer[SHA256_SHORT_BLOCK_LENGTH], &context->bitcount, sizeof(sha2_word64));
 
 		/* Final transform: */
 		SHA256_Transform(context, (sha2_word32*)context->buffer);
@@ -934,8 +1058,8 @@ void SHA512_Last(SHA512_CTX* context) {
 		*context->buffer = 0x80;
 	}
 	/* Store the length of input data (in bits): */
-	*(sha2_word64*)&context->buffer[SHA512_SHORT_BLOCK_LENGTH] = context->bitcount[1];
-	*(sha2_word64*)&context->buffer[SHA512_SHORT_BLOCK_LENGTH + 8] = context->bitcount[0];
+	MEMCPY_BCOPY(&context->buffer[SHA512_SHORT_BLOCK_LENGTH], &context->bitcount[1], sizeof(sha2_word64));
+	MEMCPY_BCOPY(&context->buffer[SHA512_SHORT_BLOCK_LENGTH + 8], &context->bitcount[0], sizeof(sha2_word64));
 
 	/* Final transform: */
 	SHA512_Transform(context, (sha2_word64*)context->buffer);
@@ -1101,7 +1225,11 @@ void sha256_final(sha256_ctx *ctx, unsigned char *digest)
 void sha256(const unsigned char *message, unsigned int len,
 	unsigned char *digest)
 {
-	SHA256_Data(message, len, reinterpret_cast<char*>(digest));
+	/* SHA256_Data() returns the hex string, callers want the binary digest */
+	sha256_ctx ctx;
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, message, len);
+	SHA256_Final(digest, &ctx);
 }
 
 void sha512_init(sha512_ctx *ctx)
@@ -1123,7 +1251,10 @@ void sha512_final(sha512_ctx *ctx, unsigned char *digest)
 void sha512(const unsigned char *message, unsigned int len,
 	unsigned char *digest)
 {
-	SHA512_Data(message, len, reinterpret_cast<char*>(digest));
+	sha512_ctx ctx;
+	SHA512_Init(&ctx);
+	SHA512_Update(&ctx, message, len);
+	SHA512_Final(digest, &ctx);
 }
 
 #else //!DO_NOT_USE_CRYPTOPP_SHA
@@ -0,0 +1,401 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef CLIENT_ONLY
+
+#include "BackupScheduler.h"
+#include "../Interface/Server.h"
+#include "../stringtools.h"
+#include "../urbackupcommon/json.h"
+#include "server_settings.h"
+#include "server_status.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+IMutex* BackupScheduler::mutex = NULL;
+std::map<Backup*, BackupScheduler::SBackupRequest> BackupScheduler::queued;
+std::map<Backup*, BackupScheduler::SBackupRequest> BackupScheduler::running;
+BackupScheduler::SLoad BackupScheduler::load;
+int64 BackupScheduler::last_load_update = 0;
+int64 BackupScheduler::last_written_bytes = -1;
+int BackupScheduler::max_sim_full_image_backups = -1;
+int64 BackupScheduler::max_hashqueue = -1;
+int64 BackupScheduler::max_storage_bps = -1;
+int64 BackupScheduler::max_network_bps = -1;
+
+namespace
+{
+	const int64 load_update_interval = 2000;
+	//ClientMain checks its queue every five minutes. Requests not repeated
+	//within two intervals belong to backups which were removed
+	const int64 request_expire_time = 10 * 60 * 1000;
+	//A woken up client which did not ask again in this time does not
+	//block backups with lower priority anymore
+	const int64 wakeup_timeout = 30 * 1000;
+
+	int64 getProcessWrittenBytes()
+	{
+#ifdef _WIN32
+		IO_COUNTERS io_counters;
+		if (GetProcessIoCounters(GetCurrentProcess(), &io_counters))
+		{
+			return static_cast<int64>(io_counters.WriteTransferCount);
+		}
+		return -1;
+#elif defined(__linux__)
+		std::string io = getStreamFile("/proc/self/io");
+		std::string write_bytes = getbetween("\nwrite_bytes: ", "\n", io);
+		if (write_bytes.empty())
+		{
+			return -1;
+		}
+		return watoi64(write_bytes);
+#else
+		return -1;
+#endif
+	}
+
+	std::string priorityName(BackupScheduler::EPriority priority)
+	{
+		switch (priority)
+		{
+		case BackupScheduler::Priority_IncrFile: return "incr_file";
+		case BackupScheduler::Priority_IncrImage: return "incr_image";
+		case BackupScheduler::Priority_FullFile: return "full_file";
+		case BackupScheduler::Priority_FullImage: return "full_image";
+		}
+		return std::string();
+	}
+
+	int64 budgetSetting(int val, int64 unit)
+	{
+		if (val <= 0)
+		{
+			return -1;
+		}
+		return val*unit;
+	}
+}
+
+void BackupScheduler::init_mutex(void)
+{
+	mutex = Server->createMutex();
+}
+
+void BackupScheduler::destroy_mutex(void)
+{
+	Server->destroy(mutex);
+}
+
+bool BackupScheduler::admit(Backup* backup, const std::string& clientname, bool file, bool incremental,
+	const std::string& storage_volume, SSettings* settings)
+{
+	IScopedLock lock(mutex);
+
+	int64 now = Server->getTimeMS();
+
+	max_sim_full_image_backups = settings->max_sim_full_image_backups;
+	max_hashqueue = budgetSetting(settings->admission_max_hash_queue, 1);
+	max_storage_bps = budgetSetting(settings->admission_max_storage_speed, 1024 * 1024);
+	max_network_bps = budgetSetting(settings->admission_max_network_speed, 1000 * 1000 / 8);
+
+	updateLoad();
+	expireRequests(now);
+
+	SBackupRequest& req = queued[backup];
+	if (req.request_time == 0)
+	{
+		req.clientname = clientname;
+		req.file = file;
+		req.incremental = incremental;
+		if (file)
+		{
+			req.priority = incremental ? Priority_IncrFile : Priority_FullFile;
+		}
+		else
+		{
+			req.priority = incremental ? Priority_IncrImage : Priority_FullImage;
+		}
+		req.storage_volume = storage_volume;
+		req.request_time = now;
+	}
+	req.last_request_time = now;
+	req.wakeup_time = 0;
+
+	std::string reason = checkBudgets(req);
+
+	if (reason.empty())
+	{
+		for (std::map<Backup*, SBackupRequest>::iterator it = queued.begin(); it != queued.end(); ++it)
+		{
+			if (it->first != backup
+				&& isHigherPriority(it->second, req)
+				&& checkBudgets(it->second).empty())
+			{
+				reason = "Waiting for " + priorityName(it->second.priority) + " backup of client \"" + it->second.clientname + "\" with higher priority";
+
+				if (it->second.wakeup_time == 0)
+				{
+					it->second.wakeup_time = now;
+					ServerStatus::sendToCommPipe(it->second.clientname, "WAKEUP");
+				}
+				break;
+			}
+		}
+	}
+
+	if (!reason.empty())
+	{
+		if (req.reason != reason)
+		{
+			Server->Log("Backup scheduler: Queuing " + priorityName(req.priority) + " backup of client \"" + clientname + "\". " + reason, LL_DEBUG);
+			req.reason = reason;
+		}
+		return false;
+	}
+
+	Server->Log("Backup scheduler: Starting " + priorityName(req.priority) + " backup of client \"" + clientname + "\" after waiting for "
+		+ PrettyPrintTime(now - req.request_time), LL_DEBUG);
+
+	req.reason.clear();
+	req.start_time = now;
+	running[backup] = req;
+	queued.erase(backup);
+
+	return true;
+}
+
+void BackupScheduler::release(Backup* backup)
+{
+	IScopedLock lock(mutex);
+
+	queued.erase(backup);
+
+	std::map<Backup*, SBackupRequest>::iterator it = running.find(backup);
+	if (it == running.end())
+	{
+		return;
+	}
+
+	running.erase(it);
+
+	wakeupNext(Server->getTimeMS());
+}
+
+void BackupScheduler::getStatus(JSON::Object& ret)
+{
+	IScopedLock lock(mutex);
+
+	int64 now = Server->getTimeMS();
+
+	updateLoad();
+	expireRequests(now);
+
+	JSON::Object obj_load;
+	if (load.storage_bps >= 0)
+	{
+		obj_load.set("storage_bps", static_cast<int64>(load.storage_bps));
+	}
+	obj_load.set("network_bps", static_cast<int64>(load.network_bps));
+	obj_load.set("hash_queue", load.hashqueue);
+	ret.set("load", obj_load);
+
+	JSON::Object obj_budgets;
+	obj_budgets.set("max_sim_full_image_backups", max_sim_full_image_backups);
+	obj_budgets.set("max_hash_queue", max_hashqueue);
+	obj_budgets.set("max_storage_bps", max_storage_bps);
+	obj_budgets.set("max_network_bps", max_network_bps);
+	ret.set("budgets", obj_budgets);
+
+	JSON::Array arr_running;
+	for (std::map<Backup*, SBackupRequest>::iterator it = running.begin(); it != running.end(); ++it)
+	{
+		JSON::Object obj;
+		obj.set("clientname", it->second.clientname);
+		obj.set("type", priorityName(it->second.priority));
+		obj.set("storage_volume", it->second.storage_volume);
+		obj.set("waited_ms", it->second.start_time - it->second.request_time);
+		obj.set("running_ms", now - it->second.start_time);
+		arr_running.add(obj);
+	}
+	ret.set("running", arr_running);
+
+	JSON::Array arr_queued;
+	for (std::map<Backup*, SBackupRequest>::iterator it = queued.begin(); it != queued.end(); ++it)
+	{
+		JSON::Object obj;
+		obj.set("clientname", it->second.clientname);
+		obj.set("type", priorityName(it->second.priority));
+		obj.set("priority", static_cast<int>(it->second.priority));
+		obj.set("storage_volume", it->second.storage_volume);
+		obj.set("waiting_ms", now - it->second.request_time);
+		obj.set("reason", it->second.reason);
+		arr_queued.add(obj);
+	}
+	ret.set("queued", arr_queued);
+}
+
+void BackupScheduler::updateLoad()
+{
+	int64 now = Server->getTimeMS();
+	if (last_load_update != 0
+		&& now - last_load_update < load_update_interval)
+	{
+		return;
+	}
+
+	int64 written_bytes = getProcessWrittenBytes();
+	if (written_bytes >= 0
+		&& last_written_bytes >= 0
+		&& last_load_update != 0
+		&& written_bytes >= last_written_bytes)
+	{
+		double curr_bps = static_cast<double>(written_bytes - last_written_bytes) * 1000 / (now - last_load_update);
+		if (load.storage_bps < 0)
+		{
+			load.storage_bps = curr_bps;
+		}
+		else
+		{
+			load.storage_bps = 0.7*load.storage_bps + 0.3*curr_bps;
+		}
+	}
+	else if (written_bytes < 0)
+	{
+		load.storage_bps = -1;
+	}
+	last_written_bytes = written_bytes;
+	last_load_update = now;
+
+	load.network_bps = 0;
+	load.hashqueue = 0;
+
+	std::vector<SStatus> status = ServerStatus::getStatus();
+	for (size_t i = 0; i < status.size(); ++i)
+	{
+		for (size_t j = 0; j < status[i].processes.size(); ++j)
+		{
+			const SProcess& proc = status[i].processes[j];
+			load.network_bps += proc.speed_bpms * 1000;
+			load.hashqueue += proc.hashqueuesize + proc.prepare_hashqueuesize;
+		}
+	}
+}
+
+bool BackupScheduler::isHigherPriority(const SBackupRequest& a, const SBackupRequest& b)
+{
+	if (a.priority != b.priority)
+	{
+		return a.priority < b.priority;
+	}
+
+	return a.request_time < b.request_time;
+}
+
+std::string BackupScheduler::checkBudgets(const SBackupRequest& req)
+{
+	if (!req.file && !req.incremental
+		&& max_sim_full_image_backups >= 0)
+	{
+		int running_full_images = 0;
+		for (std::map<Backup*, SBackupRequest>::iterator it = running.begin(); it != running.end(); ++it)
+		{
+			if (!it->second.file && !it->second.incremental
+				&& it->second.storage_volume == req.storage_volume)
+			{
+				++running_full_images;
+			}
+		}
+
+		if (running_full_images >= max_sim_full_image_backups)
+		{
+			return "Maximum number of simultaneous full image backups (" + convert(max_sim_full_image_backups)
+				+ ") on storage volume \"" + req.storage_volume + "\" reached";
+		}
+	}
+
+	//Always allow one backup to run, so the budgets cannot block backups completely
+	if (running.empty())
+	{
+		return std::string();
+	}
+
+	if (max_storage_bps > 0
+		&& load.storage_bps >= max_storage_bps)
+	{
+		return "Storage throughput " + PrettyPrintBytes(static_cast<int64>(load.storage_bps)) + "/s exceeds budget of "
+			+ PrettyPrintBytes(max_storage_bps) + "/s";
+	}
+
+	if (max_network_bps > 0
+		&& load.network_bps >= max_network_bps)
+	{
+		return "Network usage " + PrettyPrintBytes(static_cast<int64>(load.network_bps)) + "/s exceeds budget of "
+			+ PrettyPrintBytes(max_network_bps) + "/s";
+	}
+
+	if (req.file
+		&& max_hashqueue > 0
+		&& load.hashqueue >= max_hashqueue)
+	{
+		return "Hash queue contains " + convert(load.hashqueue) + " files (budget is " + convert(max_hashqueue) + " files)";
+	}
+
+	return std::string();
+}
+
+void BackupScheduler::expireRequests(int64 now)
+{
+	for (std::map<Backup*, SBackupRequest>::iterator it = queued.begin(); it != queued.end();)
+	{
+		if (now - it->second.last_request_time > request_expire_time
+			|| (it->second.wakeup_time != 0
+				&& now - it->second.wakeup_time > wakeup_timeout) )
+		{
+			queued.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void BackupScheduler::wakeupNext(int64 now)
+{
+	std::map<Backup*, SBackupRequest>::iterator next = queued.end();
+	for (std::map<Backup*, SBackupRequest>::iterator it = queued.begin(); it != queued.end(); ++it)
+	{
+		if (next == queued.end()
+			|| isHigherPriority(it->second, next->second))
+		{
+			next = it;
+		}
+	}
+
+	if (next != queued.end()
+		&& next->second.wakeup_time == 0)
+	{
+		next->second.wakeup_time = now;
+		ServerStatus::sendToCommPipe(next->second.clientname, "WAKEUP");
+	}
+}
+
+#endif //CLIENT_ONLY
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../Interface/Mutex.h"
+#include "../Interface/Types.h"
+#include <string>
+#include <map>
+
+class Backup;
+struct SSettings;
+
+namespace JSON
+{
+	class Object;
+}
+
+/**
+* Server wide admission of file and image backups. ClientMain asks it
+* before starting a queued backup. A backup is admitted if the resource
+* budgets from the server settings (full image backups per storage
+* volume, storage throughput, hash queue depth and network usage) allow
+* it and no backup with higher priority is waiting. Otherwise it stays
+* queued with the reason, and the client is woken up once resources are
+* released.
+*/
+class BackupScheduler
+{
+public:
+	enum EPriority
+	{
+		Priority_IncrFile = 0,
+		Priority_IncrImage = 1,
+		Priority_FullFile = 2,
+		Priority_FullImage = 3
+	};
+
+	static void init_mutex(void);
+	static void destroy_mutex(void);
+
+	static bool admit(Backup* backup, const std::string& clientname, bool file, bool incremental,
+		const std::string& storage_volume, SSettings* settings);
+
+	//Called when the backup finished or was removed from the queue
+	static void release(Backup* backup);
+
+	static void getStatus(JSON::Object& ret);
+
+private:
+	struct SBackupRequest
+	{
+		SBackupRequest()
+			: file(false), incremental(false), priority(Priority_IncrFile),
+			request_time(0), last_request_time(0), wakeup_time(0), start_time(0)
+		{}
+
+		std::string clientname;
+		bool file;
+		bool incremental;
+		EPriority priority;
+		std::string storage_volume;
+		std::string reason;
+		int64 request_time;
+		int64 last_request_time;
+		int64 wakeup_time;
+		int64 start_time;
+	};
+
+	struct SLoad
+	{
+		SLoad()
+			: storage_bps(-1), network_bps(0), hashqueue(0)
+		{}
+
+		double storage_bps;
+		double network_bps;
+		int64 hashqueue;
+	};
+
+	static void updateLoad();
+	static bool isHigherPriority(const SBackupRequest& a, const SBackupRequest& b);
+	static std::string checkBudgets(const SBackupRequest& req);
+	static void expireRequests(int64 now);
+	static void wakeupNext(int64 now);
+
+	static IMutex* mutex;
+	static std::map<Backup*, SBackupRequest> queued;
+	static std::map<Backup*, SBackupRequest> running;
+
+	static SLoad load;
+	static int64 last_load_update;
+	static int64 last_written_bytes;
+
+	static int max_sim_full_image_backups;
+	static int64 max_hashqueue;
+	static int64 max_storage_bps;
+	static int64 max_network_bps;
+};
@@ -20,6 +20,7 @@
 #include "../stringtools.h"
 #include <assert.h>
 #include "../urbackupcommon/ExtentIterator.h"
+#include "../common/buf_is_zero.h"
 #include <memory.h>
 #include <limits.h>
 
@@ -37,19 +38,6 @@ namespace
 	{
 		return ((numToRound / multiple) * multiple);
 	}
-
-	bool buf_is_zero(const char* buf, size_t bsize)
-	{
-		for (size_t i = 0; i < bsize; ++i)
-		{
-			if (buf[i] != 0)
-			{
-				return false;
-			}
-		}
-
-		return true;
-	}
 }
 
 
@@ -490,16 +478,10 @@ void ChunkPatcher::nextChunkPatcherBytes(int64 pos, const char * buf, size_t bsi
 		size_t bsize_to_checkpoint = (std::min)(bsize, static_cast<size_t>(next_checkpoint - pos));
 		int64 sparse_buf_used = pos%sparse_blocksize;
 
-		if (curr_only_zeros)
+		if (curr_only_zeros
+			&& !buf_is_zero(buf, bsize_to_checkpoint))
 		{
-			for (size_t i = 0; i < bsize_to_checkpoint; ++i)
-			{
-				if (buf[i] != 0)
-				{
-					curr_only_zeros = false;
-					break;
-				}
-			}
+			curr_only_zeros = false;
 		}
 
 		if (changed)
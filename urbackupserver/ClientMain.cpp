@@ -68,6 +68,7 @@
 #include "../urbackupcommon/InternetServicePipe2.h"
 #include "../urbackupcommon/CompressedPipe2.h"
 #include "../urbackupcommon/CompressedPipeZstd.h"
+#include "BackupScheduler.h"
 
 extern IUrlFactory *url_fak;
 extern ICryptoFactory *crypto_fak;
@@ -359,6 +360,10 @@ void ClientMain::operator ()(void)
 	{
 		curr_image_version = 2;
 	}
+	else if (server_settings->getImageFileFormat() == image_file_format_dedup)
+	{
+		curr_image_version = 3;
+	}
 	else
 	{
 		curr_image_version = 1;
@@ -558,6 +563,8 @@ void ClientMain::operator ()(void)
 						if (backup_queue[i].running)
 							stopBackupRunning(backup_queue[i].backup->isFileBackup());
 
+						BackupScheduler::release(backup_queue[i].backup);
+
 						ServerStatus::subRunningJob(clientmainname);
 
 						if (!backup_queue[i].backup->getResult() &&
@@ -694,6 +701,10 @@ void ClientMain::operator ()(void)
 					{
 						curr_image_version = 2;
 					}
+					else if (server_settings->getImageFileFormat() == image_file_format_dedup)
+					{
+						curr_image_version = 3;
+					}
 					else
 					{
 						curr_image_version = 1;
@@ -955,8 +966,29 @@ void ClientMain::operator ()(void)
 							&& (!filebackup || !isRunningFileBackup(backup_queue[i].group, false) ) )
 						{
 							ServerStatus::addRunningJob(clientmainname);
+
+							bool admitted = false;
+							bool scheduler_queued = false;
 							if(ServerStatus::numRunningJobs(clientmainname)<=server_settings->getSettings()->max_running_jobs_per_client
-								&& isBackupsRunningOkay(filebackup, true))
+								&& isBackupsRunningOkay(filebackup, false))
+							{
+								SSettings* settings = server_settings->getSettings();
+								admitted = BackupScheduler::admit(backup_queue[i].backup, clientname, filebackup,
+									backup_queue[i].backup->isIncrementalBackup(),
+									filebackup ? settings->backupfolder : settings->backupfolder_uncompr, settings);
+
+								if(!admitted)
+								{
+									scheduler_queued = true;
+								}
+								else if(!isBackupsRunningOkay(filebackup, true))
+								{
+									BackupScheduler::release(backup_queue[i].backup);
+									admitted = false;
+								}
+							}
+
+							if(admitted)
 							{
 								std::string tname = "backup main";
 								if (filebackup)
@@ -990,8 +1022,12 @@ void ClientMain::operator ()(void)
 							else
 							{
 								ServerStatus::subRunningJob(clientmainname);
-							}							
-							break;
+							}
+
+							if(!scheduler_queued)
+							{
+								break;
+							}
 						}
 					}
 
@@ -1150,6 +1186,7 @@ void ClientMain::operator ()(void)
 			ServerStatus::subRunningJob(clientmainname);
 		}
 
+		BackupScheduler::release(backup_queue[i].backup);
 		delete backup_queue[i].backup;
 	}
 
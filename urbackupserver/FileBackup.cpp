@@ -40,6 +40,7 @@
 #include "../urbackupcommon/TreeHash.h"
 #include "../common/data.h"
 #include "PhashLoad.h"
+#include "PrepareHashPool.h"
 #include "../urbackupcommon/glob.h"
 
 #ifndef NAME_MAX
@@ -56,7 +57,7 @@ FileBackup::FileBackup( ClientMain* client_main, int clientid, std::string clien
 	group(group), use_tmpfiles(use_tmpfiles), tmpfile_path(tmpfile_path), use_reflink(use_reflink), use_snapshots(use_snapshots),
 	disk_error(false), with_hashes(false),
 	backupid(-1), hashpipe(NULL), hashpipe_prepare(NULL),
-	bsh_ticket(ILLEGAL_THREADPOOL_TICKET), bsh_prepare_ticket(ILLEGAL_THREADPOOL_TICKET), pingthread(NULL),
+	bsh_ticket(ILLEGAL_THREADPOOL_TICKET), pingthread(NULL),
 	pingthread_ticket(ILLEGAL_THREADPOOL_TICKET), cdp_path(false), metadata_download_thread_ticket(ILLEGAL_THREADPOOL_TICKET),
 	last_speed_received_bytes(0), speed_set_time(0)
 {
@@ -586,19 +587,26 @@ void FileBackup::createHashThreads(bool use_reflink, bool ignore_hash_mismatches
 	assert(bsh_prepare.empty());
 
 	hashpipe=Server->createMemoryPipe();
-	hashpipe_prepare=Server->createMemoryPipe();
 
 	size_t h_cnt = server_settings->getSettings()->hash_threads;
 
 	for (size_t i = 0; i < h_cnt; ++i)
 	{
 		BackupServerHash* curr_bsh = new BackupServerHash(hashpipe, clientid, use_snapshots, use_reflink, use_tmpfiles, logid, use_snapshots, max_file_id);
-		BackupServerPrepareHash* curr_bsh_prepare = new BackupServerPrepareHash(hashpipe_prepare, hashpipe, clientid, logid, ignore_hash_mismatches);
+		//Items taken from the pipe for a batch cannot be processed by other hash threads
+		curr_bsh->setIndexBatching(h_cnt == 1);
 		bsh.push_back(curr_bsh);
-		bsh_prepare.push_back(curr_bsh_prepare);
 		bsh_ticket.push_back(Server->getThreadPool()->execute(curr_bsh, "fbackup write" + convert(i)));
-		bsh_prepare_ticket.push_back(Server->getThreadPool()->execute(curr_bsh_prepare, "fbackup hash" + convert(i)));
 	}
+
+	size_t prepare_cnt = (std::max)(h_cnt, PrepareHashPool::getNumWorkers());
+
+	for (size_t i = 0; i < prepare_cnt; ++i)
+	{
+		bsh_prepare.push_back(new BackupServerPrepareHash(clientid, logid, ignore_hash_mismatches));
+	}
+
+	hashpipe_prepare = new PrepareHashQueue(hashpipe, bsh_prepare, clientname, status_id);
 }
 
 
@@ -608,19 +616,27 @@ void FileBackup::destroyHashThreads()
 	{
 		hashpipe_prepare->Write("exit");
 		Server->getThreadPool()->waitFor(bsh_ticket);
-		Server->getThreadPool()->waitFor(bsh_prepare_ticket);
 		Server->destroy(hashpipe_prepare);
 		Server->destroy(hashpipe);
 	}
 
 	bsh_ticket.clear();
-	bsh_prepare_ticket.clear();
 	hashpipe=NULL;
 	hashpipe_prepare=NULL;
 	bsh.clear();
 	bsh_prepare.clear();
 }
 
+size_t FileBackup::getHashQueueSize()
+{
+	size_t ret = hashpipe->getNumElements();
+	for (size_t i = 0; i < bsh.size(); ++i)
+	{
+		ret += bsh[i]->getNumQueued();
+	}
+	return ret;
+}
+
 _i64 FileBackup::getIncrementalSize(IFile *f, const std::vector<size_t> &diffs, bool& backup_with_components, bool all)
 {
 	f->Seek(0);
@@ -646,7 +662,7 @@ _i64 FileBackup::getIncrementalSize(IFile *f, const std::vector<size_t> &diffs,
 	{
 		for(size_t i=0;i<read;++i)
 		{
-			bool b=list_parser.nextEntry(buffer[i], cf, NULL);
+			bool b=list_parser.nextEntry(buffer, read, i, cf, NULL);
 			if(b)
 			{
 				if(cf.isdir==true)
@@ -1280,7 +1296,7 @@ void FileBackup::waitForFileThreads(void)
 		size_t bsh_working = bsh.size() - hashpipe->getNumWaiters();
 		size_t bsh_prepare_working = bsh_prepare.size() - hashpipe_prepare->getNumWaiters();
 		
-		hashqueuesize = hashpipe->getNumElements() + bsh_working;
+		hashqueuesize = getHashQueueSize() + bsh_working;
 		prepare_hashqueuesize = hashpipe_prepare->getNumElements() + bsh_prepare_working;
 	}
 	{
@@ -1327,7 +1343,7 @@ bool FileBackup::verify_file_backup(IFile *fileentries)
 		for(size_t i=0;i<read;++i)
 		{
 			std::map<std::string, std::string> extras;
-			bool b=list_parser.nextEntry(buffer[i], cf, &extras);
+			bool b=list_parser.nextEntry(buffer, read, i, cf, &extras);
 			if(b)
 			{
 				std::string cfn;
@@ -1761,10 +1777,10 @@ std::vector<size_t> FileBackup::findIdenticalPermissionRoots(IFile* file_list_f,
 
 	while((bread=file_list_f->Read(buffer, 4096))>0)
 	{
-		for(_u32 i=0;i<bread;++i)
+		for(size_t i=0;i<bread;++i)
 		{
 			std::map<std::string, std::string> extra;
-			if(file_list_parser.nextEntry(buffer[i], data, &extra))
+			if(file_list_parser.nextEntry(buffer, bread, i, data, &extra))
 			{
 
 				std::string osspecific_name;
@@ -1939,10 +1955,10 @@ bool FileBackup::createUserView(IFile* file_list_f, const std::vector<int64>& id
 			ServerLogger::Log(logid, "Error reading from file " + file_list_f->getFilename() + ". " + os_last_error_str(), LL_ERROR);
 			return false;
 		}
-		for(_u32 i=0;i<bread;++i)
+		for(size_t i=0;i<bread;++i)
 		{
 			std::map<std::string, std::string> extra;
-			if(file_list_parser.nextEntry(buffer[i], data, &extra))
+			if(file_list_parser.nextEntry(buffer, bread, i, data, &extra))
 			{
 				if(skip>0)
 				{
@@ -2471,9 +2487,23 @@ bool FileBackup::startPhashDownloadThread(const std::string& async_id)
 		return false;
 	}
 
+	std::unique_ptr<FileClient> fc_phash_prio;
+	if (client_main->getProtocolVersions().phash_version > 1)
+	{
+		fc_phash_prio.reset(new FileClient(false, identity, client_main->getProtocolVersions().filesrv_protocol_version,
+			client_main->isOnInternetConnection(), client_main, use_tmpfiles ? NULL : this));
+
+		rc = client_main->getClientFilesrvConnection(fc_phash_prio.get(), server_settings.get(), 10000);
+		if (rc != ERR_CONNECTED)
+		{
+			ServerLogger::Log(logid, "Could not get filesrv connection for parallel hash priority requests (" + clientname + ")", LL_DEBUG);
+			fc_phash_prio.reset();
+		}
+	}
+
 	filelist_async_id = async_id;
 	fc_phash_stream->setProgressLogCallback(this);
-	phash_load.reset(new PhashLoad(fc_phash_stream.release(), logid, async_id));
+	phash_load.reset(new PhashLoad(fc_phash_stream.release(), fc_phash_prio.release(), logid, async_id));
 	phash_load_ticket = Server->getThreadPool()->execute(phash_load.get(), "phash load");
 
 	int64 starttime = Server->getTimeMS();
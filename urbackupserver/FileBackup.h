@@ -218,6 +218,7 @@ protected:
 	std::string clientlistName(int ref_backupid);
 	void createHashThreads(bool use_reflink, bool ignore_hash_mismatches);
 	void destroyHashThreads();
+	size_t getHashQueueSize();
 	_i64 getIncrementalSize(IFile *f, const std::vector<size_t> &diffs, bool& backup_with_components, bool all=false);
 	void calculateDownloadSpeed(int64 ctime, FileClient &fc, FileClientChunked* fc_chunked);
 	void calculateEtaFileBackup( int64 &last_eta_update, int64& eta_set_time, int64 ctime, FileClient &fc, FileClientChunked* fc_chunked,
@@ -273,7 +274,6 @@ protected:
 	std::vector<BackupServerHash*> bsh;
 	std::vector<THREADPOOL_TICKET> bsh_ticket;
 	std::vector<BackupServerPrepareHash*> bsh_prepare;
-	std::vector<THREADPOOL_TICKET> bsh_prepare_ticket;
 	std::unique_ptr<BackupServerHash> local_hash;
 	std::unique_ptr<BackupServerHash> local_hash2;
 
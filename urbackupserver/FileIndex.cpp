@@ -17,8 +17,13 @@
 **************************************************************************/
 
 #include "FileIndex.h"
+#include "FileIndexFilter.h"
 #include "../Interface/Server.h"
 #include "create_files_index.h"
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 
 const size_t max_buffer_size=100000;
 #ifdef _DEBUG
@@ -28,93 +33,441 @@ const unsigned int max_wait_time=30000;
 #endif
 const size_t min_size_no_wait=10000;
 
-std::map<FileIndex::SIndexKey, int64> FileIndex::cache_buffer_1;
-std::map<FileIndex::SIndexKey, int64> FileIndex::cache_buffer_2;
-std::map<FileIndex::SIndexKey, int64>* FileIndex::active_cache_buffer=&cache_buffer_1;
-std::map<FileIndex::SIndexKey, int64>* FileIndex::other_cache_buffer=&cache_buffer_2;
+namespace
+{
+	std::atomic<int64> active_cache_entries(0);
+	std::atomic<int64> cache_flushes(0);
+	std::atomic<bool> accept_puts(true);
+
+	//Hash over hash and filesize only, so that all clients of the same
+	//file end up in the same shard and probe sequence
+	uint64 key_prefix_hash(const FileIndex::SIndexKey& key)
+	{
+		uint64 h;
+		memcpy(&h, key.getHash(), sizeof(h));
+		uint64 fs = static_cast<uint64>(key.getFilesize());
+		h ^= fs * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ULL;
+		h ^= h >> 32;
+		return h;
+	}
+
+	/**
+	* Open addressing hash table with linear probing on the
+	* (hash, filesize) prefix of the key. Entries are never removed
+	* individually (deletes are stored as value 0), the whole table is
+	* cleared after it was flushed to the file index.
+	*/
+	class CacheTable
+	{
+	public:
+		struct SEntry
+		{
+			FileIndex::SIndexKey key;
+			int64 value;
+		};
+
+		CacheTable()
+			: n_entries(0), mask(0)
+		{
+		}
+
+		size_t size() const
+		{
+			return n_entries;
+		}
+
+		bool empty() const
+		{
+			return n_entries == 0;
+		}
+
+		//Returns true if the key was newly inserted
+		bool put(const FileIndex::SIndexKey& key, int64 value, uint64 h)
+		{
+			if ((n_entries + 1) * 4 > ctrl.size() * 3)
+			{
+				grow();
+			}
+
+			unsigned char tag = make_tag(h);
+			for (size_t i = slot(h);; i = (i + 1) & mask)
+			{
+				if (ctrl[i] == 0)
+				{
+					ctrl[i] = tag;
+					entries[i].key = key;
+					entries[i].value = value;
+					++n_entries;
+					return true;
+				}
+				else if (ctrl[i] == tag
+					&& entries[i].key == key)
+				{
+					entries[i].value = value;
+					return false;
+				}
+			}
+		}
 
+		const SEntry* find(const FileIndex::SIndexKey& key, uint64 h) const
+		{
+			if (n_entries == 0)
+				return NULL;
 
+			unsigned char tag = make_tag(h);
+			for (size_t i = slot(h); ctrl[i] != 0; i = (i + 1) & mask)
+			{
+				if (ctrl[i] == tag
+					&& entries[i].key == key)
+				{
+					return &entries[i];
+				}
+			}
+			return NULL;
+		}
+
+		//Calls f for all entries with the same hash and filesize as key
+		template<typename F>
+		void for_each_client(const FileIndex::SIndexKey& key, uint64 h, F f) const
+		{
+			if (n_entries == 0)
+				return;
+
+			unsigned char tag = make_tag(h);
+			for (size_t i = slot(h); ctrl[i] != 0; i = (i + 1) & mask)
+			{
+				if (ctrl[i] == tag
+					&& entries[i].key.isEqualWithoutClientid(key))
+				{
+					f(entries[i]);
+				}
+			}
+		}
+
+		void append_to(std::vector<SEntry>& out) const
+		{
+			for (size_t i = 0; i < ctrl.size(); ++i)
+			{
+				if (ctrl[i] != 0)
+				{
+					out.push_back(entries[i]);
+				}
+			}
+		}
+
+		void clear()
+		{
+			if (n_entries == 0)
+				return;
+
+			std::fill(ctrl.begin(), ctrl.end(), 0);
+			n_entries = 0;
+		}
+
+	private:
+		static unsigned char make_tag(uint64 h)
+		{
+			return static_cast<unsigned char>(0x80 | (h >> 57));
+		}
+
+		size_t slot(uint64 h) const
+		{
+			return static_cast<size_t>(h >> 6) & mask;
+		}
+
+		void grow()
+		{
+			std::vector<unsigned char> old_ctrl;
+			std::vector<SEntry> old_entries;
+			old_ctrl.swap(ctrl);
+			old_entries.swap(entries);
+
+			size_t new_size = old_ctrl.empty() ? 256 : old_ctrl.size() * 2;
+			ctrl.resize(new_size);
+			entries.resize(new_size);
+			mask = new_size - 1;
+			n_entries = 0;
+
+			for (size_t i = 0; i < old_ctrl.size(); ++i)
+			{
+				if (old_ctrl[i] != 0)
+				{
+					put(old_entries[i].key, old_entries[i].value,
+						key_prefix_hash(old_entries[i].key));
+				}
+			}
+		}
+
+		std::vector<unsigned char> ctrl;
+		std::vector<SEntry> entries;
+		size_t n_entries;
+		size_t mask;
+	};
+}
+
+/**
+* One shard of the write-back cache. Puts go into the table selected by
+* the current epoch. The flush thread increments the epoch, which
+* retires the table into the flush, and clears it after it was
+* committed to the file index. Lookups check the active table first.
+*/
+class alignas(64) FileIndexCacheShard
+{
+public:
+	FileIndexCacheShard()
+		: epoch(0)
+	{
+	}
+
+	void acquire(std::unique_lock<std::mutex>& lock)
+	{
+		bool contended = !lock.try_lock();
+		if (contended)
+		{
+			lock.lock();
+			inc(&SCounters::lock_contended);
+		}
+		inc(&SCounters::lock_acquired);
+	}
+
+	//Shard lock has to be held
+	void count_hit(bool hit)
+	{
+		inc(hit ? &SCounters::hits : &SCounters::misses);
+	}
+
+	CacheTable& active()
+	{
+		return tables[epoch % 2];
+	}
+
+	CacheTable& flushing()
+	{
+		return tables[(epoch + 1) % 2];
+	}
+
+	std::mutex mutex;
+	int64 epoch;
+	CacheTable tables[2];
+
+	//Only written with the shard lock held, so they stay in the
+	//shard's cache lines instead of a globally shared one
+	struct alignas(64) SCounters
+	{
+		SCounters()
+			: hits(0), misses(0), lock_contended(0), lock_acquired(0)
+		{}
+
+		std::atomic<int64> hits;
+		std::atomic<int64> misses;
+		std::atomic<int64> lock_contended;
+		std::atomic<int64> lock_acquired;
+	};
+	SCounters counters;
+
+private:
+	void inc(std::atomic<int64> SCounters::* counter)
+	{
+		std::atomic<int64>& c = counters.*counter;
+		c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+};
+
+FileIndexCacheShard FileIndex::cache_shards[FileIndex::n_cache_shards];
 
 IMutex *FileIndex::mutex=NULL;
 ICondition *FileIndex::cond=NULL;
 bool FileIndex::do_shutdown=false;
 bool FileIndex::do_flush=false;
-bool FileIndex::do_accept = true;
 
+namespace
+{
+	bool entry_less(const CacheTable::SEntry& a, const CacheTable::SEntry& b)
+	{
+		return a.key < b.key;
+	}
+
+	//Smallest client id >= key client id
+	bool get_from_cache(const FileIndex::SIndexKey& key, uint64 h, const CacheTable& cache, int64& res)
+	{
+		int key_clientid = key.getClientid();
+		int best_clientid = -1;
+		cache.for_each_client(key, h, [&](const CacheTable::SEntry& e) {
+			int clientid = e.key.getClientid();
+			if (clientid >= key_clientid
+				&& (best_clientid == -1 || clientid < best_clientid))
+			{
+				best_clientid = clientid;
+				res = e.value;
+			}
+		});
+		return best_clientid != -1;
+	}
+
+	//Smallest client id >= key client id, otherwise largest client id < key client id
+	bool get_from_cache_prefer_client(const FileIndex::SIndexKey& key, uint64 h, const CacheTable& cache, int64& res)
+	{
+		if (get_from_cache(key, h, cache, res))
+		{
+			return true;
+		}
+
+		int key_clientid = key.getClientid();
+		int best_clientid = -1;
+		cache.for_each_client(key, h, [&](const CacheTable::SEntry& e) {
+			int clientid = e.key.getClientid();
+			if (clientid < key_clientid
+				&& clientid > best_clientid)
+			{
+				best_clientid = clientid;
+				res = e.value;
+			}
+		});
+		return best_clientid != -1;
+	}
+
+	bool get_from_cache_exact(const FileIndex::SIndexKey& key, uint64 h, const CacheTable& cache, int64& res)
+	{
+		const CacheTable::SEntry* e = cache.find(key, h);
+		if (e != NULL)
+		{
+			res = e->value;
+			return true;
+		}
+		return false;
+	}
+
+	void get_from_cache_all_clients(const FileIndex::SIndexKey& key, uint64 h, const CacheTable& cache, std::map<int, int64>& ret)
+	{
+		int key_clientid = key.getClientid();
+		cache.for_each_client(key, h, [&](const CacheTable::SEntry& e) {
+			int clientid = e.key.getClientid();
+			if (clientid >= key_clientid)
+			{
+				ret[clientid] = e.value;
+			}
+		});
+	}
+
+	//False if there is definitely no entry with the key's hash and size in the index
+	bool index_may_contain(FileIndexFilter* filter, const FileIndex::SIndexKey& key)
+	{
+		if (filter == NULL
+			|| filter->may_contain(key))
+		{
+			return true;
+		}
+
+		filter->count_lookup(true, false);
+		return false;
+	}
+
+	void count_index_result(FileIndexFilter* filter, bool found)
+	{
+		if (filter != NULL)
+		{
+			filter->count_lookup(false, found);
+		}
+	}
+}
+
+FileIndexCacheShard& FileIndex::get_cache_shard(const SIndexKey& key)
+{
+	return cache_shards[key_prefix_hash(key) % n_cache_shards];
+}
 
 void FileIndex::operator()(void)
 {
 	mutex=Server->createMutex();
 	cond=Server->createCondition();
 
+	std::vector<CacheTable::SEntry> local_buf;
+
 	while(true)
 	{
-		std::map<FileIndex::SIndexKey, int64>* local_buf;
-
 		{
 			IScopedLock lock(mutex);
 
 			if(do_shutdown &&
-				cache_buffer_1.empty() &&
-				cache_buffer_2.empty() )
+				active_cache_entries.load()<=0 )
 			{
 				break;
 			}
 
-			while(active_cache_buffer->empty() && !do_shutdown)
+			while(active_cache_entries.load()<=0 && !do_shutdown)
 			{
 				do_flush=false;
 				int64 starttime=Server->getTimeMS();
 
-				while(active_cache_buffer->size()<min_size_no_wait
+				while(active_cache_entries.load()<static_cast<int64>(min_size_no_wait)
 					&& Server->getTimeMS()-starttime<max_wait_time
 					&& !do_shutdown && !do_flush)
 				{
 					cond->wait(&lock, max_wait_time);
 				}
-			}			
-
-			local_buf=active_cache_buffer;
-			
-			if(active_cache_buffer==&cache_buffer_1)
-			{
-				active_cache_buffer=&cache_buffer_2;
-				other_cache_buffer=&cache_buffer_1;
-			}
-			else
-			{
-				active_cache_buffer=&cache_buffer_1;
-				other_cache_buffer=&cache_buffer_2;
 			}
 		}
 
+		local_buf.clear();
+
+		for (size_t i = 0; i < n_cache_shards; ++i)
+		{
+			FileIndexCacheShard& shard = cache_shards[i];
+			std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+			shard.acquire(lock);
+			++shard.epoch;
+			shard.flushing().append_to(local_buf);
+		}
+
+		active_cache_entries -= static_cast<int64>(local_buf.size());
+
+		std::sort(local_buf.begin(), local_buf.end(), entry_less);
+
 		start_transaction();
 
-		for(std::map<FileIndex::SIndexKey, int64>::iterator it=local_buf->begin();
-			it!=local_buf->end();++it)
+		for(std::vector<CacheTable::SEntry>::iterator it=local_buf.begin();
+			it!=local_buf.end();++it)
 		{
-			if(it->second!=0)
+			if(it->value!=0)
 			{
-				FILEENTRY_DEBUG(Server->Log("LMDB: PUT clientid=" + convert(it->first.getClientid()) 
-					+ " filesize=" + convert(it->first.getFilesize())
-					+ " hash=" + base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index)
-					+ " target=" + convert(it->second), LL_DEBUG));
-				put(it->first, it->second);
+				FILEENTRY_DEBUG(Server->Log("LMDB: PUT clientid=" + convert(it->key.getClientid()) 
+					+ " filesize=" + convert(it->key.getFilesize())
+					+ " hash=" + base64_encode(reinterpret_cast<const unsigned char*>(it->key.getHash()), bytes_in_index)
+					+ " target=" + convert(it->value), LL_DEBUG));
+				put(it->key, it->value);
 			}
 			else
 			{
-				FILEENTRY_DEBUG(Server->Log("LMDB: DEL clientid=" + convert(it->first.getClientid()) 
-					+ " filesize=" + convert(it->first.getFilesize())
-					+ " hash="+base64_encode(reinterpret_cast<const unsigned char*>(it->first.getHash()), bytes_in_index), LL_DEBUG));
-				del(it->first);
+				FILEENTRY_DEBUG(Server->Log("LMDB: DEL clientid=" + convert(it->key.getClientid()) 
+					+ " filesize=" + convert(it->key.getFilesize())
+					+ " hash="+base64_encode(reinterpret_cast<const unsigned char*>(it->key.getHash()), bytes_in_index), LL_DEBUG));
+				del(it->key);
 			}
 		}
 
 		commit_transaction();
 
+		//Before clearing, so that prefetched lookups are invalidated
+		//before the flushed entries disappear from the cache
+		++cache_flushes;
+
+		for (size_t i = 0; i < n_cache_shards; ++i)
+		{
+			FileIndexCacheShard& shard = cache_shards[i];
+			std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+			shard.acquire(lock);
+			shard.flushing().clear();
+		}
+
+		SCacheStats stats = get_cache_stats();
+		Server->Log("File index cache: flushed " + convert(local_buf.size()) + " entries. Hits: " + convert(stats.hits)
+			+ " misses: " + convert(stats.misses) + " lock contended: " + convert(stats.lock_contended)
+			+ "/" + convert(stats.lock_acquired), LL_DEBUG);
+
 		{
 			IScopedLock lock(mutex);
-			local_buf->clear();
 			do_flush=false;
 		}
 	}
@@ -124,17 +477,40 @@ void FileIndex::operator()(void)
 
 void FileIndex::put_delayed(const SIndexKey& key, int64 value)
 {
-	IScopedLock lock(mutex);
-
-	while(active_cache_buffer->size()>=max_buffer_size || !do_accept)
+	while(active_cache_entries.load()>=static_cast<int64>(max_buffer_size) || !accept_puts.load())
 	{
-		lock.relock(NULL);
 		Server->wait(10);
-		lock.relock(mutex);
 	}
 
-	(*active_cache_buffer)[key]=value;
-	cond->notify_all();
+	uint64 h = key_prefix_hash(key);
+	FileIndexCacheShard& shard = cache_shards[h % n_cache_shards];
+
+	int64 new_entries = 0;
+	{
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		shard.acquire(lock);
+
+		//Under the shard lock, so that flush_puts() can wait for it (see filter rebuild)
+		if (value != 0)
+		{
+			FileIndexFilter::add_entry(key);
+		}
+
+		if (shard.active().put(key, value, h))
+		{
+			new_entries = ++active_cache_entries;
+		}
+	}
+
+	if (new_entries > 0)
+	{
+		if (new_entries == 1
+			|| new_entries == static_cast<int64>(min_size_no_wait))
+		{
+			IScopedLock lock(mutex);
+			cond->notify_all();
+		}
+	}
 }
 
 void FileIndex::del_delayed(const SIndexKey& key)
@@ -145,42 +521,141 @@ void FileIndex::del_delayed(const SIndexKey& key)
 int64 FileIndex::get_with_cache(const FileIndex::SIndexKey& key)
 {
 	{
-		IScopedLock lock(mutex);
+		uint64 h = key_prefix_hash(key);
+		FileIndexCacheShard& shard = cache_shards[h % n_cache_shards];
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		shard.acquire(lock);
 
 		int64 ret;
-		if(get_from_cache(key, *active_cache_buffer, ret))
+		if(get_from_cache(key, h, shard.active(), ret)
+			|| get_from_cache(key, h, shard.flushing(), ret))
 		{
+			shard.count_hit(true);
 			return ret;
 		}
 
-		if(get_from_cache(key, *other_cache_buffer, ret))
-		{
-			return ret;
-		}
+		shard.count_hit(false);
+	}
 
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+	if (!index_may_contain(filter, key))
+	{
+		return 0;
 	}
 
-	return get_any_client(key);
+	int64 ret = get_any_client(key);
+	count_index_result(filter, ret != 0);
+	return ret;
+}
+
+bool FileIndex::get_cached_prefer_client(const SIndexKey& key, int64& ret)
+{
+	uint64 h = key_prefix_hash(key);
+	FileIndexCacheShard& shard = cache_shards[h % n_cache_shards];
+	std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+	shard.acquire(lock);
+
+	bool hit = get_from_cache_prefer_client(key, h, shard.active(), ret)
+		|| get_from_cache_prefer_client(key, h, shard.flushing(), ret);
+
+	shard.count_hit(hit);
+	return hit;
 }
 
 int64 FileIndex::get_with_cache_prefer_client(const SIndexKey& key)
 {
+	int64 ret;
+	if(get_cached_prefer_client(key, ret))
 	{
-		IScopedLock lock(mutex);
+		return ret;
+	}
 
-		int64 ret;
-		if(get_from_cache_prefer_client(key, *active_cache_buffer, ret))
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+	if (!index_may_contain(filter, key))
+	{
+		return 0;
+	}
+
+	ret = get_prefer_client(key);
+	count_index_result(filter, ret != 0);
+	return ret;
+}
+
+std::vector<int64> FileIndex::get_prefer_client_batch(const std::vector<SIndexKey>& keys)
+{
+	std::vector<int64> ret;
+	ret.reserve(keys.size());
+	for(size_t i=0;i<keys.size();++i)
+	{
+		ret.push_back(get_prefer_client(keys[i]));
+	}
+	return ret;
+}
+
+void FileIndex::prefetch_prefer_client(const std::vector<SIndexKey>& keys, SPrefetch& prefetch)
+{
+	prefetch.prefer_client.clear();
+
+	//Load the generation before reading from the index. If a flush
+	//commits while or after reading, the results are discarded
+	prefetch.flush_generation = cache_flushes.load();
+
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+
+	std::vector<SIndexKey> lookup_keys;
+	lookup_keys.reserve(keys.size());
+	for(size_t i=0;i<keys.size();++i)
+	{
+		if (index_may_contain(filter, keys[i]))
 		{
-			return ret;
+			lookup_keys.push_back(keys[i]);
+		}
+		else
+		{
+			prefetch.prefer_client[keys[i]] = 0;
 		}
+	}
+
+	if (lookup_keys.empty())
+	{
+		return;
+	}
 
-		if(get_from_cache_prefer_client(key, *other_cache_buffer, ret))
+	std::vector<int64> res = get_prefer_client_batch(lookup_keys);
+
+	for(size_t i=0;i<lookup_keys.size() && i<res.size();++i)
+	{
+		prefetch.prefer_client[lookup_keys[i]] = res[i];
+		count_index_result(filter, res[i] != 0);
+	}
+}
+
+int64 FileIndex::get_prefetched_prefer_client(const SIndexKey& key, const SPrefetch& prefetch)
+{
+	int64 ret;
+	if(get_cached_prefer_client(key, ret))
+	{
+		return ret;
+	}
+
+	if(prefetch.flush_generation == cache_flushes.load())
+	{
+		std::map<SIndexKey, int64>::const_iterator it = prefetch.prefer_client.find(key);
+		if(it!=prefetch.prefer_client.end())
 		{
-			return ret;
+			return it->second;
 		}
 	}
 
-	return get_prefer_client(key);
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+	if (!index_may_contain(filter, key))
+	{
+		return 0;
+	}
+
+	ret = get_prefer_client(key);
+	count_index_result(filter, ret != 0);
+	return ret;
 }
 
 std::map<int, int64> FileIndex::get_all_clients_with_cache( const SIndexKey& key, bool with_del)
@@ -188,14 +663,26 @@ std::map<int, int64> FileIndex::get_all_clients_with_cache( const SIndexKey& key
 	std::map<int, int64> ret_cache;
 
 	{
-		IScopedLock lock(mutex);
+		uint64 h = key_prefix_hash(key);
+		FileIndexCacheShard& shard = cache_shards[h % n_cache_shards];
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		shard.acquire(lock);
+
+		get_from_cache_all_clients(key, h, shard.flushing(), ret_cache);
 
-		get_from_cache_all_clients(key, *other_cache_buffer, ret_cache);
+		get_from_cache_all_clients(key, h, shard.active(), ret_cache);
 
-		get_from_cache_all_clients(key, *active_cache_buffer, ret_cache);
+		shard.count_hit(!ret_cache.empty());
 	}
 
-	std::map<int, int64> ret = get_all_clients(key);
+	std::map<int, int64> ret;
+
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+	if (index_may_contain(filter, key))
+	{
+		ret = get_all_clients(key);
+		count_index_result(filter, !ret.empty());
+	}
 
 	for (std::map<int, int64>::iterator it = ret_cache.begin(); it != ret_cache.end();++it)
 	{
@@ -225,18 +712,27 @@ std::map<int, int64> FileIndex::get_all_clients_with_cache( const SIndexKey& key
 int64 FileIndex::get_with_cache_exact( const SIndexKey& key )
 {
 	{
-		IScopedLock lock(mutex);
+		uint64 h = key_prefix_hash(key);
+		FileIndexCacheShard& shard = cache_shards[h % n_cache_shards];
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		shard.acquire(lock);
 
 		int64 ret;
-		if(get_from_cache_exact(key, *active_cache_buffer, ret))
+		if(get_from_cache_exact(key, h, shard.active(), ret)
+			|| get_from_cache_exact(key, h, shard.flushing(), ret))
 		{
+			shard.count_hit(true);
 			return ret;
 		}
 
-		if(get_from_cache_exact(key, *other_cache_buffer, ret))
-		{
-			return ret;
-		}
+		shard.count_hit(false);
+	}
+
+	FileIndexFilter* filter = FileIndexFilter::get_for_lookup();
+	if (filter != NULL
+		&& !filter->may_contain(key))
+	{
+		return 0;
 	}
 
 	return get(key);
@@ -250,87 +746,57 @@ void FileIndex::shutdown()
 	cond->notify_all();
 }
 
-bool FileIndex::get_from_cache( const FileIndex::SIndexKey &key, const std::map<SIndexKey, int64>& cache, int64& res )
-{
-	std::map<FileIndex::SIndexKey, int64>::const_iterator it=cache.lower_bound(key);
-
-	if(it!=cache.end() &&
-		it->first.isEqualWithoutClientid(key))
-	{
-		res = it->second;
-		return true;
-	}
-
-	return false;
-}
-
-bool FileIndex::get_from_cache_prefer_client( const SIndexKey &key, const std::map<SIndexKey, int64>& cache, int64& res)
+void FileIndex::flush()
 {
-	std::map<FileIndex::SIndexKey, int64>::const_iterator start_it=cache.lower_bound(key);
+	IScopedLock lock(mutex);
 
-	if(start_it!=cache.end()
-		&& start_it->first.isEqualWithoutClientid(key) )
-	{
-		res=start_it->second;
-		return true;
-	}
+	do_flush=true;
 
-	if(start_it!=cache.end() &&
-		start_it!=cache.begin())
+	while(do_flush)
 	{
-		--start_it;
-
-		if( start_it->first.isEqualWithoutClientid(key) )
-		{
-			res=start_it->second;
-			return true;
-		}
+		cond->notify_all();
+		lock.relock(NULL);
+		Server->wait(100);
+		lock.relock(mutex);
 	}
-
-	return false;
 }
 
-void FileIndex::get_from_cache_all_clients( const SIndexKey &key, const std::map<SIndexKey, int64>& cache, std::map<int, int64> &ret )
+void FileIndex::flush_puts()
 {
-	std::map<FileIndex::SIndexKey, int64>::const_iterator it=cache.lower_bound(key);
-
-	for(;it!=cache.end()
-		&& it->first.isEqualWithoutClientid(key); ++it)
+	//Puts that are in progress finish before the shard lock is released
+	for (size_t i = 0; i < n_cache_shards; ++i)
 	{
-		ret[it->first.getClientid()]=it->second;
+		FileIndexCacheShard& shard = cache_shards[i];
+		std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+		shard.acquire(lock);
 	}
+
+	//The first flush may return after a flush that started before the puts
+	flush();
+	flush();
 }
 
-bool FileIndex::get_from_cache_exact( const SIndexKey& key, const std::map<SIndexKey, int64>& cache, int64& res )
+void FileIndex::stop_accept()
 {
-	std::map<FileIndex::SIndexKey, int64>::const_iterator it=cache.find(key);
-
-	if(it!=cache.end())
-	{
-		res=it->second;
-		return true;
-	}
-
-	return false;
+	accept_puts = false;
 }
 
-void FileIndex::flush()
+FileIndex::SCacheStats FileIndex::get_cache_stats()
 {
-	IScopedLock lock(mutex);
-
-	do_flush=true;
-
-	while(do_flush)
+	SCacheStats ret;
+	ret.hits = 0;
+	ret.misses = 0;
+	ret.lock_contended = 0;
+	ret.lock_acquired = 0;
+	for (size_t i = 0; i < n_cache_shards; ++i)
 	{
-		cond->notify_all();
-		lock.relock(NULL);
-		Server->wait(100);
-		lock.relock(mutex);
+		const FileIndexCacheShard::SCounters& counters = cache_shards[i].counters;
+		ret.hits += counters.hits.load(std::memory_order_relaxed);
+		ret.misses += counters.misses.load(std::memory_order_relaxed);
+		ret.lock_contended += counters.lock_contended.load(std::memory_order_relaxed);
+		ret.lock_acquired += counters.lock_acquired.load(std::memory_order_relaxed);
 	}
-}
-
-void FileIndex::stop_accept()
-{
-	IScopedLock lock(mutex);
-	do_accept = false;
+	ret.entries = (std::max)(static_cast<int64>(0), active_cache_entries.load());
+	ret.flushes = cache_flushes.load();
+	return ret;
 }
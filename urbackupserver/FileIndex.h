@@ -8,9 +8,13 @@
 #include <memory.h>
 #include "../stringtools.h"
 #include <assert.h>
+#include <vector>
+#include <map>
 
 const size_t bytes_in_index = 16;
 
+class FileIndexCacheShard;
+
 class FileIndex : public IThread
 {
 public:
@@ -106,6 +110,13 @@ public:
 
 	virtual std::map<int, int64> get_all_clients(const SIndexKey& key) = 0;
 
+	/**
+	* Same as get_prefer_client for each key. Implementations can sort
+	* the keys and resolve them in one pass, so this is cheaper than
+	* separate lookups for larger batches.
+	*/
+	virtual std::vector<int64> get_prefer_client_batch(const std::vector<SIndexKey>& keys);
+
 	virtual void start_transaction(void)=0;
 
 	virtual void put(const SIndexKey& key, int64 value)=0;
@@ -120,6 +131,28 @@ public:
 
 	virtual int64 get_with_cache_prefer_client(const SIndexKey& key);
 
+	struct SPrefetch
+	{
+		SPrefetch()
+			: flush_generation(-1) {}
+
+		int64 flush_generation;
+		std::map<SIndexKey, int64> prefer_client;
+	};
+
+	/**
+	* Looks up keys with get_prefer_client_batch and stores the results
+	* in prefetch. The results stay usable via get_prefetched_prefer_client
+	* until the next cache flush is committed.
+	*/
+	void prefetch_prefer_client(const std::vector<SIndexKey>& keys, SPrefetch& prefetch);
+
+	/**
+	* Same as get_with_cache_prefer_client, but uses the prefetched result
+	* instead of a lookup in the index if available
+	*/
+	int64 get_prefetched_prefer_client(const SIndexKey& key, const SPrefetch& prefetch);
+
 	virtual void del(const SIndexKey& key)=0;
 
 	static void del_delayed(const SIndexKey& key);
@@ -138,27 +171,35 @@ public:
 
 	static void flush();
 
+	//Waits till all entries put before the call are in the index
+	static void flush_puts();
+
 	static void stop_accept();
 
-private:
+	struct SCacheStats
+	{
+		int64 hits;
+		int64 misses;
+		int64 lock_contended;
+		int64 lock_acquired;
+		int64 entries;
+		int64 flushes;
+	};
+
+	static SCacheStats get_cache_stats();
 
-	bool get_from_cache( const FileIndex::SIndexKey &key, const std::map<SIndexKey, int64>& cache, int64& res );
+private:
 
-	bool get_from_cache_prefer_client( const SIndexKey &key, const std::map<SIndexKey, int64>& cache, int64& res);
+	static const size_t n_cache_shards = 64;
 
-	bool get_from_cache_exact( const SIndexKey& key, const std::map<SIndexKey, int64>& cache, int64& res );
+	static FileIndexCacheShard& get_cache_shard(const SIndexKey& key);
 
-	void get_from_cache_all_clients( const SIndexKey &key, const std::map<SIndexKey, int64>& cache, std::map<int, int64> &ret );
+	static bool get_cached_prefer_client(const SIndexKey& key, int64& ret);
 
-	static std::map<SIndexKey, int64> cache_buffer_1;
-	static std::map<SIndexKey, int64> cache_buffer_2;
-	static std::map<SIndexKey, int64>* active_cache_buffer;
-	static std::map<SIndexKey, int64>* other_cache_buffer;
-	static std::map<SIndexKey, bool> del_buffer;
+	static FileIndexCacheShard cache_shards[n_cache_shards];
 	static IMutex *mutex;
 	static ICondition *cond;
 	static bool do_shutdown;
 
 	static bool do_flush;
-	static bool do_accept;
 };
\ No newline at end of file
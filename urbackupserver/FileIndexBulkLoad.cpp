@@ -0,0 +1,381 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "FileIndexBulkLoad.h"
+#include "../Interface/Server.h"
+#include "../Interface/Database.h"
+#include "../Interface/DatabaseCursor.h"
+#include "../Interface/File.h"
+#include "../Interface/ThreadPool.h"
+#include "../stringtools.h"
+#include "../urbackupcommon/os_functions.h"
+#include "serverinterface/helper.h"
+#include "server_hash.h"
+#include <algorithm>
+#include <string.h>
+
+namespace
+{
+	//Number of ids per scanned range. A range is never split over two runs,
+	//so a restarted range can be dropped from the current run
+	const int64 c_range_ids = 100000;
+	const size_t c_max_run_read_bytes = 1024 * 1024;
+	const size_t c_run_write_bytes = 16 * 1024 * 1024;
+}
+
+FileIndexBulkLoad::FileIndexBulkLoad(DATABASE_ID db_id, const std::string& tmpdir, size_t n_threads, size_t max_memory)
+	: db_id(db_id), tmpdir(tmpdir), n_threads((std::max)(static_cast<size_t>(1), n_threads)),
+	max_memory(max_memory), min_id(0), n_ranges(0), next_range(0), ranges_done(0), n_entries(0),
+	_has_error(false), mutex(Server->createMutex())
+{
+	run_entries = (std::max)(static_cast<size_t>(c_range_ids) * 2,
+		max_memory / this->n_threads / sizeof(SBulkEntry));
+}
+
+FileIndexBulkLoad::~FileIndexBulkLoad()
+{
+	for (size_t i = 0; i < run_readers.size(); ++i)
+	{
+		delete run_readers[i];
+	}
+
+	for (size_t i = 0; i < run_files.size(); ++i)
+	{
+		Server->deleteFile(run_files[i]);
+	}
+}
+
+bool FileIndexBulkLoad::sort(SStartupStatus& status)
+{
+	IDatabase* db = Server->getDatabase(Server->getThreadID(), db_id);
+	if (db == NULL)
+	{
+		Server->Log("Error opening database for sorting file entries", LL_ERROR);
+		return false;
+	}
+
+	db_results res = db->Read("SELECT MIN(id) AS min_id, MAX(id) AS max_id FROM files");
+	if (res.empty()
+		|| res[0]["min_id"].empty())
+	{
+		return start_merge();
+	}
+
+	min_id = watoi64(res[0]["min_id"]);
+	int64 max_id = watoi64(res[0]["max_id"]);
+
+	n_ranges = (max_id - min_id) / c_range_ids + 1;
+
+	os_create_dir(tmpdir);
+
+	Server->Log("Sorting file entries with " + convert(n_threads) + " threads and " + PrettyPrintBytes(max_memory) + " memory...", LL_INFO);
+
+	std::vector<THREADPOOL_TICKET> tickets;
+	for (size_t i = 0; i < n_threads; ++i)
+	{
+		tickets.push_back(Server->getThreadPool()->execute(this, "fileindex sort"));
+	}
+
+	int last_pc = -1;
+	bool done = false;
+	while (!done)
+	{
+		done = Server->getThreadPool()->waitFor(tickets, 1000);
+
+		status.processed_file_entries = static_cast<size_t>(n_entries.load());
+
+		//The sort is the first half of the file index creation
+		status.pc_done = static_cast<double>(ranges_done.load()) / n_ranges / 2;
+
+		int curr_pc = static_cast<int>(status.pc_done * 1000 + 0.5);
+		if (curr_pc != last_pc)
+		{
+			Server->Log("Creating files index: " + convert((double)curr_pc / 10) + "% finished", LL_INFO);
+			last_pc = curr_pc;
+		}
+	}
+
+	if (_has_error)
+	{
+		return false;
+	}
+
+	Server->Log("Sorted " + convert(n_entries.load()) + " file entries into " + convert(run_files.size()) + " runs", LL_INFO);
+
+	return start_merge();
+}
+
+void FileIndexBulkLoad::operator()()
+{
+	IDatabase* db = Server->getDatabase(Server->getThreadID(), db_id);
+	if (db == NULL)
+	{
+		Server->Log("Error opening database in file entry sort thread", LL_ERROR);
+		_has_error = true;
+		return;
+	}
+
+	IQuery* q_read = db->Prepare("SELECT id, shahash, filesize, clientid, created, next_entry, prev_entry, pointed_to "
+		"FROM files "
+		"WHERE id>=? AND id<? AND length(shahash)>=16 AND filesize>" + std::to_string(link_file_min_size), false);
+
+	std::vector<SBulkEntry> entries;
+	entries.reserve(run_entries);
+
+	int64 range;
+	while (!_has_error
+		&& (range = next_range++) < n_ranges)
+	{
+		if (entries.size() + c_range_ids > run_entries
+			&& !write_run(entries))
+		{
+			break;
+		}
+
+		size_t range_start_size = entries.size();
+
+		q_read->Bind(min_id + range*c_range_ids);
+		q_read->Bind(min_id + (range + 1)*c_range_ids);
+
+		IDatabaseCursor* cur = q_read->Cursor();
+
+		int c_id = cur->columnIndex("id");
+		int c_shahash = cur->columnIndex("shahash");
+		int c_filesize = cur->columnIndex("filesize");
+		int c_clientid = cur->columnIndex("clientid");
+		int c_created = cur->columnIndex("created");
+		int c_next_entry = cur->columnIndex("next_entry");
+		int c_prev_entry = cur->columnIndex("prev_entry");
+		int c_pointed_to = cur->columnIndex("pointed_to");
+
+		while (cur->next())
+		{
+			if (cur->restarted())
+			{
+				entries.resize(range_start_size);
+			}
+
+			size_t shahash_size;
+			const char* shahash = cur->getBlob(c_shahash, shahash_size);
+			if (shahash_size < bytes_in_index)
+			{
+				continue;
+			}
+
+			SBulkEntry entry;
+			entry.key = FileIndex::SIndexKey(shahash, cur->getInt64(c_filesize), cur->getInt(c_clientid));
+			entry.created = cur->getInt64(c_created);
+			entry.id = cur->getInt64(c_id);
+			entry.next_entry = cur->getInt64(c_next_entry);
+			entry.prev_entry = cur->getInt64(c_prev_entry);
+			entry.pointed_to = cur->getInt(c_pointed_to);
+			entries.push_back(entry);
+		}
+
+		if (cur->has_error())
+		{
+			_has_error = true;
+		}
+
+		cur->shutdown();
+		q_read->Reset();
+
+		n_entries += static_cast<int64>(entries.size() - range_start_size);
+		++ranges_done;
+	}
+
+	if (!_has_error
+		&& !entries.empty())
+	{
+		write_run(entries);
+	}
+
+	db->destroyQuery(q_read);
+
+	Server->destroyDatabases(Server->getThreadID());
+}
+
+bool FileIndexBulkLoad::write_run(std::vector<SBulkEntry>& entries)
+{
+	std::sort(entries.begin(), entries.end());
+
+	std::string fn;
+	{
+		IScopedLock lock(mutex.get());
+		fn = tmpdir + os_file_sep() + "sort_run_" + convert(run_files.size()) + ".tmp";
+		run_files.push_back(fn);
+	}
+
+	std::unique_ptr<IFile> file(Server->openFile(fn, MODE_WRITE));
+	if (file.get() == NULL)
+	{
+		Server->Log("Error opening sort run file " + fn + ". " + os_last_error_str(), LL_ERROR);
+		_has_error = true;
+		return false;
+	}
+
+	const char* data = reinterpret_cast<const char*>(entries.data());
+	size_t size = entries.size() * sizeof(SBulkEntry);
+	for (size_t pos = 0; pos < size; pos += c_run_write_bytes)
+	{
+		_u32 tw = static_cast<_u32>((std::min)(c_run_write_bytes, size - pos));
+		bool has_error = false;
+		if (file->Write(data + pos, tw, &has_error) != tw
+			|| has_error)
+		{
+			Server->Log("Error writing to sort run file " + fn + ". " + os_last_error_str(), LL_ERROR);
+			_has_error = true;
+			return false;
+		}
+	}
+
+	entries.clear();
+
+	return true;
+}
+
+bool FileIndexBulkLoad::start_merge()
+{
+	if (run_files.empty())
+	{
+		return true;
+	}
+
+	size_t buffer_entries = (std::max)(static_cast<size_t>(1),
+		(std::min)(max_memory / run_files.size(), c_max_run_read_bytes) / sizeof(SBulkEntry));
+
+	for (size_t i = 0; i < run_files.size(); ++i)
+	{
+		IFile* file = Server->openFile(run_files[i], MODE_READ_SEQUENTIAL);
+		if (file == NULL)
+		{
+			Server->Log("Error opening sort run file " + run_files[i] + ". " + os_last_error_str(), LL_ERROR);
+			_has_error = true;
+			return false;
+		}
+
+		run_readers.push_back(new RunReader(file, buffer_entries));
+
+		SMergeHead head;
+		head.run = i;
+		if (run_readers[i]->next(head.entry))
+		{
+			merge_heads.push(head);
+		}
+		else if (run_readers[i]->has_error())
+		{
+			_has_error = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FileIndexBulkLoad::next(LMDBFileIndex::SCreateEntry& entry)
+{
+	if (merge_heads.empty()
+		|| _has_error)
+	{
+		return false;
+	}
+
+	SMergeHead head = merge_heads.top();
+	merge_heads.pop();
+
+	entry.key = head.entry.key;
+	entry.id = head.entry.id;
+	entry.next_entry = head.entry.next_entry;
+	entry.prev_entry = head.entry.prev_entry;
+	entry.pointed_to = head.entry.pointed_to;
+
+	RunReader* reader = run_readers[head.run];
+	if (reader->next(head.entry))
+	{
+		merge_heads.push(head);
+	}
+	else if (reader->has_error())
+	{
+		_has_error = true;
+		return false;
+	}
+
+	return true;
+}
+
+int64 FileIndexBulkLoad::get_n_entries()
+{
+	return n_entries.load();
+}
+
+bool FileIndexBulkLoad::has_error()
+{
+	return _has_error;
+}
+
+FileIndexBulkLoad::RunReader::RunReader(IFile* file, size_t buffer_entries)
+	: file(file), pos(0), buffer(buffer_entries), buffer_pos(0), buffer_size(0),
+	eof(false), _has_error(false)
+{
+}
+
+bool FileIndexBulkLoad::RunReader::next(SBulkEntry& entry)
+{
+	if (buffer_pos >= buffer_size)
+	{
+		if (eof)
+		{
+			return false;
+		}
+
+		_u32 tr = static_cast<_u32>(buffer.size() * sizeof(SBulkEntry));
+		bool has_error = false;
+		_u32 read = file->Read(pos, reinterpret_cast<char*>(buffer.data()), tr, &has_error);
+
+		if (has_error
+			|| read % sizeof(SBulkEntry) != 0)
+		{
+			Server->Log("Error reading from sort run file " + file->getFilename(), LL_ERROR);
+			_has_error = true;
+			return false;
+		}
+
+		pos += read;
+		buffer_pos = 0;
+		buffer_size = read / sizeof(SBulkEntry);
+
+		if (read < tr)
+		{
+			eof = true;
+		}
+
+		if (buffer_size == 0)
+		{
+			return false;
+		}
+	}
+
+	entry = buffer[buffer_pos++];
+
+	return true;
+}
+
+bool FileIndexBulkLoad::RunReader::has_error()
+{
+	return _has_error;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "LMDBFileIndex.h"
+#include "../Interface/Thread.h"
+#include "../Interface/Mutex.h"
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+struct SStartupStatus;
+class IFile;
+
+/**
+* Sorts the files table entries of the file index for a bulk rebuild.
+* Multiple threads scan the table in id ranges, sort what they read in
+* memory and write it as sorted runs into a temporary directory. The runs
+* are then merged in file index key order (and created descending for
+* entries with the same key), so the index can be filled with MDB_APPEND.
+* Memory use is bounded by max_memory for the scan and the merge.
+*/
+class FileIndexBulkLoad : public IThread
+{
+public:
+	FileIndexBulkLoad(DATABASE_ID db_id, const std::string& tmpdir, size_t n_threads, size_t max_memory);
+	~FileIndexBulkLoad();
+
+	bool sort(SStartupStatus& status);
+
+	bool next(LMDBFileIndex::SCreateEntry& entry);
+
+	int64 get_n_entries();
+
+	bool has_error();
+
+	//Scan thread
+	void operator()();
+
+private:
+
+#pragma pack(1)
+	struct SBulkEntry
+	{
+		FileIndex::SIndexKey key;
+		int64 created;
+		int64 id;
+		int64 next_entry;
+		int64 prev_entry;
+		int pointed_to;
+
+		bool operator<(const SBulkEntry& other) const
+		{
+			if (key != other.key)
+			{
+				return key < other.key;
+			}
+			if (created != other.created)
+			{
+				return created > other.created;
+			}
+			return id < other.id;
+		}
+	};
+#pragma pack()
+
+	class RunReader
+	{
+	public:
+		RunReader(IFile* file, size_t buffer_entries);
+
+		bool next(SBulkEntry& entry);
+
+		bool has_error();
+
+	private:
+		std::unique_ptr<IFile> file;
+		int64 pos;
+		std::vector<SBulkEntry> buffer;
+		size_t buffer_pos;
+		size_t buffer_size;
+		bool eof;
+		bool _has_error;
+	};
+
+	struct SMergeHead
+	{
+		SBulkEntry entry;
+		size_t run;
+
+		bool operator<(const SMergeHead& other) const
+		{
+			//std::priority_queue returns the largest element first
+			return other.entry < entry;
+		}
+	};
+
+	bool write_run(std::vector<SBulkEntry>& entries);
+
+	bool start_merge();
+
+	DATABASE_ID db_id;
+	std::string tmpdir;
+	size_t n_threads;
+	size_t max_memory;
+	size_t run_entries;
+
+	int64 min_id;
+	int64 n_ranges;
+	std::atomic<int64> next_range;
+	std::atomic<int64> ranges_done;
+	std::atomic<int64> n_entries;
+	std::atomic<bool> _has_error;
+
+	std::unique_ptr<IMutex> mutex;
+	std::vector<std::string> run_files;
+
+	std::vector<RunReader*> run_readers;
+	std::priority_queue<SMergeHead> merge_heads;
+};
@@ -0,0 +1,418 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "FileIndexFilter.h"
+#include "../Interface/Server.h"
+#include "../stringtools.h"
+#include "../Interface/File.h"
+#include "../urbackupcommon/os_functions.h"
+#include <vector>
+#include <math.h>
+#include <algorithm>
+
+namespace
+{
+	const size_t c_block_words = 8;
+	const size_t c_block_bits = c_block_words * 64;
+	const int64 c_bits_per_entry = 10;
+	const unsigned int c_n_hashes = 7;
+	const int64 c_min_capacity = 1024 * 1024;
+	const int64 c_max_size_bytes = 1024LL * 1024 * 1024;
+	const size_t c_io_words = 128 * 1024;
+	const char c_file_magic[8] = { 'U', 'B', 'F', 'I', 'L', 'T', 'R', '1' };
+
+	struct SFilterFileHeader
+	{
+		char magic[8];
+		uint64 n_blocks;
+		int64 capacity;
+		int64 n_added;
+		int64 n_index_entries;
+		uint64 index_txnid;
+	};
+
+	uint64 mix(uint64 h)
+	{
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+	void key_hashes(const FileIndex::SIndexKey& key, uint64& h1, uint64& h2)
+	{
+		const char* hash = key.getHash();
+		uint64 a;
+		uint64 b;
+		memcpy(&a, hash, sizeof(a));
+		memcpy(&b, hash + sizeof(a), sizeof(b));
+		h1 = mix(a ^ (static_cast<uint64>(key.getFilesize()) * 0x9E3779B97F4A7C15ULL));
+		h2 = mix(b + h1);
+	}
+
+	//Bits of the key within its block, one mask per word
+	void block_masks(uint64 h2, uint64 masks[c_block_words])
+	{
+		for (size_t i = 0; i < c_block_words; ++i)
+		{
+			masks[i] = 0;
+		}
+
+		for (unsigned int i = 0; i < c_n_hashes; ++i)
+		{
+			unsigned int pos = static_cast<unsigned int>(h2 >> (i * 9)) & (c_block_bits - 1);
+			masks[pos / 64] |= 1ULL << (pos % 64);
+		}
+	}
+}
+
+std::atomic<FileIndexFilter*> FileIndexFilter::instance(NULL);
+std::atomic<FileIndexFilter*> FileIndexFilter::rebuild_instance(NULL);
+FileIndexFilter* FileIndexFilter::retired = NULL;
+std::atomic<bool> FileIndexFilter::ready(false);
+std::atomic<bool> FileIndexFilter::rebuilding(false);
+std::atomic<int64> FileIndexFilter::n_rebuilds(0);
+
+
+FileIndexFilter::FileIndexFilter(int64 p_capacity)
+	: capacity(p_capacity), n_added(0), n_filtered(0), n_passed_missing(0)
+{
+	int64 size_bytes = (capacity*c_bits_per_entry + 7) / 8;
+	size_bytes = (std::min)(size_bytes, c_max_size_bytes);
+
+	n_blocks = (std::max)(static_cast<size_t>(1),
+		static_cast<size_t>(size_bytes / (c_block_bits / 8)));
+
+	bits.reset(new std::atomic<uint64>[n_blocks*c_block_words]());
+}
+
+void FileIndexFilter::add(const FileIndex::SIndexKey& key)
+{
+	uint64 h1, h2;
+	key_hashes(key, h1, h2);
+
+	uint64 masks[c_block_words];
+	block_masks(h2, masks);
+
+	std::atomic<uint64>* block = &bits[(h1 % n_blocks)*c_block_words];
+	for (size_t i = 0; i < c_block_words; ++i)
+	{
+		if (masks[i] != 0)
+		{
+			block[i].fetch_or(masks[i], std::memory_order_relaxed);
+		}
+	}
+
+	n_added.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FileIndexFilter::may_contain(const FileIndex::SIndexKey& key) const
+{
+	uint64 h1, h2;
+	key_hashes(key, h1, h2);
+
+	uint64 masks[c_block_words];
+	block_masks(h2, masks);
+
+	const std::atomic<uint64>* block = &bits[(h1 % n_blocks)*c_block_words];
+	for (size_t i = 0; i < c_block_words; ++i)
+	{
+		if ((block[i].load(std::memory_order_relaxed) & masks[i]) != masks[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FileIndexFilter::count_lookup(bool filtered, bool found)
+{
+	if (filtered)
+	{
+		n_filtered.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if (!found)
+	{
+		n_passed_missing.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+FileIndexFilter::SStats FileIndexFilter::get_stats() const
+{
+	SStats ret;
+	ret.ready = ready.load();
+	ret.rebuilding = rebuilding.load();
+	ret.n_rebuilds = n_rebuilds.load();
+	ret.size_bytes = static_cast<int64>(n_blocks*c_block_bits / 8);
+	ret.capacity = capacity;
+	ret.n_added = n_added.load();
+	ret.n_filtered = n_filtered.load();
+	ret.n_false_positives = n_passed_missing.load();
+
+	double m = static_cast<double>(n_blocks*c_block_bits);
+	double n = static_cast<double>(ret.n_added);
+	ret.est_false_positive_rate = pow(1.0 - exp(-static_cast<double>(c_n_hashes)*n / m), static_cast<double>(c_n_hashes));
+
+	return ret;
+}
+
+int64 FileIndexFilter::capacity_for(int64 n_index_entries)
+{
+	return (std::max)(c_min_capacity, n_index_entries + n_index_entries / 2);
+}
+
+void FileIndexFilter::init(int64 n_index_entries)
+{
+	if (instance.load() != NULL)
+	{
+		return;
+	}
+
+	int64 capacity = capacity_for(n_index_entries);
+
+	FileIndexFilter* filter = new FileIndexFilter(capacity);
+	instance.store(filter);
+
+	Server->Log("File index filter: " + PrettyPrintBytes(filter->get_stats().size_bytes) + " for "
+		+ convert(capacity) + " entries (" + convert(n_index_entries) + " in index)", LL_INFO);
+}
+
+bool FileIndexFilter::load(const std::string& fn, int64 n_index_entries, uint64 index_txnid)
+{
+	if (instance.load() != NULL)
+	{
+		return false;
+	}
+
+	std::unique_ptr<IFile> f(Server->openFile(fn, MODE_READ));
+	if (f.get() == NULL)
+	{
+		return false;
+	}
+
+	SFilterFileHeader header;
+	if (f->Read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+		|| memcmp(header.magic, c_file_magic, sizeof(c_file_magic)) != 0)
+	{
+		Server->Log("File index filter at " + fn + " is invalid", LL_WARNING);
+		return false;
+	}
+
+	if (header.n_index_entries != n_index_entries
+		|| header.index_txnid != index_txnid)
+	{
+		Server->Log("File index changed since filter was saved. Building it anew.", LL_INFO);
+		return false;
+	}
+
+	std::unique_ptr<FileIndexFilter> filter(new FileIndexFilter(header.capacity));
+	if (filter->n_blocks != header.n_blocks)
+	{
+		Server->Log("File index filter at " + fn + " has wrong size", LL_WARNING);
+		return false;
+	}
+
+	size_t n_words = filter->n_blocks*c_block_words;
+	std::vector<uint64> buf;
+	for (size_t i = 0; i < n_words; i += buf.size())
+	{
+		buf.resize((std::min)(c_io_words, n_words - i));
+		_u32 tr = static_cast<_u32>(buf.size()*sizeof(uint64));
+		if (f->Read(reinterpret_cast<char*>(buf.data()), tr) != tr)
+		{
+			Server->Log("Error reading file index filter from " + fn, LL_WARNING);
+			return false;
+		}
+
+		for (size_t j = 0; j < buf.size(); ++j)
+		{
+			filter->bits[i + j].store(buf[j], std::memory_order_relaxed);
+		}
+	}
+
+	filter->n_added = header.n_added;
+
+	instance.store(filter.release());
+	ready.store(true);
+
+	Server->Log("Loaded file index filter for " + convert(n_index_entries) + " entries", LL_INFO);
+
+	return true;
+}
+
+bool FileIndexFilter::save(const std::string& fn, int64 n_index_entries, uint64 index_txnid)
+{
+	FileIndexFilter* filter = instance.load();
+	if (filter == NULL
+		|| !ready.load()
+		|| rebuilding.load())
+	{
+		return false;
+	}
+
+	std::unique_ptr<IFile> f(Server->openFile(fn + ".new", MODE_WRITE));
+	if (f.get() == NULL)
+	{
+		Server->Log("Error opening " + fn + ".new for writing file index filter", LL_WARNING);
+		return false;
+	}
+
+	SFilterFileHeader header;
+	memcpy(header.magic, c_file_magic, sizeof(c_file_magic));
+	header.n_blocks = filter->n_blocks;
+	header.capacity = filter->capacity;
+	header.n_added = filter->n_added.load();
+	header.n_index_entries = n_index_entries;
+	header.index_txnid = index_txnid;
+
+	bool ret = f->Write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+
+	size_t n_words = filter->n_blocks*c_block_words;
+	std::vector<uint64> buf;
+	for (size_t i = 0; i < n_words && ret; i += buf.size())
+	{
+		buf.resize((std::min)(c_io_words, n_words - i));
+		for (size_t j = 0; j < buf.size(); ++j)
+		{
+			buf[j] = filter->bits[i + j].load(std::memory_order_relaxed);
+		}
+
+		_u32 tw = static_cast<_u32>(buf.size()*sizeof(uint64));
+		ret = f->Write(reinterpret_cast<const char*>(buf.data()), tw) == tw;
+	}
+
+	if (ret)
+	{
+		ret = f->Sync();
+	}
+
+	f.reset();
+
+	if (!ret
+		|| !os_rename_file(fn + ".new", fn))
+	{
+		Server->Log("Error saving file index filter to " + fn, LL_WARNING);
+		Server->deleteFile(fn + ".new");
+		return false;
+	}
+
+	return true;
+}
+
+void FileIndexFilter::set_ready()
+{
+	ready.store(true);
+}
+
+void FileIndexFilter::add_entry(const FileIndex::SIndexKey& key)
+{
+	//The rebuilt filter first, so that the key is in the current filter
+	//if the rebuilt one replaces it in between (see finish_rebuild)
+	FileIndexFilter* rebuild_filter = rebuild_instance.load();
+	if (rebuild_filter != NULL)
+	{
+		rebuild_filter->add(key);
+	}
+
+	FileIndexFilter* filter = instance.load();
+	if (filter != NULL)
+	{
+		filter->add(key);
+	}
+}
+
+bool FileIndexFilter::start_rebuild()
+{
+	FileIndexFilter* filter = instance.load();
+	if (filter == NULL
+		|| !ready.load()
+		|| filter->n_added.load(std::memory_order_relaxed) <= filter->capacity)
+	{
+		return false;
+	}
+
+	bool expected = false;
+	return rebuilding.compare_exchange_strong(expected, true);
+}
+
+FileIndexFilter* FileIndexFilter::begin_rebuild(int64 n_index_entries)
+{
+	int64 capacity = capacity_for(n_index_entries);
+
+	FileIndexFilter* filter = new FileIndexFilter(capacity);
+	rebuild_instance.store(filter);
+
+	Server->Log("Rebuilding file index filter with " + PrettyPrintBytes(filter->get_stats().size_bytes) + " for "
+		+ convert(capacity) + " entries (" + convert(n_index_entries) + " in index)", LL_INFO);
+
+	return filter;
+}
+
+void FileIndexFilter::finish_rebuild(bool ok)
+{
+	FileIndexFilter* filter = rebuild_instance.load();
+
+	if (filter != NULL)
+	{
+		if (ok)
+		{
+			delete retired;
+			retired = instance.exchange(filter);
+			rebuild_instance.store(NULL);
+			++n_rebuilds;
+		}
+		else
+		{
+			rebuild_instance.store(NULL);
+			//Keys may still be added to it
+			delete retired;
+			retired = filter;
+		}
+	}
+
+	rebuilding.store(false);
+}
+
+FileIndexFilter* FileIndexFilter::get_for_add()
+{
+	return instance.load();
+}
+
+FileIndexFilter* FileIndexFilter::get_for_lookup()
+{
+	if (!ready.load())
+	{
+		return NULL;
+	}
+	return instance.load();
+}
+
+bool FileIndexFilter::get_global_stats(SStats& stats)
+{
+	FileIndexFilter* filter = instance.load();
+	if (filter == NULL)
+	{
+		return false;
+	}
+
+	stats = filter->get_stats();
+	return true;
+}
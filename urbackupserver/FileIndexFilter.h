@@ -0,0 +1,96 @@
+#pragma once
+
+#include "FileIndex.h"
+#include <atomic>
+#include <memory>
+
+/**
+* Blocked Bloom filter over hash and file size of all file index entries.
+* All bits of a key are in the same 64 byte block, so a lookup touches
+* one cache line. Entries cannot be removed. Deleted entries stay in the
+* filter until it is rebuilt. It is rebuilt with a larger capacity in the
+* background once more entries than its capacity were added, and saved on
+* shutdown so that it does not have to be built anew on the next start.
+*/
+class FileIndexFilter
+{
+public:
+	struct SStats
+	{
+		bool ready;
+		bool rebuilding;
+		int64 size_bytes;
+		int64 capacity;
+		int64 n_added;
+		double est_false_positive_rate;
+		int64 n_filtered;
+		int64 n_false_positives;
+		int64 n_rebuilds;
+	};
+
+	explicit FileIndexFilter(int64 capacity);
+
+	void add(const FileIndex::SIndexKey& key);
+
+	bool may_contain(const FileIndex::SIndexKey& key) const;
+
+	void count_lookup(bool filtered, bool found);
+
+	SStats get_stats() const;
+
+	/**
+	* Creates the filter. Entries put from then on are added to it.
+	* It is only used for lookups after set_ready().
+	*/
+	static void init(int64 n_index_entries);
+
+	/**
+	* Loads a filter saved by save() if it was saved with the same
+	* index state. The filter is ready afterwards.
+	*/
+	static bool load(const std::string& fn, int64 n_index_entries, uint64 index_txnid);
+
+	static bool save(const std::string& fn, int64 n_index_entries, uint64 index_txnid);
+
+	static void set_ready();
+
+	//Adds key to the filter and to the one being rebuilt
+	static void add_entry(const FileIndex::SIndexKey& key);
+
+	//True if the filter is over capacity and the caller should rebuild it
+	static bool start_rebuild();
+
+	//New filter to add all index entries to. Used for lookups after finish_rebuild(true)
+	static FileIndexFilter* begin_rebuild(int64 n_index_entries);
+
+	static void finish_rebuild(bool ok);
+
+	//NULL if not initialized
+	static FileIndexFilter* get_for_add();
+
+	//NULL if not initialized or not completely built yet
+	static FileIndexFilter* get_for_lookup();
+
+	static bool get_global_stats(SStats& stats);
+
+private:
+	FileIndexFilter(const FileIndexFilter&);
+	void operator=(const FileIndexFilter&);
+
+	static int64 capacity_for(int64 n_index_entries);
+
+	size_t n_blocks;
+	int64 capacity;
+	std::unique_ptr<std::atomic<uint64>[]> bits;
+	std::atomic<int64> n_added;
+	std::atomic<int64> n_filtered;
+	std::atomic<int64> n_passed_missing;
+
+	static std::atomic<FileIndexFilter*> instance;
+	static std::atomic<FileIndexFilter*> rebuild_instance;
+	//Replaced filter. Freed on the next rebuild, so lookups still using it have long finished
+	static FileIndexFilter* retired;
+	static std::atomic<bool> ready;
+	static std::atomic<bool> rebuilding;
+	static std::atomic<int64> n_rebuilds;
+};
@@ -265,7 +265,7 @@ bool FullFileBackup::doFileBackup()
 		for(size_t i=0;i<read;++i)
 		{
 			std::map<std::string, std::string> extra_params;
-			bool b=list_parser.nextEntry(buffer[i], cf, &extra_params);
+			bool b=list_parser.nextEntry(buffer, read, i, cf, &extra_params);
 			if(b)
 			{
 				FileMetadata metadata;
@@ -311,7 +311,7 @@ bool FullFileBackup::doFileBackup()
 						}
 
 						ServerStatus::setProcessQueuesize(clientname, status_id,
-							(_u32)hashpipe->getNumElements(), (_u32)hashpipe_prepare->getNumElements());
+							(_u32)hashpipe_prepare->getNumElements(), (_u32)getHashQueueSize());
 					}
 
 					if (ctime - last_eta_update > eta_update_intervall)
@@ -633,7 +633,7 @@ bool FullFileBackup::doFileBackup()
 		}
 
 		ServerStatus::setProcessQueuesize(clientname, status_id,
-			(_u32)hashpipe->getNumElements(), (_u32)hashpipe_prepare->getNumElements());
+			(_u32)hashpipe_prepare->getNumElements(), (_u32)getHashQueueSize());
 
 		int64 ctime = Server->getTimeMS();
 		if(ctime-last_eta_update>eta_update_intervall)
@@ -726,7 +726,7 @@ bool FullFileBackup::doFileBackup()
 
 		for(size_t i=0;i<read;++i)
 		{
-			bool b=list_parser.nextEntry(buffer[i], cf, NULL);
+			bool b=list_parser.nextEntry(buffer, read, i, cf, NULL);
 			if(b)
 			{
 				if(cf.isdir)
@@ -1061,6 +1061,10 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 					{
 						image_format = IFSImageFactory::ImageFormat_CompressedVHDX;
 					}
+					else if (image_file_format == image_file_format_dedup)
+					{
+						image_format = IFSImageFactory::ImageFormat_Dedup;
+					}
 					else //default
 					{
 						image_format = IFSImageFactory::ImageFormat_CompressedVHD;
@@ -1075,7 +1079,13 @@ bool ImageBackup::doImage(const std::string &pLetter, const std::string &pParent
 						goto do_image_cleanup;
 					}
 
-					if(!has_parent)
+					if (image_format == IFSImageFactory::ImageFormat_Dedup)
+					{
+						r_vhdfile = image_fak->createDedupVHDFile(os_file_prefix(imagefn), has_parent ? pParentvhd : std::string(),
+							os_file_prefix(server_settings->getSettings()->backupfolder_uncompr + os_file_sep() + image_block_store_dir),
+							drivesize + mbr_size, (unsigned int)vhd_blocksize*blocksize);
+					}
+					else if(!has_parent)
 					{
 						r_vhdfile=image_fak->createVHDFile(os_file_prefix(imagefn), false, drivesize+mbr_size,
 							(unsigned int)vhd_blocksize*blocksize, true,
@@ -2133,6 +2143,10 @@ std::string ImageBackup::constructImagePath(const std::string &letter, std::stri
 	{
 		imgpath += ".vhdxz";
 	}
+	else if (image_file_format == image_file_format_dedup)
+	{
+		imgpath += ".dedup";
+	}
 	else if(image_file_format==image_file_format_cowraw)
 	{
 		imgpath+=".raw";
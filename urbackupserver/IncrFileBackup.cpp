@@ -603,7 +603,7 @@ bool IncrFileBackup::doFileBackup()
 		for(size_t i=0;i<read;++i)
 		{
 			std::map<std::string, std::string> extra_params;
-			bool b=list_parser.nextEntry(buffer[i], cf, &extra_params);
+			bool b=list_parser.nextEntry(buffer, read, i, cf, &extra_params);
 			if(b)
 			{
 				std::string osspecific_name;
@@ -705,7 +705,7 @@ bool IncrFileBackup::doFileBackup()
 						}
 
 						ServerStatus::setProcessQueuesize(clientname, status_id,
-							(_u32)hashpipe->getNumElements(), (_u32)hashpipe_prepare->getNumElements());
+							(_u32)hashpipe_prepare->getNumElements(), (_u32)getHashQueueSize());
 					}
 
 					if (ctime - last_eta_update > eta_update_intervall)
@@ -1388,7 +1388,7 @@ bool IncrFileBackup::doFileBackup()
 		}
 
 		ServerStatus::setProcessQueuesize(clientname, status_id,
-			(_u32)hashpipe->getNumElements(), (_u32)hashpipe_prepare->getNumElements());
+			(_u32)hashpipe_prepare->getNumElements(), (_u32)getHashQueueSize());
 
 		int64 ctime = Server->getTimeMS();
 		if(ctime-last_eta_update>eta_update_intervall)
@@ -1496,7 +1496,7 @@ bool IncrFileBackup::doFileBackup()
 			for(size_t i=0;i<read;++i)
 			{
 				str_map extra_params;
-				bool b=list_parser.nextEntry(buffer[i], cf, &extra_params);
+				bool b=list_parser.nextEntry(buffer, read, i, cf, &extra_params);
 				if(b)
 				{
 					if(cf.isdir)
@@ -1928,7 +1928,7 @@ bool IncrFileBackup::deleteFilesInSnapshot(const std::string clientlist_fn, cons
 	{
 		for(size_t i=0;i<read;++i)
 		{
-			if(list_parser.nextEntry(buffer[i], curr_file, NULL))
+			if(list_parser.nextEntry(buffer, read, i, curr_file, NULL))
 			{
 				if(curr_file.isdir && curr_file.name=="..")
 				{
@@ -28,18 +28,119 @@
 #include "../Interface/Types.h"
 #include "../Interface/File.h"
 #include <memory>
+#include <algorithm>
+#include <mutex>
 #include "../Interface/Server.h"
 #include "create_files_index.h"
+#include "FileIndexFilter.h"
 
 MDB_env *LMDBFileIndex::env=NULL;
 MDB_dbi LMDBFileIndex::dbi;
 ISharedMutex* LMDBFileIndex::mutex=NULL;
 LMDBFileIndex* LMDBFileIndex::fileindex=NULL;
 THREADPOOL_TICKET LMDBFileIndex::fileindex_ticket = ILLEGAL_THREADPOOL_TICKET;
+THREADPOOL_TICKET LMDBFileIndex::filter_ticket = ILLEGAL_THREADPOOL_TICKET;
 
 
 const size_t c_initial_map_size=1*1024*1024;
 const size_t c_create_commit_n = 10000;
+const size_t c_filter_txn_entries = 100000;
+//Key, value and node header of an appended entry with some slack
+const int64 c_reserve_bytes_per_entry = 64;
+
+namespace
+{
+	const char* c_filter_fn = "urbackup/fileindex/backup_server_files_index.filter";
+
+	std::atomic<bool> filter_build_stop(false);
+	std::mutex filter_build_mutex;
+
+	class FilterBuildThread : public IThread
+	{
+	public:
+		explicit FilterBuildThread(bool rebuild)
+			: rebuild(rebuild)
+		{
+		}
+
+		virtual ~FilterBuildThread()
+		{
+		}
+
+		void operator()()
+		{
+			if (rebuild)
+			{
+				rebuild_filter();
+			}
+			else
+			{
+				build_filter();
+			}
+
+			delete this;
+		}
+
+	private:
+		void build_filter()
+		{
+			int64 starttime = Server->getTimeMS();
+
+			FileIndexFilter* filter = FileIndexFilter::get_for_add();
+
+			LMDBFileIndex fileindex;
+			if (filter!=NULL
+				&& !fileindex.has_error()
+				&& fileindex.add_to_filter(*filter, filter_build_stop))
+			{
+				FileIndexFilter::set_ready();
+
+				FileIndexFilter::SStats stats = filter->get_stats();
+				Server->Log("File index filter built in " + PrettyPrintTime(Server->getTimeMS() - starttime)
+					+ ". Estimated false positive rate: " + convert(stats.est_false_positive_rate*100.0) + "%", LL_INFO);
+			}
+			else if (!filter_build_stop.load())
+			{
+				Server->Log("Building file index filter failed. Not using filter.", LL_ERROR);
+			}
+		}
+
+		void rebuild_filter()
+		{
+			int64 starttime = Server->getTimeMS();
+
+			LMDBFileIndex fileindex;
+			if (fileindex.has_error())
+			{
+				FileIndexFilter::finish_rebuild(false);
+				return;
+			}
+
+			FileIndexFilter* filter = FileIndexFilter::begin_rebuild(fileindex.get_n_entries());
+
+			//Entries put from now on are added to the new filter. The ones put
+			//before have to be in the index before it is iterated
+			FileIndex::flush_puts();
+
+			bool ok = fileindex.add_to_filter(*filter, filter_build_stop);
+
+			FileIndexFilter::finish_rebuild(ok);
+
+			if (ok)
+			{
+				FileIndexFilter::SStats stats = filter->get_stats();
+				Server->Log("File index filter rebuilt in " + PrettyPrintTime(Server->getTimeMS() - starttime)
+					+ ". Estimated false positive rate: " + convert(stats.est_false_positive_rate*100.0) + "%", LL_INFO);
+			}
+			else if (!filter_build_stop.load())
+			{
+				Server->Log("Rebuilding file index filter failed. Keeping current filter.", LL_ERROR);
+			}
+		}
+
+		bool rebuild;
+	};
+}
 
 
 bool LMDBFileIndex::initFileIndex()
@@ -47,16 +148,64 @@ bool LMDBFileIndex::initFileIndex()
 	mutex = Server->createSharedMutex();
 
 	fileindex=new LMDBFileIndex;
+
+	bool filter_loaded = false;
+	if (!fileindex->has_error())
+	{
+		int64 n_entries = fileindex->get_n_entries();
+
+		//Saved filter is only valid for this state of the index
+		filter_loaded = FileIndexFilter::load(c_filter_fn, n_entries, fileindex->get_last_txnid());
+		Server->deleteFile(c_filter_fn);
+
+		FileIndexFilter::init(n_entries);
+	}
+
 	fileindex_ticket = Server->getThreadPool()->execute(fileindex, "fileindex writer");
 
+	if (!fileindex->has_error()
+		&& !filter_loaded)
+	{
+		filter_ticket = Server->getThreadPool()->execute(new FilterBuildThread(false), "fileindex filter");
+	}
+
 	return !fileindex->has_error();
 }
 
 
 void LMDBFileIndex::shutdownFileIndex()
 {
+	{
+		std::lock_guard<std::mutex> lock(filter_build_mutex);
+		filter_build_stop = true;
+	}
+
+	if (filter_ticket != ILLEGAL_THREADPOOL_TICKET)
+	{
+		Server->getThreadPool()->waitFor(filter_ticket);
+	}
+
 	fileindex->shutdown();
 	Server->getThreadPool()->waitFor(fileindex_ticket);
+
+	LMDBFileIndex last_state;
+	if (!last_state.has_error())
+	{
+		FileIndexFilter::save(c_filter_fn, last_state.get_n_entries(), last_state.get_last_txnid());
+	}
+}
+
+void LMDBFileIndex::start_filter_rebuild()
+{
+	std::lock_guard<std::mutex> lock(filter_build_mutex);
+
+	if (filter_build_stop.load()
+		|| !FileIndexFilter::start_rebuild())
+	{
+		return;
+	}
+
+	filter_ticket = Server->getThreadPool()->execute(new FilterBuildThread(true), "fileindex filter");
 }
 
 
@@ -110,99 +259,158 @@ void LMDBFileIndex::create(get_data_callback_t get_data_callback, void *userdata
 
 	ServerFilesDao filesdao(db);
 
-	size_t n_done=0;
 	size_t n_rows=0;
 
-	SIndexKey last;
-	int64 last_prev_entry;
-	int64 last_id;
+	SCreateState state;
 	db_results res;
 	do
 	{
-		res=get_data_callback(n_done, n_rows, userdata);
+		res=get_data_callback(state.n_done, n_rows, userdata);
 
 		++n_rows;
 
 		for(size_t i=0;i<res.size();++i)
 		{
 			const std::string& shahash=res[i]["shahash"];
-			int64 id = watoi64(res[i]["id"]);
-			SIndexKey key(reinterpret_cast<const char*>(shahash.c_str()), watoi64(res[i]["filesize"]), watoi(res[i]["clientid"]));
 
-			int64 next_entry = watoi64(res[i]["next_entry"]);
-			int64 prev_entry = watoi64(res[i]["prev_entry"]);
-			int pointed_to = watoi(res[i]["pointed_to"]);
+			SCreateEntry entry = {
+				SIndexKey(reinterpret_cast<const char*>(shahash.c_str()), watoi64(res[i]["filesize"]), watoi(res[i]["clientid"])),
+				watoi64(res[i]["id"]),
+				watoi64(res[i]["next_entry"]),
+				watoi64(res[i]["prev_entry"]),
+				watoi(res[i]["pointed_to"]) };
 
-			assert(memcmp(&last, &key, sizeof(SIndexKey))!=1);
-
-			if(key==last)
+			if(!create_entry(filesdao, entry, state))
 			{
-				if(last_prev_entry==0)
-				{
-					filesdao.setPrevEntry(id, last_id);
-				}
+				return;
+			}
+		}		
+	}
+	while(!res.empty());
 
-				if(next_entry==0
-					&& (last_prev_entry==0 || last_prev_entry==id) )
-				{
-					filesdao.setNextEntry(last_id, id);
-				}
+	commit_transaction();
+}
 
-				if(pointed_to)
-				{
-					filesdao.setPointedTo(0, id);
-				}
+void LMDBFileIndex::create_sorted(get_sorted_callback_t get_sorted_callback, void *userdata)
+{
+	begin_txn(0);
 
-				last=key;
-				last_id=id;
-				last_prev_entry=prev_entry;
+	IDatabase *db=Server->getDatabase(Server->getThreadID(), URBACKUPDB_SERVER_FILES_NEW);
 
-				continue;
-			}
-			else
-			{
-				if(!pointed_to)
-				{
-					filesdao.setPointedTo(1, id);
-				}
-			}
-			
-			put(key, id, MDB_APPEND);
+	ServerFilesDao filesdao(db);
 
-			if(_has_error)
-			{
-				Server->Log("LMDB error after putting element. Error state interrupting..", LL_ERROR);
-				return;
-			}
+	SCreateState state;
+	SCreateEntry entry;
+	while(get_sorted_callback(state.n_done, entry, userdata))
+	{
+		if(!create_entry(filesdao, entry, state))
+		{
+			return;
+		}
+	}
 
-			if(n_done % 1000 == 0 && n_done>0)
-			{
-				if ((Server->getFailBits() & IServer::FAIL_DATABASE_CORRUPTED) ||
-					(Server->getFailBits() & IServer::FAIL_DATABASE_IOERR) ||
-					(Server->getFailBits() & IServer::FAIL_DATABASE_FULL))
-				{
-					Server->Log("Database error. Stopping.", LL_ERROR);
-					return;
-				}
-				Server->Log("File entry index contains "+convert(n_done)+" entries now.", LL_INFO);
-			}
+	commit_transaction();
+}
 
-			if(n_done % c_create_commit_n == 0 && n_done>0)
-			{
-				commit_transaction();
-				begin_txn(0);
-			}
+bool LMDBFileIndex::create_entry(ServerFilesDao& filesdao, const SCreateEntry& entry, SCreateState& state)
+{
+	const SIndexKey& key = entry.key;
+	int64 id = entry.id;
 
-			++n_done;
+	assert(memcmp(&state.last, &key, sizeof(SIndexKey))!=1);
 
-			last=key;
-			last_id=id;
-			last_prev_entry=prev_entry;
-		}		
+	if(key==state.last)
+	{
+		if(state.last_prev_entry==0)
+		{
+			filesdao.setPrevEntry(id, state.last_id);
+		}
+
+		if(entry.next_entry==0
+			&& (state.last_prev_entry==0 || state.last_prev_entry==id) )
+		{
+			filesdao.setNextEntry(state.last_id, id);
+		}
+
+		if(entry.pointed_to)
+		{
+			filesdao.setPointedTo(0, id);
+		}
+
+		state.last_id=id;
+		state.last_prev_entry=entry.prev_entry;
+
+		return true;
 	}
-	while(!res.empty());
+	else
+	{
+		if(!entry.pointed_to)
+		{
+			filesdao.setPointedTo(1, id);
+		}
+	}
+	
+	put(key, id, MDB_APPEND);
 
-	commit_transaction();
+	if(_has_error)
+	{
+		Server->Log("LMDB error after putting element. Error state interrupting..", LL_ERROR);
+		return false;
+	}
+
+	if(state.n_done % 1000 == 0 && state.n_done>0)
+	{
+		if ((Server->getFailBits() & IServer::FAIL_DATABASE_CORRUPTED) ||
+			(Server->getFailBits() & IServer::FAIL_DATABASE_IOERR) ||
+			(Server->getFailBits() & IServer::FAIL_DATABASE_FULL))
+		{
+			Server->Log("Database error. Stopping.", LL_ERROR);
+			return false;
+		}
+		Server->Log("File entry index contains "+convert(state.n_done)+" entries now.", LL_INFO);
+	}
+
+	if(state.n_done % c_create_commit_n == 0 && state.n_done>0)
+	{
+		commit_transaction();
+		begin_txn(0);
+	}
+
+	++state.n_done;
+
+	state.last=key;
+	state.last_id=id;
+	state.last_prev_entry=entry.prev_entry;
+
+	return true;
+}
+
+void LMDBFileIndex::reserve(int64 n_entries)
+{
+	size_t new_map_size = map_size;
+	while(static_cast<int64>(new_map_size) < n_entries*c_reserve_bytes_per_entry)
+	{
+		new_map_size*=2;
+	}
+
+	if(new_map_size==map_size)
+	{
+		return;
+	}
+
+	IScopedWriteLock lock(mutex);
+
+	destroy_env();
+
+	map_size=new_map_size;
+
+	Server->Log("Increased LMDB database size to "+PrettyPrintBytes(map_size)+" (reserve)", LL_DEBUG);
+
+	if(!create_env())
+	{
+		Server->Log("Error creating env after database file size increase", LL_ERROR);
+		_has_error=true;
+	}
 }
 
 int64 LMDBFileIndex::get(const LMDBFileIndex::SIndexKey& key)
@@ -420,6 +628,11 @@ void LMDBFileIndex::del_internal(const SIndexKey& key, bool log, bool handle_eno
 void LMDBFileIndex::commit_transaction(void)
 {
 	commit_transaction_internal(true);
+
+	if (this == fileindex)
+	{
+		start_filter_rebuild();
+	}
 }
 
 void LMDBFileIndex::commit_transaction_internal(bool handle_enosp)
@@ -586,6 +799,95 @@ size_t LMDBFileIndex::get_map_size()
 	return map_size;
 }
 
+int64 LMDBFileIndex::get_n_entries()
+{
+	begin_txn(MDB_RDONLY);
+
+	MDB_stat stat;
+	int rc = mdb_stat(txn, dbi, &stat);
+
+	int64 ret = 0;
+	if (rc)
+	{
+		Server->Log("LMDB: Failed to get statistics (" + (std::string)mdb_strerror(rc) + ")", LL_ERROR);
+	}
+	else
+	{
+		ret = static_cast<int64>(stat.ms_entries);
+	}
+
+	abort_transaction();
+
+	return ret;
+}
+
+uint64 LMDBFileIndex::get_last_txnid()
+{
+	MDB_envinfo info;
+	int rc = mdb_env_info(env, &info);
+
+	if (rc)
+	{
+		Server->Log("LMDB: Failed to get env info (" + (std::string)mdb_strerror(rc) + ")", LL_ERROR);
+		return 0;
+	}
+
+	return static_cast<uint64>(info.me_last_txnid);
+}
+
+bool LMDBFileIndex::add_to_filter(FileIndexFilter& filter, std::atomic<bool>& do_stop)
+{
+	SIndexKey last_key;
+	int rc = 0;
+
+	//Uses a new read transaction every c_filter_txn_entries entries, so that a
+	//long running read transaction does not prevent pages from being reused
+	while (rc==0 && !_has_error)
+	{
+		if (do_stop.load())
+		{
+			return false;
+		}
+
+		begin_txn(MDB_RDONLY);
+
+		MDB_cursor* cursor;
+
+		mdb_cursor_open(txn, dbi, &cursor);
+
+		MDB_val mdb_tkey;
+		mdb_tkey.mv_data=&last_key;
+		mdb_tkey.mv_size=sizeof(SIndexKey);
+
+		MDB_val mdb_tvalue;
+
+		rc=mdb_cursor_get(cursor, &mdb_tkey, &mdb_tvalue, MDB_SET_RANGE);
+
+		size_t n=0;
+		while(rc==0 && n<c_filter_txn_entries)
+		{
+			const SIndexKey* curr_key = reinterpret_cast<const SIndexKey*>(mdb_tkey.mv_data);
+			filter.add(*curr_key);
+			last_key = *curr_key;
+			++n;
+
+			rc=mdb_cursor_get(cursor, &mdb_tkey, &mdb_tvalue, MDB_NEXT);
+		}
+
+		if(rc && rc!=MDB_NOTFOUND)
+		{
+			Server->Log("LMDB: Failed to read ("+(std::string)mdb_strerror(rc)+")", LL_ERROR);
+			_has_error=true;
+		}
+
+		mdb_cursor_close(cursor);
+
+		abort_transaction();
+	}
+
+	return !_has_error;
+}
+
 int64 LMDBFileIndex::get_any_client( const SIndexKey& key )
 {
 	begin_txn(MDB_RDONLY);
@@ -696,6 +998,56 @@ int64 LMDBFileIndex::get_prefer_client( const SIndexKey& key )
 
 	mdb_cursor_open(txn, dbi, &cursor);
 
+	int64 ret = get_prefer_client(cursor, key);
+
+	mdb_cursor_close(cursor);
+
+	abort_transaction();
+
+	return ret;
+}
+
+std::vector<int64> LMDBFileIndex::get_prefer_client_batch(const std::vector<SIndexKey>& keys)
+{
+	std::vector<int64> ret(keys.size(), 0);
+
+	if(keys.empty())
+	{
+		return ret;
+	}
+
+	std::vector<size_t> order(keys.size());
+	for(size_t i=0;i<order.size();++i)
+	{
+		order[i]=i;
+	}
+
+	std::sort(order.begin(), order.end(),
+		[&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+	begin_txn(MDB_RDONLY);
+
+	MDB_cursor* cursor;
+
+	mdb_cursor_open(txn, dbi, &cursor);
+
+	//Keys are looked up in ascending order with the same cursor. LMDB does not
+	//descend from the root again if the next key is on the current leaf page,
+	//and the pages of consecutive lookups are mostly adjacent
+	for(size_t i=0;i<order.size() && !_has_error;++i)
+	{
+		ret[order[i]] = get_prefer_client(cursor, keys[order[i]]);
+	}
+
+	mdb_cursor_close(cursor);
+
+	abort_transaction();
+
+	return ret;
+}
+
+int64 LMDBFileIndex::get_prefer_client(MDB_cursor* cursor, const SIndexKey& key)
+{
 	SIndexKey orig_key = key;
 
 	MDB_val mdb_tkey;
@@ -734,10 +1086,6 @@ int64 LMDBFileIndex::get_prefer_client( const SIndexKey& key )
 		}
 	}
 
-	mdb_cursor_close(cursor);
-
-	abort_transaction();
-
 	return ret;
 }
 
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "../Interface/Database.h"
 #include "../Interface/Types.h"
 #ifdef NO_EMBEDDED_LMDB
@@ -8,6 +10,10 @@
 #include "FileIndex.h"
 #include "../Interface/SharedMutex.h"
 #include <memory>
+#include <atomic>
+
+class FileIndexFilter;
+class ServerFilesDao;
 
 class LMDBFileIndex : public FileIndex
 {
@@ -27,12 +33,31 @@ public:
 
 	virtual void create(get_data_callback_t get_data_callback, void *userdata);
 
+	struct SCreateEntry
+	{
+		SIndexKey key;
+		int64 id;
+		int64 next_entry;
+		int64 prev_entry;
+		int pointed_to;
+	};
+
+	typedef bool(*get_sorted_callback_t)(size_t n_done, SCreateEntry& entry, void *userdata);
+
+	//Same as create, but gets typed entries which are already in index key order
+	void create_sorted(get_sorted_callback_t get_sorted_callback, void *userdata);
+
+	//Grows the map up front so that n_entries can be appended without remapping
+	void reserve(int64 n_entries);
+
 	virtual int64 get(const SIndexKey& key);
 
 	virtual int64 get_any_client(const SIndexKey& key);
 
 	virtual int64 get_prefer_client(const SIndexKey& key);
 
+	virtual std::vector<int64> get_prefer_client_batch(const std::vector<SIndexKey>& keys);
+
 	virtual std::map<int, int64> get_all_clients(const SIndexKey& key);
 
 	virtual void start_transaction(void);
@@ -54,10 +79,34 @@ public:
 	void abort_transaction();
 
 	size_t get_map_size();
+
+	int64 get_n_entries();
+
+	uint64 get_last_txnid();
+
+	bool add_to_filter(FileIndexFilter& filter, std::atomic<bool>& do_stop);
 private:
 
 	void begin_txn(unsigned int flags);
 
+	static void start_filter_rebuild();
+
+	int64 get_prefer_client(MDB_cursor* cursor, const SIndexKey& key);
+
+	struct SCreateState
+	{
+		SCreateState()
+			: last_prev_entry(0), last_id(0), n_done(0)
+		{}
+
+		SIndexKey last;
+		int64 last_prev_entry;
+		int64 last_id;
+		size_t n_done;
+	};
+
+	bool create_entry(ServerFilesDao& filesdao, const SCreateEntry& entry, SCreateState& state);
+
 	static MDB_env *env;
 	static MDB_dbi dbi;
 	size_t map_size;
@@ -89,6 +138,7 @@ private:
 	static ISharedMutex* mutex;
 	static LMDBFileIndex* fileindex;
 	static THREADPOOL_TICKET fileindex_ticket;
+	static THREADPOOL_TICKET filter_ticket;
 
 	bool no_sync;
 };
\ No newline at end of file
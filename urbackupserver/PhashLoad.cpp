@@ -10,15 +10,17 @@
 #include "server_settings.h"
 #include "database.h"
 #include "../common/data.h"
+#include <algorithm>
 
 extern std::string server_token;
 
-PhashLoad::PhashLoad(FileClient* fc,
+PhashLoad::PhashLoad(FileClient* fc, FileClient* fc_prio,
 	logid_t logid, std::string async_id)
-	: has_error(false), fc(fc),
-	logid(logid), async_id(async_id),
-	phash_file_pos(0), phash_file(NULL), eof(false),
-	has_timeout_error(false), orig_progress_log_callback(fc->getProgressLogCallback())
+	: has_error(false), has_timeout_error(false), eof(false),
+	fc(fc), logid(logid), async_id(async_id),
+	phash_file(NULL), phash_file_pos(0),
+	fc_prio(fc_prio), mutex(Server->createMutex()), max_indexed_id(-1),
+	out_of_order(fc_prio!=NULL), orig_progress_log_callback(fc->getProgressLogCallback())
 {
 }
 
@@ -82,97 +84,171 @@ void PhashLoad::operator()()
 
 bool PhashLoad::getHash(int64 file_id, std::string & hash)
 {
+	bool prio_requested = false;
+
 	while (true)
 	{
-		while (phash_file == NULL
-			|| phash_file_pos + static_cast<int64>(sizeof(_u16)) > phash_file->Size())
+		bool finished = has_error || eof;
+
+		IScopedLock lock(mutex.get());
+
+		if (!indexRecords())
+		{
+			return false;
+		}
+
+		std::map<int64, int64>::iterator it = hash_index.find(file_id);
+		if (it != hash_index.end())
 		{
-			if ((has_error || eof)
-				&& phash_file_pos + static_cast<int64>(sizeof(_u16)) > phash_file->Size())
+			bool ret = readHash(it->second, hash);
+
+			//Hashes are requested in file id order. Hashes of lower ids
+			//are not needed anymore
+			hash_index.erase(hash_index.begin(), ++it);
+
+			if (ret)
 			{
-				ServerLogger::Log(logid, "Getting parallel file hash record size of id " + convert(file_id) + " from " + phash_file->getFilename() + " failed. "
-					+ (eof ? "EOF." : "Had error."), LL_ERROR);
-				return false;
+				ServerLogger::Log(logid, "Phash for id " + convert(file_id) + " is " + base64_encode_dash(hash), LL_DEBUG);
 			}
-			Server->wait(1000);
+
+			return ret;
+		}
+
+		if (!out_of_order
+			&& max_indexed_id > file_id)
+		{
+			hash.clear();
+			ServerLogger::Log(logid, "Current parallel hash position greated than requested. " + convert(max_indexed_id) + " > " + convert(file_id), LL_ERROR);
+			return false;
+		}
+
+		if (finished)
+		{
+			ServerLogger::Log(logid, "Getting parallel file hash of id " + convert(file_id) + " from " + (phash_file!=NULL ? phash_file->getFilename() : std::string()) + " failed. "
+				+ (eof ? "EOF." : "Had error."), LL_ERROR);
+			return false;
 		}
 
+		lock.relock(NULL);
+
+		if (!prio_requested)
+		{
+			prioritize(file_id);
+			prio_requested = true;
+		}
+
+		Server->wait(out_of_order ? 50 : 1000);
+	}
+}
+
+bool PhashLoad::indexRecords()
+{
+	while (phash_file != NULL
+		&& phash_file_pos + static_cast<int64>(sizeof(_u16)) <= phash_file->Size())
+	{
 		_u16 msgsize;
 		if (phash_file->Read(phash_file_pos, reinterpret_cast<char*>(&msgsize), sizeof(msgsize)) != sizeof(msgsize))
 		{
-			ServerLogger::Log(logid, "Error reading record size (" + convert(sizeof(msgsize)) + 
+			ServerLogger::Log(logid, "Error reading record size (" + convert(sizeof(msgsize)) +
 				" bytes) from parallel hash file " + phash_file->getFilename() + ". " + os_last_error_str(), LL_ERROR);
 			return false;
 		}
 
 		msgsize = little_endian(msgsize);
 
-		while (phash_file_pos + static_cast<int64>(sizeof(_u16)) + msgsize > phash_file->Size())
+		if (phash_file_pos + static_cast<int64>(sizeof(_u16)) + msgsize > phash_file->Size())
 		{
-			if ((has_error || eof)
-				&& phash_file_pos + static_cast<int64>(sizeof(_u16)) + msgsize > phash_file->Size())
-			{
-				ServerLogger::Log(logid, "Getting parallel file hash record data of id " + convert(file_id) + " from " + phash_file->getFilename() + " failed. "
-					+ (eof ? "EOF." : "Had error."), LL_ERROR);
-				return false;
-			}
-			Server->wait(1000);
+			break;
 		}
 
 		std::string msgdata = phash_file->Read(phash_file_pos + sizeof(_u16), msgsize);
 		if (msgdata.size() != msgsize)
 		{
-			ServerLogger::Log(logid, "Error reading parallel hash file record (size "+convert(msgsize)+" read only "+convert(msgdata.size())+") "
+			ServerLogger::Log(logid, "Error reading parallel hash file record (size " + convert(msgsize) + " read only " + convert(msgdata.size()) + ") "
 				"from parallel hash file " + phash_file->getFilename() + ". " + os_last_error_str(), LL_ERROR);
 			return false;
 		}
 
-		phash_file_pos += sizeof(_u16) + msgsize;
-
 		CRData data(msgdata.data(), msgdata.size());
 		char id;
 		if (!data.getChar(&id))
 			return false;
 
-		if (id == 0)
-			continue;
+		if (id == 1)
+		{
+			int64 curr_file_id;
+			if (!data.getVarInt(&curr_file_id))
+			{
+				ServerLogger::Log(logid, "Error reading parallel hash file id", LL_ERROR);
+				return false;
+			}
 
-		if (id != 1)
+			hash_index[curr_file_id] = phash_file_pos;
+			max_indexed_id = (std::max)(max_indexed_id, curr_file_id);
+		}
+		else if (id != 0)
 		{
 			ServerLogger::Log(logid, "Unknown parallel hash file record id", LL_ERROR);
 			return false;
 		}
 
-		int64 curr_file_id;
-		if (!data.getVarInt(&curr_file_id))
-		{
-			ServerLogger::Log(logid, "Error reading parallel hash file id", LL_ERROR);
-			return false;
-		}
+		phash_file_pos += sizeof(_u16) + msgsize;
+	}
 
-		if (!data.getStr2(&hash))
-		{
-			ServerLogger::Log(logid, "Error reading parallel hash file hash", LL_ERROR);
-			return false;
-		}
+	return true;
+}
 
-		if (curr_file_id > file_id)
-		{
-			phash_file_pos -= sizeof(_u16) + msgsize;
-			hash.clear();
-			ServerLogger::Log(logid, "Current parallel hash position greated than requested. "+convert(curr_file_id)+" > "+convert(file_id), LL_ERROR);
-			return false;
-		}
-		else if (curr_file_id < file_id)
-		{
-			ServerLogger::Log(logid, "Skip phash for id " + convert(curr_file_id) + " " + base64_encode_dash(hash), LL_DEBUG);
-			hash.clear();
-			continue;
-		}
+bool PhashLoad::readHash(int64 pos, std::string & hash)
+{
+	_u16 msgsize;
+	if (phash_file->Read(pos, reinterpret_cast<char*>(&msgsize), sizeof(msgsize)) != sizeof(msgsize))
+	{
+		ServerLogger::Log(logid, "Error reading record size from parallel hash file " + phash_file->getFilename() + ". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
 
-		ServerLogger::Log(logid, "Phash for id " + convert(file_id) + " is " + base64_encode_dash(hash), LL_DEBUG);
+	msgsize = little_endian(msgsize);
 
-		return true;
+	std::string msgdata = phash_file->Read(pos + sizeof(_u16), msgsize);
+	if (msgdata.size() != msgsize)
+	{
+		ServerLogger::Log(logid, "Error reading parallel hash file record from parallel hash file " + phash_file->getFilename() + ". " + os_last_error_str(), LL_ERROR);
+		return false;
+	}
+
+	CRData data(msgdata.data(), msgdata.size());
+	char id;
+	int64 curr_file_id;
+	if (!data.getChar(&id)
+		|| !data.getVarInt(&curr_file_id))
+	{
+		return false;
+	}
+
+	if (!data.getStr2(&hash))
+	{
+		ServerLogger::Log(logid, "Error reading parallel hash file hash", LL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+void PhashLoad::prioritize(int64 file_id)
+{
+	if (fc_prio.get() == NULL)
+	{
+		return;
+	}
+
+	std::vector<int64> file_ids;
+	file_ids.push_back(file_id);
+
+	_u32 rc = fc_prio->PrioritizePhashLoad(server_token, async_id, file_ids, 0);
+	if (rc != ERR_SUCCESS)
+	{
+		ServerLogger::Log(logid, "Error requesting parallel hash of id " + convert(file_id) + " with priority: " + fc_prio->getErrorString(rc), LL_DEBUG);
+		fc_prio.reset();
 	}
 }
 
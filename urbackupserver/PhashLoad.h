@@ -3,11 +3,18 @@
 #include "../Interface/Thread.h"
 #include "server_log.h"
 #include "../urbackupcommon/fileclient/FileClient.h"
+#include "../Interface/Mutex.h"
+#include <map>
+#include <memory>
 
 class PhashLoad : public IThread
 {
 public:
+	//fc_prio is a separate connection used to ask the client to hash
+	//files the backup is waiting for first. Clients that support this
+	//send the hashes out of order
 	PhashLoad(FileClient* fc,
+		FileClient* fc_prio,
 		logid_t logid,
 		std::string async_id);
 
@@ -30,6 +37,10 @@ public:
 	}
 
 private:
+	bool indexRecords();
+	bool readHash(int64 pos, std::string& hash);
+	void prioritize(int64 file_id);
+
 	bool has_error;
 	bool has_timeout_error;
 	bool eof;
@@ -38,5 +49,11 @@ private:
 	std::string async_id;
 	IFsFile* phash_file;
 	int64 phash_file_pos;
+	std::unique_ptr<FileClient> fc_prio;
+	std::unique_ptr<IMutex> mutex;
+	//file id -> position of the hash in phash_file
+	std::map<int64, int64> hash_index;
+	int64 max_indexed_id;
+	bool out_of_order;
 	FileClient::ProgressLogCallback* orig_progress_log_callback;
 };
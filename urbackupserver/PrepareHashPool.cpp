@@ -0,0 +1,273 @@
+/*************************************************************************
+*    UrBackup - Client/Server backup system
+*    Copyright (C) 2011-2016 Martin Raiber
+*
+*    This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Affero General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "PrepareHashPool.h"
+#include "server_prepare_hash.h"
+#include "server_status.h"
+#include "../Interface/Server.h"
+#include "../urbackupcommon/os_functions.h"
+#include "../stringtools.h"
+#include <algorithm>
+
+IMutex* PrepareHashPool::mutex = NULL;
+ICondition* PrepareHashPool::cond = NULL;
+std::vector<PrepareHashQueue*> PrepareHashPool::queues;
+size_t PrepareHashPool::rr_pos = 0;
+size_t PrepareHashPool::num_workers = 0;
+
+PrepareHashQueue::PrepareHashQueue(IPipe* output, const std::vector<BackupServerPrepareHash*>& slots,
+	const std::string& clientname, size_t status_id)
+	: output(output), slots(slots), free_slots(slots), next_seq(0), next_output_seq(0),
+	exit_queued(false), finished(false), clientname(clientname), status_id(status_id)
+{
+	PrepareHashPool::addQueue(this);
+}
+
+PrepareHashQueue::~PrepareHashQueue()
+{
+	PrepareHashPool::removeQueue(this);
+
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		delete slots[i];
+	}
+}
+
+size_t PrepareHashQueue::Read(char * buffer, size_t bsize, int timeoutms)
+{
+	return 0;
+}
+
+bool PrepareHashQueue::Write(const char * buffer, size_t bsize, int timeoutms, bool flush)
+{
+	PrepareHashPool::enqueue(this, std::string(buffer, bsize));
+	return true;
+}
+
+size_t PrepareHashQueue::Read(std::string * ret, int timeoutms)
+{
+	return 0;
+}
+
+bool PrepareHashQueue::Write(const std::string & str, int timeoutms, bool flush)
+{
+	PrepareHashPool::enqueue(this, str);
+	return true;
+}
+
+bool PrepareHashQueue::Flush(int timeoutms)
+{
+	return true;
+}
+
+bool PrepareHashQueue::isWritable(int timeoutms)
+{
+	return true;
+}
+
+bool PrepareHashQueue::isReadable(int timeoutms)
+{
+	return false;
+}
+
+bool PrepareHashQueue::hasError(void)
+{
+	return false;
+}
+
+void PrepareHashQueue::shutdown(void)
+{
+}
+
+size_t PrepareHashQueue::getNumElements(void)
+{
+	IScopedLock lock(PrepareHashPool::mutex);
+	return jobs.size() + done.size();
+}
+
+size_t PrepareHashQueue::getNumWaiters()
+{
+	IScopedLock lock(PrepareHashPool::mutex);
+	return free_slots.size();
+}
+
+void PrepareHashQueue::addThrottler(IPipeThrottler * throttler)
+{
+}
+
+void PrepareHashQueue::addOutgoingThrottler(IPipeThrottler * throttler)
+{
+}
+
+void PrepareHashQueue::addIncomingThrottler(IPipeThrottler * throttler)
+{
+}
+
+_i64 PrepareHashQueue::getTransferedBytes(void)
+{
+	return 0;
+}
+
+void PrepareHashQueue::resetTransferedBytes(void)
+{
+}
+
+void PrepareHashPool::init()
+{
+	mutex = Server->createMutex();
+	cond = Server->createCondition();
+
+	num_workers = (std::max)(static_cast<size_t>(1), os_get_num_cpus());
+
+	for (size_t i = 0; i < num_workers; ++i)
+	{
+		Server->createThread(new PrepareHashPool, "fbackup hash" + convert(i));
+	}
+}
+
+size_t PrepareHashPool::getNumWorkers()
+{
+	return num_workers;
+}
+
+void PrepareHashPool::operator()()
+{
+	IScopedLock lock(mutex);
+	while (true)
+	{
+		PrepareHashQueue* queue = NULL;
+		for (size_t i = 0; i < queues.size(); ++i)
+		{
+			PrepareHashQueue* curr = queues[(rr_pos + i) % queues.size()];
+			if (!curr->jobs.empty()
+				&& !curr->free_slots.empty())
+			{
+				queue = curr;
+				rr_pos = (rr_pos + i + 1) % queues.size();
+				break;
+			}
+		}
+
+		if (queue == NULL)
+		{
+			cond->wait(&lock);
+			continue;
+		}
+
+		size_t seq = queue->jobs.front().first;
+		std::string msg;
+		msg.swap(queue->jobs.front().second);
+		queue->jobs.pop_front();
+
+		BackupServerPrepareHash* slot = queue->free_slots.back();
+		queue->free_slots.pop_back();
+
+		lock.relock(NULL);
+
+		std::string output_data;
+		slot->prepareFile(msg, output_data);
+
+		lock.relock(mutex);
+
+		queue->free_slots.push_back(slot);
+		queue->done[seq].swap(output_data);
+
+		while (!queue->done.empty()
+			&& queue->done.begin()->first == queue->next_output_seq)
+		{
+			if (!queue->done.begin()->second.empty())
+			{
+				queue->output->Write(queue->done.begin()->second);
+			}
+			queue->done.erase(queue->done.begin());
+			++queue->next_output_seq;
+		}
+
+		updateStatus(queue);
+		finishQueue(queue);
+
+		cond->notify_all();
+	}
+}
+
+void PrepareHashPool::addQueue(PrepareHashQueue * queue)
+{
+	IScopedLock lock(mutex);
+	queues.push_back(queue);
+}
+
+void PrepareHashPool::removeQueue(PrepareHashQueue * queue)
+{
+	IScopedLock lock(mutex);
+
+	while (queue->free_slots.size() < queue->slots.size())
+	{
+		cond->wait(&lock);
+	}
+
+	std::vector<PrepareHashQueue*>::iterator it = std::find(queues.begin(), queues.end(), queue);
+	if (it != queues.end())
+	{
+		queues.erase(it);
+	}
+
+	if (rr_pos >= queues.size())
+	{
+		rr_pos = 0;
+	}
+}
+
+void PrepareHashPool::enqueue(PrepareHashQueue * queue, const std::string & msg)
+{
+	IScopedLock lock(mutex);
+
+	if (msg == "flush")
+	{
+		return;
+	}
+	else if (msg == "exit")
+	{
+		queue->exit_queued = true;
+		finishQueue(queue);
+		return;
+	}
+
+	queue->jobs.push_back(std::make_pair(queue->next_seq++, msg));
+	cond->notify_all();
+}
+
+void PrepareHashPool::finishQueue(PrepareHashQueue * queue)
+{
+	if (queue->exit_queued
+		&& !queue->finished
+		&& queue->jobs.empty()
+		&& queue->free_slots.size() == queue->slots.size())
+	{
+		queue->output->Write("exit");
+		queue->finished = true;
+	}
+}
+
+void PrepareHashPool::updateStatus(PrepareHashQueue * queue)
+{
+	size_t in_flight = queue->slots.size() - queue->free_slots.size();
+
+	ServerStatus::setProcessQueuesize(queue->clientname, queue->status_id,
+		static_cast<unsigned int>(queue->jobs.size() + queue->done.size() + in_flight),
+		static_cast<unsigned int>(queue->output->getNumElements()));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../Interface/Pipe.h"
+#include "../Interface/Thread.h"
+#include "../Interface/Mutex.h"
+#include "../Interface/Condition.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+class BackupServerPrepareHash;
+
+/**
+* Prepare hash queue of one file backup. Messages written to it are hashed
+* by the server wide PrepareHashPool. Results are written to the output
+* (hash) pipe in the order the messages were written, so BackupServerHash
+* sees the files in download order. Each slot is a BackupServerPrepareHash
+* which hashes one file at a time.
+*/
+class PrepareHashQueue : public IPipe
+{
+public:
+	PrepareHashQueue(IPipe* output, const std::vector<BackupServerPrepareHash*>& slots,
+		const std::string& clientname, size_t status_id);
+	~PrepareHashQueue();
+
+	virtual size_t Read(char *buffer, size_t bsize, int timeoutms = -1);
+	virtual bool Write(const char *buffer, size_t bsize, int timeoutms = -1, bool flush = true);
+	virtual size_t Read(std::string *ret, int timeoutms = -1);
+	virtual bool Write(const std::string &str, int timeoutms = -1, bool flush = true);
+
+	virtual bool Flush(int timeoutms = -1);
+
+	virtual bool isWritable(int timeoutms = 0);
+	virtual bool isReadable(int timeoutms = 0);
+
+	virtual bool hasError(void);
+
+	virtual void shutdown(void);
+
+	//Queued messages and hashed files not yet written to the output
+	virtual size_t getNumElements(void);
+	//Idle slots
+	virtual size_t getNumWaiters();
+
+	virtual void addThrottler(IPipeThrottler *throttler);
+	virtual void addOutgoingThrottler(IPipeThrottler *throttler);
+	virtual void addIncomingThrottler(IPipeThrottler *throttler);
+
+	virtual _i64 getTransferedBytes(void);
+	virtual void resetTransferedBytes(void);
+
+private:
+	friend class PrepareHashPool;
+
+	IPipe* output;
+	std::vector<BackupServerPrepareHash*> slots;
+	std::vector<BackupServerPrepareHash*> free_slots;
+	std::deque<std::pair<size_t, std::string> > jobs;
+	std::map<size_t, std::string> done;
+	size_t next_seq;
+	size_t next_output_seq;
+	bool exit_queued;
+	bool finished;
+	std::string clientname;
+	size_t status_id;
+};
+
+/**
+* Server wide pool of hash workers, one per core. The workers take one
+* message at a time from the queues of all running file backups in
+* round robin order, so every backup gets a fair share and a single
+* large backup can use all cores.
+*/
+class PrepareHashPool : public IThread
+{
+public:
+	static void init();
+
+	//Number of slots a queue should have to use all workers
+	static size_t getNumWorkers();
+
+	void operator()();
+
+private:
+	friend class PrepareHashQueue;
+
+	static void addQueue(PrepareHashQueue* queue);
+	static void removeQueue(PrepareHashQueue* queue);
+	static void enqueue(PrepareHashQueue* queue, const std::string& msg);
+	//mutex has to be locked
+	static void finishQueue(PrepareHashQueue* queue);
+	static void updateStatus(PrepareHashQueue* queue);
+
+	static IMutex* mutex;
+	static ICondition* cond;
+	static std::vector<PrepareHashQueue*> queues;
+	static size_t rr_pos;
+	static size_t num_workers;
+};
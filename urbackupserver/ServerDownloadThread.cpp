@@ -529,6 +529,13 @@ bool ServerDownloadThread::load_file(SQueueItem todl)
 
 	int64 script_start_time = Server->getTimeSeconds()-60;
 
+	bool use_receive_hash = !todl.metadata_only && !todl.is_script;
+	if (use_receive_hash)
+	{
+		receive_hash.reset(default_hashing_method);
+		fc.setReceiveCallback(&receive_hash);
+	}
+
     _u32 rc=fc.GetFile(cfn, fd, hashed_transfer, todl.metadata_only, todl.folder_items, todl.is_script, with_metadata ? (todl.id+1) : 0);
 
 	int hash_retries=5;
@@ -541,6 +548,11 @@ bool ServerDownloadThread::load_file(SQueueItem todl)
 		--hash_retries;
 	}
 
+	if (use_receive_hash)
+	{
+		fc.setReceiveCallback(NULL);
+	}
+
 	bool ret = true;
 	bool hash_file = false;
 	bool script_ok = true;
@@ -666,11 +678,29 @@ bool ServerDownloadThread::load_file(SQueueItem todl)
 			Server->destroy(file_old);
 		}
 
-		hashFile(todl.id, dstpath, hashpath, fd, NULL, filepath_old, fd->Size(), todl.metadata, todl.is_script, todl.sha_dig, fc.releaseSparseExtendsFile(),
-			todl.is_script ? HASH_FUNC_SHA512_NO_SPARSE : default_hashing_method, fileHasSnapshot(todl));
+		IFile* sparse_extents_f = fc.releaseSparseExtendsFile();
+
+		std::string received_hash;
+		if (use_receive_hash)
+		{
+			received_hash = receive_hash.finalize(fd->Size());
+			if (rc != ERR_SUCCESS
+				|| sparse_extents_f != NULL)
+			{
+				received_hash.clear();
+			}
+		}
+
+		hashFile(todl.id, dstpath, hashpath, fd, NULL, filepath_old, fd->Size(), todl.metadata, todl.is_script, todl.sha_dig, sparse_extents_f,
+			todl.is_script ? HASH_FUNC_SHA512_NO_SPARSE : default_hashing_method, fileHasSnapshot(todl), received_hash);
 	}
 	else
 	{
+		if (use_receive_hash)
+		{
+			receive_hash.finalize(0);
+		}
+
 		if (todl.write_metadata)
 		{
 			write_file_metadata(hashpath, client_main, todl.metadata, false);
@@ -990,7 +1020,7 @@ bool ServerDownloadThread::load_file_patch(SQueueItem todl)
 
 void ServerDownloadThread::hashFile(int64 fileid, std::string dstpath, std::string hashpath, IFile *fd, IFile *hashoutput, std::string old_file,
 	int64 t_filesize, const FileMetadata& metadata, bool is_script, std::string sha_dig, IFile* sparse_extents_f, char hashing_method,
-	bool has_snapshot)
+	bool has_snapshot, const std::string& received_hash)
 {
 	int l_backup_id=backupid;
 
@@ -1017,6 +1047,7 @@ void ServerDownloadThread::hashFile(int64 fileid, std::string dstpath, std::stri
 	data.addString(sparse_extents_f!=NULL ? sparse_extents_f->getFilename() : "");
 	data.addChar(hashing_method);
 	data.addChar(has_snapshot ? 1 : 0);
+	data.addString(received_hash);
 	metadata.serialize(data);
 
 	ServerLogger::Log(logid, "GT: Loaded file \""+ExtractFileName((dstpath))+"\"", LL_DEBUG);
@@ -232,7 +232,8 @@ public:
 	bool isOffline();
 
 	void hashFile(int64 fileid, std::string dstpath, std::string hashpath, IFile *fd, IFile *hashoutput, std::string old_file, int64 t_filesize,
-		const FileMetadata& metadata, bool is_script, std::string sha_dig, IFile* sparse_extents_f, char hashing_method, bool has_snapshot);
+		const FileMetadata& metadata, bool is_script, std::string sha_dig, IFile* sparse_extents_f, char hashing_method, bool has_snapshot,
+		const std::string& received_hash = std::string());
 
 	virtual bool getQueuedFileChunked(std::string& remotefn, IFile*& orig_file, IFile*& patchfile, IFile*& chunkhashes, IFsFile*& hashoutput, _i64& predicted_filesize, int64& file_id, bool& is_script);
 
@@ -359,4 +360,6 @@ private:
 	size_t thread_idx;
 
 	ActiveDlIds& active_dls_ids;
+
+	ReceiveHash receive_hash;
 };
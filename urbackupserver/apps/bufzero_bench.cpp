@@ -0,0 +1,99 @@
+#include "../../Interface/Server.h"
+#include "../../common/buf_is_zero.h"
+#include <algorithm>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	//Byte-at-a-time check buf_is_zero replaced
+	bool buf_is_zero_bytewise(const char* buf, size_t bsize)
+	{
+		for (size_t i = 0; i < bsize; ++i)
+		{
+			if (buf[i] != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Check via memcmp against a zero buffer (punchHoleOrZero before)
+	bool buf_is_zero_memcmp(const char* buf, size_t bsize, const std::vector<char>& zero_buf)
+	{
+		return memcmp(buf, zero_buf.data(), bsize) == 0;
+	}
+
+	void log_result(const std::string& name, size_t n_bytes, int64 starttime)
+	{
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + PrettyPrintBytes(static_cast<int64>(n_bytes)) + " in " + PrettyPrintTime(passed)
+			+ " (" + PrettyPrintBytes(static_cast<int64>(n_bytes) * 1000 / passed) + "/s)", LL_INFO);
+	}
+
+	template<typename F>
+	size_t bench_check(const std::string& name, const std::vector<char>& buf, size_t bsize, size_t total_bytes, F check)
+	{
+		size_t n_zero = 0;
+		size_t n_bytes = 0;
+		int64 starttime = Server->getTimeMS();
+		for (size_t off = 0; n_bytes < total_bytes; n_bytes += bsize)
+		{
+			if (check(buf.data() + off, bsize))
+			{
+				++n_zero;
+			}
+
+			off += bsize;
+			if (off + bsize > buf.size())
+			{
+				off = 0;
+			}
+		}
+		log_result(name, n_bytes, starttime);
+		return n_zero;
+	}
+}
+
+int bufzero_bench()
+{
+	std::vector<std::string> sizes;
+	Tokenize(Server->getServerParameter("bufzero_bench_sizes", "32,4096,524288"), sizes, ",");
+	size_t total_bytes = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("bufzero_bench_bytes", "4294967296"))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("bufzero_bench_runs", "3")));
+
+	//Zero data is the worst case (whole buffer is checked)
+	std::vector<char> buf(8 * 1024 * 1024);
+	std::vector<char> zero_buf(buf.size());
+
+	Server->Log("Benchmarking zero buffer check with " + PrettyPrintBytes(static_cast<int64>(total_bytes)) + " per block size...", LL_INFO);
+
+	for (int run = 0; run < runs; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		for (size_t i = 0; i < sizes.size(); ++i)
+		{
+			size_t bsize = (std::min)(buf.size(), static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(sizes[i]))));
+			std::string prefix = PrettyPrintBytes(static_cast<int64>(bsize)) + " blocks ";
+
+			size_t n_zero = bench_check(prefix + "buf_is_zero", buf, bsize, total_bytes, [](const char* b, size_t s) {
+				return buf_is_zero(b, s); });
+			size_t n_zero_bytewise = bench_check(prefix + "bytewise", buf, bsize, total_bytes, buf_is_zero_bytewise);
+			size_t n_zero_memcmp = bench_check(prefix + "memcmp", buf, bsize, total_bytes, [&zero_buf](const char* b, size_t s) {
+				return buf_is_zero_memcmp(b, s, zero_buf); });
+
+			if (n_zero != n_zero_bytewise
+				|| n_zero != n_zero_memcmp)
+			{
+				Server->Log("Zero buffer checks returned different results", LL_ERROR);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
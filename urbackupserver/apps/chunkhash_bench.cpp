@@ -0,0 +1,221 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/File.h"
+#include "../../common/adler32.h"
+#include "../../common/md5_mb.h"
+#include "../../md5.h"
+#include "../../fileservplugin/chunk_settings.h"
+#include "../../urbackupcommon/chunk_hasher.h"
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	//Textbook Adler-32 as reference for the SIMD variants
+	unsigned int adler32_reference(const char* buf, size_t len)
+	{
+		unsigned int a = 1;
+		unsigned int b = 0;
+		for (size_t i = 0; i < len; ++i)
+		{
+			a = (a + static_cast<unsigned char>(buf[i])) % 65521;
+			b = (b + a) % 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	std::string md5_reference(const char* buf, size_t len)
+	{
+		MD5 md5;
+		md5.update(reinterpret_cast<unsigned char*>(const_cast<char*>(buf)), static_cast<unsigned int>(len));
+		md5.finalize();
+		return std::string(reinterpret_cast<char*>(md5.raw_digest_int()), big_hash_size);
+	}
+
+	//chunkhash_single_size record of a checkpoint as build_chunk_hashs writes it
+	std::string chunkhash_reference(const char* buf, size_t len)
+	{
+		std::string ret = md5_reference(buf, len);
+		for (size_t off = 0; off < len; off += c_small_hash_dist)
+		{
+			unsigned int small_hash = little_endian(adler32_reference(buf + off,
+				(std::min)(static_cast<size_t>(c_small_hash_dist), len - off)));
+			ret.append(reinterpret_cast<char*>(&small_hash), sizeof(small_hash));
+		}
+		return ret;
+	}
+
+	void log_result(const std::string& name, size_t n_bytes, int64 starttime)
+	{
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + PrettyPrintBytes(static_cast<int64>(n_bytes)) + " in " + PrettyPrintTime(passed)
+			+ " (" + PrettyPrintBytes(static_cast<int64>(n_bytes) * 1000 / passed) + "/s)", LL_INFO);
+	}
+
+	bool bench_adler32(const std::vector<char>& data)
+	{
+		const size_t n_small = c_checkpoint_dist / c_small_hash_dist;
+		std::vector<unsigned int> small_hashes(data.size() / c_small_hash_dist + 1);
+
+		int64 starttime = Server->getTimeMS();
+		for (size_t off = 0; off < data.size(); off += c_checkpoint_dist)
+		{
+			unsigned int len = static_cast<unsigned int>((std::min)(static_cast<size_t>(c_checkpoint_dist), data.size() - off));
+			urb_adler32_blocks(&data[off], len, static_cast<unsigned int>(c_small_hash_dist), &small_hashes[(off / c_checkpoint_dist)*n_small]);
+		}
+		log_result("adler32 (urb_adler32_blocks)", data.size(), starttime);
+
+		starttime = Server->getTimeMS();
+		for (size_t off = 0, i = 0; off < data.size(); off += c_small_hash_dist, ++i)
+		{
+			size_t len = (std::min)(static_cast<size_t>(c_small_hash_dist), data.size() - off);
+			if (adler32_reference(&data[off], len) != small_hashes[i])
+			{
+				Server->Log("Adler-32 of block " + convert(i) + " differs from reference", LL_ERROR);
+				return false;
+			}
+		}
+		log_result("adler32 (reference)", data.size(), starttime);
+
+		return true;
+	}
+
+	bool bench_md5(const std::vector<char>& data)
+	{
+		size_t n_checkpoints = data.size() / c_checkpoint_dist;
+		std::vector<std::string> reference(n_checkpoints);
+
+		int64 starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_checkpoints; ++i)
+		{
+			reference[i] = md5_reference(&data[i*c_checkpoint_dist], c_checkpoint_dist);
+		}
+		log_result("md5 (MD5)", n_checkpoints*c_checkpoint_dist, starttime);
+
+		size_t lanes = md5_mb_lanes();
+		std::vector<const char*> bufs(n_checkpoints);
+		std::vector<size_t> lens(n_checkpoints, static_cast<size_t>(c_checkpoint_dist));
+		std::vector<unsigned char> digests(n_checkpoints*big_hash_size);
+		for (size_t i = 0; i < n_checkpoints; ++i)
+		{
+			bufs[i] = &data[i*c_checkpoint_dist];
+		}
+
+		starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_checkpoints; i += lanes)
+		{
+			md5_mb(&bufs[i], &lens[i], (std::min)(lanes, n_checkpoints - i), &digests[i*big_hash_size]);
+		}
+		log_result("md5 (md5_mb, " + convert(lanes) + " lanes)", n_checkpoints*c_checkpoint_dist, starttime);
+
+		for (size_t i = 0; i < n_checkpoints; ++i)
+		{
+			if (memcmp(&digests[i*big_hash_size], reference[i].data(), big_hash_size) != 0)
+			{
+				Server->Log("MD5 of checkpoint " + convert(i) + " differs from reference", LL_ERROR);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool bench_build_chunk_hashs(const std::vector<char>& data)
+	{
+		std::unique_ptr<IFsFile> f(Server->openTemporaryFile());
+		std::unique_ptr<IFsFile> hashoutput(Server->openTemporaryFile());
+		if (f.get() == NULL || hashoutput.get() == NULL)
+		{
+			Server->Log("Error opening temporary file", LL_ERROR);
+			return false;
+		}
+
+		std::string fn = f->getFilename();
+		std::string hashoutput_fn = hashoutput->getFilename();
+
+		bool ret = true;
+		if (f->Write(static_cast<int64>(0), data.data(), static_cast<_u32>(data.size())) != data.size())
+		{
+			Server->Log("Error writing to temporary file", LL_ERROR);
+			ret = false;
+		}
+
+		if (ret)
+		{
+			int64 starttime = Server->getTimeMS();
+			ret = build_chunk_hashs(f.get(), hashoutput.get(), NULL, NULL, false);
+			log_result("build_chunk_hashs", data.size(), starttime);
+		}
+
+		//File size, then one record per checkpoint
+		std::string output;
+		if (ret)
+		{
+			output = hashoutput->Read(static_cast<int64>(0), static_cast<_u32>(hashoutput->Size()));
+			ret = output.size() >= sizeof(_i64);
+		}
+
+		size_t output_pos = sizeof(_i64);
+		for (size_t off = 0; ret && off < data.size(); off += c_checkpoint_dist)
+		{
+			std::string record = chunkhash_reference(&data[off], (std::min)(static_cast<size_t>(c_checkpoint_dist), data.size() - off));
+			if (output.size() < output_pos + record.size()
+				|| memcmp(&output[output_pos], record.data(), record.size()) != 0)
+			{
+				Server->Log("Chunk hash record of checkpoint " + convert(off / c_checkpoint_dist) + " differs from reference", LL_ERROR);
+				ret = false;
+			}
+			output_pos += record.size();
+		}
+
+		if (ret && output_pos != output.size())
+		{
+			Server->Log("Chunk hash output has wrong size " + convert(output.size()), LL_ERROR);
+			ret = false;
+		}
+
+		f.reset();
+		hashoutput.reset();
+		Server->deleteFile(fn);
+		Server->deleteFile(hashoutput_fn);
+
+		return ret;
+	}
+}
+
+int chunkhash_bench()
+{
+	size_t n_checkpoints = static_cast<size_t>((std::max)(1, watoi(Server->getServerParameter("chunkhash_bench_checkpoints", "256"))));
+	size_t tail_size = static_cast<size_t>((std::max)(0, watoi(Server->getServerParameter("chunkhash_bench_tail", "12345")))) % c_checkpoint_dist;
+	int runs = (std::max)(1, watoi(Server->getServerParameter("chunkhash_bench_runs", "3")));
+
+	//Checkpoints plus a partial one at the end, like most files
+	std::vector<char> data(n_checkpoints*c_checkpoint_dist + tail_size);
+	std::mt19937 rng(0);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<char>(rng());
+	}
+	//Worst case for Adler-32 overflow handling
+	memset(data.data(), 0xFF, static_cast<size_t>(c_checkpoint_dist));
+
+	Server->Log("Benchmarking chunk hashing with " + PrettyPrintBytes(static_cast<int64>(data.size())) + "...", LL_INFO);
+
+	for (int run = 0; run < runs; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		if (!bench_adler32(data)
+			|| !bench_md5(data)
+			|| !bench_build_chunk_hashs(data))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,281 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/Thread.h"
+#include "../../Interface/ThreadPool.h"
+#include "../../clouddrive/IClouddriveFactory.h"
+#include "../../clouddrive/IKvStoreBackend.h"
+#include "../../urbackupcommon/os_functions.h"
+#include "../../urbackupcommon/backup_url_parser.h"
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	enum class BenchOp
+	{
+		Put,
+		Get,
+		Del
+	};
+
+	class BenchWorker : public IThread
+	{
+	public:
+		BenchWorker(IKvStoreBackend* backend, BenchOp op, size_t thread_idx, size_t n_threads,
+			size_t n_objects, size_t obj_size)
+			: backend(backend), op(op), thread_idx(thread_idx), n_threads(n_threads),
+			n_objects(n_objects), obj_size(obj_size), has_error(false)
+		{
+		}
+
+		void operator()()
+		{
+			switch (op)
+			{
+			case BenchOp::Put: has_error = !put(); break;
+			case BenchOp::Get: has_error = !get(); break;
+			case BenchOp::Del: has_error = !del(); break;
+			}
+		}
+
+		bool get_has_error()
+		{
+			return has_error;
+		}
+
+	private:
+		bool put()
+		{
+			std::unique_ptr<IFsFile> src(Server->openTemporaryFile());
+			if (src.get() == nullptr)
+			{
+				Server->Log("Error opening temporary file", LL_ERROR);
+				return false;
+			}
+
+			std::string tmpfn = src->getFilename();
+
+			//Object data is already compressed/encrypted, the first 16 bytes are the md5sum
+			std::vector<char> data(16 + obj_size);
+			std::mt19937 rng(static_cast<unsigned int>(thread_idx));
+			for (size_t i = 16; i < data.size(); ++i)
+			{
+				data[i] = static_cast<char>(rng());
+			}
+
+			bool ret = true;
+			for (size_t i = thread_idx; i < n_objects && ret; i += n_threads)
+			{
+				memcpy(&data[16], &i, sizeof(i));
+				std::string md5 = Server->GenerateBinaryMD5(std::string(data.data() + 16, obj_size));
+				memcpy(&data[0], md5.data(), 16);
+
+				if (src->Write(0, data.data(), static_cast<_u32>(data.size())) != data.size())
+				{
+					Server->Log("Error writing to temporary file", LL_ERROR);
+					ret = false;
+					break;
+				}
+
+				std::string ret_md5sum;
+				int64 compressed_size;
+				if (!backend->put(convert(i), src.get(), IKvStoreBackend::PutAlreadyCompressedEncrypted,
+					false, ret_md5sum, compressed_size))
+				{
+					Server->Log("Error putting object " + convert(i), LL_ERROR);
+					ret = false;
+				}
+			}
+
+			src.reset();
+			Server->deleteFile(tmpfn);
+
+			return ret;
+		}
+
+		bool get()
+		{
+			std::unique_ptr<IFsFile> dst(Server->openTemporaryFile());
+			if (dst.get() == nullptr)
+			{
+				Server->Log("Error opening temporary file", LL_ERROR);
+				return false;
+			}
+
+			std::string tmpfn = dst->getFilename();
+
+			bool ret = true;
+			for (size_t i = thread_idx; i < n_objects && ret; i += n_threads)
+			{
+				dst->Seek(0);
+				std::string ret_md5sum;
+				unsigned int get_status;
+				if (!backend->get(convert(i), std::string(), 0, false, dst.get(), ret_md5sum, get_status))
+				{
+					Server->Log("Error getting object " + convert(i), LL_ERROR);
+					ret = false;
+				}
+			}
+
+			dst.reset();
+			Server->deleteFile(tmpfn);
+
+			return ret;
+		}
+
+		bool del()
+		{
+			size_t i = thread_idx;
+			return backend->del([this, &i](IKvStoreBackend::key_next_action_t action, std::string* key)
+			{
+				if (action == IKvStoreBackend::key_next_action_t::reset)
+				{
+					i = thread_idx;
+					return true;
+				}
+				else if (action == IKvStoreBackend::key_next_action_t::clear)
+				{
+					return true;
+				}
+
+				if (i >= n_objects)
+					return false;
+
+				*key = convert(i);
+				i += n_threads;
+				return true;
+			}, false);
+		}
+
+		IKvStoreBackend* backend;
+		BenchOp op;
+		size_t thread_idx;
+		size_t n_threads;
+		size_t n_objects;
+		size_t obj_size;
+		bool has_error;
+	};
+
+	bool run_op(IKvStoreBackend* backend, BenchOp op, const std::string& name, size_t n_threads,
+		size_t n_objects, size_t obj_size)
+	{
+		std::vector<std::unique_ptr<BenchWorker> > workers;
+		std::vector<THREADPOOL_TICKET> tickets;
+
+		int64 starttime = Server->getTimeMS();
+
+		for (size_t i = 0; i < n_threads; ++i)
+		{
+			workers.push_back(std::unique_ptr<BenchWorker>(new BenchWorker(backend, op, i, n_threads, n_objects, obj_size)));
+			tickets.push_back(Server->getThreadPool()->execute(workers.back().get(), "clouddrive bench"));
+		}
+
+		Server->getThreadPool()->waitFor(tickets);
+
+		bool ret = true;
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			if (workers[i]->get_has_error())
+			{
+				ret = false;
+			}
+		}
+
+		if (op != BenchOp::Get
+			&& !backend->sync(false, false))
+		{
+			Server->Log("Error syncing backend after " + name, LL_ERROR);
+			ret = false;
+		}
+
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		std::string bytes_info;
+		if (op != BenchOp::Del)
+		{
+			bytes_info = ", " + PrettyPrintBytes(static_cast<int64>(n_objects * obj_size) * 1000 / passed) + "/s";
+		}
+
+		Server->Log(name + ": " + convert(n_objects) + " objects in " + PrettyPrintTime(passed)
+			+ " (" + convert(static_cast<int64>(n_objects) * 1000 / passed) + " objects/s" + bytes_info + ")", LL_INFO);
+
+		return ret;
+	}
+}
+
+int clouddrive_bench()
+{
+	std::string path = Server->getServerParameter("clouddrive_bench_dir", "clouddrive_bench");
+	std::string url = Server->getServerParameter("clouddrive_bench_url");
+	size_t n_objects = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("clouddrive_bench_objects", "10000"))));
+	size_t obj_size = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("clouddrive_bench_object_size", "262144"))));
+	size_t n_threads = static_cast<size_t>((std::max)(1, watoi(Server->getServerParameter("clouddrive_bench_threads", "8"))));
+	size_t n_del_parallel = static_cast<size_t>((std::max)(1, watoi(Server->getServerParameter("clouddrive_bench_del_parallel", "4"))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("clouddrive_bench_runs", "3")));
+
+	str_map params;
+	IClouddriveFactory* clouddrive_fak = reinterpret_cast<IClouddriveFactory*>(Server->getPlugin(Server->getThreadID(), Server->StartPlugin("clouddriveplugin", params)));
+	if (clouddrive_fak == nullptr)
+	{
+		Server->Log("Error loading clouddriveplugin", LL_ERROR);
+		return 1;
+	}
+
+	IClouddriveFactory::CloudSettings settings;
+	if (!url.empty())
+	{
+		//e.g. a local S3 compatible server: s3://access_key:secret_key@localhost:9000/bucket
+		str_map secret_params;
+		ParseParamStrHttp(Server->getServerParameter("clouddrive_bench_secret_params"), &secret_params);
+
+		if (!parse_backup_url(url, Server->getServerParameter("clouddrive_bench_url_params"), secret_params, settings))
+		{
+			Server->Log("Error parsing url " + url, LL_ERROR);
+			return 1;
+		}
+	}
+	else
+	{
+		settings.endpoint = IClouddriveFactory::CloudEndpoint::Dir;
+		settings.dir_settings.path = path;
+		settings.dir_settings.num_del_parallel = n_del_parallel;
+		url = "dir://" + path;
+	}
+
+	std::unique_ptr<IKvStoreBackend> backend(clouddrive_fak->createBackend(nullptr, settings));
+	if (!backend)
+	{
+		Server->Log("Error creating backend for " + url, LL_ERROR);
+		return 1;
+	}
+
+	Server->Log("Benchmarking " + convert(n_objects) + " objects of " + PrettyPrintBytes(obj_size)
+		+ " with " + convert(n_threads) + " threads at " + url + "...", LL_INFO);
+
+	int rc = 0;
+	for (int run = 0; run < runs && rc == 0; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		//Deletes are split over num_del_parallel() workers the same way the frontend does
+		if (!run_op(backend.get(), BenchOp::Put, "put", n_threads, n_objects, obj_size)
+			|| !run_op(backend.get(), BenchOp::Get, "get", n_threads, n_objects, obj_size)
+			|| !run_op(backend.get(), BenchOp::Del, "del", backend->num_del_parallel(), n_objects, obj_size))
+		{
+			rc = 1;
+		}
+	}
+
+	backend.reset();
+
+	if (settings.endpoint == IClouddriveFactory::CloudEndpoint::Dir)
+	{
+		os_remove_nonempty_dir(path);
+	}
+
+	return rc;
+}
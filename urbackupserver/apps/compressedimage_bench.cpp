@@ -0,0 +1,172 @@
+#include "../../Interface/Server.h"
+#include "../../fsimageplugin/IFSImageFactory.h"
+#include "../../fsimageplugin/IVHDFile.h"
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	const unsigned int bench_sector_size = 4096;
+
+	void fill_sector(char* buf, int64 sector)
+	{
+		//Compressible, but each sector is distinct so reads can be verified
+		memset(buf, static_cast<char>(sector % 251), bench_sector_size);
+		memcpy(buf, &sector, sizeof(sector));
+	}
+
+	bool create_image(IFSImageFactory* image_fak, const std::string& fn, int64 size)
+	{
+		std::unique_ptr<IVHDFile> vhd(image_fak->createVHDFile(fn, false, size,
+			2 * 1024 * 1024, true, IFSImageFactory::ImageFormat_CompressedVHD));
+
+		if (vhd.get() == nullptr
+			|| !vhd->isOpen())
+		{
+			Server->Log("Error creating compressed image " + fn, LL_ERROR);
+			return false;
+		}
+
+		const size_t sectors_per_write = 512;
+		std::vector<char> buf(sectors_per_write*bench_sector_size);
+
+		for (int64 pos = 0; pos < size; pos += buf.size())
+		{
+			_u32 tw = static_cast<_u32>((std::min)(static_cast<int64>(buf.size()), size - pos));
+			for (_u32 i = 0; i < tw; i += bench_sector_size)
+			{
+				fill_sector(buf.data() + i, (pos + i) / bench_sector_size);
+			}
+
+			bool has_error = false;
+			if (!vhd->Seek(pos)
+				|| vhd->Write(buf.data(), tw, &has_error) != tw
+				|| has_error)
+			{
+				Server->Log("Error writing to compressed image at " + convert(pos), LL_ERROR);
+				return false;
+			}
+		}
+
+		if (!vhd->finish())
+		{
+			Server->Log("Error finishing compressed image", LL_ERROR);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool run_bench(const std::string& name, IVHDFile* vhd, int64 n_sectors, int64 working_set,
+		size_t n_reads, unsigned int seed)
+	{
+		std::mt19937_64 rng(seed);
+		std::vector<char> buf(bench_sector_size);
+
+		int64 region_start = 0;
+
+		int64 starttime = Server->getTimeMS();
+
+		for (size_t i = 0; i < n_reads; ++i)
+		{
+			if (i % 1024 == 0)
+			{
+				region_start = static_cast<int64>(rng() % static_cast<uint64>(n_sectors - working_set + 1));
+			}
+
+			int64 sector = region_start + static_cast<int64>(rng() % static_cast<uint64>(working_set));
+
+			size_t read = 0;
+			if (!vhd->Seek(sector*bench_sector_size)
+				|| !vhd->Read(buf.data(), bench_sector_size, read)
+				|| read != bench_sector_size)
+			{
+				Server->Log(name + ": Error reading sector " + convert(sector), LL_ERROR);
+				return false;
+			}
+
+			int64 got;
+			memcpy(&got, buf.data(), sizeof(got));
+			if (got != sector)
+			{
+				Server->Log(name + ": Wrong data in sector " + convert(sector), LL_ERROR);
+				return false;
+			}
+		}
+
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + convert(n_reads) + " reads in " + PrettyPrintTime(passed)
+			+ " (" + convert(static_cast<int64>(n_reads) * 1000 / passed) + " reads/s, "
+			+ PrettyPrintBytes(static_cast<int64>(n_reads)*bench_sector_size * 1000 / passed) + "/s)", LL_INFO);
+
+		return true;
+	}
+}
+
+int compressedimage_bench()
+{
+	std::string fn = Server->getServerParameter("img_bench_file", "compressedimage_bench.vhdz");
+	int64 size = (std::max)(static_cast<int64>(16 * 1024 * 1024), watoi64(Server->getServerParameter("img_bench_size", "1073741824")));
+	size_t n_reads = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("img_bench_reads", "200000"))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("img_bench_runs", "3")));
+
+	size -= size % bench_sector_size;
+
+	str_map params;
+	IFSImageFactory* image_fak = reinterpret_cast<IFSImageFactory*>(Server->getPlugin(Server->getThreadID(), Server->StartPlugin("fsimageplugin", params)));
+	if (image_fak == nullptr)
+	{
+		Server->Log("Error loading fsimageplugin", LL_ERROR);
+		return 1;
+	}
+
+	Server->Log("Creating compressed image " + fn + " of size " + PrettyPrintBytes(size) + "...", LL_INFO);
+
+	if (!create_image(image_fak, fn, size))
+	{
+		Server->deleteFile(fn);
+		return 1;
+	}
+
+	std::unique_ptr<IVHDFile> vhd(image_fak->createVHDFile(fn, true, 0,
+		2 * 1024 * 1024, false, IFSImageFactory::ImageFormat_CompressedVHD));
+
+	if (vhd.get() == nullptr
+		|| !vhd->isOpen())
+	{
+		Server->Log("Error opening compressed image " + fn, LL_ERROR);
+		Server->deleteFile(fn);
+		return 1;
+	}
+
+	int64 n_sectors = size / bench_sector_size;
+
+	int rc = 0;
+	for (int run = 0; run < runs && rc == 0; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		//Uniformly random reads mostly miss the cache and measure decompression
+		if (!run_bench("Random reads", vhd.get(), n_sectors, n_sectors, n_reads, run))
+		{
+			rc = 1;
+		}
+		//Random reads within a few cache blocks measure the cache lookup
+		else if (!run_bench("Random reads (8MB working set)", vhd.get(), n_sectors,
+			(std::min)(n_sectors, static_cast<int64>(8 * 1024 * 1024 / bench_sector_size)), n_reads, run))
+		{
+			rc = 1;
+		}
+	}
+
+	vhd.reset();
+
+	Server->deleteFile(fn);
+
+	return rc;
+}
@@ -0,0 +1,137 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/File.h"
+#include <memory>
+#include <algorithm>
+#include "../../stringtools.h"
+#include "../../urbackupcommon/filelist_utils.h"
+
+namespace
+{
+	void write_synthetic_filelist(IFile* f, size_t n_files)
+	{
+		std::string buf;
+		for (size_t i = 0; i < n_files; ++i)
+		{
+			if (i % 100 == 0)
+			{
+				buf += "d\"directory" + convert(i) + "\" 0 1500000000\n";
+			}
+
+			buf += "f\"file_" + convert(i) + ".dat\" " + convert(i * 4096) + " " + convert(1500000000 + i);
+			if (i % 10 == 0)
+			{
+				buf += "#sym_target=target" + convert(i);
+			}
+			buf += "\n";
+
+			if (i % 100 == 99 || i + 1 == n_files)
+			{
+				buf += "u\n";
+			}
+
+			if (buf.size() > 1024 * 1024)
+			{
+				writeFileRepeat(f, buf);
+				buf.clear();
+			}
+		}
+		writeFileRepeat(f, buf);
+	}
+
+	bool parse_filelist(IFile* f, bool block_parse, size_t& n_entries)
+	{
+		FileListParser list_parser;
+		SFile cf;
+		std::vector<char> buffer(4096);
+		_u32 read;
+		n_entries = 0;
+
+		f->Seek(0);
+		bool has_read_error = false;
+		while ((read = f->Read(buffer.data(), static_cast<_u32>(buffer.size()), &has_read_error)) > 0)
+		{
+			if (has_read_error)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < read; ++i)
+			{
+				std::map<std::string, std::string> extra_params;
+				bool b = block_parse ? list_parser.nextEntry(buffer.data(), read, i, cf, &extra_params)
+					: list_parser.nextEntry(buffer[i], cf, &extra_params);
+				if (b)
+				{
+					++n_entries;
+				}
+			}
+		}
+
+		return !has_read_error;
+	}
+}
+
+int filelist_parse_bench()
+{
+	std::string filelist_fn = Server->getServerParameter("filelist");
+	int runs = (std::max)(1, watoi(Server->getServerParameter("filelist_runs", "3")));
+
+	std::unique_ptr<IFile> f;
+	bool is_tmp = false;
+	if (!filelist_fn.empty())
+	{
+		f.reset(Server->openFile(filelist_fn, MODE_READ_SEQUENTIAL));
+		if (f.get() == NULL)
+		{
+			Server->Log("Error opening file list \"" + filelist_fn + "\". " + os_last_error_str(), LL_ERROR);
+			return 1;
+		}
+	}
+	else
+	{
+		f.reset(Server->openTemporaryFile());
+		if (f.get() == NULL)
+		{
+			Server->Log("Error opening temporary file", LL_ERROR);
+			return 1;
+		}
+		is_tmp = true;
+
+		size_t n_files = watoi64(Server->getServerParameter("filelist_files", "1000000"));
+		Server->Log("Writing synthetic file list with " + convert(n_files) + " files...", LL_INFO);
+		write_synthetic_filelist(f.get(), n_files);
+	}
+
+	int64 fsize = f->Size();
+	Server->Log("File list size: " + PrettyPrintBytes(fsize), LL_INFO);
+
+	int rc = 0;
+	for (int run = 0; run < runs && rc == 0; ++run)
+	{
+		for (int block_parse = 0; block_parse < 2; ++block_parse)
+		{
+			size_t n_entries;
+			int64 starttime = Server->getTimeMS();
+			if (!parse_filelist(f.get(), block_parse != 0, n_entries))
+			{
+				Server->Log("Error reading file list", LL_ERROR);
+				rc = 1;
+				break;
+			}
+			int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+			Server->Log("Run " + convert(run + 1) + (block_parse ? " (block)" : " (per character)")
+				+ ": " + convert(n_entries) + " entries in " + PrettyPrintTime(passed)
+				+ " (" + PrettyPrintBytes(fsize * 1000 / passed) + "/s)", LL_INFO);
+		}
+	}
+
+	if (is_tmp)
+	{
+		std::string tmp_fn = f->getFilename();
+		f.reset();
+		Server->deleteFile(tmp_fn);
+	}
+
+	return rc;
+}
@@ -0,0 +1,262 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/Database.h"
+#include "../../Interface/Query.h"
+#include "../dao/ServerFilesDao.h"
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	const DATABASE_ID FILESDAO_BENCH_DB = 90;
+
+	bool create_tables(IDatabase* db, int64 n_files, size_t n_stats)
+	{
+		if (!db->Write("CREATE TABLE files (id INTEGER PRIMARY KEY, backupid INTEGER, fullpath TEXT, hashpath TEXT, shahash BLOB, "
+				"filesize INTEGER, rsize INTEGER, clientid INTEGER, incremental INTEGER, next_entry INTEGER, prev_entry INTEGER, pointed_to INTEGER)")
+			|| !db->Write("CREATE TABLE files_incoming_stat (id INTEGER PRIMARY KEY, filesize INTEGER, clientid INTEGER, backupid INTEGER, "
+				"existing_clients TEXT, direction INTEGER, incremental INTEGER, incremental_ref INTEGER, hashpath TEXT, shahash BLOB)") )
+		{
+			Server->Log("Error creating tables", LL_ERROR);
+			return false;
+		}
+
+		IQuery* q_add_file = db->Prepare("INSERT INTO files (id, backupid, fullpath, hashpath, shahash, filesize, rsize, clientid, incremental, next_entry, prev_entry, pointed_to) "
+			"VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", false);
+		IQuery* q_add_stat = db->Prepare("INSERT INTO files_incoming_stat (filesize, clientid, backupid, existing_clients, direction, incremental) "
+			"VALUES (?, ?, ?, ?, ?, ?)", false);
+
+		std::string shahash(64, 'a');
+
+		db->BeginWriteTransaction();
+
+		for (int64 i = 1; i <= n_files; ++i)
+		{
+			std::string fullpath = "/media/backup/client" + convert(i % 16) + "/240101-0000/dir" + convert(i / 1000) + "/file" + convert(i);
+			memcpy(&shahash[0], &i, sizeof(i));
+
+			q_add_file->Bind(i);
+			q_add_file->Bind(static_cast<int>(i % 100));
+			q_add_file->Bind(fullpath);
+			q_add_file->Bind(fullpath + ".hash");
+			q_add_file->Bind(shahash.data(), static_cast<_u32>(shahash.size()));
+			q_add_file->Bind(i * 4096);
+			q_add_file->Bind(i * 4096);
+			q_add_file->Bind(static_cast<int>(i % 16));
+			q_add_file->Bind(static_cast<int>(i % 10));
+			q_add_file->Bind(i + 1);
+			q_add_file->Bind(i - 1);
+			q_add_file->Bind(0);
+			q_add_file->Write();
+			q_add_file->Reset();
+		}
+
+		for (size_t i = 0; i < n_stats; ++i)
+		{
+			q_add_stat->Bind(static_cast<int64>(i) * 4096);
+			q_add_stat->Bind(static_cast<int>(i % 16));
+			q_add_stat->Bind(static_cast<int>(i % 100));
+			q_add_stat->Bind(std::string("1,2,3"));
+			q_add_stat->Bind(static_cast<int>(i % 2));
+			q_add_stat->Bind(static_cast<int>(i % 10));
+			q_add_stat->Write();
+			q_add_stat->Reset();
+		}
+
+		db->EndTransaction();
+
+		db->destroyQuery(q_add_file);
+		db->destroyQuery(q_add_stat);
+
+		return true;
+	}
+
+	//Row handling of the DAOs before they read typed columns from the cursor
+	ServerFilesDao::SFindFileEntry getFileEntryRead(IQuery* q, int64 id)
+	{
+		q->Bind(id);
+		db_results res = q->Read();
+		q->Reset();
+		ServerFilesDao::SFindFileEntry ret = { false, 0, "", 0, 0, "", "", 0, 0, 0, 0, 0, 0 };
+		if (!res.empty())
+		{
+			ret.exists = true;
+			ret.id = watoi64(res[0]["id"]);
+			ret.shahash = res[0]["shahash"];
+			ret.backupid = watoi(res[0]["backupid"]);
+			ret.clientid = watoi(res[0]["clientid"]);
+			ret.fullpath = res[0]["fullpath"];
+			ret.hashpath = res[0]["hashpath"];
+			ret.filesize = watoi64(res[0]["filesize"]);
+			ret.next_entry = watoi64(res[0]["next_entry"]);
+			ret.prev_entry = watoi64(res[0]["prev_entry"]);
+			ret.rsize = watoi64(res[0]["rsize"]);
+			ret.incremental = watoi(res[0]["incremental"]);
+			ret.pointed_to = watoi(res[0]["pointed_to"]);
+		}
+		return ret;
+	}
+
+	std::vector<ServerFilesDao::SIncomingStat> getIncomingStatsRead(IQuery* q)
+	{
+		db_results res = q->Read();
+		std::vector<ServerFilesDao::SIncomingStat> ret;
+		ret.resize(res.size());
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			ret[i].id = watoi64(res[i]["id"]);
+			ret[i].filesize = watoi64(res[i]["filesize"]);
+			ret[i].clientid = watoi(res[i]["clientid"]);
+			ret[i].backupid = watoi(res[i]["backupid"]);
+			ret[i].existing_clients = res[i]["existing_clients"];
+			ret[i].direction = watoi(res[i]["direction"]);
+			ret[i].incremental = watoi(res[i]["incremental"]);
+		}
+		return ret;
+	}
+
+	void log_result(const std::string& name, size_t n_ops, int64 n_rows, int64 starttime)
+	{
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + convert(n_ops) + " queries in " + PrettyPrintTime(passed)
+			+ " (" + convert(static_cast<int64>(n_ops) * 1000 / passed) + " queries/s, "
+			+ convert(n_rows * 1000 / passed) + " rows/s)", LL_INFO);
+	}
+
+	bool bench_lookups(IDatabase* db, ServerFilesDao& filesdao, int64 n_files, size_t n_lookups, unsigned int seed)
+	{
+		IQuery* q = db->Prepare("SELECT id, shahash, backupid, clientid, fullpath, hashpath, filesize, next_entry, prev_entry, rsize, incremental, pointed_to FROM files WHERE id=?", false);
+
+		std::mt19937_64 rng(seed);
+		int64 starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_lookups; ++i)
+		{
+			int64 id = 1 + static_cast<int64>(rng() % static_cast<uint64>(n_files));
+			ServerFilesDao::SFindFileEntry entry = getFileEntryRead(q, id);
+			if (!entry.exists || entry.id != id)
+			{
+				Server->Log("Wrong file entry for id " + convert(id) + " (Read)", LL_ERROR);
+				db->destroyQuery(q);
+				return false;
+			}
+		}
+		log_result("getFileEntry (Read)", n_lookups, n_lookups, starttime);
+
+		db->destroyQuery(q);
+
+		rng.seed(seed);
+		starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_lookups; ++i)
+		{
+			int64 id = 1 + static_cast<int64>(rng() % static_cast<uint64>(n_files));
+			ServerFilesDao::SFindFileEntry entry = filesdao.getFileEntry(id);
+			if (!entry.exists || entry.id != id)
+			{
+				Server->Log("Wrong file entry for id " + convert(id) + " (Cursor)", LL_ERROR);
+				return false;
+			}
+		}
+		log_result("getFileEntry (Cursor)", n_lookups, n_lookups, starttime);
+
+		return true;
+	}
+
+	bool bench_scans(IDatabase* db, ServerFilesDao& filesdao, size_t n_stats, size_t n_scans)
+	{
+		size_t expected = (std::min)(n_stats, static_cast<size_t>(10000));
+
+		IQuery* q = db->Prepare("SELECT id, filesize, clientid, backupid, existing_clients, direction, incremental FROM files_incoming_stat LIMIT 10000", false);
+
+		int64 rows = 0;
+		int64 starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_scans; ++i)
+		{
+			std::vector<ServerFilesDao::SIncomingStat> stats = getIncomingStatsRead(q);
+			if (stats.size() != expected)
+			{
+				Server->Log("Wrong number of incoming stats (Read)", LL_ERROR);
+				db->destroyQuery(q);
+				return false;
+			}
+			rows += stats.size();
+		}
+		log_result("getIncomingStats (Read)", n_scans, rows, starttime);
+
+		db->destroyQuery(q);
+
+		rows = 0;
+		starttime = Server->getTimeMS();
+		for (size_t i = 0; i < n_scans; ++i)
+		{
+			std::vector<ServerFilesDao::SIncomingStat> stats = filesdao.getIncomingStats();
+			if (stats.size() != expected)
+			{
+				Server->Log("Wrong number of incoming stats (Cursor)", LL_ERROR);
+				return false;
+			}
+			rows += stats.size();
+		}
+		log_result("getIncomingStats (Cursor)", n_scans, rows, starttime);
+
+		return true;
+	}
+}
+
+int filesdao_bench()
+{
+	std::string fn = Server->getServerParameter("filesdao_bench_file", "filesdao_bench.db");
+	int64 n_files = (std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("filesdao_bench_files", "1000000")));
+	size_t n_stats = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("filesdao_bench_stats", "10000"))));
+	size_t n_lookups = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("filesdao_bench_lookups", "500000"))));
+	size_t n_scans = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("filesdao_bench_scans", "100"))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("filesdao_bench_runs", "3")));
+
+	Server->deleteFile(fn);
+
+	if (!Server->openDatabase(fn, FILESDAO_BENCH_DB))
+	{
+		Server->Log("Error opening database " + fn, LL_ERROR);
+		return 1;
+	}
+
+	IDatabase* db = Server->getDatabase(Server->getThreadID(), FILESDAO_BENCH_DB);
+	if (db == nullptr)
+	{
+		Server->Log("Error getting database " + fn, LL_ERROR);
+		return 1;
+	}
+
+	Server->Log("Creating " + convert(n_files) + " file entries in " + fn + "...", LL_INFO);
+
+	int rc = 0;
+	if (!create_tables(db, n_files, n_stats))
+	{
+		rc = 1;
+	}
+
+	if (rc == 0)
+	{
+		std::unique_ptr<ServerFilesDao> filesdao(new ServerFilesDao(db));
+
+		for (int run = 0; run < runs && rc == 0; ++run)
+		{
+			Server->Log("Run " + convert(run + 1), LL_INFO);
+
+			if (!bench_lookups(db, *filesdao, n_files, n_lookups, run)
+				|| !bench_scans(db, *filesdao, n_stats, n_scans))
+			{
+				rc = 1;
+			}
+		}
+	}
+
+	Server->destroyDatabases(Server->getThreadID());
+
+	Server->deleteFile(fn);
+
+	return rc;
+}
@@ -0,0 +1,136 @@
+#include "../../Interface/Server.h"
+#include "../../clouddrive/KvStoreCacheTypes.h"
+#include "../../common/lrucache.h"
+#include "../../common/hash_lrucache.h"
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	//Cache keys like the ones CloudFile uses for its blocks
+	std::string make_key(int64 idx)
+	{
+		std::string ret;
+		ret.resize(sizeof(idx));
+		memcpy(&ret[0], &idx, sizeof(idx));
+		return ret;
+	}
+
+	void log_result(const std::string& name, size_t n_ops, int64 starttime)
+	{
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + convert(n_ops) + " operations in " + PrettyPrintTime(passed)
+			+ " (" + convert(static_cast<int64>(n_ops) * 1000 / passed) + " operations/s)", LL_INFO);
+	}
+
+	template<typename C, typename F>
+	bool bench_cache(const std::string& name, const std::vector<std::string>& keys,
+		size_t n_lookups, size_t n_churn, unsigned int seed)
+	{
+		std::unique_ptr<C> lru_cache(new C);
+		std::unique_ptr<F> fd_cache(new F);
+
+		int64 starttime = Server->getTimeMS();
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			lru_cache->put(keys[i], SKvCacheVal());
+		}
+		log_result(name + " fill", keys.size(), starttime);
+
+		//Cache hit path of TransactionalKvStore::get: fd cache lookup, then
+		//lru cache lookup moving the item to the front
+		std::mt19937_64 rng(seed);
+		starttime = Server->getTimeMS();
+		size_t n_hits = 0;
+		for (size_t i = 0; i < n_lookups; ++i)
+		{
+			const std::string& key = keys[rng() % keys.size()];
+			if (fd_cache->get(key) == nullptr)
+			{
+				SKvCacheVal* val = lru_cache->get(key);
+				if (val != nullptr)
+				{
+					val->dirty = true;
+					++n_hits;
+				}
+			}
+		}
+		log_result(name + " hit", n_lookups, starttime);
+
+		if (n_hits != n_lookups)
+		{
+			Server->Log(name + ": Expected " + convert(n_lookups) + " hits. Got " + convert(n_hits), LL_ERROR);
+			return false;
+		}
+
+		//Eviction walk with second chances, then replacing items
+		starttime = Server->getTimeMS();
+		auto evict_it = lru_cache->eviction_iterator_start();
+		--evict_it;
+		for (size_t i = 0; i < n_churn; ++i)
+		{
+			auto evict_it_prev = evict_it;
+			--evict_it;
+			if ((i % 4) == 0)
+			{
+				lru_cache->bring_to_front(evict_it_prev);
+			}
+		}
+		int64 next_key = static_cast<int64>(keys.size());
+		for (size_t i = 0; i < n_churn; ++i)
+		{
+			lru_cache->evict_one();
+			lru_cache->put(make_key(next_key++), SKvCacheVal());
+		}
+		log_result(name + " eviction", n_churn * 2, starttime);
+
+		if (lru_cache->size() != keys.size())
+		{
+			Server->Log(name + ": Wrong cache size " + convert(lru_cache->size()), LL_ERROR);
+			return false;
+		}
+
+		starttime = Server->getTimeMS();
+		lru_cache.reset();
+		log_result(name + " free", keys.size(), starttime);
+
+		return true;
+	}
+}
+
+int kvcache_bench()
+{
+	size_t n_keys = static_cast<size_t>((std::max)(static_cast<int64>(1000), watoi64(Server->getServerParameter("kvcache_bench_keys", "2000000"))));
+	size_t n_lookups = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("kvcache_bench_lookups", "10000000"))));
+	size_t n_churn = (std::min)(n_keys / 2, static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("kvcache_bench_churn", "500000")))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("kvcache_bench_runs", "3")));
+
+	std::vector<std::string> keys;
+	keys.reserve(n_keys);
+	for (size_t i = 0; i < n_keys; ++i)
+	{
+		keys.push_back(make_key(static_cast<int64>(i)));
+	}
+
+	Server->Log("Benchmarking cache with " + convert(n_keys) + " keys...", LL_INFO);
+
+	for (int run = 0; run < runs; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		if (!bench_cache<common::lrucache<std::string, SKvCacheVal>,
+				common::lrucache<std::string, SFdKey> >("lrucache", keys, n_lookups, n_churn, run)
+			|| !bench_cache<common::hash_lrucache<std::string, SKvCacheVal>,
+				common::hash_lrucache<std::string, SFdKey> >("hash_lrucache", keys, n_lookups, n_churn, run))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
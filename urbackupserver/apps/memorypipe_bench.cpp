@@ -0,0 +1,115 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/Pipe.h"
+#include "../../Interface/Thread.h"
+#include "../../Interface/ThreadPool.h"
+#include <memory>
+#include <algorithm>
+#include "../../stringtools.h"
+
+namespace
+{
+	class PipeBenchWriter : public IThread
+	{
+	public:
+		PipeBenchWriter(IPipe* pipe, size_t n_msgs, size_t msg_size, size_t flush_every)
+			: pipe(pipe), n_msgs(n_msgs), msg_size(msg_size), flush_every(flush_every)
+		{}
+
+		void operator()()
+		{
+			std::string msg(msg_size, 'a');
+			for (size_t i = 0; i < n_msgs; ++i)
+			{
+				msg[0] = static_cast<char>(i);
+				bool flush = (i + 1) % flush_every == 0 || i + 1 == n_msgs;
+				pipe->Write(msg.data(), msg.size(), -1, flush);
+			}
+		}
+
+	private:
+		IPipe* pipe;
+		size_t n_msgs;
+		size_t msg_size;
+		size_t flush_every;
+	};
+
+	bool run_bench(const std::string& name, IPipe* pipe, size_t n_msgs, size_t msg_size, size_t flush_every)
+	{
+		PipeBenchWriter writer(pipe, n_msgs, msg_size, flush_every);
+
+		int64 starttime = Server->getTimeMS();
+		THREADPOOL_TICKET ticket = Server->getThreadPool()->execute(&writer, "pipe bench");
+
+		std::string msg;
+		size_t n_read = 0;
+		bool ok = true;
+		for (; n_read < n_msgs; ++n_read)
+		{
+			size_t rc = pipe->Read(&msg, 60000);
+			if (rc != msg_size
+				|| msg[0] != static_cast<char>(n_read))
+			{
+				ok = false;
+				break;
+			}
+		}
+
+		if (!ok)
+		{
+			pipe->shutdown();
+		}
+
+		Server->getThreadPool()->waitFor(ticket);
+
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		if (!ok)
+		{
+			Server->Log(name + ": Wrong message " + convert(n_read), LL_ERROR);
+			return false;
+		}
+
+		Server->Log(name + ": " + convert(n_msgs) + " messages in " + PrettyPrintTime(passed)
+			+ " (" + convert(static_cast<int64>(n_msgs) * 1000 / passed) + " messages/s, "
+			+ PrettyPrintBytes(static_cast<int64>(n_msgs*msg_size) * 1000 / passed) + "/s)", LL_INFO);
+
+		return true;
+	}
+}
+
+int memorypipe_bench()
+{
+	size_t n_msgs = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("pipe_msgs", "2000000"))));
+	size_t msg_size = static_cast<size_t>((std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("pipe_msg_size", "256"))));
+	size_t ring_size = static_cast<size_t>(watoi64(Server->getServerParameter("pipe_ring_size", "1048576")));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("pipe_runs", "3")));
+
+	Server->Log("Message size: " + PrettyPrintBytes(msg_size) + " Ring size: " + PrettyPrintBytes(ring_size), LL_INFO);
+	Server->Log("The queue pipe allocates each message on write. The ring pipe copies it into the ring buffer and "
+		"Read(std::string*) reuses the capacity of the string, so it does not allocate per message.", LL_INFO);
+
+	for (int run = 0; run < runs; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		std::unique_ptr<IPipe> queue_pipe(Server->createMemoryPipe());
+		if (!run_bench("Queue pipe", queue_pipe.get(), n_msgs, msg_size, 1))
+		{
+			return 1;
+		}
+
+		std::unique_ptr<IPipe> ring_pipe(Server->createMemoryPipe(IServer::MemoryPipeType_SpscRing, ring_size));
+		if (!run_bench("Ring pipe", ring_pipe.get(), n_msgs, msg_size, 1))
+		{
+			return 1;
+		}
+
+		ring_pipe.reset(Server->createMemoryPipe(IServer::MemoryPipeType_SpscRing, ring_size));
+		if (!run_bench("Ring pipe (flush every 64 messages)", ring_pipe.get(), n_msgs, msg_size, 64))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
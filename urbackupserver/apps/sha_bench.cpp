@@ -0,0 +1,166 @@
+#include "../../Interface/Server.h"
+#include "../../urbackupcommon/sha2/sha2.h"
+#include "../../urbackupcommon/TreeHash.h"
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string.h>
+#include "../../stringtools.h"
+
+namespace
+{
+	//FIPS 180-2 test vectors
+	const char* sha256_abc = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+	const char* sha512_abc = "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+		"2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f";
+	const char* sha256_million_a = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+	const char* sha512_million_a = "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+		"de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b";
+
+	void log_result(const std::string& name, size_t n_bytes, int64 starttime)
+	{
+		int64 passed = (std::max)(static_cast<int64>(1), Server->getTimeMS() - starttime);
+
+		Server->Log(name + ": " + PrettyPrintBytes(static_cast<int64>(n_bytes)) + " in " + PrettyPrintTime(passed)
+			+ " (" + PrettyPrintBytes(static_cast<int64>(n_bytes) * 1000 / passed) + "/s)", LL_INFO);
+	}
+
+	//Hashes data in pieces of piece_size bytes, so buffered and direct
+	//block paths of the update functions both get exercised
+	std::string sha256_pieces(const unsigned char* data, size_t len, size_t piece_size)
+	{
+		sha256_ctx ctx;
+		sha256_init(&ctx);
+		for (size_t off = 0; off < len; off += piece_size)
+		{
+			sha256_update(&ctx, data + off, static_cast<unsigned int>((std::min)(piece_size, len - off)));
+		}
+		unsigned char digest[SHA256_DIGEST_SIZE];
+		sha256_final(&ctx, digest);
+		return bytesToHex(digest, SHA256_DIGEST_SIZE);
+	}
+
+	std::string sha512_pieces(const unsigned char* data, size_t len, size_t piece_size)
+	{
+		sha512_ctx ctx;
+		sha512_init(&ctx);
+		for (size_t off = 0; off < len; off += piece_size)
+		{
+			sha512_update(&ctx, data + off, static_cast<unsigned int>((std::min)(piece_size, len - off)));
+		}
+		unsigned char digest[SHA512_DIGEST_SIZE];
+		sha512_final(&ctx, digest);
+		return bytesToHex(digest, SHA512_DIGEST_SIZE);
+	}
+
+	bool check_digest(const std::string& name, const std::string& digest, const std::string& expected)
+	{
+		if (digest != expected)
+		{
+			Server->Log(name + " is " + digest + ", expected " + expected, LL_ERROR);
+			return false;
+		}
+		return true;
+	}
+
+	bool verify_test_vectors()
+	{
+		const unsigned char* abc = reinterpret_cast<const unsigned char*>("abc");
+		std::vector<unsigned char> million_a(1000000, 'a');
+
+		unsigned char digest[SHA512_DIGEST_SIZE];
+		sha256(abc, 3, digest);
+		if (!check_digest("sha256(\"abc\")", bytesToHex(digest, SHA256_DIGEST_SIZE), sha256_abc))
+			return false;
+		sha512(abc, 3, digest);
+		if (!check_digest("sha512(\"abc\")", bytesToHex(digest, SHA512_DIGEST_SIZE), sha512_abc))
+			return false;
+
+		const size_t piece_sizes[] = { 1, 63, 64, 127, 128, 4097, million_a.size() };
+		for (size_t i = 0; i < sizeof(piece_sizes) / sizeof(piece_sizes[0]); ++i)
+		{
+			if (!check_digest("sha256 of a million 'a' in pieces of " + convert(piece_sizes[i]),
+				sha256_pieces(million_a.data(), million_a.size(), piece_sizes[i]), sha256_million_a))
+				return false;
+			if (!check_digest("sha512 of a million 'a' in pieces of " + convert(piece_sizes[i]),
+				sha512_pieces(million_a.data(), million_a.size(), piece_sizes[i]), sha512_million_a))
+				return false;
+		}
+
+		return true;
+	}
+
+	void bench_hash_func(const std::string& name, IHashFunc& hash_func, const std::vector<char>& data, size_t piece_size)
+	{
+		int64 starttime = Server->getTimeMS();
+		for (size_t off = 0; off < data.size(); off += piece_size)
+		{
+			hash_func.hash(&data[off], static_cast<_u32>((std::min)(piece_size, data.size() - off)));
+		}
+		hash_func.finalize();
+		log_result(name, data.size(), starttime);
+	}
+
+	bool bench(const std::vector<char>& data, size_t piece_size)
+	{
+		const unsigned char* udata = reinterpret_cast<const unsigned char*>(data.data());
+
+		int64 starttime = Server->getTimeMS();
+		std::string sha256_whole = sha256_pieces(udata, data.size(), data.size());
+		log_result("sha256", data.size(), starttime);
+
+		starttime = Server->getTimeMS();
+		std::string sha512_whole = sha512_pieces(udata, data.size(), data.size());
+		log_result("sha512", data.size(), starttime);
+
+		if (!check_digest("sha256 in pieces of " + convert(piece_size), sha256_pieces(udata, data.size(), piece_size), sha256_whole)
+			|| !check_digest("sha512 in pieces of " + convert(piece_size), sha512_pieces(udata, data.size(), piece_size), sha512_whole))
+		{
+			return false;
+		}
+
+		//The IHashFunc implementations ParallelHash and the server use per sha_version
+		HashSha256 hash_sha256;
+		bench_hash_func("HashSha256 (sha_version 256)", hash_sha256, data, piece_size);
+		HashSha512 hash_sha512;
+		bench_hash_func("HashSha512 (sha_version 512)", hash_sha512, data, piece_size);
+		TreeHash tree_hash(NULL);
+		bench_hash_func("TreeHash (sha_version 528)", tree_hash, data, piece_size);
+
+		return true;
+	}
+}
+
+int sha_bench()
+{
+	int64 n_bytes = (std::max)(static_cast<int64>(1), watoi64(Server->getServerParameter("sha_bench_bytes", "268435456")));
+	size_t piece_size = static_cast<size_t>((std::max)(1, watoi(Server->getServerParameter("sha_bench_piece_size", "32768"))));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("sha_bench_runs", "3")));
+
+	if (!verify_test_vectors())
+	{
+		return 1;
+	}
+
+	std::vector<char> data(static_cast<size_t>(n_bytes));
+	std::mt19937 rng(0);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<char>(rng());
+	}
+
+	Server->Log("Benchmarking SHA on one core with " + PrettyPrintBytes(n_bytes) + " in pieces of " + PrettyPrintBytes(static_cast<int64>(piece_size)) + "...", LL_INFO);
+
+	for (int run = 0; run < runs; ++run)
+	{
+		Server->Log("Run " + convert(run + 1), LL_INFO);
+
+		if (!bench(data, piece_size))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include "../../Interface/Server.h"
+#include "../../Interface/File.h"
+#include <memory>
+#include <algorithm>
+#include "../../stringtools.h"
+#include "../../urbackupcommon/filelist_utils.h"
+#include "../treediff/TreeDiff.h"
+#include "../treediff/TreeReader.h"
+
+namespace
+{
+	const size_t c_files_per_dir = 100;
+	const size_t c_dirs_per_dir = 100;
+
+	std::string pad_num(size_t n)
+	{
+		std::string ret = convert(n);
+		while (ret.size() < 3)
+		{
+			ret = "0" + ret;
+		}
+		return ret;
+	}
+
+	class ListWriter
+	{
+	public:
+		ListWriter(IFile* f)
+			: f(f)
+		{}
+
+		~ListWriter()
+		{
+			flush();
+		}
+
+		void dir(const std::string& name, int64 last_modified)
+		{
+			buf += "d\"" + name + "\" 0 " + convert(last_modified) + "\n";
+			check_flush();
+		}
+
+		void up()
+		{
+			buf += "u\n";
+			check_flush();
+		}
+
+		void file(const std::string& name, int64 size, int64 last_modified)
+		{
+			buf += "f\"" + name + "\" " + convert(size) + " " + convert(last_modified) + "\n";
+			check_flush();
+		}
+
+		void flush()
+		{
+			writeFileRepeat(f, buf);
+			buf.clear();
+		}
+
+	private:
+		void check_flush()
+		{
+			if (buf.size() > 1024 * 1024)
+			{
+				flush();
+			}
+		}
+
+		IFile* f;
+		std::string buf;
+	};
+
+	/**
+	* Writes a synthetic file list with n_files files in two directory levels.
+	* If change_mod is not zero every change_mod'th file gets a new last modified
+	* time, every (change_mod*2)'th file is removed and a new file is added
+	* in the same directory.
+	*/
+	void write_synthetic_list(IFile* f, size_t n_files, size_t change_mod)
+	{
+		ListWriter w(f);
+		size_t n = 0;
+		for (size_t top = 0; n < n_files; ++top)
+		{
+			w.dir("dir" + convert(top), 1000);
+
+			for (size_t sub = 0; sub < c_dirs_per_dir && n < n_files; ++sub)
+			{
+				w.dir("sub" + pad_num(sub), 1000);
+
+				for (size_t i = 0; i < c_files_per_dir && n < n_files; ++i, ++n)
+				{
+					std::string name = "file" + pad_num(i) + ".dat";
+					if (change_mod == 0)
+					{
+						w.file(name, n * 4096, 1000);
+					}
+					else if (n % (change_mod * 2) == 0)
+					{
+						w.file(name + "_new", n * 4096, 2000);
+					}
+					else
+					{
+						w.file(name, n * 4096, n % change_mod == 0 ? 2000 : 1000);
+					}
+				}
+
+				w.up();
+			}
+
+			w.up();
+		}
+	}
+}
+
+int treediff_bench()
+{
+	size_t n_files = watoi64(Server->getServerParameter("treediff_files", "1000000"));
+	int change_percent = watoi(Server->getServerParameter("treediff_change_percent", "1"));
+	int runs = (std::max)(1, watoi(Server->getServerParameter("treediff_runs", "3")));
+
+	std::unique_ptr<IFile> t1(Server->openTemporaryFile());
+	std::unique_ptr<IFile> t2(Server->openTemporaryFile());
+	if (t1.get() == NULL || t2.get() == NULL)
+	{
+		Server->Log("Error opening temporary files", LL_ERROR);
+		return 1;
+	}
+
+	std::string t1_fn = t1->getFilename();
+	std::string t2_fn = t2->getFilename();
+
+	Server->Log("Writing synthetic file lists with " + convert(n_files) + " files...", LL_INFO);
+	write_synthetic_list(t1.get(), n_files, 0);
+	write_synthetic_list(t2.get(), n_files, change_percent > 0 ? (100 / (std::min)(100, change_percent)) : 0);
+
+	Server->Log("File list size: " + PrettyPrintBytes(t1->Size()), LL_INFO);
+
+	int rc = 0;
+	for (int run = 0; run < runs; ++run)
+	{
+		int64 starttime = Server->getTimeMS();
+		TreeReader reader;
+		if (!reader.readTree(t1.get()))
+		{
+			Server->Log("Error reading tree", LL_ERROR);
+			rc = 1;
+			break;
+		}
+		int64 read_time = Server->getTimeMS() - starttime;
+
+		Server->Log("Run " + convert(run + 1) + ": readTree took " + PrettyPrintTime(read_time)
+			+ " nodes=" + convert(reader.getNodes().size())
+			+ " names=" + convert(reader.getNames().size())
+			+ " memory=" + PrettyPrintBytes(reader.getMemoryUsage()), LL_INFO);
+
+		std::vector<size_t> deleted_ids;
+		std::vector<size_t> large_unchanged_subtrees;
+		std::vector<size_t> modified_inplace_ids;
+		std::vector<size_t> dir_diffs;
+		std::vector<size_t> deleted_inplace_ids;
+		bool error = false;
+
+		starttime = Server->getTimeMS();
+		std::vector<size_t> diffs = TreeDiff::diffTrees(t1.get(), t2.get(), error, &deleted_ids,
+			&large_unchanged_subtrees, &modified_inplace_ids, dir_diffs, &deleted_inplace_ids,
+			true, false);
+		int64 diff_time = Server->getTimeMS() - starttime;
+
+		if (error)
+		{
+			Server->Log("Error diffing trees", LL_ERROR);
+			rc = 1;
+			break;
+		}
+
+		Server->Log("Run " + convert(run + 1) + ": diffTrees took " + PrettyPrintTime(diff_time)
+			+ " diffs=" + convert(diffs.size())
+			+ " deleted=" + convert(deleted_ids.size())
+			+ " modified_inplace=" + convert(modified_inplace_ids.size())
+			+ " large_unchanged_subtrees=" + convert(large_unchanged_subtrees.size()), LL_INFO);
+	}
+
+	t1.reset();
+	t2.reset();
+	Server->deleteFile(t1_fn);
+	Server->deleteFile(t2_fn);
+
+	return rc;
+}
@@ -276,6 +276,15 @@ void read_config_file(std::string fn, std::vector<std::string>& real_args)
 				real_args.push_back(strlower(val));
 			}
 		}
+		if (settings->getValue("LOG_ASYNC", &val))
+		{
+			val = trim(unquote_value(val));
+
+			if (strlower(val) == "true")
+			{
+				real_args.push_back("--log_async");
+			}
+		}
 		if (settings->getValue("SQLITE_MMAP_HUGE", &val))
 		{
 			val = trim(unquote_value(val));
@@ -23,6 +23,7 @@
 #include "database.h"
 #include "server_settings.h"
 #include "LMDBFileIndex.h"
+#include "FileIndexBulkLoad.h"
 #include "../stringtools.h"
 #include "../urbackupcommon/os_functions.h"
 #include "serverinterface/helper.h"
@@ -32,6 +33,7 @@
 namespace
 {
 const size_t sqlite_data_allocation_chunk_size = 50 * 1024 * 1024; //50MB
+const int64 bulk_load_min_files = 1000000;
 
 struct SCallbackData
 {
@@ -72,7 +74,86 @@ db_results create_callback(size_t n_done, size_t n_rows, void *userdata)
 	return ret;
 }
 
-bool create_files_index_common(FileIndex& fileindex, SStartupStatus& status)
+struct SSortedCallbackData
+{
+	FileIndexBulkLoad* bulk_load;
+	int64 n_read;
+	SStartupStatus* status;
+};
+
+bool sorted_create_callback(size_t n_done, LMDBFileIndex::SCreateEntry& entry, void *userdata)
+{
+	SSortedCallbackData *data=(SSortedCallbackData*)userdata;
+
+	data->status->processed_file_entries=n_done;
+
+	int64 n_entries = data->bulk_load->get_n_entries();
+	if(n_entries>0
+		&& data->n_read % 10000 == 0)
+	{
+		int last_pc = static_cast<int>(data->status->pc_done*1000 + 0.5);
+
+		//Sorting was the first half
+		data->status->pc_done = 0.5 + static_cast<double>(data->n_read)/n_entries/2;
+
+		int curr_pc = static_cast<int>(data->status->pc_done*1000 + 0.5);
+
+		if(curr_pc!=last_pc)
+		{
+			Server->Log("Creating files index: "+convert((double)curr_pc/10)+"% finished", LL_INFO);
+		}
+	}
+
+	++data->n_read;
+
+	return data->bulk_load->next(entry);
+}
+
+bool use_bulk_load(int64 n_files)
+{
+	std::string bulk_load = Server->getServerParameter("files_index_bulk_load", "auto");
+	if(bulk_load=="auto")
+	{
+		return n_files>=bulk_load_min_files;
+	}
+	return bulk_load=="true";
+}
+
+bool create_files_index_bulk(LMDBFileIndex& fileindex, SStartupStatus& status, IDatabase* db_files_new)
+{
+	size_t n_threads = static_cast<size_t>(watoi(Server->getServerParameter("files_index_bulk_threads", convert(os_get_num_cpus()))));
+	size_t max_memory = static_cast<size_t>(watoi64(Server->getServerParameter("files_index_bulk_memory", "1073741824")));
+
+	FileIndexBulkLoad bulk_load(URBACKUPDB_SERVER_FILES, "urbackup/fileindex/sort",
+		n_threads, (std::max)(max_memory, static_cast<size_t>(64*1024*1024)));
+
+	if(!bulk_load.sort(status))
+	{
+		Server->Log("Sorting file entries failed", LL_ERROR);
+		return false;
+	}
+
+	fileindex.reserve(bulk_load.get_n_entries());
+
+	if(fileindex.has_error())
+	{
+		return false;
+	}
+
+	SSortedCallbackData data;
+	data.bulk_load=&bulk_load;
+	data.n_read=0;
+	data.status=&status;
+
+	{
+		DBScopedWriteTransaction write_transaction(db_files_new);
+		fileindex.create_sorted(sorted_create_callback, &data);
+	}
+
+	return !bulk_load.has_error();
+}
+
+bool create_files_index_common(LMDBFileIndex& fileindex, SStartupStatus& status)
 {
 	Server->destroyAllDatabases();
 
@@ -163,20 +244,30 @@ bool create_files_index_common(FileIndex& fileindex, SStartupStatus& status)
 
 	Server->Log("Starting creating files index...", LL_INFO);
 
-	IQuery *q_read=db->Prepare("SELECT id, shahash, filesize, clientid, next_entry, prev_entry, pointed_to "
-		"FROM files "
-		"WHERE length(shahash)>=16 AND filesize>"+std::to_string(link_file_min_size)+" "
-		"ORDER BY shahash ASC, filesize ASC, clientid ASC, created DESC");
+	bool has_error = false;
+	if(use_bulk_load(n_files))
+	{
+		has_error = !create_files_index_bulk(fileindex, status, db_files_new);
+	}
+	else
+	{
+		IQuery *q_read=db->Prepare("SELECT id, shahash, filesize, clientid, next_entry, prev_entry, pointed_to "
+			"FROM files "
+			"WHERE length(shahash)>=16 AND filesize>"+std::to_string(link_file_min_size)+" "
+			"ORDER BY shahash ASC, filesize ASC, clientid ASC, created DESC");
 
-	SCallbackData data;
-	data.cur=q_read->Cursor();
-	data.pos=0;
-	data.max_pos=n_files;
-	data.status=&status;
+		SCallbackData data;
+		data.cur=q_read->Cursor();
+		data.pos=0;
+		data.max_pos=n_files;
+		data.status=&status;
 
-	{
-		DBScopedWriteTransaction write_transaction(db_files_new);
-		fileindex.create(create_callback, &data);
+		{
+			DBScopedWriteTransaction write_transaction(db_files_new);
+			fileindex.create(create_callback, &data);
+		}
+
+		has_error = data.cur->has_error();
 	}
 
 	if(fileindex.has_error())
@@ -185,7 +276,7 @@ bool create_files_index_common(FileIndex& fileindex, SStartupStatus& status)
 	}
 	else
 	{
-		if (data.cur->has_error())
+		if (has_error)
 		{
 			return false;
 		}
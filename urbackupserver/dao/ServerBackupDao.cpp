@@ -18,6 +18,7 @@
 
 #include "ServerBackupDao.h"
 #include "../../stringtools.h"
+#include "../../Interface/DatabaseCursor.h"
 #include <assert.h>
 #include <string.h>
 
@@ -72,13 +73,18 @@ std::vector<std::string> ServerBackupDao::getOldBackupfolders(void)
 	{
 		q_getOldBackupfolders=db->Prepare("SELECT backupfolder FROM settings_db.old_backupfolders", false);
 	}
-	db_results res=q_getOldBackupfolders->Read();
+	IDatabaseCursor* cur=q_getOldBackupfolders->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_backupfolder=cur->columnIndex("backupfolder");
+	while(cur->next())
 	{
-		ret[i]=res[i]["backupfolder"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_backupfolder));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -95,13 +101,18 @@ std::vector<std::string> ServerBackupDao::getDeletePendingClientNames(void)
 	{
 		q_getDeletePendingClientNames=db->Prepare("SELECT name FROM clients WHERE delete_pending=1", false);
 	}
-	db_results res=q_getDeletePendingClientNames->Read();
+	IDatabaseCursor* cur=q_getDeletePendingClientNames->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_name=cur->columnIndex("name");
+	while(cur->next())
 	{
-		ret[i]=res[i]["name"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_name));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -119,14 +130,15 @@ ServerBackupDao::CondString ServerBackupDao::getGroupName(int groupid)
 		q_getGroupName=db->Prepare("SELECT name FROM settings_db.si_client_groups WHERE id=?", false);
 	}
 	q_getGroupName->Bind(groupid);
-	db_results res=q_getGroupName->Read();
-	q_getGroupName->Reset();
+	IDatabaseCursor* cur=q_getGroupName->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["name"];
+		ret.value=cur->getString(cur->columnIndex("name"));
 	}
+	cur->shutdown();
+	q_getGroupName->Reset();
 	return ret;
 }
 
@@ -144,14 +156,15 @@ ServerBackupDao::CondInt ServerBackupDao::getClientGroup(int clientid)
 		q_getClientGroup=db->Prepare("SELECT groupid FROM clients WHERE id=?", false);
 	}
 	q_getClientGroup->Bind(clientid);
-	db_results res=q_getClientGroup->Read();
-	q_getClientGroup->Reset();
+	IDatabaseCursor* cur=q_getClientGroup->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["groupid"]);
+		ret.value=cur->getInt(cur->columnIndex("groupid"));
 	}
+	cur->shutdown();
+	q_getClientGroup->Reset();
 	return ret;
 }
 
@@ -170,17 +183,18 @@ ServerBackupDao::SSetting ServerBackupDao::getServerSetting(const std::string& k
 	}
 	q_getServerSetting->Bind(key);
 	q_getServerSetting->Bind(clientid);
-	db_results res=q_getServerSetting->Read();
-	q_getServerSetting->Reset();
+	IDatabaseCursor* cur=q_getServerSetting->Cursor();
 	SSetting ret = { false, "", "", 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["value"];
-		ret.value_client=res[0]["value_client"];
-		ret.use=watoi(res[0]["use"]);
-		ret.use_last_modified=watoi64(res[0]["use_last_modified"]);
+		ret.value=cur->getString(cur->columnIndex("value"));
+		ret.value_client=cur->getString(cur->columnIndex("value_client"));
+		ret.use=cur->getInt(cur->columnIndex("use"));
+		ret.use_last_modified=cur->getInt64(cur->columnIndex("use_last_modified"));
 	}
+	cur->shutdown();
+	q_getServerSetting->Reset();
 	return ret;
 }
 
@@ -199,15 +213,16 @@ ServerBackupDao::SClientName ServerBackupDao::getVirtualMainClientname(int clien
 		q_getVirtualMainClientname=db->Prepare("SELECT virtualmain, name FROM clients WHERE id=?", false);
 	}
 	q_getVirtualMainClientname->Bind(clientid);
-	db_results res=q_getVirtualMainClientname->Read();
-	q_getVirtualMainClientname->Reset();
+	IDatabaseCursor* cur=q_getVirtualMainClientname->Cursor();
 	SClientName ret = { false, "", "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.virtualmain=res[0]["virtualmain"];
-		ret.name=res[0]["name"];
+		ret.virtualmain=cur->getString(cur->columnIndex("virtualmain"));
+		ret.name=cur->getString(cur->columnIndex("name"));
 	}
+	cur->shutdown();
+	q_getVirtualMainClientname->Reset();
 	return ret;
 }
 
@@ -229,15 +244,22 @@ std::vector<ServerBackupDao::SDuration> ServerBackupDao::getLastIncrementalDurat
 		q_getLastIncrementalDurations=db->Prepare("SELECT indexing_time_ms, (strftime('%s',running)-strftime('%s',backuptime)) AS duration FROM backups  WHERE clientid=? AND done=1 AND complete=1 AND incremental<>0 AND resumed=0 ORDER BY backuptime DESC LIMIT 10", false);
 	}
 	q_getLastIncrementalDurations->Bind(clientid);
-	db_results res=q_getLastIncrementalDurations->Read();
-	q_getLastIncrementalDurations->Reset();
+	IDatabaseCursor* cur=q_getLastIncrementalDurations->Cursor();
 	std::vector<ServerBackupDao::SDuration> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].indexing_time_ms=watoi64(res[i]["indexing_time_ms"]);
-		ret[i].duration=watoi64(res[i]["duration"]);
-	}
+	int c_indexing_time_ms=cur->columnIndex("indexing_time_ms");
+	int c_duration=cur->columnIndex("duration");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SDuration());
+		ret.back().indexing_time_ms=cur->getInt64(c_indexing_time_ms);
+		ret.back().duration=cur->getInt64(c_duration);
+	}
+	cur->shutdown();
+	q_getLastIncrementalDurations->Reset();
 	return ret;
 }
 
@@ -258,15 +280,22 @@ std::vector<ServerBackupDao::SDuration> ServerBackupDao::getLastFullDurations(in
 		q_getLastFullDurations=db->Prepare("SELECT indexing_time_ms, (strftime('%s',running)-strftime('%s',backuptime)) AS duration FROM backups  WHERE clientid=? AND done=1 AND complete=1 AND incremental=0 AND resumed=0 ORDER BY backuptime DESC LIMIT 1", false);
 	}
 	q_getLastFullDurations->Bind(clientid);
-	db_results res=q_getLastFullDurations->Read();
-	q_getLastFullDurations->Reset();
+	IDatabaseCursor* cur=q_getLastFullDurations->Cursor();
 	std::vector<ServerBackupDao::SDuration> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].indexing_time_ms=watoi64(res[i]["indexing_time_ms"]);
-		ret[i].duration=watoi64(res[i]["duration"]);
-	}
+	int c_indexing_time_ms=cur->columnIndex("indexing_time_ms");
+	int c_duration=cur->columnIndex("duration");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SDuration());
+		ret.back().indexing_time_ms=cur->getInt64(c_indexing_time_ms);
+		ret.back().duration=cur->getInt64(c_duration);
+	}
+	cur->shutdown();
+	q_getLastFullDurations->Reset();
 	return ret;
 }
 
@@ -286,14 +315,15 @@ ServerBackupDao::CondString ServerBackupDao::getClientSetting(const std::string&
 	}
 	q_getClientSetting->Bind(key);
 	q_getClientSetting->Bind(clientid);
-	db_results res=q_getClientSetting->Read();
-	q_getClientSetting->Reset();
+	IDatabaseCursor* cur=q_getClientSetting->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["value"];
+		ret.value=cur->getString(cur->columnIndex("value"));
 	}
+	cur->shutdown();
+	q_getClientSetting->Reset();
 	return ret;
 }
 
@@ -311,13 +341,18 @@ std::vector<int> ServerBackupDao::getClientIds(void)
 	{
 		q_getClientIds=db->Prepare("SELECT id FROM clients", false);
 	}
-	db_results res=q_getClientIds->Read();
+	IDatabaseCursor* cur=q_getClientIds->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -335,14 +370,19 @@ std::vector<int> ServerBackupDao::getClientsByUid(const std::string& uid)
 		q_getClientsByUid=db->Prepare("SELECT id FROM clients WHERE uid=?", false);
 	}
 	q_getClientsByUid->Bind(uid);
-	db_results res=q_getClientsByUid->Read();
-	q_getClientsByUid->Reset();
+	IDatabaseCursor* cur=q_getClientsByUid->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
+	q_getClientsByUid->Reset();
 	return ret;
 }
 
@@ -360,14 +400,15 @@ ServerBackupDao::CondString ServerBackupDao::getClientUid(int id)
 		q_getClientUid=db->Prepare("SELECT uid FROM clients WHERE id=?", false);
 	}
 	q_getClientUid->Bind(id);
-	db_results res=q_getClientUid->Read();
-	q_getClientUid->Reset();
+	IDatabaseCursor* cur=q_getClientUid->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["uid"];
+		ret.value=cur->getString(cur->columnIndex("uid"));
 	}
+	cur->shutdown();
+	q_getClientUid->Reset();
 	return ret;
 }
 
@@ -475,14 +516,19 @@ std::vector<std::string> ServerBackupDao::getClientMovedLimit5(const std::string
 		q_getClientMovedLimit5=db->Prepare("SELECT from_name FROM moved_clients WHERE to_name=? LIMIT 5", false);
 	}
 	q_getClientMovedLimit5->Bind(to_name);
-	db_results res=q_getClientMovedLimit5->Read();
-	q_getClientMovedLimit5->Reset();
+	IDatabaseCursor* cur=q_getClientMovedLimit5->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_from_name=cur->columnIndex("from_name");
+	while(cur->next())
 	{
-		ret[i]=res[i]["from_name"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_from_name));
 	}
+	cur->shutdown();
+	q_getClientMovedLimit5->Reset();
 	return ret;
 }
 
@@ -500,14 +546,19 @@ std::vector<std::string> ServerBackupDao::getClientMovedFrom(const std::string&
 		q_getClientMovedFrom=db->Prepare("SELECT to_name FROM moved_clients WHERE from_name=?", false);
 	}
 	q_getClientMovedFrom->Bind(from_name);
-	db_results res=q_getClientMovedFrom->Read();
-	q_getClientMovedFrom->Reset();
+	IDatabaseCursor* cur=q_getClientMovedFrom->Cursor();
 	std::vector<std::string> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_to_name=cur->columnIndex("to_name");
+	while(cur->next())
 	{
-		ret[i]=res[i]["to_name"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getString(c_to_name));
 	}
+	cur->shutdown();
+	q_getClientMovedFrom->Reset();
 	return ret;
 }
 
@@ -527,14 +578,15 @@ ServerBackupDao::CondString ServerBackupDao::getSetting(int clientid, const std:
 	}
 	q_getSetting->Bind(clientid);
 	q_getSetting->Bind(key);
-	db_results res=q_getSetting->Read();
-	q_getSetting->Reset();
+	IDatabaseCursor* cur=q_getSetting->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["value"];
+		ret.value=cur->getString(cur->columnIndex("value"));
 	}
+	cur->shutdown();
+	q_getSetting->Reset();
 	return ret;
 }
 
@@ -552,10 +604,13 @@ int ServerBackupDao::hasFileBackups(int clientid)
 		q_hasFileBackups=db->Prepare("SELECT COUNT(*) AS c FROM backups WHERE clientid=? AND done=1 LIMIT 1", false);
 	}
 	q_hasFileBackups->Bind(clientid);
-	db_results res=q_hasFileBackups->Read();
+	IDatabaseCursor* cur=q_hasFileBackups->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int ret=has_row ? cur->getInt(cur->columnIndex("c")) : 0;
+	cur->shutdown();
 	q_hasFileBackups->Reset();
-	assert(!res.empty());
-	return watoi(res[0]["c"]);
+	return ret;
 }
 
 /**
@@ -610,14 +665,15 @@ ServerBackupDao::CondString ServerBackupDao::getMiscValue(const std::string& tke
 		q_getMiscValue=db->Prepare("SELECT tvalue FROM misc WHERE tkey=?", false);
 	}
 	q_getMiscValue->Bind(tkey);
-	db_results res=q_getMiscValue->Read();
-	q_getMiscValue->Reset();
+	IDatabaseCursor* cur=q_getMiscValue->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["tvalue"];
+		ret.value=cur->getString(cur->columnIndex("tvalue"));
 	}
+	cur->shutdown();
+	q_getMiscValue->Reset();
 	return ret;
 }
 
@@ -770,20 +826,21 @@ ServerBackupDao::SLastIncremental ServerBackupDao::getLastIncrementalFileBackup(
 	}
 	q_getLastIncrementalFileBackup->Bind(clientid);
 	q_getLastIncrementalFileBackup->Bind(tgroup);
-	db_results res=q_getLastIncrementalFileBackup->Read();
-	q_getLastIncrementalFileBackup->Reset();
+	IDatabaseCursor* cur=q_getLastIncrementalFileBackup->Cursor();
 	SLastIncremental ret = { false, 0, "", 0, 0, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.path=res[0]["path"];
-		ret.resumed=watoi(res[0]["resumed"]);
-		ret.complete=watoi(res[0]["complete"]);
-		ret.id=watoi(res[0]["id"]);
-		ret.incremental_ref=watoi(res[0]["incremental_ref"]);
-		ret.deletion_protected=watoi(res[0]["deletion_protected"]);
-	}
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.resumed=cur->getInt(cur->columnIndex("resumed"));
+		ret.complete=cur->getInt(cur->columnIndex("complete"));
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.incremental_ref=cur->getInt(cur->columnIndex("incremental_ref"));
+		ret.deletion_protected=cur->getInt(cur->columnIndex("deletion_protected"));
+	}
+	cur->shutdown();
+	q_getLastIncrementalFileBackup->Reset();
 	return ret;
 }
 
@@ -803,18 +860,19 @@ ServerBackupDao::SLastIncremental ServerBackupDao::getLastIncrementalCompleteFil
 	}
 	q_getLastIncrementalCompleteFileBackup->Bind(clientid);
 	q_getLastIncrementalCompleteFileBackup->Bind(tgroup);
-	db_results res=q_getLastIncrementalCompleteFileBackup->Read();
-	q_getLastIncrementalCompleteFileBackup->Reset();
+	IDatabaseCursor* cur=q_getLastIncrementalCompleteFileBackup->Cursor();
 	SLastIncremental ret = { false, 0, "", 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.path=res[0]["path"];
-		ret.resumed=watoi(res[0]["resumed"]);
-		ret.complete=watoi(res[0]["complete"]);
-		ret.id=watoi(res[0]["id"]);
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.resumed=cur->getInt(cur->columnIndex("resumed"));
+		ret.complete=cur->getInt(cur->columnIndex("complete"));
+		ret.id=cur->getInt(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_getLastIncrementalCompleteFileBackup->Reset();
 	return ret;
 }
 
@@ -892,13 +950,18 @@ std::vector<int> ServerBackupDao::getMailableUserIds(void)
 	{
 		q_getMailableUserIds=db->Prepare("SELECT id FROM settings_db.si_users WHERE report_mail IS NOT NULL AND report_mail<>''", false);
 	}
-	db_results res=q_getMailableUserIds->Read();
+	IDatabaseCursor* cur=q_getMailableUserIds->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -917,14 +980,15 @@ ServerBackupDao::CondString ServerBackupDao::getUserRight(int clientid, const st
 	}
 	q_getUserRight->Bind(clientid);
 	q_getUserRight->Bind(t_domain);
-	db_results res=q_getUserRight->Read();
-	q_getUserRight->Reset();
+	IDatabaseCursor* cur=q_getUserRight->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["t_right"];
+		ret.value=cur->getString(cur->columnIndex("t_right"));
 	}
+	cur->shutdown();
+	q_getUserRight->Reset();
 	return ret;
 }
 
@@ -942,16 +1006,17 @@ ServerBackupDao::SReportSettings ServerBackupDao::getUserReportSettings(int user
 		q_getUserReportSettings=db->Prepare("SELECT report_mail, report_loglevel, report_sendonly FROM settings_db.si_users WHERE id=?", false);
 	}
 	q_getUserReportSettings->Bind(userid);
-	db_results res=q_getUserReportSettings->Read();
-	q_getUserReportSettings->Reset();
+	IDatabaseCursor* cur=q_getUserReportSettings->Cursor();
 	SReportSettings ret = { false, "", 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.report_mail=res[0]["report_mail"];
-		ret.report_loglevel=watoi(res[0]["report_loglevel"]);
-		ret.report_sendonly=watoi(res[0]["report_sendonly"]);
+		ret.report_mail=cur->getString(cur->columnIndex("report_mail"));
+		ret.report_loglevel=cur->getInt(cur->columnIndex("report_loglevel"));
+		ret.report_sendonly=cur->getInt(cur->columnIndex("report_sendonly"));
 	}
+	cur->shutdown();
+	q_getUserReportSettings->Reset();
 	return ret;
 }
 
@@ -969,14 +1034,15 @@ ServerBackupDao::CondString ServerBackupDao::formatUnixtime(int64 unixtime)
 		q_formatUnixtime=db->Prepare("SELECT datetime(?, 'unixepoch', 'localtime') AS time", false);
 	}
 	q_formatUnixtime->Bind(unixtime);
-	db_results res=q_formatUnixtime->Read();
-	q_formatUnixtime->Reset();
+	IDatabaseCursor* cur=q_formatUnixtime->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["time"];
+		ret.value=cur->getString(cur->columnIndex("time"));
 	}
+	cur->shutdown();
+	q_formatUnixtime->Reset();
 	return ret;
 }
 
@@ -997,17 +1063,18 @@ ServerBackupDao::SImageBackup ServerBackupDao::getLastFullImage(int clientid, in
 	q_getLastFullImage->Bind(clientid);
 	q_getLastFullImage->Bind(image_version);
 	q_getLastFullImage->Bind(letter);
-	db_results res=q_getLastFullImage->Read();
-	q_getLastFullImage->Reset();
+	IDatabaseCursor* cur=q_getLastFullImage->Cursor();
 	SImageBackup ret = { false, 0, 0, "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.path=res[0]["path"];
-		ret.duration=watoi64(res[0]["duration"]);
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.duration=cur->getInt64(cur->columnIndex("duration"));
 	}
+	cur->shutdown();
+	q_getLastFullImage->Reset();
 	return ret;
 }
 
@@ -1028,17 +1095,18 @@ ServerBackupDao::SImageBackup ServerBackupDao::getLastImage(int clientid, int im
 	q_getLastImage->Bind(clientid);
 	q_getLastImage->Bind(image_version);
 	q_getLastImage->Bind(letter);
-	db_results res=q_getLastImage->Read();
-	q_getLastImage->Reset();
+	IDatabaseCursor* cur=q_getLastImage->Cursor();
 	SImageBackup ret = { false, 0, 0, "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.path=res[0]["path"];
-		ret.duration=watoi64(res[0]["duration"]);
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.duration=cur->getInt64(cur->columnIndex("duration"));
 	}
+	cur->shutdown();
+	q_getLastImage->Reset();
 	return ret;
 }
 
@@ -1383,14 +1451,15 @@ ServerBackupDao::CondInt64 ServerBackupDao::hasRecentFullOrIncrFileBackup(const
 	q_hasRecentFullOrIncrFileBackup->Bind(backup_interval_incr);
 	q_hasRecentFullOrIncrFileBackup->Bind(clientid);
 	q_hasRecentFullOrIncrFileBackup->Bind(tgroup);
-	db_results res=q_hasRecentFullOrIncrFileBackup->Read();
-	q_hasRecentFullOrIncrFileBackup->Reset();
+	IDatabaseCursor* cur=q_hasRecentFullOrIncrFileBackup->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_hasRecentFullOrIncrFileBackup->Reset();
 	return ret;
 }
 
@@ -1412,14 +1481,15 @@ ServerBackupDao::CondInt64 ServerBackupDao::hasRecentIncrFileBackup(const std::s
 	q_hasRecentIncrFileBackup->Bind(backup_interval);
 	q_hasRecentIncrFileBackup->Bind(clientid);
 	q_hasRecentIncrFileBackup->Bind(tgroup);
-	db_results res=q_hasRecentIncrFileBackup->Read();
-	q_hasRecentIncrFileBackup->Reset();
+	IDatabaseCursor* cur=q_hasRecentIncrFileBackup->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_hasRecentIncrFileBackup->Reset();
 	return ret;
 }
 
@@ -1449,14 +1519,15 @@ ServerBackupDao::CondInt64 ServerBackupDao::hasRecentFullOrIncrImageBackup(const
 	q_hasRecentFullOrIncrImageBackup->Bind(clientid);
 	q_hasRecentFullOrIncrImageBackup->Bind(image_version);
 	q_hasRecentFullOrIncrImageBackup->Bind(letter);
-	db_results res=q_hasRecentFullOrIncrImageBackup->Read();
-	q_hasRecentFullOrIncrImageBackup->Reset();
+	IDatabaseCursor* cur=q_hasRecentFullOrIncrImageBackup->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_hasRecentFullOrIncrImageBackup->Reset();
 	return ret;
 }
 
@@ -1480,14 +1551,15 @@ ServerBackupDao::CondInt64 ServerBackupDao::hasRecentIncrImageBackup(const std::
 	q_hasRecentIncrImageBackup->Bind(clientid);
 	q_hasRecentIncrImageBackup->Bind(image_version);
 	q_hasRecentIncrImageBackup->Bind(letter);
-	db_results res=q_hasRecentIncrImageBackup->Read();
-	q_hasRecentIncrImageBackup->Reset();
+	IDatabaseCursor* cur=q_hasRecentIncrImageBackup->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["id"]);
+		ret.value=cur->getInt64(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_hasRecentIncrImageBackup->Reset();
 	return ret;
 }
 
@@ -1529,14 +1601,15 @@ ServerBackupDao::CondString ServerBackupDao::getRestorePath(int64 restore_id, in
 	}
 	q_getRestorePath->Bind(restore_id);
 	q_getRestorePath->Bind(clientid);
-	db_results res=q_getRestorePath->Read();
-	q_getRestorePath->Reset();
+	IDatabaseCursor* cur=q_getRestorePath->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["path"];
+		ret.value=cur->getString(cur->columnIndex("path"));
 	}
+	cur->shutdown();
+	q_getRestorePath->Reset();
 	return ret;
 }
 
@@ -1555,14 +1628,15 @@ ServerBackupDao::CondString ServerBackupDao::getRestoreIdentity(int64 restore_id
 	}
 	q_getRestoreIdentity->Bind(restore_id);
 	q_getRestoreIdentity->Bind(clientid);
-	db_results res=q_getRestoreIdentity->Read();
-	q_getRestoreIdentity->Reset();
+	IDatabaseCursor* cur=q_getRestoreIdentity->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["identity"];
+		ret.value=cur->getString(cur->columnIndex("identity"));
 	}
+	cur->shutdown();
+	q_getRestoreIdentity->Reset();
 	return ret;
 }
 
@@ -1616,28 +1690,29 @@ ServerBackupDao::SFileBackupInfo ServerBackupDao::getFileBackupInfo(int backupid
 		q_getFileBackupInfo=db->Prepare("SELECT id, clientid, strftime('%s',backuptime) AS backuptime, incremental, path, complete, strftime('%s',running) AS running, size_bytes, done, archived, archive_timeout, size_calculated, resumed, indexing_time_ms, tgroup FROM backups WHERE id=?", false);
 	}
 	q_getFileBackupInfo->Bind(backupid);
-	db_results res=q_getFileBackupInfo->Read();
-	q_getFileBackupInfo->Reset();
+	IDatabaseCursor* cur=q_getFileBackupInfo->Cursor();
 	SFileBackupInfo ret = { false, 0, 0, 0, 0, "", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.clientid=watoi(res[0]["clientid"]);
-		ret.backuptime=watoi64(res[0]["backuptime"]);
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.path=res[0]["path"];
-		ret.complete=watoi(res[0]["complete"]);
-		ret.running=watoi64(res[0]["running"]);
-		ret.size_bytes=watoi64(res[0]["size_bytes"]);
-		ret.done=watoi(res[0]["done"]);
-		ret.archived=watoi(res[0]["archived"]);
-		ret.archive_timeout=watoi64(res[0]["archive_timeout"]);
-		ret.size_calculated=watoi64(res[0]["size_calculated"]);
-		ret.resumed=watoi(res[0]["resumed"]);
-		ret.indexing_time_ms=watoi64(res[0]["indexing_time_ms"]);
-		ret.tgroup=watoi(res[0]["tgroup"]);
-	}
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.clientid=cur->getInt(cur->columnIndex("clientid"));
+		ret.backuptime=cur->getInt64(cur->columnIndex("backuptime"));
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.complete=cur->getInt(cur->columnIndex("complete"));
+		ret.running=cur->getInt64(cur->columnIndex("running"));
+		ret.size_bytes=cur->getInt64(cur->columnIndex("size_bytes"));
+		ret.done=cur->getInt(cur->columnIndex("done"));
+		ret.archived=cur->getInt(cur->columnIndex("archived"));
+		ret.archive_timeout=cur->getInt64(cur->columnIndex("archive_timeout"));
+		ret.size_calculated=cur->getInt64(cur->columnIndex("size_calculated"));
+		ret.resumed=cur->getInt(cur->columnIndex("resumed"));
+		ret.indexing_time_ms=cur->getInt64(cur->columnIndex("indexing_time_ms"));
+		ret.tgroup=cur->getInt(cur->columnIndex("tgroup"));
+	}
+	cur->shutdown();
+	q_getFileBackupInfo->Reset();
 	return ret;
 }
 
@@ -1690,14 +1765,15 @@ ServerBackupDao::CondInt ServerBackupDao::hasUsedAccessToken(const std::string&
 		q_hasUsedAccessToken=db->Prepare("SELECT clientid FROM settings_db.access_tokens WHERE tokenhash=?", false);
 	}
 	q_hasUsedAccessToken->Bind(tokenhash.c_str(), (_u32)tokenhash.size());
-	db_results res=q_hasUsedAccessToken->Read();
-	q_hasUsedAccessToken->Reset();
+	IDatabaseCursor* cur=q_hasUsedAccessToken->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["clientid"]);
+		ret.value=cur->getInt(cur->columnIndex("clientid"));
 	}
+	cur->shutdown();
+	q_hasUsedAccessToken->Reset();
 	return ret;
 }
 
@@ -1734,14 +1810,15 @@ ServerBackupDao::CondString ServerBackupDao::getClientnameByImageid(int backupid
 		q_getClientnameByImageid=db->Prepare("SELECT name FROM clients WHERE id = (SELECT clientid FROM backup_images WHERE id=? )", false);
 	}
 	q_getClientnameByImageid->Bind(backupid);
-	db_results res=q_getClientnameByImageid->Read();
-	q_getClientnameByImageid->Reset();
+	IDatabaseCursor* cur=q_getClientnameByImageid->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["name"];
+		ret.value=cur->getString(cur->columnIndex("name"));
 	}
+	cur->shutdown();
+	q_getClientnameByImageid->Reset();
 	return ret;
 }
 
@@ -1759,14 +1836,15 @@ ServerBackupDao::CondInt ServerBackupDao::getClientidByImageid(int backupid)
 		q_getClientidByImageid=db->Prepare("SELECT clientid FROM backup_images WHERE id=?", false);
 	}
 	q_getClientidByImageid->Bind(backupid);
-	db_results res=q_getClientidByImageid->Read();
-	q_getClientidByImageid->Reset();
+	IDatabaseCursor* cur=q_getClientidByImageid->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["clientid"]);
+		ret.value=cur->getInt(cur->columnIndex("clientid"));
 	}
+	cur->shutdown();
+	q_getClientidByImageid->Reset();
 	return ret;
 }
 
@@ -1784,14 +1862,15 @@ ServerBackupDao::CondInt ServerBackupDao::getImageMounttime(int backupid)
 		q_getImageMounttime=db->Prepare("SELECT mounttime FROM backup_images WHERE id=?", false);
 	}
 	q_getImageMounttime->Bind(backupid);
-	db_results res=q_getImageMounttime->Read();
-	q_getImageMounttime->Reset();
+	IDatabaseCursor* cur=q_getImageMounttime->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["mounttime"]);
+		ret.value=cur->getInt(cur->columnIndex("mounttime"));
 	}
+	cur->shutdown();
+	q_getImageMounttime->Reset();
 	return ret;
 }
 
@@ -1865,19 +1944,20 @@ ServerBackupDao::SMountedImage ServerBackupDao::getMountedImage(int backupid, in
 	}
 	q_getMountedImage->Bind(backupid);
 	q_getMountedImage->Bind(partition);
-	db_results res=q_getMountedImage->Read();
-	q_getMountedImage->Reset();
+	IDatabaseCursor* cur=q_getMountedImage->Cursor();
 	SMountedImage ret = { false, 0, 0, "", 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.backupid=watoi(res[0]["backupid"]);
-		ret.path=res[0]["path"];
-		ret.mounttime=watoi64(res[0]["mounttime"]);
-		ret.partition=watoi(res[0]["partition"]);
-		ret.clientid=watoi(res[0]["clientid"]);
-	}
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.backupid=cur->getInt(cur->columnIndex("backupid"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.mounttime=cur->getInt64(cur->columnIndex("mounttime"));
+		ret.partition=cur->getInt(cur->columnIndex("partition"));
+		ret.clientid=cur->getInt(cur->columnIndex("clientid"));
+	}
+	cur->shutdown();
+	q_getMountedImage->Reset();
 	return ret;
 }
 
@@ -1897,17 +1977,18 @@ ServerBackupDao::SMountedImage ServerBackupDao::getImageInfo(int backupid)
 		q_getImageInfo=db->Prepare("SELECT 0 AS id, id AS backupid, path, clientid FROM backup_images WHERE id=?", false);
 	}
 	q_getImageInfo->Bind(backupid);
-	db_results res=q_getImageInfo->Read();
-	q_getImageInfo->Reset();
+	IDatabaseCursor* cur=q_getImageInfo->Cursor();
 	SMountedImage ret = { false, 0, 0, "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.backupid=watoi(res[0]["backupid"]);
-		ret.path=res[0]["path"];
-		ret.clientid=watoi(res[0]["clientid"]);
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.backupid=cur->getInt(cur->columnIndex("backupid"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.clientid=cur->getInt(cur->columnIndex("clientid"));
 	}
+	cur->shutdown();
+	q_getImageInfo->Reset();
 	return ret;
 }
 
@@ -1926,19 +2007,29 @@ std::vector<ServerBackupDao::SMountedImage> ServerBackupDao::getOldMountedImages
 		q_getOldMountedImages=db->Prepare("SELECT b.id AS backupid, m.id AS id, path, m.mounttime AS mounttime, partition FROM (mounted_backup_images m INNER JOIN backup_images b ON m.backupid=b.id)  WHERE m.mounttime!=0 AND m.mounttime<(strftime('%s','now')-?)", false);
 	}
 	q_getOldMountedImages->Bind(times);
-	db_results res=q_getOldMountedImages->Read();
-	q_getOldMountedImages->Reset();
+	IDatabaseCursor* cur=q_getOldMountedImages->Cursor();
 	std::vector<ServerBackupDao::SMountedImage> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].backupid=watoi(res[i]["backupid"]);
-		ret[i].path=res[i]["path"];
-		ret[i].mounttime=watoi64(res[i]["mounttime"]);
-		ret[i].partition=watoi(res[i]["partition"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_backupid=cur->columnIndex("backupid");
+	int c_path=cur->columnIndex("path");
+	int c_mounttime=cur->columnIndex("mounttime");
+	int c_partition=cur->columnIndex("partition");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SMountedImage());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt(c_id);
+		ret.back().backupid=cur->getInt(c_backupid);
+		ret.back().path=cur->getString(c_path);
+		ret.back().mounttime=cur->getInt64(c_mounttime);
+		ret.back().partition=cur->getInt(c_partition);
+	}
+	cur->shutdown();
+	q_getOldMountedImages->Reset();
 	return ret;
 }
 
@@ -1974,14 +2065,15 @@ ServerBackupDao::CondInt ServerBackupDao::getCapa(int clientid)
 		q_getCapa=db->Prepare("SELECT capa FROM clients WHERE id=?", false);
 	}
 	q_getCapa->Bind(clientid);
-	db_results res=q_getCapa->Read();
-	q_getCapa->Reset();
+	IDatabaseCursor* cur=q_getCapa->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["capa"]);
+		ret.value=cur->getInt(cur->columnIndex("capa"));
 	}
+	cur->shutdown();
+	q_getCapa->Reset();
 	return ret;
 }
 
@@ -1999,14 +2091,15 @@ ServerBackupDao::CondInt ServerBackupDao::getClientWithHashes(int clientid)
 		q_getClientWithHashes=db->Prepare("SELECT with_hashes FROM clients WHERE id=?", false);
 	}
 	q_getClientWithHashes->Bind(clientid);
-	db_results res=q_getClientWithHashes->Read();
-	q_getClientWithHashes->Reset();
+	IDatabaseCursor* cur=q_getClientWithHashes->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["with_hashes"]);
+		ret.value=cur->getInt(cur->columnIndex("with_hashes"));
 	}
+	cur->shutdown();
+	q_getClientWithHashes->Reset();
 	return ret;
 }
 
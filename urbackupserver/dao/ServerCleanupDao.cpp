@@ -18,6 +18,7 @@
 
 #include "ServerCleanupDao.h"
 #include "../../stringtools.h"
+#include "../../Interface/DatabaseCursor.h"
 #include <assert.h>
 
 ServerCleanupDao::ServerCleanupDao(IDatabase *db)
@@ -53,15 +54,23 @@ std::vector<ServerCleanupDao::SIncompleteImages> ServerCleanupDao::getIncomplete
 	{
 		q_getIncompleteImages=db->Prepare("SELECT b.id AS id, b.path AS path, c.name AS clientname FROM backup_images b, clients c WHERE  complete=0 AND archived=0 AND running<datetime('now','-300 seconds') AND b.clientid=c.id", false);
 	}
-	db_results res=q_getIncompleteImages->Read();
+	IDatabaseCursor* cur=q_getIncompleteImages->Cursor();
 	std::vector<ServerCleanupDao::SIncompleteImages> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].path=res[i]["path"];
-		ret[i].clientname=res[i]["clientname"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_path=cur->columnIndex("path");
+	int c_clientname=cur->columnIndex("clientname");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SIncompleteImages());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().path=cur->getString(c_path);
+		ret.back().clientname=cur->getString(c_clientname);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -83,14 +92,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getIncompleteImage(int id)
 		q_getIncompleteImage=db->Prepare("SELECT id FROM backup_images WHERE complete=0 AND (archived & 1)=0 AND running<datetime('now','-300 seconds') AND id=?", false);
 	}
 	q_getIncompleteImage->Bind(id);
-	db_results res=q_getIncompleteImage->Read();
-	q_getIncompleteImage->Reset();
+	IDatabaseCursor* cur=q_getIncompleteImage->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["id"]);
+		ret.value=cur->getInt(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_getIncompleteImage->Reset();
 	return ret;
 }
 
@@ -111,15 +121,23 @@ std::vector<ServerCleanupDao::SIncompleteImages> ServerCleanupDao::getDeletePend
 	{
 		q_getDeletePendingImages=db->Prepare("SELECT b.id AS id, b.path AS path, c.name AS clientname FROM backup_images b, clients c WHERE b.delete_pending=1 AND b.clientid=c.id ORDER BY backuptime DESC", false);
 	}
-	db_results res=q_getDeletePendingImages->Read();
+	IDatabaseCursor* cur=q_getDeletePendingImages->Cursor();
 	std::vector<ServerCleanupDao::SIncompleteImages> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].path=res[i]["path"];
-		ret[i].clientname=res[i]["clientname"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_path=cur->columnIndex("path");
+	int c_clientname=cur->columnIndex("clientname");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SIncompleteImages());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().path=cur->getString(c_path);
+		ret.back().clientname=cur->getString(c_clientname);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -155,13 +173,18 @@ std::vector<int> ServerCleanupDao::getClientsSortFilebackups(void)
 	{
 		q_getClientsSortFilebackups=db->Prepare("SELECT DISTINCT c.id AS id FROM clients c INNER JOIN backups b ON c.id=b.clientid ORDER BY b.backuptime ASC", false);
 	}
-	db_results res=q_getClientsSortFilebackups->Read();
+	IDatabaseCursor* cur=q_getClientsSortFilebackups->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -181,13 +204,18 @@ std::vector<int> ServerCleanupDao::getClientsSortImagebackups(void)
 	{
 		q_getClientsSortImagebackups=db->Prepare("SELECT DISTINCT c.id AS id FROM clients c  INNER JOIN (SELECT * FROM backup_images WHERE letter!='SYSVOL' AND letter!='ESP') b ON c.id=b.clientid ORDER BY b.backuptime ASC", false);
 	}
-	db_results res=q_getClientsSortImagebackups->Read();
+	IDatabaseCursor* cur=q_getClientsSortImagebackups->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -207,15 +235,22 @@ std::vector<ServerCleanupDao::SImageLetter> ServerCleanupDao::getFullNumImages(i
 		q_getFullNumImages=db->Prepare("SELECT id, letter FROM backup_images  WHERE clientid=? AND incremental=0 AND complete=1 AND letter!='SYSVOL' AND letter!='ESP' AND archived=0 ORDER BY backuptime ASC", false);
 	}
 	q_getFullNumImages->Bind(clientid);
-	db_results res=q_getFullNumImages->Read();
-	q_getFullNumImages->Reset();
+	IDatabaseCursor* cur=q_getFullNumImages->Cursor();
 	std::vector<ServerCleanupDao::SImageLetter> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].letter=res[i]["letter"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_letter=cur->columnIndex("letter");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageLetter());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().letter=cur->getString(c_letter);
+	}
+	cur->shutdown();
+	q_getFullNumImages->Reset();
 	return ret;
 }
 
@@ -234,16 +269,24 @@ std::vector<ServerCleanupDao::SImageRef> ServerCleanupDao::getImageRefs(int incr
 		q_getImageRefs=db->Prepare("SELECT id, complete, archived FROM backup_images WHERE incremental<>0 AND incremental_ref=?", false);
 	}
 	q_getImageRefs->Bind(incremental_ref);
-	db_results res=q_getImageRefs->Read();
-	q_getImageRefs->Reset();
+	IDatabaseCursor* cur=q_getImageRefs->Cursor();
 	std::vector<ServerCleanupDao::SImageRef> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].complete=watoi(res[i]["complete"]);
-		ret[i].archived=watoi(res[i]["archived"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_complete=cur->columnIndex("complete");
+	int c_archived=cur->columnIndex("archived");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageRef());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().complete=cur->getInt(c_complete);
+		ret.back().archived=cur->getInt(c_archived);
+	}
+	cur->shutdown();
+	q_getImageRefs->Reset();
 	return ret;
 }
 
@@ -262,16 +305,24 @@ std::vector<ServerCleanupDao::SFileBackupRef> ServerCleanupDao::getFileBackupRef
 		q_getFileBackupRefsReverse=db->Prepare("SELECT id, complete, archived FROM backups WHERE id = (SELECT incremental_ref FROM backups WHERE id=?)", false);
 	}
 	q_getFileBackupRefsReverse->Bind(backupid);
-	db_results res=q_getFileBackupRefsReverse->Read();
-	q_getFileBackupRefsReverse->Reset();
+	IDatabaseCursor* cur=q_getFileBackupRefsReverse->Cursor();
 	std::vector<ServerCleanupDao::SFileBackupRef> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].complete=watoi(res[i]["complete"]);
-		ret[i].archived=watoi(res[i]["archived"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_complete=cur->columnIndex("complete");
+	int c_archived=cur->columnIndex("archived");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SFileBackupRef());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().complete=cur->getInt(c_complete);
+		ret.back().archived=cur->getInt(c_archived);
+	}
+	cur->shutdown();
+	q_getFileBackupRefsReverse->Reset();
 	return ret;
 }
 
@@ -290,16 +341,24 @@ std::vector<ServerCleanupDao::SImageRef> ServerCleanupDao::getImageRefsReverse(i
 		q_getImageRefsReverse=db->Prepare("SELECT id, complete, archived FROM backup_images WHERE id = (SELECT incremental_ref FROM backup_images WHERE id=?)", false);
 	}
 	q_getImageRefsReverse->Bind(backupid);
-	db_results res=q_getImageRefsReverse->Read();
-	q_getImageRefsReverse->Reset();
+	IDatabaseCursor* cur=q_getImageRefsReverse->Cursor();
 	std::vector<ServerCleanupDao::SImageRef> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].complete=watoi(res[i]["complete"]);
-		ret[i].archived=watoi(res[i]["archived"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_complete=cur->columnIndex("complete");
+	int c_archived=cur->columnIndex("archived");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageRef());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().complete=cur->getInt(c_complete);
+		ret.back().archived=cur->getInt(c_archived);
+	}
+	cur->shutdown();
+	q_getImageRefsReverse->Reset();
 	return ret;
 }
 
@@ -319,16 +378,24 @@ std::vector<ServerCleanupDao::SFileBackupRef> ServerCleanupDao::getFileBackupRef
 		q_getFileBackupRefs=db->Prepare("SELECT id, complete, archived FROM backups WHERE incremental<>0 AND incremental_ref=? AND delete_client_pending!=1", false);
 	}
 	q_getFileBackupRefs->Bind(incremental_ref);
-	db_results res=q_getFileBackupRefs->Read();
-	q_getFileBackupRefs->Reset();
+	IDatabaseCursor* cur=q_getFileBackupRefs->Cursor();
 	std::vector<ServerCleanupDao::SFileBackupRef> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].complete=watoi(res[i]["complete"]);
-		ret[i].archived=watoi(res[i]["archived"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_complete=cur->columnIndex("complete");
+	int c_archived=cur->columnIndex("archived");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SFileBackupRef());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().complete=cur->getInt(c_complete);
+		ret.back().archived=cur->getInt(c_archived);
+	}
+	cur->shutdown();
+	q_getFileBackupRefs->Reset();
 	return ret;
 }
 
@@ -347,14 +414,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getImageClientId(int id)
 		q_getImageClientId=db->Prepare("SELECT clientid FROM backup_images WHERE id=?", false);
 	}
 	q_getImageClientId->Bind(id);
-	db_results res=q_getImageClientId->Read();
-	q_getImageClientId->Reset();
+	IDatabaseCursor* cur=q_getImageClientId->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["clientid"]);
+		ret.value=cur->getInt(cur->columnIndex("clientid"));
 	}
+	cur->shutdown();
+	q_getImageClientId->Reset();
 	return ret;
 }
 
@@ -372,14 +440,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getFileBackupClientId(int id)
 		q_getFileBackupClientId=db->Prepare("SELECT clientid FROM backups WHERE id=?", false);
 	}
 	q_getFileBackupClientId->Bind(id);
-	db_results res=q_getFileBackupClientId->Read();
-	q_getFileBackupClientId->Reset();
+	IDatabaseCursor* cur=q_getFileBackupClientId->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["clientid"]);
+		ret.value=cur->getInt(cur->columnIndex("clientid"));
 	}
+	cur->shutdown();
+	q_getFileBackupClientId->Reset();
 	return ret;
 }
 
@@ -397,14 +466,15 @@ ServerCleanupDao::CondString ServerCleanupDao::getImageClientname(int id)
 		q_getImageClientname=db->Prepare("SELECT name FROM clients WHERE id=(SELECT clientid FROM backup_images WHERE id=? )", false);
 	}
 	q_getImageClientname->Bind(id);
-	db_results res=q_getImageClientname->Read();
-	q_getImageClientname->Reset();
+	IDatabaseCursor* cur=q_getImageClientname->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["name"];
+		ret.value=cur->getString(cur->columnIndex("name"));
 	}
+	cur->shutdown();
+	q_getImageClientname->Reset();
 	return ret;
 }
 
@@ -423,14 +493,15 @@ ServerCleanupDao::CondString ServerCleanupDao::getImagePath(int id)
 		q_getImagePath=db->Prepare("SELECT path FROM backup_images WHERE id=?", false);
 	}
 	q_getImagePath->Bind(id);
-	db_results res=q_getImagePath->Read();
-	q_getImagePath->Reset();
+	IDatabaseCursor* cur=q_getImagePath->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["path"];
+		ret.value=cur->getString(cur->columnIndex("path"));
 	}
+	cur->shutdown();
+	q_getImagePath->Reset();
 	return ret;
 }
 
@@ -450,15 +521,22 @@ std::vector<ServerCleanupDao::SImageLetter> ServerCleanupDao::getIncrNumImages(i
 		q_getIncrNumImages=db->Prepare("SELECT id,letter FROM backup_images WHERE clientid=? AND incremental<>0 AND complete=1 AND letter!='SYSVOL' AND letter!='ESP' AND archived=0 ORDER BY backuptime ASC", false);
 	}
 	q_getIncrNumImages->Bind(clientid);
-	db_results res=q_getIncrNumImages->Read();
-	q_getIncrNumImages->Reset();
+	IDatabaseCursor* cur=q_getIncrNumImages->Cursor();
 	std::vector<ServerCleanupDao::SImageLetter> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].letter=res[i]["letter"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_letter=cur->columnIndex("letter");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageLetter());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().letter=cur->getString(c_letter);
+	}
+	cur->shutdown();
+	q_getIncrNumImages->Reset();
 	return ret;
 }
 
@@ -479,10 +557,13 @@ int ServerCleanupDao::getIncrNumImagesForBackup(int backupid)
 	}
 	q_getIncrNumImagesForBackup->Bind(backupid);
 	q_getIncrNumImagesForBackup->Bind(backupid);
-	db_results res=q_getIncrNumImagesForBackup->Read();
+	IDatabaseCursor* cur=q_getIncrNumImagesForBackup->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int ret=has_row ? cur->getInt(cur->columnIndex("c")) : 0;
+	cur->shutdown();
 	q_getIncrNumImagesForBackup->Reset();
-	assert(!res.empty());
-	return watoi(res[0]["c"]);
+	return ret;
 }
 
 /**
@@ -501,10 +582,13 @@ int ServerCleanupDao::getIncrNumFileBackupsForBackup(int backupid)
 		q_getIncrNumFileBackupsForBackup=db->Prepare("SELECT COUNT(id) AS c FROM backups WHERE clientid=(SELECT clientid FROM backups WHERE id=?) AND incremental<>0 AND complete=1 AND archived=0 AND delete_client_pending!=1", false);
 	}
 	q_getIncrNumFileBackupsForBackup->Bind(backupid);
-	db_results res=q_getIncrNumFileBackupsForBackup->Read();
+	IDatabaseCursor* cur=q_getIncrNumFileBackupsForBackup->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int ret=has_row ? cur->getInt(cur->columnIndex("c")) : 0;
+	cur->shutdown();
 	q_getIncrNumFileBackupsForBackup->Reset();
-	assert(!res.empty());
-	return watoi(res[0]["c"]);
+	return ret;
 }
 
 /**
@@ -525,14 +609,19 @@ std::vector<int> ServerCleanupDao::getFullNumFiles(int clientid)
 		q_getFullNumFiles=db->Prepare("SELECT id FROM backups WHERE clientid=? AND incremental=0 AND  running<datetime('now','-300 seconds') AND archived=0 AND delete_client_pending!=1 ORDER BY backuptime ASC", false);
 	}
 	q_getFullNumFiles->Bind(clientid);
-	db_results res=q_getFullNumFiles->Read();
-	q_getFullNumFiles->Reset();
+	IDatabaseCursor* cur=q_getFullNumFiles->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
+	q_getFullNumFiles->Reset();
 	return ret;
 }
 
@@ -554,14 +643,19 @@ std::vector<int> ServerCleanupDao::getIncrNumFiles(int clientid)
 		q_getIncrNumFiles=db->Prepare("SELECT id FROM backups WHERE clientid=? AND incremental<>0 AND running<datetime('now','-300 seconds') AND archived=0 AND delete_client_pending!=1 ORDER BY backuptime ASC", false);
 	}
 	q_getIncrNumFiles->Bind(clientid);
-	db_results res=q_getIncrNumFiles->Read();
-	q_getIncrNumFiles->Reset();
+	IDatabaseCursor* cur=q_getIncrNumFiles->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
+	q_getIncrNumFiles->Reset();
 	return ret;
 }
 
@@ -579,14 +673,15 @@ ServerCleanupDao::CondString ServerCleanupDao::getClientName(int clientid)
 		q_getClientName=db->Prepare("SELECT name FROM clients WHERE id=?", false);
 	}
 	q_getClientName->Bind(clientid);
-	db_results res=q_getClientName->Read();
-	q_getClientName->Reset();
+	IDatabaseCursor* cur=q_getClientName->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["name"];
+		ret.value=cur->getString(cur->columnIndex("name"));
 	}
+	cur->shutdown();
+	q_getClientName->Reset();
 	return ret;
 }
 
@@ -604,14 +699,15 @@ ServerCleanupDao::CondString ServerCleanupDao::getClientPermUid(int clientid)
 		q_getClientPermUid=db->Prepare("SELECT perm_uid FROM clients WHERE id=?", false);
 	}
 	q_getClientPermUid->Bind(clientid);
-	db_results res=q_getClientPermUid->Read();
-	q_getClientPermUid->Reset();
+	IDatabaseCursor* cur=q_getClientPermUid->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["perm_uid"];
+		ret.value=cur->getString(cur->columnIndex("perm_uid"));
 	}
+	cur->shutdown();
+	q_getClientPermUid->Reset();
 	return ret;
 }
 
@@ -629,14 +725,15 @@ ServerCleanupDao::CondString ServerCleanupDao::getFileBackupPath(int backupid)
 		q_getFileBackupPath=db->Prepare("SELECT path FROM backups WHERE id=?", false);
 	}
 	q_getFileBackupPath->Bind(backupid);
-	db_results res=q_getFileBackupPath->Read();
-	q_getFileBackupPath->Reset();
+	IDatabaseCursor* cur=q_getFileBackupPath->Cursor();
 	CondString ret = { false, "" };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=res[0]["path"];
+		ret.value=cur->getString(cur->columnIndex("path"));
 	}
+	cur->shutdown();
+	q_getFileBackupPath->Reset();
 	return ret;
 }
 
@@ -654,14 +751,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getFileBackupDeletionProtected(int b
 		q_getFileBackupDeletionProtected=db->Prepare("SELECT deletion_protected FROM backups WHERE id=?", false);
 	}
 	q_getFileBackupDeletionProtected->Bind(backupid);
-	db_results res=q_getFileBackupDeletionProtected->Read();
-	q_getFileBackupDeletionProtected->Reset();
+	IDatabaseCursor* cur=q_getFileBackupDeletionProtected->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["deletion_protected"]);
+		ret.value=cur->getInt(cur->columnIndex("deletion_protected"));
 	}
+	cur->shutdown();
+	q_getFileBackupDeletionProtected->Reset();
 	return ret;
 }
 
@@ -765,17 +863,18 @@ ServerCleanupDao::SFileBackupInfo ServerCleanupDao::getFileBackupInfo(int backup
 		q_getFileBackupInfo=db->Prepare("SELECT id, backuptime, path, done FROM backups WHERE id=?", false);
 	}
 	q_getFileBackupInfo->Bind(backupid);
-	db_results res=q_getFileBackupInfo->Read();
-	q_getFileBackupInfo->Reset();
+	IDatabaseCursor* cur=q_getFileBackupInfo->Cursor();
 	SFileBackupInfo ret = { false, 0, "", "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.backuptime=res[0]["backuptime"];
-		ret.path=res[0]["path"];
-		ret.done=watoi(res[0]["done"]);
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.backuptime=cur->getString(cur->columnIndex("backuptime"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.done=cur->getInt(cur->columnIndex("done"));
 	}
+	cur->shutdown();
+	q_getFileBackupInfo->Reset();
 	return ret;
 }
 
@@ -793,18 +892,19 @@ ServerCleanupDao::SImageBackupInfo ServerCleanupDao::getImageBackupInfo(int back
 		q_getImageBackupInfo=db->Prepare("SELECT id, backuptime, path, letter, complete FROM backup_images WHERE id=?", false);
 	}
 	q_getImageBackupInfo->Bind(backupid);
-	db_results res=q_getImageBackupInfo->Read();
-	q_getImageBackupInfo->Reset();
+	IDatabaseCursor* cur=q_getImageBackupInfo->Cursor();
 	SImageBackupInfo ret = { false, 0, "", "", "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi(res[0]["id"]);
-		ret.backuptime=res[0]["backuptime"];
-		ret.path=res[0]["path"];
-		ret.letter=res[0]["letter"];
-		ret.complete=watoi(res[0]["complete"]);
+		ret.id=cur->getInt(cur->columnIndex("id"));
+		ret.backuptime=cur->getString(cur->columnIndex("backuptime"));
+		ret.path=cur->getString(cur->columnIndex("path"));
+		ret.letter=cur->getString(cur->columnIndex("letter"));
+		ret.complete=cur->getInt(cur->columnIndex("complete"));
 	}
+	cur->shutdown();
+	q_getImageBackupInfo->Reset();
 	return ret;
 }
 
@@ -893,16 +993,23 @@ std::vector<ServerCleanupDao::SImageBackupInfo> ServerCleanupDao::getClientImage
 		q_getClientImages=db->Prepare("SELECT id, path FROM backup_images WHERE clientid=?", false);
 	}
 	q_getClientImages->Bind(clientid);
-	db_results res=q_getClientImages->Read();
-	q_getClientImages->Reset();
+	IDatabaseCursor* cur=q_getClientImages->Cursor();
 	std::vector<ServerCleanupDao::SImageBackupInfo> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].path=res[i]["path"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_path=cur->columnIndex("path");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageBackupInfo());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt(c_id);
+		ret.back().path=cur->getString(c_path);
+	}
+	cur->shutdown();
+	q_getClientImages->Reset();
 	return ret;
 }
 
@@ -920,14 +1027,19 @@ std::vector<int> ServerCleanupDao::getClientFileBackups(int clientid)
 		q_getClientFileBackups=db->Prepare("SELECT id FROM backups WHERE clientid=?", false);
 	}
 	q_getClientFileBackups->Bind(clientid);
-	db_results res=q_getClientFileBackups->Read();
-	q_getClientFileBackups->Reset();
+	IDatabaseCursor* cur=q_getClientFileBackups->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_id=cur->columnIndex("id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_id));
 	}
+	cur->shutdown();
+	q_getClientFileBackups->Reset();
 	return ret;
 }
 
@@ -945,14 +1057,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getParentImageBackup(int assoc_id)
 		q_getParentImageBackup=db->Prepare("SELECT img_id FROM assoc_images WHERE assoc_id=?", false);
 	}
 	q_getParentImageBackup->Bind(assoc_id);
-	db_results res=q_getParentImageBackup->Read();
-	q_getParentImageBackup->Reset();
+	IDatabaseCursor* cur=q_getParentImageBackup->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["img_id"]);
+		ret.value=cur->getInt(cur->columnIndex("img_id"));
 	}
+	cur->shutdown();
+	q_getParentImageBackup->Reset();
 	return ret;
 }
 
@@ -970,14 +1083,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::getImageArchived(int backupid)
 		q_getImageArchived=db->Prepare("SELECT archived FROM backup_images WHERE id=?", false);
 	}
 	q_getImageArchived->Bind(backupid);
-	db_results res=q_getImageArchived->Read();
-	q_getImageArchived->Reset();
+	IDatabaseCursor* cur=q_getImageArchived->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["archived"]);
+		ret.value=cur->getInt(cur->columnIndex("archived"));
 	}
+	cur->shutdown();
+	q_getImageArchived->Reset();
 	return ret;
 }
 
@@ -995,14 +1109,19 @@ std::vector<int> ServerCleanupDao::getAssocImageBackups(int img_id)
 		q_getAssocImageBackups=db->Prepare("SELECT assoc_id FROM assoc_images WHERE img_id=?", false);
 	}
 	q_getAssocImageBackups->Bind(img_id);
-	db_results res=q_getAssocImageBackups->Read();
-	q_getAssocImageBackups->Reset();
+	IDatabaseCursor* cur=q_getAssocImageBackups->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_assoc_id=cur->columnIndex("assoc_id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["assoc_id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_assoc_id));
 	}
+	cur->shutdown();
+	q_getAssocImageBackups->Reset();
 	return ret;
 }
 
@@ -1020,14 +1139,19 @@ std::vector<int> ServerCleanupDao::getAssocImageBackupsReverse(int assoc_id)
 		q_getAssocImageBackupsReverse=db->Prepare("SELECT img_id FROM assoc_images WHERE assoc_id=?", false);
 	}
 	q_getAssocImageBackupsReverse->Bind(assoc_id);
-	db_results res=q_getAssocImageBackupsReverse->Read();
-	q_getAssocImageBackupsReverse->Reset();
+	IDatabaseCursor* cur=q_getAssocImageBackupsReverse->Cursor();
 	std::vector<int> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_img_id=cur->columnIndex("img_id");
+	while(cur->next())
 	{
-		ret[i]=watoi(res[i]["img_id"]);
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(cur->getInt(c_img_id));
 	}
+	cur->shutdown();
+	q_getAssocImageBackupsReverse->Reset();
 	return ret;
 }
 
@@ -1046,14 +1170,15 @@ ServerCleanupDao::CondInt64 ServerCleanupDao::getImageSize(int backupid)
 		q_getImageSize=db->Prepare("SELECT size_bytes FROM backup_images WHERE id=?", false);
 	}
 	q_getImageSize->Bind(backupid);
-	db_results res=q_getImageSize->Read();
-	q_getImageSize->Reset();
+	IDatabaseCursor* cur=q_getImageSize->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["size_bytes"]);
+		ret.value=cur->getInt64(cur->columnIndex("size_bytes"));
 	}
+	cur->shutdown();
+	q_getImageSize->Reset();
 	return ret;
 }
 
@@ -1070,14 +1195,21 @@ std::vector<ServerCleanupDao::SClientInfo> ServerCleanupDao::getClients(void)
 	{
 		q_getClients=db->Prepare("SELECT id, name FROM clients", false);
 	}
-	db_results res=q_getClients->Read();
+	IDatabaseCursor* cur=q_getClients->Cursor();
 	std::vector<ServerCleanupDao::SClientInfo> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].name=res[i]["name"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_name=cur->columnIndex("name");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SClientInfo());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().name=cur->getString(c_name);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -1096,18 +1228,27 @@ std::vector<ServerCleanupDao::SFileBackupInfo> ServerCleanupDao::getFileBackupsO
 		q_getFileBackupsOfClient=db->Prepare("SELECT id, backuptime, path, done FROM backups WHERE clientid=? ORDER BY backuptime DESC", false);
 	}
 	q_getFileBackupsOfClient->Bind(clientid);
-	db_results res=q_getFileBackupsOfClient->Read();
-	q_getFileBackupsOfClient->Reset();
+	IDatabaseCursor* cur=q_getFileBackupsOfClient->Cursor();
 	std::vector<ServerCleanupDao::SFileBackupInfo> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].backuptime=res[i]["backuptime"];
-		ret[i].path=res[i]["path"];
-		ret[i].done=watoi(res[i]["done"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_backuptime=cur->columnIndex("backuptime");
+	int c_path=cur->columnIndex("path");
+	int c_done=cur->columnIndex("done");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SFileBackupInfo());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt(c_id);
+		ret.back().backuptime=cur->getString(c_backuptime);
+		ret.back().path=cur->getString(c_path);
+		ret.back().done=cur->getInt(c_done);
+	}
+	cur->shutdown();
+	q_getFileBackupsOfClient->Reset();
 	return ret;
 }
 
@@ -1126,18 +1267,27 @@ std::vector<ServerCleanupDao::SImageBackupInfo> ServerCleanupDao::getOldImageBac
 		q_getOldImageBackupsOfClient=db->Prepare("SELECT id, backuptime, letter, path FROM backup_images WHERE clientid=? AND running<datetime('now','-12 hours')", false);
 	}
 	q_getOldImageBackupsOfClient->Bind(clientid);
-	db_results res=q_getOldImageBackupsOfClient->Read();
-	q_getOldImageBackupsOfClient->Reset();
+	IDatabaseCursor* cur=q_getOldImageBackupsOfClient->Cursor();
 	std::vector<ServerCleanupDao::SImageBackupInfo> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].backuptime=res[i]["backuptime"];
-		ret[i].letter=res[i]["letter"];
-		ret[i].path=res[i]["path"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_backuptime=cur->columnIndex("backuptime");
+	int c_letter=cur->columnIndex("letter");
+	int c_path=cur->columnIndex("path");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageBackupInfo());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt(c_id);
+		ret.back().backuptime=cur->getString(c_backuptime);
+		ret.back().letter=cur->getString(c_letter);
+		ret.back().path=cur->getString(c_path);
+	}
+	cur->shutdown();
+	q_getOldImageBackupsOfClient->Reset();
 	return ret;
 }
 
@@ -1155,19 +1305,29 @@ std::vector<ServerCleanupDao::SImageBackupInfo> ServerCleanupDao::getImageBackup
 		q_getImageBackupsOfClient=db->Prepare("SELECT id, backuptime, letter, path, complete FROM backup_images WHERE clientid=?", false);
 	}
 	q_getImageBackupsOfClient->Bind(clientid);
-	db_results res=q_getImageBackupsOfClient->Read();
-	q_getImageBackupsOfClient->Reset();
+	IDatabaseCursor* cur=q_getImageBackupsOfClient->Cursor();
 	std::vector<ServerCleanupDao::SImageBackupInfo> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].backuptime=res[i]["backuptime"];
-		ret[i].letter=res[i]["letter"];
-		ret[i].path=res[i]["path"];
-		ret[i].complete=watoi(res[i]["complete"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_backuptime=cur->columnIndex("backuptime");
+	int c_letter=cur->columnIndex("letter");
+	int c_path=cur->columnIndex("path");
+	int c_complete=cur->columnIndex("complete");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SImageBackupInfo());
+		ret.back().exists=true;
+		ret.back().id=cur->getInt(c_id);
+		ret.back().backuptime=cur->getString(c_backuptime);
+		ret.back().letter=cur->getString(c_letter);
+		ret.back().path=cur->getString(c_path);
+		ret.back().complete=cur->getInt(c_complete);
+	}
+	cur->shutdown();
+	q_getImageBackupsOfClient->Reset();
 	return ret;
 }
 
@@ -1186,14 +1346,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::findFileBackup(int clientid, const s
 	}
 	q_findFileBackup->Bind(clientid);
 	q_findFileBackup->Bind(path);
-	db_results res=q_findFileBackup->Read();
-	q_findFileBackup->Reset();
+	IDatabaseCursor* cur=q_findFileBackup->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["id"]);
+		ret.value=cur->getInt(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_findFileBackup->Reset();
 	return ret;
 }
 
@@ -1211,14 +1372,15 @@ ServerCleanupDao::CondInt64 ServerCleanupDao::getUsedStorage(int clientid)
 		q_getUsedStorage=db->Prepare("SELECT (bytes_used_files+bytes_used_images) AS used_storage FROM clients WHERE id=?", false);
 	}
 	q_getUsedStorage->Bind(clientid);
-	db_results res=q_getUsedStorage->Read();
-	q_getUsedStorage->Reset();
+	IDatabaseCursor* cur=q_getUsedStorage->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["used_storage"]);
+		ret.value=cur->getInt64(cur->columnIndex("used_storage"));
 	}
+	cur->shutdown();
+	q_getUsedStorage->Reset();
 	return ret;
 }
 
@@ -1269,18 +1431,29 @@ std::vector<ServerCleanupDao::SIncompleteFileBackup> ServerCleanupDao::getIncomp
 	{
 		q_getIncompleteFileBackups=db->Prepare("SELECT b.id, b.clientid, b.incremental, b.backuptime, b.path, c.name AS clientname FROM backups b INNER JOIN clients c ON b.clientid=c.id WHERE complete=0 AND archived=0 AND delete_client_pending!=1 AND EXISTS ( SELECT * FROM backups e WHERE b.clientid = e.clientid AND e.backuptime>b.backuptime AND e.done=1)", false);
 	}
-	db_results res=q_getIncompleteFileBackups->Read();
+	IDatabaseCursor* cur=q_getIncompleteFileBackups->Cursor();
 	std::vector<ServerCleanupDao::SIncompleteFileBackup> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].clientid=watoi(res[i]["clientid"]);
-		ret[i].incremental=watoi(res[i]["incremental"]);
-		ret[i].backuptime=res[i]["backuptime"];
-		ret[i].path=res[i]["path"];
-		ret[i].clientname=res[i]["clientname"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_clientid=cur->columnIndex("clientid");
+	int c_incremental=cur->columnIndex("incremental");
+	int c_backuptime=cur->columnIndex("backuptime");
+	int c_path=cur->columnIndex("path");
+	int c_clientname=cur->columnIndex("clientname");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SIncompleteFileBackup());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().clientid=cur->getInt(c_clientid);
+		ret.back().incremental=cur->getInt(c_incremental);
+		ret.back().backuptime=cur->getString(c_backuptime);
+		ret.back().path=cur->getString(c_path);
+		ret.back().clientname=cur->getString(c_clientname);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -1299,18 +1472,29 @@ std::vector<ServerCleanupDao::SIncompleteFileBackup> ServerCleanupDao::getDelete
 	{
 		q_getDeletePendingFileBackups=db->Prepare("SELECT b.id, b.clientid, b.incremental, b.backuptime, b.path, c.name AS clientname FROM backups b INNER JOIN clients c ON b.clientid=c.id WHERE b.delete_pending=1 AND b.delete_client_pending!=1", false);
 	}
-	db_results res=q_getDeletePendingFileBackups->Read();
+	IDatabaseCursor* cur=q_getDeletePendingFileBackups->Cursor();
 	std::vector<ServerCleanupDao::SIncompleteFileBackup> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].clientid=watoi(res[i]["clientid"]);
-		ret[i].incremental=watoi(res[i]["incremental"]);
-		ret[i].backuptime=res[i]["backuptime"];
-		ret[i].path=res[i]["path"];
-		ret[i].clientname=res[i]["clientname"];
-	}
+	int c_id=cur->columnIndex("id");
+	int c_clientid=cur->columnIndex("clientid");
+	int c_incremental=cur->columnIndex("incremental");
+	int c_backuptime=cur->columnIndex("backuptime");
+	int c_path=cur->columnIndex("path");
+	int c_clientname=cur->columnIndex("clientname");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SIncompleteFileBackup());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().clientid=cur->getInt(c_clientid);
+		ret.back().incremental=cur->getInt(c_incremental);
+		ret.back().backuptime=cur->getString(c_backuptime);
+		ret.back().path=cur->getString(c_path);
+		ret.back().clientname=cur->getString(c_clientname);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -1335,22 +1519,36 @@ std::vector<ServerCleanupDao::SHistItem> ServerCleanupDao::getClientHistory(cons
 	q_getClientHistory->Bind(back_start);
 	q_getClientHistory->Bind(back_stop);
 	q_getClientHistory->Bind(date_grouping);
-	db_results res=q_getClientHistory->Read();
-	q_getClientHistory->Reset();
+	IDatabaseCursor* cur=q_getClientHistory->Cursor();
 	std::vector<ServerCleanupDao::SHistItem> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi(res[i]["id"]);
-		ret[i].name=res[i]["name"];
-		ret[i].lastbackup=res[i]["lastbackup"];
-		ret[i].lastseen=res[i]["lastseen"];
-		ret[i].lastbackup_image=res[i]["lastbackup_image"];
-		ret[i].bytes_used_files=watoi64(res[i]["bytes_used_files"]);
-		ret[i].bytes_used_images=watoi64(res[i]["bytes_used_images"]);
-		ret[i].max_created=res[i]["max_created"];
-		ret[i].hist_id=watoi64(res[i]["hist_id"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_name=cur->columnIndex("name");
+	int c_lastbackup=cur->columnIndex("lastbackup");
+	int c_lastseen=cur->columnIndex("lastseen");
+	int c_lastbackup_image=cur->columnIndex("lastbackup_image");
+	int c_bytes_used_files=cur->columnIndex("bytes_used_files");
+	int c_bytes_used_images=cur->columnIndex("bytes_used_images");
+	int c_max_created=cur->columnIndex("max_created");
+	int c_hist_id=cur->columnIndex("hist_id");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SHistItem());
+		ret.back().id=cur->getInt(c_id);
+		ret.back().name=cur->getString(c_name);
+		ret.back().lastbackup=cur->getString(c_lastbackup);
+		ret.back().lastseen=cur->getString(c_lastseen);
+		ret.back().lastbackup_image=cur->getString(c_lastbackup_image);
+		ret.back().bytes_used_files=cur->getInt64(c_bytes_used_files);
+		ret.back().bytes_used_images=cur->getInt64(c_bytes_used_images);
+		ret.back().max_created=cur->getString(c_max_created);
+		ret.back().hist_id=cur->getInt64(c_hist_id);
+	}
+	cur->shutdown();
+	q_getClientHistory->Reset();
 	return ret;
 }
 
@@ -1457,14 +1655,15 @@ ServerCleanupDao::CondInt ServerCleanupDao::hasMoreRecentFileBackup(int backupid
 		q_hasMoreRecentFileBackup=db->Prepare("SELECT id FROM backups b WHERE id=? AND EXISTS  (SELECT * FROM backups WHERE backuptime>b.backuptime  AND tgroup=b.tgroup AND clientid=b.clientid AND done=1)", false);
 	}
 	q_hasMoreRecentFileBackup->Bind(backupid);
-	db_results res=q_hasMoreRecentFileBackup->Read();
-	q_hasMoreRecentFileBackup->Reset();
+	IDatabaseCursor* cur=q_hasMoreRecentFileBackup->Cursor();
 	CondInt ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi(res[0]["id"]);
+		ret.value=cur->getInt(cur->columnIndex("id"));
 	}
+	cur->shutdown();
+	q_hasMoreRecentFileBackup->Reset();
 	return ret;
 }
 
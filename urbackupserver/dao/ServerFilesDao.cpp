@@ -18,6 +18,7 @@
 
 #include "ServerFilesDao.h"
 #include "../../stringtools.h"
+#include "../../Interface/DatabaseCursor.h"
 #include <assert.h>
 #include <string.h>
 
@@ -148,14 +149,15 @@ ServerFilesDao::CondInt64 ServerFilesDao::getPointedTo(int64 id)
 		q_getPointedTo=db->Prepare("SELECT pointed_to FROM files WHERE id=?", false);
 	}
 	q_getPointedTo->Bind(id);
-	db_results res=q_getPointedTo->Read();
-	q_getPointedTo->Reset();
+	IDatabaseCursor* cur=q_getPointedTo->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["pointed_to"]);
+		ret.value=cur->getInt64(cur->columnIndex("pointed_to"));
 	}
+	cur->shutdown();
+	q_getPointedTo->Reset();
 	return ret;
 }
 
@@ -191,25 +193,26 @@ ServerFilesDao::SFindFileEntry ServerFilesDao::getFileEntry(int64 id)
 		q_getFileEntry=db->Prepare("SELECT id, shahash, backupid, clientid, fullpath, hashpath, filesize, next_entry, prev_entry, rsize, incremental, pointed_to FROM files WHERE id=?", false);
 	}
 	q_getFileEntry->Bind(id);
-	db_results res=q_getFileEntry->Read();
-	q_getFileEntry->Reset();
+	IDatabaseCursor* cur=q_getFileEntry->Cursor();
 	SFindFileEntry ret = { false, 0, "", 0, 0, "", "", 0, 0, 0, 0, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.shahash=res[0]["shahash"];
-		ret.backupid=watoi(res[0]["backupid"]);
-		ret.clientid=watoi(res[0]["clientid"]);
-		ret.fullpath=res[0]["fullpath"];
-		ret.hashpath=res[0]["hashpath"];
-		ret.filesize=watoi64(res[0]["filesize"]);
-		ret.next_entry=watoi64(res[0]["next_entry"]);
-		ret.prev_entry=watoi64(res[0]["prev_entry"]);
-		ret.rsize=watoi64(res[0]["rsize"]);
-		ret.incremental=watoi(res[0]["incremental"]);
-		ret.pointed_to=watoi(res[0]["pointed_to"]);
-	}
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.shahash=cur->getString(cur->columnIndex("shahash"));
+		ret.backupid=cur->getInt(cur->columnIndex("backupid"));
+		ret.clientid=cur->getInt(cur->columnIndex("clientid"));
+		ret.fullpath=cur->getString(cur->columnIndex("fullpath"));
+		ret.hashpath=cur->getString(cur->columnIndex("hashpath"));
+		ret.filesize=cur->getInt64(cur->columnIndex("filesize"));
+		ret.next_entry=cur->getInt64(cur->columnIndex("next_entry"));
+		ret.prev_entry=cur->getInt64(cur->columnIndex("prev_entry"));
+		ret.rsize=cur->getInt64(cur->columnIndex("rsize"));
+		ret.incremental=cur->getInt(cur->columnIndex("incremental"));
+		ret.pointed_to=cur->getInt(cur->columnIndex("pointed_to"));
+	}
+	cur->shutdown();
+	q_getFileEntry->Reset();
 	return ret;
 }
 
@@ -228,21 +231,22 @@ ServerFilesDao::SStatFileEntry ServerFilesDao::getStatFileEntry(int64 id)
 		q_getStatFileEntry=db->Prepare("SELECT id, backupid, clientid, filesize, rsize, shahash, next_entry, prev_entry FROM files WHERE id=?", false);
 	}
 	q_getStatFileEntry->Bind(id);
-	db_results res=q_getStatFileEntry->Read();
-	q_getStatFileEntry->Reset();
+	IDatabaseCursor* cur=q_getStatFileEntry->Cursor();
 	SStatFileEntry ret = { false, 0, 0, 0, 0, 0, "", 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.id=watoi64(res[0]["id"]);
-		ret.backupid=watoi(res[0]["backupid"]);
-		ret.clientid=watoi(res[0]["clientid"]);
-		ret.filesize=watoi64(res[0]["filesize"]);
-		ret.rsize=watoi64(res[0]["rsize"]);
-		ret.shahash=res[0]["shahash"];
-		ret.next_entry=watoi64(res[0]["next_entry"]);
-		ret.prev_entry=watoi64(res[0]["prev_entry"]);
-	}
+		ret.id=cur->getInt64(cur->columnIndex("id"));
+		ret.backupid=cur->getInt(cur->columnIndex("backupid"));
+		ret.clientid=cur->getInt(cur->columnIndex("clientid"));
+		ret.filesize=cur->getInt64(cur->columnIndex("filesize"));
+		ret.rsize=cur->getInt64(cur->columnIndex("rsize"));
+		ret.shahash=cur->getString(cur->columnIndex("shahash"));
+		ret.next_entry=cur->getInt64(cur->columnIndex("next_entry"));
+		ret.prev_entry=cur->getInt64(cur->columnIndex("prev_entry"));
+	}
+	cur->shutdown();
+	q_getStatFileEntry->Reset();
 	return ret;
 }
 
@@ -370,14 +374,15 @@ ServerFilesDao::CondInt64 ServerFilesDao::lookupEntryIdByPath(const std::string&
 		q_lookupEntryIdByPath=db->Prepare("SELECT entryid FROM files_cont_path_lookup WHERE fullpath=?", false);
 	}
 	q_lookupEntryIdByPath->Bind(fullpath);
-	db_results res=q_lookupEntryIdByPath->Read();
-	q_lookupEntryIdByPath->Reset();
+	IDatabaseCursor* cur=q_lookupEntryIdByPath->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["entryid"]);
+		ret.value=cur->getInt64(cur->columnIndex("entryid"));
 	}
+	cur->shutdown();
+	q_lookupEntryIdByPath->Reset();
 	return ret;
 }
 
@@ -418,13 +423,14 @@ ServerFilesDao::CondInt64 ServerFilesDao::getIncomingStatsCount(void)
 	{
 		q_getIncomingStatsCount=db->Prepare("SELECT COUNT(*) AS c FROM files_incoming_stat", false);
 	}
-	db_results res=q_getIncomingStatsCount->Read();
+	IDatabaseCursor* cur=q_getIncomingStatsCount->Cursor();
 	CondInt64 ret = { false, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.value=watoi64(res[0]["c"]);
+		ret.value=cur->getInt64(cur->columnIndex("c"));
 	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -459,19 +465,31 @@ std::vector<ServerFilesDao::SIncomingStat> ServerFilesDao::getIncomingStats(void
 	{
 		q_getIncomingStats=db->Prepare("SELECT id, filesize, clientid, backupid, existing_clients, direction, incremental FROM files_incoming_stat LIMIT 10000", false);
 	}
-	db_results res=q_getIncomingStats->Read();
+	IDatabaseCursor* cur=q_getIncomingStats->Cursor();
 	std::vector<ServerFilesDao::SIncomingStat> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].id=watoi64(res[i]["id"]);
-		ret[i].filesize=watoi64(res[i]["filesize"]);
-		ret[i].clientid=watoi(res[i]["clientid"]);
-		ret[i].backupid=watoi(res[i]["backupid"]);
-		ret[i].existing_clients=res[i]["existing_clients"];
-		ret[i].direction=watoi(res[i]["direction"]);
-		ret[i].incremental=watoi(res[i]["incremental"]);
-	}
+	int c_id=cur->columnIndex("id");
+	int c_filesize=cur->columnIndex("filesize");
+	int c_clientid=cur->columnIndex("clientid");
+	int c_backupid=cur->columnIndex("backupid");
+	int c_existing_clients=cur->columnIndex("existing_clients");
+	int c_direction=cur->columnIndex("direction");
+	int c_incremental=cur->columnIndex("incremental");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SIncomingStat());
+		ret.back().id=cur->getInt64(c_id);
+		ret.back().filesize=cur->getInt64(c_filesize);
+		ret.back().clientid=cur->getInt(c_clientid);
+		ret.back().backupid=cur->getInt(c_backupid);
+		ret.back().existing_clients=cur->getString(c_existing_clients);
+		ret.back().direction=cur->getInt(c_direction);
+		ret.back().incremental=cur->getInt(c_incremental);
+	}
+	cur->shutdown();
 	return ret;
 }
 
@@ -605,17 +623,18 @@ ServerFilesDao::SFileEntry ServerFilesDao::getFileEntryFromTemporaryTable(const
 		q_getFileEntryFromTemporaryTable=db->Prepare("SELECT fullpath, hashpath, shahash, filesize FROM files_last WHERE fullpath = ?", false);
 	}
 	q_getFileEntryFromTemporaryTable->Bind(fullpath);
-	db_results res=q_getFileEntryFromTemporaryTable->Read();
-	q_getFileEntryFromTemporaryTable->Reset();
+	IDatabaseCursor* cur=q_getFileEntryFromTemporaryTable->Cursor();
 	SFileEntry ret = { false, "", "", "", 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.fullpath=res[0]["fullpath"];
-		ret.hashpath=res[0]["hashpath"];
-		ret.shahash=res[0]["shahash"];
-		ret.filesize=watoi64(res[0]["filesize"]);
+		ret.fullpath=cur->getString(cur->columnIndex("fullpath"));
+		ret.hashpath=cur->getString(cur->columnIndex("hashpath"));
+		ret.shahash=cur->getString(cur->columnIndex("shahash"));
+		ret.filesize=cur->getInt64(cur->columnIndex("filesize"));
 	}
+	cur->shutdown();
+	q_getFileEntryFromTemporaryTable->Reset();
 	return ret;
 }
 
@@ -635,18 +654,27 @@ std::vector<ServerFilesDao::SFileEntry> ServerFilesDao::getFileEntriesFromTempor
 		q_getFileEntriesFromTemporaryTableGlob=db->Prepare("SELECT fullpath, hashpath, shahash, filesize FROM files_last WHERE fullpath GLOB ?", false);
 	}
 	q_getFileEntriesFromTemporaryTableGlob->Bind(fullpath_glob);
-	db_results res=q_getFileEntriesFromTemporaryTableGlob->Read();
-	q_getFileEntriesFromTemporaryTableGlob->Reset();
+	IDatabaseCursor* cur=q_getFileEntriesFromTemporaryTableGlob->Cursor();
 	std::vector<ServerFilesDao::SFileEntry> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
-	{
-		ret[i].exists=true;
-		ret[i].fullpath=res[i]["fullpath"];
-		ret[i].hashpath=res[i]["hashpath"];
-		ret[i].shahash=res[i]["shahash"];
-		ret[i].filesize=watoi64(res[i]["filesize"]);
-	}
+	int c_fullpath=cur->columnIndex("fullpath");
+	int c_hashpath=cur->columnIndex("hashpath");
+	int c_shahash=cur->columnIndex("shahash");
+	int c_filesize=cur->columnIndex("filesize");
+	while(cur->next())
+	{
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(SFileEntry());
+		ret.back().exists=true;
+		ret.back().fullpath=cur->getString(c_fullpath);
+		ret.back().hashpath=cur->getString(c_hashpath);
+		ret.back().shahash=cur->getString(c_shahash);
+		ret.back().filesize=cur->getInt64(c_filesize);
+	}
+	cur->shutdown();
+	q_getFileEntriesFromTemporaryTableGlob->Reset();
 	return ret;
 }
 
@@ -664,15 +692,16 @@ ServerFilesDao::SBackupIdMinMax ServerFilesDao::getBackupIdMinMax(int backupid)
 		q_getBackupIdMinMax=db->Prepare("SELECT MIN(id) AS tmin, MAX(id) AS tmax FROM files WHERE backupid=?", false);
 	}
 	q_getBackupIdMinMax->Bind(backupid);
-	db_results res=q_getBackupIdMinMax->Read();
-	q_getBackupIdMinMax->Reset();
+	IDatabaseCursor* cur=q_getBackupIdMinMax->Cursor();
 	SBackupIdMinMax ret = { false, 0, 0 };
-	if(!res.empty())
+	if(cur->next())
 	{
 		ret.exists=true;
-		ret.tmin=watoi64(res[0]["tmin"]);
-		ret.tmax=watoi64(res[0]["tmax"]);
+		ret.tmin=cur->getInt64(cur->columnIndex("tmin"));
+		ret.tmax=cur->getInt64(cur->columnIndex("tmax"));
 	}
+	cur->shutdown();
+	q_getBackupIdMinMax->Reset();
 	return ret;
 }
 
@@ -18,6 +18,7 @@
 
 #include "ServerLinkDao.h"
 #include "../../stringtools.h"
+#include "../../Interface/DatabaseCursor.h"
 #include <assert.h>
 #include <string.h>
 
@@ -152,10 +153,13 @@ int ServerLinkDao::getDirectoryRefcount(int clientid, const std::string& name)
 	}
 	q_getDirectoryRefcount->Bind(clientid);
 	q_getDirectoryRefcount->Bind(name);
-	db_results res=q_getDirectoryRefcount->Read();
+	IDatabaseCursor* cur=q_getDirectoryRefcount->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int ret=has_row ? cur->getInt(cur->columnIndex("c")) : 0;
+	cur->shutdown();
 	q_getDirectoryRefcount->Reset();
-	assert(!res.empty());
-	return watoi(res[0]["c"]);
+	return ret;
 }
 
 /**
@@ -178,10 +182,13 @@ int ServerLinkDao::getDirectoryRefcountWithTarget(int clientid, const std::strin
 	q_getDirectoryRefcountWithTarget->Bind(clientid);
 	q_getDirectoryRefcountWithTarget->Bind(name);
 	q_getDirectoryRefcountWithTarget->Bind(target);
-	db_results res=q_getDirectoryRefcountWithTarget->Read();
+	IDatabaseCursor* cur=q_getDirectoryRefcountWithTarget->Cursor();
+	bool has_row=cur->next();
+	assert(has_row);
+	int ret=has_row ? cur->getInt(cur->columnIndex("c")) : 0;
+	cur->shutdown();
 	q_getDirectoryRefcountWithTarget->Reset();
-	assert(!res.empty());
-	return watoi(res[0]["c"]);
+	return ret;
 }
 
 /**
@@ -201,15 +208,22 @@ std::vector<ServerLinkDao::DirectoryLinkEntry> ServerLinkDao::getLinksInDirector
 	}
 	q_getLinksInDirectory->Bind(clientid);
 	q_getLinksInDirectory->Bind(dir);
-	db_results res=q_getLinksInDirectory->Read();
-	q_getLinksInDirectory->Reset();
+	IDatabaseCursor* cur=q_getLinksInDirectory->Cursor();
 	std::vector<ServerLinkDao::DirectoryLinkEntry> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_name=cur->columnIndex("name");
+	int c_target=cur->columnIndex("target");
+	while(cur->next())
 	{
-		ret[i].name=res[i]["name"];
-		ret[i].target=res[i]["target"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(DirectoryLinkEntry());
+		ret.back().name=cur->getString(c_name);
+		ret.back().target=cur->getString(c_target);
 	}
+	cur->shutdown();
+	q_getLinksInDirectory->Reset();
 	return ret;
 }
 
@@ -230,15 +244,22 @@ std::vector<ServerLinkDao::DirectoryLinkEntry> ServerLinkDao::getLinksByPoolName
 	}
 	q_getLinksByPoolName->Bind(clientid);
 	q_getLinksByPoolName->Bind(name);
-	db_results res=q_getLinksByPoolName->Read();
-	q_getLinksByPoolName->Reset();
+	IDatabaseCursor* cur=q_getLinksByPoolName->Cursor();
 	std::vector<ServerLinkDao::DirectoryLinkEntry> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_name=cur->columnIndex("name");
+	int c_target=cur->columnIndex("target");
+	while(cur->next())
 	{
-		ret[i].name=res[i]["name"];
-		ret[i].target=res[i]["target"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(DirectoryLinkEntry());
+		ret.back().name=cur->getString(c_name);
+		ret.back().target=cur->getString(c_target);
 	}
+	cur->shutdown();
+	q_getLinksByPoolName->Reset();
 	return ret;
 }
 
@@ -19,6 +19,7 @@
 
 #include "ServerLinkJournalDao.h"
 #include "../../stringtools.h"
+#include "../../Interface/DatabaseCursor.h"
 #include <assert.h>
 #include <string.h>
 
@@ -83,14 +84,21 @@ std::vector<ServerLinkJournalDao::JournalEntry> ServerLinkJournalDao::getDirecto
 	{
 		q_getDirectoryLinkJournalEntries=db->Prepare("SELECT linkname, linktarget FROM directory_link_journal", false);
 	}
-	db_results res=q_getDirectoryLinkJournalEntries->Read();
+	IDatabaseCursor* cur=q_getDirectoryLinkJournalEntries->Cursor();
 	std::vector<ServerLinkJournalDao::JournalEntry> ret;
-	ret.resize(res.size());
-	for(size_t i=0;i<res.size();++i)
+	int c_linkname=cur->columnIndex("linkname");
+	int c_linktarget=cur->columnIndex("linktarget");
+	while(cur->next())
 	{
-		ret[i].linkname=res[i]["linkname"];
-		ret[i].linktarget=res[i]["linktarget"];
+		if(cur->restarted())
+		{
+			ret.clear();
+		}
+		ret.push_back(JournalEntry());
+		ret.back().linkname=cur->getString(c_linkname);
+		ret.back().linktarget=cur->getString(c_linktarget);
 	}
+	cur->shutdown();
 	return ret;
 }
 
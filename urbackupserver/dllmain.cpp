@@ -87,6 +87,8 @@ SStartupStatus startup_status;
 #include "DataplanDb.h"
 #include "Alerts.h"
 #include "Mailer.h"
+#include "PrepareHashPool.h"
+#include "BackupScheduler.h"
 #include "../urbackupcommon/settingslist.h"
 
 #include <stdlib.h>
@@ -155,6 +157,16 @@ bool verify_hashes(std::string arg);
 void updateRights(int t_userid, std::string s_rights, IDatabase *db);
 int md5sum_check();
 int blockalign();
+int treediff_bench();
+int filelist_parse_bench();
+int memorypipe_bench();
+int compressedimage_bench();
+int filesdao_bench();
+int clouddrive_bench();
+int kvcache_bench();
+int bufzero_bench();
+int chunkhash_bench();
+int sha_bench();
 void init_server_pubkey();
 
 std::string lang="en";
@@ -529,10 +541,50 @@ DLLEXPORT void LoadActions(IServer* pServer)
 		{
 			rc = blockalign();
 		}
+		else if (app == "treediff_bench")
+		{
+			rc = treediff_bench();
+		}
+		else if (app == "filelist_parse_bench")
+		{
+			rc = filelist_parse_bench();
+		}
+		else if (app == "memorypipe_bench")
+		{
+			rc = memorypipe_bench();
+		}
+		else if (app == "compressedimage_bench")
+		{
+			rc = compressedimage_bench();
+		}
+		else if (app == "filesdao_bench")
+		{
+			rc = filesdao_bench();
+		}
+		else if (app == "clouddrive_bench")
+		{
+			rc = clouddrive_bench();
+		}
+		else if (app == "kvcache_bench")
+		{
+			rc = kvcache_bench();
+		}
+		else if (app == "bufzero_bench")
+		{
+			rc = bufzero_bench();
+		}
+		else if (app == "chunkhash_bench")
+		{
+			rc = chunkhash_bench();
+		}
+		else if (app == "sha_bench")
+		{
+			rc = sha_bench();
+		}
 		else
 		{
 			rc=100;
-			Server->Log("App not found. Available apps: cleanup, remove_unknown, cleanup_database, repair_database, defrag_database, export_auth_log, check_fileindex, skiphash_copy, md5sum_check, hash, blockalign");
+			Server->Log("App not found. Available apps: cleanup, remove_unknown, cleanup_database, repair_database, defrag_database, export_auth_log, check_fileindex, skiphash_copy, md5sum_check, hash, blockalign, treediff_bench, filelist_parse_bench, memorypipe_bench, compressedimage_bench, filesdao_bench, clouddrive_bench, kvcache_bench, bufzero_bench, chunkhash_bench, sha_bench");
 		}
 		exit(rc);
 	}
@@ -665,9 +717,11 @@ DLLEXPORT void LoadActions(IServer* pServer)
 	ServerStatus::init_mutex();
 	ServerSettings::init_mutex();
 	ClientMain::init_mutex();
+	BackupScheduler::init_mutex();
 	DataplanDb::init();
 	init_log_report();
 	ServerChannelThread::init_mutex();
+	PrepareHashPool::init();
 
 	open_settings_database();
 	
@@ -1001,6 +1055,7 @@ DLLEXPORT void UnloadActions(void)
 		ServerSettings::clear_cache();
 		ServerSettings::destroy_mutex();
 		ServerStatus::destroy_mutex();
+		BackupScheduler::destroy_mutex();
 		WalCheckpointThread::destroy_mutex();
 		destroy_dir_link_mutex();
 		Server->wait(1000);
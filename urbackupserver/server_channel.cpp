@@ -1195,6 +1195,10 @@ void ServerChannelThread::DOWNLOAD_IMAGE(str_map& params)
 		{
 			vhdfile = image_fak->createVHDFile(res[0]["path"], true, 0, 2 * 1024 * 1024, false, IFSImageFactory::ImageFormat_RawCowFile); 
 		}
+		else if (file_extension == "dedup")
+		{
+			vhdfile = image_fak->createVHDFile(res[0]["path"], true, 0, 2 * 1024 * 1024, false, IFSImageFactory::ImageFormat_Dedup);
+		}
 		else
 		{
 			vhdfile = image_fak->createVHDFile(res[0]["path"], true, 0);
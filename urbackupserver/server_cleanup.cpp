@@ -47,9 +47,12 @@
 #include "../clouddrive/IClouddriveFactory.h"
 #include "../urbackupcommon/backup_url_parser.h"
 #include "copy_storage.h"
+#include "../fsimageplugin/IFSImageFactory.h"
 #include <assert.h>
 #include <set>
 
+extern IFSImageFactory *image_fak;
+
 IMutex *ServerCleanupThread::mutex=NULL;
 ICondition *ServerCleanupThread::cond=NULL;
 bool ServerCleanupThread::update_stats=false;
@@ -646,7 +649,8 @@ void ServerCleanupThread::do_remove_unknown(void)
 					{
 						std::string extension = findextension(image_files[l].name);
 
-						if (extension != "vhd" && extension != "vhdz" && extension != "raw")
+						if (extension != "vhd" && extension != "vhdz" && extension != "raw"
+							&& extension != "dedup")
 							continue;
 
 						found_image = true;
@@ -701,7 +705,8 @@ void ServerCleanupThread::do_remove_unknown(void)
 			{
 				std::string extension=findextension(cf.name);
 
-				if(extension!="vhd" && extension!="vhdz" && extension!="raw")
+				if(extension!="vhd" && extension!="vhdz" && extension!="raw"
+					&& extension!="dedup")
 					continue;
 
 				bool found=false;
@@ -740,6 +745,13 @@ void ServerCleanupThread::do_remove_unknown(void)
 		check_symlinks(res_clients[i], backupfolder, false);
 	}
 
+	//Also picks up blocks of the dedup images deleted above
+	Server->Log("Removing unused image blocks...", LL_INFO);
+	if (!image_fak->collectDedupGarbage(os_file_prefix(settings.getSettings()->backupfolder_uncompr + os_file_sep() + image_block_store_dir)))
+	{
+		Server->Log("Error removing unused image blocks", LL_ERROR);
+	}
+
 	Server->Log("Removing dangling file entries...", LL_INFO);
 
 	IQuery* q_backup_ids = db->Prepare("SELECT id FROM backups", false);
@@ -825,7 +837,16 @@ bool ServerCleanupThread::deleteImage(logid_t logid, std::string clientname, std
 		|| !BackupServer::isImageSnapshotsEnabled())
 	{
 		bool b = true;
-		if (!deleteAndTruncateFile(logid, path))
+		if (image_extension == "dedup")
+		{
+			if (!image_fak->removeDedupVHDFile(os_file_prefix(path))
+				&& (os_get_file_type(os_file_prefix(path)) & EFileType_File))
+			{
+				ServerLogger::Log(logid, "Error deleting dedup image \"" + path + "\"", LL_ERROR);
+				b = false;
+			}
+		}
+		else if (!deleteAndTruncateFile(logid, path))
 		{
 			b = false;
 		}
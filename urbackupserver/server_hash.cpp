@@ -41,6 +41,7 @@
 
 const size_t freespace_mod=50*1024*1024; //50 MB
 const size_t BUFFER_SIZE=64*1024; //64KB
+const size_t c_index_batch_size=64;
 
 IMutex * delete_mutex=NULL;
 
@@ -65,6 +66,8 @@ BackupServerHash::BackupServerHash(IPipe *pPipe, int pClientid, bool use_snapsho
 	space_logcnt=0;
 	working=false;
 	has_error=false;
+	index_batching=false;
+	n_queued=0;
 	chunk_patcher.setCallback(this);
 	fileindex=NULL;
 
@@ -101,11 +104,29 @@ void BackupServerHash::operator()(void)
 {
 	setupDatabase();
 
+	std::deque<std::string> queued;
+
 	while(true)
 	{
 		working=false;
 		std::string data;
-		size_t rc=pipe->Read(&data, static_cast<int>(60000) );
+		size_t rc;
+		if(!queued.empty())
+		{
+			data.swap(queued.front());
+			queued.pop_front();
+			--n_queued;
+			rc=data.size();
+		}
+		else
+		{
+			rc=pipe->Read(&data, static_cast<int>(60000) );
+			if(rc>0)
+			{
+				prefetchIndexBatch(data, queued);
+			}
+		}
+
 		if(rc==0)
 		{
 			link_logcnt=0;
@@ -1096,7 +1117,7 @@ ServerFilesDao::SFindFileEntry BackupServerHash::findFileHash(const std::string
 	bool switch_to_next_client=false;
 	if(state.state==0)
 	{
-		entryid = fileindex->get_with_cache_prefer_client(FileIndex::SIndexKey(pHash.c_str(), filesize, clientid));
+		entryid = fileindex->get_prefetched_prefer_client(FileIndex::SIndexKey(pHash.c_str(), filesize, clientid), index_prefetch);
 		state.state=1;
 		save_orig=true;
 	}
@@ -1227,6 +1248,83 @@ ServerFilesDao::SFindFileEntry BackupServerHash::findFileHash(const std::string
 	return state.prev;
 }
 
+namespace
+{
+	bool get_link_or_copy_key(const std::string& data, std::string& sha2, int64& filesize)
+	{
+		CRData rd(&data);
+
+		int iaction;
+		if(!rd.getInt(&iaction)
+			|| iaction!=BackupServerHash::EAction_LinkOrCopy)
+		{
+			return false;
+		}
+
+		int64 fileid;
+		std::string str;
+		int ival;
+		char cval;
+		return rd.getVarInt(&fileid)
+			&& rd.getStr(&str) //temp_fn
+			&& rd.getInt(&ival) //backupid
+			&& rd.getInt(&ival) //incremental
+			&& rd.getChar(&cval) //with_hashes
+			&& rd.getStr(&str) //tfn
+			&& rd.getStr(&str) //hashpath
+			&& rd.getStr(&sha2)
+			&& rd.getStr(&str) //hashoutput_fn
+			&& rd.getStr(&str) //old_file_fn
+			&& rd.getInt64(&filesize)
+			&& sha2.size()>=bytes_in_index;
+	}
+}
+
+void BackupServerHash::prefetchIndexBatch(const std::string& first, std::deque<std::string>& queued)
+{
+	if(!index_batching
+		|| first=="exit" || first=="flush")
+	{
+		return;
+	}
+
+	std::vector<FileIndex::SIndexKey> keys;
+	std::string sha2;
+	int64 filesize;
+
+	if(get_link_or_copy_key(first, sha2, filesize))
+	{
+		keys.push_back(FileIndex::SIndexKey(sha2.c_str(), filesize, clientid));
+	}
+
+	std::string data;
+	while(queued.size()+1<c_index_batch_size
+		&& pipe->Read(&data, 0)>0)
+	{
+		queued.push_back(data);
+		++n_queued;
+
+		if(data=="exit")
+		{
+			break;
+		}
+
+		if(get_link_or_copy_key(data, sha2, filesize))
+		{
+			keys.push_back(FileIndex::SIndexKey(sha2.c_str(), filesize, clientid));
+		}
+	}
+
+	if(keys.size()>1)
+	{
+		fileindex->prefetch_prefer_client(keys, index_prefetch);
+	}
+	else
+	{
+		index_prefetch.prefer_client.clear();
+	}
+}
+
 IFsFile* BackupServerHash::openFileRetry(const std::string &dest, int mode, std::string& errstr)
 {
 	IFsFile *dst=NULL;
@@ -1380,6 +1478,16 @@ bool BackupServerHash::isWorking(void)
 	return working;
 }
 
+void BackupServerHash::setIndexBatching(bool b)
+{
+	index_batching=b;
+}
+
+size_t BackupServerHash::getNumQueued(void)
+{
+	return n_queued;
+}
+
 bool BackupServerHash::hasError(void)
 {
 	volatile bool r=has_error;
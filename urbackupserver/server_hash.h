@@ -12,6 +12,8 @@
 #include "dao/ServerFilesDao.h"
 #include <vector>
 #include <map>
+#include <deque>
+#include <atomic>
 #include "../urbackupcommon/chunk_hasher.h"
 #include "server_log.h"
 #include "../urbackupcommon/ExtentIterator.h"
@@ -52,6 +54,13 @@ public:
 	
 	bool isWorking(void);
 
+	//Allows taking queued items from the pipe for batched index lookups.
+	//Only enable if this is the only thread reading from the pipe
+	void setIndexBatching(bool b);
+
+	//Number of items taken from the pipe that are not processed yet
+	size_t getNumQueued(void);
+
 	bool hasError(void);
 
 	virtual bool handle_not_enough_space(const std::string &path);
@@ -115,6 +124,8 @@ private:
 
 	ServerFilesDao::SFindFileEntry findFileHash(const std::string &pHash, _i64 filesize, int clientid, SFindState& state);
 
+	void prefetchIndexBatch(const std::string& first, std::deque<std::string>& queued);
+
 	bool copyFile(IFile *tf, const std::string &dest, ExtentIterator* extent_iterator);
 	bool copyFileWithHashoutput(IFile *tf, const std::string &dest, const std::string hash_dest, ExtentIterator* extent_iterator);
 	bool freeSpace(int64 fs, const std::string &fp);
@@ -151,6 +162,8 @@ private:
 
 	volatile bool working;
 	volatile bool has_error;
+	bool index_batching;
+	std::atomic<size_t> n_queued;
 
 	IFsFile *chunk_output_fn;
 	ChunkPatcher chunk_patcher;
@@ -165,6 +178,7 @@ private:
 	_i64 cow_filesize;
 
 	FileIndex *fileindex;
+	FileIndex::SPrefetch index_prefetch;
 
 	std::string backupfolder;
 	bool old_backupfolders_loaded;
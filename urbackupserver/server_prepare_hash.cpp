@@ -28,35 +28,21 @@
 #include "../fileservplugin/chunk_settings.h"
 #include "../md5.h"
 #include <memory.h>
+#include <algorithm>
 #include "../common/adler32.h"
+#include "../common/buf_is_zero.h"
 #include "../urbackupcommon/file_metadata.h"
 
 namespace
 {
-	bool buf_is_zero(const char* buf, size_t bsize)
-	{
-		for (size_t i = 0; i < bsize; ++i)
-		{
-			if (buf[i] != 0)
-			{
-				return false;
-			}
-		}
-
-		return true;
-	}
-
 	const size_t hash_bsize = 512*1024;
 }
 
-BackupServerPrepareHash::BackupServerPrepareHash(IPipe *pPipe, IPipe *pOutput, int pClientid,
+BackupServerPrepareHash::BackupServerPrepareHash(int pClientid,
 	logid_t logid, bool ignore_hash_mismatch)
 	: logid(logid), ignore_hash_mismatch(ignore_hash_mismatch)
 {
-	pipe=pPipe;
-	output=pOutput;
 	clientid=pClientid;
-	working=false;
 	chunk_patcher.setCallback(this);
 	chunk_patcher.setWithSparse(true);
 	has_error=false;
@@ -66,225 +52,211 @@ BackupServerPrepareHash::~BackupServerPrepareHash(void)
 {
 }
 
-void BackupServerPrepareHash::operator()(void)
+bool BackupServerPrepareHash::prepareFile(const std::string& data, std::string& output_data)
 {
-	while(true)
-	{
-		working=false;
-		std::string data;
-		size_t rc=pipe->Read(&data);
-		if(data=="exit")
-		{
-			output->Write("exit");
-			pipe->Write("exit");
-			Server->Log("server_prepare_hash Thread finished (exit)");
-			delete this;
-			return;
-		}
-		else if(data=="flush")
-		{
-			continue;
-		}
+	CRData rd(&data);
 
-		if(rc>0)
-		{
-			working=true;
-			
-			CRData rd(&data);
+	int64 fileid;
+	rd.getVarInt(&fileid);
 
-			int64 fileid;
-			rd.getVarInt(&fileid);
+	std::string temp_fn;
+	rd.getStr(&temp_fn);
 
-			std::string temp_fn;
-			rd.getStr(&temp_fn);
+	int backupid;
+	rd.getInt(&backupid);
 
-			int backupid;
-			rd.getInt(&backupid);
+	int incremental;
+	rd.getInt(&incremental);
 
-			int incremental;
-			rd.getInt(&incremental);
+	char with_hashes;
+	rd.getChar(&with_hashes);
 
-			char with_hashes;
-			rd.getChar(&with_hashes);
+	std::string tfn;
+	rd.getStr(&tfn);
 
-			std::string tfn;
-			rd.getStr(&tfn);
+	std::string hashpath;
+	rd.getStr(&hashpath);
 
-			std::string hashpath;
-			rd.getStr(&hashpath);
+	std::string hashoutput_fn;
+	rd.getStr(&hashoutput_fn);
 
-			std::string hashoutput_fn;
-			rd.getStr(&hashoutput_fn);
+	bool diff_file=!hashoutput_fn.empty();
 
-			bool diff_file=!hashoutput_fn.empty();
+	std::string old_file_fn;
+	rd.getStr(&old_file_fn);
 
-			std::string old_file_fn;
-			rd.getStr(&old_file_fn);
+	int64 t_filesize;
+	rd.getInt64(&t_filesize);
 
-			int64 t_filesize;
-			rd.getInt64(&t_filesize);
+	std::string client_sha_dig;
+	rd.getStr(&client_sha_dig);
 
-			std::string client_sha_dig;
-			rd.getStr(&client_sha_dig);
+	std::string sparse_extents_fn;
+	rd.getStr(&sparse_extents_fn);
 
-			std::string sparse_extents_fn;
-			rd.getStr(&sparse_extents_fn);
+	char c_hash_func;
+	rd.getChar(&c_hash_func);
 
-			char c_hash_func;
-			rd.getChar(&c_hash_func);
+	char c_has_snapshot;
+	rd.getChar(&c_has_snapshot);
 
-			char c_has_snapshot;
-			rd.getChar(&c_has_snapshot);
+	bool has_snapshot = c_has_snapshot == 1;
 
-			bool has_snapshot = c_has_snapshot == 1;
-			
-			FileMetadata metadata;
-			metadata.read(rd);
+	std::string received_hash;
+	rd.getStr(&received_hash);
+	
+	FileMetadata metadata;
+	metadata.read(rd);
 
-			IFile *tf=Server->openFile(os_file_prefix((temp_fn)), MODE_READ);
-			IFile *old_file=NULL;
-			if(diff_file)
+	IFile *tf=Server->openFile(os_file_prefix((temp_fn)), MODE_READ);
+	IFile *old_file=NULL;
+	if(diff_file)
+	{
+		old_file=Server->openFile(os_file_prefix((old_file_fn)), MODE_READ);
+		if(old_file==NULL)
+		{
+			ServerLogger::Log(logid, "Error opening file \""+old_file_fn+"\" for reading. File: old_file. "+os_last_error_str()+" Target path: \""+tfn+"\"", LL_ERROR);
+			has_error=true;
+			if(tf!=NULL) Server->destroy(tf);
+			return false;
+		}
+	}
+
+	if(tf==NULL)
+	{
+		ServerLogger::Log(logid, "Error opening file \""+temp_fn+"\" for reading file. File: temp_fn. "+os_last_error_str()+" Target path: \""+tfn+"\"", LL_ERROR);
+		has_error=true;
+		if(old_file!=NULL)
+		{
+			Server->destroy(old_file);
+		}
+	}
+	else
+	{
+		std::unique_ptr<ExtentIterator> extent_iterator;
+		if (!sparse_extents_fn.empty())
+		{
+			IFile* sparse_extents_f = Server->openFile(sparse_extents_fn, MODE_READ);
+
+			if (sparse_extents_f != NULL)
 			{
-				old_file=Server->openFile(os_file_prefix((old_file_fn)), MODE_READ);
-				if(old_file==NULL)
-				{
-					ServerLogger::Log(logid, "Error opening file \""+old_file_fn+"\" for reading. File: old_file. "+os_last_error_str()+" Target path: \""+tfn+"\"", LL_ERROR);
-					has_error=true;
-					if(tf!=NULL) Server->destroy(tf);
-					continue;
-				}
+				extent_iterator.reset(new ExtentIterator(sparse_extents_f, true, hash_bsize));
 			}
+		}
 
-			if(tf==NULL)
+		ServerLogger::Log(logid, "PT: Hashing file \""+ExtractFileName(tfn)+"\"", LL_DEBUG);
+		std::string h;
+		if(!diff_file && !received_hash.empty())
+		{
+			h = received_hash;
+		}
+		else if(!diff_file)
+		{
+			if (c_hash_func == HASH_FUNC_SHA512_NO_SPARSE
+				|| c_hash_func == HASH_FUNC_SHA512)
 			{
-				ServerLogger::Log(logid, "Error opening file \""+temp_fn+"\" for reading file. File: temp_fn. "+os_last_error_str()+" Target path: \""+tfn+"\"", LL_ERROR);
-				has_error=true;
-				if(old_file!=NULL)
+				HashSha512 hashsha;
+				if (hash_sha(tf, extent_iterator.get(), c_hash_func != HASH_FUNC_SHA512_NO_SPARSE, hashsha))
 				{
-					Server->destroy(old_file);
+					h = hashsha.finalize();
 				}
 			}
 			else
 			{
-				std::unique_ptr<ExtentIterator> extent_iterator;
-				if (!sparse_extents_fn.empty())
+				TreeHash treehash(NULL);
+				if (hash_sha(tf, extent_iterator.get(), true, treehash))
 				{
-					IFile* sparse_extents_f = Server->openFile(sparse_extents_fn, MODE_READ);
-
-					if (sparse_extents_f != NULL)
-					{
-						extent_iterator.reset(new ExtentIterator(sparse_extents_f, true, hash_bsize));
-					}
+					h = treehash.finalize();
 				}
-
-				ServerLogger::Log(logid, "PT: Hashing file \""+ExtractFileName(tfn)+"\"", LL_DEBUG);
-				std::string h;
-				if(!diff_file)
+			}
+			
+		}
+		else
+		{
+			if (c_hash_func == HASH_FUNC_SHA512_NO_SPARSE
+				|| c_hash_func == HASH_FUNC_SHA512)
+			{
+				hashoutput_f = NULL;
+				HashSha512 hashsha;
+				hashf = &hashsha;
+				if (hash_with_patch(old_file, tf, extent_iterator.get(), c_hash_func != HASH_FUNC_SHA512_NO_SPARSE))
 				{
-					if (c_hash_func == HASH_FUNC_SHA512_NO_SPARSE
-						|| c_hash_func == HASH_FUNC_SHA512)
-					{
-						HashSha512 hashsha;
-						if (hash_sha(tf, extent_iterator.get(), c_hash_func != HASH_FUNC_SHA512_NO_SPARSE, hashsha))
-						{
-							h = hashsha.finalize();
-						}
-					}
-					else
-					{
-						TreeHash treehash(NULL);
-						if (hash_sha(tf, extent_iterator.get(), true, treehash))
-						{
-							h = treehash.finalize();
-						}
-					}
-					
+					h = hashsha.finalize();
 				}
-				else
+				hashf = NULL;
+			}
+			else
+			{
+				std::unique_ptr<IFile> l_hashoutput_f(Server->openFile(os_file_prefix(hashoutput_fn), MODE_READ));
+				hashoutput_f = l_hashoutput_f.get();
+				TreeHash treehash(NULL);
+				hashf = &treehash;
+				if (hash_with_patch(old_file, tf, extent_iterator.get(), true))
 				{
-					if (c_hash_func == HASH_FUNC_SHA512_NO_SPARSE
-						|| c_hash_func == HASH_FUNC_SHA512)
-					{
-						hashoutput_f = NULL;
-						HashSha512 hashsha;
-						hashf = &hashsha;
-						if (hash_with_patch(old_file, tf, extent_iterator.get(), c_hash_func != HASH_FUNC_SHA512_NO_SPARSE))
-						{
-							h = hashsha.finalize();
-						}
-						hashf = NULL;
-					}
-					else
-					{
-						std::unique_ptr<IFile> l_hashoutput_f(Server->openFile(os_file_prefix(hashoutput_fn), MODE_READ));
-						hashoutput_f = l_hashoutput_f.get();
-						TreeHash treehash(NULL);
-						hashf = &treehash;
-						if (hash_with_patch(old_file, tf, extent_iterator.get(), true))
-						{
-							h = treehash.finalize();
-						}
-						hashf = NULL;
-						hashoutput_f = NULL;
-					}
+					h = treehash.finalize();
 				}
+				hashf = NULL;
+				hashoutput_f = NULL;
+			}
+		}
 
-				if (h.empty())
+		if (h.empty())
+		{
+			ServerLogger::Log(logid, "Error while hashing file \"" + tf->getFilename() + "\" (destination: \""+ tfn+"\"). Failing backup.", LL_ERROR);
+			has_error = true;
+		}
+		else if(!client_sha_dig.empty() && h!=client_sha_dig)
+		{
+			if (has_snapshot)
+			{
+				ServerLogger::Log(logid, "Client calculated hash of \"" + tfn + "\" differs from server calculated hash. "
+					"This may be caused by a bug or by random bit flips on the client or server hard disk. "
+					+(ignore_hash_mismatch?"":"Failing backup. ")+
+					"(Hash: "+ print_hash_func(c_hash_func)+
+					", client hash: "+base64_encode(reinterpret_cast<const unsigned char*>(client_sha_dig.data()), static_cast<unsigned int>(client_sha_dig.size()))+
+					", server hash: "+ base64_encode(reinterpret_cast<const unsigned char*>(h.data()), static_cast<unsigned int>(h.size()))+")", LL_ERROR);
+
+				if (!ignore_hash_mismatch)
 				{
-					ServerLogger::Log(logid, "Error while hashing file \"" + tf->getFilename() + "\" (destination: \""+ tfn+"\"). Failing backup.", LL_ERROR);
 					has_error = true;
 				}
-				else if(!client_sha_dig.empty() && h!=client_sha_dig)
-				{
-					if (has_snapshot)
-					{
-						ServerLogger::Log(logid, "Client calculated hash of \"" + tfn + "\" differs from server calculated hash. "
-							"This may be caused by a bug or by random bit flips on the client or server hard disk. "
-							+(ignore_hash_mismatch?"":"Failing backup. ")+
-							"(Hash: "+ print_hash_func(c_hash_func)+
-							", client hash: "+base64_encode(reinterpret_cast<const unsigned char*>(client_sha_dig.data()), static_cast<unsigned int>(client_sha_dig.size()))+
-							", server hash: "+ base64_encode(reinterpret_cast<const unsigned char*>(h.data()), static_cast<unsigned int>(h.size()))+")", LL_ERROR);
-
-						if (!ignore_hash_mismatch)
-						{
-							has_error = true;
-						}
-					}
-					else
-					{
-						ServerLogger::Log(logid, "Client calculated hash of \"" + tfn + "\" differs from server calculated hash. "
-							"The file is being backed up without a snapshot so this is most likely caused by the file changing during the backup. "
-							"The backed up file may be corrupt and not a valid, consistent backup. "
-							"(Hash: "+print_hash_func(c_hash_func) + ")", LL_WARNING);
-					}
-				}
-
-				Server->destroy(tf);
-				if(old_file!=NULL)
-				{
-					Server->destroy(old_file);
-				}
-				
-				CWData data;
-				data.addInt(BackupServerHash::EAction_LinkOrCopy);
-				data.addVarInt(fileid);
-				data.addString(temp_fn);
-				data.addInt(backupid);
-				data.addInt(incremental);
-				data.addChar(with_hashes);
-				data.addString(tfn);
-				data.addString(hashpath);
-				data.addString(h);
-				data.addString(hashoutput_fn);
-				data.addString(old_file_fn);
-				data.addInt64(t_filesize);
-				data.addString(sparse_extents_fn);
-				metadata.serialize(data);
-
-				output->Write(data.getDataPtr(), data.getDataSize() );
 			}
+			else
+			{
+				ServerLogger::Log(logid, "Client calculated hash of \"" + tfn + "\" differs from server calculated hash. "
+					"The file is being backed up without a snapshot so this is most likely caused by the file changing during the backup. "
+					"The backed up file may be corrupt and not a valid, consistent backup. "
+					"(Hash: "+print_hash_func(c_hash_func) + ")", LL_WARNING);
+			}
+		}
+
+		Server->destroy(tf);
+		if(old_file!=NULL)
+		{
+			Server->destroy(old_file);
 		}
+		
+		CWData data;
+		data.addInt(BackupServerHash::EAction_LinkOrCopy);
+		data.addVarInt(fileid);
+		data.addString(temp_fn);
+		data.addInt(backupid);
+		data.addInt(incremental);
+		data.addChar(with_hashes);
+		data.addString(tfn);
+		data.addString(hashpath);
+		data.addString(h);
+		data.addString(hashoutput_fn);
+		data.addString(old_file_fn);
+		data.addInt64(t_filesize);
+		data.addString(sparse_extents_fn);
+		metadata.serialize(data);
+
+		output_data.assign(data.getDataPtr(), data.getDataSize());
+		return true;
 	}
+
+	return false;
 }
 
 std::string BackupServerPrepareHash::calc_hash(IFsFile * f, std::string method)
@@ -501,9 +473,128 @@ void BackupServerPrepareHash::next_chunk_patcher_bytes(const char *buf, size_t b
 	file_pos += bsize;
 }
 
-bool BackupServerPrepareHash::isWorking(void)
+ReceiveHash::ReceiveHash()
+	: hash_func(HASH_FUNC_SHA512_NO_SPARSE), with_sparse(false), valid(false),
+	fpos(0), block_fill(0), skip_start(-1)
 {
-	return working;
+}
+
+void ReceiveHash::reset(char p_hash_func)
+{
+	hash_func = p_hash_func;
+	with_sparse = hash_func != HASH_FUNC_SHA512_NO_SPARSE;
+
+	if (hash_func == HASH_FUNC_SHA512_NO_SPARSE
+		|| hash_func == HASH_FUNC_SHA512)
+	{
+		hashf.reset(new HashSha512);
+	}
+	else
+	{
+		hashf.reset(new TreeHash(NULL));
+	}
+
+	valid = true;
+	fpos = 0;
+	block_fill = 0;
+	skip_start = -1;
+	block.resize(hash_bsize);
+}
+
+void ReceiveHash::receive_data(int64 pos, const char* buf, size_t bsize)
+{
+	if (hashf.get() == NULL)
+	{
+		return;
+	}
+
+	if (pos == 0
+		&& fpos + static_cast<int64>(block_fill) != 0)
+	{
+		//File is downloaded again from the start
+		reset(hash_func);
+	}
+
+	if (!valid
+		|| pos != fpos + static_cast<int64>(block_fill))
+	{
+		valid = false;
+		return;
+	}
+
+	while (bsize > 0)
+	{
+		size_t tocopy = (std::min)(bsize, hash_bsize - block_fill);
+		memcpy(block.data() + block_fill, buf, tocopy);
+		block_fill += tocopy;
+		buf += tocopy;
+		bsize -= tocopy;
+
+		if (block_fill == hash_bsize)
+		{
+			hashBlock();
+		}
+	}
+}
+
+void ReceiveHash::hashBlock()
+{
+	if (with_sparse
+		&& block_fill == hash_bsize
+		&& buf_is_zero(block.data(), hash_bsize))
+	{
+		if (skip_start == -1)
+		{
+			skip_start = fpos;
+		}
+	}
+	else
+	{
+		if (skip_start != -1)
+		{
+			int64 skip[2];
+			skip[0] = skip_start;
+			skip[1] = fpos - skip_start;
+			hashf->sparse_hash(reinterpret_cast<char*>(&skip), sizeof(int64) * 2);
+			skip_start = -1;
+		}
+
+		hashf->hash(block.data(), static_cast<_u32>(block_fill));
+	}
+
+	fpos += block_fill;
+	block_fill = 0;
+}
+
+std::string ReceiveHash::finalize(int64 filesize)
+{
+	if (hashf.get() == NULL)
+	{
+		return std::string();
+	}
+
+	if (block_fill > 0)
+	{
+		hashBlock();
+	}
+
+	std::string ret;
+	if (valid && fpos == filesize)
+	{
+		if (skip_start != -1)
+		{
+			int64 skip[2];
+			skip[0] = skip_start;
+			skip[1] = fpos - skip_start;
+			hashf->sparse_hash(reinterpret_cast<char*>(&skip), sizeof(int64) * 2);
+		}
+
+		ret = hashf->finalize();
+	}
+
+	hashf.reset();
+	valid = false;
+	return ret;
 }
 
 bool BackupServerPrepareHash::hasError(void)
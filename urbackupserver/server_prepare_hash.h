@@ -10,6 +10,9 @@
 #include "server_log.h"
 #include "../urbackupcommon/ExtentIterator.h"
 #include "../urbackupcommon/TreeHash.h"
+#include "../urbackupcommon/fileclient/FileClient.h"
+#include <memory>
+#include <vector>
 
 const char HASH_FUNC_SHA512_NO_SPARSE = 0;
 const char HASH_FUNC_SHA512 = 1;
@@ -29,15 +32,14 @@ namespace
 	}
 }
 
-class BackupServerPrepareHash : public IThread, public IChunkPatcherCallback
+class BackupServerPrepareHash : public IChunkPatcherCallback
 {
 public:
-	BackupServerPrepareHash(IPipe *pPipe, IPipe *pOutput, int pClientid, logid_t logid, bool ignore_hash_mismatch);
-	~BackupServerPrepareHash(void);
+	BackupServerPrepareHash(int pClientid, logid_t logid, bool ignore_hash_mismatch);
+	virtual ~BackupServerPrepareHash(void);
 
-	void operator()(void);
-	
-	bool isWorking(void);
+	//Hashes the file described by a prepare hash pipe message. Returns false if there is no message for the hash pipe
+	bool prepareFile(const std::string& data, std::string& output_data);
 
 	void next_chunk_patcher_bytes(const char *buf, size_t bsize, bool changed, bool* is_sparse);
 
@@ -66,9 +68,6 @@ private:
 
 	void addUnchangedHashes(int64 start, size_t size, bool* is_sparse);
 
-	IPipe *pipe;
-	IPipe *output;
-
 	int clientid;
 
 	IHashFunc* hashf;
@@ -80,7 +79,6 @@ private:
 
 	ChunkPatcher chunk_patcher;
 	
-	volatile bool working;
 	volatile bool has_error;
 
 	logid_t logid;
@@ -89,4 +87,35 @@ private:
 
 };
 
+/**
+* Calculates the same hash as BackupServerPrepareHash::hash_sha (without
+* extent iterator) while a file is being downloaded, so the temporary
+* file does not have to be read again. finalize() returns an empty
+* string if the data was not received in one sequential pass, e.g.
+* after a resume from a checkpoint.
+*/
+class ReceiveHash : public FileClient::ReceiveCallback
+{
+public:
+	ReceiveHash();
+
+	void reset(char hash_func);
+
+	virtual void receive_data(int64 pos, const char* buf, size_t bsize);
+
+	std::string finalize(int64 filesize);
+
+private:
+	void hashBlock();
+
+	std::unique_ptr<IHashFunc> hashf;
+	char hash_func;
+	bool with_sparse;
+	bool valid;
+	int64 fpos;
+	std::vector<char> block;
+	size_t block_fill;
+	int64 skip_start;
+};
+
 #endif //SERVER_PREPARE_HASH_H
\ No newline at end of file
@@ -319,6 +319,10 @@ void ServerSettings::readSettingsDefault(ISettingsReader* settings_default,
 		settings->autoupdate_clients = (settings_global->getValue("autoupdate_clients", "true") == "true");
 		settings->max_active_clients = settings_global->getValue("max_active_clients", 10000);
 		settings->max_sim_backups = settings_global->getValue("max_sim_backups", 100);
+		settings->max_sim_full_image_backups = settings_global->getValue("max_sim_full_image_backups", -1);
+		settings->admission_max_hash_queue = settings_global->getValue("admission_max_hash_queue", -1);
+		settings->admission_max_storage_speed = settings_global->getValue("admission_max_storage_speed", -1);
+		settings->admission_max_network_speed = settings_global->getValue("admission_max_network_speed", -1);
 		settings->cleanup_window = settings_global->getValue("cleanup_window", "1-7/3-4");
 		settings->backup_database = (settings_global->getValue("backup_database", "true") == "true");
 		settings->internet_server_port = (unsigned short)(atoi(settings_global->getValue("internet_server_port", "55415").c_str()));
@@ -14,6 +14,9 @@ namespace
 	const char* image_file_format_cowraw = "cowraw";
 	const char* image_file_format_vhdx = "vhdx";
 	const char* image_file_format_vhdxz = "vhdxz";
+	const char* image_file_format_dedup = "dedup";
+
+	const char* image_block_store_dir = "urbackup_image_blocks";
 
 	const char* full_image_style_full = "full";
 	const char* full_image_style_synthetic = "synthetic";
@@ -60,6 +63,10 @@ struct SSettings
 	bool download_client;
 	bool autoupdate_clients;
 	int max_sim_backups;
+	int max_sim_full_image_backups;
+	int admission_max_hash_queue;
+	int admission_max_storage_speed;
+	int admission_max_network_speed;
 	int max_active_clients;
 	std::string backup_window_incr_file;
 	std::string backup_window_full_file;
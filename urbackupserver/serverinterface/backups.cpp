@@ -1010,6 +1010,10 @@ namespace backupaccess
 			{
 				vhdfile.reset(image_fak->createVHDFile(path, true, 0, 2*1024*1024, false, IFSImageFactory::ImageFormat_RawCowFile));
 			}
+			else if (extension == "dedup")
+			{
+				vhdfile.reset(image_fak->createVHDFile(path, true, 0, 2 * 1024 * 1024, false, IFSImageFactory::ImageFormat_Dedup));
+			}
 			else
 			{
 				assert(false);
@@ -337,6 +337,10 @@ void getGeneralSettings(JSON::Object& obj, IDatabase *db, ServerSettings &settin
 	SET_SETTING(download_client);
 	SET_SETTING(autoupdate_clients);
 	SET_SETTING(max_sim_backups);
+	SET_SETTING(max_sim_full_image_backups);
+	SET_SETTING(admission_max_hash_queue);
+	SET_SETTING(admission_max_storage_speed);
+	SET_SETTING(admission_max_network_speed);
 	SET_SETTING(max_active_clients);
 	SET_SETTING(cleanup_window);
 	SET_SETTING(backup_database);
@@ -26,6 +26,9 @@
 #include "../server.h"
 #include "../ClientMain.h"
 #include "../dao/ServerBackupDao.h"
+#include "../FileIndex.h"
+#include "../FileIndexFilter.h"
+#include "../BackupScheduler.h"
 
 #include <algorithm>
 #include <memory>
@@ -329,6 +332,45 @@ ACTION_IMPL(status)
 			{
 				ret.set("database_error", true);
 			}
+
+			FileIndexFilter::SStats filter_stats;
+			if (FileIndexFilter::get_global_stats(filter_stats))
+			{
+				JSON::Object filter_obj;
+				filter_obj.set("ready", filter_stats.ready);
+				filter_obj.set("size", filter_stats.size_bytes);
+				filter_obj.set("capacity", filter_stats.capacity);
+				filter_obj.set("entries", filter_stats.n_added);
+				filter_obj.set("est_false_positive_rate", filter_stats.est_false_positive_rate);
+				filter_obj.set("filtered", filter_stats.n_filtered);
+				filter_obj.set("false_positives", filter_stats.n_false_positives);
+				filter_obj.set("rebuilding", filter_stats.rebuilding);
+				filter_obj.set("rebuilds", filter_stats.n_rebuilds);
+				int64 n_negative = filter_stats.n_filtered + filter_stats.n_false_positives;
+				if (n_negative > 0)
+				{
+					filter_obj.set("false_positive_rate", static_cast<double>(filter_stats.n_false_positives) / n_negative);
+				}
+				ret.set("file_index_filter", filter_obj);
+			}
+
+			FileIndex::SCacheStats cache_stats = FileIndex::get_cache_stats();
+			JSON::Object cache_obj;
+			cache_obj.set("entries", cache_stats.entries);
+			cache_obj.set("hits", cache_stats.hits);
+			cache_obj.set("misses", cache_stats.misses);
+			cache_obj.set("flushes", cache_stats.flushes);
+			cache_obj.set("lock_contended", cache_stats.lock_contended);
+			cache_obj.set("lock_acquired", cache_stats.lock_acquired);
+			if (cache_stats.hits + cache_stats.misses > 0)
+			{
+				cache_obj.set("hit_rate", static_cast<double>(cache_stats.hits) / (cache_stats.hits + cache_stats.misses));
+			}
+			ret.set("file_index_cache", cache_obj);
+
+			JSON::Object scheduler_obj;
+			BackupScheduler::getStatus(scheduler_obj);
+			ret.set("backup_scheduler", scheduler_obj);
 		}
 
 		std::string hostname=POST["hostname"];
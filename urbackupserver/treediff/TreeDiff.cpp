@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <memory.h>
 #include <memory>
+#include <string.h>
 #include "../../Interface/Server.h"
 #include "../../Interface/File.h"
 
@@ -48,6 +49,41 @@ std::vector<size_t> TreeDiff::diffTrees(const std::string& t1, const std::string
 		is_windows);
 }
 
+struct TreeDiff::SDiffState
+{
+	SDiffState(TreeNodes& t1, TreeNamePool& names, TreeEntryReader& t2)
+		: t1(t1), names(names), t2(t2)
+	{}
+
+	TreeNodes& t1;
+	TreeNamePool& names;
+	TreeEntryReader& t2;
+
+	std::vector<size_t>* diffs;
+	std::vector<size_t>* large_unchanged_subtrees;
+	std::vector<size_t>* modified_inplace_ids;
+	std::vector<size_t>* dir_diffs;
+	std::vector<size_t>* deleted_inplace_ids;
+	bool has_symbit;
+	bool is_windows;
+};
+
+struct TreeDiff::SDirFrame
+{
+	SDirFrame()
+		: subtree_changed(false), treesize(0)
+	{}
+
+	bool subtree_changed;
+	//Number of nodes below the directory in the new tree
+	size_t treesize;
+};
+
+/**
+* Only the old tree (t1) is read into memory. The new tree (t2) is
+* merged against it while it is being read, so node state of the new
+* tree is only kept for the directories on the current path.
+*/
 std::vector<size_t> TreeDiff::diffTrees(IFile* t1, IFile* t2, bool& error,
 	std::vector<size_t>* deleted_ids, std::vector<size_t>* large_unchanged_subtrees,
 	std::vector<size_t>* modified_inplace_ids, std::vector<size_t>& dir_diffs,
@@ -62,23 +98,31 @@ std::vector<size_t> TreeDiff::diffTrees(IFile* t1, IFile* t2, bool& error,
 		return ret;
 	}
 
-	TreeReader r2;
-	if(!r2.readTree(t2))
+	TreeEntryReader r2(t2);
+
+	SDiffState state(r1.getNodes(), r1.getNames(), r2);
+	state.diffs = &ret;
+	state.large_unchanged_subtrees = large_unchanged_subtrees;
+	state.modified_inplace_ids = modified_inplace_ids;
+	state.dir_diffs = &dir_diffs;
+	state.deleted_inplace_ids = deleted_inplace_ids;
+	state.has_symbit = has_symbit;
+	state.is_windows = is_windows;
+
+	SDirFrame root_frame;
+	if(!gatherDiffs(state, 0, 0, root_frame))
 	{
 		error=true;
 		return ret;
 	}
 
-	gatherDiffs(&(*r1.getNodes())[0], &(*r2.getNodes())[0], 0, ret, modified_inplace_ids, 
-		dir_diffs, deleted_inplace_ids, has_symbit, is_windows);
 	if(deleted_ids!=NULL)
 	{
-		gatherDeletes(&(*r1.getNodes())[0], *deleted_ids);
+		gatherDeletes(r1.getNodes(), *deleted_ids);
 		std::sort(deleted_ids->begin(), deleted_ids->end());
 	}
 	if(large_unchanged_subtrees!=NULL)
 	{
-		gatherLargeUnchangedSubtrees(&(*r2.getNodes())[0], *large_unchanged_subtrees);
 		std::sort(large_unchanged_subtrees->begin(), large_unchanged_subtrees->end());
 	}
 
@@ -98,209 +142,230 @@ std::vector<size_t> TreeDiff::diffTrees(IFile* t1, IFile* t2, bool& error,
 	return ret;
 }
 
-void TreeDiff::gatherDiffs(TreeNode *t1, TreeNode *t2, size_t depth, std::vector<size_t> &diffs,
-	std::vector<size_t> *modified_inplace_ids, std::vector<size_t> &dir_diffs,
-	std::vector<size_t> *deleted_inplace_ids, bool has_symbit, bool is_windows)
+bool TreeDiff::gatherDiffs(SDiffState& state, unsigned int t1, size_t depth, SDirFrame& frame)
 {
-	size_t nc_2=t2->getNumChildren();
-	size_t nc_1=t1->getNumChildren();
-	TreeNode *c2=t2->getFirstChild();
-	TreeNode *c1=t1->getFirstChild();
-	bool did_subtree_change=false;
-	while(c2!=NULL)
-	{		
-		int cmp = 1;
-		if(c1!=NULL)
+	TreeNodes& nodes1 = state.t1;
+	unsigned int c1=nodes1.getFirstChild(t1);
+	STreeEntry c2;
+	while(state.t2.next(c2))
+	{
+		if(c2.type=='u')
 		{
-			if (c1->getType() == 'f'
-				&& c2->getType() == 'd')
-			{
-				cmp = -1;
-			}
-			else if (c1->getType() == 'd'
-				&& c2->getType() == 'f')
+			if(depth==0)
 			{
-				cmp = 1;
-			}
-			else
-			{
-				cmp = c1->nameCompare(*c2);
+				continue;
 			}
+			return true;
 		}
 
-		//root may be unsorted
-		if (cmp != 0
-			&& depth == 0)
+		size_t large_unchanged_mark = state.large_unchanged_subtrees!=NULL ?
+			state.large_unchanged_subtrees->size() : 0;
+
+		SDirFrame c2_frame;
+		bool c2_recursed=false;
+		bool c2_mapped=false;
+		bool c2_done=false;
+		while(!c2_done)
 		{
-			TreeNode* sn = t1->getFirstChild();
-			while (sn != NULL)
+			int cmp = 1;
+			if(c1!=c_treenode_none)
 			{
-				if (c2->getType() == sn->getType()
-					&& c2->nameEquals(*sn)
-					&& sn->getMappedNode()==NULL)
+				if (nodes1.getType(c1) == 'f'
+					&& c2.type == 'd')
 				{
-					cmp = 0;
-					c1 = sn;
-					break;
+					cmp = -1;
+				}
+				else if (nodes1.getType(c1) == 'd'
+					&& c2.type == 'f')
+				{
+					cmp = 1;
+				}
+				else
+				{
+					cmp = strcmp(state.names.get(nodes1.getName(c1)), c2.name.c_str());
 				}
-				sn = sn->getNextSibling();
 			}
-		}
-
-		if(cmp==0)
-		{
-			bool equal_dir = (c1->getType()=='d' && c2->getType()=='d');
-			bool data_equals = c1->dataEquals(*c2);
 
-			if(equal_dir && !data_equals)
+			//root may be unsorted
+			if (cmp != 0
+				&& depth == 0)
 			{
-				dir_diffs.push_back(c2->getId());
-				subtreeChanged(c2);
+				unsigned int sn = nodes1.getFirstChild(t1);
+				while (sn != c_treenode_none)
+				{
+					if (c2.type == nodes1.getType(sn)
+						&& !nodes1.isMapped(sn)
+						&& c2.name == state.names.get(nodes1.getName(sn)))
+					{
+						cmp = 0;
+						c1 = sn;
+						break;
+					}
+					sn = nodes1.getNextSibling(sn);
+				}
 			}
 
-			if( equal_dir
-				|| data_equals )
-			{
-				gatherDiffs(c1, c2, depth+1, diffs, modified_inplace_ids, 
-					dir_diffs, deleted_inplace_ids, has_symbit, is_windows);
-				c2->setMappedNode(c1);
-				c1->setMappedNode(c2);
-			}
-			else
+			if(cmp==0)
 			{
-				if( modified_inplace_ids!=NULL
-					&& c1->getType() == c2->getType() )
+				bool equal_dir = (nodes1.getType(c1)=='d' && c2.type=='d');
+				bool data_equals = nodes1.getType(c1)==c2.type
+					&& memcmp(nodes1.getData(c1), c2.data, nodes1.getDataSize(c1))==0;
+
+				if(equal_dir && !data_equals)
 				{
-					modified_inplace_ids->push_back(c2->getId());
+					state.dir_diffs->push_back(c2.id);
+					frame.subtree_changed=true;
 				}
 
-				if (deleted_inplace_ids != NULL
-					&& c1->getType() == c2->getType()
-					&& isSymlink(c1, has_symbit, is_windows) == isSymlink(c2, has_symbit, is_windows) )
+				if( equal_dir
+					|| data_equals )
 				{
-					deleted_inplace_ids->push_back(c1->getId());
+					if(c2.type=='d')
+					{
+						if(!gatherDiffs(state, c1, depth+1, c2_frame))
+						{
+							return false;
+						}
+						c2_recursed=true;
+					}
+					nodes1.setMapped(c1);
+					c2_mapped=true;
+				}
+				else
+				{
+					if( state.modified_inplace_ids!=NULL
+						&& nodes1.getType(c1) == c2.type )
+					{
+						state.modified_inplace_ids->push_back(c2.id);
+					}
+
+					if (state.deleted_inplace_ids != NULL
+						&& nodes1.getType(c1) == c2.type
+						&& isSymlink(nodes1.getType(c1), nodes1.getData(c1), state.has_symbit, state.is_windows)
+							== isSymlink(c2.type, c2.data, state.has_symbit, state.is_windows) )
+					{
+						state.deleted_inplace_ids->push_back(nodes1.getId(c1));
+					}
+
+					state.diffs->push_back(c2.id);
+					frame.subtree_changed=true;
 				}
-				
-				diffs.push_back(c2->getId());
-				subtreeChanged(c2);				
-			}
 
 #ifndef _WIN32
-			/**
-			* Stop it from moving directories above symlinks to the directory link
-			* pool on Linux/FreeBSD, as then symbolic links within that directory
-			* would not be able to point to the current backup (symbolic links
-			* are relative to the symbolic link location)
-			* On Windows this works. Could be because it uses junctions for the
-			* symlinks to the directory pool.
-			**/
-			if (isSymlink(c2, has_symbit, is_windows))
-			{
-				subtreeChanged(c2);
-			}
+				/**
+				* Stop it from moving directories above symlinks to the directory link
+				* pool on Linux/FreeBSD, as then symbolic links within that directory
+				* would not be able to point to the current backup (symbolic links
+				* are relative to the symbolic link location)
+				* On Windows this works. Could be because it uses junctions for the
+				* symlinks to the directory pool.
+				**/
+				if (isSymlink(c2.type, c2.data, state.has_symbit, state.is_windows))
+				{
+					frame.subtree_changed=true;
+				}
 #endif
 
-			c1=c1->getNextSibling();
-			c2=c2->getNextSibling();
+				c1=nodes1.getNextSibling(c1);
+				c2_done=true;
+			}
+			else if(cmp<0)
+			{
+				c1=nodes1.getNextSibling(c1);
+				frame.subtree_changed=true;
+			}
+			else
+			{
+				state.diffs->push_back(c2.id);
+				frame.subtree_changed=true;
+				c2_done=true;
+			}
 		}
-		else if(cmp<0)
+
+		size_t c2_treesize=1;
+		if(c2_recursed)
 		{
-			c1=c1->getNextSibling();
-			subtreeChangedParent(t2);
+			c2_treesize+=c2_frame.treesize;
 		}
-		else
+		else if(c2.type=='d')
 		{
-			diffs.push_back(c2->getId());
-			subtreeChanged(c2);
+			size_t skipped=0;
+			if(!skipSubtree(state, skipped))
+			{
+				return false;
+			}
+			c2_treesize+=skipped;
+		}
+
+		frame.treesize+=c2_treesize;
 
-			c2=c2->getNextSibling();
+		if(c2_frame.subtree_changed)
+		{
+			frame.subtree_changed=true;
 		}
-	}
-}
 
-void TreeDiff::gatherDeletes(TreeNode *t1, std::vector<size_t> &deleted_ids)
-{
-	TreeNode *c1=t1->getFirstChild();
-	while(c1!=NULL)
-	{
-		if(c1->getMappedNode()==NULL)
+		if(state.large_unchanged_subtrees!=NULL
+			&& c2_mapped
+			&& !c2_frame.subtree_changed
+			&& c2_treesize>10)
 		{
-			deleted_ids.push_back(c1->getId());
+			//Replaces the large unchanged subtrees found below c2
+			state.large_unchanged_subtrees->resize(large_unchanged_mark);
+			state.large_unchanged_subtrees->push_back(c2.id);
 		}
-		gatherDeletes(c1, deleted_ids);
-		c1=c1->getNextSibling();
 	}
-}
-
-void TreeDiff::subtreeChanged(TreeNode* t2)
-{
-	TreeNode* p = t2->getParent();
-	if(p==NULL) return;
 
-	subtreeChangedParent(p);
+	return !state.t2.hasError();
 }
 
-void TreeDiff::subtreeChangedParent(TreeNode * p)
+bool TreeDiff::skipSubtree(SDiffState& state, size_t& treesize)
 {
-	do
+	size_t depth=1;
+	STreeEntry entry;
+	while(depth>0)
 	{
-		if (p->getSubtreeChanged())
+		if(!state.t2.next(entry))
 		{
-			return;
+			return !state.t2.hasError();
 		}
 
-		p->setSubtreeChanged(true);
-		p = p->getParent();
-	} while (p != NULL);
-}
-
-void TreeDiff::gatherLargeUnchangedSubtrees( TreeNode *t2, std::vector<size_t> &large_unchanged_subtrees )
-{
-	TreeNode *c2=t2->getFirstChild();
-	while(c2!=NULL)
-	{
-		if(!c2->getSubtreeChanged()
-			&& c2->getMappedNode()!=NULL
-			&& getTreesize(c2,10)>10)
+		if(entry.type=='u')
 		{
-			large_unchanged_subtrees.push_back(c2->getId());
+			--depth;
 		}
 		else
 		{
-			gatherLargeUnchangedSubtrees(c2, large_unchanged_subtrees);
+			++treesize;
+			if(entry.type=='d')
+			{
+				++depth;
+			}
 		}
-		c2=c2->getNextSibling();
 	}
+	return true;
 }
 
-size_t TreeDiff::getTreesize( TreeNode* t, size_t limit )
+void TreeDiff::gatherDeletes(TreeNodes& t1, std::vector<size_t> &deleted_ids)
 {
-	size_t treesize=1;
-	TreeNode *c=t->getFirstChild();
-	while(c!=NULL)
+	for(unsigned int n=1;n<t1.size();++n)
 	{
-		treesize+=getTreesize(c, limit);
-		if(treesize>limit)
+		if(!t1.isMapped(n))
 		{
-			return treesize;
+			deleted_ids.push_back(t1.getId(n));
 		}
-		c=c->getNextSibling();
 	}
-	return treesize;
 }
 
-bool TreeDiff::isSymlink(TreeNode * n, bool has_symbit, bool is_windows)
+bool TreeDiff::isSymlink(char type, const int64* data, bool has_symbit, bool is_windows)
 {
 	uint64 change_indicator = 0;
-	if (n->getType() == 'd'
-		&& n->getDataSize() == sizeof(uint64))
+	if (type == 'd')
 	{
-		memcpy(&change_indicator, n->getDataPtr(), sizeof(uint64));
+		memcpy(&change_indicator, data, sizeof(uint64));
 	}
-	else if (n->getType() == 'f'
-		&& n->getDataSize() == 2 * sizeof(uint64))
+	else if (type == 'f')
 	{
-		memcpy(&change_indicator, n->getDataPtr()+sizeof(uint64), sizeof(uint64));
+		memcpy(&change_indicator, data+1, sizeof(uint64));
 	}
 
 	if (has_symbit)
@@ -321,7 +386,7 @@ bool TreeDiff::isSymlink(TreeNode * n, bool has_symbit, bool is_windows)
 
 		if (is_windows)
 		{
-			if ((!(change_indicator & neg_bit) || n->getType() == 'd')
+			if ((!(change_indicator & neg_bit) || type == 'd')
 				&& (change_indicator & symlink_mask) > 0)
 			{
 				return true;
@@ -1,7 +1,10 @@
 #include <string>
 #include <vector>
+#include "../../Interface/Types.h"
 
-class TreeNode;
+class TreeNodes;
+class TreeNamePool;
+class TreeEntryReader;
 class IFile;
 
 class TreeDiff
@@ -18,13 +21,11 @@ public:
 		std::vector<size_t>* deleted_inplace_ids, bool has_symbit, bool is_windows);
 
 private:
-	static void gatherDiffs(TreeNode *t1, TreeNode *t2, size_t depth, std::vector<size_t> &diffs,
-		std::vector<size_t> *modified_inplace_ids, std::vector<size_t> &dir_diffs,
-		std::vector<size_t> *deleted_inplace_ids, bool has_symbit, bool is_window);
-	static void gatherDeletes(TreeNode *t1, std::vector<size_t> &deleted_ids);
-	static void gatherLargeUnchangedSubtrees(TreeNode *t2, std::vector<size_t> &changed_subtrees);
-	static void subtreeChanged(TreeNode* t2);
-	static void subtreeChangedParent(TreeNode* p);
-	static size_t getTreesize(TreeNode* t, size_t limit);
-	static bool isSymlink(TreeNode* n, bool has_symbit, bool is_window);
+	struct SDiffState;
+	struct SDirFrame;
+
+	static bool gatherDiffs(SDiffState& state, unsigned int t1, size_t depth, SDirFrame& frame);
+	static bool skipSubtree(SDiffState& state, size_t& treesize);
+	static void gatherDeletes(TreeNodes& t1, std::vector<size_t> &deleted_ids);
+	static bool isSymlink(char type, const int64* data, bool has_symbit, bool is_window);
 };
\ No newline at end of file
@@ -20,225 +20,168 @@
 
 #include <memory.h>
 #include <string.h>
+#include <algorithm>
 
-TreeNode::TreeNode(const char* name, const char* data, TreeNode *parent, char node_type)
-	: name(name), data(data), parent(parent), num_children(0), nextSibling(NULL), mapped_node(NULL),
-	  subtree_changed(false), node_type(node_type), id(0)
+namespace
 {
-}
+	const size_t c_name_block_size=1024*1024;
+	const size_t c_min_table_size=1024;
 
-TreeNode::TreeNode(void)
-	: num_children(0), nextSibling(NULL), mapped_node(NULL), subtree_changed(false), parent(NULL),
-	name(NULL), data(NULL), node_type(0), id(0)
-{
-}
-
-std::string TreeNode::getName()
-{
-	if(name)
+	unsigned int name_hash(const char* name, size_t name_size)
 	{
-		return name;
-	}
-	else
-	{
-		return std::string();
+		//FNV-1a
+		unsigned int h=2166136261U;
+		for(size_t i=0;i<name_size;++i)
+		{
+			h^=static_cast<unsigned char>(name[i]);
+			h*=16777619U;
+		}
+		return h;
 	}
 }
 
-std::string TreeNode::getData()
+TreeNamePool::TreeNamePool(void)
+	: table(c_min_table_size), block_pos(0), block_size(0), blocks_size(0)
 {
-	if(data!=NULL)
+	for(size_t i=0;i<table.size();++i)
 	{
-		return std::string(data, data+getDataSize());
+		table[i].id=c_treenode_none;
 	}
-	else
-	{
-		return std::string();
-	}
-}
-
-const char * TreeNode::getDataPtr()
-{
-	return data;
-}
-
-void TreeNode::setName(const char* pName)
-{
-	name=pName;
-}
-
-void TreeNode::setData(const char* pData)
-{
-	data=pData;
 }
 
-size_t TreeNode::getNumChildren()
+unsigned int TreeNamePool::add(const char* name, size_t name_size)
 {
-	return num_children;
-}
+	unsigned int hash=name_hash(name, name_size);
+	size_t mask=table.size()-1;
+	size_t pos=hash & mask;
 
-TreeNode* TreeNode::getFirstChild(void)
-{
-	if(num_children>0)
+	while(table[pos].id!=c_treenode_none)
 	{
-		return this+1;
+		const SSlot& slot=table[pos];
+		if(slot.hash==hash
+			&& strncmp(names[slot.id], name, name_size)==0
+			&& names[slot.id][name_size]==0)
+		{
+			return slot.id;
+		}
+		pos=(pos+1) & mask;
 	}
-	else
+
+	if(names.size()>=c_treenode_none-1)
 	{
-		return NULL;
+		return c_treenode_none;
 	}
-}
 
-void TreeNode::setNextSibling(TreeNode *pNextSibling)
-{
-	nextSibling=pNextSibling;
-}
+	if(block_pos+name_size+1>block_size)
+	{
+		block_size=(std::max)(c_name_block_size, name_size+1);
+		blocks.push_back(std::unique_ptr<char[]>(new char[block_size]));
+		blocks_size+=block_size;
+		block_pos=0;
+	}
 
-void TreeNode::incrementNumChildren(void)
-{
-	++num_children;
-}
+	char* name_copy=blocks.back().get()+block_pos;
+	memcpy(name_copy, name, name_size);
+	name_copy[name_size]=0;
+	block_pos+=name_size+1;
 
-void TreeNode::setId(size_t pId)
-{
-	id=pId;
-}
+	unsigned int id=static_cast<unsigned int>(names.size());
+	names.push_back(name_copy);
 
-size_t TreeNode::getId(void) const
-{
-	return id;
-}
+	table[pos].id=id;
+	table[pos].hash=hash;
 
-TreeNode *TreeNode::getNextSibling(void)
-{
-	return nextSibling;
-}
-
-TreeNode* TreeNode::getChild(size_t n)
-{
-	TreeNode *firstChild=getFirstChild();
-	size_t i=0;
-	while(firstChild!=NULL && i!=n)
-	{
-		firstChild=firstChild->getNextSibling();
-		++i;
-	}
-	if(i==n)
+	if(names.size()*2>table.size())
 	{
-		return firstChild;
+		rehash(table.size()*2);
 	}
-	else
-	{
-		return NULL;
-	}
-}
 
-void TreeNode::setParent(TreeNode *pParent)
-{
-	parent=pParent;
-}
-
-TreeNode *TreeNode::getParent(void)
-{
-	return parent;
-}
-
-TreeNode *TreeNode::getMappedNode()
-{
-	return mapped_node;
+	return id;
 }
 
-void TreeNode::setMappedNode(TreeNode *pMappedNode)
+const char* TreeNamePool::get(unsigned int id) const
 {
-	mapped_node=pMappedNode;
+	return names[id];
 }
 
-void TreeNode::setSubtreeChanged( bool b )
+size_t TreeNamePool::size(void) const
 {
-	subtree_changed=b;
+	return names.size();
 }
 
-bool TreeNode::getSubtreeChanged()
+size_t TreeNamePool::getMemoryUsage(void) const
 {
-	return subtree_changed;
+	return table.capacity()*sizeof(SSlot)
+		+ names.capacity()*sizeof(const char*)
+		+ blocks_size;
 }
 
-int TreeNode::nameCompare(const TreeNode& other)
+void TreeNamePool::rehash(size_t new_table_size)
 {
-	if(name!=NULL && other.name!=NULL)
+	std::vector<SSlot> new_table(new_table_size);
+	for(size_t i=0;i<new_table.size();++i)
 	{
-		return strcmp(name, other.name);
+		new_table[i].id=c_treenode_none;
 	}
-	else
+
+	size_t mask=new_table_size-1;
+	for(size_t i=0;i<table.size();++i)
 	{
-		if(name==other.name)
-		{
-			return 0;
-		}
-		else if(name==NULL)
+		if(table[i].id==c_treenode_none)
 		{
-			return -1;
+			continue;
 		}
-		else
+
+		size_t pos=table[i].hash & mask;
+		while(new_table[pos].id!=c_treenode_none)
 		{
-			return 1;
+			pos=(pos+1) & mask;
 		}
+		new_table[pos]=table[i];
 	}
-}
 
-bool TreeNode::nameEquals( const TreeNode& other )
-{
-	if(name!=NULL && other.name!=NULL)
-	{
-		return strcmp(name, other.name)==0;
-	}
-	else
-	{
-		return name==other.name;
-	}
+	table.swap(new_table);
 }
 
-bool TreeNode::dataEquals( const TreeNode& other )
+TreeNodes::TreeNodes(void)
 {
-	if(node_type!=other.node_type)
-	{
-		return false;
-	}
-
-	if(data!=NULL && other.data!=NULL)
-	{
-		return memcmp(data, other.data, getDataSize())==0;
-	}
-	else
-	{
-		return data==other.data;
-	}
 }
 
-bool TreeNode::equals( const TreeNode& other )
+void TreeNodes::reserve(size_t n)
 {
-	return nameEquals(other) &&
-		dataEquals(other);
+	names.reserve(n);
+	next_siblings.reserve(n);
+	ids.reserve(n);
+	data.reserve(n*2);
+	types.reserve(n);
+	flags.reserve(n);
 }
 
-size_t TreeNode::getDataSize()
+unsigned int TreeNodes::add(unsigned int name, char type, int64 data0, int64 data1, size_t id)
 {
-	if(node_type=='d')
+	if(types.size()>=c_treenode_none
+		|| id>=c_treenode_none)
 	{
-		return c_treenode_data_size_dir;
+		return c_treenode_none;
 	}
-	else
-	{
-		return c_treenode_data_size_file;
-	}
-}
 
-char TreeNode::getType()
-{
-	return node_type;
+	unsigned int n=static_cast<unsigned int>(types.size());
+	names.push_back(name);
+	next_siblings.push_back(c_treenode_none);
+	ids.push_back(static_cast<unsigned int>(id));
+	data.push_back(data0);
+	data.push_back(data1);
+	types.push_back(type);
+	flags.push_back(0);
+	return n;
 }
 
-void TreeNode::setType( char t )
+size_t TreeNodes::getMemoryUsage(void) const
 {
-	node_type = t;
+	return names.capacity()*sizeof(unsigned int)
+		+ next_siblings.capacity()*sizeof(unsigned int)
+		+ ids.capacity()*sizeof(unsigned int)
+		+ data.capacity()*sizeof(int64)
+		+ types.capacity()
+		+ flags.capacity();
 }
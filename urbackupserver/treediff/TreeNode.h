@@ -3,67 +3,101 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 #include "../../Interface/Types.h"
 
 const size_t c_treenode_data_size_file=2*sizeof(int64);
 const size_t c_treenode_data_size_dir=sizeof(int64);
 
-class TreeNode
+const unsigned int c_treenode_none=0xFFFFFFFF;
+
+/**
+* Stores each distinct file name only once. Names are referenced by
+* 32-bit ids. Name storage is allocated in blocks, so adding names
+* never moves the ones already stored.
+*/
+class TreeNamePool
 {
 public:
-	TreeNode(const char* name, const char* data, TreeNode *parent, char node_type);
-	TreeNode(void);
+	TreeNamePool(void);
 
-	void setName(const char* pName);
-	void setData(const char* pData);
+	unsigned int add(const char* name, size_t name_size);
 
-	std::string getName();
-	std::string getData();
-	const char* getDataPtr();
+	const char* get(unsigned int id) const;
 
-	bool equals(const TreeNode& other);
-	bool nameEquals(const TreeNode& other);
-	int nameCompare(const TreeNode& other);
-	bool dataEquals(const TreeNode& other);
+	size_t size(void) const;
 
-	size_t getNumChildren();
-	TreeNode* getFirstChild(void);
-	void setNextSibling(TreeNode *pNextSibling);
-	TreeNode *getNextSibling(void);
-	void incrementNumChildren(void);
-	TreeNode* getChild(size_t n);
-	void setParent(TreeNode *pParent);
-	TreeNode *getParent(void);
+	size_t getMemoryUsage(void) const;
 
-	void setType(char t);
-	char getType();
+private:
+	TreeNamePool(const TreeNamePool&);
+	void operator=(const TreeNamePool&);
 
-	void setId(size_t pId);
-	size_t getId(void) const;
+	void rehash(size_t new_table_size);
 
-	TreeNode *getMappedNode();
-	void setMappedNode(TreeNode *pMappedNode);
+	struct SSlot
+	{
+		unsigned int id;
+		unsigned int hash;
+	};
 
-	void setSubtreeChanged(bool b);
-	bool getSubtreeChanged();
+	std::vector<SSlot> table;
+	std::vector<const char*> names;
 
-	size_t getDataSize();
+	std::vector<std::unique_ptr<char[]> > blocks;
+	size_t block_pos;
+	size_t block_size;
+	size_t blocks_size;
+};
 
-private:
-	char node_type;
+/**
+* Tree of a file list, stored as struct of arrays with 32-bit indices.
+* Nodes are in the order of the file list, so the first child of a
+* directory directly follows it. Node 0 is the root.
+*/
+class TreeNodes
+{
+public:
+	TreeNodes(void);
 
-	const char* name;
-	const char* data;
+	void reserve(size_t n);
 
-	TreeNode *nextSibling;
-	TreeNode *parent;
-	TreeNode *mapped_node;
-	size_t num_children;
-	bool subtree_changed;
+	//c_treenode_none if there are too many nodes
+	unsigned int add(unsigned int name, char type, int64 data0, int64 data1, size_t id);
 
-	size_t id;
+	size_t size(void) const { return types.size(); }
+
+	unsigned int getName(unsigned int n) const { return names[n]; }
+	char getType(unsigned int n) const { return types[n]; }
+	const int64* getData(unsigned int n) const { return &data[n*2]; }
+	size_t getDataSize(unsigned int n) const { return types[n]=='d' ? c_treenode_data_size_dir : c_treenode_data_size_file; }
+	size_t getId(unsigned int n) const { return ids[n]; }
+
+	unsigned int getFirstChild(unsigned int n) const { return (flags[n] & Flag_HasChildren) ? n+1 : c_treenode_none; }
+	unsigned int getNextSibling(unsigned int n) const { return next_siblings[n]; }
+	void setNextSibling(unsigned int n, unsigned int next) { next_siblings[n]=next; }
+	void setHasChildren(unsigned int n) { flags[n]|=Flag_HasChildren; }
+
+	bool isMapped(unsigned int n) const { return (flags[n] & Flag_Mapped)!=0; }
+	void setMapped(unsigned int n) { flags[n]|=Flag_Mapped; }
+
+	size_t getMemoryUsage(void) const;
+
+private:
+	enum
+	{
+		Flag_HasChildren=1,
+		Flag_Mapped=2
+	};
+
+	std::vector<unsigned int> names;
+	std::vector<unsigned int> next_siblings;
+	std::vector<unsigned int> ids;
+	std::vector<int64> data;
+	std::vector<char> types;
+	std::vector<char> flags;
 };
 
 
-#endif //TREENODE_H
\ No newline at end of file
+#endif //TREENODE_H
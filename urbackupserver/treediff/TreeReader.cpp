@@ -17,57 +17,110 @@
 **************************************************************************/
 
 #include "TreeReader.h"
-#include <fstream>
-#include <iostream>
 #include <memory.h>
 #include <stack>
+#include <stdlib.h>
 #include "../../stringtools.h"
-#include "../../urbackupcommon/os_functions.h"
 #include "../../Interface/Server.h"
 #include "../../Interface/File.h"
-#include <assert.h>
 
-bool TreeReader::readTree(IFile* f)
+namespace
 {
-	f->Seek(0);
-	std::vector<char> buffer(512 * 1024);
-	size_t read;
-	int state=0;
-	size_t lines=0;
-	size_t stringbuffer_size=0;
-	std::string name;
-	char ltype=0;
-	do
+	int64 parse_int64(const char* str, size_t len)
 	{
-		bool has_read_error = false;
-		read = f->Read(buffer.data(), buffer.size(), &has_read_error);
+		char buf[32];
+		len=(std::min)(len, sizeof(buf)-1);
+		memcpy(buf, str, len);
+		buf[len]=0;
+		return strtoll(buf, NULL, 10);
+	}
 
-		if (has_read_error)
+	//data is the rest of the line after 'name" '
+	void parse_data(char type, const std::string& data, int64* out)
+	{
+		out[0]=0;
+		out[1]=0;
+
+		size_t sep=data.find(' ');
+		if(sep==std::string::npos)
 		{
-			Log("Error reading from tree file -1");
-			return false;
+			return;
+		}
+
+		if(type=='f')
+		{
+			out[0]=parse_int64(data.c_str(), sep);
+			out[1]=strtoll(data.c_str()+sep+1, NULL, 10);
 		}
-		
-		for(size_t i=0;i<read;++i)
+		else
 		{
-			const char ch=buffer[i];
-			switch(state)
+			out[0]=strtoll(data.c_str()+sep+1, NULL, 10);
+		}
+	}
+}
+
+TreeEntryReader::TreeEntryReader(IFile* f)
+	: f(f), buffer(512 * 1024), buffer_pos(0), buffer_size(0),
+	eof(false), has_error(false), lines(0)
+{
+	f->Seek(0);
+}
+
+bool TreeEntryReader::next(STreeEntry& entry)
+{
+	int state=0;
+	entry.name.clear();
+	data.clear();
+
+	while(true)
+	{
+		if(buffer_pos>=buffer_size)
+		{
+			if(eof)
+			{
+				return false;
+			}
+
+			bool has_read_error = false;
+			buffer_size = f->Read(buffer.data(), static_cast<_u32>(buffer.size()), &has_read_error);
+			buffer_pos = 0;
+
+			if (has_read_error)
 			{
+				Log("Error reading from tree file");
+				has_error=true;
+				return false;
+			}
+
+			if(buffer_size<buffer.size())
+			{
+				eof=true;
+			}
+
+			if(buffer_size==0)
+			{
+				return false;
+			}
+		}
+
+		const char ch=buffer[buffer_pos++];
+		switch(state)
+		{
 			case 0:
 				if(ch=='f' || ch=='d')
 				{
-					ltype = ch;
-					state = 1;
+					entry.type=ch;
+					state=1;
 				}
 				else if(ch=='u')
 				{
-					state = 10;
-					ltype = 'd';
-					name = "..";
+					entry.type='u';
+					state=10;
 				}
 				else
 				{
-					Log("Error parsing file readTree - 0. Expected 'f', 'd', or 'u'. Got '"+std::string(1, ch)+"' at line "+convert(lines)+" while reading "+ f->getFilename());
+					Log("Error parsing file readTree. Expected 'f', 'd', or 'u'. Got '" + std::string(1, ch) + "' at line " + convert(lines)+" while reading "+f->getFilename());
+					has_error=true;
 					return false;
 				}
 				break;
@@ -86,15 +139,15 @@ bool TreeReader::readTree(IFile* f)
 				}
 				else
 				{
-					name+=ch;
+					entry.name+=ch;
 				}
 				break;
 			case 5:
 				if(ch!='\"' && ch!='\\')
 				{
-					name+='\\';
+					entry.name+='\\';
 				}
-				name+=ch;
+				entry.name+=ch;
 				state=2;
 				break;
 			case 3:
@@ -112,258 +165,135 @@ bool TreeReader::readTree(IFile* f)
 				{
 					if(ch!='\n')
 					{
+						data+=ch;
 						break;
 					}
 				}
 			case 10:
 				if(ch=='\n')
 				{
-					state=0;
-					if(ltype=='f')
+					entry.id=lines;
+					++lines;
+
+					if(entry.name=="..")
 					{
-						stringbuffer_size+=2*sizeof(int64);
+						entry.type='u';
 					}
-					if(ltype!='d' || name!="..")
-					{
-						if(ltype=='d')
-						{
-							stringbuffer_size+=sizeof(int64);
-						}
 
-						++lines;
-						stringbuffer_size+=name.size()+1;
+					if(entry.type=='u')
+					{
+						entry.data[0]=0;
+						entry.data[1]=0;
+					}
+					else
+					{
+						parse_data(entry.type, data, entry.data);
 					}
-					name.clear();
-					ltype=0;
+					return true;
 				}
-			}		
 		}
 	}
-	while(read>0);
+}
 
-	name.clear();
+bool TreeEntryReader::hasError(void)
+{
+	return has_error;
+}
 
-	f->Seek(0);
+void TreeEntryReader::Log(const std::string &str)
+{
+	Server->Log(str, LL_ERROR);
+}
 
+bool TreeReader::readTree(IFile* f)
+{
+	f->Seek(0);
+	std::vector<char> buffer(512 * 1024);
+	size_t lines=0;
+	_u32 read;
+	do
+	{
+		bool has_read_error = false;
+		read = f->Read(buffer.data(), static_cast<_u32>(buffer.size()), &has_read_error);
 
-	size_t stringbuffer_pos=0;
-	stringbuffer.resize(stringbuffer_size+5);
-	
-	
-	state=0;
-	bool isdir=false;
-	std::string data;
-	std::stack<TreeNode*> parents;
-	std::stack<TreeNode*> lastNodes;
-	bool firstChild=true;
+		if (has_read_error)
+		{
+			Log("Error reading from tree file -1");
+			return false;
+		}
 
-	size_t idx=1;
-	nodes.resize(lines+1);
+		const char* pos=buffer.data();
+		const char* end=buffer.data()+read;
+		while((pos=static_cast<const char*>(memchr(pos, '\n', end-pos)))!=NULL)
+		{
+			++lines;
+			++pos;
+		}
+	}
+	while(read>0);
 
-	std::string root_str = "root";
-	memcpy(&stringbuffer[0], root_str.c_str(), root_str.size()+1);
-	stringbuffer_pos+=root_str.size()+1;
+	//Upper bound. Also counts the lines ending directories
+	nodes.reserve(lines+1);
 
-	nodes[0].setName(&stringbuffer[0]);
+	nodes.add(c_treenode_none, 0, 0, 0, 0);
 
-	parents.push(&nodes[0]);
-	lastNodes.push(&nodes[0]);
+	struct SParent
+	{
+		SParent(unsigned int node)
+			: node(node), last_child(c_treenode_none)
+		{}
 
-	lines=0;
+		unsigned int node;
+		unsigned int last_child;
+	};
 
+	std::stack<SParent> parents;
+	parents.push(SParent(0));
 
-	do
+	TreeEntryReader reader(f);
+	STreeEntry entry;
+	while(reader.next(entry))
 	{
-		bool has_read_error = false;
-		read = f->Read(buffer.data(), buffer.size(), &has_read_error);
+		if(entry.type=='u')
+		{
+			if(parents.size()>1)
+			{
+				parents.pop();
+			}
+			continue;
+		}
 
-		if (has_read_error)
+		unsigned int name=names.add(entry.name.data(), entry.name.size());
+		unsigned int idx=c_treenode_none;
+		if(name!=c_treenode_none)
 		{
-			Log("Error reading from tree file -2");
-			return false;
+			idx=nodes.add(name, entry.type, entry.data[0], entry.data[1], entry.id);
 		}
-		
-		for(size_t i=0;i<read;++i)
+
+		if(idx==c_treenode_none)
 		{
-			const char ch=buffer[i];
-			switch(state)
-			{
-				case 0:
-					if(ch=='f')
-					{
-						data+='f';
-						state=1;
-					}
-					else if(ch=='d')
-					{
-						data+='d';
-						state=1;
-					}
-					else if(ch=='u')
-					{
-						name="..";
-						state=10;
-					}
-					else
-					{
-						Log("Error parsing file readTree - 1. Expected 'f', 'd', or 'u'. Got '" + std::string(1, ch) + "' at line " + convert(lines)+" while reading "+f->getFilename());
-						return false;
-					}					
-					break;
-				case 1:
-					//"
-					state=2;
-					break;
-				case 2:
-					if(ch=='"')
-					{
-						state=3;
-					}
-					else if(ch=='\\')
-					{
-						state=5;
-					}
-					else
-					{
-						name+=ch;
-					}
-					break;
-				case 5:
-					if(ch!='\"' && ch!='\\')
-					{
-						name+='\\';
-					}
-					name+=ch;
-					state=2;
-					break;
-				case 3:
-					if(ch==' ')
-					{
-						state=4;
-						break;
-					}
-					else
-					{
-						state=10;
-					}
-				case 4:
-					if(state==4)
-					{
-						if(ch!='\n')
-						{
-							data+=ch;
-							break;
-						}
-					}
-				case 10:
-					if(ch=='\n')
-					{
-						if(name!="..")
-						{
-							memcpy(&stringbuffer[stringbuffer_pos], name.c_str(), name.size()+1);
-							nodes[idx].setName(&stringbuffer[stringbuffer_pos]);
-							stringbuffer_pos+=name.size()+1;
-							nodes[idx].setId(lines);
-
-							char ch=data[0];
-							nodes[idx].setType(ch);
-							if(ch=='f')
-							{
-								std::string sdata=data.substr(1);
-								std::string filesize=getuntil(" ", sdata);
-								std::string last_mod=getafter(" ", sdata);
-
-								_i64 ifilesize=os_atoi64(filesize);
-								_i64 ilast_mod=os_atoi64(last_mod);
-
-								char* ndata=&stringbuffer[stringbuffer_pos];
-								memcpy(&stringbuffer[stringbuffer_pos], &ifilesize, sizeof(_i64));
-								stringbuffer_pos+=sizeof(_i64);
-								memcpy(&stringbuffer[stringbuffer_pos], &ilast_mod, sizeof(_i64));
-								stringbuffer_pos+=sizeof(_i64);
-
-								nodes[idx].setData(ndata);
-							}
-							else
-							{
-								std::string sdata=data.substr(1);
-								std::string last_mod=getafter(" ", sdata);
-
-								_i64 ilast_mod=os_atoi64(last_mod);
-								char* ndata=&stringbuffer[stringbuffer_pos];
-
-								memcpy(&stringbuffer[stringbuffer_pos], &ilast_mod, sizeof(_i64));
-								stringbuffer_pos+=sizeof(_i64);
-
-								nodes[idx].setData(ndata);
-							}
-
-							if(firstChild)
-							{
-								lastNodes.push(&nodes[idx]);
-								firstChild=false;
-							}
-							else
-							{
-								lastNodes.top()->setNextSibling(&nodes[idx]);
-								lastNodes.pop();
-								lastNodes.push(&nodes[idx]);
-							}
-
-							if(!parents.empty())
-							{
-								parents.top()->incrementNumChildren();
-								nodes[idx].setParent(parents.top());
-							}
-
-							if(ch=='d')
-							{
-								parents.push(&nodes[idx]);
-								firstChild=true;
-							}
-
-							++idx;
-						}
-						else
-						{
-							if(!parents.empty())
-							{
-								parents.pop();
-							}
-							else
-							{
-								Log("TreeReader: parents empty");
-								return false;
-							}
-							if(!firstChild)
-							{
-								if(lastNodes.empty())
-								{
-									Log("TreeReader: lastNodes empty");
-									return false;
-								}
-								lastNodes.top()->setNextSibling(NULL);
-								lastNodes.pop();
-							}
-							firstChild=false;
-						}
-
-						name.clear();
-						data.clear();
-						state=0;
-						++lines;
-					}
-			}		
+			Log("Too many entries in tree file "+f->getFilename());
+			return false;
 		}
-	}
-	while(read==buffer.size());
 
-	assert(idx == nodes.size());
-	assert(stringbuffer_pos == stringbuffer.size());
+		SParent& parent=parents.top();
+		if(parent.last_child==c_treenode_none)
+		{
+			nodes.setHasChildren(parent.node);
+		}
+		else
+		{
+			nodes.setNextSibling(parent.last_child, idx);
+		}
+		parent.last_child=idx;
 
-	nodes[0].setNextSibling(NULL);
+		if(entry.type=='d')
+		{
+			parents.push(SParent(idx));
+		}
+	}
 
-	return true;
+	return !reader.hasError();
 }
 
 void TreeReader::Log(const std::string &str)
@@ -371,7 +301,17 @@ void TreeReader::Log(const std::string &str)
 	Server->Log(str, LL_ERROR);
 }
 
-std::vector<TreeNode> * TreeReader::getNodes(void)
+TreeNodes& TreeReader::getNodes(void)
+{
+	return nodes;
+}
+
+TreeNamePool& TreeReader::getNames(void)
 {
-	return &nodes;
-}
\ No newline at end of file
+	return names;
+}
+
+size_t TreeReader::getMemoryUsage(void)
+{
+	return nodes.getMemoryUsage()+names.getMemoryUsage();
+}
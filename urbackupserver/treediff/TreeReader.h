@@ -2,16 +2,58 @@
 
 class IFile;
 
+/**
+* Entry of a file list. Type is 'f', 'd' or 'u' (end of directory).
+* Data is file size and last modified for files, last modified for
+* directories.
+*/
+struct STreeEntry
+{
+	char type;
+	std::string name;
+	int64 data[2];
+	size_t id;
+};
+
+/**
+* Parses a file list sequentially with a fixed size read buffer
+*/
+class TreeEntryReader
+{
+public:
+	TreeEntryReader(IFile* f);
+
+	//Returns false at the end of the file or on error
+	bool next(STreeEntry& entry);
+
+	bool hasError(void);
+
+private:
+	void Log(const std::string &str);
+
+	IFile* f;
+	std::vector<char> buffer;
+	size_t buffer_pos;
+	size_t buffer_size;
+	bool eof;
+	bool has_error;
+	size_t lines;
+	std::string data;
+};
+
 class TreeReader
 {
 public:
 	bool readTree(IFile* f);
 
-	std::vector<TreeNode> * getNodes(void);
+	TreeNodes& getNodes(void);
+	TreeNamePool& getNames(void);
+
+	size_t getMemoryUsage(void);
 private:
 
 	void Log(const std::string &str);
 
-	std::vector<TreeNode> nodes;
-	std::vector<char> stringbuffer;
+	TreeNodes nodes;
+	TreeNamePool names;
 };
\ No newline at end of file
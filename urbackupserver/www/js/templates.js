@@ -40,7 +40,7 @@
 (function(){dust.register("live_log",body_0);function body_0(chk,ctx){return chk.w("<html style=\"height: 100%\"><head><title>").f(ctx.get(["tUrBackup live log"], false),ctx,"h").w(": ").f(ctx.get(["clientname"], false),ctx,"h").w("</title><script language=\"JavaScript\" src=\"").f(ctx.get(["jquery_js"], false),ctx,"h").w("\"></script><script language=\"JavaScript\" src=\"").f(ctx.get(["dust_js"], false),ctx,"h").w("\"></script><script language=\"JavaScript\" src=\"").f(ctx.get(["templates_js"], false),ctx,"h").w("\"></script><script language=\"JavaScript\" src=\"").f(ctx.get(["urbackup_functions_js"], false),ctx,"h").w("\"></script><script type=\"text/javascript\">/*<!--*/if(!window.g)window.g=new Object();g.session=\"").f(ctx.get(["session"], false),ctx,"h").w("\";g.max_log_id=-1;g.clientid=").f(ctx.get(["clientid"], false),ctx,"h").w(";").x(ctx.get(["logid"], false),ctx,{"block":body_1},{}).w("g.live_log_rows=0;g.max_live_log_rows=500;g.refresh_log = function(){var lastid=\"\";if(g.max_log_id>0){lastid=\"&lastid=\"+g.max_log_id;}var logid=\"\";if(g.logid){logid=\"&logid=\"+g.logid;}new getJSON(\"livelog\", \"clientid=\"+g.clientid+lastid+logid, refresh_log2);};function refresh_log2(data){var new_data=\"\";for(var i=0;i<data.logdata.length;++i){var obj=data.logdata[i];if(obj.id>g.max_log_id){var s_loglevel=\"\";var background_color=\"\";if(obj.loglevel==1)background_color=\"background-color: yellow\";else if(obj.loglevel==2)background_color=\"background-color: red\";switch(obj.loglevel){case -1: s_loglevel=\"DEBUG\"; break;case  0: s_loglevel=\"INFO\"; break;case  1: s_loglevel=\"WARNING\"; break;case  2: s_loglevel=\"ERROR\"; break;}new_data+=dustRender(\"live_log_row\", {time: format_unix_timestamp(obj.time), loglevel: s_loglevel, message: obj.msg, background_color: background_color});g.max_log_id=obj.id;++g.live_log_rows;}}var deleted_height=0;if(g.live_log_rows>g.max_live_log_rows){var deleted_height_start=I('logdata').rows[g.live_log_rows-g.max_live_log_rows].getBoundingClientRect().bottom;while(g.live_log_rows>g.max_live_log_rows && I('logdata').rows.length>0){I('logdata').deleteRow(0);--g.live_log_rows;}deleted_height=deleted_height_start-I('logdata').rows[0].getBoundingClientRect().bottom;}if(new_data.length>0){var is_at_bottom=false;var body = document.body,html = document.documentElement;var height = Math.max( body.scrollHeight, body.offsetHeight, html.clientHeight, html.scrollHeight, html.offsetHeight );if(window.pageYOffset + window.innerHeight > height-20){is_at_bottom=true;}if(I('logdata').tBodies.length>0){I('logdata').tBodies[0].innerHTML+=new_data;}else{I('logdata').innerHTML+=new_data;}if(is_at_bottom){window.scrollTo(window.pageXOffset, window.pageYOffset + window.innerHeight);}else if(window.pageYOffset-deleted_height>0 && deleted_height>0){window.scrollTo(window.pageXOffset, window.pageYOffset-deleted_height);}}g.refresh_log();};/*-->*/</script></head><body onload=\"g.refresh_log()\" style=\"height: 100%\"><div style=\"height: 100%; position: absolute; left: 0px; top: 0px\">&nbsp;</div><table style=\"border: 0px\" id=\"logdata\" style=\"height: 100%\"></table><img src=\"images/indicator.gif\" /></body></html> ");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("g.logid=").f(ctx.get(["logid"], false),ctx,"h").w(";");}body_1.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_general",body_0);function body_0(chk,ctx){return chk.w("<ul class=\"nav nav-pills\" id=\"settings_tabber\"><li class=\"active\"><a href=\"#server_settings\" data-toggle=\"pill\">").f(ctx.get(["tServer"], false),ctx,"h").w("</a></li><li><a href=\"#file_backups\" data-toggle=\"pill\">").f(ctx.get(["tFile Backups"], false),ctx,"h").w("</a></li><li><a href=\"#image_backups\" data-toggle=\"pill\">").f(ctx.get(["tImage Backups"], false),ctx,"h").w("</a></li><li><a href=\"#permissions\" data-toggle=\"pill\">").f(ctx.get(["tPermissions"], false),ctx,"h").w("</a></li><li><a href=\"#client\" data-toggle=\"pill\">").f(ctx.get(["tClient"], false),ctx,"h").w("</a></li><li><a href=\"#archive\" data-toggle=\"pill\">").f(ctx.get(["tArchive"], false),ctx,"h").w("</a></li><li><a href=\"#alerts\" data-toggle=\"pill\">").f(ctx.get(["tAlerts"], false),ctx,"h").w("</a></li><li><a href=\"#passive\" data-toggle=\"pill\">").f(ctx.get(["tLocal/passive clients"], false),ctx,"h").w("</a></li>").f(ctx.get(["internet_settings_start"], false),ctx,"h",["s"]).w("<li><a href=\"#internet\" data-toggle=\"pill\">").f(ctx.get(["tInternet/Active clients"], false),ctx,"h").w("</a></li>").f(ctx.get(["internet_settings_end"], false),ctx,"h",["s"]).w("<li><a href=\"#advanced\" data-toggle=\"pill\">").f(ctx.get(["tAdvanced"], false),ctx,"h").w("</a></li></ul><div class=\"tab-content\"><div class=\"tab-pane active\" id=\"server_settings\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backupfolder\">").f(ctx.get(["tBackup storage path"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"backupfolder\" value=\"").f(ctx.get(["backupfolder"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"server_url\">").f(ctx.get(["tServer URL for client file/backup access/browsing"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"server_url\" value=\"").f(ctx.get(["server_url"], false),ctx,"h",["s"]).w("\" placeholder=\"http://example.com:55414\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"no_images\">").f(ctx.get(["tDo not do image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"no_images\" value=\"true\" ").f(ctx.get(["no_images"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"no_file_backups\">").f(ctx.get(["tDo not do file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"no_file_backups\" value=\"true\" ").f(ctx.get(["no_file_backups"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"autoshutdown\">").f(ctx.get(["tAutomatically shut down server"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"autoshutdown\" value=\"true\" ").f(ctx.get(["autoshutdown"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"download_client\">").f(ctx.get(["tDownload client from update server"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"download_client\" value=\"true\" ").f(ctx.get(["download_client"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"show_server_updates\">").f(ctx.get(["tShow when a new server version is available"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"show_server_updates\" value=\"true\" ").f(ctx.get(["show_server_updates"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tAutoupdate clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"autoupdate_clients\" value=\"true\" ").f(ctx.get(["autoupdate_clients"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_sim_backups\">").f(ctx.get(["tMax simultaneous backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_sim_backups\" value=\"").f(ctx.get(["max_sim_backups"], false),ctx,"h").w("\" /></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_active_clients\">").f(ctx.get(["tMax recently active clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_active_clients\" value=\"").f(ctx.get(["max_active_clients"], false),ctx,"h").w("\" /></div></div>").f(ctx.get(["ONLY_WIN32_BEGIN"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"tmpdir\">").f(ctx.get(["tNondefault temporary file directory"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"tmpdir\" value=\"").f(ctx.get(["tmpdir"], false),ctx,"h",["s"]).w("\" /></div></div>").f(ctx.get(["ONLY_WIN32_END"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cleanup_window\">").f(ctx.get(["tCleanup time window"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"cleanup_window\" value=\"").f(ctx.get(["cleanup_window"], false),ctx,"h",["s"]).w("\" /><div class=\"input-group-addon\"><a href=\"help.htm#cleanup_window\" target=\"_blank\">?</a></div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_database\">").f(ctx.get(["tAutomatically backup UrBackup database"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"backup_database\" ").f(ctx.get(["backup_database"], false),ctx,"h").w("/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_local_speed\">").f(ctx.get(["tTotal max backup speed for local network"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_local_speed\" value=\"").f(ctx.get(["global_local_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">MBit/s</div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_soft_fs_quota\">").f(ctx.get(["tGlobal soft filesystem quota"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_soft_fs_quota\" value=\"").f(ctx.get(["global_soft_fs_quota"], false),ctx,"h").w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#global_soft_fs_quota\" target=\"_blank\">?</a></div></div></div></div></form>&nbsp;</div></div></div>").f(ctx.get(["settings_inv"], false),ctx,"h",["s"]).w("</div><div style=\"text-align: right\"><input type=\"button\" class=\"btn btn-primary\" value=\"").f(ctx.get(["tSave"], false),ctx,"h").w("\" onClick=\"saveGeneralSettings()\" /><br />&nbsp;</div>");}body_0.__dustBody=!0;return body_0;})();
 (function(){dust.register("login",body_0);function body_0(chk,ctx){return chk.w("<div class=\"row\"><div class=\"col-sm-3\"></div><div class=\"col-sm-6 panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\" name=\"login1\" action=\"#\" onsubmit=\"return g.login1()\"><div class=\"form-group\" id=\"username_row\"><label for=\"username\">").f(ctx.get(["tUsername"], false),ctx,"h").w(":</label><input class=\"form-control\" id=\"username\" name=\"username\"></div><div class=\"form-group\"><label for=\"password\">").f(ctx.get(["tPassword"], false),ctx,"h").w(":</label><input type=\"password\" class=\"form-control\" id=\"password\" name=\"password\"></div><div class=\"form-group\"><button type=\"submit\" class=\"btn btn-default\">").f(ctx.get(["tLogin"], false),ctx,"h").w("</button></div></form></div></div><div class=\"col-sm-3\"></div></div>");}body_0.__dustBody=!0;return body_0;})();
-(function(){dust.register("settings_inv_row",body_0);function body_0(chk,ctx){return chk.x(ctx.get(["client_settings"], false),ctx,{"else":body_1,"block":body_2},{}).w("<div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_incr\">").f(ctx.get(["tInterval for incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_incr\" value=\"").f(ctx.get(["update_freq_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["thours"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_full\">").f(ctx.get(["tInterval for full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_full\" value=\"").f(ctx.get(["update_freq_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div>\t\t\t\t</div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_incr\">").f(ctx.get(["tMaximal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_incr\" value=\"").f(ctx.get(["max_file_incr"], false),ctx,"h").w("\"/></div><div id=\"max_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_incr\">").f(ctx.get(["tMinimal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_incr\" value=\"").f(ctx.get(["min_file_incr"], false),ctx,"h").w("\"/></div><div id=\"min_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_full\">").f(ctx.get(["tMaximal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_full\" value=\"").f(ctx.get(["max_file_full"], false),ctx,"h").w("\"/></div><div id=\"max_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_full\">").f(ctx.get(["tMinimal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_full\" value=\"").f(ctx.get(["min_file_full"], false),ctx,"h").w("\"/></div><div id=\"min_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"exclude_files\">").f(ctx.get(["tExcluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"exclude_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"exclude_files\" value=\"").f(ctx.get(["exclude_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#exclude_files\" target=\"_blank\">?</a></div></div></div><div id=\"exclude_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"include_files\">").f(ctx.get(["tIncluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"include_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"include_files\" value=\"").f(ctx.get(["include_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#include_files\" target=\"_blank\">?</a></div></div></div><div id=\"include_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"default_dirs\">").f(ctx.get(["tDefault directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"default_dirs_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"default_dirs\" value=\"").f(ctx.get(["default_dirs"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#default_dirs\" target=\"_blank\">?</a></div></div></div><div id=\"default_dirs_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dirs_optional\">").f(ctx.get(["tDirectories to backup are optional by default:"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"backup_dirs_optional\" ").f(ctx.get(["backup_dirs_optional"], false),ctx,"h").w("/></label></div><div id=\"backup_dirs_optional_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ransomware_canary_paths\">").f(ctx.get(["tRansomware canary paths:"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"ransomware_canary_paths_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"ransomware_canary_paths\" value=\"").f(ctx.get(["ransomware_canary_paths"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#ransomware_canary_paths\" target=\"_blank\">?</a></div></div></div><div id=\"ransomware_canary_paths_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"image_backups\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_incr\">").f(ctx.get(["tInterval for incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_incr\" value=\"").f(ctx.get(["update_freq_image_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_full\">").f(ctx.get(["tInterval for full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_full\" value=\"").f(ctx.get(["update_freq_image_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tDays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_incr\">").f(ctx.get(["tMaximal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_incr\" value=\"").f(ctx.get(["max_image_incr"], false),ctx,"h").w("\"/></div><div id=\"max_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_incr\">").f(ctx.get(["tMinimal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_incr\" value=\"").f(ctx.get(["min_image_incr"], false),ctx,"h").w("\"/></div><div id=\"min_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_full\">").f(ctx.get(["tMaximal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_full\" value=\"").f(ctx.get(["max_image_full"], false),ctx,"h").w("\"/></div><div id=\"max_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_full\">").f(ctx.get(["tMinimal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_full\" value=\"").f(ctx.get(["min_image_full"], false),ctx,"h").w("\"/></div><div id=\"min_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_letters\">").f(ctx.get(["tVolumes to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"image_letters_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"image_letters\" value=\"").f(ctx.get(["image_letters"], false),ctx,"h",["s","h"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#image_letters\" target=\"_blank\">?</a></div></div></div><div id=\"image_letters_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_file_format\">").f(ctx.get(["tImage backup file format"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"image_file_format\"><option value=\"vhdz\" ").f(ctx.get(["image_file_format_0"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHD (Compressed non-standard Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_1"], false),ctx,"h").w(">").f(ctx.get(["tVHD (Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhdx\" ").f(ctx.get(["image_file_format_2"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHDX (Compressed non-standard Virtual HardDisk v2) (beta)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_3"], false),ctx,"h").w(">").f(ctx.get(["tVHDX (Virtual HardDisk v2) (beta)"], false),ctx,"h").w("</option>").x(ctx.get(["cowraw_available"], false),ctx,{"block":body_3},{}).w("</select></div><div id=\"image_file_format_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_4},{}).w("<div class=\"tab-pane\" id=\"client\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["main_client"], false),ctx,{"block":body_5},{}).w("<div class=\"form-group\" id=\"backup_window_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window\" value=\"").f(ctx.get(["backup_window"], false),ctx,"h",["s"]).w("\" onchange=\"backupWindowChange()\"/><div class=\"input-group-addon\"><a href=\"javascript: showBackupWindowDetails()\">").f(ctx.get(["tShow details"], false),ctx,"h").w("</a>&nbsp;&nbsp;<a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_file_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window for incremental file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_file\" value=\"").f(ctx.get(["backup_window_incr_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_file_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_file\">").f(ctx.get(["tBackup window for full file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_file\" value=\"").f(ctx.get(["backup_window_full_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_incr_image\">").f(ctx.get(["tBackup window for incremental image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_image\" value=\"").f(ctx.get(["backup_window_incr_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_image_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_image\">").f(ctx.get(["tBackup window for full image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_image\" value=\"").f(ctx.get(["backup_window_full_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_image_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_6},{}).w("\t\t\t").x(ctx.get(["main_client"], false),ctx,{"block":body_7},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_quota\">").f(ctx.get(["tSoft client quota"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"client_quota\" value=\"").f(ctx.get(["client_quota"], false),ctx,"h").w("\"/></div><div id=\"client_quota_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_8},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_url\">").f(ctx.get(["tBackup destination URL"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_url_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_url\" value=\"").f(ctx.get(["backup_dest_url"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_url_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_params\">").f(ctx.get(["tBackup destination parameters"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_params_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_params\" value=\"").f(ctx.get(["backup_dest_params"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_params_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_secret_params\">").f(ctx.get(["tBackup destination secret server parameters"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_secret_params_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_secret_params\" value=\"").f(ctx.get(["backup_dest_secret_params"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_secret_params_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_unlocked_window\">").f(ctx.get(["tOnly run backups if unlocked in this backup window"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_unlocked_window\" value=\"").f(ctx.get(["backup_unlocked_window"], false),ctx,"h").w("\"/></div></div><div id=\"backup_unlocked_window_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"archive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><div id=\"archive_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div><table class=\"table table-striped\" id=\"archive_table\"><thead><tr><th>").f(ctx.get(["tArchive every"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive for"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive window"], false),ctx,"h").w(" <a class=\"btn btn-xs btn-default\" href=\"help.htm#archive_window\" target=\"_blank\" title=\"h;dom;mon;dow\">?</a></th><th>").f(ctx.get(["tBackup type"], false),ctx,"h").w("</th><th>").f(ctx.get(["tVolume letters"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<th>").f(ctx.get(["tNext archival"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<th>&nbsp;</th><th>&nbsp;</th></tr></thead><tbody><tr><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_every\"></div><select class=\"form-control\" style=\"width: 40%\" id=\"archive_every_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option></select></td><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_for\"></div><select class=\"form-control\" style=\"width: 40%\" onchange=\"changeArchiveForUnit()\" id=\"archive_for_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option><option value=\"i\">").f(ctx.get(["tforever"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_window\" value=\"*;*;*;*\"></td><td><select class=\"form-control\" id=\"archive_backup_type\" onchange=\"changeArchiveBackupType()\"><option value=\"file\">").f(ctx.get(["tFile backup"], false),ctx,"h").w("</option><option value=\"incr_file\">").f(ctx.get(["tIncremental file backup"], false),ctx,"h").w("</option><option value=\"full_file\">").f(ctx.get(["tFull file backup"], false),ctx,"h").w("</option><option value=\"image\">").f(ctx.get(["tImage backup"], false),ctx,"h").w("</option><option value=\"incr_image\">").f(ctx.get(["tIncremental image backup"], false),ctx,"h").w("</option><option value=\"full_image\">").f(ctx.get(["tFull image backup"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_letters\" value=\"ALL\" disabled=\"disabled\"></td>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<td>&nbsp;</td>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<td></td><td>").x(ctx.get(["archive_global"], false),ctx,{"block":body_9},{}).f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(false)\" />").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("\t\t</td></tr></tbody></table></div></div></div><div class=\"tab-pane\" id=\"alerts\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"alert_script\">").f(ctx.get(["tAlert script"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"alert_script\" onChange=\"updateAlertScriptParams()\">").f(ctx.get(["alert_scripts"], false),ctx,"h",["s"]).w("</select></div>").x(ctx.get(["can_edit_scripts"], false),ctx,{"block":body_10},{}).w("<div id=\"alert_script_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div></div>\t\t\t<div id=\"alert_script_params_container\">").f(ctx.get(["mod_alert_params"], false),ctx,"h",["s"]).w("</div></form></div></div></div><div class=\"tab-pane\" id=\"passive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_speed\">").f(ctx.get(["tMax backup speed for local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"local_speed\" value=\"").f(ctx.get(["local_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">MBit/s</div></div></div><div id=\"local_speed_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_encrypt\">").f(ctx.get(["tEncrypt local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"local_encrypt\" value=\"false\" ").f(ctx.get(["local_encrypt"], false),ctx,"h").w("/></label></div><div id=\"local_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_compress\">").f(ctx.get(["tCompress local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"local_compress\" value=\"false\" ").f(ctx.get(["local_compress"], false),ctx,"h").w("/></label></div><div id=\"local_compress_sw\" style=\"display: inline\"></div></div></form></div></div></div>").f(ctx.get(["internet_settings_start"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"internet\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["global_settings"], false),ctx,{"block":body_11},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_12},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_backups\">").f(ctx.get(["tDo image backups as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_image_backups\" value=\"false\" ").f(ctx.get(["internet_image_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_backups\">").f(ctx.get(["tDo full file backups as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_full_file_backups\" value=\"false\" ").f(ctx.get(["internet_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_speed\">").f(ctx.get(["tMax backup speed as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_speed\" value=\"").f(ctx.get(["internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"internet_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_15},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_16},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_calculate_filehashes_on_client\">").f(ctx.get(["tCalculate file-hashes on the client as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_calculate_filehashes_on_client\" value=\"false\" ").f(ctx.get(["internet_calculate_filehashes_on_client"], false),ctx,"h").w("/></label></div><div id=\"internet_calculate_filehashes_on_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_parallel_file_hashing\">Beta: Calculate file hashes on client in parallel as Internet/active client:</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_parallel_file_hashing\" value=\"false\" ").f(ctx.get(["internet_parallel_file_hashing"], false),ctx,"h").w("/></label></div><div id=\"internet_parallel_file_hashing_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_17},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_file_dataplan_limit\">").f(ctx.get(["tDo not start file backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_file_dataplan_limit\" value=\"").f(ctx.get(["internet_file_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_file_dataplan_limit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_dataplan_limit\">").f(ctx.get(["tDo not start image backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_image_dataplan_limit\" value=\"").f(ctx.get(["internet_image_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_image_dataplan_limit_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_18},{}).w("</form></div></div></div>").f(ctx.get(["internet_settings_end"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"advanced\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles\">").f(ctx.get(["tTemporary files as file backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles\" value=\"false\" ").f(ctx.get(["use_tmpfiles"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles_images\">").f(ctx.get(["tTemporary files as image backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles_images\" value=\"false\" ").f(ctx.get(["use_tmpfiles_images"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_bind_port\">").f(ctx.get(["tNon-default UrBackup Internet protocol TCP port"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_bind_port\" value=\"").f(ctx.get(["internet_server_bind_port"], false),ctx,"h").w("\"/></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_file_transfer_mode\">").f(ctx.get(["tLocal/passive full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_transfer_mode\">").f(ctx.get(["tInternet/active full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_file_transfer_mode\">").f(ctx.get(["tLocal/passive incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["local_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_file_transfer_mode\">").f(ctx.get(["tInternet/active incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["internet_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_image_transfer_mode\">").f(ctx.get(["tLocal/passive image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_image_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_transfer_mode\">").f(ctx.get(["tInternet/active image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_image_transfer_mode_sw\" style=\"display: inline\"></div></div>\t\t\t<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_image_style\">").f(ctx.get(["tLocal/passive incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["local_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["local_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_image_style\">").f(ctx.get(["tInternet/active incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["internet_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["internet_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_image_style\">").f(ctx.get(["tLocal/passive full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_image_style\"><option value=\"full\" ").f(ctx.get(["local_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["local_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_full_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_image_style\">").f(ctx.get(["tInternet/active full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_image_style\"><option value=\"full\" ").f(ctx.get(["internet_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["internet_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_image_style_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_stats_cachesize\">").f(ctx.get(["tDatabase cache size during batch processing"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_stats_cachesize\" value=\"").f(ctx.get(["update_stats_cachesize"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_incremental_symlinks\">").f(ctx.get(["tUse symlinks during incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_incremental_symlinks\" value=\"false\" ").f(ctx.get(["use_incremental_symlinks"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_expect_endpoint\">").f(ctx.get(["tList of server IPs (proxys) from which to expect endpoint information (forwarded for) when connecting to Internet/active service (needs server restart)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_expect_endpoint\" value=\"").f(ctx.get(["internet_expect_endpoint"], false),ctx,"h").w("\"/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"end_to_end_file_backup_verification\">").f(ctx.get(["tDebugging: End-to-end verification of all file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"end_to_end_file_backup_verification\" value=\"false\" ").f(ctx.get(["end_to_end_file_backup_verification"], false),ctx,"h").w("/></label></div><div id=\"end_to_end_file_backup_verification_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"verify_using_client_hashes\">").f(ctx.get(["tDebugging: Verify file backups using client side hashes"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"verify_using_client_hashes\" value=\"false\" ").f(ctx.get(["verify_using_client_hashes"], false),ctx,"h").w("/></label></div><div id=\"verify_using_client_hashes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_readd_file_entries\">").f(ctx.get(["tPeriodically readd file entries of internet clients to database (disable only if you do not run fulls)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_readd_file_entries\" value=\"true\" ").f(ctx.get(["internet_readd_file_entries"], false),ctx,"h").w("/></label></div><div id=\"internet_readd_file_entries_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"background_backups\">").f(ctx.get(["tRun backups with background priority on the clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"background_backups\" value=\"true\" ").f(ctx.get(["background_backups"], false),ctx,"h").w("/></label></div><div id=\"background_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"create_linked_user_views\">").f(ctx.get(["tCreate symbolically linked views for each user on the clients after file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"create_linked_user_views\" value=\"true\" ").f(ctx.get(["create_linked_user_views"], false),ctx,"h").w("/></label></div><div id=\"create_linked_user_views_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_running_jobs_per_client\">").f(ctx.get(["tMaximum number of simultaneous jobs per client"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"max_running_jobs_per_client\" value=\"").f(ctx.get(["max_running_jobs_per_client"], false),ctx,"h").w("\"/></label></div><div id=\"max_running_jobs_per_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_volumes\">").f(ctx.get(["tList of volumes for which change block tracking should be used (if available)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_volumes\" value=\"").f(ctx.get(["cbt_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_crash_persistent_volumes\">").f(ctx.get(["tList of volumes for which the change block tracking should be crash persistent"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_crash_persistent_volumes\" value=\"").f(ctx.get(["cbt_crash_persistent_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_crash_persistent_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ignore_disk_errors\">").f(ctx.get(["tDo not fail backups in case of hash mismatches or read errors"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"ignore_disk_errors\" value=\"true\" ").f(ctx.get(["ignore_disk_errors"], false),ctx,"h").w("/></label></div><div id=\"ignore_disk_errors_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_snapshot_groups\" value=\"").f(ctx.get(["image_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"image_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_snapshot_groups\" value=\"").f(ctx.get(["file_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"file_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"vss_select_components\">").f(ctx.get(["tWindows components backup configuration"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"vss_select_components_div\"><label><input type=\"text\" class=\"form-control\" id=\"vss_select_components\" value=\"").f(ctx.get(["vss_select_components"], false),ctx,"h").w("\"/></label></div><div id=\"vss_select_components_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_settings_tray_access_pw\">").f(ctx.get(["tRequire tray icon users to enter following text before being able to change settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_settings_tray_access_pw\" value=\"").f(ctx.get(["client_settings_tray_access_pw"], false),ctx,"h").w("\"/></label></div><div id=\"client_settings_tray_access_pw_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"download_threads\">Beta: ").f(ctx.get(["tNumber of parallel file download threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"download_threads\" value=\"").f(ctx.get(["download_threads"], false),ctx,"h").w("\"/></label></div><div id=\"download_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"hash_threads\">Beta: ").f(ctx.get(["tNumber of parallel server file hash threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"hash_threads\" value=\"").f(ctx.get(["hash_threads"], false),ctx,"h").w("\"/></label></div><div id=\"hash_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_hash_threads\">Beta: ").f(ctx.get(["tNumber of parallel client file hash threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_hash_threads\" value=\"").f(ctx.get(["client_hash_threads"], false),ctx,"h").w("\"/></label></div><div id=\"client_hash_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_compress_threads\">Beta: ").f(ctx.get(["tNumber of threads to use for VHDZ compression (0: auto)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_compress_threads\" value=\"").f(ctx.get(["image_compress_threads"], false),ctx,"h").w("\"/></label></div><div id=\"image_compress_threads_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["client_settings"], false),ctx,{"block":body_19},{});}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"file_backups\">");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<div class=\"tab-pane active\" id=\"file_backups\">");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<option value=\"cowraw\" ").f(ctx.get(["image_file_format_4"], false),ctx,"h").w(">").f(ctx.get(["tRaw copy-on-write file"], false),ctx,"h").w("</option>");}body_3.__dustBody=!0;function body_4(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"permissions\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_config_paths\">").f(ctx.get(["tAllow client-side changing of the directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_config_paths\" ").f(ctx.get(["allow_config_paths"], false),ctx,"h").w("/></label></div><div id=\"allow_config_paths_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_file_backups\">").f(ctx.get(["tAllow client-side starting of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_full_file_backups\" ").f(ctx.get(["allow_starting_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_file_backups\">").f(ctx.get(["tAllow client-side starting of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_file_backups\" ").f(ctx.get(["allow_starting_incr_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_image_backups\">").f(ctx.get(["tAllow client-side starting of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"allow_starting_full_image_backups\" ").f(ctx.get(["allow_starting_full_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_image_backups\">").f(ctx.get(["tAllow client-side starting of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_image_backups\" ").f(ctx.get(["allow_starting_incr_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_log_view\">").f(ctx.get(["tAllow client-side viewing of backup logs"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_log_view\" ").f(ctx.get(["allow_log_view"], false),ctx,"h").w("/></label></div><div id=\"allow_log_view_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_pause\">").f(ctx.get(["tAllow client-side pausing of backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_pause\" ").f(ctx.get(["allow_pause"], false),ctx,"h").w("/></label></div><div id=\"allow_pause_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_verwrite\">").f(ctx.get(["tAllow client-side changing of settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_overwrite\" ").f(ctx.get(["allow_overwrite"], false),ctx,"h").w("/></label></div><div id=\"allow_overwrite_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_tray_exit\">").f(ctx.get(["tAllow clients to quit the tray icon"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_tray_exit\" ").f(ctx.get(["allow_tray_exit"], false),ctx,"h").w("/></label></div><div id=\"allow_tray_exit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_file_restore\">").f(ctx.get(["tAllow clients to start file restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_file_restore\" ").f(ctx.get(["allow_file_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_file_restore_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_config\">").f(ctx.get(["tAllow clients to configure components to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_config\" ").f(ctx.get(["allow_component_config"], false),ctx,"h").w("/></label></div><div id=\"allow_component_config_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_restore\">").f(ctx.get(["tAllow clients to start component restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_restore\" ").f(ctx.get(["allow_component_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_component_restore_sw\" style=\"display: inline\"></div></div></form></div></div></div>");}body_4.__dustBody=!0;function body_5(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"startup_backup_delay\">").f(ctx.get(["tDelay after system startup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"startup_backup_delay\" value=\"").f(ctx.get(["startup_backup_delay"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMin"], false),ctx,"h").w("</div></div></div><div id=\"startup_backup_delay_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"pause_if_windows_unlocked\">").f(ctx.get(["tPause backups if Windows is unlocked"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"pause_if_windows_unlocked\" ").f(ctx.get(["pause_if_windows_unlocked"], false),ctx,"h").w("/></label></div><div id=\"pause_if_windows_unlocked_sw\" style=\"display: inline\"></div></div>");}body_5.__dustBody=!0;function body_6(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"computername\">").f(ctx.get(["tClient name"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"computername\" value=\"").f(ctx.get(["computername"], false),ctx,"h").w("\"/></div><div id=\"computername_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_6.__dustBody=!0;function body_7(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"silent_update\">").f(ctx.get(["tPerform autoupdates silently"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"silent_update\" ").f(ctx.get(["silent_update"], false),ctx,"h").w("/></label></div><div id=\"silent_update_sw\" style=\"display: inline\"></div></div>");}body_7.__dustBody=!0;function body_8(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"virtual_clients\">").f(ctx.get(["tAdditional virtual sub client names"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"virtual_clients_div\"><input type=\"text\" class=\"form-control\" id=\"virtual_clients\" value=\"").f(ctx.get(["virtual_clients"], false),ctx,"h").w("\"/></div><div id=\"virtual_clients_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_8.__dustBody=!0;function body_9(chk,ctx){return chk.w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(true)\" />");}body_9.__dustBody=!0;function body_10(chk,ctx){return chk.w("<a href=\"javascript: show_scripts1()\">").f(ctx.get(["tEdit scripts"], false),ctx,"h").w("</a>");}body_10.__dustBody=!0;function body_11(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tClients try to connect via Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"true\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server\">").f(ctx.get(["tServer URL clients connect to"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server\" value=\"").f(ctx.get(["internet_server"], false),ctx,"h").w("\" placeholder=\"ws://example.com:55414/socket\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_proxy\">").f(ctx.get(["tConnect via HTTP(S) proxy (leave empty to connect without)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_proxy\" value=\"").f(ctx.get(["internet_server_proxy"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_11.__dustBody=!0;function body_12(chk,ctx){return chk.nx(ctx.get(["global_settings"], false),ctx,{"block":body_13},{}).x(ctx.get(["with_authkey"], false),ctx,{"block":body_14},{});}body_12.__dustBody=!0;function body_13(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tTry to to connect via Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"true\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div><div id=\"internet_mode_enabled_sw\" style=\"display: inline\"></div></div>");}body_13.__dustBody=!0;function body_14(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_authkey\">").f(ctx.get(["tAuth key"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_authkey\" value=\"").f(ctx.get(["internet_authkey"], false),ctx,"h",["s"]).w("\"/></label></div></div>");}body_14.__dustBody=!0;function body_15(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_internet_speed\">").f(ctx.get(["tTotal max backup speed for Internet/active connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_internet_speed\" value=\"").f(ctx.get(["global_internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"global_internet_speed_sw\" style=\"display: inline\"></div></div>");}body_15.__dustBody=!0;function body_16(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_encrypt\">").f(ctx.get(["tEncrypted Internet/active transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_encrypt\" value=\"false\" ").f(ctx.get(["internet_encrypt"], false),ctx,"h").w("/></label></div><div id=\"internet_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_compress\">").f(ctx.get(["tCompressed Internet/active transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_compress\" value=\"false\" ").f(ctx.get(["internet_compress"], false),ctx,"h").w("/></label></div><div id=\"internet_compress_sw\" style=\"display: inline\"></div></div>");}body_16.__dustBody=!0;function body_17(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_connect_always\">").f(ctx.get(["tConnect as Internet/active client if connected to as local/passive client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_connect_always\" value=\"false\" ").f(ctx.get(["internet_connect_always"], false),ctx,"h").w("/></label></div><div id=\"internet_connect_always_sw\" style=\"display: inline\"></div></div>");}body_17.__dustBody=!0;function body_18(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_dataplan_db\">").f(ctx.get(["tUpdate data limit estimation database"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"update_dataplan_db\" value=\"true\" ").f(ctx.get(["update_dataplan_db"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"restore_authkey\">").f(ctx.get(["tInternet/active restore authentication key"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"restore_authkey\" value=\"").f(ctx.get(["restore_authkey"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_18.__dustBody=!0;function body_19(chk,ctx){return chk.w("</div>");}body_19.__dustBody=!0;return body_0;})();
+(function(){dust.register("settings_inv_row",body_0);function body_0(chk,ctx){return chk.x(ctx.get(["client_settings"], false),ctx,{"else":body_1,"block":body_2},{}).w("<div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_incr\">").f(ctx.get(["tInterval for incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_incr\" value=\"").f(ctx.get(["update_freq_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["thours"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_full\">").f(ctx.get(["tInterval for full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_full\" value=\"").f(ctx.get(["update_freq_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div>\t\t\t\t</div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_incr\">").f(ctx.get(["tMaximal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_incr\" value=\"").f(ctx.get(["max_file_incr"], false),ctx,"h").w("\"/></div><div id=\"max_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_incr\">").f(ctx.get(["tMinimal number of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_incr\" value=\"").f(ctx.get(["min_file_incr"], false),ctx,"h").w("\"/></div><div id=\"min_file_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_file_full\">").f(ctx.get(["tMaximal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_file_full\" value=\"").f(ctx.get(["max_file_full"], false),ctx,"h").w("\"/></div><div id=\"max_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_file_full\">").f(ctx.get(["tMinimal number of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_file_full\" value=\"").f(ctx.get(["min_file_full"], false),ctx,"h").w("\"/></div><div id=\"min_file_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"exclude_files\">").f(ctx.get(["tExcluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"exclude_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"exclude_files\" value=\"").f(ctx.get(["exclude_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#exclude_files\" target=\"_blank\">?</a></div></div></div><div id=\"exclude_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"include_files\">").f(ctx.get(["tIncluded files (with wildcards)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"include_files_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"include_files\" value=\"").f(ctx.get(["include_files"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#include_files\" target=\"_blank\">?</a></div></div></div><div id=\"include_files_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"default_dirs\">").f(ctx.get(["tDefault directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"default_dirs_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"default_dirs\" value=\"").f(ctx.get(["default_dirs"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#default_dirs\" target=\"_blank\">?</a></div></div></div><div id=\"default_dirs_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dirs_optional\">").f(ctx.get(["tDirectories to backup are optional by default:"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"backup_dirs_optional\" ").f(ctx.get(["backup_dirs_optional"], false),ctx,"h").w("/></label></div><div id=\"backup_dirs_optional_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ransomware_canary_paths\">").f(ctx.get(["tRansomware canary paths:"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"ransomware_canary_paths_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"ransomware_canary_paths\" value=\"").f(ctx.get(["ransomware_canary_paths"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#ransomware_canary_paths\" target=\"_blank\">?</a></div></div></div><div id=\"ransomware_canary_paths_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"image_backups\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_incr\">").f(ctx.get(["tInterval for incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_incr\" value=\"").f(ctx.get(["update_freq_image_incr"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tdays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_incr_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_incr_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_freq_image_full\">").f(ctx.get(["tInterval for full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_freq_image_full\" value=\"").f(ctx.get(["update_freq_image_full"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tDays"], false),ctx,"h").w("</div></div></div><div id=\"update_freq_image_full_sw\" style=\"display: inline\"></div><div class=\"checkbox-inline\" style=\"margin-left: 5pt\"><label><input type=\"checkbox\" id=\"update_freq_image_full_disable\" onchange=\"settingsCheckboxChange($(this).attr('id'))\"/>").f(ctx.get(["tDisable"], false),ctx,"h").w("</label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_incr\">").f(ctx.get(["tMaximal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_incr\" value=\"").f(ctx.get(["max_image_incr"], false),ctx,"h").w("\"/></div><div id=\"max_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_incr\">").f(ctx.get(["tMinimal number of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_incr\" value=\"").f(ctx.get(["min_image_incr"], false),ctx,"h").w("\"/></div><div id=\"min_image_incr_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_image_full\">").f(ctx.get(["tMaximal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"max_image_full\" value=\"").f(ctx.get(["max_image_full"], false),ctx,"h").w("\"/></div><div id=\"max_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"min_image_full\">").f(ctx.get(["tMinimal number of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"min_image_full\" value=\"").f(ctx.get(["min_image_full"], false),ctx,"h").w("\"/></div><div id=\"min_image_full_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_letters\">").f(ctx.get(["tVolumes to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"image_letters_div\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"image_letters\" value=\"").f(ctx.get(["image_letters"], false),ctx,"h",["s","h"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#image_letters\" target=\"_blank\">?</a></div></div></div><div id=\"image_letters_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_file_format\">").f(ctx.get(["tImage backup file format"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"image_file_format\"><option value=\"vhdz\" ").f(ctx.get(["image_file_format_0"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHD (Compressed non-standard Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_1"], false),ctx,"h").w(">").f(ctx.get(["tVHD (Virtual HardDisk)"], false),ctx,"h").w("</option><option value=\"vhdx\" ").f(ctx.get(["image_file_format_2"], false),ctx,"h").w(">").f(ctx.get(["tCompressed VHDX (Compressed non-standard Virtual HardDisk v2) (beta)"], false),ctx,"h").w("</option><option value=\"vhd\" ").f(ctx.get(["image_file_format_3"], false),ctx,"h").w(">").f(ctx.get(["tVHDX (Virtual HardDisk v2) (beta)"], false),ctx,"h").w("</option><option value=\"dedup\" ").f(ctx.get(["image_file_format_4"], false),ctx,"h").w(">").f(ctx.get(["tDeduplicated image blocks (shared block store) (beta)"], false),ctx,"h").w("</option>").x(ctx.get(["cowraw_available"], false),ctx,{"block":body_3},{}).w("</select></div><div id=\"image_file_format_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_4},{}).w("<div class=\"tab-pane\" id=\"client\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["main_client"], false),ctx,{"block":body_5},{}).w("<div class=\"form-group\" id=\"backup_window_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window\" value=\"").f(ctx.get(["backup_window"], false),ctx,"h",["s"]).w("\" onchange=\"backupWindowChange()\"/><div class=\"input-group-addon\"><a href=\"javascript: showBackupWindowDetails()\">").f(ctx.get(["tShow details"], false),ctx,"h").w("</a>&nbsp;&nbsp;<a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_file_row\"><label class=\"col-sm-4 control-label\">").f(ctx.get(["tBackup window for incremental file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_file\" value=\"").f(ctx.get(["backup_window_incr_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_file_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_file\">").f(ctx.get(["tBackup window for full file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_file\" value=\"").f(ctx.get(["backup_window_full_file"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_file_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_incr_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_incr_image\">").f(ctx.get(["tBackup window for incremental image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_incr_image\" value=\"").f(ctx.get(["backup_window_incr_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_incr_image_sw\" style=\"display: inline\"></div></div><div class=\"form-group\" id=\"backup_window_full_image_row\"><label class=\"col-sm-4 control-label\" for=\"backup_window_full_image\">").f(ctx.get(["tBackup window for full image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_window_full_image\" value=\"").f(ctx.get(["backup_window_full_image"], false),ctx,"h",["s"]).w("\"/><div class=\"input-group-addon\"><a href=\"help.htm#backup_window\" target=\"_blank\">?</a></div></div></div><div id=\"backup_window_full_image_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_6},{}).w("\t\t\t").x(ctx.get(["main_client"], false),ctx,{"block":body_7},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_quota\">").f(ctx.get(["tSoft client quota"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"client_quota\" value=\"").f(ctx.get(["client_quota"], false),ctx,"h").w("\"/></div><div id=\"client_quota_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_8},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_url\">").f(ctx.get(["tBackup destination URL"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_url_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_url\" value=\"").f(ctx.get(["backup_dest_url"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_url_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_params\">").f(ctx.get(["tBackup destination parameters"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_params_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_params\" value=\"").f(ctx.get(["backup_dest_params"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_params_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_dest_secret_params\">").f(ctx.get(["tBackup destination secret server parameters"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"backup_dest_secret_params_div\"><input type=\"text\" class=\"form-control\" id=\"backup_dest_secret_params\" value=\"").f(ctx.get(["backup_dest_secret_params"], false),ctx,"h",["s"]).w("\"/></div><div id=\"backup_dest_secret_params_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"backup_unlocked_window\">").f(ctx.get(["tOnly run backups if unlocked in this backup window"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"backup_unlocked_window\" value=\"").f(ctx.get(["backup_unlocked_window"], false),ctx,"h").w("\"/></div></div><div id=\"backup_unlocked_window_sw\" style=\"display: inline\"></div></div></form></div></div></div><div class=\"tab-pane\" id=\"archive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><div id=\"archive_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div><table class=\"table table-striped\" id=\"archive_table\"><thead><tr><th>").f(ctx.get(["tArchive every"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive for"], false),ctx,"h").w("</th><th>").f(ctx.get(["tArchive window"], false),ctx,"h").w(" <a class=\"btn btn-xs btn-default\" href=\"help.htm#archive_window\" target=\"_blank\" title=\"h;dom;mon;dow\">?</a></th><th>").f(ctx.get(["tBackup type"], false),ctx,"h").w("</th><th>").f(ctx.get(["tVolume letters"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<th>").f(ctx.get(["tNext archival"], false),ctx,"h").w("</th>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<th>&nbsp;</th><th>&nbsp;</th></tr></thead><tbody><tr><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_every\"></div><select class=\"form-control\" style=\"width: 40%\" id=\"archive_every_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option></select></td><td><div style=\"float: left; width: 60%\"><input class=\"form-control\" type=\"text\" id=\"archive_for\"></div><select class=\"form-control\" style=\"width: 40%\" onchange=\"changeArchiveForUnit()\" id=\"archive_for_unit\"><option value=\"h\">").f(ctx.get(["thours"], false),ctx,"h").w("</option><option value=\"d\" selected=\"selected\">").f(ctx.get(["tdays"], false),ctx,"h").w("</option><option value=\"w\">").f(ctx.get(["tweeks"], false),ctx,"h").w("</option><option value=\"m\">").f(ctx.get(["tmonth"], false),ctx,"h").w("</option><option value=\"y\">").f(ctx.get(["tyears"], false),ctx,"h").w("</option><option value=\"i\">").f(ctx.get(["tforever"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_window\" value=\"*;*;*;*\"></td><td><select class=\"form-control\" id=\"archive_backup_type\" onchange=\"changeArchiveBackupType()\"><option value=\"file\">").f(ctx.get(["tFile backup"], false),ctx,"h").w("</option><option value=\"incr_file\">").f(ctx.get(["tIncremental file backup"], false),ctx,"h").w("</option><option value=\"full_file\">").f(ctx.get(["tFull file backup"], false),ctx,"h").w("</option><option value=\"image\">").f(ctx.get(["tImage backup"], false),ctx,"h").w("</option><option value=\"incr_image\">").f(ctx.get(["tIncremental image backup"], false),ctx,"h").w("</option><option value=\"full_image\">").f(ctx.get(["tFull image backup"], false),ctx,"h").w("</option></select></td><td><input class=\"form-control\" type=\"text\" id=\"archive_letters\" value=\"ALL\" disabled=\"disabled\"></td>").f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<td>&nbsp;</td>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("<td></td><td>").x(ctx.get(["archive_global"], false),ctx,{"block":body_9},{}).f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(false)\" />").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]).w("\t\t</td></tr></tbody></table></div></div></div><div class=\"tab-pane\" id=\"alerts\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"alert_script\">").f(ctx.get(["tAlert script"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"alert_script\" onChange=\"updateAlertScriptParams()\">").f(ctx.get(["alert_scripts"], false),ctx,"h",["s"]).w("</select></div>").x(ctx.get(["can_edit_scripts"], false),ctx,{"block":body_10},{}).w("<div id=\"alert_script_sw\" style=\"float: right; margin-left: 10pt; margin-right: 10pt\"></div></div>\t\t\t<div id=\"alert_script_params_container\">").f(ctx.get(["mod_alert_params"], false),ctx,"h",["s"]).w("</div></form></div></div></div><div class=\"tab-pane\" id=\"passive\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_speed\">").f(ctx.get(["tMax backup speed for local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"local_speed\" value=\"").f(ctx.get(["local_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">MBit/s</div></div></div><div id=\"local_speed_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_encrypt\">").f(ctx.get(["tEncrypt local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"local_encrypt\" value=\"false\" ").f(ctx.get(["local_encrypt"], false),ctx,"h").w("/></label></div><div id=\"local_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_compress\">").f(ctx.get(["tCompress local/passive transfers"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"local_compress\" value=\"false\" ").f(ctx.get(["local_compress"], false),ctx,"h").w("/></label></div><div id=\"local_compress_sw\" style=\"display: inline\"></div></div></form></div></div></div>").f(ctx.get(["internet_settings_start"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"internet\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").x(ctx.get(["global_settings"], false),ctx,{"block":body_11},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_12},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_backups\">").f(ctx.get(["tDo image backups as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_image_backups\" value=\"false\" ").f(ctx.get(["internet_image_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_backups\">").f(ctx.get(["tDo full file backups as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_full_file_backups\" value=\"false\" ").f(ctx.get(["internet_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"internet_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_speed\">").f(ctx.get(["tMax backup speed as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_speed\" value=\"").f(ctx.get(["internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"internet_speed_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_15},{}).x(ctx.get(["main_client"], false),ctx,{"block":body_16},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_calculate_filehashes_on_client\">").f(ctx.get(["tCalculate file-hashes on the client as Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_calculate_filehashes_on_client\" value=\"false\" ").f(ctx.get(["internet_calculate_filehashes_on_client"], false),ctx,"h").w("/></label></div><div id=\"internet_calculate_filehashes_on_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_parallel_file_hashing\">Beta: Calculate file hashes on client in parallel as Internet/active client:</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_parallel_file_hashing\" value=\"false\" ").f(ctx.get(["internet_parallel_file_hashing"], false),ctx,"h").w("/></label></div><div id=\"internet_parallel_file_hashing_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["main_client"], false),ctx,{"block":body_17},{}).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_file_dataplan_limit\">").f(ctx.get(["tDo not start file backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_file_dataplan_limit\" value=\"").f(ctx.get(["internet_file_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_file_dataplan_limit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_dataplan_limit\">").f(ctx.get(["tDo not start image backups if current estimated data usage limit per month is smaller than"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"internet_image_dataplan_limit\" value=\"").f(ctx.get(["internet_image_dataplan_limit"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div><div id=\"internet_image_dataplan_limit_sw\" style=\"display: inline\"></div></div>").x(ctx.get(["global_settings"], false),ctx,{"block":body_18},{}).w("</form></div></div></div>").f(ctx.get(["internet_settings_end"], false),ctx,"h",["s"]).w("<div class=\"tab-pane\" id=\"advanced\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\">").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles\">").f(ctx.get(["tTemporary files as file backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles\" value=\"false\" ").f(ctx.get(["use_tmpfiles"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_tmpfiles_images\">").f(ctx.get(["tTemporary files as image backup buffer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_tmpfiles_images\" value=\"false\" ").f(ctx.get(["use_tmpfiles_images"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_bind_port\">").f(ctx.get(["tNon-default UrBackup Internet protocol TCP port"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_bind_port\" value=\"").f(ctx.get(["internet_server_bind_port"], false),ctx,"h").w("\"/></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_file_transfer_mode\">").f(ctx.get(["tLocal/passive full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_file_transfer_mode\">").f(ctx.get(["tInternet/active full file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_full_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_full_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_file_transfer_mode\">").f(ctx.get(["tLocal/passive incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["local_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_file_transfer_mode\">").f(ctx.get(["tInternet/active incremental file backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_file_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_incr_file_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_incr_file_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option><option value=\"blockhash\" ").f(ctx.get(["internet_incr_file_transfer_mode_2"], false),ctx,"h").w(">").f(ctx.get(["tBlock differences - hashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_file_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_image_transfer_mode\">").f(ctx.get(["tLocal/passive image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["local_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["local_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"local_image_transfer_mode_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_image_transfer_mode\">").f(ctx.get(["tInternet/active image backup transfer mode"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_image_transfer_mode\"><option value=\"raw\" ").f(ctx.get(["internet_image_transfer_mode_0"], false),ctx,"h").w(">").f(ctx.get(["tRaw"], false),ctx,"h").w("</option><option value=\"hashed\" ").f(ctx.get(["internet_image_transfer_mode_1"], false),ctx,"h").w(">").f(ctx.get(["tHashed"], false),ctx,"h").w("</option></select></div><div id=\"internet_image_transfer_mode_sw\" style=\"display: inline\"></div></div>\t\t\t<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_incr_image_style\">").f(ctx.get(["tLocal/passive incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["local_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["local_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_incr_image_style\">").f(ctx.get(["tInternet/active incremental image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_incr_image_style\"><option value=\"to-full\" ").f(ctx.get(["internet_incr_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tBased on last full image backup"], false),ctx,"h").w("</option><option value=\"to-last\" ").f(ctx.get(["internet_incr_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tBased on last image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_incr_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"local_full_image_style\">").f(ctx.get(["tLocal/passive full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"local_full_image_style\"><option value=\"full\" ").f(ctx.get(["local_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["local_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"local_full_image_style_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_full_image_style\">").f(ctx.get(["tInternet/active full image style"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><select class=\"form-control\" id=\"internet_full_image_style\"><option value=\"full\" ").f(ctx.get(["internet_full_image_style_0"], false),ctx,"h").w(">").f(ctx.get(["tFull image backup #1"], false),ctx,"h").w("</option><option value=\"synthetic\" ").f(ctx.get(["internet_full_image_style_1"], false),ctx,"h").w(">").f(ctx.get(["tSynthetic full image backup"], false),ctx,"h").w("</option></select></div><div id=\"internet_full_image_style_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["global_settings_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_stats_cachesize\">").f(ctx.get(["tDatabase cache size during batch processing"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"update_stats_cachesize\" value=\"").f(ctx.get(["update_stats_cachesize"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMB"], false),ctx,"h").w("</div></div></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"use_incremental_symlinks\">").f(ctx.get(["tUse symlinks during incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"use_incremental_symlinks\" value=\"false\" ").f(ctx.get(["use_incremental_symlinks"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_expect_endpoint\">").f(ctx.get(["tList of server IPs (proxys) from which to expect endpoint information (forwarded for) when connecting to Internet/active service (needs server restart)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_expect_endpoint\" value=\"").f(ctx.get(["internet_expect_endpoint"], false),ctx,"h").w("\"/></label></div></div>").f(ctx.get(["global_settings_end"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"end_to_end_file_backup_verification\">").f(ctx.get(["tDebugging: End-to-end verification of all file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"end_to_end_file_backup_verification\" value=\"false\" ").f(ctx.get(["end_to_end_file_backup_verification"], false),ctx,"h").w("/></label></div><div id=\"end_to_end_file_backup_verification_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"verify_using_client_hashes\">").f(ctx.get(["tDebugging: Verify file backups using client side hashes"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"verify_using_client_hashes\" value=\"false\" ").f(ctx.get(["verify_using_client_hashes"], false),ctx,"h").w("/></label></div><div id=\"verify_using_client_hashes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_readd_file_entries\">").f(ctx.get(["tPeriodically readd file entries of internet clients to database (disable only if you do not run fulls)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_readd_file_entries\" value=\"true\" ").f(ctx.get(["internet_readd_file_entries"], false),ctx,"h").w("/></label></div><div id=\"internet_readd_file_entries_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"background_backups\">").f(ctx.get(["tRun backups with background priority on the clients"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"background_backups\" value=\"true\" ").f(ctx.get(["background_backups"], false),ctx,"h").w("/></label></div><div id=\"background_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"create_linked_user_views\">").f(ctx.get(["tCreate symbolically linked views for each user on the clients after file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"create_linked_user_views\" value=\"true\" ").f(ctx.get(["create_linked_user_views"], false),ctx,"h").w("/></label></div><div id=\"create_linked_user_views_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"max_running_jobs_per_client\">").f(ctx.get(["tMaximum number of simultaneous jobs per client"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"max_running_jobs_per_client\" value=\"").f(ctx.get(["max_running_jobs_per_client"], false),ctx,"h").w("\"/></label></div><div id=\"max_running_jobs_per_client_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_volumes\">").f(ctx.get(["tList of volumes for which change block tracking should be used (if available)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_volumes\" value=\"").f(ctx.get(["cbt_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"cbt_crash_persistent_volumes\">").f(ctx.get(["tList of volumes for which the change block tracking should be crash persistent"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"cbt_crash_persistent_volumes\" value=\"").f(ctx.get(["cbt_crash_persistent_volumes"], false),ctx,"h").w("\"/></label></div><div id=\"cbt_crash_persistent_volumes_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"ignore_disk_errors\">").f(ctx.get(["tDo not fail backups in case of hash mismatches or read errors"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"ignore_disk_errors\" value=\"true\" ").f(ctx.get(["ignore_disk_errors"], false),ctx,"h").w("/></label></div><div id=\"ignore_disk_errors_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during image backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_snapshot_groups\" value=\"").f(ctx.get(["image_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"image_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"file_snapshot_groups\">").f(ctx.get(["tVolumes to snapshot in groups during file backups"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"file_snapshot_groups\" value=\"").f(ctx.get(["file_snapshot_groups"], false),ctx,"h").w("\"/></label></div><div id=\"file_snapshot_groups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"vss_select_components\">").f(ctx.get(["tWindows components backup configuration"], false),ctx,"h").w("</label><div class=\"col-sm-6\" id=\"vss_select_components_div\"><label><input type=\"text\" class=\"form-control\" id=\"vss_select_components\" value=\"").f(ctx.get(["vss_select_components"], false),ctx,"h").w("\"/></label></div><div id=\"vss_select_components_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_settings_tray_access_pw\">").f(ctx.get(["tRequire tray icon users to enter following text before being able to change settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_settings_tray_access_pw\" value=\"").f(ctx.get(["client_settings_tray_access_pw"], false),ctx,"h").w("\"/></label></div><div id=\"client_settings_tray_access_pw_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"download_threads\">Beta: ").f(ctx.get(["tNumber of parallel file download threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"download_threads\" value=\"").f(ctx.get(["download_threads"], false),ctx,"h").w("\"/></label></div><div id=\"download_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"hash_threads\">Beta: ").f(ctx.get(["tNumber of parallel server file hash threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"hash_threads\" value=\"").f(ctx.get(["hash_threads"], false),ctx,"h").w("\"/></label></div><div id=\"hash_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"client_hash_threads\">Beta: ").f(ctx.get(["tNumber of parallel client file hash threads per file backup"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"client_hash_threads\" value=\"").f(ctx.get(["client_hash_threads"], false),ctx,"h").w("\"/></label></div><div id=\"client_hash_threads_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"image_compress_threads\">Beta: ").f(ctx.get(["tNumber of threads to use for VHDZ compression (0: auto)"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"image_compress_threads\" value=\"").f(ctx.get(["image_compress_threads"], false),ctx,"h").w("\"/></label></div><div id=\"image_compress_threads_sw\" style=\"display: inline\"></div></div></form></div></div></div>").x(ctx.get(["client_settings"], false),ctx,{"block":body_19},{});}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"file_backups\">");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<div class=\"tab-pane active\" id=\"file_backups\">");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<option value=\"cowraw\" ").f(ctx.get(["image_file_format_5"], false),ctx,"h").w(">").f(ctx.get(["tRaw copy-on-write file"], false),ctx,"h").w("</option>");}body_3.__dustBody=!0;function body_4(chk,ctx){return chk.w("<div class=\"tab-pane\" id=\"permissions\"><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\"><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_config_paths\">").f(ctx.get(["tAllow client-side changing of the directories to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_config_paths\" ").f(ctx.get(["allow_config_paths"], false),ctx,"h").w("/></label></div><div id=\"allow_config_paths_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_file_backups\">").f(ctx.get(["tAllow client-side starting of full file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_full_file_backups\" ").f(ctx.get(["allow_starting_full_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_file_backups\">").f(ctx.get(["tAllow client-side starting of incremental file backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_file_backups\" ").f(ctx.get(["allow_starting_incr_file_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_file_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_full_image_backups\">").f(ctx.get(["tAllow client-side starting of full image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"checkbox\" id=\"allow_starting_full_image_backups\" ").f(ctx.get(["allow_starting_full_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_full_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_starting_incr_image_backups\">").f(ctx.get(["tAllow client-side starting of incremental image backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_starting_incr_image_backups\" ").f(ctx.get(["allow_starting_incr_image_backups"], false),ctx,"h").w("/></label></div><div id=\"allow_starting_incr_image_backups_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_log_view\">").f(ctx.get(["tAllow client-side viewing of backup logs"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_log_view\" ").f(ctx.get(["allow_log_view"], false),ctx,"h").w("/></label></div><div id=\"allow_log_view_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_pause\">").f(ctx.get(["tAllow client-side pausing of backups"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_pause\" ").f(ctx.get(["allow_pause"], false),ctx,"h").w("/></label></div><div id=\"allow_pause_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_verwrite\">").f(ctx.get(["tAllow client-side changing of settings"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_overwrite\" ").f(ctx.get(["allow_overwrite"], false),ctx,"h").w("/></label></div><div id=\"allow_overwrite_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_tray_exit\">").f(ctx.get(["tAllow clients to quit the tray icon"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_tray_exit\" ").f(ctx.get(["allow_tray_exit"], false),ctx,"h").w("/></label></div><div id=\"allow_tray_exit_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_file_restore\">").f(ctx.get(["tAllow clients to start file restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_file_restore\" ").f(ctx.get(["allow_file_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_file_restore_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_config\">").f(ctx.get(["tAllow clients to configure components to backup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_config\" ").f(ctx.get(["allow_component_config"], false),ctx,"h").w("/></label></div><div id=\"allow_component_config_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"allow_component_restore\">").f(ctx.get(["tAllow clients to start component restores"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"allow_component_restore\" ").f(ctx.get(["allow_component_restore"], false),ctx,"h").w("/></label></div><div id=\"allow_component_restore_sw\" style=\"display: inline\"></div></div></form></div></div></div>");}body_4.__dustBody=!0;function body_5(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"startup_backup_delay\">").f(ctx.get(["tDelay after system startup"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"startup_backup_delay\" value=\"").f(ctx.get(["startup_backup_delay"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">").f(ctx.get(["tMin"], false),ctx,"h").w("</div></div></div><div id=\"startup_backup_delay_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"pause_if_windows_unlocked\">").f(ctx.get(["tPause backups if Windows is unlocked"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"pause_if_windows_unlocked\" ").f(ctx.get(["pause_if_windows_unlocked"], false),ctx,"h").w("/></label></div><div id=\"pause_if_windows_unlocked_sw\" style=\"display: inline\"></div></div>");}body_5.__dustBody=!0;function body_6(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"computername\">").f(ctx.get(["tClient name"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"computername\" value=\"").f(ctx.get(["computername"], false),ctx,"h").w("\"/></div><div id=\"computername_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_6.__dustBody=!0;function body_7(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"silent_update\">").f(ctx.get(["tPerform autoupdates silently"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"silent_update\" ").f(ctx.get(["silent_update"], false),ctx,"h").w("/></label></div><div id=\"silent_update_sw\" style=\"display: inline\"></div></div>");}body_7.__dustBody=!0;function body_8(chk,ctx){return chk.f(ctx.get(["no_compname_start"], false),ctx,"h",["s"]).w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"virtual_clients\">").f(ctx.get(["tAdditional virtual sub client names"], false),ctx,"h").w(":</label><div class=\"col-sm-6\" id=\"virtual_clients_div\"><input type=\"text\" class=\"form-control\" id=\"virtual_clients\" value=\"").f(ctx.get(["virtual_clients"], false),ctx,"h").w("\"/></div><div id=\"virtual_clients_sw\" style=\"display: inline\"></div></div>").f(ctx.get(["no_compname_end"], false),ctx,"h",["s"]);}body_8.__dustBody=!0;function body_9(chk,ctx){return chk.w("<input type=\"button\" class=\"btn btn-sm btn-default\" value=\"").f(ctx.get(["tAdd"], false),ctx,"h").w("\" id=\"archive_add\" onclick=\"addArchiveItem(true)\" />");}body_9.__dustBody=!0;function body_10(chk,ctx){return chk.w("<a href=\"javascript: show_scripts1()\">").f(ctx.get(["tEdit scripts"], false),ctx,"h").w("</a>");}body_10.__dustBody=!0;function body_11(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tClients try to connect via Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"true\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server\">").f(ctx.get(["tServer URL clients connect to"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server\" value=\"").f(ctx.get(["internet_server"], false),ctx,"h").w("\" placeholder=\"ws://example.com:55414/socket\"/></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_server_proxy\">").f(ctx.get(["tConnect via HTTP(S) proxy (leave empty to connect without)"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"internet_server_proxy\" value=\"").f(ctx.get(["internet_server_proxy"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_11.__dustBody=!0;function body_12(chk,ctx){return chk.nx(ctx.get(["global_settings"], false),ctx,{"block":body_13},{}).x(ctx.get(["with_authkey"], false),ctx,{"block":body_14},{});}body_12.__dustBody=!0;function body_13(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_mode_enabled\">").f(ctx.get(["tTry to to connect via Internet/active client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_mode_enabled\" value=\"true\" ").f(ctx.get(["internet_mode_enabled"], false),ctx,"h").w("/></label></div><div id=\"internet_mode_enabled_sw\" style=\"display: inline\"></div></div>");}body_13.__dustBody=!0;function body_14(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_authkey\">").f(ctx.get(["tAuth key"], false),ctx,"h").w("</label><div class=\"col-sm-6\"><label><input type=\"text\" class=\"form-control\" id=\"internet_authkey\" value=\"").f(ctx.get(["internet_authkey"], false),ctx,"h",["s"]).w("\"/></label></div></div>");}body_14.__dustBody=!0;function body_15(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"global_internet_speed\">").f(ctx.get(["tTotal max backup speed for Internet/active connection"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><div class=\"input-group\"><input type=\"text\" class=\"form-control\" id=\"global_internet_speed\" value=\"").f(ctx.get(["global_internet_speed"], false),ctx,"h").w("\"/><div class=\"input-group-addon\">KBit/s</div></div></div><div id=\"global_internet_speed_sw\" style=\"display: inline\"></div></div>");}body_15.__dustBody=!0;function body_16(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_encrypt\">").f(ctx.get(["tEncrypted Internet/active transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_encrypt\" value=\"false\" ").f(ctx.get(["internet_encrypt"], false),ctx,"h").w("/></label></div><div id=\"internet_encrypt_sw\" style=\"display: inline\"></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_compress\">").f(ctx.get(["tCompressed Internet/active transfer"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_compress\" value=\"false\" ").f(ctx.get(["internet_compress"], false),ctx,"h").w("/></label></div><div id=\"internet_compress_sw\" style=\"display: inline\"></div></div>");}body_16.__dustBody=!0;function body_17(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"internet_connect_always\">").f(ctx.get(["tConnect as Internet/active client if connected to as local/passive client"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"internet_connect_always\" value=\"false\" ").f(ctx.get(["internet_connect_always"], false),ctx,"h").w("/></label></div><div id=\"internet_connect_always_sw\" style=\"display: inline\"></div></div>");}body_17.__dustBody=!0;function body_18(chk,ctx){return chk.w("<div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"update_dataplan_db\">").f(ctx.get(["tUpdate data limit estimation database"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"update_dataplan_db\" value=\"true\" ").f(ctx.get(["update_dataplan_db"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-4 control-label\" for=\"restore_authkey\">").f(ctx.get(["tInternet/active restore authentication key"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"restore_authkey\" value=\"").f(ctx.get(["restore_authkey"], false),ctx,"h",["s"]).w("\"/></div></div>");}body_18.__dustBody=!0;function body_19(chk,ctx){return chk.w("</div>");}body_19.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_archive_row",body_0);function body_0(chk,ctx){return chk.w("<td>").f(ctx.get(["archive_every"], false),ctx,"h").w("</td><td>").f(ctx.get(["archive_for"], false),ctx,"h").w("</td><td>").f(ctx.get(["archive_window"], false),ctx,"h").w("<td>").f(ctx.get(["archive_backup_type_str"], false),ctx,"h").w("</td><td>").f(ctx.get(["archive_letters_str"], false),ctx,"h").w("</td>").x(ctx.get(["show_archive_timeleft"], false),ctx,{"block":body_1},{}).w("<td>").x(ctx.get(["source_group"], false),ctx,{"block":body_2},{}).x(ctx.get(["source_here"], false),ctx,{"block":body_3},{}).w("</td><td><input class=\"btn btn-sm btn-default\" type=\"button\" value=\"").f(ctx.get(["tDelete"], false),ctx,"h").w("\" onclick=\"deleteArchiveItem('").f(ctx.get(["archive_uuid"], false),ctx,"h").w("')\"\"/").x(ctx.get(["source_group"], false),ctx,{"block":body_4},{}).w("></td>");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<td>").f(ctx.get(["archive_timeleft"], false),ctx,"h").w("</td>");}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<span class=\"glyphicon glyphicon-lock\" aria-hidden=\"true\" title=\"").f(ctx.get(["tArchival setting from group"], false),ctx,"h").w("\"></span>");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<span class=\"glyphicon glyphicon-home\" aria-hidden=\"true\" title=\"").f(ctx.get(["tArchival setting from here"], false),ctx,"h").w("\"></span>");}body_3.__dustBody=!0;function body_4(chk,ctx){return chk.w("disabled");}body_4.__dustBody=!0;return body_0;})();
 (function(){dust.register("report_script_edit",body_0);function body_0(chk,ctx){return chk.w("<div class=\"panel panel-default\" style=\"margin-top:20px; height:100%\"><div class=\"panel-heading\">").f(ctx.get(["tEdit report script"], false),ctx,"h").w("</div><div class=\"panel-body\"><div><h3>").f(ctx.get(["tReport script"], false),ctx,"h").w("</h3><div id=\"editor\" style=\"clear:left; border:1px solid grey; height:600px\"></div>\t\t</div><br /><input type=\"button\" class=\"btn btn-primary\" style=\"margin-left: 20px\" value=\"").f(ctx.get(["tSave"], false),ctx,"h").w("\" onClick=\"saveReportScript()\"/>").x(ctx.get(["saved_ok"], false),ctx,{"block":body_1},{}).w("</div></div>");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.w("<div id=\"saved_ok\">Saved script successfully.</div>");}body_1.__dustBody=!0;return body_0;})();
 (function(){dust.register("settings_ldap",body_0);function body_0(chk,ctx){return chk.w("<br/><div class=\"panel panel-default\"><div class=\"panel-body\"><form class=\"form-horizontal\" role=\"form\"><div class=\"alert alert-danger\" role=\"alert\">LDAP/AD login is currently undergoing development and testing. Please do not expect it to work.</div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_login_enabled\">").f(ctx.get(["tEnable logins via LDAP/AD"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><label><input type=\"checkbox\" id=\"ldap_login_enabled\" value=\"false\" ").f(ctx.get(["ldap_login_enabled"], false),ctx,"h").w("/></label></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_server_name\">").f(ctx.get(["tLDAP/AD server name"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_server_name\" value=\"").f(ctx.get(["ldap_server_name"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_server_port\">").f(ctx.get(["tLDAP/AD server port"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_server_port\" value=\"").f(ctx.get(["ldap_server_port"], false),ctx,"h").w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_username_prefix\">").f(ctx.get(["tLDAP/AD user name prefix"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_username_prefix\" value=\"").f(ctx.get(["ldap_username_prefix"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_username_suffix\">").f(ctx.get(["tLDAP/AD user name suffix"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_username_suffix\" value=\"").f(ctx.get(["ldap_username_suffix"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_group_class_query\">").f(ctx.get(["tLDAP/AD group and class query"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_group_class_query\" value=\"").f(ctx.get(["ldap_group_class_query"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_group_key_name\">").f(ctx.get(["tLDAP/AD group key name in query"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_group_key_name\" value=\"").f(ctx.get(["ldap_group_key_name"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_class_key_name\">").f(ctx.get(["tLDAP/AD class key name in query"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_class_key_name\" value=\"").f(ctx.get(["ldap_class_key_name"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_group_rights_map\">").f(ctx.get(["tLDAP/AD group rights map"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_group_rights_map\" value=\"").f(ctx.get(["ldap_group_rights_map"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"ldap_class_rights_map\">").f(ctx.get(["tLDAP/AD class rights map"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"ldap_class_rights_map\" value=\"").f(ctx.get(["ldap_class_rights_map"], false),ctx,"h",["s"]).w("\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"testusername\">").f(ctx.get(["tTest login with this user"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"text\" class=\"form-control\" id=\"testusername\" value=\"\"/></div></div><div class=\"form-group\"><label class=\"col-sm-3 control-label\" for=\"testpassword\">").f(ctx.get(["tPassword for test user"], false),ctx,"h").w(":</label><div class=\"col-sm-6\"><input type=\"password\" class=\"form-control\" id=\"testpassword\" value=\"\"/></div></div><input type=\"button\" class=\"btn btn-default\" value=\"").f(ctx.get(["tSave"], false),ctx,"h").w("\" onClick=\"saveLdapSettings()\" />").x(ctx.get(["test_login"], false),ctx,{"block":body_1},{}).w("</form></div></div>");}body_0.__dustBody=!0;function body_1(chk,ctx){return chk.x(ctx.get(["test_login_ok"], false),ctx,{"else":body_2,"block":body_3},{});}body_1.__dustBody=!0;function body_2(chk,ctx){return chk.w("<div class=\"alert alert-danger\"><strong>").f(ctx.get(["tTest login failed. Error:"], false),ctx,"h").w("</strong> ").f(ctx.get(["ldap_err"], false),ctx,"h").w("</div>");}body_2.__dustBody=!0;function body_3(chk,ctx){return chk.w("<div class=\"alert alert-success\"><strong>").f(ctx.get(["tTest login succeeded. Rights of user:"], false),ctx,"h").w(" ").f(ctx.get(["ldap_rights"], false),ctx,"h").w("</strong></div>");}body_3.__dustBody=!0;return body_0;})();
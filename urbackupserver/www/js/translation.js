@@ -1869,6 +1869,7 @@ translations.en = {
 "tDirectories to backup are optional by default:": "Directories to backup are optional by default:",
 "tCompressed VHDX (Compressed non-standard Virtual HardDisk v2) (beta)": "Compressed VHDX (Compressed non-standard Virtual HardDisk v2) (beta)",
 "tVHDX (Virtual HardDisk v2) (beta)": "VHDX (Virtual HardDisk v2) (beta)",
+"tDeduplicated image blocks (shared block store) (beta)": "Deduplicated image blocks (shared block store) (beta)",
 "tAdditional virtual sub client names": "Additional virtual sub client names",
 "tMax backup speed for local/passive transfers": "Max backup speed for local/passive transfers",
 "tEncrypt local/passive transfers": "Encrypt local/passive transfers",